@@ -0,0 +1,172 @@
+#include "AliasingPlanner.h"
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+void AliasingPlanner::Reset()
+{
+	m_resources.clear();
+	m_placements.clear();
+	m_events.clear();
+	std::fill(std::begin(m_heapSizes), std::end(m_heapSizes), 0);
+	m_unaliasedSize = 0;
+	m_peakLiveSize = 0;
+}
+
+uint32_t AliasingPlanner::AddResource(uint64_t size, uint64_t alignment, TransientHeapType heapType, uint32_t firstUse, uint32_t lastUse)
+{
+	if (firstUse > lastUse || heapType >= TransientHeapType::count || alignment == 0 || (alignment & (alignment - 1)) != 0)
+		throw std::runtime_error("AliasingPlanner: invalid transient resource");
+	m_resources.push_back({ size, alignment, heapType, firstUse, lastUse });
+	return static_cast<uint32_t>(m_resources.size() - 1);
+}
+
+void AliasingPlanner::Plan()
+{
+	const uint32_t count = static_cast<uint32_t>(m_resources.size());
+	m_placements.assign(count, {});
+	m_events.clear();
+	std::fill(std::begin(m_heapSizes), std::end(m_heapSizes), 0);
+	m_unaliasedSize = 0;
+	m_peakLiveSize = 0;
+
+	// ͬʱȷŴԴʹΪλĴС
+	std::vector<uint32_t> order(count);
+	for (uint32_t idx = 0; idx < count; ++idx)
+	{
+		order[idx] = idx;
+	}
+	std::sort(order.begin(), order.end(), [this](uint32_t lhs, uint32_t rhs)
+	{
+		const Resource& l = m_resources[lhs];
+		const Resource& r = m_resources[rhs];
+		if (l.firstUse != r.firstUse)
+			return l.firstUse < r.firstUse;
+		if (l.size != r.size)
+			return l.size > r.size;
+		return lhs < rhs;
+	});
+
+	std::vector<Slot> slots[heapTypeCount];
+	std::vector<uint32_t> slotOf(count);
+	for (const uint32_t idx : order)
+	{
+		const Resource& res = m_resources[idx];
+		auto& heapSlots = slots[static_cast<uint32_t>(res.heapType)];
+		size_t bestFit = heapSlots.size();
+		size_t largest = heapSlots.size();
+		for (size_t slotIdx = 0; slotIdx < heapSlots.size(); ++slotIdx)
+		{
+			const Slot& slot = heapSlots[slotIdx];
+			if (slot.lastUse >= res.firstUse)
+				continue;
+			if (slot.size >= res.size && (bestFit == heapSlots.size() || slot.size < heapSlots[bestFit].size))
+				bestFit = slotIdx;
+			if (largest == heapSlots.size() || slot.size > heapSlots[largest].size)
+				largest = slotIdx;
+		}
+		const size_t chosen = bestFit != heapSlots.size() ? bestFit : largest;
+		if (chosen == heapSlots.size())
+		{
+			heapSlots.emplace_back();
+		}
+		else
+		{
+			m_events.push_back({ res.firstUse, heapSlots[chosen].lastResource, idx });
+		}
+		Slot& slot = heapSlots[chosen];
+		slot.size = std::max(slot.size, res.size);
+		slot.alignment = std::max(slot.alignment, res.alignment);
+		slot.lastUse = res.lastUse;
+		slot.lastResource = idx;
+		slotOf[idx] = static_cast<uint32_t>(chosen);
+		m_unaliasedSize += res.size;
+	}
+
+	// λڶ
+	for (uint32_t type = 0; type < heapTypeCount; ++type)
+	{
+		uint64_t offset = 0;
+		for (auto& slot : slots[type])
+		{
+			slot.offset = AlignUp(offset, slot.alignment);
+			offset = slot.offset + slot.size;
+		}
+		m_heapSizes[type] = offset;
+	}
+	for (uint32_t idx = 0; idx < count; ++idx)
+	{
+		const TransientHeapType heapType = m_resources[idx].heapType;
+		m_placements[idx] = { heapType, slots[static_cast<uint32_t>(heapType)][slotOf[idx]].offset };
+	}
+	std::stable_sort(m_events.begin(), m_events.end(), [](const AliasingEvent& lhs, const AliasingEvent& rhs) { return lhs.position < rhs.position; });
+
+	// ɨڵĶ˵㣬ͬһλͷźռ
+	std::vector<std::pair<uint64_t, int64_t>> sweep;
+	sweep.reserve(count * 2ULL);
+	for (const auto& res : m_resources)
+	{
+		sweep.emplace_back(res.firstUse, static_cast<int64_t>(res.size));
+		sweep.emplace_back(static_cast<uint64_t>(res.lastUse) + 1, -static_cast<int64_t>(res.size));
+	}
+	std::sort(sweep.begin(), sweep.end());
+	int64_t live = 0;
+	for (const auto& [position, delta] : sweep)
+	{
+		live += delta;
+		m_peakLiveSize = std::max(m_peakLiveSize, static_cast<uint64_t>(live));
+	}
+}
+
+uint32_t AliasingPlanner::GetResourceCount() const
+{
+	return static_cast<uint32_t>(m_resources.size());
+}
+
+const TransientPlacement& AliasingPlanner::GetPlacement(uint32_t resource) const
+{
+	assert(resource < m_placements.size());
+	return m_placements[resource];
+}
+
+const std::vector<AliasingEvent>& AliasingPlanner::GetAliasingEvents() const
+{
+	return m_events;
+}
+
+uint64_t AliasingPlanner::GetHeapSize(TransientHeapType heapType) const
+{
+	return m_heapSizes[static_cast<uint32_t>(heapType)];
+}
+
+uint64_t AliasingPlanner::GetUnaliasedSize() const
+{
+	return m_unaliasedSize;
+}
+
+uint64_t AliasingPlanner::GetAliasedSize() const
+{
+	uint64_t size = 0;
+	for (const uint64_t heapSize : m_heapSizes)
+	{
+		size += heapSize;
+	}
+	return size;
+}
+
+uint64_t AliasingPlanner::GetPeakLiveSize() const
+{
+	return m_peakLiveSize;
+}
+
+uint64_t AliasingPlanner::GetSavedSize() const
+{
+	// λƫƵĶڼ¿ܳʡĿռ
+	const uint64_t aliased = GetAliasedSize();
+	return aliased < m_unaliasedSize ? m_unaliasedSize - aliased : 0;
+}
+
+uint64_t AliasingPlanner::AlignUp(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * ˲̬ԴڶѵԴѲ㼶1ӲԴܷͬһ
+ */
+enum class TransientHeapType : uint32_t
+{
+	renderTarget = 0,	// ȾĿģ
+	texture,			// 
+	buffer,
+	count
+};
+
+// ˲̬Դڶеλ
+struct TransientPlacement
+{
+	TransientHeapType	heapType{ TransientHeapType::texture };
+	uint64_t			offset{ 0 };
+};
+
+// afterһʹ֮ǰbeforeռõڴ潻afterݲЧ
+struct AliasingEvent
+{
+	uint32_t	position{ 0 };	// afterһαʹõpass
+	uint32_t	before{ 0 };
+	uint32_t	after{ 0 };
+};
+
+/*
+ * ˲̬Դı滮ֻƫƣԴ
+ * ÿԴΪpassϵı[firstUse, lastUse]ཻԴͼ
+ * ˳ͼ̰ɫÿɫΪеһλȸԴСвλ
+ * ĿвλûʱλͬһλеԴڻཻ˿Թڴ
+ * Դڲλ滻һԴʱϣԴδ壬һʹñд
+ */
+class AliasingPlanner
+{
+public:
+	static constexpr uint32_t heapTypeCount = static_cast<uint32_t>(TransientHeapType::count);
+
+	AliasingPlanner() = default;
+	AliasingPlanner(const AliasingPlanner&) = delete;
+	AliasingPlanner& operator=(const AliasingPlanner&) = delete;
+	AliasingPlanner(AliasingPlanner&&) = default;
+	AliasingPlanner& operator=(AliasingPlanner&&) = default;
+	~AliasingPlanner() = default;
+
+	void Reset();
+	// alignmentΪ2ݣԴ
+	uint32_t AddResource(uint64_t size, uint64_t alignment, TransientHeapType heapType, uint32_t firstUse, uint32_t lastUse);
+	void Plan();
+
+	uint32_t GetResourceCount() const;
+	const TransientPlacement& GetPlacement(uint32_t resource) const;
+	// position
+	const std::vector<AliasingEvent>& GetAliasingEvents() const;
+	uint64_t GetHeapSize(TransientHeapType heapType) const;
+	// ÿԴռڴʱܴС
+	uint64_t GetUnaliasedSize() const;
+	// жѵܴС
+	uint64_t GetAliasedSize() const;
+	// ͬһʱ̴ԴܴСκα½
+	uint64_t GetPeakLiveSize() const;
+	uint64_t GetSavedSize() const;
+private:
+	struct Resource
+	{
+		uint64_t			size;
+		uint64_t			alignment;
+		TransientHeapType	heapType;
+		uint32_t			firstUse;
+		uint32_t			lastUse;
+	};
+	struct Slot
+	{
+		uint64_t	size{ 0 };
+		uint64_t	alignment{ 1 };
+		uint32_t	lastUse{ 0 };
+		uint32_t	lastResource{ 0 };
+		uint64_t	offset{ 0 };
+	};
+
+	static uint64_t AlignUp(uint64_t value, uint64_t alignment);
+private:
+	std::vector<Resource>				m_resources;
+	std::vector<TransientPlacement>		m_placements;
+	std::vector<AliasingEvent>			m_events;
+	uint64_t							m_heapSizes[heapTypeCount]{};
+	uint64_t							m_unaliasedSize{ 0 };
+	uint64_t							m_peakLiveSize{ 0 };
+};
@@ -0,0 +1,54 @@
+#include "D3D12GraphBackend.h"
+#include "D3D12StateTracker.h"
+
+static_assert(GraphState::common == D3D12_RESOURCE_STATE_COMMON && GraphState::present == D3D12_RESOURCE_STATE_PRESENT);
+static_assert(GraphState::vertexAndConstantBuffer == D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER && GraphState::indexBuffer == D3D12_RESOURCE_STATE_INDEX_BUFFER);
+static_assert(GraphState::renderTarget == D3D12_RESOURCE_STATE_RENDER_TARGET && GraphState::unorderedAccess == D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+static_assert(GraphState::depthWrite == D3D12_RESOURCE_STATE_DEPTH_WRITE && GraphState::depthRead == D3D12_RESOURCE_STATE_DEPTH_READ);
+static_assert(GraphState::nonPixelShaderResource == D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE && GraphState::pixelShaderResource == D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+static_assert(GraphState::indirectArgument == D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT);
+static_assert(GraphState::copyDest == D3D12_RESOURCE_STATE_COPY_DEST && GraphState::copySource == D3D12_RESOURCE_STATE_COPY_SOURCE);
+
+D3D12GraphBackend::D3D12GraphBackend(ID3D12GraphicsCommandList* cmdList, const RenderGraph& graph)
+: m_cmdList(cmdList), m_graph(graph)
+{
+}
+
+void D3D12GraphBackend::SubmitBarriers(const GraphBarrier* barriers, uint32_t count)
+{
+	// ύ״̬кϣ֡ͼת¼ƺͬ
+	FlushBarriers(m_cmdList);
+	auto* tracker = D3D12StateTracker::Find(m_cmdList);
+	m_scratch.clear();
+	for (uint32_t idx = 0; idx < count; ++idx)
+	{
+		const GraphBarrier& barrier = barriers[idx];
+		auto* resource = static_cast<ID3D12Resource*>(m_graph.GetNative(barrier.resource));
+		if (barrier.type == GraphBarrierType::uav)
+		{
+			m_scratch.push_back(CD3DX12_RESOURCE_BARRIER::UAV(resource));
+			continue;
+		}
+		if (barrier.type == GraphBarrierType::aliasing)
+		{
+			// ûnative˲̬ԴΪcommittedԴϣڴԴΪʱʾԴ
+			if (resource)
+			{
+				auto* before = barrier.aliasBefore == GraphBarrier::anyResource ? nullptr : static_cast<ID3D12Resource*>(m_graph.GetNative(barrier.aliasBefore));
+				m_scratch.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(before, resource));
+			}
+			continue;
+		}
+		D3D12_RESOURCE_BARRIER_FLAGS flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+		if (barrier.split == GraphBarrierSplit::begin)
+			flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+		else if (barrier.split == GraphBarrierSplit::end)
+			flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+		m_scratch.push_back(CD3DX12_RESOURCE_BARRIER::Transition(resource, static_cast<D3D12_RESOURCE_STATES>(barrier.before), static_cast<D3D12_RESOURCE_STATES>(barrier.after),
+			D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, flags));
+		if (tracker && barrier.split != GraphBarrierSplit::begin)
+			tracker->GetTracker().NoteTransition(resource, barrier.before, barrier.after);
+	}
+	if (!m_scratch.empty())
+		m_cmdList->ResourceBarrier(static_cast<UINT>(m_scratch.size()), m_scratch.data());
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+#include <D3DUtil.hpp>
+#include "RenderGraph.h"
+
+/*
+ * ֡ͼD3D12ˣ֡ͼⲿԴnativeΪID3D12Resource*
+ */
+class D3D12GraphBackend final : public RenderGraphBackend
+{
+public:
+	D3D12GraphBackend(ID3D12GraphicsCommandList* cmdList, const RenderGraph& graph);
+	D3D12GraphBackend(const D3D12GraphBackend&) = delete;
+	D3D12GraphBackend& operator=(const D3D12GraphBackend&) = delete;
+	~D3D12GraphBackend() override = default;
+
+	void SubmitBarriers(const GraphBarrier* barriers, uint32_t count) override;
+private:
+	ID3D12GraphicsCommandList*				m_cmdList;
+	const RenderGraph&						m_graph;
+	std::vector<D3D12_RESOURCE_BARRIER>		m_scratch;
+};
@@ -0,0 +1,133 @@
+#include "D3D12StateTracker.h"
+#include <algorithm>
+#include <shared_mutex>
+
+static_assert(allSubresources == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+
+namespace
+{
+// ¼Ƶıб٣ԲҼ
+std::shared_mutex bindingMutex;
+std::vector<std::pair<ID3D12GraphicsCommandList*, D3D12StateTracker*>> bindings;
+
+class BarrierCollector final : public BarrierSink
+{
+public:
+	void Submit(const StateBarrier* barriers, uint32_t count) override
+	{
+		m_barriers.insert(m_barriers.end(), barriers, barriers + count);
+	}
+	std::vector<StateBarrier> m_barriers;
+};
+}
+
+bool TrackTransition(ID3D12GraphicsCommandList* cmdList, ID3D12Resource* res, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after)
+{
+	if (auto* tracker = D3D12StateTracker::Find(cmdList))
+	{
+		tracker->GetTracker().Transition(res, before, after);
+		return true;
+	}
+	D3D12StateTracker::GetGlobalTable().Invalidate(res);
+	return false;
+}
+
+void FlushBarriers(ID3D12GraphicsCommandList* cmdList)
+{
+	if (auto* tracker = D3D12StateTracker::Find(cmdList))
+		tracker->Flush();
+}
+
+D3D12BarrierSink::D3D12BarrierSink(ID3D12GraphicsCommandList* cmdList)
+: m_cmdList(cmdList)
+{
+}
+
+void D3D12BarrierSink::Submit(const StateBarrier* barriers, uint32_t count)
+{
+	m_scratch.clear();
+	for (uint32_t idx = 0; idx < count; ++idx)
+	{
+		const StateBarrier& barrier = barriers[idx];
+		auto* resource = static_cast<ID3D12Resource*>(barrier.resource);
+		if (barrier.type == StateBarrierType::uav)
+			m_scratch.push_back(CD3DX12_RESOURCE_BARRIER::UAV(resource));
+		else
+			m_scratch.push_back(CD3DX12_RESOURCE_BARRIER::Transition(resource, static_cast<D3D12_RESOURCE_STATES>(barrier.before), static_cast<D3D12_RESOURCE_STATES>(barrier.after), barrier.subresource));
+	}
+	if (!m_scratch.empty())
+		m_cmdList->ResourceBarrier(static_cast<UINT>(m_scratch.size()), m_scratch.data());
+}
+
+D3D12StateTracker::D3D12StateTracker(ID3D12GraphicsCommandList* cmdList)
+: m_cmdList(cmdList), m_tracker(&GetGlobalTable()), m_sink(cmdList)
+{
+}
+
+D3D12StateTracker::~D3D12StateTracker()
+{
+	Unbind();
+}
+
+void D3D12StateTracker::Begin()
+{
+	m_tracker.Reset();
+	if (m_bound)
+		return;
+	std::unique_lock<std::shared_mutex> lock(bindingMutex);
+	bindings.emplace_back(m_cmdList, this);
+	m_bound = true;
+}
+
+void D3D12StateTracker::Flush()
+{
+	m_tracker.Flush(m_sink);
+}
+
+void D3D12StateTracker::Submit(ID3D12CommandQueue* queue, ID3D12CommandAllocator* alloc, ID3D12GraphicsCommandList* fixupList)
+{
+	Flush();
+	Unbind();
+	ThrowIfFailed(m_cmdList->Close());
+	BarrierCollector fixups;
+	m_tracker.Resolve(GetGlobalTable(), fixups);
+	if (fixups.m_barriers.empty())
+	{
+		ID3D12CommandList* cmdLists[] = { m_cmdList };
+		queue->ExecuteCommandLists(_countof(cmdLists), cmdLists);
+		return;
+	}
+	// бһʹԴʱٶ״̬֮ǰύбһ£תٶ״̬
+	ThrowIfFailed(fixupList->Reset(alloc, nullptr));
+	D3D12BarrierSink(fixupList).Submit(fixups.m_barriers.data(), static_cast<uint32_t>(fixups.m_barriers.size()));
+	ThrowIfFailed(fixupList->Close());
+	ID3D12CommandList* cmdLists[] = { fixupList, m_cmdList };
+	queue->ExecuteCommandLists(_countof(cmdLists), cmdLists);
+}
+
+ResourceStateTracker& D3D12StateTracker::GetTracker()
+{
+	return m_tracker;
+}
+
+ResourceStateTable& D3D12StateTracker::GetGlobalTable()
+{
+	static ResourceStateTable table;
+	return table;
+}
+
+D3D12StateTracker* D3D12StateTracker::Find(ID3D12GraphicsCommandList* cmdList)
+{
+	std::shared_lock<std::shared_mutex> lock(bindingMutex);
+	const auto iter = std::find_if(bindings.begin(), bindings.end(), [cmdList](const auto& binding) { return binding.first == cmdList; });
+	return iter == bindings.end() ? nullptr : iter->second;
+}
+
+void D3D12StateTracker::Unbind()
+{
+	if (!m_bound)
+		return;
+	std::unique_lock<std::shared_mutex> lock(bindingMutex);
+	bindings.erase(std::remove_if(bindings.begin(), bindings.end(), [this](const auto& binding) { return binding.second == this; }), bindings.end());
+	m_bound = false;
+}
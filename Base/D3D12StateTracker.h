@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <D3DUtil.hpp>
+#include "ResourceStateTracker.h"
+
+// Ѹ¼ƵбԴָΪID3D12Resource*
+class D3D12BarrierSink final : public BarrierSink
+{
+public:
+	explicit D3D12BarrierSink(ID3D12GraphicsCommandList* cmdList);
+	~D3D12BarrierSink() override = default;
+
+	void Submit(const StateBarrier* barriers, uint32_t count) override;
+private:
+	ID3D12GraphicsCommandList*				m_cmdList;
+	std::vector<D3D12_RESOURCE_BARRIER>		m_scratch;
+};
+
+/*
+ * б״̬٣BeginSubmit֮бϵChangeState
+ * drawdispatch֮ǰFlushBarriersڸебϵChangeState¼ƣʹȫ״̬еļ¼ʧЧ
+ * Submitȫ״̬¼Ƶбڸбύ
+ */
+class D3D12StateTracker
+{
+public:
+	explicit D3D12StateTracker(ID3D12GraphicsCommandList* cmdList);
+	D3D12StateTracker(const D3D12StateTracker&) = delete;
+	D3D12StateTracker& operator=(const D3D12StateTracker&) = delete;
+	~D3D12StateTracker();
+
+	// бReset֮
+	void Begin();
+	void Flush();
+	// رղύбб乲õǰķ
+	void Submit(ID3D12CommandQueue* queue, ID3D12CommandAllocator* alloc, ID3D12GraphicsCommandList* fixupList);
+	ResourceStateTracker& GetTracker();
+
+	static ResourceStateTable& GetGlobalTable();
+	// бBeginSubmit֮ʱؿ
+	static D3D12StateTracker* Find(ID3D12GraphicsCommandList* cmdList);
+private:
+	void Unbind();
+private:
+	ID3D12GraphicsCommandList*		m_cmdList;
+	ResourceStateTracker			m_tracker;
+	D3D12BarrierSink				m_sink;
+	bool							m_bound{ false };
+};
@@ -7,17 +7,21 @@
 #include <wrl/client.h>
 #include <Src/d3dx12.h>
 #include <variant>
+#include "FrameConfig.h"
+#include "ShaderConfig.h"
 
 using Microsoft::WRL::ComPtr;
 
-inline constexpr int frameResourcesCount = 3;
-inline constexpr int dirLightNum = 3;
-inline constexpr int spotLightNum = 0;
-inline constexpr int maxLights = (dirLightNum + spotLightNum);
-inline constexpr int pointLightNum = 2048;
+inline constexpr int dirLightNum = DIR_LIGHT_NUM;
+inline constexpr int spotLightNum = SPOT_LIGHT_NUM;
+inline constexpr int maxLights = MAX_LIGHTS;
 
 template <D3D12_RESOURCE_STATES TBefore, D3D12_RESOURCE_STATES TAfter>
 inline void ChangeState(ID3D12GraphicsCommandList* cmdList, ID3D12Resource* res);
+// бڱ״̬ʱתtrueʹȫ״̬иԴļ¼ʧЧD3D12StateTracker.h
+bool TrackTransition(ID3D12GraphicsCommandList* cmdList, ID3D12Resource* res, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after);
+// drawdispatch֮ǰύ
+void FlushBarriers(ID3D12GraphicsCommandList* cmdList);
 
 class D3DUtil {
 public:
@@ -64,6 +68,7 @@ public:
 		 * ͨID3D12CommandList::CopySubresourceRegionƵm_buffer
 		 */
 		ChangeState<D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST>(cmdList, ans.Get());
+		FlushBarriers(cmdList);
 		UpdateSubresources<1>(cmdList, ans.Get(), uploadBuffer.Get(), 0, 0, 1, &subresource_data); // бĿԴмԴмԴƫƣмԴʼ㣻ԴеԴ
 		ChangeState<D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList, ans.Get());
 		return ans;
@@ -164,6 +169,8 @@ inline HashID StringToID(const std::wstring& str)
 template <D3D12_RESOURCE_STATES TBefore, D3D12_RESOURCE_STATES TAfter>
 inline void ChangeState(ID3D12GraphicsCommandList* cmdList, ID3D12Resource* res)
 {
+	if (TrackTransition(cmdList, res, TBefore, TAfter))
+		return;
 	const auto& trans = CD3DX12_RESOURCE_BARRIER::Transition(res, TBefore, TAfter);
 	cmdList->ResourceBarrier(1, &trans);
 }
@@ -173,5 +180,6 @@ inline void DrawCanvas(ID3D12GraphicsCommandList* cmdList)
 	cmdList->IASetVertexBuffers(0, 0, nullptr);
 	cmdList->IASetIndexBuffer(nullptr);
 	cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	FlushBarriers(cmdList);
 	cmdList->DrawInstanced(6, 1, 0, 0);
 }
\ No newline at end of file
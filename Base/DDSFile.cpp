@@ -0,0 +1,350 @@
+#include "DDSFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+constexpr uint32_t MakeFourCC(char a, char b, char c, char d)
+{
+	return static_cast<uint32_t>(static_cast<uint8_t>(a)) | static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8 |
+		static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16 | static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24;
+}
+
+constexpr uint32_t	ddsMagic = MakeFourCC('D', 'D', 'S', ' ');
+constexpr uint32_t	ddpfFourCC = 0x4;
+constexpr uint32_t	ddpfRGB = 0x40;
+constexpr uint32_t	ddsdRequired = 0x1007;	// CAPS | HEIGHT | WIDTH | PIXELFORMAT
+constexpr uint32_t	ddsdPitch = 0x8;
+constexpr uint32_t	ddsCapsTexture = 0x1000;
+constexpr uint32_t	ddsdMipMapCount = 0x20000;
+constexpr uint32_t	ddsdDepth = 0x800000;
+constexpr uint32_t	caps2CubeMap = 0x200;
+constexpr uint32_t	caps2AllFaces = 0xFC00;
+constexpr uint32_t	caps2Volume = 0x200000;
+constexpr uint32_t	dimensionTexture2D = 3;
+constexpr uint32_t	miscTextureCube = 0x4;
+constexpr uint32_t	maxArraySize = 2048;	// D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION
+constexpr uint32_t	maxMipCount = 32;
+
+struct DDSPixelFormat
+{
+	uint32_t	size;
+	uint32_t	flags;
+	uint32_t	fourCC;
+	uint32_t	rgbBitCount;
+	uint32_t	rBitMask;
+	uint32_t	gBitMask;
+	uint32_t	bBitMask;
+	uint32_t	aBitMask;
+};
+
+struct DDSHeader
+{
+	uint32_t		size;
+	uint32_t		flags;
+	uint32_t		height;
+	uint32_t		width;
+	uint32_t		pitchOrLinearSize;
+	uint32_t		depth;
+	uint32_t		mipMapCount;
+	uint32_t		reserved1[11];
+	DDSPixelFormat	ddspf;
+	uint32_t		caps;
+	uint32_t		caps2;
+	uint32_t		caps3;
+	uint32_t		caps4;
+	uint32_t		reserved2;
+};
+
+struct DDSHeaderDX10
+{
+	uint32_t	dxgiFormat;
+	uint32_t	resourceDimension;
+	uint32_t	miscFlag;
+	uint32_t	arraySize;
+	uint32_t	miscFlags2;
+};
+
+static_assert(sizeof(DDSPixelFormat) == 32, "DDS_PIXELFORMATС");
+static_assert(sizeof(DDSHeader) == 124, "DDS_HEADERС");
+static_assert(sizeof(DDSHeaderDX10) == 20, "DDS_HEADER_DXT10С");
+
+bool IsSupported(DDSFormat format)
+{
+	return DDSFile::GetElementSize(format) != 0;
+}
+
+// ʽļͷֻʶ𳣼FourCC32λRGBA
+DDSFormat GetLegacyFormat(const DDSPixelFormat& ddspf)
+{
+	if (ddspf.flags & ddpfFourCC)
+	{
+		switch (ddspf.fourCC)
+		{
+		case MakeFourCC('D', 'X', 'T', '1'):
+			return DDSFormat::BC1_UNORM;
+		case MakeFourCC('D', 'X', 'T', '2'):
+		case MakeFourCC('D', 'X', 'T', '3'):
+			return DDSFormat::BC2_UNORM;
+		case MakeFourCC('D', 'X', 'T', '4'):
+		case MakeFourCC('D', 'X', 'T', '5'):
+			return DDSFormat::BC3_UNORM;
+		case MakeFourCC('A', 'T', 'I', '1'):
+		case MakeFourCC('B', 'C', '4', 'U'):
+			return DDSFormat::BC4_UNORM;
+		case MakeFourCC('B', 'C', '4', 'S'):
+			return DDSFormat::BC4_SNORM;
+		case MakeFourCC('A', 'T', 'I', '2'):
+		case MakeFourCC('B', 'C', '5', 'U'):
+			return DDSFormat::BC5_UNORM;
+		case MakeFourCC('B', 'C', '5', 'S'):
+			return DDSFormat::BC5_SNORM;
+		case 110: // D3DFMT_Q16W16V16U16
+			return DDSFormat::R16G16B16A16_SNORM;
+		case 113: // D3DFMT_A16B16G16R16F
+			return DDSFormat::R16G16B16A16_FLOAT;
+		case 114: // D3DFMT_R32F
+			return DDSFormat::R32_FLOAT;
+		case 116: // D3DFMT_A32B32G32R32F
+			return DDSFormat::R32G32B32A32_FLOAT;
+		default:
+			return DDSFormat::Unknown;
+		}
+	}
+	if ((ddspf.flags & ddpfRGB) && ddspf.rgbBitCount == 32)
+	{
+		if (ddspf.rBitMask == 0x000000ff && ddspf.gBitMask == 0x0000ff00 && ddspf.bBitMask == 0x00ff0000 && ddspf.aBitMask == 0xff000000)
+			return DDSFormat::R8G8B8A8_UNORM;
+		if (ddspf.rBitMask == 0x00ff0000 && ddspf.gBitMask == 0x0000ff00 && ddspf.bBitMask == 0x000000ff && ddspf.aBitMask == 0xff000000)
+			return DDSFormat::B8G8R8A8_UNORM;
+		if (ddspf.rBitMask == 0x00ff0000 && ddspf.gBitMask == 0x0000ff00 && ddspf.bBitMask == 0x000000ff && ddspf.aBitMask == 0)
+			return DDSFormat::B8G8R8X8_UNORM;
+		if (ddspf.rBitMask == 0x000003ff && ddspf.gBitMask == 0x000ffc00 && ddspf.bBitMask == 0x3ff00000 && ddspf.aBitMask == 0xc0000000)
+			return DDSFormat::R10G10B10A2_UNORM;
+	}
+	return DDSFormat::Unknown;
+}
+}
+
+bool DDSFile::Parse(const uint8_t* data, size_t size, uint32_t maxMips)
+{
+	m_info = DDSTextureInfo{};
+	m_subresources.clear();
+	if (!data || size < sizeof(uint32_t) + sizeof(DDSHeader))
+		return false;
+	uint32_t magic;
+	memcpy(&magic, data, sizeof(magic));
+	DDSHeader header;
+	memcpy(&header, data + sizeof(uint32_t), sizeof(header));
+	if (magic != ddsMagic || header.size != sizeof(DDSHeader) || header.ddspf.size != sizeof(DDSPixelFormat))
+		return false;
+	size_t offset = sizeof(uint32_t) + sizeof(DDSHeader);
+
+	DDSTextureInfo info;
+	info.width = header.width;
+	info.height = header.height;
+	info.arraySize = 1;
+	if ((header.ddspf.flags & ddpfFourCC) && header.ddspf.fourCC == MakeFourCC('D', 'X', '1', '0'))
+	{
+		if (size < offset + sizeof(DDSHeaderDX10))
+			return false;
+		DDSHeaderDX10 dx10;
+		memcpy(&dx10, data + offset, sizeof(dx10));
+		offset += sizeof(DDSHeaderDX10);
+		if (dx10.resourceDimension != dimensionTexture2D || dx10.arraySize == 0 || dx10.arraySize > maxArraySize)
+			return false;
+		info.format = static_cast<DDSFormat>(dx10.dxgiFormat);
+		info.isCubeMap = (dx10.miscFlag & miscTextureCube) != 0;
+		info.arraySize = info.isCubeMap ? dx10.arraySize * 6 : dx10.arraySize;
+	}
+	else
+	{
+		if ((header.caps2 & caps2Volume) || ((header.flags & ddsdDepth) && header.depth > 1))
+			return false;
+		if (header.caps2 & caps2CubeMap)
+		{
+			// ʽļͷͼȫ6
+			if ((header.caps2 & caps2AllFaces) != caps2AllFaces)
+				return false;
+			info.isCubeMap = true;
+			info.arraySize = 6;
+		}
+		info.format = GetLegacyFormat(header.ddspf);
+	}
+	if (!IsSupported(info.format) || info.width == 0 || info.height == 0)
+		return false;
+	if (info.isCubeMap && info.width != info.height)
+		return false;
+
+	uint32_t mipCount = (header.flags & ddsdMipMapCount) ? header.mipMapCount : 1;
+	mipCount = std::max(mipCount, 1u);
+	uint32_t fullChain = 1;
+	for (uint32_t dim = std::max(info.width, info.height); dim > 1; dim >>= 1)
+		++fullChain;
+	if (mipCount > fullChain || mipCount > maxMipCount)
+		return false;
+
+	// ֻСļmipѹʽĶmipΪ4ı
+	uint32_t skipMips = maxMips != 0 && maxMips < mipCount ? mipCount - maxMips : 0;
+	if (IsBlockCompressed(info.format))
+	{
+		while (skipMips > 0 && (std::max(info.width >> skipMips, 1u) % 4 != 0 || std::max(info.height >> skipMips, 1u) % 4 != 0))
+			--skipMips;
+	}
+
+	// ļа Ԫ -> mip ˳
+	std::vector<DDSSubresource> subresources;
+	subresources.reserve(static_cast<size_t>(info.arraySize) * (mipCount - skipMips));
+	for (uint32_t item = 0; item < info.arraySize; ++item)
+	{
+		for (uint32_t mip = 0; mip < mipCount; ++mip)
+		{
+			DDSSubresource sub;
+			sub.width = std::max(info.width >> mip, 1u);
+			sub.height = std::max(info.height >> mip, 1u);
+			GetSurfaceInfo(info.format, sub.width, sub.height, sub.rowPitch, sub.slicePitch);
+			if (sub.slicePitch > size - offset)
+				return false;
+			sub.data = data + offset;
+			offset += sub.slicePitch;
+			if (mip >= skipMips)
+				subresources.push_back(sub);
+		}
+	}
+
+	info.width = std::max(info.width >> skipMips, 1u);
+	info.height = std::max(info.height >> skipMips, 1u);
+	info.mipCount = mipCount - skipMips;
+	info.skippedMips = skipMips;
+	m_info = info;
+	m_subresources = std::move(subresources);
+	return true;
+}
+
+const DDSTextureInfo& DDSFile::GetInfo() const
+{
+	return m_info;
+}
+
+const std::vector<DDSSubresource>& DDSFile::GetSubresources() const
+{
+	return m_subresources;
+}
+
+const DDSSubresource& DDSFile::GetSubresource(uint32_t item, uint32_t mip) const
+{
+	return m_subresources[static_cast<size_t>(item) * m_info.mipCount + mip];
+}
+
+bool DDSFile::IsBlockCompressed(DDSFormat format)
+{
+	switch (format)
+	{
+	case DDSFormat::BC1_UNORM:
+	case DDSFormat::BC1_UNORM_SRGB:
+	case DDSFormat::BC2_UNORM:
+	case DDSFormat::BC2_UNORM_SRGB:
+	case DDSFormat::BC3_UNORM:
+	case DDSFormat::BC3_UNORM_SRGB:
+	case DDSFormat::BC4_UNORM:
+	case DDSFormat::BC4_SNORM:
+	case DDSFormat::BC5_UNORM:
+	case DDSFormat::BC5_SNORM:
+	case DDSFormat::BC6H_UF16:
+	case DDSFormat::BC6H_SF16:
+	case DDSFormat::BC7_UNORM:
+	case DDSFormat::BC7_UNORM_SRGB:
+		return true;
+	default:
+		return false;
+	}
+}
+
+uint32_t DDSFile::GetElementSize(DDSFormat format)
+{
+	switch (format)
+	{
+	case DDSFormat::BC1_UNORM:
+	case DDSFormat::BC1_UNORM_SRGB:
+	case DDSFormat::BC4_UNORM:
+	case DDSFormat::BC4_SNORM:
+		return 8;
+	case DDSFormat::BC2_UNORM:
+	case DDSFormat::BC2_UNORM_SRGB:
+	case DDSFormat::BC3_UNORM:
+	case DDSFormat::BC3_UNORM_SRGB:
+	case DDSFormat::BC5_UNORM:
+	case DDSFormat::BC5_SNORM:
+	case DDSFormat::BC6H_UF16:
+	case DDSFormat::BC6H_SF16:
+	case DDSFormat::BC7_UNORM:
+	case DDSFormat::BC7_UNORM_SRGB:
+		return 16;
+	case DDSFormat::R32G32B32A32_FLOAT:
+		return 16;
+	case DDSFormat::R16G16B16A16_FLOAT:
+	case DDSFormat::R16G16B16A16_SNORM:
+		return 8;
+	case DDSFormat::R10G10B10A2_UNORM:
+	case DDSFormat::R32_FLOAT:
+	case DDSFormat::R8G8B8A8_UNORM:
+	case DDSFormat::R8G8B8A8_UNORM_SRGB:
+	case DDSFormat::B8G8R8A8_UNORM:
+	case DDSFormat::B8G8R8X8_UNORM:
+	case DDSFormat::B8G8R8A8_UNORM_SRGB:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+void DDSFile::GetSurfaceInfo(DDSFormat format, uint32_t width, uint32_t height, size_t& rowPitch, size_t& slicePitch)
+{
+	const size_t elementSize = GetElementSize(format);
+	size_t rows;
+	if (IsBlockCompressed(format))
+	{
+		rowPitch = std::max<size_t>(1, (static_cast<size_t>(width) + 3) / 4) * elementSize;
+		rows = std::max<size_t>(1, (static_cast<size_t>(height) + 3) / 4);
+	}
+	else
+	{
+		rowPitch = static_cast<size_t>(width) * elementSize;
+		rows = height;
+	}
+	slicePitch = rowPitch * rows;
+}
+
+bool DDSFile::Save(const std::filesystem::path& path, DDSFormat format, uint32_t width, uint32_t height, const void* data)
+{
+	if (!data || width == 0 || height == 0 || !IsSupported(format) || IsBlockCompressed(format))
+		return false;
+	size_t rowPitch, slicePitch;
+	GetSurfaceInfo(format, width, height, rowPitch, slicePitch);
+
+	DDSHeader header{};
+	header.size = sizeof(DDSHeader);
+	header.flags = ddsdRequired | ddsdPitch;
+	header.height = height;
+	header.width = width;
+	header.pitchOrLinearSize = static_cast<uint32_t>(rowPitch);
+	header.mipMapCount = 1;
+	header.ddspf.size = sizeof(DDSPixelFormat);
+	header.ddspf.flags = ddpfFourCC;
+	header.ddspf.fourCC = MakeFourCC('D', 'X', '1', '0');
+	header.caps = ddsCapsTexture;
+	DDSHeaderDX10 dx10{};
+	dx10.dxgiFormat = static_cast<uint32_t>(format);
+	dx10.resourceDimension = dimensionTexture2D;
+	dx10.arraySize = 1;
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+		return false;
+	file.write(reinterpret_cast<const char*>(&ddsMagic), sizeof(ddsMagic));
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(&dx10), sizeof(dx10));
+	file.write(static_cast<const char*>(data), static_cast<std::streamsize>(slicePitch));
+	return file.good();
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+/*
+ * DXGI_FORMATֵһ£Windows¿ֱתΪDXGI_FORMAT
+ */
+enum class DDSFormat : uint32_t
+{
+	Unknown = 0,
+	R32G32B32A32_FLOAT = 2,
+	R16G16B16A16_FLOAT = 10,
+	R16G16B16A16_SNORM = 13,
+	R10G10B10A2_UNORM = 24,
+	R8G8B8A8_UNORM = 28,
+	R8G8B8A8_UNORM_SRGB = 29,
+	R32_FLOAT = 41,
+	BC1_UNORM = 71,
+	BC1_UNORM_SRGB = 72,
+	BC2_UNORM = 74,
+	BC2_UNORM_SRGB = 75,
+	BC3_UNORM = 77,
+	BC3_UNORM_SRGB = 78,
+	BC4_UNORM = 80,
+	BC4_SNORM = 81,
+	BC5_UNORM = 83,
+	BC5_SNORM = 84,
+	B8G8R8A8_UNORM = 87,
+	B8G8R8X8_UNORM = 88,
+	B8G8R8A8_UNORM_SRGB = 91,
+	BC6H_UF16 = 95,
+	BC6H_SF16 = 96,
+	BC7_UNORM = 98,
+	BC7_UNORM_SRGB = 99,
+};
+
+struct DDSTextureInfo
+{
+	uint32_t	width{ 0 };
+	uint32_t	height{ 0 };
+	uint32_t	mipCount{ 0 };
+	uint32_t	arraySize{ 0 };		// ͼΪ6 * 鳤
+	uint32_t	skippedMips{ 0 };	// maxMipsĸ߷ֱmip
+	DDSFormat	format{ DDSFormat::Unknown };
+	bool		isCubeMap{ false };
+};
+
+// ָӳڴԴ
+struct DDSSubresource
+{
+	const uint8_t*	data{ nullptr };
+	size_t			rowPitch{ 0 };
+	size_t			slicePitch{ 0 };
+	uint32_t		width{ 0 };
+	uint32_t		height{ 0 };
+};
+
+/*
+ * DDSļͷԴּ㣬D3Dֻ֧2Dͼ
+ * Դ˳D3D12һ£index = item * mipCount + mip
+ * ֱڴ棬豣֤ڴ(ͨMappedFile)ʹڼЧ
+ */
+class DDSFile
+{
+public:
+	/*
+	 * maxMipsΪ0ʱֻСmaxMipsmipڿٵõ֡õĵͷֱ
+	 * BCʽҪ󶥲mipĿΪ4ı˿ܱmaxMipsmip
+	 */
+	bool Parse(const uint8_t* data, size_t size, uint32_t maxMips = 0);
+	const DDSTextureInfo& GetInfo() const;
+	const std::vector<DDSSubresource>& GetSubresources() const;
+	const DDSSubresource& GetSubresource(uint32_t item, uint32_t mip) const;
+
+	static bool IsBlockCompressed(DDSFormat format);
+	// ѹʽÿ4x4ֽ෵ÿֽ
+	static uint32_t GetElementSize(DDSFormat format);
+	static void GetSurfaceInfo(DDSFormat format, uint32_t width, uint32_t height, size_t& rowPitch, size_t& slicePitch);
+	// DX10ļͷдmipķѹ2Ddataн
+	static bool Save(const std::filesystem::path& path, DDSFormat format, uint32_t width, uint32_t height, const void* data);
+private:
+	DDSTextureInfo				m_info;
+	std::vector<DDSSubresource>	m_subresources;
+};
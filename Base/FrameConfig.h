@@ -0,0 +1,4 @@
+#pragma once
+
+// ֡ԴCPUGPUô֡D3DģҲԴΪ׼
+inline constexpr int frameResourcesCount = 3;
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+/*
+ * ֻڴӳļWindowsʹCreateFileMappingƽ̨ʹmmap
+ * ӳڶCloseʱ
+ */
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	explicit MappedFile(const std::filesystem::path& path);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& rhs) noexcept;
+	MappedFile& operator=(MappedFile&& rhs) noexcept;
+	~MappedFile();
+
+	bool Open(const std::filesystem::path& path);
+	void Close();
+	bool IsOpen() const;
+	const uint8_t* GetData() const;
+	size_t GetSize() const;
+private:
+	const uint8_t*	m_data{ nullptr };
+	size_t			m_size{ 0 };
+#ifdef _WIN32
+	void*			m_file{ nullptr };
+	void*			m_mapping{ nullptr };
+#endif
+};
@@ -7,23 +7,90 @@ UINT Item::GetInstanceCount()
 
 void RenderItem::Update(const GameTimer& timer, UploaderBuffer<ObjectInstance>* currObjectCB, UINT offset)
 {
+	auto& store = TransformStore::instance();
+	if (offset != m_lastOffset)
+	{
+		m_lastOffset = offset;
+		store.MarkDirty(m_transformStart, m_transformCount);
+	}
 	instanceStart = offset;
-	// ֻЩ˸ıŻ³еݣһÿ֮Դи
-	for (UINT i = 0; i < transformPack.size(); ++i)
+	// ֻзıʵŻ£ÿһԿϴ
+	constexpr UINT batchSize = 64;
+	XMFLOAT4X4 models[batchSize];
+	ObjectInstance instances[batchSize];
+	bool boundsChanged = false;
+	if (m_hasBounds && m_instanceBounds.size() != m_transformCount)
+	{
+		m_instanceBounds.resize(m_transformCount);
+	}
+	store.ConsumeDirtyRanges(m_transformStart, m_transformCount, [&](UINT first, UINT count)
+	{
+		for (UINT batch = 0; batch < count; batch += batchSize)
+		{
+			const UINT size = std::min(batchSize, count - batch);
+			store.ComposeTransposed(first + batch, size, models);
+			for (UINT i = 0; i < size; ++i)
+			{
+				instances[i].model_gpu = models[i];
+				instances[i].matIndex_gpu = m_matIndex;
+			}
+			currObjectCB->CopyRange(offset + first + batch - m_transformStart, instances, size);
+			if (!m_hasBounds)
+				continue;
+			// ʵ任ıʱͬռΧ
+			for (UINT i = 0; i < size; ++i)
+			{
+				const XMMATRIX model = XMMatrixTranspose(XMLoadFloat4x4(&models[i]));
+				m_localBounds.Transform(m_instanceBounds[first + batch + i - m_transformStart], model);
+			}
+			boundsChanged = true;
+		}
+	});
+	if (boundsChanged)
 	{
-		XMMATRIX model = Transform::GetModelMatrixXM(
-			transformPack[i]->m_scale,
-			transformPack[i]->m_rotation,
-			transformPack[i]->m_position);
-		ObjectInstance instanceData;
-		XMStoreFloat4x4(&instanceData.model_gpu, std::move(XMMatrixTranspose(model)));
-		instanceData.matIndex_gpu = m_matIndex;
-		currObjectCB->Copy(i + offset, instanceData);
+		m_worldBounds = m_instanceBounds[0];
+		for (UINT i = 1; i < m_transformCount; ++i)
+		{
+			BoundingBox::CreateMerged(m_worldBounds, m_worldBounds, m_instanceBounds[i]);
+		}
 	}
 }
 
+void RenderItem::SetScale(UINT pos, const XMFLOAT3& scale)
+{
+	TransformStore::instance().SetScale(m_transformStart + pos, scale);
+}
+
+Transform RenderItem::GetTransform(UINT pos) const
+{
+	return TransformStore::instance().GetTransform(m_transformStart + pos);
+}
+
 UINT RenderItem::GetInstanceSize() const {
-	return static_cast<UINT>(transformPack.size());
+	return m_transformCount;
+}
+
+void RenderItem::SetLocalBounds(const BoundingBox& bounds)
+{
+	m_hasBounds = true;
+	m_localBounds = bounds;
+	// һUpdateʱ¼ʵΧ
+	m_lastOffset = UINT_MAX;
+}
+
+bool RenderItem::HasBounds() const
+{
+	return m_hasBounds;
+}
+
+const BoundingBox& RenderItem::GetWorldBounds() const
+{
+	return m_worldBounds;
+}
+
+const std::vector<BoundingBox>& RenderItem::GetInstanceBounds() const
+{
+	return m_instanceBounds;
 }
 
 D3D12_VERTEX_BUFFER_VIEW Mesh::GetVBOView() const
@@ -5,10 +5,12 @@
 #include <d3d12.h>
 #include <dxgi1_6.h>
 #include <unordered_map>
+#include <DirectXCollision.h>
 #include "D3DUtil.hpp"
 #include "Material.h"
 #include "Vertex.h"
 #include "Transform.h"
+#include "TransformStore.h"
 
 class Mesh;
 using namespace std;
@@ -25,13 +27,17 @@ struct RenderItem : public Item
 {
 public:
 	RenderItem() = default;
-	std::vector<std::shared_ptr<Transform>>	transformPack;
+	// ʵı任TransformStoreУ[m_transformStart, m_transformStart + m_transformCount)ΪȾʵ
+	UINT									m_transformStart{ 0 };
+	UINT									m_transformCount{ 0 };
 	D3D12_PRIMITIVE_TOPOLOGY				m_topologyType{ D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST };
 	// ʶʾѾı䣬ҪжӦĳ
 	// ָGPUӦڵǰȾ峣
 	Mesh*									m_mesh{ nullptr};
 	UINT									m_matIndex;
 	BlendType								m_type;
+	// ̬Ӱᱻ棬̬ƶҪCascadedShadow::InvalidateCache
+	bool									m_isStatic{ false };
 	// DrawIndexedInstancedķ
 	UINT									instanceStart{ 0 };
 	UINT									eboCount{ 0 };
@@ -41,48 +47,50 @@ public:
 	template <typename... Args, std::enable_if_t<sizeof...(Args) <= 3 && (is_same_v<decltype(Transform::m_scale), Args>, ...)>* = nullptr>
 	void EmplaceBack(Args&&... args)
 	{
-		instanceCount++;
-		auto& form = transformPack.emplace_back(std::make_shared<Transform>());
-		auto list = std::make_tuple(std::forward<Args>(args)...);
-		if constexpr (sizeof...(args) == 1)
-		{
-			form->m_position = std::get<0>(list);
-		} else if constexpr (sizeof...(args) == 2)
-		{
-			form->m_position = std::get<0>(list);
-			form->m_scale = std::get<1>(list);
-		} else if constexpr (sizeof...(args) == 3)
-		{
-			form->m_position = std::get<0>(list);
-			form->m_scale = std::get<1>(list);
-			form->m_rotation = std::get<2>(list);
-		}
+		EmplaceBack();
+		SetParameters(m_transformCount - 1, std::forward<Args>(args)...);
 	}
 	void EmplaceBack()
 	{
 		instanceCount++;
-		transformPack.emplace_back(std::make_shared<Transform>());
+		m_transformStart = TransformStore::instance().Grow(m_transformStart, m_transformCount);
+		m_transformCount++;
 	}
 	template <typename... Args, std::enable_if_t<sizeof...(Args) <= 3 && (is_same_v<decltype(Transform::m_scale), Args>, ...)>* = nullptr>
 	void SetParameters(UINT pos, Args&&... args) // (1) posV (2) scale (3) rotation
 	{
-		const auto& form = transformPack[pos];
+		auto& store = TransformStore::instance();
+		const UINT idx = m_transformStart + pos;
 		auto list = std::make_tuple(std::forward<Args>(args)...);
-		if constexpr (sizeof...(args) == 1)
+		if constexpr (sizeof...(args) >= 1)
 		{
-			form->m_position = std::get<0>(list);
-		} else if constexpr (sizeof...(args) == 2)
+			store.SetPosition(idx, std::get<0>(list));
+		}
+		if constexpr (sizeof...(args) >= 2)
 		{
-			form->m_position = std::get<0>(list);
-			form->m_scale = std::get<1>(list);
-		} else if constexpr (sizeof...(args) == 3)
+			store.SetScale(idx, std::get<1>(list));
+		}
+		if constexpr (sizeof...(args) == 3)
 		{
-			form->m_position = std::get<0>(list);
-			form->m_scale = std::get<1>(list);
-			form->m_rotation = std::get<2>(list);
+			store.SetRotation(idx, std::get<2>(list));
 		}
 	}
+	void SetScale(UINT pos, const XMFLOAT3& scale);
+	Transform GetTransform(UINT pos) const;
 	UINT GetInstanceSize() const;
+	// ģͿռµİΧУδðΧеȾ޳
+	void SetLocalBounds(const BoundingBox& bounds);
+	bool HasBounds() const;
+	// ʵռΧеĲ
+	const BoundingBox& GetWorldBounds() const;
+	const std::vector<BoundingBox>& GetInstanceBounds() const;
+private:
+	// һдʵƫƣƫƱ仯ʱҪϴȫʵ
+	UINT									m_lastOffset{ UINT_MAX };
+	bool									m_hasBounds{ false };
+	BoundingBox								m_localBounds;
+	BoundingBox								m_worldBounds;
+	std::vector<BoundingBox>				m_instanceBounds;
 };
 
 struct Submesh
@@ -0,0 +1,265 @@
+#include "MeshCache.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <type_traits>
+#include "MappedFile.h"
+
+using namespace Models;
+
+namespace
+{
+static_assert(std::is_trivially_copyable_v<Vertex_CPU>, "Vertex_CPUҪܹ鿽");
+static_assert(sizeof(Vertex_CPU) == sizeof(float) * 14, "Vertex_CPUֱ仯ʱҪ汾");
+
+struct CacheHeader
+{
+	uint32_t	magic;
+	uint32_t	version;
+	uint64_t	sourceHash;
+	uint32_t	materialCount;
+	uint32_t	meshCount;
+};
+
+// ÿļռõֽ(ַΪʱ)ڷǰļͷе
+constexpr size_t minMaterialSize = sizeof(uint32_t) * 4;
+constexpr size_t minMeshSize = sizeof(uint32_t) + sizeof(uint32_t) * 3 + sizeof(DirectX::XMFLOAT3) * 2 + sizeof(uint32_t) * 2;
+
+/*
+ * ӳڴ˳ȡκԽ綼ʹȡʧܣ𻵵Ļ浼±
+ */
+class CacheReader
+{
+public:
+	CacheReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+	bool Read(void* dst, size_t size)
+	{
+		if (size > m_size - m_offset)
+			return false;
+		memcpy(dst, m_data + m_offset, size);
+		m_offset += size;
+		return true;
+	}
+	template <typename T>
+	bool Read(T& value)
+	{
+		return Read(&value, sizeof(T));
+	}
+	bool ReadString(std::string& str)
+	{
+		uint32_t length;
+		if (!Read(length) || length > m_size - m_offset)
+			return false;
+		str.assign(reinterpret_cast<const char*>(m_data + m_offset), length);
+		m_offset += length;
+		return true;
+	}
+	template <typename T>
+	bool ReadArray(std::vector<T>& arr)
+	{
+		uint32_t count;
+		if (!Read(count) || count > (m_size - m_offset) / sizeof(T))
+			return false;
+		arr.resize(count);
+		return Read(arr.data(), sizeof(T) * count);
+	}
+	size_t Remaining() const
+	{
+		return m_size - m_offset;
+	}
+	bool AtEnd() const
+	{
+		return m_offset == m_size;
+	}
+private:
+	const uint8_t*	m_data;
+	size_t			m_size;
+	size_t			m_offset{ 0 };
+};
+
+class CacheWriter
+{
+public:
+	explicit CacheWriter(std::ofstream& stream) : m_stream(stream) {}
+
+	template <typename T>
+	void Write(const T& value)
+	{
+		m_stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+	void WriteString(const std::string& str)
+	{
+		Write(static_cast<uint32_t>(str.size()));
+		m_stream.write(str.data(), static_cast<std::streamsize>(str.size()));
+	}
+	template <typename T>
+	void WriteArray(const std::vector<T>& arr)
+	{
+		Write(static_cast<uint32_t>(arr.size()));
+		m_stream.write(reinterpret_cast<const char*>(arr.data()), static_cast<std::streamsize>(sizeof(T) * arr.size()));
+	}
+private:
+	std::ofstream& m_stream;
+};
+}
+
+uint64_t MeshCache::Hash(const void* data, size_t size, uint64_t seed)
+{
+	const auto bytes = static_cast<const uint8_t*>(data);
+	uint64_t hash = seed;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= fnvPrime;
+	}
+	return hash;
+}
+
+bool MeshCache::HashSource(const std::filesystem::path& source, uint32_t importFlags, uint64_t& hash)
+{
+	const MappedFile file(source);
+	if (!file.IsOpen())
+		return false;
+	hash = Hash(file.GetData(), file.GetSize());
+	std::string extension = source.extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	if (extension == ".obj")
+	{
+		hash = HashMaterialLibraries(source, file.GetData(), file.GetSize(), hash);
+	}
+	hash = Hash(&importFlags, sizeof(importFlags), hash);
+	return true;
+}
+
+uint64_t MeshCache::HashMaterialLibraries(const std::filesystem::path& source, const uint8_t* data, size_t size, uint64_t hash)
+{
+	const std::string_view text(reinterpret_cast<const char*>(data), size);
+	constexpr std::string_view keyword = "mtllib";
+	size_t lineStart = 0;
+	while (lineStart < text.size())
+	{
+		size_t lineEnd = text.find('\n', lineStart);
+		if (lineEnd == std::string_view::npos)
+			lineEnd = text.size();
+		std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+		const size_t first = line.find_first_not_of(" \t");
+		if (first == std::string_view::npos || line.compare(first, keyword.size(), keyword) != 0)
+			continue;
+		line.remove_prefix(first + keyword.size());
+		if (!line.empty() && line.front() != ' ' && line.front() != '\t')
+			continue;
+		// һmtlliböԿհ׷ָļ
+		size_t nameStart = line.find_first_not_of(" \t\r");
+		while (nameStart != std::string_view::npos)
+		{
+			size_t nameEnd = line.find_first_of(" \t\r", nameStart);
+			if (nameEnd == std::string_view::npos)
+				nameEnd = line.size();
+			const std::string_view name = line.substr(nameStart, nameEnd - nameStart);
+			hash = Hash(name.data(), name.size(), hash);
+			const MappedFile library(source.parent_path() / std::filesystem::path(name));
+			if (library.IsOpen())
+			{
+				hash = Hash(library.GetData(), library.GetSize(), hash);
+			}
+			nameStart = line.find_first_not_of(" \t\r", nameEnd);
+		}
+	}
+	return hash;
+}
+
+std::filesystem::path MeshCache::GetCachePath(const std::filesystem::path& source)
+{
+	std::filesystem::path cache(source);
+	cache += ".meshcache";
+	return cache;
+}
+
+bool MeshCache::Load(const std::filesystem::path& cachePath, uint64_t sourceHash, MeshCacheData& data)
+{
+	const MappedFile file(cachePath);
+	if (!file.IsOpen())
+		return false;
+	CacheReader reader(file.GetData(), file.GetSize());
+	CacheHeader header;
+	if (!reader.Read(header) || header.magic != magic || header.version != version || header.sourceHash != sourceHash)
+		return false;
+
+	// ļǰȷʣֽɣ𻵵ļͷ¾޴ķ
+	if (header.materialCount > reader.Remaining() / minMaterialSize ||
+		header.meshCount > (reader.Remaining() - static_cast<size_t>(header.materialCount) * minMaterialSize) / minMeshSize)
+		return false;
+	MeshCacheData result;
+	result.materials.resize(header.materialCount);
+	for (auto& mat : result.materials)
+	{
+		if (!reader.ReadString(mat.name))
+			return false;
+		for (auto& tex : mat.textures)
+		{
+			if (!reader.ReadString(tex))
+				return false;
+		}
+	}
+	result.meshes.resize(header.meshCount);
+	for (auto& mesh : result.meshes)
+	{
+		if (!reader.ReadString(mesh.materialName) ||
+			!reader.Read(mesh.vboStart) || !reader.Read(mesh.eboStart) || !reader.Read(mesh.eboCount) ||
+			!reader.Read(mesh.bounds.Center) || !reader.Read(mesh.bounds.Extents) ||
+			!reader.ReadArray(mesh.vertices) || !reader.ReadArray(mesh.indices))
+			return false;
+	}
+	if (!reader.AtEnd())
+		return false;
+	data = std::move(result);
+	return true;
+}
+
+bool MeshCache::Save(const std::filesystem::path& cachePath, uint64_t sourceHash, const MeshCacheData& data)
+{
+	// дʱļ滻джʱ²Ļ
+	std::filesystem::path tempPath(cachePath);
+	tempPath += ".tmp";
+	{
+		std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+		if (!stream)
+			return false;
+		CacheWriter writer(stream);
+		CacheHeader header{ magic, version, sourceHash, static_cast<uint32_t>(data.materials.size()), static_cast<uint32_t>(data.meshes.size()) };
+		writer.Write(header);
+		for (const auto& mat : data.materials)
+		{
+			writer.WriteString(mat.name);
+			for (const auto& tex : mat.textures)
+			{
+				writer.WriteString(tex);
+			}
+		}
+		for (const auto& mesh : data.meshes)
+		{
+			writer.WriteString(mesh.materialName);
+			writer.Write(mesh.vboStart);
+			writer.Write(mesh.eboStart);
+			writer.Write(mesh.eboCount);
+			writer.Write(mesh.bounds.Center);
+			writer.Write(mesh.bounds.Extents);
+			writer.WriteArray(mesh.vertices);
+			writer.WriteArray(mesh.indices);
+		}
+		if (!stream)
+			return false;
+	}
+	std::error_code error;
+	std::filesystem::rename(tempPath, cachePath, error);
+	if (error)
+	{
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <DirectXCollision.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "VertexFormat.h"
+
+namespace Models
+{
+/*
+ * ģݣassimpĽҲǻļ
+ */
+struct CachedMaterial
+{
+	std::string	name;
+	std::string	textures[3];	// diffusespecularambient·ûʱΪ
+};
+struct CachedMesh
+{
+	std::string				materialName;
+	uint32_t				vboStart{ 0 };
+	uint32_t				eboStart{ 0 };
+	uint32_t				eboCount{ 0 };
+	DirectX::BoundingBox	bounds;
+	std::vector<Vertex_CPU>	vertices;
+	std::vector<uint32_t>	indices;
+};
+struct MeshCacheData
+{
+	std::vector<CachedMaterial>	materials;
+	std::vector<CachedMesh>		meshes;
+};
+
+/*
+ * 񻺴
+ * ļͷ¼ʽ汾Դļ(objõmtlʿ)FNV-1aϣһһ¼ΪڣҪµ
+ * ȡʱͨڴӳʻļֱ鿽
+ */
+class MeshCache
+{
+public:
+	static constexpr uint32_t	magic = 0x4348534D; // "MSHC"
+	static constexpr uint32_t	version = 1;
+
+	// FNV-1a 64λϣseedڴ
+	static uint64_t Hash(const void* data, size_t size, uint64_t seed = fnvOffset);
+	// Դļݡobjõmtlļ뵼ͬǷЧ
+	static bool HashSource(const std::filesystem::path& source, uint32_t importFlags, uint64_t& hash);
+	static std::filesystem::path GetCachePath(const std::filesystem::path& source);
+	static bool Load(const std::filesystem::path& cachePath, uint64_t sourceHash, MeshCacheData& data);
+	static bool Save(const std::filesystem::path& cachePath, uint64_t sourceHash, const MeshCacheData& data);
+private:
+	// ιϣobjmtllibõļļݣļʱֻϣļ
+	static uint64_t HashMaterialLibraries(const std::filesystem::path& source, const uint8_t* data, size_t size, uint64_t hash);
+private:
+	static constexpr uint64_t	fnvOffset = 14695981039346656037ULL;
+	static constexpr uint64_t	fnvPrime = 1099511628211ULL;
+};
+}
@@ -1,16 +1,45 @@
 #include "ObjLoader.h"
 #include <iostream>
-#include <assimp/postprocess.h>
-#include <assimp/Importer.hpp>
 #include <filesystem>
 
 #include "Scene.h"
+#include "SceneImporter.h"
+#include "ThreadPool.hpp"
 
 using namespace Models;
-using namespace Assimp;
 
 const std::string_view Models::ModelPath = "Resources/Models/";
 
+const BVH& Model::GetTriangleBVH()
+{
+	// ֻ߲ѯҪBVH(л)ʱٹ
+	std::call_once(triangleBVHBuilt, [this]()
+	{
+		std::vector<XMFLOAT3> positions;
+		std::vector<uint32_t> indices;
+		if (!submesh.empty())
+		{
+			const auto& last = submesh.back();
+			positions.reserve(last.vboStart + meshData.back().VBOs.size());
+			indices.reserve(static_cast<size_t>(last.eboStart) + last.eboCount);
+		}
+		for (const auto& mesh : meshData)
+		{
+			const auto base = static_cast<uint32_t>(positions.size());
+			for (const auto& vbo : mesh.VBOs)
+			{
+				positions.emplace_back(vbo.pos);
+			}
+			for (const auto ebo : mesh.EBOs)
+			{
+				indices.emplace_back(base + ebo);
+			}
+		}
+		triangleBVH.BuildTriangles(positions, indices);
+	});
+	return triangleBVH;
+}
+
 void ObjLoader::Init(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList)
 {
 	m_device = device;
@@ -22,17 +51,28 @@ bool ObjLoader::CreateObjFromFile(std::string_view fileName)
 	HashID id = StringToID(fileName);
 	if (m_models.count(id))
 		return true;
-	Importer importer;
 	string fullName(ModelPath);
 	fullName.append(fileName);
-	const aiScene* scene = importer.ReadFile(fullName, aiProcess_ConvertToLeftHanded | aiProcess_Triangulate | aiProcess_ImproveCacheLocality | aiProcess_CalcTangentSpace | aiProcess_GenSmoothNormals);
-	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE | !scene->mRootNode)
+	// ԴļĹϣһʱassimp
+	MeshCacheData data;
+	uint64_t sourceHash = 0;
+	const bool hashed = MeshCache::HashSource(fullName, SceneImporter::importFlags, sourceHash);
+	const auto cachePath = MeshCache::GetCachePath(fullName);
+	if (!hashed || !MeshCache::Load(cachePath, sourceHash, data))
 	{
-		std::cout << "ERROR::ASSIMP::" << importer.GetErrorString() << std::endl;
-		return false;
+		std::string error;
+		if (!SceneImporter::Import(fullName, data, error))
+		{
+			std::cout << "ERROR::ASSIMP::" << error << std::endl;
+			return false;
+		}
+		if (hashed && !MeshCache::Save(cachePath, sourceHash, data))
+		{
+			std::cout << "WARNING::MESHCACHE::failed to write " << cachePath.string() << std::endl;
+		}
 	}
 	m_models[id] = std::make_shared<Model>();
-	ProcessNode(scene->mRootNode, scene, fileName);
+	BuildModel(data, fileName);
 	return true;
 }
 
@@ -66,102 +106,81 @@ void ObjLoader::UpdateAllModels(const GameTimer& timer, UploaderBuffer<MaterialC
 	}
 }
 
-void ObjLoader::ProcessNode(aiNode* node, const aiScene* scene, std::string_view fileName)
+void ObjLoader::BuildModel(MeshCacheData& data, std::string_view fileName)
 {
 	const HashID id = StringToID(fileName);
-	m_models[id]->meshData.resize(scene->mNumMeshes);
-	m_models[id]->submesh.resize(scene->mNumMeshes);
-	UINT vboOffset = 0;
-	UINT eboOffset = 0;
-	// 
-	for (UINT i = 0; i < scene->mNumMaterials; ++i)
+	auto& model = m_models[id];
+	for (const auto& mat : data.materials)
 	{
-		const auto& mat = scene->mMaterials[i];
-		std::unique_ptr<MaterialData> data = make_unique<MaterialData>();
-		data->type = BlendType::opaque;
-		data->materialCBIndex = Material::GetMatIndex();
-		data->name = mat->GetName().C_Str();
-		data->diffuseIndex = LoadMaterialTextures(mat, aiTextureType_DIFFUSE, fileName, i);
-		data->metalnessIndex = LoadMaterialTextures(mat, aiTextureType_SPECULAR, fileName, i);
-		data->normalIndex = LoadMaterialTextures(mat, aiTextureType_AMBIENT, fileName, i);
-		m_models[id]->objMat->CreateMaterial(std::move(data));
+		std::unique_ptr<MaterialData> matData = make_unique<MaterialData>();
+		matData->type = BlendType::opaque;
+		matData->materialCBIndex = Material::GetMatIndex();
+		matData->name = mat.name;
+		matData->diffuseIndex = LoadMaterialTexture(mat.textures[0], fileName);
+		matData->metalnessIndex = LoadMaterialTexture(mat.textures[1], fileName);
+		matData->normalIndex = LoadMaterialTexture(mat.textures[2], fileName);
+		model->objMat->CreateMaterial(std::move(matData));
 	}
 
-	// ڵе
-	for (UINT i = 0; i < scene->mNumMeshes; ++i)
+	const UINT meshCount = static_cast<UINT>(data.meshes.size());
+	model->meshData.resize(meshCount);
+	model->submesh.resize(meshCount);
+	for (UINT i = 0; i < meshCount; ++i)
 	{
-		aiMesh* mesh = scene->mMeshes[i];
-		m_models[id]->submesh[i].materialName = scene->mMaterials[mesh->mMaterialIndex]->GetName().C_Str();
-		m_models[id]->submesh[i].vboStart = vboOffset;
-		m_models[id]->submesh[i].eboStart = eboOffset;
-		m_models[id]->submesh[i].eboCount = mesh->mNumFaces * 3;
-		ProcessMesh(mesh, scene, fileName, i);
-		vboOffset += mesh->mNumVertices;
-		eboOffset += mesh->mNumFaces * 3;
-		BoundingBox box;
-		box.CreateFromPoints(box, mesh->mNumVertices, reinterpret_cast<const XMFLOAT3*>(mesh->mVertices), sizeof(XMFLOAT3));
-		if (i == 0)
-		{
-			Scene::sceneBox = std::move(box);
-			BoundingSphere::CreateFromBoundingBox(Scene::sceneBound, box);
-		} else
-		{
-			BoundingBox::CreateMerged(Scene::sceneBox, Scene::sceneBox, box);
-			BoundingSphere temp;
-			BoundingSphere::CreateFromBoundingBox(temp, box);
-			BoundingSphere::CreateMerged(Scene::sceneBound, Scene::sceneBound, temp);
-		}
+		auto& cached = data.meshes[i];
+		auto& sub = model->submesh[i];
+		sub.materialName = std::move(cached.materialName);
+		sub.vboStart = cached.vboStart;
+		sub.eboStart = cached.eboStart;
+		sub.eboCount = cached.eboCount;
+		sub.bounds = cached.bounds;
+		model->meshData[i].VBOs = std::move(cached.vertices);
+		model->meshData[i].EBOs = std::move(cached.indices);
 	}
-}
 
-void ObjLoader::ProcessMesh(const aiMesh* mesh, const aiScene* scene, std::string_view fileName, UINT idx)
-{
-	HashID id = StringToID(fileName);
-	auto& vbos = m_models[id]->meshData[idx].VBOs;
-	vbos.reserve(mesh->mNumVertices);
-	auto& ebos = m_models[id]->meshData[idx].EBOs;
-	ebos.reserve(3LL * mesh->mNumFaces);
-	// λ
-	for (UINT i = 0; i < mesh->mNumVertices; ++i)
+	// йԼΧ壺ÿȺϲ䣬ٰ˳ϲϲ˳̶˽ȷ
+	if (meshCount > 0)
 	{
-		vbos.emplace_back(Vertex_CPU{});
-		// λáߡ
-		vbos[i].pos = { mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z};
-		vbos[i].normal = { mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z };
-		vbos[i].tangent = { mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z };
-		vbos[i].bitangent = { mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z };
-		mesh->mTextureCoords[0] ? vbos[i].tex = { mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y } : vbos[i].tex = { 0.0f, 0.0f };
-	}
-	// EBO
-	for (UINT i = 0; i < mesh->mNumFaces; ++i)
-	{
-		aiFace face = mesh->mFaces[i];
-		for (UINT j = 0; j < face.mNumIndices; ++j)
+		constexpr UINT grain = 16;
+		const UINT chunkCount = (meshCount + grain - 1) / grain;
+		std::vector<BoundingBox> chunkBoxes(chunkCount);
+		std::vector<BoundingSphere> chunkSpheres(chunkCount);
+		Thread::ThreadPool::instance().ParallelFor(0, meshCount, grain, [&](UINT begin, UINT end)
+		{
+			const UINT chunk = begin / grain;
+			BoundingBox box = model->submesh[begin].bounds;
+			BoundingSphere sphere;
+			BoundingSphere::CreateFromBoundingBox(sphere, box);
+			for (UINT i = begin + 1; i < end; ++i)
+			{
+				const BoundingBox& subBox = model->submesh[i].bounds;
+				BoundingBox::CreateMerged(box, box, subBox);
+				BoundingSphere temp;
+				BoundingSphere::CreateFromBoundingBox(temp, subBox);
+				BoundingSphere::CreateMerged(sphere, sphere, temp);
+			}
+			chunkBoxes[chunk] = box;
+			chunkSpheres[chunk] = sphere;
+		});
+		Scene::sceneBox = chunkBoxes[0];
+		Scene::sceneBound = chunkSpheres[0];
+		for (UINT chunk = 1; chunk < chunkCount; ++chunk)
 		{
-			ebos.emplace_back(face.mIndices[j]);
+			BoundingBox::CreateMerged(Scene::sceneBox, Scene::sceneBox, chunkBoxes[chunk]);
+			BoundingSphere::CreateMerged(Scene::sceneBound, Scene::sceneBound, chunkSpheres[chunk]);
 		}
 	}
 }
 
-UINT ObjLoader::LoadMaterialTextures(aiMaterial* mat, aiTextureType type, std::string_view fileName, UINT idx)
+UINT ObjLoader::LoadMaterialTexture(const std::string& texName, std::string_view fileName)
 {
-	HashID id = StringToID(fileName);
+	if (texName.empty())
+		return 0;
 	string fullPath(ModelPath);
 	fullPath.append(fileName);
 	const filesystem::path myPath(fullPath);
-	aiString aiPath;
-	if (mat->GetTextureCount(type) > 0)
-	{
-		mat->GetTexture(type, 0, &aiPath);
-		filesystem::path tex = myPath.parent_path() / aiPath.C_Str();
-		if (type == aiTextureType_DIFFUSE)
-			return TextureMgr::instance().InsertDDSTexture(aiPath.C_Str(), tex.wstring());
-		if (type == aiTextureType_SPECULAR)
-			return TextureMgr::instance().InsertDDSTexture(aiPath.C_Str(), tex.wstring());
-		if (type == aiTextureType_AMBIENT)
-			return TextureMgr::instance().InsertDDSTexture(aiPath.C_Str(), tex.wstring());
-	}
-	return 0;
+	const filesystem::path tex = myPath.parent_path() / texName;
+	return TextureMgr::instance().InsertDDSTexture(texName, tex.wstring());
 }
 
 Models::ObjLoader::ObjLoader(Singleton<ObjLoader>::Token) : Singleton<Models::ObjLoader>(), m_modelMesh(std::make_unique<Mesh>())
@@ -1,13 +1,15 @@
 #pragma once
 
 #include <d3d12.h>
-#include <assimp/material.h>
-#include <assimp/scene.h>
+#include <DirectXCollision.h>
 #include <wrl/client.h>
+#include <mutex>
 #include "Mesh.h"
 #include "Material.h"
 #include "D3DUtil.hpp"
 #include "Texture.h"
+#include "BVH.h"
+#include "MeshCache.h"
 
 namespace Models
 {
@@ -16,6 +18,7 @@ struct SubAdvMesh : Submesh
 	std::string materialName;
 	UINT faceStart{ 0 };
 	UINT faceCount{ 0 };
+	BoundingBox bounds;	// ģͿռµİΧ
 };
 struct AdvMeshData : BaseMeshData
 {
@@ -33,6 +36,11 @@ struct Model
 	vector<AdvMeshData>			meshData;
 	std::unique_ptr<Material>	objMat;
 	Model() : objMat(std::make_unique<Material>()) {  }
+	// ģͿռεBVHͼԪΪȫţʰȡ߲ѯ״εʱŹ
+	const BVH& GetTriangleBVH();
+private:
+	BVH							triangleBVH;
+	std::once_flag				triangleBVHBuilt;
 };
 using Microsoft::WRL::ComPtr;
 extern const std::string_view ModelPath;
@@ -55,9 +63,9 @@ public:
 	void UpdateAllModels(const GameTimer& timer, UploaderBuffer<MaterialConstant>* currMatConstant);
 	~ObjLoader() override = default;
 private:
-	void ProcessNode(aiNode* node, const aiScene* scene, std::string_view fileName);
-	void ProcessMesh(const aiMesh* mesh, const aiScene* scene, std::string_view fileName, UINT idx);
-	UINT LoadMaterialTextures(aiMaterial* mat, aiTextureType type, std::string_view fileName, UINT idx);
+	// мݴʡ
+	void BuildModel(MeshCacheData& data, std::string_view fileName);
+	UINT LoadMaterialTexture(const std::string& texName, std::string_view fileName);
 private:
 	ComPtr<ID3D12Device>							m_device;
 	ComPtr<ID3D12GraphicsCommandList>				m_cmdList;
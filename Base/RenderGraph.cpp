@@ -0,0 +1,441 @@
+#include "RenderGraph.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+
+namespace
+{
+constexpr RenderGraph::PassHandle externalWriter = ~0u;
+}
+
+void RenderGraph::Reset()
+{
+	m_resources.clear();
+	m_passes.clear();
+	m_order.clear();
+	m_barriers.clear();
+	m_finalBarriers.clear();
+	m_planner.Reset();
+	m_compiled = false;
+}
+
+RenderGraph::ResourceHandle RenderGraph::ImportResource(const std::string& name, void* native, uint32_t initialState, uint32_t finalState)
+{
+	Resource resource;
+	resource.name = name;
+	resource.native = native;
+	resource.initialState = initialState;
+	resource.finalState = finalState;
+	resource.imported = true;
+	resource.writers.push_back(externalWriter);
+	m_resources.push_back(std::move(resource));
+	m_compiled = false;
+	return static_cast<ResourceHandle>(m_resources.size() - 1);
+}
+
+RenderGraph::ResourceHandle RenderGraph::DeclareVirtual(const std::string& name)
+{
+	Resource resource;
+	resource.name = name;
+	resource.writers.push_back(externalWriter);
+	m_resources.push_back(std::move(resource));
+	m_compiled = false;
+	return static_cast<ResourceHandle>(m_resources.size() - 1);
+}
+
+RenderGraph::ResourceHandle RenderGraph::DeclareTransient(const std::string& name, uint64_t size, uint64_t alignment, TransientHeapType heapType)
+{
+	const ResourceHandle handle = DeclareVirtual(name);
+	Resource& resource = m_resources[handle];
+	resource.transient = true;
+	resource.size = size;
+	resource.alignment = alignment;
+	resource.heapType = heapType;
+	return handle;
+}
+
+RenderGraph::PassHandle RenderGraph::AddPass(const std::string& name, std::function<void()> execute)
+{
+	Pass pass;
+	pass.name = name;
+	pass.execute = std::move(execute);
+	m_passes.push_back(std::move(pass));
+	m_compiled = false;
+	return static_cast<PassHandle>(m_passes.size() - 1);
+}
+
+void RenderGraph::Read(PassHandle pass, ResourceHandle resource, uint32_t state)
+{
+	if (Access* access = FindAccess(pass, resource))
+	{
+		if (access->write)
+			throw std::runtime_error("RenderGraph: pass " + m_passes[pass].name + " reads and writes " + m_resources[resource].name);
+		access->state |= state;
+		return;
+	}
+	const uint32_t version = static_cast<uint32_t>(m_resources[resource].writers.size() - 1);
+	m_passes[pass].accesses.push_back({ resource, state, false, version });
+	m_compiled = false;
+}
+
+void RenderGraph::Write(PassHandle pass, ResourceHandle resource, uint32_t state)
+{
+	if (FindAccess(pass, resource))
+		throw std::runtime_error("RenderGraph: pass " + m_passes[pass].name + " accesses " + m_resources[resource].name + " more than once with a write");
+	auto& writers = m_resources[resource].writers;
+	writers.push_back(pass);
+	m_passes[pass].accesses.push_back({ resource, state, true, static_cast<uint32_t>(writers.size() - 1) });
+	m_compiled = false;
+}
+
+void RenderGraph::SetSideEffect(PassHandle pass)
+{
+	m_passes[pass].sideEffect = true;
+	m_compiled = false;
+}
+
+void RenderGraph::Compile()
+{
+	CullPasses();
+	SortPasses();
+	PlaceBarriers();
+	PlanAliasing();
+	m_compiled = true;
+}
+
+void RenderGraph::Execute(RenderGraphBackend& backend) const
+{
+	if (!m_compiled)
+		throw std::runtime_error("RenderGraph: Execute before Compile");
+	for (size_t orderIdx = 0; orderIdx < m_order.size(); ++orderIdx)
+	{
+		const auto& barriers = m_barriers[orderIdx];
+		if (!barriers.empty())
+			backend.SubmitBarriers(barriers.data(), static_cast<uint32_t>(barriers.size()));
+		const Pass& pass = m_passes[m_order[orderIdx]];
+		backend.BeginPass(pass.name);
+		if (pass.execute)
+			pass.execute();
+		backend.EndPass();
+	}
+	if (!m_finalBarriers.empty())
+		backend.SubmitBarriers(m_finalBarriers.data(), static_cast<uint32_t>(m_finalBarriers.size()));
+}
+
+const std::vector<RenderGraph::PassHandle>& RenderGraph::GetExecutionOrder() const
+{
+	return m_order;
+}
+
+bool RenderGraph::IsCulled(PassHandle pass) const
+{
+	return m_passes[pass].culled;
+}
+
+const std::vector<GraphBarrier>& RenderGraph::GetBarriers(uint32_t orderIdx) const
+{
+	return m_barriers[orderIdx];
+}
+
+const std::vector<GraphBarrier>& RenderGraph::GetFinalBarriers() const
+{
+	return m_finalBarriers;
+}
+
+uint32_t RenderGraph::GetBarrierCount() const
+{
+	size_t count = m_finalBarriers.size();
+	for (const auto& barriers : m_barriers)
+	{
+		count += barriers.size();
+	}
+	return static_cast<uint32_t>(count);
+}
+
+const std::string& RenderGraph::GetPassName(PassHandle pass) const
+{
+	return m_passes[pass].name;
+}
+
+const std::string& RenderGraph::GetResourceName(ResourceHandle resource) const
+{
+	return m_resources[resource].name;
+}
+
+void* RenderGraph::GetNative(ResourceHandle resource) const
+{
+	return m_resources[resource].native;
+}
+
+void RenderGraph::SetNative(ResourceHandle resource, void* native)
+{
+	m_resources[resource].native = native;
+}
+
+bool RenderGraph::IsPlaced(ResourceHandle resource) const
+{
+	return m_resources[resource].planIdx != notPlaced;
+}
+
+const TransientPlacement& RenderGraph::GetPlacement(ResourceHandle resource) const
+{
+	if (!IsPlaced(resource))
+		throw std::runtime_error("RenderGraph: " + m_resources[resource].name + " has no transient placement");
+	return m_planner.GetPlacement(m_resources[resource].planIdx);
+}
+
+const AliasingPlanner& RenderGraph::GetAliasingPlanner() const
+{
+	return m_planner;
+}
+
+void RenderGraph::CullPasses()
+{
+	// ָpassһμɴӱʹõİ汾ݵҪд
+	std::vector<std::vector<bool>> needed(m_resources.size());
+	for (size_t idx = 0; idx < m_resources.size(); ++idx)
+	{
+		needed[idx].assign(m_resources[idx].writers.size(), false);
+		if (m_resources[idx].imported)
+			needed[idx].back() = true;
+	}
+	for (size_t idx = m_passes.size(); idx-- > 0;)
+	{
+		Pass& pass = m_passes[idx];
+		bool alive = pass.sideEffect;
+		for (const auto& access : pass.accesses)
+		{
+			alive = alive || (access.write && needed[access.resource][access.version]);
+		}
+		pass.culled = !alive;
+		if (!alive)
+			continue;
+		for (const auto& access : pass.accesses)
+		{
+			needed[access.resource][access.write ? access.version - 1 : access.version] = true;
+		}
+	}
+}
+
+void RenderGraph::SortPasses()
+{
+	// дддд
+	const size_t passCount = m_passes.size();
+	std::vector<std::vector<PassHandle>> successors(passCount);
+	std::vector<uint32_t> inDegree(passCount, 0);
+	const auto AddEdge = [&successors, &inDegree](PassHandle from, PassHandle to)
+	{
+		successors[from].push_back(to);
+		++inDegree[to];
+	};
+	for (ResourceHandle resource = 0; resource < m_resources.size(); ++resource)
+	{
+		PassHandle lastWriter = externalWriter;
+		std::vector<PassHandle> readers;
+		for (PassHandle pass = 0; pass < passCount; ++pass)
+		{
+			if (m_passes[pass].culled)
+				continue;
+			const Access* access = FindAccess(pass, resource);
+			if (!access)
+				continue;
+			if (lastWriter != externalWriter)
+				AddEdge(lastWriter, pass);
+			if (access->write)
+			{
+				for (const PassHandle reader : readers)
+				{
+					AddEdge(reader, pass);
+				}
+				readers.clear();
+				lastWriter = pass;
+			}
+			else
+			{
+				readers.push_back(pass);
+			}
+		}
+	}
+
+	std::priority_queue<PassHandle, std::vector<PassHandle>, std::greater<>> ready;
+	size_t aliveCount = 0;
+	for (PassHandle pass = 0; pass < passCount; ++pass)
+	{
+		if (m_passes[pass].culled)
+			continue;
+		++aliveCount;
+		if (inDegree[pass] == 0)
+			ready.push(pass);
+	}
+	m_order.clear();
+	while (!ready.empty())
+	{
+		const PassHandle pass = ready.top();
+		ready.pop();
+		m_order.push_back(pass);
+		for (const PassHandle next : successors[pass])
+		{
+			if (--inDegree[next] == 0)
+				ready.push(next);
+		}
+	}
+	if (m_order.size() != aliveCount)
+		throw std::runtime_error("RenderGraph: dependency cycle");
+}
+
+void RenderGraph::PlaceBarriers()
+{
+	const uint32_t orderCount = static_cast<uint32_t>(m_order.size());
+	m_barriers.assign(orderCount, {});
+	m_finalBarriers.clear();
+	// positionorderCountʱpass֮
+	const auto Place = [this, orderCount](uint32_t position, const GraphBarrier& barrier)
+	{
+		(position < orderCount ? m_barriers[position] : m_finalBarriers).push_back(barrier);
+	};
+	// lastOrderΪ-1ʱԴ֡ڻδʣתԴ֡ʼʱ
+	const auto Transition = [&Place](ResourceHandle resource, uint32_t before, uint32_t after, int32_t lastOrder, uint32_t position)
+	{
+		const uint32_t beginPosition = static_cast<uint32_t>(lastOrder + 1);
+		if (beginPosition < position)
+		{
+			Place(beginPosition, { GraphBarrierType::transition, GraphBarrierSplit::begin, resource, before, after });
+			Place(position, { GraphBarrierType::transition, GraphBarrierSplit::end, resource, before, after });
+		}
+		else
+		{
+			Place(position, { GraphBarrierType::transition, GraphBarrierSplit::none, resource, before, after });
+		}
+	};
+
+	struct Use
+	{
+		uint32_t	order;
+		uint32_t	state;
+		bool		write;
+	};
+	std::vector<Use> uses;
+	for (ResourceHandle resource = 0; resource < m_resources.size(); ++resource)
+	{
+		const Resource& res = m_resources[resource];
+		if (!res.imported)
+			continue;
+		uses.clear();
+		for (uint32_t orderIdx = 0; orderIdx < orderCount; ++orderIdx)
+		{
+			if (const Access* access = FindAccess(m_order[orderIdx], resource))
+				uses.push_back({ orderIdx, access->state, access->write });
+		}
+		// ֻʺϲΪһ״̬ڵһζȡ֮ǰת
+		for (size_t first = 0; first < uses.size();)
+		{
+			const auto IsMergeable = [](const Use& use) { return !use.write && (use.state & ~GraphState::readOnlyMask) == 0; };
+			size_t last = first + 1;
+			if (IsMergeable(uses[first]))
+			{
+				uint32_t merged = uses[first].state;
+				while (last < uses.size() && IsMergeable(uses[last]))
+					merged |= uses[last++].state;
+				for (size_t idx = first; idx < last; ++idx)
+					uses[idx].state = merged;
+			}
+			first = last;
+		}
+
+		uint32_t state = res.initialState;
+		int32_t lastOrder = -1;
+		bool lastWrite = false;
+		for (const auto& use : uses)
+		{
+			if (use.state != state)
+			{
+				Transition(resource, state, use.state, lastOrder, use.order);
+			}
+			else if (use.state == GraphState::unorderedAccess && lastOrder >= 0 && (use.write || lastWrite))
+			{
+				Place(use.order, { GraphBarrierType::uav, GraphBarrierSplit::none, resource, state, state });
+			}
+			state = use.state;
+			lastOrder = static_cast<int32_t>(use.order);
+			lastWrite = use.write;
+		}
+		if (state != res.finalState)
+			Transition(resource, state, res.finalState, lastOrder, orderCount);
+	}
+}
+
+void RenderGraph::PlanAliasing()
+{
+	const uint32_t orderCount = static_cast<uint32_t>(m_order.size());
+	m_planner.Reset();
+	std::vector<ResourceHandle> planned;
+	std::vector<uint32_t> firstUses;
+	for (ResourceHandle resource = 0; resource < m_resources.size(); ++resource)
+	{
+		Resource& res = m_resources[resource];
+		res.planIdx = notPlaced;
+		if (!res.transient)
+			continue;
+		uint32_t firstUse = orderCount;
+		uint32_t lastUse = 0;
+		for (uint32_t orderIdx = 0; orderIdx < orderCount; ++orderIdx)
+		{
+			const Access* access = FindAccess(m_order[orderIdx], resource);
+			if (!access)
+				continue;
+			// ֵڴδ
+			if (firstUse == orderCount && !access->write)
+				throw std::runtime_error("RenderGraph: transient " + res.name + " is read before written");
+			firstUse = std::min(firstUse, orderIdx);
+			lastUse = orderIdx;
+		}
+		if (firstUse == orderCount)
+			continue;
+		res.planIdx = m_planner.AddResource(res.size, res.alignment, res.heapType, firstUse, lastUse);
+		planned.push_back(resource);
+		firstUses.push_back(firstUse);
+	}
+	m_planner.Plan();
+
+	// ڴȴûнֹڴԴǲλеĵһԴһ֡ڲλеԴ
+	const auto& events = m_planner.GetAliasingEvents();
+	std::vector<bool> handsOver(planned.size(), false);
+	std::vector<bool> takesOver(planned.size(), false);
+	for (const auto& event : events)
+	{
+		handsOver[event.before] = true;
+		takesOver[event.after] = true;
+	}
+	std::vector<std::vector<GraphBarrier>> aliasing(orderCount);
+	for (uint32_t idx = 0; idx < planned.size(); ++idx)
+	{
+		if (!handsOver[idx] || takesOver[idx])
+			continue;
+		GraphBarrier barrier{ GraphBarrierType::aliasing, GraphBarrierSplit::none, planned[idx] };
+		barrier.aliasBefore = GraphBarrier::anyResource;
+		aliasing[firstUses[idx]].push_back(barrier);
+	}
+	for (const auto& event : events)
+	{
+		GraphBarrier barrier{ GraphBarrierType::aliasing, GraphBarrierSplit::none, planned[event.after] };
+		barrier.aliasBefore = planned[event.before];
+		aliasing[event.position].push_back(barrier);
+	}
+	// ͬһλõ״̬ת
+	for (uint32_t position = 0; position < orderCount; ++position)
+	{
+		auto& barriers = m_barriers[position];
+		barriers.insert(barriers.begin(), aliasing[position].begin(), aliasing[position].end());
+	}
+}
+
+RenderGraph::Access* RenderGraph::FindAccess(PassHandle pass, ResourceHandle resource)
+{
+	for (auto& access : m_passes[pass].accesses)
+	{
+		if (access.resource == resource)
+			return &access;
+	}
+	return nullptr;
+}
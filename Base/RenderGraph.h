@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "AliasingPlanner.h"
+
+/*
+ * ֡ͼеԴ״ֵ̬D3D12_RESOURCE_STATESһ£˿ֱת
+ */
+namespace GraphState
+{
+constexpr uint32_t common = 0;
+constexpr uint32_t present = 0;
+constexpr uint32_t vertexAndConstantBuffer = 0x1;
+constexpr uint32_t indexBuffer = 0x2;
+constexpr uint32_t renderTarget = 0x4;
+constexpr uint32_t unorderedAccess = 0x8;
+constexpr uint32_t depthWrite = 0x10;
+constexpr uint32_t depthRead = 0x20;
+constexpr uint32_t nonPixelShaderResource = 0x40;
+constexpr uint32_t pixelShaderResource = 0x80;
+constexpr uint32_t indirectArgument = 0x200;
+constexpr uint32_t copyDest = 0x400;
+constexpr uint32_t copySource = 0x800;
+constexpr uint32_t shaderResource = nonPixelShaderResource | pixelShaderResource;
+// ֻ״̬֮԰λϲֻֻһת
+constexpr uint32_t readOnlyMask = vertexAndConstantBuffer | indexBuffer | depthRead | nonPixelShaderResource | pixelShaderResource | indirectArgument | copySource;
+}
+
+enum class GraphBarrierType
+{
+	transition,
+	uav,
+	aliasing
+};
+
+// ϣbeginԴһη֮ʼתendһη֮ǰȴת
+enum class GraphBarrierSplit
+{
+	none,
+	begin,
+	end
+};
+
+struct GraphBarrier
+{
+	// ֡ͼÿ֡ͬĹ滮öѣλеһԴһ֡µԴڴԴΪԴ
+	static constexpr uint32_t anyResource = ~0u;
+
+	GraphBarrierType	type{ GraphBarrierType::transition };
+	GraphBarrierSplit	split{ GraphBarrierSplit::none };
+	uint32_t			resource{ 0 };
+	uint32_t			before{ 0 };
+	uint32_t			after{ 0 };
+	// aliasingʱΪڴԴresourceΪֵԴ
+	uint32_t			aliasBefore{ 0 };
+};
+
+/*
+ * ֡ͼִкˣ֡ͼֻϵλpass˳ɺ¼Ƶб
+ */
+class RenderGraphBackend
+{
+public:
+	virtual ~RenderGraphBackend() = default;
+	// ͬһλõһύ
+	virtual void SubmitBarriers(const GraphBarrier* barriers, uint32_t count) = 0;
+	virtual void BeginPass(const std::string& /*name*/) {}
+	virtual void EndPass() {}
+};
+
+/*
+ * ֡ͼͼAPIÿ֡
+ * 1. passԴĶддԴ°汾ȡǰ汾дߣдΪ޸ģͬһ汾
+ * 2. Compile޳δʹõpass(ͬʱpass˳)ڷ֮ٵϣ
+ *    ֻʺϲΪһתη֮passʱʹòϣUAV֮UAV
+ * 3. ⲿԴ֡ʼʱinitialStateһ汾Ϊⲿʹã֡ʱתfinalState
+ *    Դֻpass֮״̬Ч
+ * 4. ˲̬ԴԴĻڴ棬滮ڽڴpass֮ǰɱϣ
+ *    õĲλеһԴͬɱϣһ֡ռøòλԴڴ
+ */
+class RenderGraph
+{
+public:
+	using ResourceHandle = uint32_t;
+	using PassHandle = uint32_t;
+
+	RenderGraph() = default;
+	RenderGraph(const RenderGraph&) = delete;
+	RenderGraph& operator=(const RenderGraph&) = delete;
+	RenderGraph(RenderGraph&&) = default;
+	RenderGraph& operator=(RenderGraph&&) = default;
+	~RenderGraph() = default;
+
+	// һ֡
+	void Reset();
+	// nativeΪʹõԴָ
+	ResourceHandle ImportResource(const std::string& name, void* native, uint32_t initialState, uint32_t finalState);
+	ResourceHandle DeclareVirtual(const std::string& name);
+	// ˲̬Դֻ֡ʹã״̬ԴһЧһηʱд
+	// Compilepassϵڹ滮ڲཻԴڴ
+	ResourceHandle DeclareTransient(const std::string& name, uint64_t size, uint64_t alignment, TransientHeapType heapType);
+	PassHandle AddPass(const std::string& name, std::function<void()> execute);
+	// ͬһpassͬһԴĶζȡϲ״̬дֻWriteͬʱдʱ׳쳣
+	void Read(PassHandle pass, ResourceHandle resource, uint32_t state);
+	void Write(PassHandle pass, ResourceHandle resource, uint32_t state);
+	// ⲿɼ(ض)ᱻ޳
+	void SetSideEffect(PassHandle pass);
+
+	void Compile();
+	void Execute(RenderGraphBackend& backend) const;
+
+	const std::vector<PassHandle>& GetExecutionOrder() const;
+	bool IsCulled(PassHandle pass) const;
+	// ִ˳еorderIdxpass֮ǰ
+	const std::vector<GraphBarrier>& GetBarriers(uint32_t orderIdx) const;
+	// pass֮
+	const std::vector<GraphBarrier>& GetFinalBarriers() const;
+	uint32_t GetBarrierCount() const;
+	const std::string& GetPassName(PassHandle pass) const;
+	const std::string& GetResourceName(ResourceHandle resource) const;
+	void* GetNative(ResourceHandle resource) const;
+	// ˲̬ԴCompile֮󰴹滮λôplacedԴExecute֮ǰ
+	void SetNative(ResourceHandle resource, void* native);
+	// ˲̬Դзʶ޳ʱûλ
+	bool IsPlaced(ResourceHandle resource) const;
+	const TransientPlacement& GetPlacement(ResourceHandle resource) const;
+	const AliasingPlanner& GetAliasingPlanner() const;
+private:
+	static constexpr uint32_t notPlaced = ~0u;
+	struct Resource
+	{
+		std::string				name;
+		void*					native{ nullptr };
+		uint32_t				initialState{ GraphState::common };
+		uint32_t				finalState{ GraphState::common };
+		bool					imported{ false };
+		bool					transient{ false };
+		uint64_t				size{ 0 };
+		uint64_t				alignment{ 1 };
+		TransientHeapType		heapType{ TransientHeapType::texture };
+		uint32_t				planIdx{ notPlaced };
+		// ÿ汾дߣ汾0֡
+		std::vector<PassHandle>	writers;
+	};
+	struct Access
+	{
+		ResourceHandle	resource;
+		uint32_t		state;
+		bool			write;
+		uint32_t		version;	// ȡİ汾дİ汾
+	};
+	struct Pass
+	{
+		std::string				name;
+		std::function<void()>	execute;
+		std::vector<Access>		accesses;
+		bool					sideEffect{ false };
+		bool					culled{ false };
+	};
+
+	void CullPasses();
+	void SortPasses();
+	void PlaceBarriers();
+	void PlanAliasing();
+	Access* FindAccess(PassHandle pass, ResourceHandle resource);
+private:
+	std::vector<Resource>					m_resources;
+	std::vector<Pass>						m_passes;
+	std::vector<PassHandle>					m_order;
+	std::vector<std::vector<GraphBarrier>>	m_barriers;
+	std::vector<GraphBarrier>				m_finalBarriers;
+	AliasingPlanner							m_planner;
+	bool									m_compiled{ false };
+};
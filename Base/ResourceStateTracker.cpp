@@ -0,0 +1,300 @@
+#include "ResourceStateTracker.h"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include "RenderGraph.h"
+
+std::optional<std::vector<uint32_t>> ResourceStateTable::Find(void* resource) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto iter = m_states.find(resource);
+	if (iter == m_states.end())
+		return std::nullopt;
+	return iter->second;
+}
+
+void ResourceStateTable::Set(void* resource, std::vector<uint32_t> states)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_states[resource] = std::move(states);
+}
+
+void ResourceStateTable::Invalidate(void* resource)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_states.erase(resource);
+}
+
+void ResourceStateTable::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_states.clear();
+}
+
+size_t ResourceStateTable::GetResourceCount() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_states.size();
+}
+
+ResourceStateTracker::ResourceStateTracker(const ResourceStateTable* table)
+: m_table(table)
+{
+}
+
+void ResourceStateTracker::Reset()
+{
+	m_tracked.clear();
+	m_lookup.clear();
+	m_pending.clear();
+	m_dropped = 0;
+	m_submitted = 0;
+}
+
+void ResourceStateTracker::Transition(void* resource, uint32_t before, uint32_t after)
+{
+	Tracked& tracked = GetTracked(resource);
+	// һγ״̬иԴ״̬ͬԴ
+	if (tracked.states.size() == 1 && tracked.states.front() == unknownState && m_table)
+	{
+		const auto known = m_table->Find(resource);
+		if (known && std::any_of(known->begin(), known->end(), [&known](uint32_t state) { return state != known->front(); }))
+		{
+			tracked.states.assign(known->size(), unknownState);
+			tracked.assumed.assign(known->size(), unknownState);
+		}
+	}
+	if (tracked.states.size() == 1)
+	{
+		Apply(tracked, 0, allSubresources, before, after);
+		return;
+	}
+	// Դ״̬Ѿһʱת
+	const uint32_t first = tracked.states.front();
+	if (first != unknownState && std::all_of(tracked.states.begin(), tracked.states.end(), [first](uint32_t state) { return state == first; }))
+	{
+		if (first == after || IsImplied(first, after))
+		{
+			++m_dropped;
+			return;
+		}
+		Enqueue(resource, allSubresources, first, after);
+		std::fill(tracked.states.begin(), tracked.states.end(), after);
+		return;
+	}
+	for (size_t idx = 0; idx < tracked.states.size(); ++idx)
+	{
+		Apply(tracked, idx, static_cast<uint32_t>(idx), before, after);
+	}
+}
+
+void ResourceStateTracker::TransitionSubresource(void* resource, uint32_t subresource, uint32_t subresourceCount, uint32_t before, uint32_t after)
+{
+	Tracked& tracked = GetTracked(resource);
+	if (tracked.states.size() == 1 && subresourceCount > 1)
+	{
+		tracked.states.assign(subresourceCount, tracked.states.front());
+		tracked.assumed.assign(subresourceCount, tracked.assumed.front());
+	}
+	if (subresource >= tracked.states.size())
+		throw std::runtime_error("ResourceStateTracker: subresource out of range");
+	Apply(tracked, subresource, subresource, before, after);
+}
+
+void ResourceStateTracker::UAVBarrier(void* resource)
+{
+	GetTracked(resource);
+	if (!m_pending.empty() && m_pending.back().type == StateBarrierType::uav && m_pending.back().resource == resource)
+	{
+		++m_dropped;
+		return;
+	}
+	m_pending.push_back({ StateBarrierType::uav, resource });
+}
+
+void ResourceStateTracker::NoteTransition(void* resource, uint32_t before, uint32_t after)
+{
+	Tracked& tracked = GetTracked(resource);
+	for (size_t idx = 0; idx < tracked.states.size(); ++idx)
+	{
+		// ⲿѾbefore¼
+		if (tracked.states[idx] == unknownState)
+			tracked.assumed[idx] = before;
+		tracked.states[idx] = after;
+	}
+}
+
+void ResourceStateTracker::Flush(BarrierSink& sink)
+{
+	if (m_pending.empty())
+		return;
+	sink.Submit(m_pending.data(), static_cast<uint32_t>(m_pending.size()));
+	m_submitted += static_cast<uint32_t>(m_pending.size());
+	m_pending.clear();
+}
+
+uint32_t ResourceStateTracker::Resolve(ResourceStateTable& table, BarrierSink& sink)
+{
+	if (!m_pending.empty())
+		throw std::runtime_error("ResourceStateTracker: Resolve with pending barriers");
+	std::vector<StateBarrier> fixups;
+	for (const Tracked& tracked : m_tracked)
+	{
+		const auto known = table.Find(tracked.resource);
+		const size_t count = tracked.states.size();
+		// ״̬ٵȲͬʱֻ״̬¼ܶӦ
+		const bool comparable = known && (known->size() == 1 || known->size() == count || count == 1);
+		if (comparable)
+		{
+			const auto& actual = *known;
+			const bool uniform = std::all_of(actual.begin(), actual.end(), [&actual](uint32_t state) { return state == actual.front(); });
+			if (count == 1 && uniform)
+			{
+				if (tracked.assumed.front() != unknownState && actual.front() != unknownState && actual.front() != tracked.assumed.front())
+					fixups.push_back({ StateBarrierType::transition, tracked.resource, allSubresources, actual.front(), tracked.assumed.front() });
+			}
+			else if (count == 1)
+			{
+				for (size_t sub = 0; sub < actual.size() && tracked.assumed.front() != unknownState; ++sub)
+				{
+					if (actual[sub] != unknownState && actual[sub] != tracked.assumed.front())
+						fixups.push_back({ StateBarrierType::transition, tracked.resource, static_cast<uint32_t>(sub), actual[sub], tracked.assumed.front() });
+				}
+			}
+			else
+			{
+				for (size_t idx = 0; idx < count; ++idx)
+				{
+					const uint32_t state = actual.size() == 1 ? actual.front() : actual[idx];
+					if (tracked.assumed[idx] != unknownState && state != unknownState && state != tracked.assumed[idx])
+						fixups.push_back({ StateBarrierType::transition, tracked.resource, static_cast<uint32_t>(idx), state, tracked.assumed[idx] });
+				}
+			}
+		}
+
+		// бδתԴ״̬еļ¼Ȼδ֪ԴΪunknownState
+		std::vector<uint32_t> finalStates = tracked.states;
+		// ֻ¼UAVϵԴԭеļ¼
+		if (count == 1 && finalStates.front() == unknownState && known)
+			finalStates = *known;
+		for (size_t idx = 0; idx < finalStates.size(); ++idx)
+		{
+			if (finalStates[idx] != unknownState || !known)
+				continue;
+			if (known->size() == 1)
+				finalStates[idx] = known->front();
+			else if (known->size() == finalStates.size())
+				finalStates[idx] = (*known)[idx];
+		}
+		if (std::any_of(finalStates.begin(), finalStates.end(), [](uint32_t state) { return state != unknownState; }))
+			table.Set(tracked.resource, std::move(finalStates));
+		else
+			table.Invalidate(tracked.resource);
+	}
+	if (!fixups.empty())
+		sink.Submit(fixups.data(), static_cast<uint32_t>(fixups.size()));
+	return static_cast<uint32_t>(fixups.size());
+}
+
+std::optional<uint32_t> ResourceStateTracker::GetState(void* resource, uint32_t subresource) const
+{
+	const auto iter = m_lookup.find(resource);
+	if (iter == m_lookup.end())
+		return std::nullopt;
+	const auto& states = m_tracked[iter->second].states;
+	uint32_t state;
+	if (states.size() == 1)
+		state = states.front();
+	else if (subresource == allSubresources)
+		state = std::all_of(states.begin(), states.end(), [&states](uint32_t s) { return s == states.front(); }) ? states.front() : unknownState;
+	else
+		state = subresource < states.size() ? states[subresource] : unknownState;
+	if (state == unknownState)
+		return std::nullopt;
+	return state;
+}
+
+uint32_t ResourceStateTracker::GetPendingCount() const
+{
+	return static_cast<uint32_t>(m_pending.size());
+}
+
+uint32_t ResourceStateTracker::GetDroppedCount() const
+{
+	return m_dropped;
+}
+
+uint32_t ResourceStateTracker::GetSubmittedCount() const
+{
+	return m_submitted;
+}
+
+ResourceStateTracker::Tracked& ResourceStateTracker::GetTracked(void* resource)
+{
+	const auto [iter, inserted] = m_lookup.try_emplace(resource, m_tracked.size());
+	if (inserted)
+		m_tracked.push_back({ resource, { unknownState }, { unknownState } });
+	return m_tracked[iter->second];
+}
+
+void ResourceStateTracker::Apply(Tracked& tracked, size_t idx, uint32_t subresource, uint32_t before, uint32_t after)
+{
+	uint32_t& current = tracked.states[idx];
+	if (current == unknownState)
+	{
+		current = LookupTable(tracked.resource, subresource, tracked.states.size()).value_or(before);
+		tracked.assumed[idx] = current;
+	}
+	if (current == after || IsImplied(current, after))
+	{
+		++m_dropped;
+		return;
+	}
+	Enqueue(tracked.resource, subresource, current, after);
+	current = after;
+}
+
+void ResourceStateTracker::Enqueue(void* resource, uint32_t subresource, uint32_t before, uint32_t after)
+{
+	// ͬһԴһת֮ûκβֱӺϲ
+	for (auto iter = m_pending.rbegin(); iter != m_pending.rend(); ++iter)
+	{
+		if (iter->resource != resource)
+			continue;
+		if (iter->type != StateBarrierType::transition || iter->subresource != subresource)
+			break;
+		++m_dropped;
+		if (iter->before == after)
+			m_pending.erase(std::next(iter).base());
+		else
+			iter->after = after;
+		return;
+	}
+	m_pending.push_back({ StateBarrierType::transition, resource, subresource, before, after });
+}
+
+std::optional<uint32_t> ResourceStateTracker::LookupTable(void* resource, uint32_t subresource, size_t subresourceCount) const
+{
+	if (!m_table)
+		return std::nullopt;
+	const auto states = m_table->Find(resource);
+	if (!states)
+		return std::nullopt;
+	if (states->size() == 1)
+		return states->front();
+	if (subresource == allSubresources)
+	{
+		if (states->front() != unknownState && std::all_of(states->begin(), states->end(), [&states](uint32_t state) { return state == states->front(); }))
+			return states->front();
+		return std::nullopt;
+	}
+	if (states->size() == subresourceCount && subresource < states->size() && (*states)[subresource] != unknownState)
+		return (*states)[subresource];
+	return std::nullopt;
+}
+
+bool ResourceStateTracker::IsImplied(uint32_t current, uint32_t after)
+{
+	// ֻ״̬Ͽֱһֶȡ
+	return after != 0 && (current & ~GraphState::readOnlyMask) == 0 && (current & after) == after;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Դ״̬٣״ֵ̬D3D12_RESOURCE_STATESһ£ԴԺ˵ָʶͼAPI
+ */
+constexpr uint32_t allSubresources = 0xffffffff;
+// ״̬аԴ¼ʱ״̬δ֪Դ
+constexpr uint32_t unknownState = 0xffffffff;
+
+enum class StateBarrierType
+{
+	transition,
+	uav
+};
+
+struct StateBarrier
+{
+	StateBarrierType	type{ StateBarrierType::transition };
+	void*				resource{ nullptr };
+	uint32_t			subresource{ allSubresources };
+	uint32_t			before{ 0 };
+	uint32_t			after{ 0 };
+};
+
+// ϵ¼ƶˣͬһһύ
+class BarrierSink
+{
+public:
+	virtual ~BarrierSink() = default;
+	virtual void Submit(const StateBarrier* barriers, uint32_t count) = 0;
+};
+
+/*
+ * ȫ״̬¼ύбִϺԴ״̬ڶ߳з
+ * ÿԴ¼1(Դͬ)ÿԴ1״̬ûм¼ʾ״̬ţ
+ * Դ¼ʱԴΪunknownStateֻת˲Դбʧ֪״̬
+ */
+class ResourceStateTable
+{
+public:
+	ResourceStateTable() = default;
+	ResourceStateTable(const ResourceStateTable&) = delete;
+	ResourceStateTable& operator=(const ResourceStateTable&) = delete;
+	~ResourceStateTable() = default;
+
+	std::optional<std::vector<uint32_t>> Find(void* resource) const;
+	void Set(void* resource, std::vector<uint32_t> states);
+	// ڸ֮ת״̬Դٿ
+	void Invalidate(void* resource);
+	// ԴؽָܱãҪ
+	void Clear();
+	size_t GetResourceCount() const;
+private:
+	mutable std::mutex									m_mutex;
+	std::unordered_map<void*, std::vector<uint32_t>>	m_states;
+};
+
+/*
+ * б״̬
+ * 1. ¼бÿԴĵǰ״̬Ŀ״̬뵱ǰ״̬ͬѰڵǰֻ״̬ʱת
+ * 2. תȷύΣͬһԴеתϲΪһdrawdispatchȲ֮ǰFlushһύ
+ * 3. Դһγʱȫ״̬ļ¼Ϊ׼ûм¼ʱʹõ÷ٶ״̬
+ *    ύʱResolveٴζ״̬ڸб֮ǰִеϣбʱ״̬״̬
+ * б谴ύ˳Resolve
+ */
+class ResourceStateTracker
+{
+public:
+	explicit ResourceStateTracker(const ResourceStateTable* table = nullptr);
+	ResourceStateTracker(const ResourceStateTracker&) = delete;
+	ResourceStateTracker& operator=(const ResourceStateTracker&) = delete;
+	ResourceStateTracker(ResourceStateTracker&&) = default;
+	ResourceStateTracker& operator=(ResourceStateTracker&&) = default;
+	~ResourceStateTracker() = default;
+
+	// бʱ
+	void Reset();
+	// beforeΪ÷ٶ״ֻ̬Դһγ״̬ûм¼ʱʹ
+	void Transition(void* resource, uint32_t before, uint32_t after);
+	void TransitionSubresource(void* resource, uint32_t subresource, uint32_t subresourceCount, uint32_t before, uint32_t after);
+	void UAVBarrier(void* resource);
+	// ڸ֮¼Ƶת(֡ͼ)ֻ¸ٵ״̬ǰFlush
+	void NoteTransition(void* resource, uint32_t before, uint32_t after);
+	void Flush(BarrierSink& sink);
+	// ύʱãϽsinkϵ
+	uint32_t Resolve(ResourceStateTable& table, BarrierSink& sink);
+
+	std::optional<uint32_t> GetState(void* resource, uint32_t subresource = allSubresources) const;
+	uint32_t GetPendingCount() const;
+	// ϲת
+	uint32_t GetDroppedCount() const;
+	uint32_t GetSubmittedCount() const;
+private:
+	struct Tracked
+	{
+		void*					resource;
+		// СΪ1ʱԴ״̬ͬÿԴһ
+		std::vector<uint32_t>	states;
+		// һʹʱٶ״̬δʹùΪunknownState
+		std::vector<uint32_t>	assumed;
+	};
+
+	Tracked& GetTracked(void* resource);
+	void Apply(Tracked& tracked, size_t idx, uint32_t subresource, uint32_t before, uint32_t after);
+	void Enqueue(void* resource, uint32_t subresource, uint32_t before, uint32_t after);
+	std::optional<uint32_t> LookupTable(void* resource, uint32_t subresource, size_t subresourceCount) const;
+	static bool IsImplied(uint32_t current, uint32_t after);
+private:
+	const ResourceStateTable*				m_table;
+	std::vector<Tracked>					m_tracked;
+	std::unordered_map<void*, size_t>		m_lookup;
+	std::vector<StateBarrier>				m_pending;
+	uint32_t								m_dropped{ 0 };
+	uint32_t								m_submitted{ 0 };
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+/*
+ * ԷֻƫƣԴڴ
+ * ÿ֡ķڻ֡ʱΧֵǸ֡ռõ䣬GPUԽΧλ
+ * 뻷β޷ɶĿռ䶼֡ʱβָ밴֡Сǰ
+ */
+class RingAllocator
+{
+public:
+	static constexpr uint64_t invalidOffset = ~0ULL;
+
+	explicit RingAllocator(uint64_t capacity) : m_capacity(capacity) {}
+
+	// alignmentΪ2ݣռ䲻ʱinvalidOffset
+	uint64_t Allocate(uint64_t size, uint64_t alignment)
+	{
+		if (size == 0 || size > m_capacity || m_used == m_capacity)
+			return invalidOffset;
+		const uint64_t aligned = AlignUp(m_head, alignment);
+		uint64_t offset;
+		uint64_t consumed;
+		if (m_head >= m_tail)
+		{
+			// Ϊ[head, capacity)[0, tail)
+			if (aligned + size <= m_capacity)
+			{
+				offset = aligned;
+				consumed = aligned + size - m_head;
+			}
+			else if (size <= m_tail)
+			{
+				offset = 0;
+				consumed = m_capacity - m_head + size;
+			}
+			else
+			{
+				return invalidOffset;
+			}
+		}
+		else
+		{
+			// Ϊ[head, tail)
+			if (aligned + size > m_tail)
+				return invalidOffset;
+			offset = aligned;
+			consumed = aligned + size - m_head;
+		}
+		m_head = (offset + size) % m_capacity;
+		m_used += consumed;
+		m_frameSize += consumed;
+		return offset;
+	}
+
+	// ǰ֡ķȫɣfenceΪύ֡󷢳Χֵ
+	void FinishFrame(uint64_t fence)
+	{
+		if (m_frameSize == 0)
+			return;
+		m_frames.push_back({ fence, m_frameSize });
+		m_frameSize = 0;
+	}
+
+	// GPUѾִɵ֡
+	void Reclaim(uint64_t completedFence)
+	{
+		while (!m_frames.empty() && m_frames.front().fence <= completedFence)
+		{
+			m_tail = (m_tail + m_frames.front().size) % m_capacity;
+			m_used -= m_frames.front().size;
+			m_frames.pop_front();
+		}
+		// Ϊʱص㣬ٿԽβɵ˷
+		if (m_used == 0)
+		{
+			m_head = 0;
+			m_tail = 0;
+		}
+	}
+
+	uint64_t GetCapacity() const
+	{
+		return m_capacity;
+	}
+
+	uint64_t GetUsedSize() const
+	{
+		return m_used;
+	}
+private:
+	static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	struct FrameMark
+	{
+		uint64_t	fence;
+		uint64_t	size;
+	};
+	uint64_t				m_capacity;
+	uint64_t				m_head{ 0 };
+	uint64_t				m_tail{ 0 };
+	uint64_t				m_used{ 0 };
+	uint64_t				m_frameSize{ 0 };
+	std::deque<FrameMark>	m_frames;
+};
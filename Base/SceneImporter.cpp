@@ -0,0 +1,103 @@
+#include "SceneImporter.h"
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <cassert>
+#include "ThreadPool.hpp"
+
+using namespace Models;
+
+bool SceneImporter::Import(const std::filesystem::path& source, MeshCacheData& data, std::string& error)
+{
+	Assimp::Importer importer;
+	const aiScene* scene = importer.ReadFile(source.string(), importFlags);
+	if (!scene || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || !scene->mRootNode)
+	{
+		error = importer.GetErrorString();
+		return false;
+	}
+	ProcessScene(scene, data);
+	return true;
+}
+
+void SceneImporter::ProcessScene(const aiScene* scene, MeshCacheData& data)
+{
+	// ʣֻ¼·ObjLoader::BuildModelм
+	constexpr aiTextureType textureTypes[3] = { aiTextureType_DIFFUSE, aiTextureType_SPECULAR, aiTextureType_AMBIENT };
+	data.materials.resize(scene->mNumMaterials);
+	for (uint32_t i = 0; i < scene->mNumMaterials; ++i)
+	{
+		const auto& mat = scene->mMaterials[i];
+		data.materials[i].name = mat->GetName().C_Str();
+		for (uint32_t j = 0; j < 3; ++j)
+		{
+			aiString aiPath;
+			if (mat->GetTextureCount(textureTypes[j]) > 0 && mat->GetTexture(textureTypes[j], 0, &aiPath) == aiReturn_SUCCESS)
+				data.materials[i].textures[j] = aiPath.C_Str();
+		}
+	}
+
+	// ֻߵͨǰ׺͵õÿںϲеƫƣתԲд
+	std::vector<const aiMesh*> meshes;
+	meshes.reserve(scene->mNumMeshes);
+	for (uint32_t i = 0; i < scene->mNumMeshes; ++i)
+	{
+		if (scene->mMeshes[i]->mPrimitiveTypes == aiPrimitiveType_TRIANGLE)
+			meshes.push_back(scene->mMeshes[i]);
+	}
+	const uint32_t meshCount = static_cast<uint32_t>(meshes.size());
+	data.meshes.resize(meshCount);
+	uint32_t vboOffset = 0;
+	uint32_t eboOffset = 0;
+	for (uint32_t i = 0; i < meshCount; ++i)
+	{
+		const aiMesh* mesh = meshes[i];
+		auto& cached = data.meshes[i];
+		cached.materialName = scene->mMaterials[mesh->mMaterialIndex]->GetName().C_Str();
+		cached.vboStart = vboOffset;
+		cached.eboStart = eboOffset;
+		cached.eboCount = mesh->mNumFaces * 3;
+		vboOffset += mesh->mNumVertices;
+		eboOffset += mesh->mNumFaces * 3;
+	}
+	Thread::ThreadPool::instance().ParallelFor(0, meshCount, 1, [&](uint32_t i)
+	{
+		ProcessMesh(meshes[i], data.meshes[i]);
+	});
+}
+
+void SceneImporter::ProcessMesh(const aiMesh* mesh, CachedMesh& data)
+{
+	// Ԥȷÿռԭд룬ͬʱΧ
+	auto& vbos = data.vertices;
+	vbos.resize(mesh->mNumVertices);
+	XMVECTOR boundsMin = g_XMFltMax;
+	XMVECTOR boundsMax = XMVectorNegate(g_XMFltMax);
+	for (uint32_t i = 0; i < mesh->mNumVertices; ++i)
+	{
+		auto& vbo = vbos[i];
+		// λáߡꣻûʱassimp
+		vbo.pos = { mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z };
+		vbo.normal = { mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z };
+		vbo.tangent = mesh->mTangents ? XMFLOAT3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z) : XMFLOAT3(0.0f, 0.0f, 0.0f);
+		vbo.bitangent = mesh->mBitangents ? XMFLOAT3(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z) : XMFLOAT3(0.0f, 0.0f, 0.0f);
+		vbo.tex = mesh->mTextureCoords[0] ? XMFLOAT2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y) : XMFLOAT2(0.0f, 0.0f);
+		const XMVECTOR pos = XMLoadFloat3(&vbo.pos);
+		boundsMin = XMVectorMin(boundsMin, pos);
+		boundsMax = XMVectorMax(boundsMax, pos);
+	}
+	if (mesh->mNumVertices > 0)
+	{
+		BoundingBox::CreateFromPoints(data.bounds, boundsMin, boundsMax);
+	}
+	// EBOaiProcess_TriangulateaiProcess_SortByPType֤ÿ涼
+	auto& ebos = data.indices;
+	ebos.resize(3ULL * mesh->mNumFaces);
+	for (uint32_t i = 0; i < mesh->mNumFaces; ++i)
+	{
+		const aiFace& face = mesh->mFaces[i];
+		assert(face.mNumIndices == 3);
+		ebos[3ULL * i] = face.mIndices[0];
+		ebos[3ULL * i + 1] = face.mIndices[1];
+		ebos[3ULL * i + 2] = face.mIndices[2];
+	}
+}
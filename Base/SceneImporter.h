@@ -0,0 +1,30 @@
+#pragma once
+
+#include <assimp/postprocess.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include "MeshCache.h"
+
+struct aiScene;
+struct aiMesh;
+
+namespace Models
+{
+/*
+ * ͨassimpģͲתΪ񻺴ͬмݣD3D
+ * aiProcess_SortByPTypeѵ㡢βֵֻͬᱻ
+ */
+class SceneImporter
+{
+public:
+	static constexpr uint32_t	importFlags = aiProcess_ConvertToLeftHanded | aiProcess_Triangulate | aiProcess_SortByPType |
+		aiProcess_ImproveCacheLocality | aiProcess_CalcTangentSpace | aiProcess_GenSmoothNormals;
+
+	// ʧʱfalseͨerrorassimpĴϢ
+	static bool Import(const std::filesystem::path& source, MeshCacheData& data, std::string& error);
+private:
+	static void ProcessScene(const aiScene* scene, MeshCacheData& data);
+	static void ProcessMesh(const aiMesh* mesh, CachedMesh& data);
+};
+}
@@ -2,6 +2,8 @@
 #include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
+#include <d3d12shader.h>
 #include "D3DUtil.hpp"
 
 Shader::Shader
@@ -99,3 +101,28 @@ const ComPtr<ID3DBlob>& Shader::GetShaderByType(ShaderPos type) const
 {
 	return m_shaderBlobs[static_cast<int>(type)];
 }
+
+void Shader::CheckConstantBuffer(ShaderPos type, const char* name, UINT byteSize) const
+{
+	const auto& blob = GetShaderByType(type);
+	ComPtr<ID3D12ShaderReflection> reflection;
+	ThrowIfFailed(D3DReflect(blob->GetBufferPointer(), blob->GetBufferSize(), IID_PPV_ARGS(&reflection)));
+	D3D12_SHADER_BUFFER_DESC desc;
+	if (FAILED(reflection->GetConstantBufferByName(name)->GetDesc(&desc)))
+		return;
+	if (desc.Size != ((byteSize + 15) & ~15U))
+		throw std::runtime_error(std::string("Shader: constant buffer layout mismatch: ") + name);
+}
+
+void Shader::CheckStructuredBuffer(ShaderPos type, const char* name, UINT stride) const
+{
+	const auto& blob = GetShaderByType(type);
+	ComPtr<ID3D12ShaderReflection> reflection;
+	ThrowIfFailed(D3DReflect(blob->GetBufferPointer(), blob->GetBufferSize(), IID_PPV_ARGS(&reflection)));
+	// ṹĲ¼NumSamples
+	D3D12_SHADER_INPUT_BIND_DESC desc;
+	if (FAILED(reflection->GetResourceBindingDescByName(name, &desc)))
+		return;
+	if (desc.NumSamples != stride)
+		throw std::runtime_error(std::string("Shader: structured buffer stride mismatch: ") + name);
+}
@@ -45,6 +45,12 @@ public:
 	const D3D12_INPUT_ELEMENT_DESC* GetInputLayouts() const;
 	UINT GetInputLayoutSize() const;
 	const ComPtr<ID3DBlob>& GetShaderByType(ShaderPos type) const;
+	/*
+	 * ɫУCPU˽ṹHLSLĲ֣һʱ׳쳣
+	 * Ƚϰ16ֽڶĴСṹȽԪز޳Դ
+	 */
+	void CheckConstantBuffer(ShaderPos type, const char* name, UINT byteSize) const;
+	void CheckStructuredBuffer(ShaderPos type, const char* name, UINT stride) const;
 private:
 	/*
 	 * inputĴ ͨʵĶӳ䵽Ӧ
@@ -0,0 +1,34 @@
+#ifndef SHADER_CONFIG
+#define SHADER_CONFIG
+
+/*
+ * C++HLSLͬĳ鳤߳ߴ඼ԴΪ׼
+ * ɫ·ļֻԤָע
+ */
+
+/* WorldConstant/PassConstantlightsδŵƽй۹ */
+#define DIR_LIGHT_NUM (3)
+#define SPOT_LIGHT_NUM (0)
+#define MAX_LIGHTS (DIR_LIGHT_NUM + SPOT_LIGHT_NUM)
+
+/* TileBased.hlslֿ߳߳Ķ */
+#define TILE_GROUP_DIM (16)
+#define DEPTH_MASK_BITS (32)
+/*
+ * ֿԴλÿǵĵԴռMAX_TILE_LIGHTS / 8ֽgroupshared
+ * Դʱʱɫ޳йԴɫ
+ */
+#define MAX_TILE_LIGHTS (8192)
+
+/* ΰuintдԴ棬ռһuint */
+#if (MAX_TILE_LIGHTS % 32) != 0
+#error MAX_TILE_LIGHTS must be a multiple of 32
+#endif
+#if DEPTH_MASK_BITS != 32
+#error DEPTH_MASK_BITS must match the width of a uint
+#endif
+#if (TILE_GROUP_DIM * TILE_GROUP_DIM) > 1024
+#error TILE_GROUP_DIM exceeds the thread group size limit
+#endif
+
+#endif
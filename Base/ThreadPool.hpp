@@ -1,9 +1,333 @@
 #pragma once
 
-// TODO:̳߳ʵֶ߳Ⱦ
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "Singleton.hpp"
+
 namespace Thread
 {
-class ThreadPool {
+/*
+ * ڵ㣺pendingDeps¼δɵǰŻУ
+ * ʱλsuccessorsеĺ
+ */
+struct Task
+{
+	std::function<void()>				func;
+	std::atomic<int>					pendingDeps{ 1 };	// 1ύǰ񲻱ǰ
+	std::atomic<bool>					finished{ false };
+	std::mutex							lock;
+	std::vector<std::shared_ptr<Task>>	successors;
+	std::exception_ptr					exception{ nullptr };
+};
+using TaskHandle = std::shared_ptr<Task>;
+
+/*
+ * work-stealing̳߳أÿ߳ӵԼ˫˶У̴߳βȡ(LIFOѺ)
+ * ̴̶߳߳еͷȡ(FIFOȡϴ)
+ * Wait/ParallelFor߳ҲִڲǶײв
+ */
+class ThreadPool : public Singleton<ThreadPool>
+{
+public:
+	explicit ThreadPool(typename Singleton<ThreadPool>::Token) : Singleton<ThreadPool>()
+	{
+		const uint32_t hardware = std::max(2u, std::thread::hardware_concurrency());
+		// ߳ڵȴʱִͬٿһ߳
+		const uint32_t workerCount = hardware - 1;
+		m_queues.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; ++i)
+		{
+			m_queues.emplace_back(std::make_unique<WorkQueue>());
+		}
+		m_workers.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; ++i)
+		{
+			m_workers.emplace_back([this, i]() { WorkerLoop(i); });
+		}
+	}
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	ThreadPool(ThreadPool&&) = delete;
+	ThreadPool& operator=(ThreadPool&&) = delete;
+	~ThreadPool() override
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_sleepLock);
+			m_stop = true;
+		}
+		m_sleepCV.notify_all();
+		for (auto& worker : m_workers)
+		{
+			if (worker.joinable())
+				worker.join();
+		}
+	}
+
+	uint32_t GetWorkerCount() const
+	{
+		return static_cast<uint32_t>(m_workers.size());
+	}
+
+	// ύһdepsеȫɺŻᱻ
+	TaskHandle Submit(std::function<void()> func, const std::vector<TaskHandle>& deps = {})
+	{
+		auto task = std::make_shared<Task>();
+		task->func = std::move(func);
+		for (const auto& dep : deps)
+		{
+			if (!dep)
+				continue;
+			std::lock_guard<std::mutex> guard(dep->lock);
+			if (!dep->finished.load(std::memory_order_acquire))
+			{
+				task->pendingDeps.fetch_add(1, std::memory_order_relaxed);
+				dep->successors.emplace_back(task);
+			}
+		}
+		// ͷύ׶εı
+		if (task->pendingDeps.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			Schedule(task);
+		}
+		return task;
+	}
+
+	// ȴɣȴڼ䵱ǰִ̰߳же
+	void Wait(const TaskHandle& task)
+	{
+		if (!task)
+			return;
+		while (!task->finished.load(std::memory_order_acquire))
+		{
+			if (!RunOneTask())
+				std::this_thread::yield();
+		}
+		if (task->exception)
+			std::rethrow_exception(task->exception);
+	}
+
+	void WaitAll(const std::vector<TaskHandle>& tasks)
+	{
+		for (const auto& task : tasks)
+		{
+			Wait(task);
+		}
+	}
+
+	/*
+	 * [begin, end)grainСзֲִУ߳ȫ
+	 * funcǩfunc(uint32_t idx)Ҳfunc(uint32_t chunkBegin, uint32_t chunkEnd)
+	 */
+	template <typename Func>
+	void ParallelFor(uint32_t begin, uint32_t end, uint32_t grain, Func&& func)
+	{
+		if (begin >= end)
+			return;
+		grain = std::max(1u, grain);
+		const uint32_t count = end - begin;
+		const uint32_t chunkCount = (count + grain - 1) / grain;
+		auto RunChunk = [&func, begin, end, grain](uint32_t chunk)
+		{
+			const uint32_t chunkBegin = begin + chunk * grain;
+			const uint32_t chunkEnd = std::min(end, chunkBegin + grain);
+			if constexpr (std::is_invocable_v<Func, uint32_t, uint32_t>)
+			{
+				func(chunkBegin, chunkEnd);
+			}
+			else
+			{
+				for (uint32_t i = chunkBegin; i < chunkEnd; ++i)
+				{
+					func(i);
+				}
+			}
+		};
+		// ֻһûй߳ʱֱӴִ
+		if (chunkCount == 1 || m_workers.empty())
+		{
+			for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+			{
+				RunChunk(chunk);
+			}
+			return;
+		}
+		std::vector<TaskHandle> tasks;
+		tasks.reserve(chunkCount - 1);
+		for (uint32_t chunk = 1; chunk < chunkCount; ++chunk)
+		{
+			tasks.emplace_back(Submit([&RunChunk, chunk]() { RunChunk(chunk); }));
+		}
+		// һɵִ߳
+		std::exception_ptr firstException{ nullptr };
+		try
+		{
+			RunChunk(0);
+		}
+		catch (...)
+		{
+			firstException = std::current_exception();
+		}
+		// п뿪ʧЧջ
+		std::exception_ptr taskException{ nullptr };
+		for (const auto& task : tasks)
+		{
+			try
+			{
+				Wait(task);
+			}
+			catch (...)
+			{
+				if (!taskException)
+					taskException = std::current_exception();
+			}
+		}
+		if (firstException)
+			std::rethrow_exception(firstException);
+		if (taskException)
+			std::rethrow_exception(taskException);
+	}
+
+private:
+	struct WorkQueue
+	{
+		std::mutex				lock;
+		std::deque<TaskHandle>	tasks;
+	};
+
+	void Schedule(const TaskHandle& task)
+	{
+		if (m_queues.empty())
+		{
+			// ûй߳ʱֱڵǰִ߳
+			Execute(task);
+			return;
+		}
+		uint32_t queueIdx;
+		if (t_workerIdx >= 0 && t_owner == this)
+		{
+			queueIdx = static_cast<uint32_t>(t_workerIdx);
+		}
+		else
+		{
+			queueIdx = m_nextQueue.fetch_add(1, std::memory_order_relaxed) % static_cast<uint32_t>(m_queues.size());
+		}
+		{
+			std::lock_guard<std::mutex> guard(m_queues[queueIdx]->lock);
+			m_queues[queueIdx]->tasks.emplace_back(task);
+		}
+		m_queuedCount.fetch_add(1, std::memory_order_release);
+		{
+			// ֪ͨ⹤̼߳˯֮䶪ʧ
+			std::lock_guard<std::mutex> guard(m_sleepLock);
+		}
+		m_sleepCV.notify_one();
+	}
+
+	TaskHandle PopOrSteal(int selfIdx)
+	{
+		const uint32_t queueCount = static_cast<uint32_t>(m_queues.size());
+		if (selfIdx >= 0)
+		{
+			auto& own = *m_queues[selfIdx];
+			std::lock_guard<std::mutex> guard(own.lock);
+			if (!own.tasks.empty())
+			{
+				TaskHandle task = std::move(own.tasks.back());
+				own.tasks.pop_back();
+				m_queuedCount.fetch_sub(1, std::memory_order_relaxed);
+				return task;
+			}
+		}
+		const uint32_t start = selfIdx >= 0 ? static_cast<uint32_t>(selfIdx) + 1 : 0;
+		for (uint32_t i = 0; i < queueCount; ++i)
+		{
+			auto& victim = *m_queues[(start + i) % queueCount];
+			std::lock_guard<std::mutex> guard(victim.lock);
+			if (!victim.tasks.empty())
+			{
+				TaskHandle task = std::move(victim.tasks.front());
+				victim.tasks.pop_front();
+				m_queuedCount.fetch_sub(1, std::memory_order_relaxed);
+				return task;
+			}
+		}
+		return nullptr;
+	}
+
+	bool RunOneTask()
+	{
+		const int selfIdx = t_owner == this ? t_workerIdx : -1;
+		TaskHandle task = PopOrSteal(selfIdx);
+		if (!task)
+			return false;
+		Execute(task);
+		return true;
+	}
+
+	void Execute(const TaskHandle& task)
+	{
+		try
+		{
+			task->func();
+		}
+		catch (...)
+		{
+			task->exception = std::current_exception();
+		}
+		task->func = nullptr;
+
+		std::vector<TaskHandle> successors;
+		{
+			std::lock_guard<std::mutex> guard(task->lock);
+			task->finished.store(true, std::memory_order_release);
+			successors.swap(task->successors);
+		}
+		for (const auto& next : successors)
+		{
+			if (next->pendingDeps.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				Schedule(next);
+		}
+	}
+
+	void WorkerLoop(uint32_t idx)
+	{
+		t_workerIdx = static_cast<int>(idx);
+		t_owner = this;
+		while (true)
+		{
+			if (RunOneTask())
+				continue;
+			std::unique_lock<std::mutex> guard(m_sleepLock);
+			m_sleepCV.wait(guard, [this]()
+			{
+				return m_stop || m_queuedCount.load(std::memory_order_acquire) > 0;
+			});
+			if (m_stop)
+				return;
+		}
+	}
+
+private:
+	inline static thread_local int				t_workerIdx{ -1 };
+	inline static thread_local ThreadPool*		t_owner{ nullptr };
+
+	std::vector<std::unique_ptr<WorkQueue>>		m_queues;
+	std::vector<std::thread>					m_workers;
+	std::atomic<uint32_t>						m_nextQueue{ 0 };
+	std::atomic<int>							m_queuedCount{ 0 };
+	std::mutex									m_sleepLock;
+	std::condition_variable						m_sleepCV;
+	bool										m_stop{ false };
 };
 }
 
@@ -2,10 +2,6 @@
 #include <D3DUtil.hpp>
 #include <MathHelper.hpp>
 
-Transform::Transform(const XMFLOAT3& scale, const XMFLOAT3& rotation, const XMFLOAT3& translation)
-	: m_scale(scale), m_rotation(rotation), m_position(translation)
-{}
-
 XMFLOAT4X4 Transform::GetModelMatrix(const XMFLOAT3& scale, const XMFLOAT3& rotation, const XMFLOAT3& translation)
 {
 	XMFLOAT4X4 ans;
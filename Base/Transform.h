@@ -7,7 +7,8 @@ using namespace  DirectX;
 struct Transform {
 public:
 	Transform() = default;
-	Transform(const XMFLOAT3& scale, const XMFLOAT3& rotation, const XMFLOAT3& translation);
+	Transform(const XMFLOAT3& scale, const XMFLOAT3& rotation, const XMFLOAT3& translation)
+	: m_scale(scale), m_rotation(rotation), m_position(translation) {}
 	~Transform() = default;
 	Transform(const Transform&) = default;
 	Transform& operator=(const Transform&) = default;
@@ -0,0 +1,153 @@
+#include "TransformStore.h"
+#include <algorithm>
+#include <cassert>
+
+TransformStore::TransformStore(typename Singleton<TransformStore>::Token) : Singleton<TransformStore>()
+{
+	Resize(0);
+}
+
+uint32_t TransformStore::Allocate(uint32_t count)
+{
+	const uint32_t start = m_size;
+	Resize(m_size + count);
+	return start;
+}
+
+uint32_t TransformStore::Grow(uint32_t start, uint32_t count)
+{
+	if (count == 0 || start + count == m_size)
+	{
+		const uint32_t begin = count == 0 ? m_size : start;
+		Resize(m_size + 1);
+		return begin;
+	}
+	// 䲻ĩβԭʵǨƵĩβԱ䲻ʹ
+	const uint32_t newStart = Allocate(count + 1);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const Transform form = GetTransform(start + i);
+		SetScale(newStart + i, form.m_scale);
+		SetRotation(newStart + i, form.m_rotation);
+		SetPosition(newStart + i, form.m_position);
+	}
+	return newStart;
+}
+
+uint32_t TransformStore::GetSize() const
+{
+	return m_size;
+}
+
+void TransformStore::SetScale(uint32_t idx, const XMFLOAT3& scale)
+{
+	assert(idx < m_size);
+	m_scaleX[idx] = scale.x;
+	m_scaleY[idx] = scale.y;
+	m_scaleZ[idx] = scale.z;
+	m_dirty[idx] = frameResourcesCount;
+}
+
+void TransformStore::SetRotation(uint32_t idx, const XMFLOAT3& rotation)
+{
+	assert(idx < m_size);
+	m_rotationX[idx] = rotation.x;
+	m_rotationY[idx] = rotation.y;
+	m_rotationZ[idx] = rotation.z;
+	m_dirty[idx] = frameResourcesCount;
+}
+
+void TransformStore::SetPosition(uint32_t idx, const XMFLOAT3& position)
+{
+	assert(idx < m_size);
+	m_positionX[idx] = position.x;
+	m_positionY[idx] = position.y;
+	m_positionZ[idx] = position.z;
+	m_dirty[idx] = frameResourcesCount;
+}
+
+Transform TransformStore::GetTransform(uint32_t idx) const
+{
+	assert(idx < m_size);
+	return Transform(
+		XMFLOAT3(m_scaleX[idx], m_scaleY[idx], m_scaleZ[idx]),
+		XMFLOAT3(m_rotationX[idx], m_rotationY[idx], m_rotationZ[idx]),
+		XMFLOAT3(m_positionX[idx], m_positionY[idx], m_positionZ[idx]));
+}
+
+void TransformStore::MarkDirty(uint32_t start, uint32_t count)
+{
+	assert(start + count <= m_size);
+	std::fill(m_dirty.begin() + start, m_dirty.begin() + start + count, static_cast<uint8_t>(frameResourcesCount));
+}
+
+void TransformStore::ComposeTransposed(uint32_t start, uint32_t count, XMFLOAT4X4* out) const
+{
+	assert(start + count <= m_size);
+	/*
+	 * Model = S * R * TR = Rz(roll) * Rx(pitch) * Ry(yaw)XMMatrixRotationRollPitchYawһ
+	 * ÿȡ4ʵͬһһǺԪصļ㶼4ʵͬʱ
+	 */
+	for (uint32_t base = 0; base < count; base += 4)
+	{
+		const uint32_t idx = start + base;
+		XMVECTOR sinPitch, cosPitch, sinYaw, cosYaw, sinRoll, cosRoll;
+		XMVectorSinCos(&sinPitch, &cosPitch, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_rotationX[idx])));
+		XMVectorSinCos(&sinYaw, &cosYaw, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_rotationY[idx])));
+		XMVectorSinCos(&sinRoll, &cosRoll, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_rotationZ[idx])));
+		const XMVECTOR scaleX = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_scaleX[idx]));
+		const XMVECTOR scaleY = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_scaleY[idx]));
+		const XMVECTOR scaleZ = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_scaleZ[idx]));
+
+		const XMVECTOR sinRollSinPitch = XMVectorMultiply(sinRoll, sinPitch);
+		const XMVECTOR cosRollSinPitch = XMVectorMultiply(cosRoll, sinPitch);
+		// ת9Ԫ
+		const XMVECTOR r00 = XMVectorMultiplyAdd(sinRollSinPitch, sinYaw, XMVectorMultiply(cosRoll, cosYaw));
+		const XMVECTOR r01 = XMVectorMultiply(sinRoll, cosPitch);
+		const XMVECTOR r02 = XMVectorNegativeMultiplySubtract(cosRoll, sinYaw, XMVectorMultiply(sinRollSinPitch, cosYaw));
+		const XMVECTOR r10 = XMVectorNegativeMultiplySubtract(sinRoll, cosYaw, XMVectorMultiply(cosRollSinPitch, sinYaw));
+		const XMVECTOR r11 = XMVectorMultiply(cosRoll, cosPitch);
+		const XMVECTOR r12 = XMVectorMultiplyAdd(sinRoll, sinYaw, XMVectorMultiply(cosRollSinPitch, cosYaw));
+		const XMVECTOR r20 = XMVectorMultiply(cosPitch, sinYaw);
+		const XMVECTOR r21 = XMVectorNegate(sinPitch);
+		const XMVECTOR r22 = XMVectorMultiply(cosPitch, cosYaw);
+
+		// תúĵjModelĵjУת4x4鼴ɵõÿʵһ
+		const XMMATRIX row0 = XMMatrixTranspose(XMMATRIX(
+			XMVectorMultiply(scaleX, r00), XMVectorMultiply(scaleY, r10), XMVectorMultiply(scaleZ, r20),
+			XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_positionX[idx]))));
+		const XMMATRIX row1 = XMMatrixTranspose(XMMATRIX(
+			XMVectorMultiply(scaleX, r01), XMVectorMultiply(scaleY, r11), XMVectorMultiply(scaleZ, r21),
+			XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_positionY[idx]))));
+		const XMMATRIX row2 = XMMatrixTranspose(XMMATRIX(
+			XMVectorMultiply(scaleX, r02), XMVectorMultiply(scaleY, r12), XMVectorMultiply(scaleZ, r22),
+			XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_positionZ[idx]))));
+
+		const uint32_t lanes = std::min(4U, count - base);
+		for (uint32_t lane = 0; lane < lanes; ++lane)
+		{
+			XMFLOAT4X4& model = out[base + lane];
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&model._11), row0.r[lane]);
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&model._21), row1.r[lane]);
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&model._31), row2.r[lane]);
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&model._41), g_XMIdentityR3);
+		}
+	}
+}
+
+void TransformStore::Resize(uint32_t size)
+{
+	m_size = size;
+	const size_t capacity = static_cast<size_t>(size) + simdPadding;
+	m_scaleX.resize(capacity, 1.0f);
+	m_scaleY.resize(capacity, 1.0f);
+	m_scaleZ.resize(capacity, 1.0f);
+	m_rotationX.resize(capacity, 0.0f);
+	m_rotationY.resize(capacity, 0.0f);
+	m_rotationZ.resize(capacity, 0.0f);
+	m_positionX.resize(capacity, 0.0f);
+	m_positionY.resize(capacity, 0.0f);
+	m_positionZ.resize(capacity, 0.0f);
+	// ·ʵҪдȫ֡Դ
+	m_dirty.resize(capacity, static_cast<uint8_t>(frameResourcesCount));
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+#include "FrameConfig.h"
+#include "Singleton.hpp"
+#include "Transform.h"
+
+/*
+ * SoAʽ洢ʵšתƽƣÿʵʶ
+ * ʶMaterialDataͬ޸ĺΪframeResourcesCountÿдһ֡Դݼ㼴ϴ
+ */
+class TransformStore : public Singleton<TransformStore>
+{
+public:
+	explicit TransformStore(typename Singleton<TransformStore>::Token);
+	TransformStore(const TransformStore&) = delete;
+	TransformStore& operator=(const TransformStore&) = delete;
+	TransformStore(TransformStore&&) = delete;
+	TransformStore& operator=(TransformStore&&) = delete;
+	~TransformStore() override = default;
+
+	// countʵ׸ʵľ
+	uint32_t Allocate(uint32_t count);
+	// [start, start + count)֮׷һʵ䲻ĩβǨƵĩβµʼ
+	uint32_t Grow(uint32_t start, uint32_t count);
+	uint32_t GetSize() const;
+
+	void SetScale(uint32_t idx, const XMFLOAT3& scale);
+	void SetRotation(uint32_t idx, const XMFLOAT3& rotation);
+	void SetPosition(uint32_t idx, const XMFLOAT3& position);
+	Transform GetTransform(uint32_t idx) const;
+	void MarkDirty(uint32_t start, uint32_t count);
+
+	/*
+	 * [start, start + count)Դʶfunc(first, size)Щʵʶݼ
+	 * ͬĵûӰ죬ڶ߳вдཻ
+	 */
+	template <typename Func>
+	void ConsumeDirtyRanges(uint32_t start, uint32_t count, Func&& func);
+	// 4ʵΪһģ;תúľԱֱϴ
+	void ComposeTransposed(uint32_t start, uint32_t count, XMFLOAT4X4* out) const;
+private:
+	void Resize(uint32_t size);
+private:
+	// ĩβⱣʵʹSIMD4ʵʱԽ
+	static constexpr uint32_t	simdPadding = 3;
+
+	std::vector<float>		m_scaleX;
+	std::vector<float>		m_scaleY;
+	std::vector<float>		m_scaleZ;
+	std::vector<float>		m_rotationX;
+	std::vector<float>		m_rotationY;
+	std::vector<float>		m_rotationZ;
+	std::vector<float>		m_positionX;
+	std::vector<float>		m_positionY;
+	std::vector<float>		m_positionZ;
+	std::vector<uint8_t>	m_dirty;
+	uint32_t				m_size{ 0 };
+};
+
+template <typename Func>
+void TransformStore::ConsumeDirtyRanges(uint32_t start, uint32_t count, Func&& func)
+{
+	const uint32_t end = start + count;
+	uint32_t idx = start;
+	while (idx < end)
+	{
+		if (m_dirty[idx] == 0)
+		{
+			++idx;
+			continue;
+		}
+		uint32_t rangeEnd = idx;
+		while (rangeEnd < end && m_dirty[rangeEnd] > 0)
+		{
+			--m_dirty[rangeEnd];
+			++rangeEnd;
+		}
+		func(idx, rangeEnd - idx);
+		idx = rangeEnd;
+	}
+}
@@ -0,0 +1,57 @@
+#include "UploadRing.h"
+#include <stdexcept>
+
+UploadRing::UploadRing(Singleton<UploadRing>::Token) : Singleton<UploadRing>()
+{
+}
+
+UploadRing::~UploadRing()
+{
+	if (m_uploadBuffer != nullptr)
+	{
+		m_uploadBuffer->Unmap(0, nullptr);
+	}
+	m_data = nullptr;
+}
+
+void UploadRing::Init(ID3D12Device* device, UINT64 capacity)
+{
+	const auto& property = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	const auto& buffer = CD3DX12_RESOURCE_DESC::Buffer(capacity);
+	ThrowIfFailed(device->CreateCommittedResource(
+		&property,
+		D3D12_HEAP_FLAG_NONE,
+		&buffer,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&m_uploadBuffer)));
+	m_uploadBuffer->SetName(L"Upload Ring");
+	// ־ӳ䣬дGPUȡ֮ͬΧ֤
+	ThrowIfFailed(m_uploadBuffer->Map(0, nullptr, reinterpret_cast<void**>(&m_data)));
+	m_ring = std::make_unique<RingAllocator>(capacity);
+}
+
+UploadAllocation UploadRing::Allocate(UINT64 size, UINT64 alignment)
+{
+	const UINT64 offset = m_ring->Allocate(size, alignment);
+	if (offset == RingAllocator::invalidOffset)
+	{
+		throw std::runtime_error("UploadRing: out of memory");
+	}
+	UploadAllocation allocation;
+	allocation.cpuAddress = m_data + offset;
+	allocation.gpuAddress = m_uploadBuffer->GetGPUVirtualAddress() + offset;
+	allocation.resource = m_uploadBuffer.Get();
+	allocation.offset = offset;
+	return allocation;
+}
+
+void UploadRing::FinishFrame(UINT64 fence)
+{
+	m_ring->FinishFrame(fence);
+}
+
+void UploadRing::Reclaim(UINT64 completedFence)
+{
+	m_ring->Reclaim(completedFence);
+}
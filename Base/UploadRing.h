@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <D3DUtil.hpp>
+#include "RingAllocator.hpp"
+#include "Singleton.hpp"
+
+using Microsoft::WRL::ComPtr;
+
+/*
+ * ϴеһӷ䣬ֻڷڵ֡Ч
+ */
+struct UploadAllocation
+{
+	BYTE*						cpuAddress{ nullptr };
+	D3D12_GPU_VIRTUAL_ADDRESS	gpuAddress{ 0 };
+	UINT						elementByteSize{ 0 };
+	ID3D12Resource*				resource{ nullptr };	// ΪCopyBufferRegionԴʱʹ
+	UINT64						offset{ 0 };
+
+	template <typename T>
+	void Copy(UINT elementIndex, const T& data) const
+	{
+		memcpy(cpuAddress + static_cast<size_t>(elementIndex) * elementByteSize, &data, sizeof(T));
+	}
+	D3D12_GPU_VIRTUAL_ADDRESS GetAddress(UINT elementIndex = 0) const
+	{
+		return gpuAddress + static_cast<UINT64>(elementIndex) * elementByteSize;
+	}
+};
+
+/*
+ * ֡һ־ӳϴѣÿ֡дĳ
+ * ֻ߳нУ֡ύΧֵǣGPUִɺReclaim
+ * Ҫ֡ݵ(ʶµʵ)ʹ֡ԴеUploaderBuffer
+ */
+class UploadRing : public Singleton<UploadRing>
+{
+public:
+	explicit UploadRing(typename Singleton<UploadRing>::Token);
+	~UploadRing() override;
+	UploadRing(const UploadRing&) = delete;
+	UploadRing& operator=(const UploadRing&) = delete;
+	UploadRing(UploadRing&&) = delete;
+	UploadRing& operator=(UploadRing&&) = delete;
+
+	void Init(ID3D12Device* device, UINT64 capacity);
+	// ռ䲻ʱ׳쳣˵;֡
+	UploadAllocation Allocate(UINT64 size, UINT64 alignment);
+	// ÿԪذ256ֽڶ룬ఴԪؽ
+	template <typename T>
+	UploadAllocation Allocate(UINT elementCount, bool isConstantBuffer)
+	{
+		const UINT elementByteSize = isConstantBuffer ? D3DUtil::AlignsConstantBuffer(sizeof(T)) : static_cast<UINT>(sizeof(T));
+		const UINT64 alignment = isConstantBuffer ? D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT : D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT;
+		auto allocation = Allocate(static_cast<UINT64>(elementByteSize) * elementCount, alignment);
+		allocation.elementByteSize = elementByteSize;
+		return allocation;
+	}
+	void FinishFrame(UINT64 fence);
+	void Reclaim(UINT64 completedFence);
+private:
+	ComPtr<ID3D12Resource>			m_uploadBuffer;
+	BYTE*							m_data{ nullptr };
+	std::unique_ptr<RingAllocator>	m_ring;
+};
@@ -65,6 +65,19 @@ public:
 	{
 		memcpy(&m_data[elementIndex * m_elementByteSize], &data, sizeof(T));
 	}
+	// countԪأǳԪؽУһο
+	void CopyRange(int startIndex, const T* data, UINT count)
+	{
+		if (!m_isConstantBuffer)
+		{
+			memcpy(&m_data[startIndex * m_elementByteSize], data, sizeof(T) * count);
+			return;
+		}
+		for (UINT i = 0; i < count; ++i)
+		{
+			memcpy(&m_data[(startIndex + i) * m_elementByteSize], &data[i], sizeof(T));
+		}
+	}
 	ID3D12Resource* GetResource() const
 	{
 		return m_uploadBuffer.Get();
@@ -43,7 +43,7 @@ public:
 	void InitPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& templateDesc) override;
 	void CreateDescriptors(D3D12_CPU_DESCRIPTOR_HANDLE cpuSRVStart, D3D12_GPU_DESCRIPTOR_HANDLE gpuSRVStart, D3D12_CPU_DESCRIPTOR_HANDLE cpuRTVStart, UINT srvSize, UINT rtvSize);
 	void Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc) override;
-	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const override;
+	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) override;
 private:
 	void CreateBlurPass(bool horizontal) const;
 	void CreateResources() override;
@@ -134,9 +134,10 @@ void BilateralBlur<T, enable_if_t<blurByType<T>::value == 0, int>>::Update
 
 template <typename T>
 void BilateralBlur<T, enable_if_t<blurByType<T>::value == 0, int>>::Draw
-(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const
+(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc)
 {
 	ChangeState<D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET>(cmdList, horizontalRes.Get());
+	FlushBarriers(cmdList);
 	cmdList->ClearRenderTargetView(horizontalRTV, Colors::White, 0, nullptr);
 	cmdList->OMSetRenderTargets(1, &horizontalRTV, true, nullptr);
 	drawFunc(NULL); // ģ
@@ -147,6 +148,7 @@ void BilateralBlur<T, enable_if_t<blurByType<T>::value == 0, int>>::Draw
 	ChangeState<D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList, horizontalRes.Get());
 
 	ChangeState<D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_RENDER_TARGET>(cmdList, m_resource.Get());
+	FlushBarriers(cmdList);
 	cmdList->ClearRenderTargetView(m_cpuRTV, Colors::White, 0, nullptr);
 	cmdList->OMSetRenderTargets(1, &m_cpuRTV, true, nullptr);
 	cmdList->SetGraphicsRootConstantBufferView(10, blurUploader->GetResource()->GetGPUVirtualAddress() );
@@ -232,7 +234,7 @@ public:
 	void InitPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& templateDesc) override;
 	void CreateDescriptors(D3D12_CPU_DESCRIPTOR_HANDLE cpuSrvStart, D3D12_GPU_DESCRIPTOR_HANDLE gpuSrvStart, UINT srvSize);
 	void Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc) override;
-	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const override;
+	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) override;
 
 	ID3D12Resource* GetDownResource() const { return m_downUp->GetDownSamplerResource(); } 
 	ID3D12Resource* GetUpResource() const { return m_downUp->GetUpSamplerResource(); }
@@ -353,7 +355,7 @@ void BilateralBlur<T, enable_if_t<blurByType<T>::value == 1, int>>::Update
 
 template <typename T>
 void BilateralBlur<T, enable_if_t<blurByType<T>::value == 1, int>>::Draw(
-	ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const
+	ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc)
 {
 	// copyResources phase
 	ChangeState<D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST>(cmdList, GetDownResource());
@@ -377,6 +379,7 @@ void BilateralBlur<T, enable_if_t<blurByType<T>::value == 1, int>>::Draw(
 		cmdList->SetPipelineState(m_pso.Get());
 		cmdList->SetComputeRootDescriptorTable(1, m_gpuSRV);
 		cmdList->SetComputeRootDescriptorTable(2, downGpuUAV);
+		FlushBarriers(cmdList);
 		cmdList->Dispatch(horizontalGroupX, shrinkHeight, 1);
 
 		ChangeState<D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList, downSamplerRes.Get());
@@ -386,6 +389,7 @@ void BilateralBlur<T, enable_if_t<blurByType<T>::value == 1, int>>::Draw(
 		cmdList->SetPipelineState(m_verticalPso.Get());
 		cmdList->SetComputeRootDescriptorTable(1, downGpuSRV);
 		cmdList->SetComputeRootDescriptorTable(2, m_gpuUAV);
+		FlushBarriers(cmdList);
 		cmdList->Dispatch(shrinkWidth, verticalGroupY, 1);
 
 		ChangeState<D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_UNORDERED_ACCESS>(cmdList, downSamplerRes.Get());
@@ -0,0 +1,194 @@
+#include "CascadeScheduler.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace Effect;
+using namespace DirectX;
+
+namespace
+{
+// [0, size)
+int32_t Wrap(int64_t value, uint32_t size)
+{
+	const int64_t wrapped = value % static_cast<int64_t>(size);
+	return static_cast<int32_t>(wrapped < 0 ? wrapped + size : wrapped);
+}
+}
+
+CascadeScheduler::CascadeScheduler(uint32_t cascadeCount, uint32_t everyFrameCount, float lightAngleThreshold)
+: m_everyFrameCount(std::min(everyFrameCount, cascadeCount)), m_cosThreshold(std::cos(std::max(lightAngleThreshold, 0.0f))), m_cascades(cascadeCount)
+{
+}
+
+XMFLOAT3 CascadeScheduler::BeginFrame(const XMFLOAT3& lightDir)
+{
+	if (m_hasLight)
+		++m_frameIndex;
+	for (auto& cascade : m_cascades)
+	{
+		cascade.work = CascadeWork::skip;
+		cascade.exposedCount = 0;
+	}
+	const float length = std::sqrt(lightDir.x * lightDir.x + lightDir.y * lightDir.y + lightDir.z * lightDir.z);
+	if (length <= 0.0f)
+		return m_lightDir;
+	const XMFLOAT3 dir{ lightDir.x / length, lightDir.y / length, lightDir.z / length };
+	const float cosAngle = dir.x * m_lightDir.x + dir.y * m_lightDir.y + dir.z * m_lightDir.z;
+	if (!m_hasLight || cosAngle < m_cosThreshold)
+	{
+		// տռı䣬мҪػ
+		m_lightDir = dir;
+		m_hasLight = true;
+		Invalidate();
+	}
+	return m_lightDir;
+}
+
+bool CascadeScheduler::ShouldUpdate(uint32_t idx, const CascadeRect& slice) const
+{
+	assert(idx < m_cascades.size());
+	const auto& cascade = m_cascades[idx];
+	if (!cascade.valid || idx < m_everyFrameCount)
+		return true;
+	// ֲԶ׶뿪һεĴںþɵӰȱʧҪ
+	const CascadeFit& fit = cascade.fit;
+	const int64_t size = fit.resolution;
+	if (slice.minX < fit.x || slice.minY < fit.y || slice.maxX > fit.x + size || slice.maxY > fit.y + size)
+		return true;
+	const uint32_t farCount = static_cast<uint32_t>(m_cascades.size()) - m_everyFrameCount;
+	return idx - m_everyFrameCount == m_frameIndex % farCount;
+}
+
+CascadeWork CascadeScheduler::Submit(uint32_t idx, const CascadeFit& fit)
+{
+	assert(idx < m_cascades.size());
+	auto& cascade = m_cascades[idx];
+	CascadeFit& cached = cascade.fit;
+	const bool sameGrid = fit.resolution == cached.resolution && fit.texelSize == cached.texelSize;
+	// ̬ƶȷΧܱ仯ֻҪڻķΧھͲҪػ澲̬
+	const bool depthContained = fit.nearZ <= cached.nearZ && fit.farZ >= cached.farZ;
+	const int64_t dx = static_cast<int64_t>(fit.x) - cached.x;
+	const int64_t dy = static_cast<int64_t>(fit.y) - cached.y;
+	const int64_t size = fit.resolution;
+	cascade.exposedCount = 0;
+	if (!cascade.valid || !sameGrid || !depthContained || std::abs(dx) >= size || std::abs(dy) >= size)
+	{
+		cached = fit;
+		cascade.originX = fit.x;
+		cascade.originY = fit.y;
+		cascade.valid = true;
+		cascade.work = CascadeWork::full;
+		return cascade.work;
+	}
+	if (dx == 0 && dy == 0)
+	{
+		cascade.work = CascadeWork::dynamicOnly;
+		return cascade.work;
+	}
+	/*
+	 * ƽƺ¶ԴеСбʾ0Ϊտռyһ
+	 * ȡеȥ֮صĲ
+	 */
+	const int32_t res = static_cast<int32_t>(size);
+	int32_t columnMin = 0;
+	int32_t columnMax = res;
+	if (dx != 0)
+	{
+		const int32_t width = static_cast<int32_t>(std::abs(dx));
+		const int32_t begin = dx > 0 ? res - width : 0;
+		cascade.exposed[cascade.exposedCount++] = { begin, 0, begin + width, res };
+		columnMin = dx > 0 ? 0 : width;
+		columnMax = dx > 0 ? res - width : res;
+	}
+	if (dy != 0)
+	{
+		const int32_t height = static_cast<int32_t>(std::abs(dy));
+		const int32_t begin = dy > 0 ? 0 : res - height;
+		cascade.exposed[cascade.exposedCount++] = { columnMin, begin, columnMax, begin + height };
+	}
+	// ͶӰûȷΧֻƽƴ
+	cached.x = fit.x;
+	cached.y = fit.y;
+	cascade.work = CascadeWork::scroll;
+	return cascade.work;
+}
+
+void CascadeScheduler::Invalidate()
+{
+	for (auto& cascade : m_cascades)
+	{
+		cascade.valid = false;
+	}
+}
+
+CascadeWork CascadeScheduler::GetWork(uint32_t idx) const
+{
+	assert(idx < m_cascades.size());
+	return m_cascades[idx].work;
+}
+
+const CascadeFit& CascadeScheduler::GetCachedFit(uint32_t idx) const
+{
+	assert(idx < m_cascades.size());
+	return m_cascades[idx].fit;
+}
+
+uint32_t CascadeScheduler::GetCacheRects(uint32_t idx, CascadeCacheRect* rects) const
+{
+	assert(idx < m_cascades.size());
+	const auto& cascade = m_cascades[idx];
+	const int32_t res = static_cast<int32_t>(cascade.fit.resolution);
+	if (cascade.work == CascadeWork::full)
+	{
+		rects[0] = { 0, 0, res, res, 0, 0 };
+		return 1;
+	}
+	if (cascade.work != CascadeWork::scroll)
+		return 0;
+	// еĵcбڻĵ(c + offset) % resУα߽Ĳʹòͬӿԭ
+	const XMINT2 offset = GetCacheOffset(idx);
+	const int32_t splitX = res - offset.x;
+	const int32_t splitY = res - offset.y;
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < cascade.exposedCount; ++i)
+	{
+		const CascadeRect& exposed = cascade.exposed[i];
+		const int32_t columns[2][3] = { { exposed.minX, std::min(exposed.maxX, splitX), offset.x },
+			{ std::max(exposed.minX, splitX), exposed.maxX, offset.x - res } };
+		const int32_t rows[2][3] = { { exposed.minY, std::min(exposed.maxY, splitY), offset.y },
+			{ std::max(exposed.minY, splitY), exposed.maxY, offset.y - res } };
+		for (const auto& row : rows)
+		{
+			for (const auto& column : columns)
+			{
+				if (column[0] >= column[1] || row[0] >= row[1])
+					continue;
+				assert(count < maxCacheRects);
+				rects[count++] = { column[0] + column[2], row[0] + row[2], column[1] + column[2], row[1] + row[2], column[2], row[2] };
+			}
+		}
+	}
+	return count;
+}
+
+XMINT2 CascadeScheduler::GetCacheOffset(uint32_t idx) const
+{
+	assert(idx < m_cascades.size());
+	const auto& cascade = m_cascades[idx];
+	if (cascade.fit.resolution == 0)
+		return { 0, 0 };
+	// տռ+yƽʱ0жӦĻƶ
+	return { Wrap(static_cast<int64_t>(cascade.fit.x) - cascade.originX, cascade.fit.resolution),
+		Wrap(static_cast<int64_t>(cascade.originY) - cascade.fit.y, cascade.fit.resolution) };
+}
+
+uint32_t CascadeScheduler::GetCascadeCount() const
+{
+	return static_cast<uint32_t>(m_cascades.size());
+}
+
+uint64_t CascadeScheduler::GetFrameIndex() const
+{
+	return m_frameIndex;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+namespace Effect
+{
+// տռtexelΪλľΣmax
+struct CascadeRect
+{
+	int32_t		minX{ 0 };
+	int32_t		minY{ 0 };
+	int32_t		maxX{ 0 };
+	int32_t		maxY{ 0 };
+};
+
+/*
+ * ڹտռеϽ
+ * ͶӰXYΧΪ(x, y)ʼ߳resolutiontexelڣtexelı߳texelSizeֻͶӰйأλ޹
+ * ƶʱֻtexelƽƣtexelʾԱ㾫ȷȽ
+ */
+struct CascadeFit
+{
+	int32_t		x{ 0 };
+	int32_t		y{ 0 };
+	uint32_t	resolution{ 0 };
+	float		texelSize{ 0.0f };
+	float		nearZ{ 0.0f };	// տռͶӰȷΧnearZ >= farZ
+	float		farZ{ 0.0f };
+};
+
+// ̬ҪػһԼͼеӿԭΪ(viewportX, viewportY)߳뼶ͬ
+struct CascadeCacheRect
+{
+	int32_t		left{ 0 };
+	int32_t		top{ 0 };
+	int32_t		right{ 0 };
+	int32_t		bottom{ 0 };
+	int32_t		viewportX{ 0 };
+	int32_t		viewportY{ 0 };
+};
+
+// ڱ֡ҪɵĹ
+enum class CascadeWork : uint8_t
+{
+	skip = 0,		// һεӰ
+	dynamicOnly,	// ̬Чƾ̬Ⱥֻƶ̬
+	scroll,			// ƽƣֻھ̬ػ¶ٻƶ̬
+	full			// »ƾ̬棬ٻƶ̬
+};
+
+/*
+ * Ӱĸµ뾲̬ʧЧжϣD3D豸
+ * 1. ǰeveryFrameCountÿ֡£Զ£ÿֻ֡һ׶뿪һεĴʱ
+ * 2. Դ뻺ʱķнǲֵʱûʱķ򣬳ֵмõĹտռı䣬ȫ֡ػ
+ * 3. ̬ȷΧ޹أƽʱ̬水Ѱַ棬ֻػ¶texel
+ *    еλ = (еλ + GetCacheOffset) % resolutionڵĵ0Ϊտռyһ
+ */
+class CascadeScheduler
+{
+public:
+	static constexpr uint32_t	maxCacheRects = 8;	// ¶౻α߽ΪĿ
+
+	CascadeScheduler(uint32_t cascadeCount, uint32_t everyFrameCount, float lightAngleThreshold);
+	CascadeScheduler(const CascadeScheduler&) = delete;
+	CascadeScheduler& operator=(const CascadeScheduler&) = delete;
+	CascadeScheduler(CascadeScheduler&&) = default;
+	CascadeScheduler& operator=(CascadeScheduler&&) = default;
+	~CascadeScheduler() = default;
+
+	// ÿ֡ʼʱãlightDirһر֡ӰʹõĹԴ
+	DirectX::XMFLOAT3 BeginFrame(const DirectX::XMFLOAT3& lightDir);
+	// ֡ǷҪϸüsliceΪ׶ڹտռеķΧ
+	bool ShouldUpdate(uint32_t idx, const CascadeRect& slice) const;
+	// ύϵĽ֮ͬԲе
+	CascadeWork Submit(uint32_t idx, const CascadeFit& fit);
+	// ̬仯ͼֱ仯·Ǻãһ֡мػ
+	void Invalidate();
+
+	CascadeWork GetWork(uint32_t idx) const;
+	// ǰʹõϽȷΧΪ̬ȷΧܱһύķΧ
+	const CascadeFit& GetCachedFit(uint32_t idx) const;
+	// ֡Ҫھ̬ػfullʱΪ򣬷
+	uint32_t GetCacheRects(uint32_t idx, CascadeCacheRect* rects) const;
+	// ڵ̬ĻƫƣΧΪ[0, resolution)
+	DirectX::XMINT2 GetCacheOffset(uint32_t idx) const;
+	uint32_t GetCascadeCount() const;
+	uint64_t GetFrameIndex() const;
+private:
+	struct CascadeState
+	{
+		CascadeFit			fit;
+		CascadeWork			work{ CascadeWork::skip };
+		bool				valid{ false };
+		// һfullʱڵ㣬̬ԴΪԭ㻷Ѱַ
+		int32_t				originX{ 0 };
+		int32_t				originY{ 0 };
+		CascadeRect			exposed[2];	// ֡¶ĴԴебʾ
+		uint32_t			exposedCount{ 0 };
+	};
+
+	uint32_t					m_everyFrameCount;
+	float						m_cosThreshold;
+	uint64_t					m_frameIndex{ 0 };
+	bool						m_hasLight{ false };
+	DirectX::XMFLOAT3			m_lightDir{ 0.0f, 0.0f, 0.0f };
+	std::vector<CascadeState>	m_cascades;
+};
+}
@@ -2,15 +2,19 @@
 #include "Texture.h"
 #include "RtvDsvMgr.h"
 #include "Scene.h"
+#include "ThreadPool.hpp"
 #include <DirectXCollision.h>
+#include <numeric>
 
 using namespace Effect;
 using namespace Models;
 
 CascadedShadow::CascadedShadow(ID3D12Device* _device, UINT _width)
-: RenderToTexture(_device, _width, _width, DXGI_FORMAT_R32_TYPELESS), cascadedUploader(std::make_unique<UploaderBuffer<CascadedShadowPass>>(_device, 1, true))
+: RenderToTexture(_device, _width, _width, DXGI_FORMAT_R32_TYPELESS), m_atlas(_width, minCascadeSize),
+m_scheduler(cascadeLevels, everyFrameCascades, cacheLightAngle)
 {
-	m_dsvOffset = RtvDsvMgr::instance().RegisterDSV(cascadeLevels);
+	// Ӱͼ뾲̬ռһDSV
+	m_dsvOffset = RtvDsvMgr::instance().RegisterDSV(2);
 	m_passOffset = PassConstant::RegisterPassCount(cascadeLevels);
 	CreateResources();
 }
@@ -18,49 +22,32 @@ CascadedShadow::CascadedShadow(ID3D12Device* _device, UINT _width)
 void CascadedShadow::CreateDescriptors(D3D12_CPU_DESCRIPTOR_HANDLE cpuSrvStart, D3D12_GPU_DESCRIPTOR_HANDLE gpuSrvStart,
 	D3D12_CPU_DESCRIPTOR_HANDLE cpuDsvStart, UINT srvSize, UINT dsvSize)
 {
-	CD3DX12_CPU_DESCRIPTOR_HANDLE cpuSrvHandler(cpuSrvStart, static_cast<INT>(m_srvOffset), srvSize);
-	m_cpuSRV = cpuSrvHandler;
-	m_shadowCpuSRV[0] = cpuSrvHandler.Offset(1, srvSize);
-	m_shadowCpuSRV[1] = cpuSrvHandler.Offset(1, srvSize);
-	m_shadowCpuSRV[2] = cpuSrvHandler.Offset(1, srvSize);
-	m_shadowCpuSRV[3] = cpuSrvHandler.Offset(1, srvSize);
-	CD3DX12_GPU_DESCRIPTOR_HANDLE gpuSrvHandler(gpuSrvStart, static_cast<INT>(m_srvOffset), srvSize);
-	m_gpuSRV = gpuSrvHandler;
-	m_shadowGpuSRV[0] = gpuSrvHandler.Offset(1, srvSize);
-	m_shadowGpuSRV[1] = gpuSrvHandler.Offset(1, srvSize);
-	m_shadowGpuSRV[2] = gpuSrvHandler.Offset(1, srvSize);
-	m_shadowGpuSRV[3] = gpuSrvHandler.Offset(1, srvSize);
-	CD3DX12_CPU_DESCRIPTOR_HANDLE cpuDsvHandler(cpuDsvStart, static_cast<INT>(m_dsvOffset), dsvSize);
-	m_cpuDSV[0] = cpuDsvHandler;
-	m_cpuDSV[1] = cpuDsvHandler.Offset(1, dsvSize);
-	m_cpuDSV[2] = cpuDsvHandler.Offset(1, dsvSize);
-	m_cpuDSV[3] = cpuDsvHandler.Offset(1, dsvSize);
-	m_cpuDSV[4] = cpuDsvHandler.Offset(1, dsvSize);
+	m_cpuSRV = CD3DX12_CPU_DESCRIPTOR_HANDLE(cpuSrvStart, static_cast<INT>(m_srvOffset), srvSize);
+	m_gpuSRV = CD3DX12_GPU_DESCRIPTOR_HANDLE(gpuSrvStart, static_cast<INT>(m_srvOffset), srvSize);
+	m_cpuDSV = CD3DX12_CPU_DESCRIPTOR_HANDLE(cpuDsvStart, static_cast<INT>(m_dsvOffset), dsvSize);
+	// ̬SRVӰͼ֮ͬһ
+	m_staticCpuSRV = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_cpuSRV, 1, srvSize);
+	m_staticCpuDSV = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_cpuDSV, 1, dsvSize);
 
 	CreateDescriptors();
 }
 
-void CascadedShadow::InitShader(const wstring& csmName)
+void CascadedShadow::InitShader(const wstring& csmName, const wstring& cacheName)
 {
 	m_shader = std::make_unique<Shader>(default_shader, csmName, initializer_list<D3D12_INPUT_ELEMENT_DESC>({
 		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
 		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0}
 	}));
+	// ƾ̬ʱSV_VertexIDȫΣҪ
+	m_cacheShader = std::make_unique<Shader>(default_shader, cacheName, initializer_list<D3D12_INPUT_ELEMENT_DESC>());
 }
 
 void CascadedShadow::InitTexture(string_view csmName)
 {
-	auto InitCascaded = [](string_view csmName, UINT idx)
-	{
-		string cascadedName(csmName);
-		cascadedName.append(to_string(idx));
-		return TextureMgr::instance().RegisterRenderToTexture(cascadedName);
-	};
-	m_srvOffset = InitCascaded(csmName, 0);
-	for (UINT i = 1; i < cascadeLevels; ++i)
-	{
-		InitCascaded(csmName, i);
-	}
+	m_srvOffset = TextureMgr::instance().RegisterRenderToTexture(csmName);
+	string staticName(csmName);
+	staticName.append("Static");
+	TextureMgr::instance().RegisterRenderToTexture(staticName);
 }
 
 void CascadedShadow::InitPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& templateDesc)
@@ -82,134 +69,250 @@ void CascadedShadow::InitPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& templateD
 	shadowDesc.RTVFormats[0] = DXGI_FORMAT_UNKNOWN;
 	shadowDesc.RTVFormats[1] = DXGI_FORMAT_UNKNOWN;
 	ThrowIfFailed(m_device->CreateGraphicsPipelineState(&shadowDesc, IID_PPV_ARGS(&m_pso)));
+
+	// ̬ԭдͼҪƫȱȽ
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC cacheDesc = shadowDesc;
+	cacheDesc.RasterizerState.DepthBias = 0;
+	cacheDesc.RasterizerState.SlopeScaledDepthBias = 0.0f;
+	cacheDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+	cacheDesc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_ALWAYS;
+	cacheDesc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ALL;
+	cacheDesc.InputLayout = { nullptr, 0 };
+	cacheDesc.VS = { static_cast<BYTE*>(m_cacheShader->GetShaderByType(ShaderPos::vertex)->GetBufferPointer()),
+	m_cacheShader->GetShaderByType(ShaderPos::vertex)->GetBufferSize() };
+	cacheDesc.PS = { static_cast<BYTE*>(m_cacheShader->GetShaderByType(ShaderPos::fragment)->GetBufferPointer()),m_cacheShader->GetShaderByType(ShaderPos::fragment)->GetBufferSize() };
+	ThrowIfFailed(m_device->CreateGraphicsPipelineState(&cacheDesc, IID_PPV_ARGS(&m_cachePso)));
 }
 
 void CascadedShadow::Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc)
 {
-	float frustumStart = 0.0f, frustumEnd = 0.0f;
-	const float cameraNearFarRange = abs(m_camera->m_farPlane - m_camera->m_nearPlane);
-	auto [lightView, lightPos] = std::move(RegisterLightViewXM());
+	// ṹ޷lambdaչΪͨ
+	XMMATRIX lightView;
+	XMVECTOR lightPos;
+	const bool splitsChanged = UpdateSplits();
+	AllocateCascades();
+	const float pixelScale = 2.0f * std::tanf(0.5f * m_camera->m_fov) / m_camera->GetViewPort().Height;
+	// Դתδֵʱûʱķ򣬱֤̬뱾֡Ĺտռһ
+	XMFLOAT3 lightDir;
+	XMStoreFloat3(&lightDir, m_mainLight->GetLightDir());
+	const XMFLOAT3 shadowDir = m_scheduler.BeginFrame(lightDir);
+	std::tie(lightView, lightPos) = RegisterLightViewXM(XMLoadFloat3(&shadowDir));
 	m_shadowView = lightView;
 
 	XMMATRIX camView = std::move(m_camera->GetCurrViewXM());
 	XMMATRIX camProj = std::move(m_camera->GetCurrProjXM());
 	XMMATRIX invCamView = XMMatrixInverse(nullptr, camView);
-	// ׶
-	for (UINT idx = 0; idx < cascadeLevels; ++idx)
+	/*
+	 * ̬޹أȷΧȡڹտռеķΧֻԴı
+	 * ڵtexelֻ߳׶Խ߾ƶʱtexelƽƣ̬֮
+	 */
+	float sceneNearZ;
+	float sceneFarZ;
 	{
-		if (idx > 0)
+		XMFLOAT3 corners[8]{};
+		Scene::sceneBox.GetCorners(corners);
+		XMVECTOR lightMinVec = g_XMFltMax;
+		XMVECTOR lightMaxVec = XMVectorNegate(g_XMFltMax);
+		for (UINT i = 0; i < 8; ++i)
 		{
-			frustumStart = cascadedPercent[idx - 1];
+			const XMVECTOR v = XMVector3Transform(XMLoadFloat3(&corners[i]), lightView);
+			lightMinVec = XMVectorMin(v, lightMinVec);
+			lightMaxVec = XMVectorMax(v, lightMaxVec);
 		}
+		sceneFarZ = XMVectorGetZ(lightMinVec);
+		sceneNearZ = XMVectorGetZ(lightMaxVec);
+	}
+	// ׶, ֻдͶӰPassConstantλ˿Բм
+	Thread::ThreadPool::instance().ParallelFor(0, cascadeLevels, 1, [&](UINT idx)
+	{
 		// ׶Z
-		frustumEnd = cascadedPercent[idx];
-		frustumStart *= cameraNearFarRange;
-		frustumEnd *= cameraNearFarRange;
-		// Ϊÿ׶崴տռµͶӰ, ͨһͶӰTopLeftX, TopLeftY,Width, HeightNearFar
+		const float frustumStart = m_cascadeStart[idx];
+		const float frustumEnd = m_cascadeEnd[idx];
+		// ׶任ռڱ任տռ䣬ڹտռµAABB
 		XMFLOAT3 camFrustumPoints[8];
 		BoundingFrustum camFrustum(camProj);
 		camFrustum.Near = frustumStart;
 		camFrustum.Far = frustumEnd;
-		// ׶任ռڱ任տռ
 		camFrustum.Transform(camFrustum, XMMatrixMultiply(invCamView, lightView));
 		camFrustum.GetCorners(camFrustumPoints);
-		// ׶ڹտռµAABBVMaxVMin
 		BoundingBox shadowAABB;
 		BoundingBox::CreateFromPoints(shadowAABB, 8, camFrustumPoints, sizeof(XMFLOAT3));
-		XMVECTOR lightAABBMin = XMLoadFloat3(&shadowAABB.Center) - XMLoadFloat3(&shadowAABB.Extents);
-		XMVECTOR lightAABBMax = XMLoadFloat3(&shadowAABB.Center) + XMLoadFloat3(&shadowAABB.Extents);
-
-		// ڹ߸ıӽǱ仯˸
-		//     Near    Far
-		//    0----1  4----5
-		//    |    |  |    |
-		//    |    |  |    |
-		//    3----2  7----6
-		XMVECTOR diagVec = XMLoadFloat3(&camFrustumPoints[7]) - XMLoadFloat3(&camFrustumPoints[5]);
-		XMVECTOR diag2Vec = XMLoadFloat3(&camFrustumPoints[7]) - XMLoadFloat3(&camFrustumPoints[1]);
-		XMVECTOR lengthVec = XMVectorMax(XMVector3Length(diagVec), XMVector3Length(diag2Vec));
-		//ͶӰƫ
-		XMVECTOR offset = (lengthVec - (lightAABBMax - lightAABBMin)) * g_XMOneHalf;
-		static const XMVECTOR onlyXY = { 1.0f, 1.0f, 0.0f, 0.0f };
-		lightAABBMax += offset * onlyXY;
-		lightAABBMin -= offset * onlyXY;
 
 		/*
 		 * Ҫڹ߱任ӽǱ仯Ӱ˸
-		 * ԭʱ̲λòͬ²ֵͬǿǼӰͶͼÿtexelеĿȺ͸߶ȣ
-		 * ӰͶͼĿ߷ֱWHֻWHƶ
-		 */ 
-		float invSize = 1.0f / static_cast<float>(m_width);
-		XMVECTOR worldUnitTexelSize = lightAABBMax - lightAABBMin;
-		worldUnitTexelSize *= invSize;
-		lightAABBMax /= worldUnitTexelSize;
-		lightAABBMax = XMVectorFloor(lightAABBMax);
-		lightAABBMax *= worldUnitTexelSize;
-		lightAABBMin /= worldUnitTexelSize;
-		lightAABBMin = XMVectorFloor(lightAABBMin);
-		lightAABBMin *= worldUnitTexelSize;
-
-		XMVECTOR sceneAABBPointLight[8]{};
-		{
-			XMFLOAT3 corners[8]{};
-			Scene::sceneBox.GetCorners(corners);
-			for (UINT i = 0; i < 8; ++i)
-			{
-				XMVECTOR v = XMLoadFloat3(&corners[i]);
-				sceneAABBPointLight[i] = XMVector3Transform(v, lightView);
-			}
-		}
-		// AABBΧеnearZfarZ, ǽAABBĽ任տռ䣬ȻЩminmax
-		XMVECTOR lightMinVec = g_XMFltMax;
-		XMVECTOR lightMaxVec = g_XMFltMin;
-		for (UINT i = 0; i < 8; ++i)
-		{
-			lightMinVec = XMVectorMin(sceneAABBPointLight[i], lightMinVec);
-			lightMaxVec = XMVectorMax(sceneAABBPointLight[i], lightMaxVec);
-		}
-		float farZ = XMVectorGetZ(lightMinVec);
-		float nearZ = XMVectorGetZ(lightMaxVec);
+		 * ԭʱ̲λòͬ²ֵͬ
+		 * ׶⳯µͶӰԽߣԶԽΪڱ߳texel߳λá޹أ
+		 * ֻtexelƶԽ߶һtexelȡܰ׶
+		 */
+		const UINT resolution = m_cascadeRegions[idx].size;
+		const float extent = CascadeExtent(frustumStart, frustumEnd);
+		const float texelSize = extent / static_cast<float>(std::max(resolution, 2U) - 1);
+		const float invTexelSize = 1.0f / texelSize;
+		m_texelsPerPixel[idx] = SampleDistribution::TexelsPerPixel(std::max(frustumStart, m_camera->m_nearPlane), pixelScale, extent, resolution);
+		CascadeRect slice;
+		slice.minX = static_cast<int32_t>(std::floor((shadowAABB.Center.x - shadowAABB.Extents.x) * invTexelSize));
+		slice.minY = static_cast<int32_t>(std::floor((shadowAABB.Center.y - shadowAABB.Extents.y) * invTexelSize));
+		slice.maxX = static_cast<int32_t>(std::ceil((shadowAABB.Center.x + shadowAABB.Extents.x) * invTexelSize));
+		slice.maxY = static_cast<int32_t>(std::ceil((shadowAABB.Center.y + shadowAABB.Extents.y) * invTexelSize));
+		// ֡µԶһεͶӰӰ׶뿪һεĴʱ
+		if (!m_scheduler.ShouldUpdate(idx, slice))
+			return;
 
-		m_shadowProj[idx] = XMMatrixOrthographicOffCenterLH(
-			XMVectorGetX(lightAABBMin), XMVectorGetX(lightAABBMax),
-			XMVectorGetY(lightAABBMin), XMVectorGetY(lightAABBMax),
-			nearZ, farZ);
+		CascadeFit fit;
+		fit.x = static_cast<int32_t>(std::floor((shadowAABB.Center.x - 0.5f * extent) * invTexelSize));
+		fit.y = static_cast<int32_t>(std::floor((shadowAABB.Center.y - 0.5f * extent) * invTexelSize));
+		fit.resolution = resolution;
+		fit.texelSize = texelSize;
+		fit.nearZ = sceneNearZ;
+		fit.farZ = sceneFarZ;
+		m_scheduler.Submit(idx, fit);
+		// ͶӰʼɻϽõ̬ȡƽƺ󲹻붯̬λͬһͶӰռ
+		const CascadeFit& cached = m_scheduler.GetCachedFit(idx);
+		const float left = static_cast<float>(cached.x) * cached.texelSize;
+		const float bottom = static_cast<float>(cached.y) * cached.texelSize;
+		const float size = static_cast<float>(cached.resolution) * cached.texelSize;
+		m_shadowProj[idx] = XMMatrixOrthographicOffCenterLH(left, left + size, bottom, bottom + size, cached.nearZ, cached.farZ);
 		m_depthFloatFrustum[idx] = frustumEnd;
 		XMMATRIX lightVP = XMMatrixMultiply(lightView, m_shadowProj[idx]);
 
 		// Update Shadow Map PassConstant
+		const float invSize = 1.0f / static_cast<float>(resolution);
 		PassConstant shadowPass{};
 		XMStoreFloat4x4(&shadowPass.view_gpu, XMMatrixTranspose(lightView));
 		XMStoreFloat4x4(&shadowPass.proj_gpu, XMMatrixTranspose(m_shadowProj[idx]));
 		XMStoreFloat4x4(&shadowPass.vp_gpu, XMMatrixTranspose(lightVP));
-		shadowPass.nearZ_gpu = nearZ;
-		shadowPass.farZ_gpu = farZ;
-		shadowPass.renderTargetSize_gpu = std::move(XMFLOAT2(
-			static_cast<float>(m_width), static_cast<float>(m_height)));
-		shadowPass.invRenderTargetSize_gpu = std::move(XMFLOAT2(
-			1.0f / static_cast<float>(m_width), 1.0f / static_cast<float>(m_height)));
+		shadowPass.nearZ_gpu = cached.nearZ;
+		shadowPass.farZ_gpu = cached.farZ;
+		shadowPass.renderTargetSize_gpu = std::move(XMFLOAT2(static_cast<float>(resolution), static_cast<float>(resolution)));
+		shadowPass.invRenderTargetSize_gpu = std::move(XMFLOAT2(invSize, invSize));
 		XMStoreFloat3(&shadowPass.cameraPos_gpu, lightPos);
 		updateFunc(m_passOffset + idx, shadowPass);
-	}
+	});
 	// Update Cascaded Shadow Map Uploader Buffer
 	SyncWithShadowPass();
+#if defined(DEBUG) || defined(_DEBUG)
+	if (splitsChanged)
+	{
+		string text("CascadedShadow splits:");
+		for (UINT idx = 0; idx < cascadeLevels; ++idx)
+		{
+			text += " [" + std::to_string(m_cascadeStart[idx]) + ", " + std::to_string(m_cascadeEnd[idx]) + "] texels/pixel " + std::to_string(m_texelsPerPixel[idx]);
+		}
+		text += "\n";
+		OutputDebugStringA(text.c_str());
+	}
+#endif
 }
 
-void CascadedShadow::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const
+void CascadedShadow::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc)
 {
-	cmdList->RSSetViewports(1, &m_viewport);
-	cmdList->RSSetScissorRects(1, &m_scissorRect);
+	// ־̬붯̬壬мֱӻƵͼУ̬治£֮InvalidateCache
+	ChangeState<D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_DEPTH_WRITE>(cmdList, m_resource.Get());
 	for (UINT idx = 0; idx < cascadeLevels; ++idx)
 	{
-		ChangeState<D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_DEPTH_WRITE>(cmdList, GetCascadedRes(idx));
-		cmdList->ClearDepthStencilView(m_cpuDSV[idx], D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 0.0f, 0, 0, nullptr);
-		cmdList->OMSetRenderTargets(0, nullptr, false, &m_cpuDSV[idx]);
-		cmdList->SetPipelineState(m_pso.Get());
+		SetCascadeTarget(cmdList, idx, m_cpuDSV);
+		FlushBarriers(cmdList);
+		cmdList->ClearDepthStencilView(m_cpuDSV, D3D12_CLEAR_FLAG_DEPTH, 0.0f, 0, 1, &m_cascadeScissors[idx]);
 		drawFunc(m_passOffset + idx);
-		ChangeState<D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList, GetCascadedRes(idx));
+	}
+	ChangeState<D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList, m_resource.Get());
+}
+
+void CascadedShadow::BeginCascades(ID3D12GraphicsCommandList* cmdList) const
+{
+	ChangeState<D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_DEPTH_WRITE>(cmdList, m_resource.Get());
+	if (HasStaticWork())
+	{
+		ChangeState<D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_DEPTH_WRITE>(cmdList, m_staticResource.Get());
+	}
+}
+
+UINT CascadedShadow::GetStaticRectCount(UINT idx) const
+{
+	CascadeCacheRect rects[CascadeScheduler::maxCacheRects];
+	return m_scheduler.GetCacheRects(idx, rects);
+}
+
+void CascadedShadow::BindStaticCascade(ID3D12GraphicsCommandList* cmdList, UINT idx, UINT rectIdx, bool clear) const
+{
+	CascadeCacheRect rects[CascadeScheduler::maxCacheRects];
+	const UINT count = m_scheduler.GetCacheRects(idx, rects);
+	assert(rectIdx < count);
+	const CascadeCacheRect& rect = rects[rectIdx];
+	const ShadowAtlasRegion& region = m_cascadeRegions[idx];
+	// ̬滷ѰַӿڰƫƷãԽı߽磬ɲü޶ΪҪػĲ
+	const D3D12_VIEWPORT viewport = { static_cast<float>(static_cast<INT>(region.x) + rect.viewportX), static_cast<float>(static_cast<INT>(region.y) + rect.viewportY),
+		static_cast<float>(region.size), static_cast<float>(region.size), 0.0f, 1.0f };
+	const D3D12_RECT scissor = { static_cast<LONG>(region.x) + rect.left, static_cast<LONG>(region.y) + rect.top,
+		static_cast<LONG>(region.x) + rect.right, static_cast<LONG>(region.y) + rect.bottom };
+	cmdList->RSSetViewports(1, &viewport);
+	cmdList->RSSetScissorRects(1, &scissor);
+	cmdList->OMSetRenderTargets(0, nullptr, false, &m_staticCpuDSV);
+	cmdList->SetPipelineState(m_pso.Get());
+	if (clear)
+	{
+		// ֻҪػ
+		FlushBarriers(cmdList);
+		cmdList->ClearDepthStencilView(m_staticCpuDSV, D3D12_CLEAR_FLAG_DEPTH, 0.0f, 0, 1, &scissor);
+	}
+}
+
+void CascadedShadow::EndStaticCascades(ID3D12GraphicsCommandList* cmdList) const
+{
+	ChangeState<D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList, m_staticResource.Get());
+}
+
+void CascadedShadow::BindCascade(ID3D12GraphicsCommandList* cmdList, UINT idx, bool composite) const
+{
+	assert(m_scheduler.GetWork(idx) != CascadeWork::skip);
+	SetCascadeTarget(cmdList, idx, m_cpuDSV);
+	if (composite)
+	{
+		// Ծ̬ȸǸü򣬴̬滷Ѱַ贫ƫ
+		const ShadowAtlasRegion& region = m_cascadeRegions[idx];
+		const XMINT2 offset = m_scheduler.GetCacheOffset(idx);
+		const UINT constants[4] = { region.x, region.y, region.size, static_cast<UINT>(offset.x) | (static_cast<UINT>(offset.y) << 16) };
+		cmdList->SetPipelineState(m_cachePso.Get());
+		cmdList->SetGraphicsRootDescriptorTable(5, m_gpuSRV);
+		cmdList->SetGraphicsRoot32BitConstants(cacheConstantRootParam, 4, constants, 0);
+		cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		FlushBarriers(cmdList);
+		cmdList->DrawInstanced(3, 1, 0, 0);
+		cmdList->SetPipelineState(m_pso.Get());
 	}
 }
 
+void CascadedShadow::EndCascades(ID3D12GraphicsCommandList* cmdList) const
+{
+	ChangeState<D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList, m_resource.Get());
+}
+
+CascadeWork CascadedShadow::GetCascadeWork(UINT idx) const
+{
+	return m_scheduler.GetWork(idx);
+}
+
+void CascadedShadow::InvalidateCache()
+{
+	m_scheduler.Invalidate();
+}
+
+void CascadedShadow::SetDepthBounds(const DepthBounds& bounds)
+{
+	m_depthBounds = bounds;
+}
+
+float CascadedShadow::GetTexelsPerPixel(UINT idx) const
+{
+	assert(idx < cascadeLevels);
+	return m_texelsPerPixel[idx];
+}
+
+UINT CascadedShadow::GetPassOffset() const
+{
+	return m_passOffset;
+}
+
 void CascadedShadow::SetNecessaryParameters(float _offset, float _range, const shared_ptr<Camera>& _viewCam, const Light<Pixel>* _mainLight, int kernelSize)
 {
 	m_shadowOffset = _offset;
@@ -221,8 +324,7 @@ void CascadedShadow::SetNecessaryParameters(float _offset, float _range, const s
 
 void CascadedShadow::CopyCascadedShadowPass(ID3D12GraphicsCommandList* cmdList) const
 {
-	const auto address = cascadedUploader->GetResource()->GetGPUVirtualAddress();
-	cmdList->SetGraphicsRootConstantBufferView(11, address);
+	cmdList->SetGraphicsRootConstantBufferView(11, m_cascadedPass.GetAddress());
 }
 
 XMFLOAT4X4 CascadedShadow::GetShadowView() const
@@ -237,12 +339,21 @@ const XMMATRIX& CascadedShadow::GetShadowViewXM() const
 	return m_shadowView;
 }
 
-ID3D12Resource* CascadedShadow::GetCascadedRes(UINT idx) const
+XMMATRIX CascadedShadow::GetCascadeVPXM(UINT idx) const
+{
+	assert(idx < cascadeLevels);
+	return XMMatrixMultiply(m_shadowView, m_shadowProj[idx]);
+}
+
+ID3D12Resource* CascadedShadow::GetShadowAtlas() const
+{
+	return m_resource.Get();
+}
+
+const ShadowAtlasRegion& CascadedShadow::GetCascadeRegion(UINT idx) const
 {
 	assert(idx < cascadeLevels);
-	if (idx == 0)
-		return m_resource.Get();
-	return m_shadowRes[idx - 1].Get();
+	return m_cascadeRegions[idx];
 }
 
 UINT CascadedShadow::GetCascadedSrvOffset() const
@@ -250,6 +361,152 @@ UINT CascadedShadow::GetCascadedSrvOffset() const
 	return m_srvOffset;
 }
 
+bool CascadedShadow::HasStaticWork() const
+{
+	for (UINT idx = 0; idx < cascadeLevels; ++idx)
+	{
+		if (m_scheduler.GetWork(idx) == CascadeWork::full || m_scheduler.GetWork(idx) == CascadeWork::scroll)
+			return true;
+	}
+	return false;
+}
+
+void CascadedShadow::SetCascadeTarget(ID3D12GraphicsCommandList* cmdList, UINT idx, const D3D12_CPU_DESCRIPTOR_HANDLE& dsv) const
+{
+	assert(idx < cascadeLevels);
+	cmdList->RSSetViewports(1, &m_cascadeViewports[idx]);
+	cmdList->RSSetScissorRects(1, &m_cascadeScissors[idx]);
+	cmdList->OMSetRenderTargets(0, nullptr, false, &dsv);
+	cmdList->SetPipelineState(m_pso.Get());
+}
+
+bool CascadedShadow::UpdateSplits()
+{
+	const float cameraNearFarRange = abs(m_camera->m_farPlane - m_camera->m_nearPlane);
+	float starts[cascadeLevels]{};
+	float ends[cascadeLevels]{};
+	const DepthBounds bounds = SampleDistribution::Quantize(m_depthBounds, m_camera->m_nearPlane, m_camera->m_farPlane, splitStepsPerOctave);
+	if (bounds.valid)
+	{
+		// ֻֿɼȷΧĽԶ˽ɼļ
+		SampleDistribution::ComputeSplits(bounds, splitLambda, cascadeLevels, ends);
+		for (UINT idx = 0; idx < cascadeLevels; ++idx)
+		{
+			starts[idx] = idx > 0 ? ends[idx - 1] : bounds.minZ;
+		}
+	}
+	else
+	{
+		// δعԼֻ
+		for (UINT idx = 0; idx < cascadeLevels; ++idx)
+		{
+			starts[idx] = idx > 0 ? cascadedPercent[idx - 1] * cameraNearFarRange : 0.0f;
+			ends[idx] = cascadedPercent[idx] * cameraNearFarRange;
+		}
+	}
+	if (std::equal(std::begin(starts), std::end(starts), std::begin(m_cascadeStart)) && std::equal(std::begin(ends), std::end(ends), std::begin(m_cascadeEnd)))
+		return false;
+	std::copy(std::begin(starts), std::end(starts), std::begin(m_cascadeStart));
+	std::copy(std::begin(ends), std::end(ends), std::begin(m_cascadeEnd));
+	// ׶ıԶ
+	m_scheduler.Invalidate();
+	return true;
+}
+
+void CascadedShadow::AllocateCascades()
+{
+	/*
+	 * UpdateмĹտռȱΪ׶ԽߣԴ޹
+	 * ׶һصĿΪһtexelõı߳˷ֱֻͶӰ仯ʱı䣬֡
+	 */
+	const float tanHalfFov = std::tanf(0.5f * m_camera->m_fov);
+	const float pixelScale = 2.0f * tanHalfFov / m_camera->GetViewPort().Height;
+	const UINT maxCascadeSize = std::max(m_atlas.GetAtlasSize() >> 1, minCascadeSize);
+	UINT sizes[cascadeLevels]{};
+	uint64_t totalArea = 0;
+	for (UINT idx = 0; idx < cascadeLevels; ++idx)
+	{
+		const float frustumStart = std::max(m_cascadeStart[idx], m_camera->m_nearPlane);
+		const float frustumEnd = std::max(m_cascadeEnd[idx], frustumStart);
+		const float texels = CascadeExtent(frustumStart, frustumEnd) / (frustumStart * pixelScale);
+		sizes[idx] = std::clamp(ShadowAtlasAllocator::RoundUpPow2(static_cast<UINT>(std::min(std::ceil(texels), static_cast<float>(maxCascadeSize)))), minCascadeSize, maxCascadeSize);
+		totalArea += static_cast<uint64_t>(sizes[idx]) * sizes[idx];
+	}
+	// ͼɲʱļѡԶһ룬ľ
+	const auto halveLargest = [&sizes, &totalArea]()
+	{
+		UINT target = cascadeLevels;
+		for (UINT idx = 0; idx < cascadeLevels; ++idx)
+		{
+			if (sizes[idx] > minCascadeSize && (target == cascadeLevels || sizes[idx] >= sizes[target]))
+				target = idx;
+		}
+		if (target == cascadeLevels)
+			return false;
+		totalArea -= static_cast<uint64_t>(sizes[target]) * sizes[target] * 3 / 4;
+		sizes[target] >>= 1;
+		return true;
+	};
+	const uint64_t atlasArea = static_cast<uint64_t>(m_atlas.GetAtlasSize()) * m_atlas.GetAtlasSize();
+	while (totalArea > atlasArea && halveLargest());
+	// ֱֻʸıʱؽֱʲʱԭв֣̬Ȼ
+	if (std::equal(std::begin(sizes), std::end(sizes), std::begin(m_requestedSizes)))
+		return;
+	std::copy(std::begin(sizes), std::end(sizes), std::begin(m_requestedSizes));
+	/*
+	 * ȴСط2򲻻Ƭͼʱһμɳɹ
+	 * ﴦ֡õ·ϣʧʱ׳쳣Ǽͷֱ²֣ʧʱһεĲ
+	 */
+	ShadowAtlasRegion regions[cascadeLevels];
+	for (;;)
+	{
+		UINT order[cascadeLevels];
+		std::iota(std::begin(order), std::end(order), 0U);
+		std::stable_sort(std::begin(order), std::end(order), [&sizes](UINT lhs, UINT rhs) { return sizes[lhs] > sizes[rhs]; });
+		m_atlas.Reset();
+		bool placed = true;
+		for (UINT idx : order)
+		{
+			const auto region = m_atlas.Allocate(sizes[idx]);
+			if (!region)
+			{
+				placed = false;
+				break;
+			}
+			regions[idx] = *region;
+		}
+		if (placed)
+			break;
+		if (!halveLargest())
+			return;
+	}
+	if (std::equal(std::begin(sizes), std::end(sizes), std::begin(m_cascadeSizes)))
+		return;
+	std::copy(std::begin(sizes), std::end(sizes), std::begin(m_cascadeSizes));
+	m_scheduler.Invalidate();
+	for (UINT idx = 0; idx < cascadeLevels; ++idx)
+	{
+		const ShadowAtlasRegion& region = regions[idx];
+		m_cascadeRegions[idx] = region;
+		m_cascadeViewports[idx] = { static_cast<float>(region.x), static_cast<float>(region.y),
+			static_cast<float>(region.size), static_cast<float>(region.size), 0.0f, 1.0f };
+		m_cascadeScissors[idx] = { static_cast<LONG>(region.x), static_cast<LONG>(region.y),
+			static_cast<LONG>(region.x + region.size), static_cast<LONG>(region.y + region.size) };
+	}
+}
+
+float CascadedShadow::CascadeExtent(float frustumStart, float frustumEnd) const
+{
+	// ԶƽĶԽƽǵ㵽ԶƽԽǵߣֻͶӰй
+	const float tanHalfFov = std::tanf(0.5f * m_camera->m_fov);
+	const float nearHalfHeight = frustumStart * tanHalfFov;
+	const float farHalfHeight = frustumEnd * tanHalfFov;
+	const float farDiag = 2.0f * farHalfHeight * std::sqrt(m_camera->m_aspect * m_camera->m_aspect + 1.0f);
+	const float crossHalfHeight = nearHalfHeight + farHalfHeight;
+	const float crossDiag = std::sqrt(crossHalfHeight * crossHalfHeight * (m_camera->m_aspect * m_camera->m_aspect + 1.0f) + (frustumEnd - frustumStart) * (frustumEnd - frustumStart));
+	return std::max(farDiag, crossDiag);
+}
+
 void CascadedShadow::SyncWithShadowPass()
 {
 	static XMMATRIX T(
@@ -259,6 +516,7 @@ void CascadedShadow::SyncWithShadowPass()
 		0.5f, 0.5f, 0.0f, 1.0f);
 	XMFLOAT4 scales[cascadeLevels]{};
 	XMFLOAT4 offsets[cascadeLevels]{};
+	XMFLOAT4 atlasScaleBias[cascadeLevels]{};
 	for (UINT idx = 0; idx < cascadeLevels; ++idx)
 	{
 		const XMMATRIX shadowTex = XMMatrixMultiply(m_shadowProj[idx], T);
@@ -267,6 +525,7 @@ void CascadedShadow::SyncWithShadowPass()
 		scales[idx].z = XMVectorGetZ(shadowTex.r[2]);
 		scales[idx].w = 1.0f;
 		XMStoreFloat3((XMFLOAT3*)(offsets + idx), shadowTex.r[3]);
+		atlasScaleBias[idx] = m_atlas.GetUVScaleBias(m_cascadeRegions[idx]);
 	}
 	float depthArray[cascadeLevels][4] = {
 		{m_depthFloatFrustum[0]}, {m_depthFloatFrustum[1]}, {m_depthFloatFrustum[2]},
@@ -276,20 +535,24 @@ void CascadedShadow::SyncWithShadowPass()
 	memcpy(&shadowPass.cascadedScale_gpu, &scales, sizeof(XMFLOAT4) * cascadeLevels);
 	memcpy(&shadowPass.cascadedOffset_gpu, &offsets, sizeof(XMFLOAT4) * cascadeLevels);
 	memcpy(&shadowPass.cascadedDepthFloat_gpu, &depthArray, sizeof(XMFLOAT4) * cascadeLevels);
-	shadowPass.cascadedShadowPercent_gpu[0] = XMFLOAT4(cascadedPercent[0], cascadedPercent[1], cascadedPercent[2], cascadedPercent[3]);
-	shadowPass.cascadedShadowPercent_gpu[1] = XMFLOAT4(cascadedPercent[4], 0.0f, 0.0f, 0.0f);
+	memcpy(&shadowPass.cascadedAtlas_gpu, &atlasScaleBias, sizeof(XMFLOAT4) * cascadeLevels);
+	const float invRange = 1.0f / abs(m_camera->m_farPlane - m_camera->m_nearPlane);
+	shadowPass.cascadedShadowPercent_gpu[0] = XMFLOAT4(m_cascadeEnd[0] * invRange, m_cascadeEnd[1] * invRange, m_cascadeEnd[2] * invRange, m_cascadeEnd[3] * invRange);
+	shadowPass.cascadedShadowPercent_gpu[1] = XMFLOAT4(m_cascadeEnd[4] * invRange, 0.0f, 0.0f, 0.0f);
 	shadowPass.cascadedShadowOffset = m_shadowOffset;
 	shadowPass.cascadedBlend_gpu = m_cascadedBlend;
 	shadowPass.pcfStart_gpu = -m_kernelSize;
 	shadowPass.pcfEnd_gpu = m_kernelSize;
-	cascadedUploader->Copy(0, shadowPass);
+	// ÿ֡дӻϴз䣬⸲GPUڶȡһ֡
+	m_cascadedPass = UploadRing::instance().Allocate<CascadedShadowPass>(1, true);
+	m_cascadedPass.Copy(0, shadowPass);
 }
 
-std::tuple<XMMATRIX, XMVECTOR> CascadedShadow::RegisterLightViewXM() const
+std::tuple<XMMATRIX, XMVECTOR> CascadedShadow::RegisterLightViewXM(FXMVECTOR lightDir) const
 {
-	XMVECTOR lightPos = -2.0f * Scene::sceneBound.Radius * m_mainLight->GetLightDir();
+	XMVECTOR lightPos = -2.0f * Scene::sceneBound.Radius * lightDir;
 	XMVECTOR lightUp = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
-	XMMATRIX lightView = XMMatrixLookToLH(lightPos, m_mainLight->GetLightDir(), lightUp);
+	XMMATRIX lightView = XMMatrixLookToLH(lightPos, lightDir, lightUp);
 
 	return { lightView, lightPos };
 }
@@ -320,10 +583,7 @@ void CascadedShadow::CreateResources()
 
 	const auto& properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
 	ThrowIfFailed(m_device->CreateCommittedResource(&properties, D3D12_HEAP_FLAG_NONE, &shadowDesc, D3D12_RESOURCE_STATE_GENERIC_READ, &shadowClear, IID_PPV_ARGS(m_resource.GetAddressOf())));
-	for (UINT i = 0; i < 4; ++i)
-	{
-		ThrowIfFailed(m_device->CreateCommittedResource(&properties, D3D12_HEAP_FLAG_NONE, &shadowDesc, D3D12_RESOURCE_STATE_GENERIC_READ, &shadowClear, IID_PPV_ARGS(m_shadowRes[i].GetAddressOf())));
-	}
+	ThrowIfFailed(m_device->CreateCommittedResource(&properties, D3D12_HEAP_FLAG_NONE, &shadowDesc, D3D12_RESOURCE_STATE_GENERIC_READ, &shadowClear, IID_PPV_ARGS(m_staticResource.GetAddressOf())));
 }
 
 void CascadedShadow::CreateDescriptors()
@@ -338,10 +598,7 @@ void CascadedShadow::CreateDescriptors()
 	srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
 	srvDesc.Texture2D.PlaneSlice = 0;
 	m_device->CreateShaderResourceView(m_resource.Get(), &srvDesc, m_cpuSRV);
-	for (UINT i = 0; i < 4; ++i)
-	{
-		m_device->CreateShaderResourceView(m_shadowRes[i].Get(), &srvDesc, m_shadowCpuSRV[i]);
-	}
+	m_device->CreateShaderResourceView(m_staticResource.Get(), &srvDesc, m_staticCpuSRV);
 
 	// DSVshaderܹȾshadow Map
 	D3D12_DEPTH_STENCIL_VIEW_DESC dsvDesc{};
@@ -349,9 +606,6 @@ void CascadedShadow::CreateDescriptors()
 	dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
 	dsvDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
 	dsvDesc.Texture2D.MipSlice = 0;
-	m_device->CreateDepthStencilView(m_resource.Get(), &dsvDesc, m_cpuDSV[0]);
-	for (UINT i = 0; i < 4; ++i)
-	{
-		m_device->CreateDepthStencilView(m_shadowRes[i].Get(), &dsvDesc, m_cpuDSV[i + 1]);
-	}
+	m_device->CreateDepthStencilView(m_resource.Get(), &dsvDesc, m_cpuDSV);
+	m_device->CreateDepthStencilView(m_staticResource.Get(), &dsvDesc, m_staticCpuDSV);
 }
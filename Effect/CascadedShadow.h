@@ -1,8 +1,11 @@
 #pragma once
 
 #include "Camera.h"
+#include "CascadeScheduler.h"
 #include "RenderToTexture.h"
-#include "UploaderBuffer.hpp"
+#include "SampleDistribution.h"
+#include "ShadowAtlasAllocator.h"
+#include "UploadRing.h"
 
 namespace Effect
 {
@@ -10,10 +13,14 @@ namespace Effect
  * ׶廮ֳɶ׶
  * Ϊÿ׶տռµͶӰ
  * Ϊÿ׶ȾshadowMap
+ * мһͼ׶texelܶΪ2
+ * ̬Ȼڲͬľ̬ͼУʱȸƾ̬ٻƶ̬壬Ƶ뻺ʧЧCascadeScheduler
+ * ķָDepthReductionصĿɼȷΧ(SDSM)δʱʹù̶cascadedPercent
  */
 class CascadedShadow final : public RenderToTexture
 {
 public:
+	// _widthΪͼı߳
 	CascadedShadow(ID3D12Device* _device, UINT _width);
 	CascadedShadow(const CascadedShadow&) = delete;
 	CascadedShadow& operator=(const CascadedShadow&) = delete;
@@ -22,20 +29,52 @@ public:
 	~CascadedShadow() override = default;
 
 	void CreateDescriptors(D3D12_CPU_DESCRIPTOR_HANDLE cpuSrvStart, D3D12_GPU_DESCRIPTOR_HANDLE gpuSrvStart, D3D12_CPU_DESCRIPTOR_HANDLE cpuDsvStart, UINT srvSize, UINT dsvSize);
-	void InitShader(const wstring& csmName);
+	void InitShader(const wstring& csmName, const wstring& cacheName);
 	void InitTexture(string_view csmName);
 	void InitPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& templateDesc) override;
 	void Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc) override;
-	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const override;
+	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) override;
+	/*
+	 * ֺĻ̣ڶбв¼Ƹ
+	 * 1. BeginCascades
+	 * 2. GetStaticRectCountΪ0ļÿBindStaticCascadeƾ̬壬ȫEndStaticCascades
+	 * 3. GetCascadeWorkΪskipļBindCascadeƶ̬壬compositeΪtrueʱȸƾ̬
+	 * 4. EndCascades
+	 */
+	void BeginCascades(ID3D12GraphicsCommandList* cmdList) const;
+	// fullʱΪscrollʱΪ̬¶
+	UINT GetStaticRectCount(UINT idx) const;
+	void BindStaticCascade(ID3D12GraphicsCommandList* cmdList, UINT idx, UINT rectIdx, bool clear) const;
+	void EndStaticCascades(ID3D12GraphicsCommandList* cmdList) const;
+	void BindCascade(ID3D12GraphicsCommandList* cmdList, UINT idx, bool composite) const;
+	void EndCascades(ID3D12GraphicsCommandList* cmdList) const;
+	CascadeWork GetCascadeWork(UINT idx) const;
+	// ̬ıͼDrawǺãһ֡мػ
+	void InvalidateCache();
+	// DepthReductionصȷΧһUpdateʱݴ˻ּ
+	void SetDepthBounds(const DepthBounds& bounds);
+	// һĻظǵӰtexelС1ʱӰǷ
+	float GetTexelsPerPixel(UINT idx) const;
+	UINT GetPassOffset() const;
 	void SetNecessaryParameters(float _offset, float _range, const shared_ptr<Camera>& _viewCam, const Light<Pixel>* _mainLight, int kernelSize);
 	void CopyCascadedShadowPass(ID3D12GraphicsCommandList* cmdList) const;
 	XMFLOAT4X4 GetShadowView() const;
 	const XMMATRIX& GetShadowViewXM() const;
-	ID3D12Resource* GetCascadedRes(UINT idx) const;
+	XMMATRIX GetCascadeVPXM(UINT idx) const;
+	ID3D12Resource* GetShadowAtlas() const;
+	const ShadowAtlasRegion& GetCascadeRegion(UINT idx) const;
 	UINT GetCascadedSrvOffset() const;
 private:
+	// ڹ۲ռе䣬ָıʱмػ沢true
+	bool UpdateSplits();
+	// ׶һصĴСѡķֱʣͼʱȽԶֻڷֱʸıʱ²
+	void AllocateCascades();
+	// ׶Խߣλá޹
+	float CascadeExtent(float frustumStart, float frustumEnd) const;
 	void SyncWithShadowPass();
-	std::tuple<XMMATRIX, XMVECTOR> RegisterLightViewXM() const;
+	bool HasStaticWork() const;
+	void SetCascadeTarget(ID3D12GraphicsCommandList* cmdList, UINT idx, const D3D12_CPU_DESCRIPTOR_HANDLE& dsv) const;
+	std::tuple<XMMATRIX, XMVECTOR> RegisterLightViewXM(FXMVECTOR lightDir) const;
 	void CreateResources() override;
 	void CreateDescriptors() override;
 private:
@@ -44,17 +83,27 @@ private:
 		XMFLOAT4	cascadedOffset_gpu[5];
 		XMFLOAT4	cascadedScale_gpu[5];
 		XMFLOAT4	cascadedDepthFloat_gpu[5];
+		XMFLOAT4	cascadedAtlas_gpu[5]; // ͼеuvƫ
 		float		cascadedBlend_gpu{ 0.2f };
 		float		cascadedShadowOffset;
 		int			pcfStart_gpu;
 		int			pcfEnd_gpu;
 	};
 
-	std::unique_ptr<UploaderBuffer<CascadedShadowPass>> cascadedUploader;
-	ComPtr<ID3D12Resource>								m_shadowRes[4];
-	CD3DX12_CPU_DESCRIPTOR_HANDLE						m_cpuDSV[5];
-	CD3DX12_CPU_DESCRIPTOR_HANDLE						m_shadowCpuSRV[4];
-	CD3DX12_GPU_DESCRIPTOR_HANDLE						m_shadowGpuSRV[4];
+	UploadAllocation									m_cascadedPass;
+	CD3DX12_CPU_DESCRIPTOR_HANDLE						m_cpuDSV;
+	// ̬Ȼ棬m_resourceСͬ
+	ComPtr<ID3D12Resource>								m_staticResource;
+	CD3DX12_CPU_DESCRIPTOR_HANDLE						m_staticCpuDSV;
+	CD3DX12_CPU_DESCRIPTOR_HANDLE						m_staticCpuSRV;
+	ComPtr<ID3D12PipelineState>							m_cachePso;
+	ShadowAtlasAllocator								m_atlas;
+	CascadeScheduler									m_scheduler;
+	UINT												m_requestedSizes[5]{};	// ͶӰķֱʣıʱ²
+	UINT												m_cascadeSizes[5]{};
+	ShadowAtlasRegion									m_cascadeRegions[5];
+	D3D12_VIEWPORT										m_cascadeViewports[5]{};
+	D3D12_RECT											m_cascadeScissors[5]{};
 	XMMATRIX											m_shadowView;
 	XMMATRIX											m_shadowProj[5]{};
 	const Light<Pixel>*									m_mainLight;
@@ -65,11 +114,22 @@ private:
 	float												m_shadowOffset;
 	float												m_cascadedBlend{ 0.2f };
 	float												m_depthFloatFrustum[5];
+	DepthBounds											m_depthBounds;
+	float												m_cascadeStart[5]{};
+	float												m_cascadeEnd[5]{};
+	float												m_texelsPerPixel[5]{};
 	std::unique_ptr<Shader>								m_shader;
+	std::unique_ptr<Shader>								m_cacheShader;
 	std::shared_ptr<Camera>								m_camera;
 public:
 	static constexpr UINT								cascadeLevels = 5U;
 	static constexpr float								cascadedPercent[cascadeLevels] = { 0.05f, 0.10f, 0.22f, 0.3f, 0.4f };
+	static constexpr UINT								minCascadeSize = 128U;
+	static constexpr UINT								everyFrameCascades = 2U;	// ÿ֡µĽ
+	static constexpr float								cacheLightAngle = 0.0087266f;	// Դת0.5Ⱥػ澲̬
+	static constexpr float								splitLambda = 0.8f;	// ռȨ
+	static constexpr UINT								splitStepsPerOctave = 8U;	// ȷΧÿһΪ8λʱָ治
+	static constexpr UINT								cacheConstantRootParam = 15U;	// ϳɾ̬ʱǩռõĸ
 };
 }
 
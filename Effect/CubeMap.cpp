@@ -9,7 +9,7 @@ CubeMap::CubeMap(){
 
 void CubeMap::InitStaticTex(std::string_view name, const std::wstring& fileName)
 {
-	TextureMgr::instance().InsertDDSTexture(name, fileName);
+	TextureMgr::instance().InsertDDSTexture(name, fileName, true);
 	staticTex = name;
 }
 
@@ -36,5 +36,5 @@ ID3D12PipelineState* CubeMap::GetPSO() const
 
 HashID CubeMap::GetStaticID()
 {
-	return TextureMgr::instance().GetRegisterType(staticTex).value_or(0);
+	return TextureMgr::instance().GetSRVIndex(TextureMgr::instance().GetRegisterType(staticTex).value_or(0));
 }
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "DepthReduction.h"
+#include <cassert>
+#include "PostProcessMgr.hpp"
+#include "Texture.h"
+#include "UploadRing.h"
+
+using namespace Effect;
+
+namespace
+{
+// ԼΪ(minZ, maxZ)uint
+constexpr UINT64 boundsByteSize = sizeof(UINT) * 2;
+}
+
+DepthReduction::DepthReduction(ID3D12Device* _device, UINT _width, UINT _height)
+: RenderToTexture(_device, _width, _height, DXGI_FORMAT_R32_TYPELESS)
+{
+	CreateResources();
+}
+
+DepthReduction::~DepthReduction()
+{
+	if (m_readback)
+		m_readback->Unmap(0, nullptr);
+}
+
+void DepthReduction::InitPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& templateDesc)
+{
+	D3D12_COMPUTE_PIPELINE_STATE_DESC reduceDesc{};
+	reduceDesc.CS = { static_cast<BYTE*>(m_shader->GetShaderByType(ShaderPos::compute)->GetBufferPointer()), m_shader->GetShaderByType(ShaderPos::compute)->GetBufferSize() };
+	reduceDesc.pRootSignature = PostProcessMgr::instance().GetRootSignature();
+	reduceDesc.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
+	ThrowIfFailed(m_device->CreateComputePipelineState(&reduceDesc, IID_PPV_ARGS(&m_pso)));
+}
+
+void DepthReduction::Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc)
+{
+}
+
+void DepthReduction::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc)
+{
+	// ϴеֵùԼ
+	const auto clearValue = UploadRing::instance().Allocate<UINT>(2, false);
+	clearValue.Copy(0, SampleDistribution::clearMinBits);
+	clearValue.Copy(1, SampleDistribution::clearMaxBits);
+	ChangeState<D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST>(cmdList, m_resource.Get());
+	FlushBarriers(cmdList);
+	cmdList->CopyBufferRegion(m_resource.Get(), 0, clearValue.resource, clearValue.offset, boundsByteSize);
+	ChangeState<D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_UNORDERED_ACCESS>(cmdList, m_resource.Get());
+
+	cmdList->SetComputeRootSignature(PostProcessMgr::instance().GetRootSignature());
+	cmdList->SetPipelineState(m_pso.Get());
+	drawFunc(NULL);
+	const float texSize[] = { static_cast<float>(m_width), static_cast<float>(m_height), 1.0f / static_cast<float>(m_width), 1.0f / static_cast<float>(m_height) };
+	cmdList->SetComputeRoot32BitConstants(0, 4, texSize, 0);
+	cmdList->SetComputeRootDescriptorTable(2, m_gpuUAV);
+	UINT groupX = (UINT)std::ceilf((float)m_width / 16.0f);
+	UINT groupY = (UINT)std::ceilf((float)m_height / 16.0f);
+	FlushBarriers(cmdList);
+	cmdList->Dispatch(groupX, groupY, 1);
+
+	ChangeState<D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE>(cmdList, m_resource.Get());
+	FlushBarriers(cmdList);
+	cmdList->CopyBufferRegion(m_readback.Get(), boundsByteSize * m_frameIdx, m_resource.Get(), 0, boundsByteSize);
+	ChangeState<D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_COMMON>(cmdList, m_resource.Get());
+}
+
+void DepthReduction::OnResize(UINT newWidth, UINT newHeight)
+{
+	// ԼĻС޹أֻ߳
+	m_width = newWidth;
+	m_height = newHeight;
+}
+
+void DepthReduction::CreateDescriptors(D3D12_CPU_DESCRIPTOR_HANDLE srvCpuStart, D3D12_GPU_DESCRIPTOR_HANDLE srvGpuStart, UINT srvSize)
+{
+	m_cpuUAV = CD3DX12_CPU_DESCRIPTOR_HANDLE(srvCpuStart, static_cast<INT>(m_uavIdx), srvSize);
+	m_gpuUAV = CD3DX12_GPU_DESCRIPTOR_HANDLE(srvGpuStart, static_cast<INT>(m_uavIdx), srvSize);
+
+	CreateDescriptors();
+}
+
+void DepthReduction::InitShader(const wstring& binaryName)
+{
+	m_shader = std::make_unique<Shader>(compute_shader, binaryName, initializer_list<D3D12_INPUT_ELEMENT_DESC>());
+}
+
+void DepthReduction::InitTexture()
+{
+	m_uavIdx = TextureMgr::instance().RegisterRenderToTexture("DepthReduction");
+}
+
+DepthBounds DepthReduction::ReadBack(UINT frameIdx)
+{
+	assert(frameIdx < frameResourcesCount);
+	DepthBounds ans;
+	if (m_written[frameIdx])
+	{
+		const UINT* bounds = m_readbackData + 2 * frameIdx;
+		ans = SampleDistribution::DecodeBounds(bounds[0], bounds[1]);
+	}
+	m_written[frameIdx] = true;
+	m_frameIdx = frameIdx;
+	return ans;
+}
+
+void DepthReduction::CreateResources()
+{
+	const auto& defaultProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	const auto& boundsDesc = CD3DX12_RESOURCE_DESC::Buffer(boundsByteSize, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+	ThrowIfFailed(m_device->CreateCommittedResource(&defaultProperties, D3D12_HEAP_FLAG_NONE, &boundsDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(m_resource.ReleaseAndGetAddressOf())));
+	m_resource->SetName(L"DepthReductionBounds");
+
+	// ÿ֡ԴռһΣضѱӳ䣬ֻڶӦ֡ԴΧɺȡ
+	const auto& readbackProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK);
+	const auto& readbackDesc = CD3DX12_RESOURCE_DESC::Buffer(boundsByteSize * frameResourcesCount);
+	ThrowIfFailed(m_device->CreateCommittedResource(&readbackProperties, D3D12_HEAP_FLAG_NONE, &readbackDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(m_readback.ReleaseAndGetAddressOf())));
+	m_readback->SetName(L"DepthReductionReadback");
+	void* data = nullptr;
+	ThrowIfFailed(m_readback->Map(0, nullptr, &data));
+	m_readbackData = static_cast<const UINT*>(data);
+}
+
+void DepthReduction::CreateDescriptors()
+{
+	D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc{};
+	uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+	uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+	uavDesc.Buffer.FirstElement = 0;
+	uavDesc.Buffer.NumElements = 2;
+	uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+	m_device->CreateUnorderedAccessView(m_resource.Get(), nullptr, &uavDesc, m_cpuUAV);
+}
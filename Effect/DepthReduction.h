@@ -0,0 +1,43 @@
+#pragma once
+#include "RenderToTexture.h"
+#include "SampleDistribution.h"
+
+namespace Effect
+{
+/*
+ * SDSMȹԼGBufferNDCɼڹ۲ռеȷΧ
+ * Ƶ֡ԴתĻض֡ԴʱGPUд룬CPUframeResourcesCount - 1֡ӳٶȡ
+ */
+class DepthReduction final : public RenderToTexture {
+public:
+	DepthReduction(ID3D12Device* _device, UINT _width, UINT _height);
+	~DepthReduction() override;
+	DepthReduction(const DepthReduction&) = delete;
+	DepthReduction& operator=(const DepthReduction&) = delete;
+	DepthReduction(DepthReduction&&) = default;
+	DepthReduction& operator=(DepthReduction&&) = default;
+
+	void InitPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& templateDesc) override;
+	void Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc) override;
+	// drawFuncаGBufferComputeConstant
+	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) override;
+	void OnResize(UINT newWidth, UINT newHeight) override;
+	void CreateDescriptors(D3D12_CPU_DESCRIPTOR_HANDLE srvCpuStart, D3D12_GPU_DESCRIPTOR_HANDLE srvGpuStart, UINT srvSize);
+	void InitShader(const wstring& binaryName);
+	void InitTexture();
+	// ȴ֡ԴΧãظ֡ԴһιԼĽ֡Ľдͬһλ
+	DepthBounds ReadBack(UINT frameIdx);
+private:
+	void CreateResources() override;
+	void CreateDescriptors() override;
+private:
+	std::unique_ptr<Shader>								m_shader;
+	ComPtr<ID3D12Resource>								m_readback;
+	const UINT*											m_readbackData{ nullptr };
+	CD3DX12_CPU_DESCRIPTOR_HANDLE						m_cpuUAV;
+	CD3DX12_GPU_DESCRIPTOR_HANDLE						m_gpuUAV;
+	UINT												m_uavIdx;
+	UINT												m_frameIdx{ 0 };
+	bool												m_written[frameResourcesCount]{};
+};
+}
@@ -44,7 +44,7 @@ void Effect::DynamicCubeMap::Update(const GameTimer& timer, const std::function<
 	}
 }
 
-void Effect::DynamicCubeMap::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const {
+void Effect::DynamicCubeMap::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) {
 	cmdList->RSSetViewports(1, &m_viewport);
 	cmdList->RSSetScissorRects(1, &m_scissorRect);
 	// ͼԴתΪRENDER_TARGET
@@ -52,6 +52,7 @@ void Effect::DynamicCubeMap::Draw(ID3D12GraphicsCommandList* cmdList, const std:
 	for (UINT i = 0U; i < 6U; ++i)
 	{
 		// ̨Ȼ
+		FlushBarriers(cmdList);
 		cmdList->ClearRenderTargetView(m_cpuRtv[i], Colors::LightSteelBlue, 0, nullptr);
 		cmdList->ClearDepthStencilView(m_cpuDSV, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 0.0f, 0, 0, nullptr);
 		// ָҪȾĻ
@@ -49,7 +49,7 @@ void Effect::GaussianBlur::CreateDescriptors(D3D12_CPU_DESCRIPTOR_HANDLE cpuDesc
 	m_DownUp->CreateDescriptors(cpuDesc, gpuDesc, descSize);
 }
 
-void Effect::GaussianBlur::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const {
+void Effect::GaussianBlur::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) {
 	ChangeState<D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST>(cmdList, GetResourceDownSampler());
 	drawFunc(NULL);
 	ChangeState<D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList, GetResourceDownSampler());
@@ -72,6 +72,7 @@ void Effect::GaussianBlur::Draw(ID3D12GraphicsCommandList* cmdList, const std::f
 		cmdList->SetPipelineState(m_pso.Get());
 		cmdList->SetComputeRootDescriptorTable(1, m_gpuSRV);
 		cmdList->SetComputeRootDescriptorTable(2, m_gpuUAV1);
+		FlushBarriers(cmdList);
 		cmdList->Dispatch(horizontalGroupX, m_shrinkHeight, 1);
 
 		SetGenericRead(cmdList, m_resource1.Get());
@@ -82,6 +83,7 @@ void Effect::GaussianBlur::Draw(ID3D12GraphicsCommandList* cmdList, const std::f
 		cmdList->SetPipelineState(m_pso1.Get());
 		cmdList->SetComputeRootDescriptorTable(1, m_gpuSRV1);
 		cmdList->SetComputeRootDescriptorTable(2, m_gpuUAV);
+		FlushBarriers(cmdList);
 		cmdList->Dispatch(m_shrinkWidth, verticalGroupY, 1);
 
 		SetGenericRead(cmdList, m_resource.Get());
@@ -104,11 +106,12 @@ void Effect::GaussianBlur::Draw(ID3D12GraphicsCommandList* cmdList, const std::f
 }
 
 void Effect::GaussianBlur::Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc) {
-	if (m_dirtyFlag)
-	{
-		m_DownUp->OnResize(m_width, m_height);
-		m_dirtyFlag = false;
-	}
+}
+
+void Effect::GaussianBlur::OnResize(UINT newWidth, UINT newHeight) {
+	RenderToTexture::OnResize(newWidth, newHeight);
+	// ܷ˲̬УҪ¹滮֮ǰ³ߴؽ
+	m_DownUp->OnResize(m_width, m_height);
 }
 
 void Effect::GaussianBlur::InitTexture(const string& horizontal, const string& vertical, const string& down, const string& up) {
@@ -129,6 +132,10 @@ ID3D12Resource* Effect::GaussianBlur::GetResourceDownSampler() const {
 	return m_DownUp->GetDownSamplerResource();
 }
 
+void Effect::GaussianBlur::PlaceDownSampler(ID3D12Heap* heap, UINT64 offset) {
+	m_DownUp->PlaceResource(heap, offset);
+}
+
 ID3D12Resource* Effect::GaussianBlur::GetResourceUpSampler() const
 {
 	return m_DownUp->GetUpSamplerResource();
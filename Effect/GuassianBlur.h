@@ -13,11 +13,13 @@ public:
 	void InitPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& templateDesc) override;
 	// backBuffer任״̬ΪcopySource; m_resource任״̬ΪcopyDesc,ձ任Ϊgeneric read
 	void CreateDescriptors(D3D12_CPU_DESCRIPTOR_HANDLE cpuDesc, D3D12_GPU_DESCRIPTOR_HANDLE gpuDesc, UINT descSize);
-	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const override;
+	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) override;
 	void Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc) override;
+	void OnResize(UINT newWidth, UINT newHeight) override;
 	void InitTexture(const string& horizontal = "blurHorizontal", const string& vertical = "blurVertical", const string& down = "downSampler", const string& = "upSampler");
 
 	ID3D12Resource* GetResourceDownSampler() const;
+	void PlaceDownSampler(ID3D12Heap* heap, UINT64 offset);
 	ID3D12Resource* GetResourceUpSampler() const;
 	CD3DX12_GPU_DESCRIPTOR_HANDLE GetUpSamplerSRV() const;
 private:
@@ -0,0 +1,128 @@
+#include "HiZReadback.h"
+#include <cassert>
+#include "PostProcessMgr.hpp"
+#include "Texture.h"
+
+using namespace Effect;
+
+namespace
+{
+constexpr UINT64 depthByteSize = sizeof(float) * HiZReadback::readbackWidth * HiZReadback::readbackHeight;
+}
+
+HiZReadback::HiZReadback(ID3D12Device* _device, UINT _width, UINT _height)
+: RenderToTexture(_device, _width, _height, DXGI_FORMAT_R32_TYPELESS)
+{
+	CreateResources();
+}
+
+HiZReadback::~HiZReadback()
+{
+	if (m_readback)
+		m_readback->Unmap(0, nullptr);
+}
+
+void HiZReadback::InitPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& templateDesc)
+{
+	D3D12_COMPUTE_PIPELINE_STATE_DESC downsampleDesc{};
+	downsampleDesc.CS = { static_cast<BYTE*>(m_shader->GetShaderByType(ShaderPos::compute)->GetBufferPointer()), m_shader->GetShaderByType(ShaderPos::compute)->GetBufferSize() };
+	downsampleDesc.pRootSignature = PostProcessMgr::instance().GetRootSignature();
+	downsampleDesc.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
+	ThrowIfFailed(m_device->CreateComputePipelineState(&downsampleDesc, IID_PPV_ARGS(&m_pso)));
+}
+
+void HiZReadback::Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc)
+{
+}
+
+void HiZReadback::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc)
+{
+	// ÿtexelᱻд룬Ҫ
+	ChangeState<D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_UNORDERED_ACCESS>(cmdList, m_resource.Get());
+	cmdList->SetComputeRootSignature(PostProcessMgr::instance().GetRootSignature());
+	cmdList->SetPipelineState(m_pso.Get());
+	drawFunc(NULL);
+	// texSizeΪĻСw0w1ΪС
+	const float settings[] = { static_cast<float>(m_width), static_cast<float>(m_height), 1.0f / static_cast<float>(m_width), 1.0f / static_cast<float>(m_height),
+		static_cast<float>(readbackWidth), static_cast<float>(readbackHeight) };
+	cmdList->SetComputeRoot32BitConstants(0, _countof(settings), settings, 0);
+	cmdList->SetComputeRootDescriptorTable(2, m_gpuUAV);
+	FlushBarriers(cmdList);
+	cmdList->Dispatch(readbackWidth / 8, readbackHeight / 8, 1);
+
+	ChangeState<D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE>(cmdList, m_resource.Get());
+	FlushBarriers(cmdList);
+	cmdList->CopyBufferRegion(m_readback.Get(), depthByteSize * m_frameIdx, m_resource.Get(), 0, depthByteSize);
+	ChangeState<D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_COMMON>(cmdList, m_resource.Get());
+}
+
+void HiZReadback::OnResize(UINT newWidth, UINT newHeight)
+{
+	// С̶ֻÿtexelǵطΧ
+	m_width = newWidth;
+	m_height = newHeight;
+}
+
+void HiZReadback::CreateDescriptors(D3D12_CPU_DESCRIPTOR_HANDLE srvCpuStart, D3D12_GPU_DESCRIPTOR_HANDLE srvGpuStart, UINT srvSize)
+{
+	m_cpuUAV = CD3DX12_CPU_DESCRIPTOR_HANDLE(srvCpuStart, static_cast<INT>(m_uavIdx), srvSize);
+	m_gpuUAV = CD3DX12_GPU_DESCRIPTOR_HANDLE(srvGpuStart, static_cast<INT>(m_uavIdx), srvSize);
+
+	CreateDescriptors();
+}
+
+void HiZReadback::InitShader(const wstring& binaryName)
+{
+	m_shader = std::make_unique<Shader>(compute_shader, binaryName, initializer_list<D3D12_INPUT_ELEMENT_DESC>());
+}
+
+void HiZReadback::InitTexture()
+{
+	m_uavIdx = TextureMgr::instance().RegisterRenderToTexture("HiZReadback");
+}
+
+const float* HiZReadback::ReadBack(UINT frameIdx, XMFLOAT4X4& viewProj)
+{
+	assert(frameIdx < frameResourcesCount);
+	const float* ans = nullptr;
+	if (m_written[frameIdx])
+	{
+		ans = m_readbackData + static_cast<size_t>(readbackWidth) * readbackHeight * frameIdx;
+		viewProj = m_viewProj[frameIdx];
+	}
+	m_written[frameIdx] = true;
+	m_frameIdx = frameIdx;
+	return ans;
+}
+
+void HiZReadback::SetViewProj(const XMFLOAT4X4& viewProj)
+{
+	m_viewProj[m_frameIdx] = viewProj;
+}
+
+void HiZReadback::CreateResources()
+{
+	const auto& defaultProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	const auto& depthDesc = CD3DX12_RESOURCE_DESC::Buffer(depthByteSize, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+	ThrowIfFailed(m_device->CreateCommittedResource(&defaultProperties, D3D12_HEAP_FLAG_NONE, &depthDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(m_resource.ReleaseAndGetAddressOf())));
+	m_resource->SetName(L"HiZDepth");
+
+	const auto& readbackProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK);
+	const auto& readbackDesc = CD3DX12_RESOURCE_DESC::Buffer(depthByteSize * frameResourcesCount);
+	ThrowIfFailed(m_device->CreateCommittedResource(&readbackProperties, D3D12_HEAP_FLAG_NONE, &readbackDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(m_readback.ReleaseAndGetAddressOf())));
+	m_readback->SetName(L"HiZReadback");
+	void* data = nullptr;
+	ThrowIfFailed(m_readback->Map(0, nullptr, &data));
+	m_readbackData = static_cast<const float*>(data);
+}
+
+void HiZReadback::CreateDescriptors()
+{
+	D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc{};
+	uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+	uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+	uavDesc.Buffer.FirstElement = 0;
+	uavDesc.Buffer.NumElements = readbackWidth * readbackHeight;
+	uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+	m_device->CreateUnorderedAccessView(m_resource.Get(), nullptr, &uavDesc, m_cpuUAV);
+}
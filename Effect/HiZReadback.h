@@ -0,0 +1,48 @@
+#pragma once
+#include "RenderToTexture.h"
+
+namespace Effect
+{
+/*
+ * ڵ޳ȻضGBufferNDCȽΪreadbackWidth x readbackHeightԶ
+ * Ƶ֡ԴתĻضͬʱ¼дʱViewProjectionCPUframeResourcesCount֡ͶӰʹ
+ */
+class HiZReadback final : public RenderToTexture {
+public:
+	static constexpr UINT readbackWidth = 256;
+	static constexpr UINT readbackHeight = 128;
+
+	HiZReadback(ID3D12Device* _device, UINT _width, UINT _height);
+	~HiZReadback() override;
+	HiZReadback(const HiZReadback&) = delete;
+	HiZReadback& operator=(const HiZReadback&) = delete;
+	HiZReadback(HiZReadback&&) = default;
+	HiZReadback& operator=(HiZReadback&&) = default;
+
+	void InitPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& templateDesc) override;
+	void Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc) override;
+	// drawFuncаGBuffer
+	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) override;
+	void OnResize(UINT newWidth, UINT newHeight) override;
+	void CreateDescriptors(D3D12_CPU_DESCRIPTOR_HANDLE srvCpuStart, D3D12_GPU_DESCRIPTOR_HANDLE srvGpuStart, UINT srvSize);
+	void InitShader(const wstring& binaryName);
+	void InitTexture();
+	// ȴ֡ԴΧãظ֡Դһд뵱ʱViewProjectionδдʱnullptr
+	const float* ReadBack(UINT frameIdx, XMFLOAT4X4& viewProj);
+	// ֡дӦ޶ViewProjection
+	void SetViewProj(const XMFLOAT4X4& viewProj);
+private:
+	void CreateResources() override;
+	void CreateDescriptors() override;
+private:
+	std::unique_ptr<Shader>								m_shader;
+	ComPtr<ID3D12Resource>								m_readback;
+	const float*										m_readbackData{ nullptr };
+	CD3DX12_CPU_DESCRIPTOR_HANDLE						m_cpuUAV;
+	CD3DX12_GPU_DESCRIPTOR_HANDLE						m_gpuUAV;
+	UINT												m_uavIdx;
+	UINT												m_frameIdx{ 0 };
+	bool												m_written[frameResourcesCount]{};
+	XMFLOAT4X4											m_viewProj[frameResourcesCount];
+};
+}
@@ -53,10 +53,11 @@ void Effect::MotionVector::Update(const GameTimer& timer, const std::function<vo
 {
 }
 
-void Effect::MotionVector::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const
+void Effect::MotionVector::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc)
 {
 	cmdList->SetGraphicsRootSignature(PostProcessMgr::instance().GetRootSignature());
 	ChangeState<D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET>(cmdList, m_resource.Get());
+	FlushBarriers(cmdList);
 	cmdList->ClearRenderTargetView(m_cpuRTV, Colors::Black, 0, nullptr);
 	cmdList->OMSetRenderTargets(1, &m_cpuRTV, true, nullptr);
 	cmdList->SetPipelineState(m_pso.Get());
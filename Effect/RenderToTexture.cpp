@@ -34,12 +34,35 @@ void RenderToTexture::OnResize(UINT newWidth, UINT newHeight) {
 	{
 		m_width = newWidth;
 		m_height = newHeight;
+		m_heap.Reset();
+		m_heapOffset = 0;
 		CreateResources();
 		CreateDescriptors();
 		m_dirtyFlag = true;
 	}
 }
 
+void RenderToTexture::PlaceResource(ID3D12Heap* heap, UINT64 offset)
+{
+	m_heap = heap;
+	m_heapOffset = offset;
+	CreateResources();
+	CreateDescriptors();
+}
+
+void RenderToTexture::CreateOutputResource(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES state, ComPtr<ID3D12Resource>& resource) const
+{
+	// ͷžԴµplacedԴص
+	resource.Reset();
+	if (m_heap)
+	{
+		ThrowIfFailed(m_device->CreatePlacedResource(m_heap.Get(), m_heapOffset, &desc, state, nullptr, IID_PPV_ARGS(resource.GetAddressOf())));
+		return;
+	}
+	const auto& properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	ThrowIfFailed(m_device->CreateCommittedResource(&properties, D3D12_HEAP_FLAG_NONE, &desc, state, nullptr, IID_PPV_ARGS(resource.GetAddressOf())));
+}
+
 ID3D12PipelineState* RenderToTexture::GetPSO() const
 {
 	return m_pso.Get();
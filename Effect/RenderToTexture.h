@@ -27,8 +27,10 @@ public:
 	ID3D12PipelineState* GetPSO() const;
 
 	virtual void OnResize(UINT newWidth, UINT newHeight);
+	// Ϊ˲̬ѵoffsetheapΪʱָΪcommittedԴߴ仯´ΪcommittedԴҪ·
+	void PlaceResource(ID3D12Heap* heap, UINT64 offset);
 	virtual void Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc) = 0;
-	virtual void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const = 0;
+	virtual void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) = 0;
 	virtual void InitPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& templateDesc) = 0;
 	std::optional<UINT> GetSrvIdx(std::string_view name);
 protected:
@@ -37,10 +39,14 @@ protected:
 	using ComPtr = Microsoft::WRL::ComPtr<T>;
 	virtual void CreateDescriptors() = 0;
 	virtual void CreateResources() = 0;
+	// ˲̬ʱplacedԴ򴴽committedԴ
+	void CreateOutputResource(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES state, ComPtr<ID3D12Resource>& resource) const;
 protected:
 	ComPtr<ID3D12Device>			m_device;
 	ComPtr<ID3D12Resource>			m_resource;
 	ComPtr<ID3D12PipelineState>		m_pso;
+	ComPtr<ID3D12Heap>				m_heap;
+	UINT64							m_heapOffset{ 0 };
 
 	CD3DX12_CPU_DESCRIPTOR_HANDLE	m_cpuSRV;
 	CD3DX12_GPU_DESCRIPTOR_HANDLE	m_gpuSRV;
@@ -54,8 +54,9 @@ void Effect::SSAO::InitShader() {
 void Effect::SSAO::Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc) {
 }
 
-void Effect::SSAO::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const {
+void Effect::SSAO::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) {
 	ChangeState<D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET>(cmdList, m_resource.Get());
+	FlushBarriers(cmdList);
 	cmdList->ClearRenderTargetView(m_cpuRTV, Colors::White, 0, nullptr);
 	cmdList->OMSetRenderTargets(1, &m_cpuRTV, true, nullptr);
 	auto randHandler = CD3DX12_GPU_DESCRIPTOR_HANDLE(TextureMgr::instance().GetSRVDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
@@ -69,11 +70,13 @@ void Effect::SSAO::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<
 
 	m_bilateralBlur->Draw(cmdList, [&](UINT){
 		ChangeState<D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE>(cmdList, m_resource.Get());
+		FlushBarriers(cmdList);
 		cmdList->CopyResource(m_bilateralBlur->GetDownResource(), m_resource.Get());
 	});
 
 	ChangeState<D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_COPY_DEST>(cmdList, m_resource.Get());
 	ChangeState<D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_SOURCE>(cmdList, m_bilateralBlur->GetUpResource());
+	FlushBarriers(cmdList);
 	cmdList->CopyResource(m_resource.Get(), m_bilateralBlur->GetUpResource());
 	ChangeState<D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList, m_resource.Get());
 	ChangeState<D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_COMMON>(cmdList, m_bilateralBlur->GetUpResource());
@@ -181,6 +184,7 @@ void Effect::SSAO::CreateRandomTexture(ID3D12GraphicsCommandList* cmdList) {
 	subresData.SlicePitch = subresData.RowPitch * 64;
 	// ݸƵĬԴв״̬
 	ChangeState<D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_COPY_DEST>(cmdList, randomTex.Get());
+	FlushBarriers(cmdList);
 	UpdateSubresources(cmdList, randomTex.Get(), randomUploader.Get(), 0, 0, num2DRes, &subresData);
 	ChangeState<D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList, randomTex.Get());
 
@@ -20,7 +20,7 @@ public:
 	void InitTexture();
 	void InitShader();
 	void Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc) override;
-	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const override;
+	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) override;
 	void CreateRandomTexture(ID3D12GraphicsCommandList* cmdList);
 	void CreateDescriptors(D3D12_CPU_DESCRIPTOR_HANDLE cpuSRVStart, D3D12_GPU_DESCRIPTOR_HANDLE gpuSRVStart, D3D12_CPU_DESCRIPTOR_HANDLE cpuRTVStart, UINT srvSize, UINT rtvSize);
 private:
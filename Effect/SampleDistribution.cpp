@@ -0,0 +1,90 @@
+#include "SampleDistribution.h"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+using namespace Effect;
+
+float SampleDistribution::NdcToViewZ(float ndcZ, float proj22, float proj32)
+{
+	return proj32 / (ndcZ - proj22);
+}
+
+DepthBounds SampleDistribution::ReduceDepth(const float* ndcDepth, uint32_t width, uint32_t height, uint32_t rowPitch, float proj22, float proj32)
+{
+	// ZNDCԽԽȹԼNDCٱ任ر任ԼĽͬ
+	float nearestNdc = 0.0f;
+	float farthestNdc = FLT_MAX;
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		const float* row = ndcDepth + static_cast<size_t>(y) * rowPitch;
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			if (row[x] <= 0.0f)
+				continue;
+			nearestNdc = std::max(nearestNdc, row[x]);
+			farthestNdc = std::min(farthestNdc, row[x]);
+		}
+	}
+	DepthBounds ans;
+	if (nearestNdc <= 0.0f)
+		return ans;
+	ans.minZ = NdcToViewZ(nearestNdc, proj22, proj32);
+	ans.maxZ = NdcToViewZ(farthestNdc, proj22, proj32);
+	ans.valid = true;
+	return ans;
+}
+
+DepthBounds SampleDistribution::DecodeBounds(uint32_t minBits, uint32_t maxBits)
+{
+	DepthBounds ans;
+	// ûκдʱΪֵ
+	if (minBits > maxBits)
+		return ans;
+	std::memcpy(&ans.minZ, &minBits, sizeof(float));
+	std::memcpy(&ans.maxZ, &maxBits, sizeof(float));
+	ans.valid = ans.minZ > 0.0f;
+	return ans;
+}
+
+DepthBounds SampleDistribution::Quantize(const DepthBounds& bounds, float nearPlane, float farPlane, uint32_t stepsPerOctave)
+{
+	if (!bounds.valid)
+		return bounds;
+	assert(nearPlane > 0.0f && farPlane > nearPlane && stepsPerOctave > 0);
+	const float steps = static_cast<float>(stepsPerOctave);
+	DepthBounds ans;
+	ans.minZ = std::exp2(std::floor(std::log2(std::max(bounds.minZ, nearPlane)) * steps) / steps);
+	ans.maxZ = std::exp2(std::ceil(std::log2(std::max(bounds.maxZ, nearPlane)) * steps) / steps);
+	ans.minZ = std::clamp(ans.minZ, nearPlane, farPlane);
+	ans.maxZ = std::clamp(ans.maxZ, ans.minZ, farPlane);
+	ans.valid = true;
+	return ans;
+}
+
+void SampleDistribution::ComputeSplits(const DepthBounds& bounds, float lambda, uint32_t count, float* splitEnds)
+{
+	assert(bounds.valid && bounds.minZ > 0.0f && count > 0);
+	const float minZ = bounds.minZ;
+	const float maxZ = std::max(bounds.maxZ, minZ);
+	const float ratio = maxZ / minZ;
+	for (uint32_t idx = 1; idx <= count; ++idx)
+	{
+		const float t = static_cast<float>(idx) / static_cast<float>(count);
+		const float logSplit = minZ * std::pow(ratio, t);
+		const float uniformSplit = minZ + (maxZ - minZ) * t;
+		splitEnds[idx - 1] = lambda * logSplit + (1.0f - lambda) * uniformSplit;
+	}
+	// һǡýmaxZ
+	splitEnds[count - 1] = maxZ;
+}
+
+float SampleDistribution::TexelsPerPixel(float viewZ, float pixelScale, float cascadeWorldSize, uint32_t resolution)
+{
+	if (cascadeWorldSize <= 0.0f)
+		return 0.0f;
+	const float texelSize = cascadeWorldSize / static_cast<float>(resolution);
+	return viewZ * pixelScale / texelSize;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Effect
+{
+// ȹԼĽԹ۲ռȱʾ
+struct DepthBounds
+{
+	float	minZ{ 0.0f };
+	float	maxZ{ 0.0f };
+	bool	valid{ false };	// ûм(ȫΪ)ʱΪfalse
+};
+
+/*
+ * ֲӰ(SDSM)CPU֣D3D豸
+ * 1. ReduceDepthGPUȹԼĲοʵ֣NDCΪ0زԼ
+ * 2. ComputeSplitsڿɼȷΧڰȻֵĲֵüķָ
+ * 3. TexelsPerPixelΪһĻǵӰtexelС1ʱӰ־
+ */
+class SampleDistribution
+{
+public:
+	// GPUuintλģʽȽֱֵΪĸ0
+	static constexpr uint32_t	clearMinBits = 0x7f7fffffu;
+	static constexpr uint32_t	clearMaxBits = 0u;
+
+	// ZNDCȵ۲ռȵı任proj22proj32ΪͶӰ[2][2][3][2]
+	static float NdcToViewZ(float ndcZ, float proj22, float proj32);
+	// rowPitchfloatΪλ
+	static DepthBounds ReduceDepth(const float* ndcDepth, uint32_t width, uint32_t height, uint32_t rowPitch, float proj22, float proj32);
+	static DepthBounds DecodeBounds(uint32_t minBits, uint32_t maxBits);
+	// Χ뵽2Ϊ׵Ķ̶ȲĽԶƽ֮䣬΢Сƶıָ棬ľ̬Ա
+	static DepthBounds Quantize(const DepthBounds& bounds, float nearPlane, float farPlane, uint32_t stepsPerOctave);
+	// splitEnds[i]ΪiԶ˵ȣ0bounds.minZʼlambdaΪ1ʱΪ֣Ϊ0ʱΪȻ
+	static void ComputeSplits(const DepthBounds& bounds, float lambda, uint32_t count, float* splitEnds);
+	// pixelScaleΪ۲Ϊ1һصĸ߶ȣcascadeWorldSizeΪͶӰĿ
+	static float TexelsPerPixel(float viewZ, float pixelScale, float cascadeWorldSize, uint32_t resolution);
+};
+}
@@ -84,12 +84,13 @@ void Effect::Shadow::Update(const GameTimer& timer, const std::function<void(UIN
 	updateFunc(m_dsvOffset, shadowPass);
 }
 
-void Effect::Shadow::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const {
+void Effect::Shadow::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) {
 	cmdList->RSSetViewports(1, &m_viewport);
 	cmdList->RSSetScissorRects(1, &m_scissorRect);
 	// Ϊдģʽ
 	ChangeState<D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_DEPTH_WRITE>(cmdList, m_resource.Get());
 	// Ȼͺ̨
+	FlushBarriers(cmdList);
 	cmdList->ClearDepthStencilView(m_cpuDSV, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 0.0f, 0, 0, nullptr);
 	// ҪȾĿΪ,Ӷֹɫд
 	cmdList->OMSetRenderTargets(0, nullptr, false, &m_cpuDSV);
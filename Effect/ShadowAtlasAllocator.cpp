@@ -0,0 +1,167 @@
+#include "ShadowAtlasAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+using namespace Effect;
+using namespace DirectX;
+
+namespace
+{
+// ȡMortonżλ
+uint32_t CompactBits(uint32_t value)
+{
+	value &= 0x55555555u;
+	value = (value | (value >> 1)) & 0x33333333u;
+	value = (value | (value >> 2)) & 0x0f0f0f0fu;
+	value = (value | (value >> 4)) & 0x00ff00ffu;
+	value = (value | (value >> 8)) & 0x0000ffffu;
+	return value;
+}
+
+uint32_t Log2(uint32_t value)
+{
+	uint32_t ans = 0;
+	while (value >>= 1)
+		++ans;
+	return ans;
+}
+}
+
+ShadowAtlasAllocator::ShadowAtlasAllocator(uint32_t atlasSize, uint32_t minTileSize)
+: m_atlasSize(RoundUpPow2(std::max(atlasSize, 1u))), m_minTileSize(std::min(RoundUpPow2(std::max(minTileSize, 1u)), m_atlasSize))
+{
+	m_levelCount = Log2(m_atlasSize / m_minTileSize) + 1;
+	m_nodes.resize(m_levelCount);
+	for (uint32_t level = 0; level < m_levelCount; ++level)
+	{
+		m_nodes[level].resize(static_cast<size_t>(1) << (2 * level));
+	}
+	Reset();
+}
+
+std::optional<ShadowAtlasRegion> ShadowAtlasAllocator::Allocate(uint32_t size)
+{
+	if (size == 0 || size > m_atlasSize)
+		return std::nullopt;
+	const uint32_t tileSize = std::max(RoundUpPow2(size), m_minTileSize);
+	const uint32_t target = Log2(m_atlasSize / tileSize);
+	// Ŀ㼶ϲСĿнڵ㣬ʹѲֳĿп飬
+	for (uint32_t level = target + 1; level-- > 0;)
+	{
+		auto& nodes = m_nodes[level];
+		const auto it = std::find(nodes.begin(), nodes.end(), NodeState::free);
+		if (it == nodes.end())
+			continue;
+		uint32_t node = static_cast<uint32_t>(it - nodes.begin());
+		for (; level < target; ++level)
+		{
+			m_nodes[level][node] = NodeState::split;
+			node <<= 2;
+			std::fill_n(m_nodes[level + 1].begin() + node, 4, NodeState::free);
+		}
+		m_nodes[target][node] = NodeState::used;
+		m_usedArea += static_cast<uint64_t>(tileSize) * tileSize;
+		return MakeRegion(target, node);
+	}
+	return std::nullopt;
+}
+
+std::optional<ShadowAtlasRegion> ShadowAtlasAllocator::Allocate(uint32_t size, uint32_t minSize)
+{
+	minSize = std::max(RoundUpPow2(std::max(minSize, 1u)), m_minTileSize);
+	for (uint32_t tileSize = std::min(RoundUpPow2(size), m_atlasSize); tileSize >= minSize; tileSize >>= 1)
+	{
+		if (auto region = Allocate(tileSize))
+			return region;
+	}
+	return std::nullopt;
+}
+
+void ShadowAtlasAllocator::Free(const ShadowAtlasRegion& region)
+{
+	uint32_t level = region.level;
+	uint32_t node = region.node;
+	if (level >= m_levelCount || node >= m_nodes[level].size() || m_nodes[level][node] != NodeState::used)
+	{
+		assert(false && "ͷ˲ڸͼ");
+		return;
+	}
+	m_nodes[level][node] = NodeState::free;
+	m_usedArea -= static_cast<uint64_t>(GetTileSize(level)) * GetTileSize(level);
+	// ĸֵܽڵ㶼ʱϲظڵ
+	for (; level > 0; --level)
+	{
+		auto siblings = m_nodes[level].begin() + (node & ~3u);
+		if (!std::all_of(siblings, siblings + 4, [](NodeState state) { return state == NodeState::free; }))
+			break;
+		std::fill_n(siblings, 4, NodeState::absent);
+		node >>= 2;
+		m_nodes[level - 1][node] = NodeState::free;
+	}
+}
+
+void ShadowAtlasAllocator::Reset()
+{
+	for (auto& nodes : m_nodes)
+	{
+		std::fill(nodes.begin(), nodes.end(), NodeState::absent);
+	}
+	m_nodes[0][0] = NodeState::free;
+	m_usedArea = 0;
+}
+
+uint32_t ShadowAtlasAllocator::GetAtlasSize() const
+{
+	return m_atlasSize;
+}
+
+uint32_t ShadowAtlasAllocator::GetMinTileSize() const
+{
+	return m_minTileSize;
+}
+
+uint64_t ShadowAtlasAllocator::GetUsedArea() const
+{
+	return m_usedArea;
+}
+
+uint32_t ShadowAtlasAllocator::GetLargestFreeSize() const
+{
+	for (uint32_t level = 0; level < m_levelCount; ++level)
+	{
+		const auto& nodes = m_nodes[level];
+		if (std::find(nodes.begin(), nodes.end(), NodeState::free) != nodes.end())
+			return GetTileSize(level);
+	}
+	return 0;
+}
+
+XMFLOAT4 ShadowAtlasAllocator::GetUVScaleBias(const ShadowAtlasRegion& region) const
+{
+	const float invSize = 1.0f / static_cast<float>(m_atlasSize);
+	return { region.size * invSize, region.size * invSize, region.x * invSize, region.y * invSize };
+}
+
+uint32_t ShadowAtlasAllocator::RoundUpPow2(uint32_t value)
+{
+	if (value <= 1)
+		return 1;
+	--value;
+	value |= value >> 1;
+	value |= value >> 2;
+	value |= value >> 4;
+	value |= value >> 8;
+	value |= value >> 16;
+	return value + 1;
+}
+
+uint32_t ShadowAtlasAllocator::GetTileSize(uint32_t level) const
+{
+	return m_atlasSize >> level;
+}
+
+ShadowAtlasRegion ShadowAtlasAllocator::MakeRegion(uint32_t level, uint32_t node) const
+{
+	const uint32_t tileSize = GetTileSize(level);
+	return { CompactBits(node) * tileSize, CompactBits(node >> 1) * tileSize, tileSize, level, node };
+}
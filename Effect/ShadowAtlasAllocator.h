@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include <DirectXMath.h>
+
+namespace Effect
+{
+// ӰͼеһtexelΪλ
+struct ShadowAtlasRegion
+{
+	uint32_t	x{ 0 };
+	uint32_t	y{ 0 };
+	uint32_t	size{ 0 };
+	uint32_t	level{ 0 };	// Ĳ㼶0Ϊͼ
+	uint32_t	node{ 0 };	// 㼶ڰMortonеĽڵ
+};
+
+/*
+ * ӰͼĲֻ򣬲Դ
+ * ÿڵ߳Ϊ2ݣʱѡСнڵ𼶲֣ͷʱĸֵܶϲظڵ
+ * ͬһ㼶Ľڵ㰴MortonңǿͼϽǣȴСط2ʱƬ
+ */
+class ShadowAtlasAllocator
+{
+public:
+	ShadowAtlasAllocator(uint32_t atlasSize, uint32_t minTileSize);
+	ShadowAtlasAllocator(const ShadowAtlasAllocator&) = delete;
+	ShadowAtlasAllocator& operator=(const ShadowAtlasAllocator&) = delete;
+	ShadowAtlasAllocator(ShadowAtlasAllocator&&) = default;
+	ShadowAtlasAllocator& operator=(ShadowAtlasAllocator&&) = default;
+	~ShadowAtlasAllocator() = default;
+
+	// sizeȡ2ݣռ䲻ʱؿ
+	std::optional<ShadowAtlasRegion> Allocate(uint32_t size);
+	// size޷ʱ𼶼룬ֱminSize
+	std::optional<ShadowAtlasRegion> Allocate(uint32_t size, uint32_t minSize);
+	void Free(const ShadowAtlasRegion& region);
+	// ȫ²ǰ
+	void Reset();
+
+	uint32_t GetAtlasSize() const;
+	uint32_t GetMinTileSize() const;
+	uint64_t GetUsedArea() const;
+	// ǰܷ߳ûпʱΪ0
+	uint32_t GetLargestFreeSize() const;
+	// ʱuv * (x, y) + (z, w)[0, 1]任ͼ
+	DirectX::XMFLOAT4 GetUVScaleBias(const ShadowAtlasRegion& region) const;
+
+	static uint32_t RoundUpPow2(uint32_t value);
+private:
+	enum class NodeState : uint8_t
+	{
+		absent = 0,	// Ƚڵлѱռãýڵ㲻
+		free,
+		split,
+		used
+	};
+
+	uint32_t GetTileSize(uint32_t level) const;
+	ShadowAtlasRegion MakeRegion(uint32_t level, uint32_t node) const;
+private:
+	uint32_t								m_atlasSize;
+	uint32_t								m_minTileSize;
+	uint32_t								m_levelCount;
+	uint64_t								m_usedArea{ 0 };
+	// level4^levelڵ㣬ڵnӽڵΪ4n ~ 4n + 3
+	std::vector<std::vector<NodeState>>		m_nodes;
+};
+}
@@ -73,6 +73,8 @@ void TemporalAA::OnResize(UINT newWidth, UINT newHeight)
 	{
 		m_width = newWidth;
 		m_height = newHeight;
+		m_heap.Reset();
+		m_heapOffset = 0;
 		CreateResources();
 		CreateDescriptors();
 		m_motionVector->OnResize(newWidth, newHeight);
@@ -80,7 +82,7 @@ void TemporalAA::OnResize(UINT newWidth, UINT newHeight)
 	}
 }
 
-void TemporalAA::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const
+void TemporalAA::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc)
 {
 	m_motionVector->Draw(cmdList, [](UINT){});
 
@@ -101,11 +103,13 @@ void TemporalAA::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<vo
 	const UINT groupX = static_cast<UINT>(std::ceilf(static_cast<float>(m_width) / 16.0f));
 	const UINT groupY = static_cast<UINT>(std::ceilf(static_cast<float>(m_height) / 16.0f));
 	cmdList->SetName(L"TemporalAA");
+	FlushBarriers(cmdList);
 	cmdList->Dispatch(groupX, groupY, 1);
 
 	// ǰresourceprevResourceȥ
 	ChangeState<D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_COPY_DEST>(cmdList, m_prevResource.Get());
 	ChangeState<D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE>(cmdList, m_resource.Get());
+	FlushBarriers(cmdList);
 	cmdList->CopyResource(m_prevResource.Get(), m_resource.Get());
 	ChangeState<D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList, m_prevResource.Get());
 	ChangeState<D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList, m_resource.Get());
@@ -120,14 +124,35 @@ void TemporalAA::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<vo
 void TemporalAA::FirstDraw(ID3D12GraphicsCommandList* cmdList, const D3D12_CPU_DESCRIPTOR_HANDLE& depthHandler,
 	ID3D12RootSignature* signature, const std::function<void()>& drawFunc)
 {
-	if (!m_dirtyFlag)
+	if (!BeginFirstPass(cmdList))
 		return;
+	BindFirstPass(cmdList, depthHandler, true);
+	drawFunc();
+	EndFirstPass(cmdList);
+}
+
+bool TemporalAA::BeginFirstPass(ID3D12GraphicsCommandList* cmdList) const
+{
+	if (!m_dirtyFlag)
+		return false;
 	ChangeState<D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET>(cmdList, m_prevResource.Get());
-	cmdList->ClearRenderTargetView(m_prevCpuRTV, Colors::Black, 0, nullptr);
-	cmdList->ClearDepthStencilView(depthHandler, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 0.0f, 0, 0, nullptr);
+	return true;
+}
+
+void TemporalAA::BindFirstPass(ID3D12GraphicsCommandList* cmdList, const D3D12_CPU_DESCRIPTOR_HANDLE& depthHandler, bool clear) const
+{
+	if (clear)
+	{
+		FlushBarriers(cmdList);
+		cmdList->ClearRenderTargetView(m_prevCpuRTV, Colors::Black, 0, nullptr);
+		cmdList->ClearDepthStencilView(depthHandler, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 0.0f, 0, 0, nullptr);
+	}
 	cmdList->OMSetRenderTargets(1, &m_prevCpuRTV, true, &depthHandler);
 	cmdList->SetPipelineState(m_firstPso.Get());
-	drawFunc();
+}
+
+void TemporalAA::EndFirstPass(ID3D12GraphicsCommandList* cmdList)
+{
 	ChangeState<D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList, m_prevResource.Get());
 
 	// jitterPointƫ
@@ -142,6 +167,7 @@ void TemporalAA::FirstDraw(ID3D12GraphicsCommandList* cmdList, const D3D12_CPU_D
 	const std::function<void()>& drawFunc) const
 {
 	ChangeState<D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET>(cmdList, m_prevResource.Get());
+	FlushBarriers(cmdList);
 	cmdList->ClearRenderTargetView(m_prevCpuRTV, Colors::Black, 0, nullptr);
 	cmdList->ClearDepthStencilView(depthHandler, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 0.0f, 0, 0, nullptr);
 	cmdList->OMSetRenderTargets(1, &m_prevCpuRTV, true, &depthHandler);
@@ -217,7 +243,7 @@ void TemporalAA::CreateResources()
 	{
 		const auto& properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
 		resDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
-		ThrowIfFailed(m_device->CreateCommittedResource(&properties, D3D12_HEAP_FLAG_NONE, &resDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&m_resource)));
+		CreateOutputResource(resDesc, D3D12_RESOURCE_STATE_GENERIC_READ, m_resource);
 		m_resource->SetName(L"outputTAA");
 
 		constexpr float clearColor[] = { 0.0f, 0.0f, 0.0f, 1.0f };
@@ -20,10 +20,14 @@ public:
 	void InitTexture(const string& temporalName, const string& prevName, const string& motionVecName);
 	void Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc) override;
 	void OnResize(UINT newWidth, UINT newHeight) override;
-	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const override;
+	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) override;
 	void FirstDraw(ID3D12GraphicsCommandList* cmdList, const D3D12_CPU_DESCRIPTOR_HANDLE& depthHandler,
 		ID3D12RootSignature* signature, const std::function<void()>& drawFunc);
 	void FirstDraw(ID3D12GraphicsCommandList* cmdList, const D3D12_CPU_DESCRIPTOR_HANDLE& depthHandler, const std::function<void()>& drawFunc) const;
+	// ֺ̣֡BeginFirstPassfalseʾ֡
+	bool BeginFirstPass(ID3D12GraphicsCommandList* cmdList) const;
+	void BindFirstPass(ID3D12GraphicsCommandList* cmdList, const D3D12_CPU_DESCRIPTOR_HANDLE& depthHandler, bool clear) const;
+	void EndFirstPass(ID3D12GraphicsCommandList* cmdList);
 	void CreateDescriptors(D3D12_CPU_DESCRIPTOR_HANDLE srvCpuStart, D3D12_GPU_DESCRIPTOR_HANDLE srvGpuStart, D3D12_CPU_DESCRIPTOR_HANDLE rtvCpuStart, UINT srvSize, UINT rtvSize);
 	XMFLOAT2 GetJitter() const;
 	D3D12_GPU_DESCRIPTOR_HANDLE GetMotionVector() const;
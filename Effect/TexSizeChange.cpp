@@ -10,7 +10,7 @@ Effect::TexSizeChange::TexSizeChange(ID3D12Device* _device, UINT _width, UINT _h
 	CreateResources();
 }
 
-void Effect::TexSizeChange::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const {
+void Effect::TexSizeChange::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) {
 }
 
 void Effect::TexSizeChange::CreateResources() {
@@ -43,7 +43,8 @@ void Effect::TexSizeChange::CreateResources() {
 	upDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
 	{
 		const auto& properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-		ThrowIfFailed(m_device->CreateCommittedResource(&properties, D3D12_HEAP_FLAG_NONE, &upDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&downSamplerRes)));
+		// ֻн֡ʹãԷ˲̬
+		CreateOutputResource(upDesc, D3D12_RESOURCE_STATE_COMMON, downSamplerRes);
 		ThrowIfFailed(m_device->CreateCommittedResource(&properties, D3D12_HEAP_FLAG_NONE, &downDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&downSamplerRes1)));
 		ThrowIfFailed(m_device->CreateCommittedResource(&properties, D3D12_HEAP_FLAG_NONE, &upDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&upSamplerRes)));
 	}
@@ -21,7 +21,7 @@ public:
 	void InitShader();
 	void InitPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& templateDesc) override;
 	void Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc) override;
-	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const override;
+	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) override;
 	template <typename T, std::enable_if_t<std::is_base_of_v<Sampler, T> && T::value>* = nullptr>
 	void SubDraw(ID3D12GraphicsCommandList* cmdList, ID3D12Resource* source) const;
 	template <typename T, std::enable_if_t<std::is_base_of_v<Sampler, T> && !T::value>* = nullptr>
@@ -81,10 +81,12 @@ void TexSizeChange::SubDraw(ID3D12GraphicsCommandList* cmdList, ID3D12Resource*
 	const UINT downGroupX = static_cast<UINT>(std::ceilf(static_cast<float>(m_sizeData.m_shrinkWidth) / 16.0f));
 	const UINT downGroupY = static_cast<UINT>(std::ceilf(static_cast<float>(m_sizeData.m_shrinkHeight) / 16.0f));
 	cmdList->SetName(L"DownSampler");
+	FlushBarriers(cmdList);
 	cmdList->Dispatch(downGroupX, downGroupY, 1);
 	ChangeState<D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_COMMON>(cmdList, downSamplerRes.Get());
 	ChangeState<D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE>(cmdList, downSamplerRes1.Get());
 	ChangeState<D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST>(cmdList, source);
+	FlushBarriers(cmdList);
 	cmdList->CopyResource(source, downSamplerRes1.Get());
 	ChangeState<D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList, source);
 	ChangeState<D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_COMMON>(cmdList, downSamplerRes1.Get());
@@ -102,6 +104,7 @@ void TexSizeChange::SubDraw(ID3D12GraphicsCommandList* cmdList, CD3DX12_GPU_DESC
 	const UINT upGroupX = static_cast<UINT>(std::ceilf(static_cast<float>(m_width) / 16.0f));
 	const UINT upGroupY = static_cast<UINT>(std::ceilf(static_cast<float>(m_height) / 16.0f));
 	cmdList->SetName(L"UpSampler");
+	FlushBarriers(cmdList);
 	cmdList->Dispatch(upGroupX, upGroupY, 1);
 	ChangeState<D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COMMON>(cmdList, upSamplerRes.Get());
 }
@@ -20,7 +20,7 @@ void Effect::ToneMap::InitPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& template
 void Effect::ToneMap::Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc) {
 }
 
-void Effect::ToneMap::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const {
+void Effect::ToneMap::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) {
 	ChangeState<D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_UNORDERED_ACCESS>(cmdList, m_resource.Get());
 	cmdList->SetComputeRootSignature(PostProcessMgr::instance().GetRootSignature());
 	cmdList->SetPipelineState(m_pso.Get());
@@ -28,6 +28,7 @@ void Effect::ToneMap::Draw(ID3D12GraphicsCommandList* cmdList, const std::functi
 	drawFunc(NULL);
 	UINT groupX = (UINT)std::ceilf((float)m_width / 16.0f);
 	UINT groupY = (UINT)std::ceilf((float)m_height / 16.0f);
+	FlushBarriers(cmdList);
 	cmdList->Dispatch(groupX, groupY, 1);
 	ChangeState<D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE>(cmdList, m_resource.Get());
 }
@@ -62,11 +63,8 @@ void Effect::ToneMap::CreateResources() {
 	uavDesc.SampleDesc.Quality = 0;
 	uavDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
 	uavDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
-	{
-		const auto& properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-		ThrowIfFailed(m_device->CreateCommittedResource(&properties, D3D12_HEAP_FLAG_NONE, &uavDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&m_resource)));
-		m_resource->SetName(L"ToneMapOutput");
-	}
+	CreateOutputResource(uavDesc, D3D12_RESOURCE_STATE_COMMON, m_resource);
+	m_resource->SetName(L"ToneMapOutput");
 }
 
 void Effect::ToneMap::CreateDescriptors() {
@@ -0,0 +1,470 @@
+#include "BVH.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace Models;
+
+namespace
+{
+enum class Overlap : uint8_t
+{
+	Outside,
+	Intersect,
+	Inside
+};
+
+float SurfaceArea(const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax)
+{
+	const float x = boundsMax.x - boundsMin.x;
+	const float y = boundsMax.y - boundsMin.y;
+	const float z = boundsMax.z - boundsMin.z;
+	return 2.0f * (x * y + y * z + z * x);
+}
+
+void Grow(XMFLOAT3& boundsMin, XMFLOAT3& boundsMax, const XMFLOAT3& otherMin, const XMFLOAT3& otherMax)
+{
+	boundsMin = XMFLOAT3(std::min(boundsMin.x, otherMin.x), std::min(boundsMin.y, otherMin.y), std::min(boundsMin.z, otherMin.z));
+	boundsMax = XMFLOAT3(std::max(boundsMax.x, otherMax.x), std::max(boundsMax.y, otherMax.y), std::max(boundsMax.z, otherMax.z));
+}
+
+float Component(const XMFLOAT3& v, uint32_t axis)
+{
+	return (&v.x)[axis];
+}
+
+void BoxToMinMax(const BoundingBox& box, XMFLOAT3& boundsMin, XMFLOAT3& boundsMax)
+{
+	boundsMin = XMFLOAT3(box.Center.x - box.Extents.x, box.Center.y - box.Extents.y, box.Center.z - box.Extents.z);
+	boundsMax = XMFLOAT3(box.Center.x + box.Extents.x, box.Center.y + box.Extents.y, box.Center.z + box.Extents.z);
+}
+
+BoundingBox MinMaxToBox(const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax)
+{
+	BoundingBox box;
+	BoundingBox::CreateFromPoints(box, XMLoadFloat3(&boundsMin), XMLoadFloat3(&boundsMax));
+	return box;
+}
+
+constexpr XMFLOAT3 emptyMin{ FLT_MAX, FLT_MAX, FLT_MAX };
+constexpr XMFLOAT3 emptyMax{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+}
+
+void BVH::Build(const std::vector<BoundingBox>& primBounds)
+{
+	Clear();
+	m_primBounds = primBounds;
+	std::vector<BuildPrim> prims(primBounds.size());
+	for (size_t i = 0; i < primBounds.size(); ++i)
+	{
+		BoxToMinMax(primBounds[i], prims[i].boundsMin, prims[i].boundsMax);
+		prims[i].centroid = primBounds[i].Center;
+		prims[i].index = static_cast<uint32_t>(i);
+	}
+	BuildFromPrims(prims);
+}
+
+void BVH::BuildTriangles(const std::vector<XMFLOAT3>& positions, const std::vector<uint32_t>& indices)
+{
+	assert(indices.size() % 3 == 0);
+	Clear();
+	const size_t triCount = indices.size() / 3;
+	m_triangles.resize(indices.size());
+	m_primBounds.resize(triCount);
+	std::vector<BuildPrim> prims(triCount);
+	for (size_t i = 0; i < triCount; ++i)
+	{
+		XMFLOAT3 boundsMin = emptyMin;
+		XMFLOAT3 boundsMax = emptyMax;
+		for (size_t j = 0; j < 3; ++j)
+		{
+			const XMFLOAT3& p = positions[indices[3 * i + j]];
+			m_triangles[3 * i + j] = p;
+			Grow(boundsMin, boundsMax, p, p);
+		}
+		prims[i].boundsMin = boundsMin;
+		prims[i].boundsMax = boundsMax;
+		m_primBounds[i] = MinMaxToBox(boundsMin, boundsMax);
+		prims[i].centroid = m_primBounds[i].Center;
+		prims[i].index = static_cast<uint32_t>(i);
+	}
+	BuildFromPrims(prims);
+}
+
+void BVH::Refit(const std::vector<BoundingBox>& primBounds)
+{
+	assert(primBounds.size() == m_primBounds.size() && m_triangles.empty());
+	m_primBounds = primBounds;
+	// ӽڵǴڸڵ㣬ɱ֤ȸӽڵ
+	for (size_t n = m_nodes.size(); n-- > 0;)
+	{
+		auto& node = m_nodes[n];
+		node.boundsMin = emptyMin;
+		node.boundsMax = emptyMax;
+		if (node.IsLeaf())
+		{
+			for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+			{
+				XMFLOAT3 primMin, primMax;
+				BoxToMinMax(m_primBounds[m_primIndices[i]], primMin, primMax);
+				Grow(node.boundsMin, node.boundsMax, primMin, primMax);
+			}
+		}
+		else
+		{
+			const auto& left = m_nodes[n + 1];
+			const auto& right = m_nodes[node.offset];
+			Grow(node.boundsMin, node.boundsMax, left.boundsMin, left.boundsMax);
+			Grow(node.boundsMin, node.boundsMax, right.boundsMin, right.boundsMax);
+		}
+	}
+}
+
+void BVH::Clear()
+{
+	m_nodes.clear();
+	m_primIndices.clear();
+	m_primBounds.clear();
+	m_triangles.clear();
+}
+
+void BVH::BuildFromPrims(std::vector<BuildPrim>& prims)
+{
+	const uint32_t count = static_cast<uint32_t>(prims.size());
+	if (count == 0)
+		return;
+	// ڵᳬ2n-1
+	m_nodes.reserve(2ULL * count - 1);
+	BuildNode(prims, 0, count, 0);
+	m_nodes.shrink_to_fit();
+	m_primIndices.resize(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		m_primIndices[i] = prims[i].index;
+	}
+}
+
+uint32_t BVH::BuildNode(std::vector<BuildPrim>& prims, uint32_t begin, uint32_t end, uint32_t depth)
+{
+	const uint32_t nodeIdx = static_cast<uint32_t>(m_nodes.size());
+	m_nodes.emplace_back();
+	XMFLOAT3 boundsMin = emptyMin, boundsMax = emptyMax;
+	XMFLOAT3 centroidMin = emptyMin, centroidMax = emptyMax;
+	for (uint32_t i = begin; i < end; ++i)
+	{
+		Grow(boundsMin, boundsMax, prims[i].boundsMin, prims[i].boundsMax);
+		Grow(centroidMin, centroidMax, prims[i].centroid, prims[i].centroid);
+	}
+	m_nodes[nodeIdx].boundsMin = boundsMin;
+	m_nodes[nodeIdx].boundsMax = boundsMax;
+
+	const uint32_t count = end - begin;
+	auto MakeLeaf = [&]()
+	{
+		m_nodes[nodeIdx].offset = begin;
+		m_nodes[nodeIdx].count = count;
+	};
+	if (count <= maxLeafSize || depth >= maxDepth)
+	{
+		MakeLeaf();
+		return nodeIdx;
+	}
+
+	/*
+	 * SAHÿϽķΧΪbinCount䣬ɨõÿλõĴ
+	 * ͬʱȱλã֤ȷ
+	 */
+	float bestCost = FLT_MAX;
+	uint32_t bestAxis = 0;
+	uint32_t bestSplit = 0;
+	for (uint32_t axis = 0; axis < 3; ++axis)
+	{
+		const float axisMin = Component(centroidMin, axis);
+		const float extent = Component(centroidMax, axis) - axisMin;
+		if (extent <= 1e-6f)
+			continue;
+		const float scale = static_cast<float>(binCount) / extent;
+		XMFLOAT3 binMin[binCount], binMax[binCount];
+		uint32_t binPrims[binCount]{};
+		std::fill(std::begin(binMin), std::end(binMin), emptyMin);
+		std::fill(std::begin(binMax), std::end(binMax), emptyMax);
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			const uint32_t bin = std::min(binCount - 1, static_cast<uint32_t>((Component(prims[i].centroid, axis) - axisMin) * scale));
+			Grow(binMin[bin], binMax[bin], prims[i].boundsMin, prims[i].boundsMax);
+			++binPrims[bin];
+		}
+		float leftArea[binCount - 1];
+		uint32_t leftCount[binCount - 1];
+		XMFLOAT3 sweepMin = emptyMin, sweepMax = emptyMax;
+		uint32_t sweepCount = 0;
+		for (uint32_t b = 0; b < binCount - 1; ++b)
+		{
+			Grow(sweepMin, sweepMax, binMin[b], binMax[b]);
+			sweepCount += binPrims[b];
+			leftCount[b] = sweepCount;
+			leftArea[b] = sweepCount > 0 ? SurfaceArea(sweepMin, sweepMax) : 0.0f;
+		}
+		sweepMin = emptyMin;
+		sweepMax = emptyMax;
+		sweepCount = 0;
+		for (uint32_t b = binCount - 1; b > 0; --b)
+		{
+			Grow(sweepMin, sweepMax, binMin[b], binMax[b]);
+			sweepCount += binPrims[b];
+			if (leftCount[b - 1] == 0 || sweepCount == 0)
+				continue;
+			const float cost = leftArea[b - 1] * static_cast<float>(leftCount[b - 1]) + SurfaceArea(sweepMin, sweepMax) * static_cast<float>(sweepCount);
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = b;
+			}
+		}
+	}
+
+	uint32_t mid;
+	if (bestCost == FLT_MAX)
+	{
+		// غϣ޷ռ仮ֱ֣Ӱƽ
+		mid = begin + count / 2;
+	}
+	else
+	{
+		// ֵĴ۲ڲʱͼԪ㹻پͱΪҶڵ
+		const float leafCost = SurfaceArea(boundsMin, boundsMax) * static_cast<float>(count);
+		if (bestCost >= leafCost && count <= 4 * maxLeafSize)
+		{
+			MakeLeaf();
+			return nodeIdx;
+		}
+		const float axisMin = Component(centroidMin, bestAxis);
+		const float scale = static_cast<float>(binCount) / (Component(centroidMax, bestAxis) - axisMin);
+		// ȶֱͼԪ˳
+		const auto split = std::stable_partition(prims.begin() + begin, prims.begin() + end, [&](const BuildPrim& prim)
+		{
+			return std::min(binCount - 1, static_cast<uint32_t>((Component(prim.centroid, bestAxis) - axisMin) * scale)) < bestSplit;
+		});
+		mid = static_cast<uint32_t>(split - prims.begin());
+	}
+
+	BuildNode(prims, begin, mid, depth + 1);
+	const uint32_t right = BuildNode(prims, mid, end, depth + 1);
+	m_nodes[nodeIdx].offset = right;
+	m_nodes[nodeIdx].count = 0;
+	return nodeIdx;
+}
+
+template <typename OverlapFunc>
+void BVH::Traverse(OverlapFunc&& overlap, std::vector<uint32_t>& result) const
+{
+	if (m_nodes.empty())
+		return;
+	// ڶֵǸǷȫλڲѯΧ
+	std::pair<uint32_t, bool> stack[maxDepth * 2];
+	uint32_t top = 0;
+	stack[top++] = { 0, false };
+	while (top > 0)
+	{
+		const auto [nodeIdx, inside] = stack[--top];
+		const auto& node = m_nodes[nodeIdx];
+		Overlap state = Overlap::Inside;
+		if (!inside)
+		{
+			state = overlap(node.boundsMin, node.boundsMax);
+			if (state == Overlap::Outside)
+				continue;
+		}
+		if (node.IsLeaf())
+		{
+			for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+			{
+				const uint32_t primIdx = m_primIndices[i];
+				if (state == Overlap::Inside)
+				{
+					result.emplace_back(primIdx);
+					continue;
+				}
+				XMFLOAT3 primMin, primMax;
+				BoxToMinMax(m_primBounds[primIdx], primMin, primMax);
+				if (overlap(primMin, primMax) != Overlap::Outside)
+					result.emplace_back(primIdx);
+			}
+			continue;
+		}
+		const bool childInside = state == Overlap::Inside;
+		stack[top++] = { node.offset, childInside };
+		stack[top++] = { nodeIdx + 1, childInside };
+	}
+}
+
+void BVH::QueryPlanes(const XMFLOAT4* planes, uint32_t planeCount, std::vector<uint32_t>& result) const
+{
+	Traverse([planes, planeCount](const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax)
+	{
+		const XMFLOAT3 center((boundsMin.x + boundsMax.x) * 0.5f, (boundsMin.y + boundsMax.y) * 0.5f, (boundsMin.z + boundsMax.z) * 0.5f);
+		const XMFLOAT3 extent((boundsMax.x - boundsMin.x) * 0.5f, (boundsMax.y - boundsMin.y) * 0.5f, (boundsMax.z - boundsMin.z) * 0.5f);
+		Overlap state = Overlap::Inside;
+		for (uint32_t i = 0; i < planeCount; ++i)
+		{
+			const auto& p = planes[i];
+			const float dist = p.x * center.x + p.y * center.y + p.z * center.z + p.w;
+			const float radius = std::abs(p.x) * extent.x + std::abs(p.y) * extent.y + std::abs(p.z) * extent.z;
+			if (dist > radius)
+				return Overlap::Outside;
+			if (dist > -radius)
+				state = Overlap::Intersect;
+		}
+		return state;
+	}, result);
+}
+
+void BVH::QueryFrustum(const BoundingFrustum& frustum, std::vector<uint32_t>& result) const
+{
+	XMVECTOR planesXM[6];
+	frustum.GetPlanes(&planesXM[0], &planesXM[1], &planesXM[2], &planesXM[3], &planesXM[4], &planesXM[5]);
+	XMFLOAT4 planes[6];
+	for (uint32_t i = 0; i < 6; ++i)
+	{
+		XMStoreFloat4(&planes[i], planesXM[i]);
+	}
+	QueryPlanes(planes, 6, result);
+}
+
+void BVH::QueryAABB(const BoundingBox& box, std::vector<uint32_t>& result) const
+{
+	XMFLOAT3 queryMin, queryMax;
+	BoxToMinMax(box, queryMin, queryMax);
+	Traverse([&queryMin, &queryMax](const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax)
+	{
+		if (boundsMin.x > queryMax.x || boundsMax.x < queryMin.x ||
+			boundsMin.y > queryMax.y || boundsMax.y < queryMin.y ||
+			boundsMin.z > queryMax.z || boundsMax.z < queryMin.z)
+			return Overlap::Outside;
+		if (boundsMin.x >= queryMin.x && boundsMax.x <= queryMax.x &&
+			boundsMin.y >= queryMin.y && boundsMax.y <= queryMax.y &&
+			boundsMin.z >= queryMin.z && boundsMax.z <= queryMax.z)
+			return Overlap::Inside;
+		return Overlap::Intersect;
+	}, result);
+}
+
+void BVH::QuerySphere(const BoundingSphere& sphere, std::vector<uint32_t>& result) const
+{
+	Traverse([&sphere](const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax)
+	{
+		switch (sphere.Contains(MinMaxToBox(boundsMin, boundsMax)))
+		{
+		case DISJOINT:
+			return Overlap::Outside;
+		case CONTAINS:
+			return Overlap::Inside;
+		default:
+			return Overlap::Intersect;
+		}
+	}, result);
+}
+
+bool BVH::Raycast(FXMVECTOR origin, FXMVECTOR direction, float maxDistance, RayHit& hit) const
+{
+	hit = RayHit{};
+	if (m_nodes.empty())
+		return false;
+	const XMVECTOR dir = XMVector3Normalize(direction);
+	XMFLOAT3 o, invDir;
+	XMStoreFloat3(&o, origin);
+	XMStoreFloat3(&invDir, XMVectorReciprocal(dir));
+	float closest = maxDistance;
+	// ڵΧеslabԣؽ룬δཻʱFLT_MAX
+	auto NodeEntry = [&](const BVHNode& node)
+	{
+		float tMin = 0.0f;
+		float tMax = closest;
+		for (uint32_t axis = 0; axis < 3; ++axis)
+		{
+			const float inv = Component(invDir, axis);
+			float t0 = (Component(node.boundsMin, axis) - Component(o, axis)) * inv;
+			float t1 = (Component(node.boundsMax, axis) - Component(o, axis)) * inv;
+			if (t0 > t1)
+				std::swap(t0, t1);
+			tMin = std::max(tMin, t0);
+			tMax = std::min(tMax, t1);
+			if (tMin > tMax)
+				return FLT_MAX;
+		}
+		return tMin;
+	};
+
+	uint32_t stack[maxDepth * 2];
+	uint32_t top = 0;
+	stack[top++] = 0;
+	while (top > 0)
+	{
+		const auto& node = m_nodes[stack[--top]];
+		if (NodeEntry(node) == FLT_MAX)
+			continue;
+		if (node.IsLeaf())
+		{
+			for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+			{
+				float dist;
+				if (IntersectPrimitive(origin, dir, m_primIndices[i], dist) && dist < closest)
+				{
+					closest = dist;
+					hit.primitive = m_primIndices[i];
+					hit.distance = dist;
+				}
+			}
+			continue;
+		}
+		// ȷʽϽӽڵ㣬Ա㾡closest
+		uint32_t nearIdx = static_cast<uint32_t>(&node - m_nodes.data()) + 1;
+		uint32_t farIdx = node.offset;
+		if (NodeEntry(m_nodes[nearIdx]) > NodeEntry(m_nodes[farIdx]))
+			std::swap(nearIdx, farIdx);
+		stack[top++] = farIdx;
+		stack[top++] = nearIdx;
+	}
+	return hit.primitive != UINT_MAX;
+}
+
+bool BVH::IntersectPrimitive(FXMVECTOR origin, FXMVECTOR direction, uint32_t primIdx, float& dist) const
+{
+	if (m_triangles.empty())
+	{
+		return m_primBounds[primIdx].Intersects(origin, direction, dist);
+	}
+	const XMVECTOR v0 = XMLoadFloat3(&m_triangles[3 * primIdx]);
+	const XMVECTOR v1 = XMLoadFloat3(&m_triangles[3 * primIdx + 1]);
+	const XMVECTOR v2 = XMLoadFloat3(&m_triangles[3 * primIdx + 2]);
+	return TriangleTests::Intersects(origin, direction, v0, v1, v2, dist);
+}
+
+bool BVH::Empty() const
+{
+	return m_nodes.empty();
+}
+
+uint32_t BVH::GetPrimitiveCount() const
+{
+	return static_cast<uint32_t>(m_primBounds.size());
+}
+
+const BoundingBox& BVH::GetPrimitiveBounds(uint32_t primIdx) const
+{
+	assert(primIdx < m_primBounds.size());
+	return m_primBounds[primIdx];
+}
+
+BoundingBox BVH::GetBounds() const
+{
+	if (m_nodes.empty())
+		return BoundingBox();
+	return MinMaxToBox(m_nodes[0].boundsMin, m_nodes[0].boundsMax);
+}
+
+const std::vector<BVHNode>& BVH::GetNodes() const
+{
+	return m_nodes;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <DirectXCollision.h>
+#include <cfloat>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+namespace Models
+{
+using namespace DirectX;
+
+/*
+ * ƽBVHڵ㣬32ֽ
+ * ڲڵӽڵ(idx + 1)offsetΪӽڵ㣻ҶڵoffsetΪͼԪ㣬countΪͼԪ
+ */
+struct BVHNode
+{
+	XMFLOAT3	boundsMin;
+	uint32_t	offset{ 0 };
+	XMFLOAT3	boundsMax;
+	uint32_t	count{ 0 };
+
+	bool IsLeaf() const { return count > 0; }
+};
+
+struct RayHit
+{
+	uint32_t	primitive{ UINT_MAX };
+	float		distance{ FLT_MAX };
+};
+
+/*
+ * ڷSAHĲΰΧ
+ * ͼԪǰΧ(Ⱦ)ΣѯͼԪе
+ * ֻݣͬǵõͬѯΪconstڶ߳ͬʱ
+ */
+class BVH
+{
+public:
+	BVH() = default;
+	BVH(const BVH&) = delete;
+	BVH& operator=(const BVH&) = delete;
+	BVH(BVH&&) = default;
+	BVH& operator=(BVH&&) = default;
+	~BVH() = default;
+
+	void Build(const std::vector<BoundingBox>& primBounds);
+	void BuildTriangles(const std::vector<XMFLOAT3>& positions, const std::vector<uint32_t>& indices);
+	// ˲䣬ֻԵϸ½ڵİΧУƶʵ
+	void Refit(const std::vector<BoundingBox>& primBounds);
+	void Clear();
+
+	/*
+	 * ƽBoundingFrustumԼһ£߳
+	 * ȫλƽڲĽڵ㲻²ԣֱȫͼԪ
+	 */
+	void QueryPlanes(const XMFLOAT4* planes, uint32_t planeCount, std::vector<uint32_t>& result) const;
+	void QueryFrustum(const BoundingFrustum& frustum, std::vector<uint32_t>& result) const;
+	void QueryAABB(const BoundingBox& box, std::vector<uint32_t>& result) const;
+	void QuerySphere(const BoundingSphere& sphere, std::vector<uint32_t>& result) const;
+	// Ľ㣬ͼԪȷ󽻣ΧͼԪΧ
+	bool Raycast(FXMVECTOR origin, FXMVECTOR direction, float maxDistance, RayHit& hit) const;
+
+	bool Empty() const;
+	uint32_t GetPrimitiveCount() const;
+	const BoundingBox& GetPrimitiveBounds(uint32_t primIdx) const;
+	BoundingBox GetBounds() const;
+	const std::vector<BVHNode>& GetNodes() const;
+private:
+	struct BuildPrim
+	{
+		XMFLOAT3	boundsMin;
+		XMFLOAT3	boundsMax;
+		XMFLOAT3	centroid;
+		uint32_t	index;
+	};
+	void BuildFromPrims(std::vector<BuildPrim>& prims);
+	uint32_t BuildNode(std::vector<BuildPrim>& prims, uint32_t begin, uint32_t end, uint32_t depth);
+	template <typename OverlapFunc>
+	void Traverse(OverlapFunc&& overlap, std::vector<uint32_t>& result) const;
+	bool IntersectPrimitive(FXMVECTOR origin, FXMVECTOR direction, uint32_t primIdx, float& dist) const;
+private:
+	static constexpr uint32_t	binCount = 16;
+	static constexpr uint32_t	maxLeafSize = 4;
+	static constexpr uint32_t	maxDepth = 64;		// ȵĽڵֱΪҶڵ㣬ѯջ˿Թ̶С
+
+	std::vector<BVHNode>		m_nodes;
+	std::vector<uint32_t>		m_primIndices;	// Ҷڵ䵽ԭʼͼԪŵӳ
+	std::vector<BoundingBox>	m_primBounds;
+	std::vector<XMFLOAT3>		m_triangles;	// ģʽÿͼԪ3
+};
+}
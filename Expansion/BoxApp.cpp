@@ -13,6 +13,10 @@
 #include "ObjLoader.h"
 #include "PostProcessMgr.hpp"
 #include "Scene.h"
+#include "ThreadPool.hpp"
+#include "UploadRing.h"
+#include "D3D12GraphBackend.h"
+#include "D3D12StateTracker.h"
 #if defined(DEBUG) || defined(_DEBUG)
 #include "DebugMgr.hpp"
 #endif
@@ -23,15 +27,19 @@ BoxApp::BoxApp(HINSTANCE instance, bool startMsaa, Camera::CameraType type)
 : D3DApp_Template(instance, startMsaa, type), m_material(std::make_shared<Material>()), m_skybox(std::make_unique<Effect::CubeMap>())
 {
 	m_passOffset = PassConstant::RegisterPassCount(1);
+	// ÿpassֵĿͬʱڿõ߳
+	m_recorder = std::make_unique<ParallelRecorder<RenderItem>>(std::min(4U, Thread::ThreadPool::instance().GetWorkerCount() + 1), 32U);
 	m_pixelLights.reserve(maxLights);
-	m_computeLights.reserve(pointLightNum);
-	m_pointLightPos.reserve(pointLightNum);
 }
 
 bool BoxApp::Init()
 {
 	if(!D3DApp_Template::Init(*this))
 		return false;
+	// бÿ֡ύиԴ״̬¼ڵбУбõǰ֡ķ
+	ThrowIfFailed(m_d3dDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_commandAllocator.Get(), nullptr, IID_PPV_ARGS(m_fixupCommandList.GetAddressOf())));
+	ThrowIfFailed(m_fixupCommandList->Close());
+	m_stateTracker = std::make_unique<D3D12StateTracker>(m_commandList.Get());
 	m_commandList->Reset(m_commandAllocator.Get(), nullptr);
 
 	CreateLights();
@@ -44,6 +52,7 @@ bool BoxApp::Init()
 	CreateRenderItems();
 	CreateFrameResources();
 	CreatePSO();
+	PlaceTransientResources();
 
 	// ִгʼ
 	m_commandList->Close();
@@ -51,6 +60,9 @@ bool BoxApp::Init()
 	m_commandQueue->ExecuteCommandLists(_countof(cmdLists), cmdLists);
 	FlushCommandQueue();
 
+	// ԤIBLҪպУں̨
+	TextureMgr::instance().WaitForTexture(m_skybox->TexName());
+	TextureMgr::instance().ApplySwaps(m_currFence, m_currFence);
 	UpdateLUT(m_timer);
 	DrawLUT();
 
@@ -65,12 +77,20 @@ BoxApp::~BoxApp()
 
 void BoxApp::Resize()
 {
+	// ؽԴܸþԴĵַ
+	D3D12StateTracker::GetGlobalTable().Clear();
 	D3DApp_Template::Resize(*this);
 	gBuffer->Resize(m_clientWidth, m_clientHeight);
 	m_renderer->OnResize(m_clientWidth, m_clientHeight);
+	m_forwardPlus->OnResize(m_clientWidth, m_clientHeight);
 	m_blur->OnResize(m_clientWidth, m_clientHeight);
 	m_toneMap->OnResize(m_clientWidth, m_clientHeight);
+	m_depthReduction->OnResize(m_clientWidth, m_clientHeight);
+	m_hiZReadback->OnResize(m_clientWidth, m_clientHeight);
 	m_TemporalAA->OnResize(m_clientWidth, m_clientHeight);
+	// ߴ仯˲̬ԴؽΪcommittedԴInitеһResizeʱδInit
+	if (m_transientHeap)
+		PlaceTransientResources();
 }
 
 void BoxApp::Update(const GameTimer& timer)
@@ -89,19 +109,36 @@ void BoxApp::Update(const GameTimer& timer)
 		WaitForSingleObject(eventHandler, INFINITE);
 		CloseHandle(eventHandler);
 	}
+	// ֡ԴһдȷΧʱѾɶڱ֡ļ
+	m_shadow->SetDepthBounds(m_depthReduction->ReadBack(static_cast<UINT>(m_currFrameResourceIndex)));
 
-	{
-		XMMATRIX rotate = XMMatrixRotationY(static_cast<float>(0.1 * timer.DeltaTime()));
-		XMVECTOR lightDir = XMVector3TransformNormal(m_pixelLights[0]->GetLightDir(), rotate);
-		XMStoreFloat3(&const_cast<XMFLOAT3&>(m_pixelLights[0]->GetData().direction), lightDir);
-		UpdateLightPos(timer);
-	}
+	// GPUѾִɵ֡ڻϴеķ䣬Ϊ֡ÿ֡дĳ
+	auto& uploadRing = UploadRing::instance();
+	uploadRing.Reclaim(m_fence->GetCompletedValue());
+	m_currFrameResource->m_passCB = uploadRing.Allocate<PassConstant>(PassConstant::GetPassCount(), true);
+	m_currFrameResource->m_postProcessCB = uploadRing.Allocate<PostProcessPass>(1, true);
+
+	// ϴɵдµ;֡õľ֡ΧԽm_currFenceգڱ֡ʱµ
+	if (TextureMgr::instance().Pump())
+		TextureMgr::instance().ApplySwaps(m_fence->GetCompletedValue(), m_currFence);
+
+	XMMATRIX rotate = XMMatrixRotationY(static_cast<float>(0.1 * timer.DeltaTime()));
+	XMVECTOR lightDir = XMVector3TransformNormal(m_pixelLights[0]->GetLightDir(), rotate);
+	XMStoreFloat3(&const_cast<XMFLOAT3&>(m_pixelLights[0]->GetData().direction), lightDir);
+
+	// Դƶֻ»ţΪύ̳߳
+	auto& pool = Thread::ThreadPool::instance();
+	auto lightTask = pool.Submit([&]() { UpdateLightPos(timer); });
 
 	UpdateObjectInstance(timer);
+	UpdateSceneBVH();
 	UpdatePassConstant(timer);
 	UpdateMaterialConstant(timer);
 	UpdatePostProcess(timer);
 	UpdateOffScreen(timer);
+	UpdateCulling();
+	UpdateTransparentOrder();
+	pool.Wait(lightTask);
 }
 
 void BoxApp::DrawScene(const GameTimer& timer)
@@ -109,114 +146,64 @@ void BoxApp::DrawScene(const GameTimer& timer)
 	auto alloc = m_currFrameResource->m_commandAllocator;
 	ThrowIfFailed(alloc->Reset());
 	ThrowIfFailed(m_commandList->Reset(alloc.Get(), gBuffer->m_pso.Get()));
-
-	// ǩCBV/SRVõ
-	ID3D12DescriptorHeap* descriptorSRVHeaps[] = { TextureMgr::instance().GetSRVDescriptorHeap() };
-	m_commandList->SetDescriptorHeaps(_countof(descriptorSRVHeaps), descriptorSRVHeaps);
-	m_commandList->SetGraphicsRootSignature(m_rootSignature.Get());
-
-	// matBuffer
-	auto matBuffer = m_currFrameResource->m_materialCBuffer->GetResource();
-	m_commandList->SetGraphicsRootShaderResourceView(2, matBuffer->GetGPUVirtualAddress());
-	// textureBuffer
-	m_commandList->SetGraphicsRootDescriptorTable(6, TextureMgr::instance().GetSRVDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
-	m_shadow->CopyCascadedShadowPass(m_commandList.Get());
+	m_stateTracker->Begin();
+	BindFrameState(m_commandList.Get());
 
 	/*
-	 * ʵʱȾ
+	 * ӰTAA֡GBufferеȾڹ߳в¼ƵԵб
+	 * бЩpassԴ״̬תύ֮˳ύ̵߳б
 	 */
-	m_shadow->Draw(m_commandList.Get(), [&](UINT offset)
-	{
-		constexpr UINT passCBSize = D3DUtil::AlignsConstantBuffer(sizeof(PassConstant));
-		auto passCB = m_currFrameResource->m_passCBuffer->GetResource();
-		auto address = passCB->GetGPUVirtualAddress() + offset * passCBSize;
-		m_commandList->SetGraphicsRootConstantBufferView(0, address);
-		DrawRenderItems(m_commandList.Get(), m_renderItemLayers[static_cast<UINT>(BlendType::opaque)]);
-	});
-	m_TemporalAA->FirstDraw(m_commandList.Get(), GetDepthStencilView(), m_rootSignature.Get(), [&]()
-	{
-		m_commandList->RSSetViewports(1, &m_camera->GetViewPort());
-		m_commandList->RSSetScissorRects(1, &m_scissorRect);
-		DrawRenderItems(m_commandList.Get(), m_renderItemLayers[static_cast<UINT>(BlendType::opaque)]);
-		m_commandList->SetPipelineState(m_skybox->GetPSO());
-		DrawRenderItems(m_commandList.Get(), m_renderItemLayers[static_cast<UINT>(BlendType::skybox)]);
-	});
-
-	m_commandList->RSSetViewports(1, &m_camera->GetViewPort());
-	m_commandList->RSSetScissorRects(1, &m_scissorRect);
-
+	m_shadow->BeginCascades(m_commandList.Get());
+	const bool taaFirstPass = m_TemporalAA->BeginFirstPass(m_commandList.Get());
 	ChangeState<D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET>(m_commandList.Get(), GetCurrentBackBuffer());
 	gBuffer->RefreshGBuffer(m_commandList.Get());
+	// ̨תΪȾĿϱ֮ǰύRefreshGBufferڲύ
+	FlushBarriers(m_commandList.Get());
 	m_commandList->ClearRenderTargetView(GetCurrentBackBufferView(), Colors::LightSteelBlue, 0, nullptr);
-	m_commandList->ClearDepthStencilView(GetDepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL,0.0f, 0, 0, nullptr);
+	m_stateTracker->Submit(m_commandQueue.Get(), alloc.Get(), m_fixupCommandList.Get());
+	RecordScenePasses(taaFirstPass);
+
+	// бύ󼴿ãб¼ʣpass
+	ThrowIfFailed(m_commandList->Reset(alloc.Get(), gBuffer->m_pso.Get()));
+	m_stateTracker->Begin();
+	BindFrameState(m_commandList.Get());
+	m_shadow->EndCascades(m_commandList.Get());
+	if (taaFirstPass)
+	{
+		m_TemporalAA->EndFirstPass(m_commandList.Get());
+	}
 
-	// ָȾ
+	m_commandList->RSSetViewports(1, &m_camera->GetViewPort());
+	m_commandList->RSSetScissorRects(1, &m_scissorRect);
+	// ָGBuffer passʱȾĿ״̬
 	{
 		const auto& depthStencilView = GetDepthStencilView();
 		m_commandList->OMSetRenderTargets(3, &gBuffer->gBufferRTV[0], true, &depthStencilView);
 	}
-
-	// ͨεķʽCBVĳ໥
 	m_commandList->SetPipelineState(gBuffer->m_pso.Get());
-	auto passCB = m_currFrameResource->m_passCBuffer->GetResource();
-	auto address = passCB->GetGPUVirtualAddress();
-	m_commandList->SetGraphicsRootConstantBufferView(m_passOffset, address);
-	DrawRenderItems(m_commandList.Get(), m_renderItemLayers[static_cast<UINT>(BlendType::opaque)]);
+	m_commandList->SetGraphicsRootConstantBufferView(m_passOffset, m_currFrameResource->m_passCB.GetAddress());
 
-	for (int i = 0; i < 3; ++i)
-	{
-		ChangeState<D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_GENERIC_READ>(m_commandList.Get(), gBuffer->gBufferRes[i].Get());
-	}
 	// Post ProcessдGBufferPassConstant
 	// GPUдGBuffer
 	auto gBufferSRVHandler = CD3DX12_GPU_DESCRIPTOR_HANDLE(TextureMgr::instance().GetSRVDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
 	gBufferSRVHandler.Offset(gBuffer->albedoIdx, m_cbvUavDescriptorSize);
-	PostProcessMgr::instance().UpdateResources<PostProcessMgr::Compute>(m_commandList.Get(), m_currFrameResource->m_postProcessCBuffer->GetResource()->GetGPUVirtualAddress(), gBufferSRVHandler);
+	PostProcessMgr::instance().UpdateResources<PostProcessMgr::Compute>(m_commandList.Get(), m_currFrameResource->m_postProcessCB.GetAddress(), gBufferSRVHandler);
 	m_commandList->SetGraphicsRootDescriptorTable(3, gBufferSRVHandler);
-
-	// SSAO
-	m_ssao->Draw(m_commandList.Get(), [](UINT) {});
-	auto ssaoSRVHandler = CD3DX12_GPU_DESCRIPTOR_HANDLE(TextureMgr::instance().GetSRVDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
-	ssaoSRVHandler.Offset(m_ssao->GetSrvIdx("SSAO").value_or(0), m_cbvUavDescriptorSize);
-	m_commandList->SetGraphicsRootDescriptorTable(4, ssaoSRVHandler);
-
-	// GPUдshadow
-	auto shadowSRVHandler = CD3DX12_GPU_DESCRIPTOR_HANDLE(TextureMgr::instance().GetSRVDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
-	shadowSRVHandler.Offset(m_shadow->GetCascadedSrvOffset(), m_cbvUavDescriptorSize);
-	m_commandList->SetGraphicsRootDescriptorTable(5, shadowSRVHandler);
-	auto skyboxSRVHandler = CD3DX12_GPU_DESCRIPTOR_HANDLE(TextureMgr::instance().GetSRVDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
-	skyboxSRVHandler.Offset(m_skybox->GetStaticID(), m_cbvUavDescriptorSize);
-	m_commandList->SetGraphicsRootDescriptorTable(7, skyboxSRVHandler);
-
-	m_renderer->Draw(m_commandList.Get(), [&](UINT){
-		m_commandList->SetComputeRootConstantBufferView(0, m_currFrameResource->m_postProcessCBuffer->GetResource()->GetGPUVirtualAddress());
-		m_commandList->SetComputeRootDescriptorTable(1, gBufferSRVHandler);
-	});
-	m_commandList->SetPipelineState(m_skybox->GetPSO());
-	DrawRenderItems(m_commandList.Get(), m_renderItemLayers[static_cast<UINT>(BlendType::skybox)]);
-
-	/*
-	 * Post Process Part
-	 */
-	PostProcessMgr::instance().UpdateResources<PostProcessMgr::Graphics>(m_commandList.Get(), m_currFrameResource->m_postProcessCBuffer->GetResource()->GetGPUVirtualAddress(), gBufferSRVHandler);
-	for (int i = 0; i < 3; ++i)
-	{
-		ChangeState<D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET>(m_commandList.Get(), gBuffer->gBufferRes[i].Get());
-	}
-	// Դ;ָʾ״̬ת䣬ȾĿ״̬תΪ״̬
-	DrawPostProcess(m_commandList.Get());
-
-	// ļ¼
-	ThrowIfFailed(m_commandList->Close());
-	// ִеб
-	ID3D12CommandList* cmdLists[] = { m_commandList.Get() };
-	m_commandQueue->ExecuteCommandLists(_countof(cmdLists), cmdLists);
+	// ӳٹ֡ͼ֯GBuffer̨뷺ϲ״̬ת֡ͼ
+	BuildFrameGraph(m_commandList.Get(), gBufferSRVHandler);
+	m_frameGraph.Compile();
+	D3D12GraphBackend backend(m_commandList.Get(), m_frameGraph);
+	m_frameGraph.Execute(backend);
+
+	// ļ¼ִеб
+	m_stateTracker->Submit(m_commandQueue.Get(), alloc.Get(), m_fixupCommandList.Get());
 	// ǰ̨
 	ThrowIfFailed(m_swapChain->Present(0, 0));
 	m_currBackBuffer = (m_currBackBuffer + 1) % m_swapBufferCount;
 	// ͨ֡Դ滻FlushCommandQueue,ʵ޷ȫȴ״ķбַǿգʹGPUִ
 	m_currFrameResource->m_fence = ++m_currFence;
 	m_commandQueue->Signal(m_fence.Get(), m_currFence);
+	UploadRing::instance().FinishFrame(m_currFence);
 }
 
 void BoxApp::OnMouseDown(WPARAM btn_state, int x, int y)
@@ -258,6 +245,20 @@ void BoxApp::OnKeyboardInput(const GameTimer& timer)
 		m_camera->Strafe(-20.0f * delta);
 	if (GetAsyncKeyState('D') & 0x8000)
 		m_camera->Strafe(20.0f * delta);
+	// 1: ֿ޳  2: ִ
+	if (GetAsyncKeyState('1') & 0x8000)
+		m_renderer->SetLightCulling(Renderer::LightCulling::TileBased);
+	if (GetAsyncKeyState('2') & 0x8000)
+		m_renderer->SetLightCulling(Renderer::LightCulling::Clustered);
+	// 3: һԴ  4: ɾһԴʱֻһ
+	const bool addDown = (GetAsyncKeyState('3') & 0x8000) != 0;
+	if (addDown && !m_addLightsDown)
+		AddPointLights(pointLightBatch);
+	m_addLightsDown = addDown;
+	const bool removeDown = (GetAsyncKeyState('4') & 0x8000) != 0;
+	if (removeDown && !m_removeLightsDown)
+		RemovePointLights(pointLightBatch);
+	m_removeLightsDown = removeDown;
 
 	m_camera->SetJitter(m_TemporalAA->GetJitter());
 	m_camera->Update();
@@ -275,7 +276,11 @@ void BoxApp::CreateOffScreenRendering() {
 	m_dynamicCube->InitCamera(0.0f, 2.0f, 0.0f);
 	gBuffer = std::make_unique<Renderer::GBuffer>(m_d3dDevice.Get(), m_clientWidth, m_clientHeight, DXGI_FORMAT_R10G10B10A2_UNORM, DXGI_FORMAT_R32_FLOAT, DXGI_FORMAT_R16G16B16A16_SNORM);
 	m_renderer = std::make_unique<Renderer::TileBasedDefer>(m_d3dDevice.Get(), m_clientWidth, m_clientHeight, m_backBufferFormat);
-	m_shadow = std::make_unique<Effect::CascadedShadow>(m_d3dDevice.Get(), 1024U);
+	m_forwardPlus = std::make_unique<Renderer::ForwardPlus>(m_d3dDevice.Get(), m_clientWidth, m_clientHeight, DXGI_FORMAT_R32_TYPELESS);
+	// 5һ2048ӰͼԴԭ51024
+	m_shadow = std::make_unique<Effect::CascadedShadow>(m_d3dDevice.Get(), 2048U);
+	m_depthReduction = std::make_unique<Effect::DepthReduction>(m_d3dDevice.Get(), m_clientWidth, m_clientHeight);
+	m_hiZReadback = std::make_unique<Effect::HiZReadback>(m_d3dDevice.Get(), m_clientWidth, m_clientHeight);
 	m_blur = std::make_unique<Effect::GaussianBlur>(m_d3dDevice.Get(), m_clientWidth, m_clientHeight, DXGI_FORMAT_R8G8B8A8_UNORM, 2U);
 	m_toneMap = std::make_unique<Effect::ToneMap>(m_d3dDevice.Get(), m_clientWidth, m_clientHeight, m_backBufferFormat);
 	m_ssao = std::make_unique<Effect::SSAO>(m_d3dDevice.Get(), m_clientWidth, m_clientHeight, DXGI_FORMAT_R8_UNORM);
@@ -296,8 +301,7 @@ void BoxApp::UpdateLUT(const GameTimer& timer)
 		constant.lights[2].direction = m_pixelLights[2]->GetData().direction;
 		constant.lights[2].strength = m_pixelLights[2]->GetData().strength;
 
-		auto currPass = m_currFrameResource->m_passCBuffer.get();
-		currPass->Copy(i, constant);
+		m_currFrameResource->m_passCB.Copy(i, constant);
 	});
 }
 
@@ -359,12 +363,11 @@ void BoxApp::DrawLUT()
 
 	// LUT Shadow
 	m_shadow->Draw(m_commandList.Get(), [&](UINT offset) {
-		constexpr UINT passCBSize = D3DUtil::AlignsConstantBuffer(sizeof(PassConstant));
-		auto passCB = m_currFrameResource->m_passCBuffer->GetResource();
-		auto address = passCB->GetGPUVirtualAddress() + offset * passCBSize;
-		m_commandList->SetGraphicsRootConstantBufferView(0, address);
+		m_commandList->SetGraphicsRootConstantBufferView(0, m_currFrameResource->m_passCB.GetAddress(offset));
 		DrawRenderItems(m_commandList.Get(), m_renderItemLayers[static_cast<UINT>(BlendType::opaque)]);
 	});
+	// Ԥֱӻ壬̬û
+	m_shadow->InvalidateCache();
 
 	// GPUдshadow
 	auto shadowSRVHandler = CD3DX12_GPU_DESCRIPTOR_HANDLE(TextureMgr::instance().GetSRVDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
@@ -372,10 +375,7 @@ void BoxApp::DrawLUT()
 	m_commandList->SetGraphicsRootDescriptorTable(5, shadowSRVHandler);
 	// LUT drawing
 	m_dynamicCube->Draw(m_commandList.Get(), [&](UINT offset) {
-		constexpr auto passCBSize = D3DUtil::AlignsConstantBuffer(sizeof(PassConstant));
-		auto passCB = m_currFrameResource->m_passCBuffer->GetResource();
-		auto address = passCB->GetGPUVirtualAddress() + (offset + 1) * passCBSize;
-		m_commandList->SetGraphicsRootConstantBufferView(0, address);
+		m_commandList->SetGraphicsRootConstantBufferView(0, m_currFrameResource->m_passCB.GetAddress(offset + 1));
 		m_commandList->SetPipelineState(LUTParams.Get());
 		DrawRenderItems(m_commandList.Get(), m_renderItemLayers[static_cast<UINT>(BlendType::opaque)]);
 		m_commandList->SetPipelineState(m_skybox->GetPSO());
@@ -399,6 +399,7 @@ void BoxApp::DrawLUT()
 	ThrowIfFailed(m_swapChain->Present(0, 0));
 	m_currBackBuffer = (m_currBackBuffer + 1) % m_swapBufferCount;
 	FlushCommandQueue();
+	UploadRing::instance().FinishFrame(m_currFence);
 }
 
 void BoxApp::CreateLights()
@@ -416,8 +417,17 @@ void BoxApp::CreateLights()
 	dirLight2.strength = { 0.8f, 0.8f, 0.8f };
 	m_pixelLights.emplace_back(std::make_shared<Light<Pixel>>(std::move(dirLight2)));
 	m_shadow->SetNecessaryParameters(0.001f, 0.2f, m_camera, m_pixelLights[0].get(), 2);
+	m_renderer->SetCamera(m_camera);
+
+	// ԴֻӰʼʱԼɾ
+	constexpr UINT scenePointLights = 2048;
+	m_pointLights.Reserve(scenePointLights);
+	AddPointLights(scenePointLights);
+	m_renderer->UpdatePointLights(m_currFrameResourceIndex, m_pointLights.GetData(), m_pointLights.GetSize());
+}
 
-	std::mt19937 randSeed(1337);
+void BoxApp::AddPointLights(UINT count)
+{
 	constexpr float maxRadius = 150.0f;
 	constexpr float attenuation = 0.8f;
 	std::uniform_real<float> radiusNormDist(0.0f, 1.0f);
@@ -428,26 +438,38 @@ void BoxApp::CreateLights()
 	std::uniform_real<float> hueDist(0.0f, 1.0f);
 	std::uniform_real<float> intensityDist(0.2f, 0.8f);
 	std::uniform_real<float> attenuationDist(2.0f, 20.0f);
-	for (UINT i = 0; i < pointLightNum; ++i)
+	for (UINT i = 0; i < count; ++i)
 	{
 		LightMoveParams data;
-		data.radius = std::sqrt(radiusNormDist(randSeed)) * maxRadius;
-		data.angle = angleDist(randSeed);
-		data.height = heightDist(randSeed);
-		data.moveSpeed = (moveDirection(randSeed) * 2 - 1) * moveSpeedDist(randSeed) / data.radius;
-		m_pointLightPos.emplace_back(std::make_unique<LightMoveParams>(data));
+		data.radius = std::sqrt(radiusNormDist(m_lightRandom)) * maxRadius;
+		data.angle = angleDist(m_lightRandom);
+		data.height = heightDist(m_lightRandom);
+		data.moveSpeed = (moveDirection(m_lightRandom) * 2 - 1) * moveSpeedDist(m_lightRandom) / data.radius;
 		XMFLOAT3 worldPos = { data.radius * std::cos(data.angle), data.height, data.radius * std::sin(data.angle) };
 		XMVECTOR viewPos = XMVector3TransformCoord(XMLoadFloat3(&worldPos), m_camera->GetCurrViewXM());
 
 		LightInCompute params;
 		XMStoreFloat3(&params.posV, viewPos);
-		params.fallOffEnd = attenuationDist(randSeed);
+		params.fallOffEnd = attenuationDist(m_lightRandom);
 		params.fallOffStart = attenuation * params.fallOffEnd;
-		params.strength = MathHelper::MathHelper::HueToRGB(hueDist(randSeed));
-		XMStoreFloat3(&params.strength, XMLoadFloat3(&params.strength) * intensityDist(randSeed));
-		m_computeLights.emplace_back(std::make_shared<Light<Compute>>(std::move(params)));
+		params.strength = MathHelper::MathHelper::HueToRGB(hueDist(m_lightRandom));
+		XMStoreFloat3(&params.strength, XMLoadFloat3(&params.strength) * intensityDist(m_lightRandom));
+		m_pointLightHandles.push_back(m_pointLights.Add(data, params));
+	}
+}
+
+void BoxApp::RemovePointLights(UINT count)
+{
+	// ѡɾԴľֲ䣬֡UpdateLightPosϴк
+	count = std::min(count, static_cast<UINT>(m_pointLightHandles.size()));
+	for (UINT i = 0; i < count; ++i)
+	{
+		std::uniform_int<size_t> pick(0, m_pointLightHandles.size() - 1);
+		const size_t slot = pick(m_lightRandom);
+		m_pointLights.Remove(m_pointLightHandles[slot]);
+		m_pointLightHandles[slot] = m_pointLightHandles.back();
+		m_pointLightHandles.pop_back();
 	}
-	m_renderer->UpdatePointLights(m_computeLights);
 }
 
 void BoxApp::CreateDescriptorHeaps()
@@ -463,7 +485,11 @@ void BoxApp::CreateDescriptorHeaps()
 	m_shadow->CreateDescriptors(cpuSrvStart, gpuSrvStart, cpuDsvStart, m_cbvUavDescriptorSize, m_dsvDescriptorSize);
 	m_blur->CreateDescriptors(cpuSrvStart, gpuSrvStart, m_cbvUavDescriptorSize);
 	m_toneMap->CreateDescriptors(cpuSrvStart, gpuSrvStart, m_cbvUavDescriptorSize);
+	m_depthReduction->CreateDescriptors(cpuSrvStart, gpuSrvStart, m_cbvUavDescriptorSize);
+	m_hiZReadback->CreateDescriptors(cpuSrvStart, gpuSrvStart, m_cbvUavDescriptorSize);
 	m_renderer->CreateDescriptors(cpuSrvStart, cpuRtvStart, GetDepthStencilView(), gpuSrvStart, m_cbvUavDescriptorSize, m_rtvDescriptorSize, m_dsvDescriptorSize);
+	m_forwardPlus->CreateDescriptors(cpuSrvStart, cpuRtvStart, cpuDsvStart, gpuSrvStart, m_cbvUavDescriptorSize, m_rtvDescriptorSize, m_dsvDescriptorSize);
+	m_forwardPlus->SetOpaqueRenderer(m_renderer.get(), GetDepthStencilView());
 	m_ssao->CreateRandomTexture(m_commandList.Get());
 	m_ssao->CreateDescriptors(cpuSrvStart, gpuSrvStart, cpuRtvStart, m_cbvUavDescriptorSize, m_rtvDescriptorSize);
 	m_TemporalAA->CreateDescriptors(cpuSrvStart, gpuSrvStart, cpuRtvStart, m_cbvUavDescriptorSize, m_rtvDescriptorSize);
@@ -489,8 +515,8 @@ void BoxApp::CreateRootSignature()
 	CD3DX12_DESCRIPTOR_RANGE gBufferSRV;
 	gBufferSRV.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 3, 4, 1);
 	CD3DX12_DESCRIPTOR_RANGE shadowSRV;
-	shadowSRV.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 5, 4, 2);
-	CD3DX12_ROOT_PARAMETER parameters[12]{};
+	shadowSRV.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 2, 4, 2); // Ӱͼ뾲̬Ӱ
+	CD3DX12_ROOT_PARAMETER parameters[16]{};
 	parameters[0].InitAsConstantBufferView(0); // Ⱦ̵CBV
 	parameters[1].InitAsShaderResourceView(1, 0); // CBV
 	parameters[2].InitAsShaderResourceView(0, 1); // ʵĽṹ
@@ -503,11 +529,17 @@ void BoxApp::CreateRootSignature()
 	parameters[9].InitAsConstantBufferView(1); // SSAO ConstantBuffer
 	parameters[10].InitAsConstantBufferView(2); // Bilateral Blur 
 	parameters[11].InitAsConstantBufferView(3);
+	// ForwardPlusĵԴֿԴλֿ鳣
+	parameters[Renderer::ForwardPlus::lightsRootParam].InitAsShaderResourceView(0, 3, D3D12_SHADER_VISIBILITY_PIXEL);
+	parameters[Renderer::ForwardPlus::tileBitsRootParam].InitAsShaderResourceView(1, 3, D3D12_SHADER_VISIBILITY_PIXEL);
+	parameters[Renderer::ForwardPlus::tileConstantRootParam].InitAsConstants(4, 4, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+	// ̬Ӱ뻷ƫ
+	parameters[Effect::CascadedShadow::cacheConstantRootParam].InitAsConstants(4, 5, 0, D3D12_SHADER_VISIBILITY_PIXEL);
 
 	// ̬
 	auto staticSampler = CreateStaticSampler2D();
 	// ǩĲ
-	CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc(12U, parameters, staticSampler.size(), staticSampler.data(), D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+	CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc(16U, parameters, staticSampler.size(), staticSampler.data(), D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 	// ֻһɵĸǩ
 	ComPtr<ID3DBlob> serialRootSig{ nullptr }; // ID3DBlobһͨڴ飬Էһvoid*ݻ򷵻ػĴС
 	ComPtr<ID3DBlob> error{ nullptr };
@@ -520,6 +552,7 @@ void BoxApp::CreateRootSignature()
 		serialRootSig->GetBufferSize(), IID_PPV_ARGS(&m_rootSignature));
 
 	m_renderer->InitRootSignature();
+	m_forwardPlus->InitRootSignature();
 }
 
 void BoxApp::CreateShadersAndInput() {
@@ -531,13 +564,22 @@ void BoxApp::CreateShadersAndInput() {
 		{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
 		{"TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
 		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 36, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0}})));
-	m_shadow->InitShader(L"Shaders\\Shadow");
+	m_shadow->InitShader(L"Shaders\\Shadow", L"Shaders\\ShadowCache");
 	m_dynamicCube->InitShader(L"Shaders\\Skybox");
 	m_blur->InitShader(L"Shaders\\Blur_Horizontal", L"Shaders\\Blur_Vertical");
 	m_toneMap->InitShader(L"Shaders\\ToneMap_ACES");
+	m_depthReduction->InitShader(L"Shaders\\DepthReduction_Reduce");
+	m_hiZReadback->InitShader(L"Shaders\\HiZReadback_Downsample");
 	m_renderer->InitShaders(std::forward_as_tuple(L"Shaders\\Box", default_shader, initializer_list<D3D12_INPUT_ELEMENT_DESC>({ {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
 		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0} })), 
-		std::forward_as_tuple(L"Shaders\\TileBased_Defer", compute_shader, initializer_list<D3D12_INPUT_ELEMENT_DESC>()));
+		std::forward_as_tuple(L"Shaders\\TileBased_Defer", compute_shader, initializer_list<D3D12_INPUT_ELEMENT_DESC>()),
+		std::forward_as_tuple(L"Shaders\\TileBased_DeferClustered", compute_shader, initializer_list<D3D12_INPUT_ELEMENT_DESC>()));
+	m_forwardPlus->InitShaders(std::forward_as_tuple(L"Shaders\\ForwardPlus", default_shader, initializer_list<D3D12_INPUT_ELEMENT_DESC>({
+		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 36, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 } })),
+		std::forward_as_tuple(L"Shaders\\TileBased_CullLights", compute_shader, initializer_list<D3D12_INPUT_ELEMENT_DESC>()));
 	m_ssao->InitShader();
 	m_TemporalAA->InitShader(L"Shaders\\TemporalAA_Aliasing", L"Shaders\\MotionVector");
 }
@@ -547,6 +589,9 @@ void BoxApp::CreateGeometry()
 	auto totalGeo = std::make_unique<Mesh>();
 	BaseMeshData sphere = BaseGeometry::CreateSphere(0.5f, 20, 20);
 	BaseMeshData quad = BaseGeometry::CreateQuad(0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
+	// ͸壺˿ױλԭľ
+	BaseMeshData fence = BaseGeometry::CreateCube(1.0f, 1.0f, 1.0f, 0);
+	BaseMeshData treeSprite = BaseGeometry::CreateQuad(-0.5f, 1.0f, 1.0f, 1.0f, 0.0f);
 
 	///*
 	// * еļϲһѴĶ㡢
@@ -556,6 +601,8 @@ void BoxApp::CreateGeometry()
 	// ĶsubmeshGeometry˶/ڲͬ
 	Submesh sphereSubmesh;
 	Submesh quadSubmesh;
+	Submesh fenceSubmesh;
+	Submesh treeSpriteSubmesh;
 	sphereSubmesh.eboCount = static_cast<UINT>(sphere.EBOs.size());
 	sphereSubmesh.eboStart = eboOffset;
 	sphereSubmesh.vboStart = vboOffset;
@@ -568,6 +615,18 @@ void BoxApp::CreateGeometry()
 	vboOffset += quad.VBOs.size();
 	eboOffset += quad.EBOs.size();
 
+	fenceSubmesh.eboCount = static_cast<UINT>(fence.EBOs.size());
+	fenceSubmesh.eboStart = eboOffset;
+	fenceSubmesh.vboStart = vboOffset;
+	vboOffset += fence.VBOs.size();
+	eboOffset += fence.EBOs.size();
+
+	treeSpriteSubmesh.eboCount = static_cast<UINT>(treeSprite.EBOs.size());
+	treeSpriteSubmesh.eboStart = eboOffset;
+	treeSpriteSubmesh.vboStart = vboOffset;
+	vboOffset += treeSprite.VBOs.size();
+	eboOffset += treeSprite.EBOs.size();
+
 	vector<Vertex_GPU> vbo;
 	vector<uint16_t> ebo;
 	// ȡеĶԪزʽһ㻺
@@ -579,6 +638,14 @@ void BoxApp::CreateGeometry()
 		vbo.emplace_back(Vertex_GPU{ quad.VBOs[i].pos, quad.VBOs[i].normal, quad.VBOs[i].tangent, quad.VBOs[i].tex });
 	ebo.insert(ebo.end(), std::begin(quad.GetEBO_16()), std::end(quad.GetEBO_16()));
 
+	for (auto i = 0; i < fence.VBOs.size(); ++i)
+		vbo.emplace_back(Vertex_GPU{ fence.VBOs[i].pos, fence.VBOs[i].normal, fence.VBOs[i].tangent, fence.VBOs[i].tex });
+	ebo.insert(ebo.end(), std::begin(fence.GetEBO_16()), std::end(fence.GetEBO_16()));
+
+	for (auto i = 0; i < treeSprite.VBOs.size(); ++i)
+		vbo.emplace_back(Vertex_GPU{ treeSprite.VBOs[i].pos, treeSprite.VBOs[i].normal, treeSprite.VBOs[i].tangent, treeSprite.VBOs[i].tex });
+	ebo.insert(ebo.end(), std::begin(treeSprite.GetEBO_16()), std::end(treeSprite.GetEBO_16()));
+
 	auto objModel = Models::ObjLoader::instance().GetObj("Sponza/pbr/sponza.obj").value();
 	const UINT len = objModel->meshData.size();
 	for (UINT i = 0; i < len; ++i)
@@ -618,6 +685,8 @@ void BoxApp::CreateGeometry()
 
 	totalGeo->drawArgs["Sphere"] = std::move(sphereSubmesh);
 	totalGeo->drawArgs["Debug"] = std::move(quadSubmesh);
+	totalGeo->drawArgs["WireFence"] = std::move(fenceSubmesh);
+	totalGeo->drawArgs["TreeSprite"] = std::move(treeSpriteSubmesh);
 	m_meshGeos[totalGeo->name] = std::move(totalGeo);
 }
 
@@ -647,15 +716,19 @@ void BoxApp::CreatePSO()
 	m_blur->InitPSO(templateDesc);
 	m_TemporalAA->InitPSO(templateDesc);
 	m_toneMap->InitPSO(templateDesc);
+	m_depthReduction->InitPSO(templateDesc);
+	m_hiZReadback->InitPSO(templateDesc);
 	m_renderer->InitPSO(templateDesc);
+	m_forwardPlus->InitPSO(templateDesc);
 	m_ssao->InitPSO(templateDesc);
 }
 
 void BoxApp::CreateFrameResources()
 {
+	UploadRing::instance().Init(m_d3dDevice.Get(), uploadRingSize);
 	for (auto i = 0; i < frameResourcesCount; ++i)
 	{
-		m_frameCBuffer.emplace_back(std::make_unique<FrameResource>(m_d3dDevice.Get(), PassConstant::GetPassCount(), RenderItem::GetInstanceCount(), static_cast<UINT>(Material::GetMatSize())));
+		m_frameCBuffer.emplace_back(std::make_unique<FrameResource>(m_d3dDevice.Get(), RenderItem::GetInstanceCount(), static_cast<UINT>(Material::GetMatSize()), recordPassCount * m_recorder->GetMaxChunksPerPass()));
 	}
 }
 
@@ -663,7 +736,7 @@ void BoxApp::CreateRenderItems()
 {
 	auto skybox = std::make_unique<RenderItem>();
 	skybox->EmplaceBack();
-	skybox->transformPack[0]->m_scale = std::move(XMFLOAT3(5000.0f, 5000.0f, 5000.0f));
+	skybox->SetScale(0, XMFLOAT3(5000.0f, 5000.0f, 5000.0f));
 	skybox->m_topologyType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 	skybox->m_matIndex = m_material->m_data["Skybox"]->materialCBIndex;
 	skybox->m_type = m_material->m_data["Skybox"]->type;
@@ -691,30 +764,76 @@ void BoxApp::CreateRenderItems()
 		auto sponza = std::make_unique<RenderItem>();
 		string geoName("sponza" + to_string(i));
 		sponza->EmplaceBack();
-		sponza->transformPack[0]->m_scale = std::move(XMFLOAT3(0.1f, 0.1f, 0.1f));
+		sponza->SetScale(0, XMFLOAT3(0.1f, 0.1f, 0.1f));
+		sponza->SetLocalBounds(sponzaModel->submesh[i].bounds);
 		sponza->m_matIndex = sponzaModel->objMat->m_data[sponzaModel->submesh[i].materialName]->materialCBIndex;
 		sponza->m_topologyType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 		sponza->m_type = BlendType::opaque;
+		sponza->m_isStatic = true;
 		sponza->m_mesh = m_meshGeos["Total"].get();
 		sponza->eboStart = m_meshGeos["Total"]->drawArgs[geoName].eboStart;
 		sponza->eboCount = m_meshGeos["Total"]->drawArgs[geoName].eboCount;
 		sponza->vboStart = m_meshGeos["Total"]->drawArgs[geoName].vboStart;
+		// ڵʹȾı任͸ԵĲοմ͸Ϊڵ
+		const string& materialName = sponzaModel->submesh[i].materialName;
+		if (std::find(std::begin(alphaTestedMaterials), std::end(alphaTestedMaterials), materialName) == std::end(alphaTestedMaterials))
+		{
+			const Transform form = sponza->GetTransform(0);
+			const XMMATRIX world = Transform::GetModelMatrixXM(form.m_scale, form.m_rotation, form.m_position);
+			const auto& meshData = sponzaModel->meshData[i];
+			m_occluders.Append(&meshData.VBOs[0].pos, sizeof(Vertex_CPU), meshData.EBOs.data(), static_cast<UINT>(meshData.EBOs.size()), world, occluderMinArea);
+		}
 		m_renderItems.emplace_back(std::move(sponza));
 	}
+	m_occluders.Simplify(occluderBudget);
+
+	// ͥڵ͸壬ForwardPlus
+	auto fence = std::make_unique<RenderItem>();
+	for (float x : { -60.0f, 0.0f, 60.0f })
+	{
+		fence->EmplaceBack(XMFLOAT3(x, 5.0f, 0.0f), XMFLOAT3(10.0f, 10.0f, 10.0f));
+	}
+	CreateTransparentItem(std::move(fence), "WireFence", BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.5f, 0.5f, 0.5f)));
+	// ÿһȾʵΪഹֱľ飬
+	for (const XMFLOAT3& pos : { XMFLOAT3(-100.0f, 0.0f, -30.0f), XMFLOAT3(-100.0f, 0.0f, 30.0f), XMFLOAT3(100.0f, 0.0f, -30.0f), XMFLOAT3(100.0f, 0.0f, 30.0f) })
+	{
+		auto tree = std::make_unique<RenderItem>();
+		tree->EmplaceBack(XMFLOAT3(pos), XMFLOAT3(20.0f, 20.0f, 20.0f), XMFLOAT3(0.0f, 0.0f, 0.0f));
+		tree->EmplaceBack(XMFLOAT3(pos), XMFLOAT3(20.0f, 20.0f, 20.0f), XMFLOAT3(0.0f, XM_PIDIV2, 0.0f));
+		CreateTransparentItem(std::move(tree), "TreeSprite", BoundingBox(XMFLOAT3(0.0f, 0.5f, 0.0f), XMFLOAT3(0.5f, 0.5f, 0.5f)));
+	}
 	Models::Scene::sceneBox.Transform(Models::Scene::sceneBox, XMMatrixScalingFromVector(XMVectorSet(0.07f, 0.07f, 0.07f, 1.0f)));
 
-	// Ⱦ͸
+	// Ⱦͷֲ
 	for (auto& item : m_renderItems)
 	{
 		m_renderItemLayers[static_cast<UINT>(item->m_type)].emplace_back(item.get());
 	}
 }
 
+void BoxApp::CreateTransparentItem(std::unique_ptr<RenderItem> item, const string& name, const BoundingBox& localBounds)
+{
+	const auto& material = m_material->m_data[name];
+	item->SetLocalBounds(localBounds);
+	item->m_matIndex = material->materialCBIndex;
+	item->m_topologyType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+	item->m_type = material->type;
+	item->m_isStatic = true;
+	item->m_mesh = m_meshGeos["Total"].get();
+	item->eboCount = item->m_mesh->drawArgs[name].eboCount;
+	item->eboStart = item->m_mesh->drawArgs[name].eboStart;
+	item->vboStart = item->m_mesh->drawArgs[name].vboStart;
+	m_renderItems.emplace_back(std::move(item));
+}
+
 void BoxApp::CreateTextures()
 {
 	TextureMgr::instance().Init(m_d3dDevice.Get(), m_commandQueue.Get());
+	TextureMgr::instance().SetPreviewMips(texturePreviewMips);
 
 	m_skybox->InitStaticTex("Skybox", TexturePath + L"Skybox/grasscube1024.dds");
+	TextureMgr::instance().InsertDDSTexture("WireFence", TexturePath + L"Common/WireFence.dds");
+	TextureMgr::instance().InsertDDSTexture("TreeSprite", TexturePath + L"Common/tree01S.dds");
 	[](){
 		static char sponza[] = "Sponza/pbr/sponza.obj";
 		Models::ObjLoader::instance().CreateObjFromFile<sponza>();
@@ -722,12 +841,15 @@ void BoxApp::CreateTextures()
 
 	m_dynamicCube->InitTexture("CubeMap");
 	m_renderer->InitTexture();
+	m_forwardPlus->InitTexture();
 	gBuffer->albedoIdx = TextureMgr::instance().RegisterRenderToTexture("gAlbedo");
 	gBuffer->depthIdx = TextureMgr::instance().RegisterRenderToTexture("gPos");
 	gBuffer->normalIdx = TextureMgr::instance().RegisterRenderToTexture("gNormal");
 	m_shadow->InitTexture("ShadowMap");
 	m_blur->InitTexture();
 	m_toneMap->InitTexture();
+	m_depthReduction->InitTexture();
+	m_hiZReadback->InitTexture();
 	m_ssao->InitTexture();
 	m_TemporalAA->InitTexture("TAATex", "prevTex", "TAAMotionVector");
 }
@@ -738,6 +860,15 @@ void BoxApp::CreateMaterials()
 	//m_material->CreateMaterial("Cube", "Brick", Material::GetMatIndex(), 0.1f, XMFLOAT3(0.0f, 0.0f, 0.0f), 0.1f, BlendType::opaque);
 	//m_material->CreateMaterial("Grid", "Tile", Material::GetMatIndex(), 0.5f, XMFLOAT3(0.0f, 0.0f, 0.0f), 0.2f, BlendType::opaque);
 	m_material->CreateMaterial("Skybox", m_skybox->TexName() , 3, 1.0f, XMFLOAT3(0.1f, 0.1f, 0.1f), 0.0f, BlendType::skybox);
+	// ͸ֻ0ûжӦͼģͲһ
+	for (const char* name : { "WireFence", "TreeSprite" })
+	{
+		auto matData = std::make_unique<MaterialData>(name, Material::GetMatIndex(), 0.8f, XMFLOAT3(0.0f, 0.0f, 0.0f), 0.0f, BlendType::transparent);
+		matData->diffuseIndex = TextureMgr::instance().GetRegisterType(name).value();
+		matData->normalIndex = 0;
+		matData->metalnessIndex = 0;
+		m_material->CreateMaterial(std::move(matData));
+	}
 }
 
 auto BoxApp::CreateStaticSampler2D() -> std::array<const CD3DX12_STATIC_SAMPLER_DESC, 8>
@@ -760,14 +891,20 @@ auto BoxApp::CreateStaticSampler2D() -> std::array<const CD3DX12_STATIC_SAMPLER_
 
 void BoxApp::UpdateObjectInstance(const GameTimer& timer)
 {
+	// ȴмÿȾʵƫƣȾдʵ以ص֮Բи
+	std::vector<UINT> offsets(m_renderItems.size());
 	UINT offset = 0;
+	for (size_t i = 0; i < m_renderItems.size(); ++i)
+	{
+		offsets[i] = offset;
+		offset += m_renderItems[i]->GetInstanceSize();
+	}
 	// ֻҪһεӦ洢ڳУֻеʶ仯ʱŻ³
 	auto currInstanceData = m_currFrameResource->m_uploadCBuffer.get();
-	for (const auto& item : m_renderItems)
+	Thread::ThreadPool::instance().ParallelFor(0, static_cast<UINT>(m_renderItems.size()), 32, [&](UINT i)
 	{
-		item->Update(timer, currInstanceData, offset);
-		offset += item->GetInstanceSize();
-	}
+		m_renderItems[i]->Update(timer, currInstanceData, offsets[i]);
+	});
 }
 
 void BoxApp::UpdatePassConstant(const GameTimer& timer)
@@ -793,8 +930,7 @@ void BoxApp::UpdatePassConstant(const GameTimer& timer)
 	m_currPassCB.lights[2].direction = m_pixelLights[2]->GetData().direction;
 	m_currPassCB.lights[2].strength = m_pixelLights[2]->GetData().strength;
 
-	auto passCB = m_currFrameResource->m_passCBuffer.get();
-	passCB->Copy(m_passOffset, m_currPassCB);
+	m_currFrameResource->m_passCB.Copy(m_passOffset, m_currPassCB);
 }
 
 void BoxApp::UpdateMaterialConstant(const GameTimer& timer)
@@ -807,13 +943,175 @@ void BoxApp::UpdateMaterialConstant(const GameTimer& timer)
 void BoxApp::UpdateOffScreen(const GameTimer& timer)
 {
 	m_shadow->Update(timer, [&](UINT offset, auto& constant) {
-		auto passCB = m_currFrameResource->m_passCBuffer.get();
-		passCB->Copy(offset, constant);
+		m_currFrameResource->m_passCB.Copy(offset, constant);
 	});
 	m_blur->Update(timer, [](UINT, auto&){});
 	m_TemporalAA->Update(timer, [](UINT, auto&){});
 }
 
+void BoxApp::UpdateSceneBVH()
+{
+	// Ⱦʱֻrefit仯ʱ¹
+	const auto& opaqueItems = m_renderItemLayers[static_cast<UINT>(BlendType::opaque)];
+	std::vector<BoundingBox> bounds;
+	bounds.reserve(opaqueItems.size());
+	for (const auto item : opaqueItems)
+	{
+		if (item->HasBounds())
+			bounds.emplace_back(item->GetWorldBounds());
+	}
+	auto& bvh = Models::Scene::sceneBVH;
+	if (bvh.Empty() || bvh.GetPrimitiveCount() != bounds.size())
+	{
+		bvh.Build(bounds);
+	}
+	else
+	{
+		bvh.Refit(bounds);
+	}
+}
+
+void BoxApp::UpdateCulling()
+{
+	// ȾΧ뼶ͶӰUpdateObjectInstanceUpdateOffScreenִ֮
+	// payloadΪȾڲ͸е±
+	const auto& opaqueItems = m_renderItemLayers[static_cast<UINT>(BlendType::opaque)];
+	m_culler.Reset();
+	for (UINT idx = 0; idx < opaqueItems.size(); ++idx)
+	{
+		if (opaqueItems[idx]->HasBounds())
+			m_culler.AddItem(opaqueItems[idx]->GetWorldBounds(), idx);
+		else
+			m_culler.AddAlwaysVisible(idx);
+	}
+	XMFLOAT4 planes[FrustumCuller::planeCount];
+	for (UINT idx = 0; idx < Effect::CascadedShadow::cascadeLevels; ++idx)
+	{
+		FrustumCuller::ExtractPlanes(m_shadow->GetCascadeVPXM(idx), planes);
+		m_culler.AddPass(planes);
+	}
+	m_camera->GetWorldFrustumPlanes(planes);
+	m_culler.AddPass(planes);
+	m_culler.Cull();
+	for (UINT idx = 0; idx < Effect::CascadedShadow::cascadeLevels; ++idx)
+	{
+		m_staticCasters[idx].clear();
+		m_dynamicCasters[idx].clear();
+		for (const auto itemIdx : m_culler.GetVisible(idx))
+		{
+			const auto item = opaqueItems[itemIdx];
+			(item->m_isStatic ? m_staticCasters[idx] : m_dynamicCasters[idx]).push_back(item);
+		}
+	}
+	// ڵ޳ʹ޶ľ󣬶Сڵһ
+	const XMMATRIX viewProj = m_camera->GetNonjitteredCurrVPXM();
+	m_occlusionCuller.Clear(m_camera->m_nearPlane);
+	m_occlusionCuller.RenderOccluder(m_occluders, viewProj);
+	// ֡ԴһдframeResourcesCount֡дʱľͶӰ֡
+	const UINT frameIdx = static_cast<UINT>(m_currFrameResourceIndex);
+	XMFLOAT4X4 readbackViewProj;
+	const float* readbackDepth = m_hiZReadback->ReadBack(frameIdx, readbackViewProj);
+	if (readbackDepth)
+	{
+		constexpr UINT hiZWidth = Effect::HiZReadback::readbackWidth;
+		constexpr UINT hiZHeight = Effect::HiZReadback::readbackHeight;
+#if defined(DEBUG) || defined(_DEBUG)
+		HiZCuller truth;
+		truth.Build(readbackDepth, hiZWidth, hiZHeight);
+		for (const auto& [box, culled] : m_hiZDecisions[frameIdx])
+		{
+			truth.Evaluate(box, culled, XMLoadFloat4x4(&readbackViewProj), m_hiZErrors);
+		}
+		if (m_hiZErrors.tested >= hiZReportInterval)
+		{
+			const auto percent = [this](UINT count) { return std::to_string(100.0 * count / m_hiZErrors.tested); };
+			OutputDebugStringA(("HiZ occlusion: false positive " + percent(m_hiZErrors.falsePositive) + "%, false negative " + percent(m_hiZErrors.falseNegative) + "%\n").c_str());
+			m_hiZErrors = HiZErrorStats{};
+		}
+#endif
+		m_hiZDepth.resize(static_cast<size_t>(hiZWidth) * hiZHeight);
+		HiZCuller::Reproject(readbackDepth, hiZWidth, hiZHeight, XMLoadFloat4x4(&readbackViewProj), viewProj, m_hiZDepth.data());
+		m_hiZCuller.Build(m_hiZDepth.data(), hiZWidth, hiZHeight);
+	}
+	XMFLOAT4X4 currViewProj;
+	XMStoreFloat4x4(&currViewProj, viewProj);
+	m_hiZReadback->SetViewProj(currViewProj);
+#if defined(DEBUG) || defined(_DEBUG)
+	m_hiZDecisions[frameIdx].clear();
+#endif
+	// һʵܿɼʱȾ
+	const auto HiZVisible = [this, &viewProj, frameIdx](const RenderItem* item)
+	{
+		bool visible = false;
+		for (const auto& box : item->GetInstanceBounds())
+		{
+			const bool instanceVisible = m_hiZCuller.IsVisible(box, viewProj);
+#if defined(DEBUG) || defined(_DEBUG)
+			m_hiZDecisions[frameIdx].emplace_back(box, !instanceVisible);
+#endif
+			visible = visible || instanceVisible;
+		}
+		return visible;
+	};
+	m_hiZCuller.ResetStats();
+	m_cameraVisible.clear();
+	for (const auto itemIdx : m_culler.GetVisible(cameraCullPass))
+	{
+		const auto item = opaqueItems[itemIdx];
+		if (!item->HasBounds() || (m_occlusionCuller.IsVisible(item->GetWorldBounds(), viewProj) && HiZVisible(item)))
+			m_cameraVisible.push_back(item);
+	}
+#if defined(DEBUG) || defined(_DEBUG)
+	ReportCulling();
+#endif
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+void BoxApp::ReportCulling()
+{
+	// ۼƸpass׶޳Ľÿ֡ƽֵpassڵ޳
+	for (UINT idx = 0; idx < m_culler.GetPassCount(); ++idx)
+	{
+		const auto& stats = m_culler.GetStats(idx);
+		m_cullTotals[idx].visible += stats.visible;
+		m_cullTotals[idx].culled += stats.culled;
+	}
+	m_occludedTotal += m_culler.GetStats(cameraCullPass).visible - static_cast<UINT>(m_cameraVisible.size());
+	if (++m_cullFrames < cullReportInterval)
+		return;
+	const auto average = [this](UINT count) { return std::to_string(count / m_cullFrames); };
+	std::string text = "Frustum culling per frame:";
+	for (UINT idx = 0; idx < m_culler.GetPassCount(); ++idx)
+	{
+		text += (idx == cameraCullPass ? " camera " : " cascade" + std::to_string(idx) + " ") +
+			average(m_cullTotals[idx].visible) + "/" + average(m_cullTotals[idx].visible + m_cullTotals[idx].culled);
+	}
+	text += ", occluded " + average(m_occludedTotal) + "\n";
+	OutputDebugStringA(text.c_str());
+	std::fill(std::begin(m_cullTotals), std::end(m_cullTotals), CullStats{});
+	m_occludedTotal = 0;
+	m_cullFrames = 0;
+}
+#endif
+
+void BoxApp::UpdateTransparentOrder()
+{
+	// ͸ҪԶϣ԰Χ(ûаΧʱȡһʵλ)
+	const auto& items = m_renderItemLayers[static_cast<UINT>(BlendType::transparent)];
+	std::vector<XMFLOAT3> centers;
+	centers.reserve(items.size());
+	for (const auto item : items)
+	{
+		centers.emplace_back(item->HasBounds() ? item->GetWorldBounds().Center : item->GetTransform(0).m_position);
+	}
+	const auto& order = m_transparentSort.Sort(centers.data(), static_cast<UINT>(centers.size()), m_camera->GetCurrViewXM());
+	m_transparentItems.clear();
+	for (UINT idx : order)
+	{
+		m_transparentItems.push_back(items[idx]);
+	}
+}
+
 void BoxApp::UpdatePostProcess(const GameTimer& timer)
 {
 	PostProcessPass ppp;
@@ -829,81 +1127,370 @@ void BoxApp::UpdatePostProcess(const GameTimer& timer)
 	ppp.totalTime_gpu = static_cast<float>(timer.TotalTime());
 	ppp.cameraPos_gpu = m_camera->GetCurrPos();
 
-	auto postProcessPass = m_currFrameResource->m_postProcessCBuffer.get();
-	postProcessPass->Copy(0, ppp);
+	m_currFrameResource->m_postProcessCB.Copy(0, ppp);
 }
 
 void BoxApp::UpdateLightPos(const GameTimer& timer)
 {
-	const auto totalTime = timer.TotalTime();
-	for (UINT i = 0; i < pointLightNum; ++i)
-	{
-		const auto& data = m_pointLightPos[i];
-		const float angle = data->angle * totalTime * data->moveSpeed;
-		const auto& params = m_computeLights[i];
-		XMFLOAT3 pos = XMFLOAT3(data->radius * std::cos(angle), data->height, data->radius * std::sin(angle));
-		XMVECTOR viewPos = XMVector3TransformCoord(XMLoadFloat3(&pos), m_camera->GetCurrViewXM());
-		params->MovePos(viewPos);
-	}
-	m_renderer->UpdatePointLights(m_computeLights);
+	// SoA洢ĵԴSIMD鲢и£Уһοϴ
+	m_pointLights.Animate(static_cast<float>(timer.TotalTime()), m_camera->GetCurrViewXM());
+	m_renderer->UpdatePointLights(m_currFrameResourceIndex, m_pointLights.GetData(), m_pointLights.GetSize());
 }
 
 void BoxApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const vector<RenderItem*>& items)
 {
+	FlushBarriers(cmdList);
 	auto objectConstantBuffer = m_currFrameResource->m_uploadCBuffer->GetResource();
+	CommandListSink sink(cmdList, objectConstantBuffer->GetGPUVirtualAddress());
 	for (auto& item : items)
 	{
-		const auto& vboView = item->m_mesh->GetVBOView();
-		const auto& eboView = item->m_mesh->GetEBOView();
-		cmdList->IASetVertexBuffers(0, 1, &vboView);
-		cmdList->IASetIndexBuffer(&eboView);
-		cmdList->IASetPrimitiveTopology(item->m_topologyType);
+		sink.DrawItem(*item);
+	}
+}
+
+void BoxApp::BindFrameState(ID3D12GraphicsCommandList* cmdList) const
+{
+	// ǩCBV/SRVõ
+	ID3D12DescriptorHeap* descriptorSRVHeaps[] = { TextureMgr::instance().GetSRVDescriptorHeap() };
+	cmdList->SetDescriptorHeaps(_countof(descriptorSRVHeaps), descriptorSRVHeaps);
+	cmdList->SetGraphicsRootSignature(m_rootSignature.Get());
 
-		cmdList->SetGraphicsRootShaderResourceView(1, objectConstantBuffer->GetGPUVirtualAddress() + item->instanceStart * sizeof(ObjectInstance));
+	// matBuffer
+	auto matBuffer = m_currFrameResource->m_materialCBuffer->GetResource();
+	cmdList->SetGraphicsRootShaderResourceView(2, matBuffer->GetGPUVirtualAddress());
+	// textureBuffer
+	cmdList->SetGraphicsRootDescriptorTable(6, TextureMgr::instance().GetSRVDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
+	m_shadow->CopyCascadedShadowPass(cmdList);
+}
 
-		cmdList->DrawIndexedInstanced(item->eboCount, item->GetInstanceSize(), item->eboStart, item->vboStart, 0);
+void BoxApp::RecordScenePasses(bool taaFirstPass)
+{
+	using PassHooks = CommandListSink::PassHooks;
+	const auto passCB = m_currFrameResource->m_passCB;
+	const auto& cameraItems = m_cameraVisible;
+	// ÿбҪ°Ĺ״̬
+	auto BindPass = [this, passCB](ID3D12GraphicsCommandList* cmdList, UINT passIdx)
+	{
+		BindFrameState(cmdList);
+		cmdList->SetGraphicsRootConstantBufferView(0, passCB.GetAddress(passIdx));
+	};
+
+	std::vector<PassHooks> hooks;
+	m_recorder->Reset();
+	// Ӱھ̬ػʧЧ¶ÿһpassһ̬ʱ̬תΪɶ
+	using Effect::CascadeWork;
+	bool hasStatic = false;
+	for (UINT idx = 0; idx < Effect::CascadedShadow::cascadeLevels; ++idx)
+	{
+		const UINT rectCount = m_shadow->GetStaticRectCount(idx);
+		for (UINT rectIdx = 0; rectIdx < rectCount; ++rectIdx)
+		{
+			m_recorder->AddPass(m_staticCasters[idx]);
+			hooks.push_back({ [this, BindPass, idx, rectIdx](ID3D12GraphicsCommandList* cmdList, const RecordChunk& chunk)
+			{
+				BindPass(cmdList, m_shadow->GetPassOffset() + idx);
+				m_shadow->BindStaticCascade(cmdList, idx, rectIdx, chunk.chunkIdx == 0);
+			}, nullptr });
+			hasStatic = true;
+		}
+	}
+	if (hasStatic)
+	{
+		hooks.back().end = [this](ID3D12GraphicsCommandList* cmdList, const RecordChunk& chunk)
+		{
+			if (chunk.chunkIdx + 1 == chunk.chunkCount)
+			{
+				m_shadow->EndStaticCascades(cmdList);
+			}
+		};
+	}
+	// ٽ̬ȸƵͼӶ̬壬Զڱ֡ʱ
+	for (UINT idx = 0; idx < Effect::CascadedShadow::cascadeLevels; ++idx)
+	{
+		if (m_shadow->GetCascadeWork(idx) == CascadeWork::skip)
+			continue;
+		m_recorder->AddPass(m_dynamicCasters[idx]);
+		hooks.push_back({ [this, BindPass, idx](ID3D12GraphicsCommandList* cmdList, const RecordChunk& chunk)
+		{
+			BindPass(cmdList, m_shadow->GetPassOffset() + idx);
+			m_shadow->BindCascade(cmdList, idx, chunk.chunkIdx == 0);
+		}, nullptr });
+	}
+	// TAA֡
+	if (taaFirstPass)
+	{
+		m_recorder->AddPass(cameraItems);
+		hooks.push_back({ [this, BindPass](ID3D12GraphicsCommandList* cmdList, const RecordChunk& chunk)
+		{
+			BindPass(cmdList, m_passOffset);
+			cmdList->RSSetViewports(1, &m_camera->GetViewPort());
+			cmdList->RSSetScissorRects(1, &m_scissorRect);
+			m_TemporalAA->BindFirstPass(cmdList, GetDepthStencilView(), chunk.chunkIdx == 0);
+		}, [this](ID3D12GraphicsCommandList* cmdList, const RecordChunk& chunk)
+		{
+			// պһлƣ֤λв͸֮
+			if (chunk.chunkIdx + 1 == chunk.chunkCount)
+			{
+				cmdList->SetPipelineState(m_skybox->GetPSO());
+				DrawRenderItems(cmdList, m_renderItemLayers[static_cast<UINT>(BlendType::skybox)]);
+			}
+		} });
+	}
+	// GBuffer
+	m_recorder->AddPass(cameraItems);
+	hooks.push_back({ [this, BindPass](ID3D12GraphicsCommandList* cmdList, const RecordChunk& chunk)
+	{
+		BindPass(cmdList, m_passOffset);
+		cmdList->RSSetViewports(1, &m_camera->GetViewPort());
+		cmdList->RSSetScissorRects(1, &m_scissorRect);
+		const auto& depthStencilView = GetDepthStencilView();
+		if (chunk.chunkIdx == 0)
+		{
+			FlushBarriers(cmdList);
+			cmdList->ClearDepthStencilView(depthStencilView, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 0.0f, 0, 0, nullptr);
+		}
+		cmdList->OMSetRenderTargets(3, &gBuffer->gBufferRTV[0], true, &depthStencilView);
+		cmdList->SetPipelineState(gBuffer->m_pso.Get());
+	}, nullptr });
+
+	// kдkб˳ύ봮¼Ƶȼ
+	const UINT chunkCount = m_recorder->GetChunkCount();
+	assert(chunkCount <= m_currFrameResource->m_workerCommandLists.size());
+	const auto instanceAddress = m_currFrameResource->m_uploadCBuffer->GetResource()->GetGPUVirtualAddress();
+	std::vector<CommandListSink> sinks;
+	std::vector<ICommandSink<RenderItem>*> sinkPtrs(chunkCount);
+	std::vector<ID3D12CommandList*> cmdLists(chunkCount);
+	sinks.reserve(chunkCount);
+	for (UINT i = 0; i < chunkCount; ++i)
+	{
+		auto cmdList = m_currFrameResource->m_workerCommandLists[i].Get();
+		sinks.emplace_back(cmdList, instanceAddress, m_currFrameResource->m_workerAllocators[i].Get(), &hooks);
+		sinkPtrs[i] = &sinks[i];
+		cmdLists[i] = cmdList;
 	}
+	m_recorder->Record(sinkPtrs);
+	m_commandQueue->ExecuteCommandLists(chunkCount, cmdLists.data());
 }
 
-void BoxApp::DrawPostProcess(ID3D12GraphicsCommandList* cmdList) {
-	m_renderer->SetBloomState<0, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList);
-	m_TemporalAA->Draw(cmdList, [&](UINT){
-		cmdList->SetComputeRootDescriptorTable(3, m_renderer->GetBloomSRV<0>());
+void BoxApp::BuildFrameGraph(ID3D12GraphicsCommandList* cmdList, D3D12_GPU_DESCRIPTOR_HANDLE gBufferSRVHandler)
+{
+	using namespace GraphState;
+	m_frameGraph.Reset();
+	// GBuffer֡ͼ֮ǰΪȾĿд룬֡ʱתȾĿ깩һ֡ʹ
+	std::array<RenderGraph::ResourceHandle, 3> gBufferRes{};
+	for (int i = 0; i < 3; ++i)
+	{
+		gBufferRes[i] = m_frameGraph.ImportResource("GBuffer" + std::to_string(i), gBuffer->gBufferRes[i].Get(), renderTarget, renderTarget);
+	}
+	const auto backBuffer = m_frameGraph.ImportResource("BackBuffer", GetCurrentBackBuffer(), renderTarget, present);
+	const auto bloomUpSampler = m_frameGraph.ImportResource("BloomUpSampler", m_blur->GetResourceUpSampler(), common, common);
+	// Դֻ֡ʹã״̬ЧʵʵڴΪ˲̬Դ֡ͼ滮
+	// ϢֻPlaceTransientResourcesպѯ˲̬еԴnative֡ͼɱ
+	const auto DeclareTransient = [this](const std::string& name, ID3D12Resource* res)
+	{
+		auto found = m_transientInfos.find(name);
+		if (found == m_transientInfos.end())
+		{
+			const auto& desc = res->GetDesc();
+			const auto& allocInfo = m_d3dDevice->GetResourceAllocationInfo(0, 1, &desc);
+			TransientHeapType heapType = TransientHeapType::texture;
+			if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+				heapType = TransientHeapType::buffer;
+			else if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+				heapType = TransientHeapType::renderTarget;
+			found = m_transientInfos.emplace(name, TransientInfo{ allocInfo.SizeInBytes, allocInfo.Alignment, heapType }).first;
+		}
+		TransientInfo& info = found->second;
+		info.handle = m_frameGraph.DeclareTransient(name, info.size, info.alignment, info.heapType);
+		if (info.placed)
+			m_frameGraph.SetNative(info.handle, res);
+		return info.handle;
+	};
+	const auto ssao = DeclareTransient("SSAO", m_ssao->GetResource());
+	const auto sceneColor = DeclareTransient("SceneColor", m_renderer->GetResource());
+	const auto bloomBright = DeclareTransient("BloomBright", m_renderer->GetBloomRes());
+	const auto bloomDownSampler = DeclareTransient("BloomDownSampler", m_blur->GetResourceDownSampler());
+	const auto taaOutput = DeclareTransient("TemporalAA", m_TemporalAA->GetResource());
+	const auto toneMapOutput = DeclareTransient("ToneMap", m_toneMap->GetResource());
+	const auto ReadGBuffer = [this, &gBufferRes](RenderGraph::PassHandle node)
+	{
+		for (const auto res : gBufferRes)
+		{
+			m_frameGraph.Read(node, res, shaderResource);
+		}
+	};
+
+	// ԼɼصȷΧ֡ڻӰ
+	auto node = m_frameGraph.AddPass("DepthReduction", [this, cmdList, gBufferSRVHandler]
+	{
+		m_depthReduction->Draw(cmdList, [&](UINT) {
+			cmdList->SetComputeRootConstantBufferView(4, m_currFrameResource->m_postProcessCB.GetAddress());
+			cmdList->SetComputeRootDescriptorTable(5, gBufferSRVHandler);
+		});
+	});
+	ReadGBuffer(node);
+	m_frameGraph.SetSideEffect(node);
+	// Ȳض֡ͶӰڵ޳
+	node = m_frameGraph.AddPass("HiZReadback", [this, cmdList, gBufferSRVHandler]
+	{
+		m_hiZReadback->Draw(cmdList, [&](UINT) {
+			cmdList->SetComputeRootDescriptorTable(5, gBufferSRVHandler);
+		});
 	});
-	m_renderer->SetBloomState<0, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET>(cmdList);
+	ReadGBuffer(node);
+	m_frameGraph.SetSideEffect(node);
+
+	// SSAO
+	node = m_frameGraph.AddPass("SSAO", [this, cmdList]
+	{
+		m_ssao->Draw(cmdList, [](UINT) {});
+	});
+	ReadGBuffer(node);
+	m_frameGraph.Write(node, ssao, common);
+
+	node = m_frameGraph.AddPass("DeferredLighting", [this, cmdList, gBufferSRVHandler]
+	{
+		auto ssaoSRVHandler = CD3DX12_GPU_DESCRIPTOR_HANDLE(TextureMgr::instance().GetSRVDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
+		ssaoSRVHandler.Offset(m_ssao->GetSrvIdx("SSAO").value_or(0), m_cbvUavDescriptorSize);
+		cmdList->SetGraphicsRootDescriptorTable(4, ssaoSRVHandler);
+
+		// GPUдshadow
+		auto shadowSRVHandler = CD3DX12_GPU_DESCRIPTOR_HANDLE(TextureMgr::instance().GetSRVDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
+		shadowSRVHandler.Offset(m_shadow->GetCascadedSrvOffset(), m_cbvUavDescriptorSize);
+		cmdList->SetGraphicsRootDescriptorTable(5, shadowSRVHandler);
+		auto skyboxSRVHandler = CD3DX12_GPU_DESCRIPTOR_HANDLE(TextureMgr::instance().GetSRVDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
+		skyboxSRVHandler.Offset(m_skybox->GetStaticID(), m_cbvUavDescriptorSize);
+		cmdList->SetGraphicsRootDescriptorTable(7, skyboxSRVHandler);
+
+		m_renderer->Draw(cmdList, [&](UINT){
+			cmdList->SetComputeRootConstantBufferView(0, m_currFrameResource->m_postProcessCB.GetAddress());
+			cmdList->SetComputeRootDescriptorTable(1, gBufferSRVHandler);
+		});
+		cmdList->SetPipelineState(m_skybox->GetPSO());
+		DrawRenderItems(cmdList, m_renderItemLayers[static_cast<UINT>(BlendType::skybox)]);
+	});
+	ReadGBuffer(node);
+	m_frameGraph.Read(node, ssao, common);
+	m_frameGraph.Write(node, sceneColor, common);
+	m_frameGraph.Write(node, bloomBright, common);
+	// ͸Forward+ӳȾĽϣҪGBufferתȾĿ֮ǰ
+	if (!m_transparentItems.empty())
+	{
+		node = m_frameGraph.AddPass("ForwardPlus", [this, cmdList, gBufferSRVHandler]
+		{
+			m_forwardPlus->Draw(cmdList, [&](UINT pass)
+			{
+				if (pass == Renderer::ForwardPlus::lightCullingPass)
+				{
+					cmdList->SetComputeRootConstantBufferView(0, m_currFrameResource->m_postProcessCB.GetAddress());
+					cmdList->SetComputeRootDescriptorTable(1, gBufferSRVHandler);
+					return;
+				}
+				DrawRenderItems(cmdList, m_transparentItems);
+			});
+		});
+		ReadGBuffer(node);
+		m_frameGraph.Write(node, sceneColor, common);
+	}
+
+	/*
+	 * Post Process Part
+	 */
+	node = m_frameGraph.AddPass("TemporalAA", [this, cmdList, gBufferSRVHandler]
+	{
+		PostProcessMgr::instance().UpdateResources<PostProcessMgr::Graphics>(cmdList, m_currFrameResource->m_postProcessCB.GetAddress(), gBufferSRVHandler);
+		m_renderer->SetBloomState<0, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList);
+		m_TemporalAA->Draw(cmdList, [&](UINT){
+			cmdList->SetComputeRootDescriptorTable(3, m_renderer->GetBloomSRV<0>());
+		});
+		m_renderer->SetBloomState<0, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET>(cmdList);
+	});
+	ReadGBuffer(node);
+	m_frameGraph.Read(node, sceneColor, common);
+	m_frameGraph.Write(node, taaOutput, common);
 
 	// ̨ݿԴ
 	// ִϺݴĬϻڴ滺
-	m_blur->Draw(cmdList, [&](UINT) {
-		m_renderer->SetBloomState<1, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE>(cmdList);
-		cmdList->CopyResource(m_blur->GetResourceDownSampler(), m_renderer->GetBloomRes());
-		m_renderer->SetBloomState<1, D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET>(cmdList);
+	// ϲģڲת״̬ʱصcommon
+	node = m_frameGraph.AddPass("Bloom", [this, cmdList]
+	{
+		m_blur->Draw(cmdList, [&](UINT) {
+			m_renderer->SetBloomState<1, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE>(cmdList);
+			FlushBarriers(cmdList);
+			cmdList->CopyResource(m_blur->GetResourceDownSampler(), m_renderer->GetBloomRes());
+			m_renderer->SetBloomState<1, D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET>(cmdList);
+		});
+	});
+	m_frameGraph.Read(node, bloomBright, common);
+	m_frameGraph.Write(node, bloomDownSampler, common);
+	m_frameGraph.Write(node, bloomUpSampler, common);
+
+	node = m_frameGraph.AddPass("ToneMap", [this, cmdList]
+	{
+		m_toneMap->Draw(cmdList, [&](UINT)
+		{
+			cmdList->SetComputeRootDescriptorTable(1, m_TemporalAA->GetGpuSRV());
+			cmdList->SetComputeRootDescriptorTable(3, m_blur->GetUpSamplerSRV());
+		});
 	});
+	m_frameGraph.Read(node, taaOutput, common);
+	m_frameGraph.Read(node, bloomUpSampler, shaderResource);
+	m_frameGraph.Write(node, toneMapOutput, common);
 
-	ChangeState<D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_GENERIC_READ>(cmdList, m_blur->GetResourceUpSampler());
-	m_toneMap->Draw(cmdList, [&](UINT)
+	node = m_frameGraph.AddPass("CopyToBackBuffer", [this, cmdList]
 	{
-		cmdList->SetComputeRootDescriptorTable(1, m_TemporalAA->GetGpuSRV());
-		cmdList->SetComputeRootDescriptorTable(3, m_blur->GetUpSamplerSRV());
+		FlushBarriers(cmdList);
+		cmdList->CopyResource(GetCurrentBackBuffer(), m_toneMap->GetResource());
+		m_toneMap->SetResourceState<D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_COMMON>(cmdList);
 	});
-	ChangeState<D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_COMMON>(cmdList, m_blur->GetResourceUpSampler());
+	m_frameGraph.Read(node, toneMapOutput, common);
+	m_frameGraph.Write(node, backBuffer, copyDest);
 
-	ChangeState<D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_DEST>(cmdList, GetCurrentBackBuffer());
-	cmdList->CopyResource(GetCurrentBackBuffer(), m_toneMap->GetResource());
-	m_toneMap->SetResourceState<D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_COMMON>(cmdList);
+#if defined(DEBUG) || defined(_DEBUG)
+	node = m_frameGraph.AddPass("Debug", [this, cmdList]
+	{
+		Debug::DebugMgr::instance().PrepareToDebug(cmdList, GetCurrentBackBufferView());
+		cmdList->SetGraphicsRootDescriptorTable(0, gBuffer->gBufferGpuSRV[0]);
+		DrawDebugItems(cmdList);
+	});
+	m_frameGraph.Read(node, gBufferRes[0], pixelShaderResource);
+	m_frameGraph.Write(node, backBuffer, renderTarget);
+#endif
+}
 
+void BoxApp::PlaceTransientResources()
+{
+	// ֡ͼÿ֡ͬ滮ҲֻͬԴؽ滮һ
+	m_transientInfos.clear();
+	BuildFrameGraph(m_commandList.Get(), {});
+	m_frameGraph.Compile();
+	const auto& planner = m_frameGraph.GetAliasingPlanner();
+	// TAA⽵ɫӳֻUAVкڲཻڴ
+	const auto& heapDesc = CD3DX12_HEAP_DESC(planner.GetHeapSize(TransientHeapType::texture), D3D12_HEAP_TYPE_DEFAULT, 0, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES);
+	ComPtr<ID3D12Heap> heap;
+	ThrowIfFailed(m_d3dDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(heap.GetAddressOf())));
+	heap->SetName(L"TransientTextures");
+	const auto Place = [this](const string& name)
+	{
+		TransientInfo& info = m_transientInfos.at(name);
+		info.placed = true;
+		return m_frameGraph.GetPlacement(info.handle).offset;
+	};
+	// Դ¶ؽ֮ͷžɶ
+	m_TemporalAA->PlaceResource(heap.Get(), Place("TemporalAA"));
+	m_blur->PlaceDownSampler(heap.Get(), Place("BloomDownSampler"));
+	m_toneMap->PlaceResource(heap.Get(), Place("ToneMap"));
+	m_transientHeap = heap;
 #if defined(DEBUG) || defined(_DEBUG)
-	ChangeState<D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_RENDER_TARGET>(cmdList, GetCurrentBackBuffer());
-	Debug::DebugMgr::instance().PrepareToDebug(cmdList, GetCurrentBackBufferView());
-	cmdList->SetGraphicsRootDescriptorTable(0, gBuffer->gBufferGpuSRV[0]);
-	DrawDebugItems(cmdList);
-	ChangeState<D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_DEST>(cmdList, GetCurrentBackBuffer());
+	const auto mb = [](uint64_t size) { return std::to_string(size / (1024.0 * 1024.0)); };
+	OutputDebugStringA(("Transient aliasing: unaliased " + mb(planner.GetUnaliasedSize()) + "MB, aliased " + mb(planner.GetAliasedSize()) + "MB, peak live " +
+		mb(planner.GetPeakLiveSize()) + "MB, saved " + mb(planner.GetSavedSize()) + "MB, placed " + mb(planner.GetHeapSize(TransientHeapType::texture)) + "MB\n").c_str());
 #endif
-	ChangeState<D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PRESENT>(cmdList, GetCurrentBackBuffer());
 }
 
 void BoxApp::DrawDebugItems(ID3D12GraphicsCommandList* cmdList) const
 {
+	FlushBarriers(cmdList);
 	const auto& items = m_renderItemLayers[static_cast<UINT>(BlendType::debug)];
 	for (auto& item : items )
 	{
@@ -3,12 +3,21 @@
 #include <DirectXMath.h>
 #include <memory>
 #include <array>
+#include <random>
+#include <string_view>
 #include "D3DAPP_Template.h"
 #include "FrameResource.h"
 #include "Shader.h"
 #include "Mesh.h"
 #include "Material.h"
 #include "EffectHeader.h"
+#include "CommandListSink.h"
+#include "FrustumCuller.h"
+#include "MaskedOcclusionCuller.h"
+#include "HiZCuller.h"
+#include "RenderGraph.h"
+#include "D3D12StateTracker.h"
+#include "PointLightStore.h"
 
 using namespace DirectX;
 using namespace Template;
@@ -43,12 +52,17 @@ private:
 	 */
 	void CreateRootSignature();
 	void CreateLights();
+	// ʼķֲɵԴ¼m_pointLightHandles
+	void AddPointLights(UINT count);
+	void RemovePointLights(UINT count);
 	void CreateDescriptorHeaps();
 	void CreateShadersAndInput();
 	void CreateGeometry();
 	void CreatePSO();
 	void CreateFrameResources();
 	void CreateRenderItems();
+	// nameͬʱǲ
+	void CreateTransparentItem(std::unique_ptr<RenderItem> item, const string& name, const BoundingBox& localBounds);
 	void CreateTextures();
 	void CreateMaterials();
 	auto CreateStaticSampler2D() -> std::array<const CD3DX12_STATIC_SAMPLER_DESC, 8>;
@@ -59,9 +73,19 @@ private:
 	void UpdateOffScreen(const GameTimer& timer);
 	void UpdatePostProcess(const GameTimer& timer);
 	void UpdateLightPos(const GameTimer& timer);
+	void UpdateSceneBVH();
+	void UpdateCulling();
+#if defined(DEBUG) || defined(_DEBUG)
+	void ReportCulling();
+#endif
+	void UpdateTransparentOrder();
 
 	void DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const vector<RenderItem*>& items);
-	void DrawPostProcess(ID3D12GraphicsCommandList* cmdList);
+	void BindFrameState(ID3D12GraphicsCommandList* cmdList) const;
+	void RecordScenePasses(bool taaFirstPass);
+	void BuildFrameGraph(ID3D12GraphicsCommandList* cmdList, D3D12_GPU_DESCRIPTOR_HANDLE gBufferSRVHandler);
+	// ˲̬Դؽ֡ͼ滮һαѲȾĿ˲̬ͬһ
+	void PlaceTransientResources();
 	void DrawDebugItems(ID3D12GraphicsCommandList* cmdList) const;
 private:
 	// cbufferԱɫ,ͨCPUÿ֡һΡҪϴѶĬ϶УҳСӲСռ(256B)
@@ -77,20 +101,87 @@ private:
 	unordered_map<string, std::unique_ptr<Mesh>>		m_meshGeos;
 	std::shared_ptr<Material>							m_material{ nullptr };
 	std::vector<std::shared_ptr<Light<Pixel>>>			m_pixelLights;
-	std::vector<std::shared_ptr<Light<Compute>>>		m_computeLights;
-	std::vector<unique_ptr<LightMoveParams>>			m_pointLightPos;
+	PointLightStore										m_pointLights;
+	std::vector<UINT>									m_pointLightHandles;
+	std::mt19937										m_lightRandom{ 1337 };
+	// ÿΰɾĵԴ
+	static constexpr UINT								pointLightBatch = 256;
+	bool												m_addLightsDown{ false };
+	bool												m_removeLightsDown{ false };
 
 	POINT												m_lastMousePos;
 	std::unique_ptr<Effect::CubeMap>					m_skybox;
 	std::unique_ptr<Effect::DynamicCubeMap>				m_dynamicCube;
 	std::unique_ptr<Effect::CascadedShadow>				m_shadow;
+	std::unique_ptr<Effect::DepthReduction>				m_depthReduction;
+	std::unique_ptr<Effect::HiZReadback>				m_hiZReadback;
 
 	std::unique_ptr<Renderer::TileBasedDefer>			m_renderer;
+	std::unique_ptr<Renderer::ForwardPlus>				m_forwardPlus;
+	// ֡Զе͸Ⱦ
+	Renderer::TransparentSort							m_transparentSort;
+	std::vector<RenderItem*>							m_transparentItems;
 	std::unique_ptr<Renderer::GBuffer>					gBuffer;
 	std::unique_ptr<Effect::SSAO>						m_ssao;
 
 	std::unique_ptr<Effect::GaussianBlur>				m_blur;
 	std::unique_ptr<Effect::ToneMap>					m_toneMap;
 	std::unique_ptr<Effect::TemporalAA>					m_TemporalAA;
+
+	// Ӱľ̬붯̬塢TAA֡GBufferȾ¼
+	std::unique_ptr<ParallelRecorder<RenderItem>>		m_recorder;
+	static constexpr UINT								recordPassCount = Effect::CascadedShadow::cascadeLevels * 2 + 2;
+	// ޳passǰcascadeLevelsΪӰһΪ
+	FrustumCuller										m_culler;
+	// ɼͶӰ壬ֻ̬ڼľ̬ʧЧʱ
+	std::vector<RenderItem*>							m_staticCasters[Effect::CascadedShadow::cascadeLevels];
+	std::vector<RenderItem*>							m_dynamicCasters[Effect::CascadedShadow::cascadeLevels];
+	static constexpr UINT								cameraCullPass = Effect::CascadedShadow::cascadeLevels;
+#if defined(DEBUG) || defined(_DEBUG)
+	// ÿcullReportInterval֡һθ޳passƽɼ
+	CullStats											m_cullTotals[cameraCullPass + 1];
+	UINT												m_occludedTotal{ 0 };
+	UINT												m_cullFrames{ 0 };
+	static constexpr UINT								cullReportInterval = 600;
+#endif
+	// pass׶޳ڵ޳ڵΪ̬ΣӰڵӰ
+	static constexpr UINT								occlusionWidth = 512;
+	static constexpr UINT								occlusionHeight = 256;
+	static constexpr UINT								occluderBudget = 4096;
+	static constexpr float								occluderMinArea = 1.0f;
+	// Sponzaд͸ԵĲʣҶеֲ
+	static constexpr std::string_view					alphaTestedMaterials[] = { "leaf", "Material__57", "chain" };
+	MaskedOcclusionCuller								m_occlusionCuller{ occlusionWidth, occlusionHeight };
+	OccluderMesh										m_occluders;
+	std::vector<RenderItem*>							m_cameraVisible;
+	// ضGBufferͶӰ֡󹹽HZBʵΧвԣڵ޳
+	HiZCuller											m_hiZCuller;
+	std::vector<float>									m_hiZDepth;
+#if defined(DEBUG) || defined(_DEBUG)
+	// ֡Դ¼֡HZBжȻضԸ֡ʵͳ
+	std::vector<std::pair<BoundingBox, bool>>			m_hiZDecisions[frameResourcesCount];
+	HiZErrorStats										m_hiZErrors;
+	static constexpr UINT								hiZReportInterval = 100000;
+#endif
+	// ÿ֡ӳٹ֡ͼ
+	RenderGraph											m_frameGraph;
+	// ˲̬ԴķϢԴؽѯһΣÿ֡ʱ
+	struct TransientInfo
+	{
+		UINT64						size;
+		UINT64						alignment;
+		TransientHeapType			heapType;
+		// ֡ľ
+		RenderGraph::ResourceHandle	handle{ 0 };
+		bool						placed{ false };
+	};
+	unordered_map<string, TransientInfo>				m_transientInfos;
+	ComPtr<ID3D12Heap>									m_transientHeap;
+	std::unique_ptr<D3D12StateTracker>					m_stateTracker;
+	ComPtr<ID3D12GraphicsCommandList>					m_fixupCommandList;
+	// ϴframeResourcesCount;֡뵱ǰ֡ȫÿ֡ݣִعԴбռ4MB
+	static constexpr UINT64								uploadRingSize = 32 * 1024 * 1024;
+	// ȼصmipԤ32x32(BCʽԴ)
+	static constexpr UINT								texturePreviewMips = 6;
 };   
 
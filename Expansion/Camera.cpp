@@ -205,7 +205,12 @@ XMFLOAT4X4 Camera::GetViewPortRay() const {
 
 void Camera::GetFrustumPlanes(XMFLOAT4* planes) const
 {
-	const BoundingFrustum projFrustum(GetCurrProjXM());
+	BoundingFrustum projFrustum(GetCurrProjXM());
+	// reverse-ZͶӰƳĽƽԶƽǵߵ
+	if (projFrustum.Near > projFrustum.Far)
+	{
+		std::swap(projFrustum.Near, projFrustum.Far);
+	}
 	XMVECTOR frustumPlanesXM[6];
 	projFrustum.GetPlanes(&frustumPlanesXM[0], &frustumPlanesXM[1], &frustumPlanesXM[2],
 		&frustumPlanesXM[3], &frustumPlanesXM[4], &frustumPlanesXM[5]);
@@ -217,6 +222,22 @@ void Camera::GetFrustumPlanes(XMFLOAT4* planes) const
 	memcpy(planes, &frustumPlanes, sizeof(XMFLOAT4) * 6);
 }
 
+void Camera::GetWorldFrustumPlanes(XMFLOAT4* planes) const
+{
+	GetFrustumPlanes(planes);
+	// ƽӹ۲ռ任ռҪ(invView)^-1תãviewת
+	const XMMATRIX planeTransform = XMMatrixTranspose(GetCurrViewXM());
+	for (int i = 0; i < 6; ++i)
+	{
+		XMStoreFloat4(&planes[i], XMPlaneNormalize(XMPlaneTransform(XMLoadFloat4(&planes[i]), planeTransform)));
+	}
+}
+
+uint64_t Camera::GetProjectionVersion() const
+{
+	return m_projVersion;
+}
+
 void Camera::SetFrustum(float fov, float aspect, float nearZ, float farZ)
 {
 	m_fov = fov;
@@ -229,6 +250,7 @@ void Camera::SetFrustum(float fov, float aspect, float nearZ, float farZ)
 	XMMATRIX proj = XMMatrixPerspectiveFovLH(m_fov, m_aspect, m_nearPlane, m_farPlane);
 	DirectX::XMStoreFloat4x4(&m_nonjitteredProj, proj);
 	m_proj = m_nonjitteredProj;
+	++m_projVersion;
 }
 
 void Camera::SetFrustumReverseZ(float fov, float aspect, float nearZ, float farZ) {
@@ -242,11 +264,13 @@ void Camera::SetFrustumReverseZ(float fov, float aspect, float nearZ, float farZ
 	XMMATRIX proj = XMMatrixPerspectiveFovLH(m_fov, m_aspect, m_nearPlane, m_farPlane);
 	DirectX::XMStoreFloat4x4(&m_nonjitteredProj, proj);
 	m_proj = m_nonjitteredProj;
+	++m_projVersion;
 }
 
 void Camera::SetViewPort(const D3D12_VIEWPORT& viewport)
 {
 	m_viewport = viewport;
+	++m_projVersion;
 }
 
 void Camera::SetViewPort(float topLeftX, float topLeftY, float width, float height, float minDepth, float maxDepth)
@@ -257,6 +281,7 @@ void Camera::SetViewPort(float topLeftX, float topLeftY, float width, float heig
 	m_viewport.Height = height;
 	m_viewport.MinDepth = minDepth;
 	m_viewport.MaxDepth = maxDepth;
+	++m_projVersion;
 }
 
 void Camera::LookAt(const XMFLOAT3& center, const XMFLOAT3& target, const XMFLOAT3& up)
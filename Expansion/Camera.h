@@ -66,7 +66,10 @@ public:
 	XMFLOAT4X4			GetInvVP() const;
 	XMMATRIX			GetViewPortRayXM() const;
 	XMFLOAT4X4			GetViewPortRay() const;
-	void				GetFrustumPlanes(XMFLOAT4* planes) const;
+	void				GetFrustumPlanes(XMFLOAT4* planes) const;		// ۲ռµƽ棬߳
+	void				GetWorldFrustumPlanes(XMFLOAT4* planes) const;
+	// ͶӰӿÿα仯ʱTAA
+	uint64_t			GetProjectionVersion() const;
 
 	void SetJitter(const XMFLOAT2& curr);
 	void SetFrustum(float fov, float aspect, float nearZ, float farZ);
@@ -101,6 +104,7 @@ protected:
 	XMFLOAT4X4					m_proj{ MathHelper::MathHelper::identity4x4() };
 	XMFLOAT4X4					m_view{ MathHelper::MathHelper::identity4x4() };
 	bool						isMoved{ true };
+	uint64_t					m_projVersion{ 0 };
 };
 
 class FirstPersonCamera : public Camera
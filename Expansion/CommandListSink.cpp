@@ -0,0 +1,45 @@
+#include "CommandListSink.h"
+
+CommandListSink::CommandListSink(ID3D12GraphicsCommandList* cmdList, D3D12_GPU_VIRTUAL_ADDRESS instanceAddress,
+	ID3D12CommandAllocator* allocator, const std::vector<PassHooks>* hooks)
+: m_cmdList(cmdList), m_allocator(allocator), m_hooks(hooks), m_instanceAddress(instanceAddress)
+{
+}
+
+void CommandListSink::BeginChunk(const RecordChunk& chunk)
+{
+	if (m_allocator)
+	{
+		ThrowIfFailed(m_allocator->Reset());
+		ThrowIfFailed(m_cmdList->Reset(m_allocator, nullptr));
+	}
+	if (m_hooks && (*m_hooks)[chunk.passIdx].begin)
+	{
+		(*m_hooks)[chunk.passIdx].begin(m_cmdList, chunk);
+	}
+}
+
+void CommandListSink::DrawItem(const RenderItem& item)
+{
+	const auto& vboView = item.m_mesh->GetVBOView();
+	const auto& eboView = item.m_mesh->GetEBOView();
+	m_cmdList->IASetVertexBuffers(0, 1, &vboView);
+	m_cmdList->IASetIndexBuffer(&eboView);
+	m_cmdList->IASetPrimitiveTopology(item.m_topologyType);
+
+	m_cmdList->SetGraphicsRootShaderResourceView(1, m_instanceAddress + item.instanceStart * sizeof(ObjectInstance));
+
+	m_cmdList->DrawIndexedInstanced(item.eboCount, item.GetInstanceSize(), item.eboStart, item.vboStart, 0);
+}
+
+void CommandListSink::EndChunk(const RecordChunk& chunk)
+{
+	if (m_hooks && (*m_hooks)[chunk.passIdx].end)
+	{
+		(*m_hooks)[chunk.passIdx].end(m_cmdList, chunk);
+	}
+	if (m_allocator)
+	{
+		ThrowIfFailed(m_cmdList->Close());
+	}
+}
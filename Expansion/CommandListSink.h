@@ -0,0 +1,40 @@
+#pragma once
+
+#include <d3d12.h>
+#include <functional>
+#include <vector>
+#include "Mesh.h"
+#include "ParallelRecorder.hpp"
+
+/*
+ * дD3D12бĽն
+ * ʱsinkBeginChunkбEndChunkйر(ڹ̵߳б)
+ * ʱѴ¼״̬б׷ӻ
+ */
+class CommandListSink final : public ICommandSink<RenderItem>
+{
+public:
+	using PassFunc = std::function<void(ID3D12GraphicsCommandList*, const RecordChunk&)>;
+	struct PassHooks
+	{
+		PassFunc begin;	// 󶨸passĹ״̬
+		PassFunc end;	// ¼ƽʱ
+	};
+
+	CommandListSink(ID3D12GraphicsCommandList* cmdList, D3D12_GPU_VIRTUAL_ADDRESS instanceAddress,
+		ID3D12CommandAllocator* allocator = nullptr, const std::vector<PassHooks>* hooks = nullptr);
+	CommandListSink(const CommandListSink&) = delete;
+	CommandListSink& operator=(const CommandListSink&) = delete;
+	CommandListSink(CommandListSink&&) = default;
+	CommandListSink& operator=(CommandListSink&&) = default;
+	~CommandListSink() override = default;
+
+	void BeginChunk(const RecordChunk& chunk) override;
+	void DrawItem(const RenderItem& item) override;
+	void EndChunk(const RecordChunk& chunk) override;
+private:
+	ID3D12GraphicsCommandList*		m_cmdList;
+	ID3D12CommandAllocator*			m_allocator;
+	const std::vector<PassHooks>*	m_hooks;
+	D3D12_GPU_VIRTUAL_ADDRESS		m_instanceAddress;
+};
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "Renderer/DeferShading.h"
+#include "Renderer/ForwardPlus.h"
 #include "Renderer/GBuffer.h"
 #include "Renderer/TileBasedDefer.h"
+#include "Renderer/TransparentSort.h"
 #include "Shadow.h"
 #include "CubeMap.h"
 #include "DynamicCubeMap.h"
@@ -10,4 +12,6 @@
 #include "ToneMap.h"
 #include "SSAO.h"
 #include "TemporalAA.h"
-#include "CascadedShadow.h"
\ No newline at end of file
+#include "CascadedShadow.h"
+#include "DepthReduction.h"
+#include "HiZReadback.h"
\ No newline at end of file
@@ -1,11 +1,19 @@
 #include "FrameResource.h"
 
-FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount, UINT matCount)
+FrameResource::FrameResource(ID3D12Device* device, UINT objectCount, UINT matCount, UINT workerListCount)
 : m_uploadCBuffer(std::make_unique<UploaderBuffer<ObjectInstance>>(device, objectCount, false)),
-m_passCBuffer(std::make_unique<UploaderBuffer<PassConstant>>(device, passCount, true)),
-m_materialCBuffer(std::make_unique<UploaderBuffer<MaterialConstant>>(device, matCount, false)),
-m_postProcessCBuffer(std::make_unique<UploaderBuffer<PostProcessPass>>(device, 1, true))
+m_materialCBuffer(std::make_unique<UploaderBuffer<MaterialConstant>>(device, matCount, false))
 {
 	device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(m_commandAllocator.GetAddressOf()));
+
+	m_workerAllocators.resize(workerListCount);
+	m_workerCommandLists.resize(workerListCount);
+	for (UINT i = 0; i < workerListCount; ++i)
+	{
+		ThrowIfFailed(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(m_workerAllocators[i].GetAddressOf())));
+		ThrowIfFailed(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_workerAllocators[i].Get(), nullptr, IID_PPV_ARGS(m_workerCommandLists[i].GetAddressOf())));
+		// б¼״̬ȹرԱ¼ʱͳһReset
+		ThrowIfFailed(m_workerCommandLists[i]->Close());
+	}
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "UploaderBuffer.hpp"
+#include "UploadRing.h"
 #include "Vertex.h"
 #include "Material.h" 
 
@@ -11,18 +12,22 @@
 class FrameResource
 {
 public:
-	FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount, UINT matCount);
+	FrameResource(ID3D12Device* device, UINT objectCount, UINT matCount, UINT workerListCount = 0);
 	FrameResource(const FrameResource&) = delete;
 	FrameResource& operator=(const FrameResource&) = delete;
 	FrameResource(FrameResource&&) = default;
 	FrameResource& operator=(FrameResource&&) = default;
 	~FrameResource() = default;
 	std::unique_ptr<UploaderBuffer<ObjectInstance>>		m_uploadCBuffer{ nullptr };
-	std::unique_ptr<UploaderBuffer<PassConstant>>		m_passCBuffer{ nullptr };
 	std::unique_ptr<UploaderBuffer<MaterialConstant>>	m_materialCBuffer{ nullptr };
-	std::unique_ptr<UploaderBuffer<PostProcessPass>>	m_postProcessCBuffer{ nullptr };
+	// ÿ֡дĳÿ֡ʼʱӻϴ·
+	UploadAllocation									m_passCB;
+	UploadAllocation									m_postProcessCB;
 	// GPUִص֮ǰͲÿһ֡ҪԼ
 	ComPtr<ID3D12CommandAllocator>						m_commandAllocator{ nullptr };
+	// ¼ʹõбÿ¼ƿռһб
+	std::vector<ComPtr<ID3D12CommandAllocator>>			m_workerAllocators;
+	std::vector<ComPtr<ID3D12GraphicsCommandList>>		m_workerCommandLists;
 	UINT64												m_fence{ 0 };
 };
 
@@ -0,0 +1,154 @@
+#include "FrustumCuller.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include "ThreadPool.hpp"
+
+using namespace DirectX;
+
+void FrustumCuller::ExtractPlanes(FXMMATRIX viewProj, XMFLOAT4* planes)
+{
+	/*
+	 * Gribb-Hartmannüռпɼ -w<=x<=w, -w<=y<=w, 0<=z<=w
+	 * ɾϵõڵƽ棬ȡBoundingFrustumĳԼһ
+	 */
+	const XMMATRIX m = XMMatrixTranspose(viewProj);
+	const XMVECTOR inner[planeCount] = {
+		XMVectorAdd(m.r[3], m.r[0]),		// left
+		XMVectorSubtract(m.r[3], m.r[0]),	// right
+		XMVectorAdd(m.r[3], m.r[1]),		// bottom
+		XMVectorSubtract(m.r[3], m.r[1]),	// top
+		m.r[2],								// z = 0
+		XMVectorSubtract(m.r[3], m.r[2])	// z = w
+	};
+	for (uint32_t i = 0; i < planeCount; ++i)
+	{
+		XMStoreFloat4(&planes[i], XMPlaneNormalize(XMVectorNegate(inner[i])));
+	}
+}
+
+void FrustumCuller::Reset()
+{
+	m_payloads.clear();
+	m_centerX.clear();
+	m_centerY.clear();
+	m_centerZ.clear();
+	m_extentX.clear();
+	m_extentY.clear();
+	m_extentZ.clear();
+	m_alwaysVisible.clear();
+	m_passes.clear();
+}
+
+void FrustumCuller::AddItem(const BoundingBox& bounds, uint32_t payload)
+{
+	const uint32_t idx = AppendItem(payload, false);
+	m_centerX[idx] = bounds.Center.x;
+	m_centerY[idx] = bounds.Center.y;
+	m_centerZ[idx] = bounds.Center.z;
+	m_extentX[idx] = bounds.Extents.x;
+	m_extentY[idx] = bounds.Extents.y;
+	m_extentZ[idx] = bounds.Extents.z;
+}
+
+void FrustumCuller::AddAlwaysVisible(uint32_t payload)
+{
+	AppendItem(payload, true);
+}
+
+uint32_t FrustumCuller::AddPass(const XMFLOAT4* planes)
+{
+	const uint32_t passIdx = static_cast<uint32_t>(m_passes.size());
+	auto& pass = m_passes.emplace_back();
+	std::copy(planes, planes + planeCount, pass.planes);
+	pass.visible.reserve(m_payloads.size());
+	return passIdx;
+}
+
+void FrustumCuller::Cull()
+{
+	Thread::ThreadPool::instance().ParallelFor(0, static_cast<uint32_t>(m_passes.size()), 1, [this](uint32_t passIdx)
+	{
+		CullPass(passIdx);
+	});
+}
+
+uint32_t FrustumCuller::GetItemCount() const
+{
+	return static_cast<uint32_t>(m_payloads.size());
+}
+
+uint32_t FrustumCuller::GetPassCount() const
+{
+	return static_cast<uint32_t>(m_passes.size());
+}
+
+const std::vector<uint32_t>& FrustumCuller::GetVisible(uint32_t passIdx) const
+{
+	assert(passIdx < m_passes.size());
+	return m_passes[passIdx].visible;
+}
+
+const CullStats& FrustumCuller::GetStats(uint32_t passIdx) const
+{
+	assert(passIdx < m_passes.size());
+	return m_passes[passIdx].stats;
+}
+
+uint32_t FrustumCuller::AppendItem(uint32_t payload, bool alwaysVisible)
+{
+	const uint32_t idx = static_cast<uint32_t>(m_payloads.size());
+	m_payloads.emplace_back(payload);
+	m_alwaysVisible.emplace_back(alwaysVisible ? 1 : 0);
+	// SoAÿչ4ԪأԪرΪ0
+	if (idx % 4 == 0)
+	{
+		for (auto soa : { &m_centerX, &m_centerY, &m_centerZ, &m_extentX, &m_extentY, &m_extentZ })
+		{
+			soa->resize(idx + 4, 0.0f);
+		}
+	}
+	return idx;
+}
+
+void FrustumCuller::CullPass(uint32_t passIdx)
+{
+	auto& pass = m_passes[passIdx];
+	pass.visible.clear();
+	const uint32_t count = static_cast<uint32_t>(m_payloads.size());
+	for (uint32_t base = 0; base < count; base += 4)
+	{
+		const XMVECTOR centerX = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_centerX[base]));
+		const XMVECTOR centerY = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_centerY[base]));
+		const XMVECTOR centerZ = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_centerZ[base]));
+		const XMVECTOR extentX = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_extentX[base]));
+		const XMVECTOR extentY = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_extentY[base]));
+		const XMVECTOR extentZ = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_extentZ[base]));
+		// Χĵƽľڷ߷ϵͶӰ뾶ʱΧȫλƽ
+		XMVECTOR outside = XMVectorFalseInt();
+		for (const auto& plane : pass.planes)
+		{
+			XMVECTOR dist = XMVectorMultiplyAdd(centerX, XMVectorReplicate(plane.x), XMVectorReplicate(plane.w));
+			dist = XMVectorMultiplyAdd(centerY, XMVectorReplicate(plane.y), dist);
+			dist = XMVectorMultiplyAdd(centerZ, XMVectorReplicate(plane.z), dist);
+			XMVECTOR radius = XMVectorMultiply(extentX, XMVectorReplicate(std::abs(plane.x)));
+			radius = XMVectorMultiplyAdd(extentY, XMVectorReplicate(std::abs(plane.y)), radius);
+			radius = XMVectorMultiplyAdd(extentZ, XMVectorReplicate(std::abs(plane.z)), radius);
+			outside = XMVectorOrInt(outside, XMVectorGreater(dist, radius));
+		}
+		XMUINT4 mask;
+		XMStoreUInt4(&mask, outside);
+		const uint32_t laneMask[4] = { mask.x, mask.y, mask.z, mask.w };
+		const uint32_t lanes = std::min(4U, count - base);
+		for (uint32_t lane = 0; lane < lanes; ++lane)
+		{
+			const uint32_t idx = base + lane;
+			if (laneMask[lane] == 0 || m_alwaysVisible[idx])
+			{
+				pass.visible.emplace_back(m_payloads[idx]);
+			}
+		}
+	}
+	pass.stats.visible = static_cast<uint32_t>(pass.visible.size());
+	pass.stats.culled = count - pass.stats.visible;
+}
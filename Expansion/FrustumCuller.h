@@ -0,0 +1,74 @@
+#pragma once
+
+#include <DirectXCollision.h>
+#include <cstdint>
+#include <vector>
+
+/*
+ * ÿpass޳ͳ
+ */
+struct CullStats
+{
+	uint32_t	visible{ 0 };
+	uint32_t	culled{ 0 };
+};
+
+/*
+ * ڰΧе׶޳D3D豸
+ * ΧSoAʽţÿһXMVECTORͬʱ4ΧУ
+ * ÿΧиһ÷payload(Ⱦ±)ÿpass˳ɼpayload
+ * ƽDirectX::BoundingFrustumԼһ£߳⣬pƽڲ൱ҽdot(n, p) + d <= 0
+ */
+class FrustumCuller
+{
+public:
+	static constexpr uint32_t planeCount = 6;
+
+	FrustumCuller() = default;
+	FrustumCuller(const FrustumCuller&) = delete;
+	FrustumCuller& operator=(const FrustumCuller&) = delete;
+	FrustumCuller(FrustumCuller&&) = default;
+	FrustumCuller& operator=(FrustumCuller&&) = default;
+	~FrustumCuller() = default;
+
+	// ViewProjectionȡռµ6ƽ(ȷΧ[0, 1]reverse-Z)
+	static void ExtractPlanes(DirectX::FXMMATRIX viewProj, DirectX::XMFLOAT4* planes);
+
+	// հΧpass
+	void Reset();
+	// һ޳Χ
+	void AddItem(const DirectX::BoundingBox& bounds, uint32_t payload);
+	// һǿɼ(ûаΧеȾ)
+	void AddAlwaysVisible(uint32_t payload);
+	// һpassplanesΪplaneCountռµƽ棬pass
+	uint32_t AddPass(const DirectX::XMFLOAT4* planes);
+	// pass֮以̳߳в޳
+	void Cull();
+
+	uint32_t GetItemCount() const;
+	uint32_t GetPassCount() const;
+	const std::vector<uint32_t>& GetVisible(uint32_t passIdx) const;
+	const CullStats& GetStats(uint32_t passIdx) const;
+private:
+	uint32_t AppendItem(uint32_t payload, bool alwaysVisible);
+	void CullPass(uint32_t passIdx);
+private:
+	struct Pass
+	{
+		DirectX::XMFLOAT4		planes[planeCount];
+		std::vector<uint32_t>	visible;
+		CullStats				stats;
+	};
+
+	std::vector<uint32_t>		m_payloads;
+	// Χ볤ȲΪ4ı
+	std::vector<float>			m_centerX;
+	std::vector<float>			m_centerY;
+	std::vector<float>			m_centerZ;
+	std::vector<float>			m_extentX;
+	std::vector<float>			m_extentY;
+	std::vector<float>			m_extentZ;
+	// AddAlwaysVisibleӵ
+	std::vector<uint8_t>		m_alwaysVisible;
+	std::vector<Pass>			m_passes;
+};
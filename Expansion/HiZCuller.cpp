@@ -0,0 +1,246 @@
+#include "HiZCuller.h"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+void HiZCuller::Downsample(const float* ndcDepth, uint32_t width, uint32_t height, uint32_t rowPitch, uint32_t outWidth, uint32_t outHeight, float* out)
+{
+	// Shaders/Compute/HiZReadback.hlsl֣ͬǷΧȡtexelܹ߽
+	for (uint32_t y = 0; y < outHeight; ++y)
+	{
+		const uint32_t startY = y * height / outHeight;
+		const uint32_t endY = std::min(((y + 1) * height + outHeight - 1) / outHeight, height);
+		for (uint32_t x = 0; x < outWidth; ++x)
+		{
+			const uint32_t startX = x * width / outWidth;
+			const uint32_t endX = std::min(((x + 1) * width + outWidth - 1) / outWidth, width);
+			float farthest = 1.0f;
+			for (uint32_t sy = startY; sy < endY; ++sy)
+			{
+				const float* row = ndcDepth + static_cast<size_t>(sy) * rowPitch;
+				for (uint32_t sx = startX; sx < endX; ++sx)
+				{
+					farthest = std::min(farthest, row[sx]);
+				}
+			}
+			out[static_cast<size_t>(y) * outWidth + x] = farthest;
+		}
+	}
+}
+
+void HiZCuller::Reproject(const float* prevDepth, uint32_t width, uint32_t height, FXMMATRIX prevViewProj, CXMMATRIX currViewProj, float* out)
+{
+	const size_t count = static_cast<size_t>(width) * height;
+	std::fill(out, out + count, emptyDepth);
+	// һ֡NDC꾭صε꣬wΪֱӳԵǰViewProjection
+	const XMMATRIX reprojection = XMMatrixMultiply(XMMatrixInverse(nullptr, prevViewProj), currViewProj);
+	const float fw = static_cast<float>(width);
+	const float fh = static_cast<float>(height);
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		const float ndcY = 1.0f - (static_cast<float>(y) + 0.5f) / fh * 2.0f;
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			const float depth = prevDepth[static_cast<size_t>(y) * width + x];
+			if (depth <= 0.0f)
+				continue;
+			const float ndcX = (static_cast<float>(x) + 0.5f) / fw * 2.0f - 1.0f;
+			XMFLOAT4 clip;
+			XMStoreFloat4(&clip, XMVector4Transform(XMVectorSet(ndcX, ndcY, depth, 1.0f), reprojection));
+			if (clip.w <= 0.0f)
+				continue;
+			const float invW = 1.0f / clip.w;
+			const float screenX = (clip.x * invW * 0.5f + 0.5f) * fw;
+			const float screenY = (0.5f - clip.y * invW * 0.5f) * fh;
+			if (!(screenX >= 0.0f && screenX < fw && screenY >= 0.0f && screenY < fh))
+				continue;
+			// Ƶƽ֮ǰڵκ
+			const float reprojected = clip.z * invW;
+			if (reprojected > 1.0f)
+				continue;
+			float& target = out[static_cast<size_t>(screenY) * width + static_cast<size_t>(screenX)];
+			target = target == emptyDepth ? reprojected : std::min(target, reprojected);
+		}
+	}
+
+	std::vector<float> filled(out, out + count);
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			const size_t idx = static_cast<size_t>(y) * width + x;
+			if (out[idx] != emptyDepth)
+				continue;
+			// Եھ(ˮƽֱԽ)ʱΪѷ
+			float farthest = 0.0f;
+			if (x > 0 && x + 1 < width && y > 0 && y + 1 < height)
+			{
+				const float neighbors[4][2] = {
+					{ out[idx - 1], out[idx + 1] },
+					{ out[idx - width], out[idx + width] },
+					{ out[idx - width - 1], out[idx + width + 1] },
+					{ out[idx - width + 1], out[idx + width - 1] } };
+				bool crack = false;
+				float neighborFarthest = 1.0f;
+				for (const auto& pair : neighbors)
+				{
+					crack = crack || (pair[0] != emptyDepth && pair[1] != emptyDepth);
+					for (const float depth : pair)
+					{
+						if (depth != emptyDepth)
+							neighborFarthest = std::min(neighborFarthest, depth);
+					}
+				}
+				if (crack)
+					farthest = neighborFarthest;
+			}
+			filled[idx] = farthest;
+		}
+	}
+	std::copy(filled.begin(), filled.end(), out);
+}
+
+void HiZCuller::Build(const float* depth, uint32_t width, uint32_t height)
+{
+	assert(width > 0 && height > 0);
+	m_levels.clear();
+	size_t total = 0;
+	for (uint32_t w = width, h = height;; w = (w + 1) / 2, h = (h + 1) / 2)
+	{
+		m_levels.push_back({ w, h, total });
+		total += static_cast<size_t>(w) * h;
+		if (w == 1 && h == 1)
+			break;
+	}
+	m_depth.resize(total);
+	std::copy(depth, depth + static_cast<size_t>(width) * height, m_depth.begin());
+	// һ2x2ȡԶȣߴΪʱһ()ֻһtexel
+	for (size_t level = 1; level < m_levels.size(); ++level)
+	{
+		const Level& src = m_levels[level - 1];
+		const Level& dst = m_levels[level];
+		for (uint32_t y = 0; y < dst.height; ++y)
+		{
+			const uint32_t y0 = 2 * y;
+			const uint32_t y1 = std::min(y0 + 1, src.height - 1);
+			for (uint32_t x = 0; x < dst.width; ++x)
+			{
+				const uint32_t x0 = 2 * x;
+				const uint32_t x1 = std::min(x0 + 1, src.width - 1);
+				const float* s = m_depth.data() + src.offset;
+				m_depth[dst.offset + static_cast<size_t>(y) * dst.width + x] = std::min({ s[static_cast<size_t>(y0) * src.width + x0], s[static_cast<size_t>(y0) * src.width + x1],
+					s[static_cast<size_t>(y1) * src.width + x0], s[static_cast<size_t>(y1) * src.width + x1] });
+			}
+		}
+	}
+}
+
+bool HiZCuller::IsVisible(const BoundingBox& worldBox, FXMMATRIX viewProj)
+{
+	++m_stats.tested;
+	const bool visible = Test(worldBox, viewProj);
+	if (!visible)
+		++m_stats.occluded;
+	return visible;
+}
+
+void HiZCuller::Evaluate(const BoundingBox& worldBox, bool culled, FXMMATRIX viewProj, HiZErrorStats& stats) const
+{
+	++stats.tested;
+	const bool visible = Test(worldBox, viewProj);
+	if (culled && visible)
+		++stats.falsePositive;
+	else if (!culled && !visible)
+		++stats.falseNegative;
+}
+
+void HiZCuller::ResetStats()
+{
+	m_stats = HiZStats{};
+}
+
+bool HiZCuller::IsValid() const
+{
+	return !m_levels.empty();
+}
+
+uint32_t HiZCuller::GetLevelCount() const
+{
+	return static_cast<uint32_t>(m_levels.size());
+}
+
+uint32_t HiZCuller::GetWidth(uint32_t level) const
+{
+	return m_levels[level].width;
+}
+
+uint32_t HiZCuller::GetHeight(uint32_t level) const
+{
+	return m_levels[level].height;
+}
+
+float HiZCuller::GetDepth(uint32_t level, uint32_t x, uint32_t y) const
+{
+	const Level& l = m_levels[level];
+	assert(x < l.width && y < l.height);
+	return m_depth[l.offset + static_cast<size_t>(y) * l.width + x];
+}
+
+const HiZStats& HiZCuller::GetStats() const
+{
+	return m_stats;
+}
+
+bool HiZCuller::Test(const BoundingBox& worldBox, FXMMATRIX viewProj) const
+{
+	if (m_levels.empty())
+		return true;
+	const float width = static_cast<float>(m_levels[0].width);
+	const float height = static_cast<float>(m_levels[0].height);
+	XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+	worldBox.GetCorners(corners);
+	float nearest = 0.0f;
+	float minX = FLT_MAX, minY = FLT_MAX;
+	float maxX = -FLT_MAX, maxY = -FLT_MAX;
+	for (const auto& corner : corners)
+	{
+		XMFLOAT4 clip;
+		XMStoreFloat4(&clip, XMVector3Transform(XMLoadFloat3(&corner), viewProj));
+		if (clip.w <= 0.0f)
+			return true;
+		const float invW = 1.0f / clip.w;
+		const float screenX = (clip.x * invW * 0.5f + 0.5f) * width;
+		const float screenY = (0.5f - clip.y * invW * 0.5f) * height;
+		nearest = std::max(nearest, clip.z * invW);
+		minX = std::min(minX, screenX);
+		maxX = std::max(maxX, screenX);
+		minY = std::min(minY, screenY);
+		maxY = std::max(maxY, screenY);
+	}
+	// ZNDCȴ1Ķλڽƽ֮ǰ
+	if (nearest >= 1.0f)
+		return true;
+	const int32_t texelMinX = std::max(static_cast<int32_t>(std::floor(std::clamp(minX, -1.0f, width))), 0);
+	const int32_t texelMaxX = std::min(static_cast<int32_t>(std::floor(std::clamp(maxX, -1.0f, width))), static_cast<int32_t>(m_levels[0].width) - 1);
+	const int32_t texelMinY = std::max(static_cast<int32_t>(std::floor(std::clamp(minY, -1.0f, height))), 0);
+	const int32_t texelMaxY = std::min(static_cast<int32_t>(std::floor(std::clamp(maxY, -1.0f, height))), static_cast<int32_t>(m_levels[0].height) - 1);
+	if (texelMinX > texelMaxX || texelMinY > texelMaxY)
+		return false;
+
+	// ѡĻΧ2x2texelĲ㼶ֻ߲һtexelѭȻ
+	uint32_t level = 0;
+	while (level + 1 < m_levels.size() && ((texelMaxX >> level) - (texelMinX >> level) > 1 || (texelMaxY >> level) - (texelMinY >> level) > 1))
+		++level;
+	float farthest = 1.0f;
+	for (int32_t y = texelMinY >> level; y <= texelMaxY >> level; ++y)
+	{
+		for (int32_t x = texelMinX >> level; x <= texelMaxX >> level; ++x)
+		{
+			farthest = std::min(farthest, GetDepth(level, static_cast<uint32_t>(x), static_cast<uint32_t>(y)));
+		}
+	}
+	return nearest >= farthest;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <DirectXCollision.h>
+#include <cstdint>
+#include <vector>
+
+/*
+ * ÿ޳ͳ
+ */
+struct HiZStats
+{
+	uint32_t	tested{ 0 };
+	uint32_t	occluded{ 0 };
+};
+
+/*
+ * ʵΪ׼жfalsePositiveΪ޳ʵʿɼfalseNegativeΪδ޳ʵʱڵ
+ */
+struct HiZErrorStats
+{
+	uint32_t	tested{ 0 };
+	uint32_t	falsePositive{ 0 };
+	uint32_t	falseNegative{ 0 };
+};
+
+/*
+ * ڻضȵĲ㼶Z(HZB)ڵ޳D3D豸
+ * ΪZµNDCȣ0Ϊգÿtexel串ǷΧԶ(С)
+ * 1. DownsampleΪGPUĲοʵ
+ * 2. ReprojectѼ֡ǰͶӰǰViewProjection
+ * 3. BuildԶȵĲ㼶IsVisibleѡΧĻΧ2x2texelĲ㼶в
+ */
+class HiZCuller
+{
+public:
+	// ͶӰûtexel
+	static constexpr float emptyDepth = -1.0f;
+
+	HiZCuller() = default;
+	HiZCuller(const HiZCuller&) = delete;
+	HiZCuller& operator=(const HiZCuller&) = delete;
+	HiZCuller(HiZCuller&&) = default;
+	HiZCuller& operator=(HiZCuller&&) = default;
+	~HiZCuller() = default;
+
+	// ÿtexelȡ串ǵԶȣrowPitchfloatΪλ
+	static void Downsample(const float* ndcDepth, uint32_t width, uint32_t height, uint32_t rowPitch, uint32_t outWidth, uint32_t outHeight, float* out);
+	/*
+	 * texelİprevViewProjµͶӰcurrViewProjͬһtexelʱȡԶ
+	 * ǰʱŴһtexelѷ죬ԵھӶĿն԰Զ䣻նΪ±¶Ϊ
+	 */
+	static void Reproject(const float* prevDepth, uint32_t width, uint32_t height, DirectX::FXMMATRIX prevViewProj, DirectX::CXMMATRIX currViewProj, float* out);
+
+	// depthΪѶӦǰViewProjectionĵ0
+	void Build(const float* depth, uint32_t width, uint32_t height);
+	// ռΧǷܿɼBuild֮ǰΧдƽʱǿɼ
+	bool IsVisible(const DirectX::BoundingBox& worldBox, DirectX::FXMMATRIX viewProj);
+	// Ա㼶Ϊʵȣͳculledһж
+	void Evaluate(const DirectX::BoundingBox& worldBox, bool culled, DirectX::FXMMATRIX viewProj, HiZErrorStats& stats) const;
+	void ResetStats();
+
+	bool IsValid() const;
+	uint32_t GetLevelCount() const;
+	uint32_t GetWidth(uint32_t level) const;
+	uint32_t GetHeight(uint32_t level) const;
+	float GetDepth(uint32_t level, uint32_t x, uint32_t y) const;
+	const HiZStats& GetStats() const;
+private:
+	bool Test(const DirectX::BoundingBox& worldBox, DirectX::FXMMATRIX viewProj) const;
+private:
+	struct Level
+	{
+		uint32_t	width;
+		uint32_t	height;
+		size_t		offset;
+	};
+
+	std::vector<Level>	m_levels;
+	std::vector<float>	m_depth;
+	HiZStats			m_stats;
+};
@@ -74,13 +74,13 @@ public:
 	Light& operator=(const Light&) = default;
 	Light(Light&&) = default;
 	Light& operator=(Light&&) = default;
-	void MovePos(const XMFLOAT3& pos) const
+	void MovePos(const DirectX::XMFLOAT3& pos) const
 	{
 		m_lightData->posV = std::move(pos);
 	}
-	void MovePos(const XMVECTOR& pos) const
+	void MovePos(const DirectX::XMVECTOR& pos) const
 	{
-		XMStoreFloat3(&m_lightData->posV, pos);
+		DirectX::XMStoreFloat3(&m_lightData->posV, pos);
 	}
 	const LightInCompute& GetData() const {
 		return *m_lightData.get();
@@ -0,0 +1,438 @@
+#include "MaskedOcclusionCuller.h"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+// Ϊʱȣκζ
+constexpr float emptyLayerDepth = FLT_MAX;
+
+float TriangleArea(FXMVECTOR p0, FXMVECTOR p1, FXMVECTOR p2)
+{
+	return 0.5f * XMVectorGetX(XMVector3Length(XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0))));
+}
+}
+
+uint32_t OccluderMesh::GetTriangleCount() const
+{
+	return static_cast<uint32_t>(vertices.size() / 3);
+}
+
+void OccluderMesh::Append(const XMFLOAT3* positions, size_t stride, const uint32_t* indices, uint32_t indexCount, FXMMATRIX world, float minArea)
+{
+	// λÿǸĶṹеһԱֽڲѰַ
+	const auto* base = reinterpret_cast<const uint8_t*>(positions);
+	const auto load = [base, stride, &world](uint32_t index)
+	{
+		return XMVector3TransformCoord(XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(base + stride * index)), world);
+	};
+	for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		const XMVECTOR p0 = load(indices[i]);
+		const XMVECTOR p1 = load(indices[i + 1]);
+		const XMVECTOR p2 = load(indices[i + 2]);
+		if (TriangleArea(p0, p1, p2) < minArea)
+			continue;
+		vertices.resize(vertices.size() + 3);
+		XMStoreFloat3(&vertices[vertices.size() - 3], p0);
+		XMStoreFloat3(&vertices[vertices.size() - 2], p1);
+		XMStoreFloat3(&vertices[vertices.size() - 1], p2);
+	}
+}
+
+void OccluderMesh::Simplify(uint32_t maxTriangles)
+{
+	const uint32_t count = GetTriangleCount();
+	if (count <= maxTriangles)
+		return;
+	std::vector<float> areas(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		areas[i] = TriangleArea(XMLoadFloat3(&vertices[3 * i]), XMLoadFloat3(&vertices[3 * i + 1]), XMLoadFloat3(&vertices[3 * i + 2]));
+	}
+	std::vector<uint32_t> order(count);
+	std::iota(order.begin(), order.end(), 0U);
+	std::nth_element(order.begin(), order.begin() + maxTriangles, order.end(), [&areas](uint32_t lhs, uint32_t rhs) { return areas[lhs] > areas[rhs]; });
+	order.resize(maxTriangles);
+	// ԭе˳򣬽㷨޹
+	std::sort(order.begin(), order.end());
+	std::vector<XMFLOAT3> kept;
+	kept.reserve(static_cast<size_t>(maxTriangles) * 3);
+	for (const uint32_t tri : order)
+	{
+		kept.insert(kept.end(), vertices.begin() + 3 * tri, vertices.begin() + 3 * tri + 3);
+	}
+	vertices = std::move(kept);
+}
+
+MaskedOcclusionCuller::MaskedOcclusionCuller(uint32_t width, uint32_t height, bool allowSimd)
+: m_tilesX((std::max(width, 1u) + tileWidth - 1) / tileWidth), m_tilesY((std::max(height, 1u) + tileHeight - 1) / tileHeight)
+{
+	m_width = m_tilesX * tileWidth;
+	m_height = m_tilesY * tileHeight;
+#if defined(__AVX2__)
+	m_useSimd = allowSimd;
+#else
+	m_useSimd = false;
+	(void)allowSimd;
+#endif
+	m_tiles.resize(static_cast<size_t>(m_tilesX) * m_tilesY);
+	Clear(0.0f);
+}
+
+void MaskedOcclusionCuller::Clear(float nearZ)
+{
+	m_nearZ = nearZ;
+	for (auto& tile : m_tiles)
+	{
+		std::fill(std::begin(tile.mask), std::end(tile.mask), 0u);
+		tile.zFar0 = 0.0f;
+		tile.zFar1 = emptyLayerDepth;
+	}
+	m_stats = OcclusionStats{};
+}
+
+void MaskedOcclusionCuller::RenderOccluder(const OccluderMesh& occluder, FXMMATRIX viewProj)
+{
+	const uint32_t triangleCount = occluder.GetTriangleCount();
+	for (uint32_t tri = 0; tri < triangleCount; ++tri)
+	{
+		XMFLOAT4 clip[3];
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			XMStoreFloat4(&clip[i], XMVector3Transform(XMLoadFloat3(&occluder.vertices[3 * tri + i]), viewProj));
+		}
+		// 㶼ͬһüƽʱβɼ
+		const auto allOutside = [&clip](auto&& outside) { return outside(clip[0]) && outside(clip[1]) && outside(clip[2]); };
+		if (allOutside([this](const XMFLOAT4& v) { return v.w < m_nearZ; }) ||
+			allOutside([](const XMFLOAT4& v) { return v.x > v.w; }) || allOutside([](const XMFLOAT4& v) { return v.x < -v.w; }) ||
+			allOutside([](const XMFLOAT4& v) { return v.y > v.w; }) || allOutside([](const XMFLOAT4& v) { return v.y < -v.w; }))
+			continue;
+		RasterizeClipped(clip);
+	}
+}
+
+bool MaskedOcclusionCuller::IsVisible(const BoundingBox& worldBox, FXMMATRIX viewProj)
+{
+	++m_stats.tested;
+	XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+	worldBox.GetCorners(corners);
+	float minW = FLT_MAX;
+	float minX = FLT_MAX, minY = FLT_MAX;
+	float maxX = -FLT_MAX, maxY = -FLT_MAX;
+	for (const auto& corner : corners)
+	{
+		XMFLOAT4 clip;
+		XMStoreFloat4(&clip, XMVector3Transform(XMLoadFloat3(&corner), viewProj));
+		// ƽİΧ޷õصĻΧ
+		if (clip.w < m_nearZ)
+			return true;
+		const float invW = 1.0f / clip.w;
+		const float screenX = (clip.x * invW * 0.5f + 0.5f) * static_cast<float>(m_width);
+		const float screenY = (0.5f - clip.y * invW * 0.5f) * static_cast<float>(m_height);
+		minW = std::min(minW, clip.w);
+		minX = std::min(minX, screenX);
+		maxX = std::max(maxX, screenX);
+		minY = std::min(minY, screenY);
+		maxY = std::max(maxY, screenY);
+	}
+	// ĻΧȡǵأٰһ
+	const int32_t pixelMinX = std::max(static_cast<int32_t>(std::floor(std::clamp(minX, -1.0f, static_cast<float>(m_width)))), 0);
+	const int32_t pixelMaxX = std::min(static_cast<int32_t>(std::floor(std::clamp(maxX, -1.0f, static_cast<float>(m_width)))), static_cast<int32_t>(m_width) - 1);
+	const int32_t pixelMinY = std::max(static_cast<int32_t>(std::floor(std::clamp(minY, -1.0f, static_cast<float>(m_height)))), 0);
+	const int32_t pixelMaxY = std::min(static_cast<int32_t>(std::floor(std::clamp(maxY, -1.0f, static_cast<float>(m_height)))), static_cast<int32_t>(m_height) - 1);
+	if (pixelMinX > pixelMaxX || pixelMinY > pixelMaxY)
+	{
+		++m_stats.occluded;
+		return false;
+	}
+
+	const float nearest = 1.0f / minW;
+	for (int32_t ty = pixelMinY / static_cast<int32_t>(tileHeight); ty <= pixelMaxY / static_cast<int32_t>(tileHeight); ++ty)
+	{
+		const int32_t tileY = ty * static_cast<int32_t>(tileHeight);
+		const int32_t rowStart = std::max(pixelMinY - tileY, 0);
+		const int32_t rowEnd = std::min(pixelMaxY - tileY, static_cast<int32_t>(tileHeight) - 1);
+		for (int32_t tx = pixelMinX / static_cast<int32_t>(tileWidth); tx <= pixelMaxX / static_cast<int32_t>(tileWidth); ++tx)
+		{
+			const Tile& tile = m_tiles[static_cast<size_t>(ty) * m_tilesX + tx];
+			if (nearest < tile.zFar0)
+				continue;
+			// ο޷ڵʱΧڷֿڵȫλڹԶڹ
+			if (nearest >= tile.zFar1)
+				return true;
+			const int32_t tileX = tx * static_cast<int32_t>(tileWidth);
+			const uint32_t colStart = static_cast<uint32_t>(std::max(pixelMinX - tileX, 0));
+			const uint32_t colEnd = static_cast<uint32_t>(std::min(pixelMaxX - tileX, static_cast<int32_t>(tileWidth) - 1));
+			const uint32_t columns = (colEnd - colStart == 31u ? ~0u : ((1u << (colEnd - colStart + 1)) - 1u)) << colStart;
+			for (int32_t row = rowStart; row <= rowEnd; ++row)
+			{
+				if (columns & ~tile.mask[row])
+					return true;
+			}
+		}
+	}
+	++m_stats.occluded;
+	return false;
+}
+
+float MaskedOcclusionCuller::GetPixelDepth(uint32_t x, uint32_t y) const
+{
+	assert(x < m_width && y < m_height);
+	const Tile& tile = m_tiles[static_cast<size_t>(y / tileHeight) * m_tilesX + x / tileWidth];
+	const bool inWorkingLayer = (tile.mask[y % tileHeight] >> (x % tileWidth)) & 1u;
+	return inWorkingLayer ? std::max(tile.zFar0, tile.zFar1) : tile.zFar0;
+}
+
+const OcclusionStats& MaskedOcclusionCuller::GetStats() const
+{
+	return m_stats;
+}
+
+uint32_t MaskedOcclusionCuller::GetWidth() const
+{
+	return m_width;
+}
+
+uint32_t MaskedOcclusionCuller::GetHeight() const
+{
+	return m_height;
+}
+
+bool MaskedOcclusionCuller::UsesSimd() const
+{
+	return m_useSimd;
+}
+
+void MaskedOcclusionCuller::RasterizeClipped(const XMFLOAT4* clipVertices)
+{
+	// Խƽw = nearZüΪı
+	XMFLOAT4 polygon[4];
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		const XMFLOAT4& a = clipVertices[i];
+		const XMFLOAT4& b = clipVertices[(i + 1) % 3];
+		const float da = a.w - m_nearZ;
+		const float db = b.w - m_nearZ;
+		if (da >= 0.0f)
+			polygon[count++] = a;
+		if ((da >= 0.0f) != (db >= 0.0f))
+		{
+			const float t = da / (da - db);
+			polygon[count++] = XMFLOAT4(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, m_nearZ);
+		}
+	}
+	if (count < 3)
+		return;
+	XMFLOAT3 screen[4];
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const float invW = 1.0f / polygon[i].w;
+		screen[i].x = (polygon[i].x * invW * 0.5f + 0.5f) * static_cast<float>(m_width);
+		screen[i].y = (0.5f - polygon[i].y * invW * 0.5f) * static_cast<float>(m_height);
+		screen[i].z = invW;
+	}
+	RasterizeTriangle(screen);
+	if (count == 4)
+	{
+		const XMFLOAT3 second[3] = { screen[0], screen[2], screen[3] };
+		RasterizeTriangle(second);
+	}
+}
+
+void MaskedOcclusionCuller::RasterizeTriangle(const XMFLOAT3* v)
+{
+	const float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+	if (!(std::abs(area) > 1e-6f))
+		return;
+	// ޳ֻƷͳһΪڲǸ
+	const float sign = area > 0.0f ? 1.0f : -1.0f;
+	TriangleSetup setup;
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		const XMFLOAT3& a = v[i];
+		const XMFLOAT3& b = v[(i + 1) % 3];
+		setup.edgeA[i] = (a.y - b.y) * sign;
+		setup.edgeB[i] = (b.x - a.x) * sign;
+		setup.edgeC[i] = -(setup.edgeA[i] * a.x + setup.edgeB[i] * a.y);
+	}
+	const float invArea = 1.0f / area;
+	setup.depthA = ((v[1].z - v[0].z) * (v[2].y - v[0].y) - (v[2].z - v[0].z) * (v[1].y - v[0].y)) * invArea;
+	setup.depthB = ((v[1].x - v[0].x) * (v[2].z - v[0].z) - (v[2].x - v[0].x) * (v[1].z - v[0].z)) * invArea;
+	setup.depthC = v[0].z - setup.depthA * v[0].x - setup.depthB * v[0].y;
+	setup.minDepth = std::min({ v[0].z, v[1].z, v[2].z });
+	setup.maxDepth = std::max({ v[0].z, v[1].z, v[2].z });
+
+	const float width = static_cast<float>(m_width);
+	const float height = static_cast<float>(m_height);
+	const int32_t minX = std::max(static_cast<int32_t>(std::floor(std::clamp(std::min({ v[0].x, v[1].x, v[2].x }), -1.0f, width))), 0);
+	const int32_t maxX = std::min(static_cast<int32_t>(std::floor(std::clamp(std::max({ v[0].x, v[1].x, v[2].x }), -1.0f, width))), static_cast<int32_t>(m_width) - 1);
+	const int32_t minY = std::max(static_cast<int32_t>(std::floor(std::clamp(std::min({ v[0].y, v[1].y, v[2].y }), -1.0f, height))), 0);
+	const int32_t maxY = std::min(static_cast<int32_t>(std::floor(std::clamp(std::max({ v[0].y, v[1].y, v[2].y }), -1.0f, height))), static_cast<int32_t>(m_height) - 1);
+	if (minX > maxX || minY > maxY)
+		return;
+	++m_stats.occluderTriangles;
+
+	alignas(32) uint32_t rowMasks[tileHeight];
+	for (int32_t ty = minY / static_cast<int32_t>(tileHeight); ty <= maxY / static_cast<int32_t>(tileHeight); ++ty)
+	{
+		const float tileY = static_cast<float>(ty * static_cast<int32_t>(tileHeight));
+		for (int32_t tx = minX / static_cast<int32_t>(tileWidth); tx <= maxX / static_cast<int32_t>(tileWidth); ++tx)
+		{
+			const float tileX = static_cast<float>(tx * static_cast<int32_t>(tileWidth));
+			ComputeCoverage(setup, tileX, tileY, rowMasks);
+			uint32_t any = 0;
+			for (const uint32_t row : rowMasks)
+				any |= row;
+			if (!any)
+				continue;
+			// ƽڷֿĸϵļֵԶȵķΧս
+			const float d00 = setup.depthA * tileX + setup.depthB * tileY + setup.depthC;
+			const float dx = setup.depthA * static_cast<float>(tileWidth);
+			const float dy = setup.depthB * static_cast<float>(tileHeight);
+			const float cornerMin = d00 + std::min(dx, 0.0f) + std::min(dy, 0.0f);
+			const float cornerMax = d00 + std::max(dx, 0.0f) + std::max(dy, 0.0f);
+			const float triFar = std::max(setup.minDepth, cornerMin);
+			const float triNear = std::min(setup.maxDepth, cornerMax);
+			UpdateTile(m_tiles[static_cast<size_t>(ty) * m_tilesX + tx], rowMasks, triFar, triNear);
+		}
+	}
+}
+
+void MaskedOcclusionCuller::ComputeCoverage(const TriangleSetup& setup, float tileX, float tileY, uint32_t* rowMasks) const
+{
+#if defined(__AVX2__)
+	if (m_useSimd)
+	{
+		ComputeCoverageAVX2(setup, tileX, tileY, rowMasks);
+		return;
+	}
+#endif
+	ComputeCoverageScalar(setup, tileX, tileY, rowMasks);
+}
+
+void MaskedOcclusionCuller::UpdateTile(Tile& tile, const uint32_t* rowMasks, float triFar, float triNear) const
+{
+	// λڲο֮󣬲ıڵϢ
+	if (triNear <= tile.zFar0)
+		return;
+	// αȹöʱ㣬ϢǱص
+	const bool discard = triFar - tile.zFar1 > tile.zFar1 - tile.zFar0;
+	if (discard)
+		tile.zFar1 = emptyLayerDepth;
+#if defined(__AVX2__)
+	const bool full = m_useSimd ? MergeMaskAVX2(tile, rowMasks, discard) : MergeMaskScalar(tile, rowMasks, discard);
+#else
+	const bool full = MergeMaskScalar(tile, rowMasks, discard);
+#endif
+	tile.zFar1 = std::min(tile.zFar1, triFar);
+	// ֿ鶼Զڹ㣬ϲο
+	if (full)
+	{
+		tile.zFar0 = std::max(tile.zFar0, tile.zFar1);
+		tile.zFar1 = emptyLayerDepth;
+		std::fill(std::begin(tile.mask), std::end(tile.mask), 0u);
+	}
+}
+
+/*
+ * ÿÿڵı߽xA > 0ʱ߽ҲڣA < 0ʱ
+ * ߽绻ΪֿڵкŲ[0, 32]λɸе룬λΪ32ʱΪ0
+ * ʵֵ˳ͬλһ
+ */
+void MaskedOcclusionCuller::ComputeCoverageScalar(const TriangleSetup& setup, float tileX, float tileY, uint32_t* rowMasks)
+{
+	const float columnBias = tileX + 0.5f;
+	for (uint32_t row = 0; row < tileHeight; ++row)
+	{
+		const float y = tileY + 0.5f + static_cast<float>(row);
+		uint32_t mask = ~0u;
+		for (uint32_t e = 0; e < 3; ++e)
+		{
+			const float rowValue = setup.edgeB[e] * y + setup.edgeC[e];
+			if (setup.edgeA[e] == 0.0f)
+			{
+				if (!(rowValue >= 0.0f))
+					mask = 0;
+				continue;
+			}
+			const float column = std::clamp(rowValue * (-1.0f / setup.edgeA[e]) - columnBias, -1.0f, 33.0f);
+			if (setup.edgeA[e] > 0.0f)
+			{
+				const int32_t start = std::clamp(static_cast<int32_t>(std::ceil(column)), 0, 32);
+				mask &= start >= 32 ? 0u : ~0u << start;
+			}
+			else
+			{
+				const int32_t shift = std::clamp(31 - static_cast<int32_t>(std::floor(column)), 0, 32);
+				mask &= shift >= 32 ? 0u : ~0u >> shift;
+			}
+		}
+		rowMasks[row] = mask;
+	}
+}
+
+bool MaskedOcclusionCuller::MergeMaskScalar(Tile& tile, const uint32_t* rowMasks, bool discard)
+{
+	if (discard)
+		std::fill(std::begin(tile.mask), std::end(tile.mask), 0u);
+	bool full = true;
+	for (uint32_t row = 0; row < tileHeight; ++row)
+	{
+		tile.mask[row] |= rowMasks[row];
+		full = full && tile.mask[row] == ~0u;
+	}
+	return full;
+}
+
+#if defined(__AVX2__)
+void MaskedOcclusionCuller::ComputeCoverageAVX2(const TriangleSetup& setup, float tileX, float tileY, uint32_t* rowMasks)
+{
+	const float columnBias = tileX + 0.5f;
+	const __m256i ones = _mm256_set1_epi32(-1);
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i maxShift = _mm256_set1_epi32(32);
+	const __m256 rowY = _mm256_add_ps(_mm256_set1_ps(tileY + 0.5f), _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f));
+	__m256i mask = ones;
+	for (uint32_t e = 0; e < 3; ++e)
+	{
+		const __m256 rowValue = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(setup.edgeB[e]), rowY), _mm256_set1_ps(setup.edgeC[e]));
+		if (setup.edgeA[e] == 0.0f)
+		{
+			mask = _mm256_and_si256(mask, _mm256_castps_si256(_mm256_cmp_ps(rowValue, _mm256_setzero_ps(), _CMP_GE_OQ)));
+			continue;
+		}
+		__m256 column = _mm256_sub_ps(_mm256_mul_ps(rowValue, _mm256_set1_ps(-1.0f / setup.edgeA[e])), _mm256_set1_ps(columnBias));
+		column = _mm256_min_ps(_mm256_max_ps(column, _mm256_set1_ps(-1.0f)), _mm256_set1_ps(33.0f));
+		if (setup.edgeA[e] > 0.0f)
+		{
+			const __m256i start = _mm256_min_epi32(_mm256_max_epi32(_mm256_cvttps_epi32(_mm256_ceil_ps(column)), zero), maxShift);
+			mask = _mm256_and_si256(mask, _mm256_sllv_epi32(ones, start));
+		}
+		else
+		{
+			const __m256i last = _mm256_cvttps_epi32(_mm256_floor_ps(column));
+			const __m256i shift = _mm256_min_epi32(_mm256_max_epi32(_mm256_sub_epi32(_mm256_set1_epi32(31), last), zero), maxShift);
+			mask = _mm256_and_si256(mask, _mm256_srlv_epi32(ones, shift));
+		}
+	}
+	_mm256_store_si256(reinterpret_cast<__m256i*>(rowMasks), mask);
+}
+
+bool MaskedOcclusionCuller::MergeMaskAVX2(Tile& tile, const uint32_t* rowMasks, bool discard)
+{
+	__m256i mask = discard ? _mm256_setzero_si256() : _mm256_load_si256(reinterpret_cast<const __m256i*>(tile.mask));
+	mask = _mm256_or_si256(mask, _mm256_load_si256(reinterpret_cast<const __m256i*>(rowMasks)));
+	_mm256_store_si256(reinterpret_cast<__m256i*>(tile.mask), mask);
+	return _mm256_testc_si256(mask, _mm256_set1_epi32(-1)) != 0;
+}
+#endif
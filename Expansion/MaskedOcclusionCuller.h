@@ -0,0 +1,104 @@
+#pragma once
+
+#include <DirectXCollision.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * ڵ壬ռеΣÿ3㹹һ
+ */
+struct OccluderMesh
+{
+	std::vector<DirectX::XMFLOAT3>	vertices;
+
+	uint32_t GetTriangleCount() const;
+	// ׷ռСminAreaΣpositionsΪһλãڶstrideֽ
+	void Append(const DirectX::XMFLOAT3* positions, size_t stride, const uint32_t* indices, uint32_t indexCount, DirectX::FXMMATRIX world, float minArea);
+	// ֻmaxTrianglesΣڵʼʵεӼ޳ֱ
+	void Simplify(uint32_t maxTriangles);
+};
+
+/*
+ * ÿ޳ͳ
+ */
+struct OcclusionStats
+{
+	uint32_t	occluderTriangles{ 0 };	// üդ
+	uint32_t	tested{ 0 };
+	uint32_t	occluded{ 0 };
+};
+
+/*
+ * ڵ޳(Masked Software Occlusion Culling)D3D豸
+ * Ϊ32x8صķֿ飬ÿֿ鱣1λĸ㱣ȣ
+ * zFar0Ϊο㣬ֿÿضڵ岻ԶzFar0zFar1Ϊ㣬еضڵ岻ԶzFar1
+ * εĸAVX2һμֿ8УûAVX2ʱʹýͬıʵ֣ϲο
+ * 1/wʾĻռԲֵֵԽԽ0ʾûڵ
+ */
+class MaskedOcclusionCuller
+{
+public:
+	static constexpr uint32_t	tileWidth = 32;
+	static constexpr uint32_t	tileHeight = 8;
+
+	// ȡֿСNDCӳ䵽allowSimdΪfalseʱʼʹñʵ֣УʵֵĽ
+	MaskedOcclusionCuller(uint32_t width, uint32_t height, bool allowSimd = true);
+	MaskedOcclusionCuller(const MaskedOcclusionCuller&) = delete;
+	MaskedOcclusionCuller& operator=(const MaskedOcclusionCuller&) = delete;
+	MaskedOcclusionCuller(MaskedOcclusionCuller&&) = default;
+	MaskedOcclusionCuller& operator=(MaskedOcclusionCuller&&) = default;
+	~MaskedOcclusionCuller() = default;
+
+	// ÿ֡ʼʱãnearZΪĽƽ棬ƽ֮ǰڵ岻ᱻGPUƣڹդǰü
+	void Clear(float nearZ);
+	void RenderOccluder(const OccluderMesh& occluder, DirectX::FXMMATRIX viewProj);
+	// ռΧǷܿɼƽİΧǿɼ
+	bool IsVisible(const DirectX::BoundingBox& worldBox, DirectX::FXMMATRIX viewProj);
+	// ϱصڵ(1/w)ڵУ
+	float GetPixelDepth(uint32_t x, uint32_t y) const;
+	const OcclusionStats& GetStats() const;
+	uint32_t GetWidth() const;
+	uint32_t GetHeight() const;
+	// ǷʹAVX2ʵ֣ʱδAVX2allowSimdΪfalseʱfalse
+	bool UsesSimd() const;
+private:
+	struct alignas(32) Tile
+	{
+		uint32_t	mask[tileHeight];	// ÿһuintiλӦֿڵi
+		float		zFar0;
+		float		zFar1;
+	};
+	// ĻռеıߺA * x + B * y + CڲΪǸ
+	struct TriangleSetup
+	{
+		float		edgeA[3];
+		float		edgeB[3];
+		float		edgeC[3];
+		float		depthA;	// 1/w = depthA * x + depthB * y + depthC
+		float		depthB;
+		float		depthC;
+		float		minDepth;
+		float		maxDepth;
+	};
+
+	void RasterizeClipped(const DirectX::XMFLOAT4* clipVertices);
+	void RasterizeTriangle(const DirectX::XMFLOAT3* screenVertices);
+	void ComputeCoverage(const TriangleSetup& setup, float tileX, float tileY, uint32_t* rowMasks) const;
+	void UpdateTile(Tile& tile, const uint32_t* rowMasks, float triFar, float triNear) const;
+	static void ComputeCoverageScalar(const TriangleSetup& setup, float tileX, float tileY, uint32_t* rowMasks);
+	static bool MergeMaskScalar(Tile& tile, const uint32_t* rowMasks, bool discard);
+#if defined(__AVX2__)
+	static void ComputeCoverageAVX2(const TriangleSetup& setup, float tileX, float tileY, uint32_t* rowMasks);
+	static bool MergeMaskAVX2(Tile& tile, const uint32_t* rowMasks, bool discard);
+#endif
+private:
+	uint32_t			m_width;
+	uint32_t			m_height;
+	uint32_t			m_tilesX;
+	uint32_t			m_tilesY;
+	bool				m_useSimd;
+	float				m_nearZ{ 0.0f };
+	std::vector<Tile>	m_tiles;
+	OcclusionStats		m_stats;
+};
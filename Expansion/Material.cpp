@@ -14,7 +14,8 @@ INT Material::GetMatIndex()
 
 INT Material::GetMatSize()
 {
-	return matIndex;
+	// matIndex
+	return matIndex + 1;
 }
 
 void Material::CreateMaterial(const std::string& name, std::string_view texName, UINT materialCBIndex, float roughness, const XMFLOAT3& emission, float metalness, BlendType type)
@@ -34,16 +35,22 @@ void Material::CreateMaterial(std::unique_ptr<MaterialData> data)
 
 void Material::Update(const GameTimer& timer, UploaderBuffer<MaterialConstant>* currMatConstant)
 {
+	// 滻仯֡ԴҪд
+	const auto& texMgr = TextureMgr::instance();
+	const bool texturesSwapped = m_textureGeneration != texMgr.GetSwapGeneration();
+	m_textureGeneration = texMgr.GetSwapGeneration();
 	for (auto& [name, mat] : m_data)
 	{
+		if (texturesSwapped)
+			mat->dirtyFlag = frameResourcesCount;
 		// ֻвʳݷ仯Ҫ֡Դ
 		if (mat->dirtyFlag > 0)
 		{
 			MaterialConstant matConstants;
 			matConstants.emission = mat->emission;
-			matConstants.diffuseIndex = mat->diffuseIndex;
-			matConstants.normalIndex = mat->normalIndex;
-			matConstants.metalnessIndex = mat->metalnessIndex;
+			matConstants.diffuseIndex = texMgr.GetSRVIndex(mat->diffuseIndex);
+			matConstants.normalIndex = texMgr.GetSRVIndex(mat->normalIndex);
+			matConstants.metalnessIndex = texMgr.GetSRVIndex(mat->metalnessIndex);
 			currMatConstant->Copy(mat->materialCBIndex, matConstants);
 			// һFrameResourceи
 			mat->dirtyFlag--;
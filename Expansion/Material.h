@@ -14,7 +14,7 @@ struct MaterialData
 	std::string			name;
 	// ʳ
 	UINT				materialCBIndex;
-	// (gAlbedo)SRVе
+	// (gAlbedo)עд볣ʱתΪSRVе
 	UINT				diffuseIndex;
 	// ͼSRVе
 	UINT				normalIndex;
@@ -52,4 +52,5 @@ public:
 	void Update(const GameTimer& timer, UploaderBuffer<MaterialConstant>* currMatConstant);
 private:
 	static INT matIndex;
+	UINT m_textureGeneration{ 0 };
 };
\ No newline at end of file
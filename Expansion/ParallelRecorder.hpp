@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include "ThreadPool.hpp"
+
+/*
+ * һ¼ƿ飺ĳpass[begin, end)Ⱦһ߳¼ƽһб
+ */
+struct RecordChunk
+{
+	uint32_t passIdx{ 0 };
+	uint32_t chunkIdx{ 0 };		// passе
+	uint32_t chunkCount{ 1 };	// passĿ
+	uint32_t begin{ 0 };
+	uint32_t end{ 0 };
+};
+
+/*
+ * նˣ¼߼ֻ˽ӿڡ
+ * D3D12ʵдб豸ʵֻֿ¼Уֿ֤顢˳ȷ
+ */
+template<typename Item>
+class ICommandSink
+{
+public:
+	virtual ~ICommandSink() = default;
+	virtual void BeginChunk(const RecordChunk& chunk) = 0;
+	virtual void DrawItem(const Item& item) = 0;
+	virtual void EndChunk(const RecordChunk& chunk) = 0;
+};
+
+/*
+ * passȾзֳɿ鲢̳߳в¼ơ
+ * ĻֻȡȾkдksinksink˳ύɱ֤봮¼ƵĽһ
+ */
+template<typename Item>
+class ParallelRecorder
+{
+public:
+	ParallelRecorder(uint32_t maxChunksPerPass, uint32_t minItemsPerChunk)
+	: m_maxChunksPerPass(std::max(1U, maxChunksPerPass)), m_minItemsPerChunk(std::max(1U, minItemsPerChunk))
+	{
+	}
+	ParallelRecorder(const ParallelRecorder&) = delete;
+	ParallelRecorder& operator=(const ParallelRecorder&) = delete;
+	ParallelRecorder(ParallelRecorder&&) = default;
+	ParallelRecorder& operator=(ParallelRecorder&&) = default;
+	~ParallelRecorder() = default;
+
+	static std::vector<RecordChunk> SplitChunks(uint32_t passIdx, uint32_t itemCount, uint32_t maxChunks, uint32_t minItemsPerChunk)
+	{
+		// Ⱦʱֵò̵֣߳޹
+		uint32_t chunkCount = (itemCount + minItemsPerChunk - 1) / minItemsPerChunk;
+		chunkCount = std::clamp(chunkCount, 1U, maxChunks);
+		const uint32_t base = itemCount / chunkCount;
+		const uint32_t remain = itemCount % chunkCount;
+
+		std::vector<RecordChunk> chunks(chunkCount);
+		uint32_t start = 0;
+		for (uint32_t i = 0; i < chunkCount; ++i)
+		{
+			const uint32_t size = base + (i < remain ? 1 : 0);
+			chunks[i].passIdx = passIdx;
+			chunks[i].chunkIdx = i;
+			chunks[i].chunkCount = chunkCount;
+			chunks[i].begin = start;
+			chunks[i].end = start + size;
+			start += size;
+		}
+		return chunks;
+	}
+
+	// һ֡pass
+	void Reset()
+	{
+		m_passes.clear();
+		m_chunks.clear();
+	}
+
+	// һpasspassţûȾpassҲռһ飬Աִ״̬
+	uint32_t AddPass(const std::vector<Item*>& items)
+	{
+		const uint32_t passIdx = static_cast<uint32_t>(m_passes.size());
+		m_passes.emplace_back(&items);
+		auto chunks = SplitChunks(passIdx, static_cast<uint32_t>(items.size()), m_maxChunksPerPass, m_minItemsPerChunk);
+		m_chunks.insert(m_chunks.end(), chunks.begin(), chunks.end());
+		return passIdx;
+	}
+
+	// sinks[k]յk飬벻GetChunkCount()
+	void Record(const std::vector<ICommandSink<Item>*>& sinks) const
+	{
+		assert(sinks.size() >= m_chunks.size());
+		Thread::ThreadPool::instance().ParallelFor(0, static_cast<uint32_t>(m_chunks.size()), 1, [&](uint32_t i)
+		{
+			RecordChunkTo(m_chunks[i], sinks[i]);
+		});
+	}
+
+	void RecordSerial(const std::vector<ICommandSink<Item>*>& sinks) const
+	{
+		assert(sinks.size() >= m_chunks.size());
+		for (uint32_t i = 0; i < m_chunks.size(); ++i)
+		{
+			RecordChunkTo(m_chunks[i], sinks[i]);
+		}
+	}
+
+	uint32_t GetChunkCount() const
+	{
+		return static_cast<uint32_t>(m_chunks.size());
+	}
+
+	uint32_t GetMaxChunksPerPass() const
+	{
+		return m_maxChunksPerPass;
+	}
+
+	const std::vector<RecordChunk>& GetChunks() const
+	{
+		return m_chunks;
+	}
+private:
+	void RecordChunkTo(const RecordChunk& chunk, ICommandSink<Item>* sink) const
+	{
+		const auto& items = *m_passes[chunk.passIdx];
+		sink->BeginChunk(chunk);
+		for (uint32_t i = chunk.begin; i < chunk.end; ++i)
+		{
+			sink->DrawItem(*items[i]);
+		}
+		sink->EndChunk(chunk);
+	}
+private:
+	std::vector<const std::vector<Item*>*>	m_passes;
+	std::vector<RecordChunk>				m_chunks;
+	uint32_t								m_maxChunksPerPass;
+	uint32_t								m_minItemsPerChunk;
+};
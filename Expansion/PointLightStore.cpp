@@ -0,0 +1,196 @@
+#include "PointLightStore.h"
+#include <cassert>
+#include <cmath>
+#include "ThreadPool.hpp"
+
+using namespace DirectX;
+
+namespace
+{
+XMVECTOR LoadLanes(const std::vector<float>& data, uint32_t idx)
+{
+	return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&data[idx]));
+}
+}
+
+void PointLightStore::Reserve(uint32_t count)
+{
+	const size_t capacity = static_cast<size_t>(count) + simdPadding;
+	m_radius.reserve(capacity);
+	m_angle.reserve(capacity);
+	m_height.reserve(capacity);
+	m_moveSpeed.reserve(capacity);
+	m_strengthR.reserve(capacity);
+	m_strengthG.reserve(capacity);
+	m_strengthB.reserve(capacity);
+	m_fallOffStart.reserve(capacity);
+	m_fallOffEnd.reserve(capacity);
+	m_packed.reserve(capacity);
+	m_indexToHandle.reserve(count);
+	m_handleToIndex.reserve(count);
+}
+
+uint32_t PointLightStore::Add(const LightMoveParams& move, const LightInCompute& light)
+{
+	const uint32_t idx = m_size;
+	Resize(m_size + 1);
+	m_radius[idx] = move.radius;
+	m_angle[idx] = move.angle;
+	m_height[idx] = move.height;
+	m_moveSpeed[idx] = move.moveSpeed;
+	m_strengthR[idx] = light.strength.x;
+	m_strengthG[idx] = light.strength.y;
+	m_strengthB[idx] = light.strength.z;
+	m_fallOffStart[idx] = light.fallOffStart;
+	m_fallOffEnd[idx] = light.fallOffEnd;
+	m_packed[idx] = light;
+
+	uint32_t handle;
+	if (m_freeHandles.empty())
+	{
+		handle = static_cast<uint32_t>(m_handleToIndex.size());
+		m_handleToIndex.push_back(idx);
+	}
+	else
+	{
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+		m_handleToIndex[handle] = idx;
+	}
+	m_indexToHandle.push_back(handle);
+	return handle;
+}
+
+void PointLightStore::Remove(uint32_t handle)
+{
+	assert(IsValid(handle));
+	const uint32_t idx = m_handleToIndex[handle];
+	const uint32_t last = m_size - 1;
+	if (idx != last)
+	{
+		MoveLight(last, idx);
+		m_indexToHandle[idx] = m_indexToHandle[last];
+		m_handleToIndex[m_indexToHandle[idx]] = idx;
+	}
+	m_indexToHandle.pop_back();
+	m_handleToIndex[handle] = invalidHandle;
+	m_freeHandles.push_back(handle);
+	Resize(last);
+}
+
+bool PointLightStore::IsValid(uint32_t handle) const
+{
+	return handle < m_handleToIndex.size() && m_handleToIndex[handle] != invalidHandle;
+}
+
+uint32_t PointLightStore::GetIndex(uint32_t handle) const
+{
+	assert(IsValid(handle));
+	return m_handleToIndex[handle];
+}
+
+uint32_t PointLightStore::GetSize() const
+{
+	return m_size;
+}
+
+void PointLightStore::Animate(float totalTime, FXMMATRIX view)
+{
+	const XMMATRIX viewMat = view;
+	// ÿ㶼4ı֮д뻥ص
+	Thread::ThreadPool::instance().ParallelFor(0, m_size, chunkSize, [&](uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		AnimateRange(chunkBegin, chunkEnd - chunkBegin, totalTime, viewMat);
+	});
+}
+
+void PointLightStore::AnimateScalar(float totalTime, FXMMATRIX view, LightInCompute* out) const
+{
+	for (uint32_t i = 0; i < m_size; ++i)
+	{
+		const float angle = m_angle[i] * totalTime * m_moveSpeed[i];
+		const XMFLOAT3 pos(m_radius[i] * std::cos(angle), m_height[i], m_radius[i] * std::sin(angle));
+		LightInCompute& light = out[i];
+		light.strength = { m_strengthR[i], m_strengthG[i], m_strengthB[i] };
+		light.fallOffStart = m_fallOffStart[i];
+		XMStoreFloat3(&light.posV, XMVector3TransformCoord(XMLoadFloat3(&pos), view));
+		light.fallOffEnd = m_fallOffEnd[i];
+	}
+}
+
+const LightInCompute* PointLightStore::GetData() const
+{
+	return m_packed.data();
+}
+
+void PointLightStore::AnimateRange(uint32_t start, uint32_t count, float totalTime, const XMMATRIX& view)
+{
+	assert(start % 4 == 0 && start + count <= m_size);
+	const XMVECTOR time = XMVectorReplicate(totalTime);
+	// ۲ĸԪع㲥4ͨXMVector3TransformCoordԼһ
+	const XMVECTOR m00 = XMVectorSplatX(view.r[0]), m01 = XMVectorSplatY(view.r[0]), m02 = XMVectorSplatZ(view.r[0]), m03 = XMVectorSplatW(view.r[0]);
+	const XMVECTOR m10 = XMVectorSplatX(view.r[1]), m11 = XMVectorSplatY(view.r[1]), m12 = XMVectorSplatZ(view.r[1]), m13 = XMVectorSplatW(view.r[1]);
+	const XMVECTOR m20 = XMVectorSplatX(view.r[2]), m21 = XMVectorSplatY(view.r[2]), m22 = XMVectorSplatZ(view.r[2]), m23 = XMVectorSplatW(view.r[2]);
+	const XMVECTOR m30 = XMVectorSplatX(view.r[3]), m31 = XMVectorSplatY(view.r[3]), m32 = XMVectorSplatZ(view.r[3]), m33 = XMVectorSplatW(view.r[3]);
+
+	for (uint32_t base = 0; base < count; base += 4)
+	{
+		const uint32_t idx = start + base;
+		const XMVECTOR radius = LoadLanes(m_radius, idx);
+		const XMVECTOR height = LoadLanes(m_height, idx);
+		XMVECTOR sinAngle, cosAngle;
+		XMVectorSinCos(&sinAngle, &cosAngle, XMVectorMultiply(XMVectorMultiply(LoadLanes(m_angle, idx), time), LoadLanes(m_moveSpeed, idx)));
+		const XMVECTOR worldX = XMVectorMultiply(radius, cosAngle);
+		const XMVECTOR worldZ = XMVectorMultiply(radius, sinAngle);
+
+		const XMVECTOR viewX = XMVectorMultiplyAdd(worldX, m00, XMVectorMultiplyAdd(height, m10, XMVectorMultiplyAdd(worldZ, m20, m30)));
+		const XMVECTOR viewY = XMVectorMultiplyAdd(worldX, m01, XMVectorMultiplyAdd(height, m11, XMVectorMultiplyAdd(worldZ, m21, m31)));
+		const XMVECTOR viewZ = XMVectorMultiplyAdd(worldX, m02, XMVectorMultiplyAdd(height, m12, XMVectorMultiplyAdd(worldZ, m22, m32)));
+		const XMVECTOR viewW = XMVectorMultiplyAdd(worldX, m03, XMVectorMultiplyAdd(height, m13, XMVectorMultiplyAdd(worldZ, m23, m33)));
+		const XMVECTOR invW = XMVectorDivide(XMVectorReplicate(1.0f), viewW);
+
+		// LightInCompute(strength, fallOffStart)(posV, fallOffEnd)float4Уת4x4鼴ɵõÿյԴһ
+		const XMMATRIX first = XMMatrixTranspose(XMMATRIX(
+			LoadLanes(m_strengthR, idx), LoadLanes(m_strengthG, idx), LoadLanes(m_strengthB, idx), LoadLanes(m_fallOffStart, idx)));
+		const XMMATRIX second = XMMatrixTranspose(XMMATRIX(
+			XMVectorMultiply(viewX, invW), XMVectorMultiply(viewY, invW), XMVectorMultiply(viewZ, invW), LoadLanes(m_fallOffEnd, idx)));
+
+		// ͬ䣬4յʱдĲֲᱻϴ
+		XMFLOAT4* dst = reinterpret_cast<XMFLOAT4*>(&m_packed[idx]);
+		for (uint32_t lane = 0; lane < 4; ++lane)
+		{
+			XMStoreFloat4(dst + lane * 2, first.r[lane]);
+			XMStoreFloat4(dst + lane * 2 + 1, second.r[lane]);
+		}
+	}
+}
+
+void PointLightStore::MoveLight(uint32_t from, uint32_t to)
+{
+	m_radius[to] = m_radius[from];
+	m_angle[to] = m_angle[from];
+	m_height[to] = m_height[from];
+	m_moveSpeed[to] = m_moveSpeed[from];
+	m_strengthR[to] = m_strengthR[from];
+	m_strengthG[to] = m_strengthG[from];
+	m_strengthB[to] = m_strengthB[from];
+	m_fallOffStart[to] = m_fallOffStart[from];
+	m_fallOffEnd[to] = m_fallOffEnd[from];
+	m_packed[to] = m_packed[from];
+}
+
+void PointLightStore::Resize(uint32_t size)
+{
+	m_size = size;
+	const size_t capacity = static_cast<size_t>(size) + simdPadding;
+	m_radius.resize(capacity, 0.0f);
+	m_angle.resize(capacity, 0.0f);
+	m_height.resize(capacity, 0.0f);
+	m_moveSpeed.resize(capacity, 0.0f);
+	m_strengthR.resize(capacity, 0.0f);
+	m_strengthG.resize(capacity, 0.0f);
+	m_strengthB.resize(capacity, 0.0f);
+	m_fallOffStart.resize(capacity, 0.0f);
+	m_fallOffEnd.resize(capacity, 0.0f);
+	m_packed.resize(capacity, LightInCompute{});
+}
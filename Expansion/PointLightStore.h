@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Light.h"
+
+/*
+ * SoAʽ洢еԴ˶ɫ˥shared_ptr<Light<Compute>>ĸ·ʽ
+ * AnimateÿSIMD4յԴĹ۲ռλãַ̳߳أֱдɫLightInCompute
+ * Уϴʱֻһmemcpy
+ * ԴԾɾɾʱĩβĹԴλܣԴе˿ܱ仯
+ */
+class PointLightStore
+{
+public:
+	PointLightStore() = default;
+	PointLightStore(const PointLightStore&) = delete;
+	PointLightStore& operator=(const PointLightStore&) = delete;
+	PointLightStore(PointLightStore&&) = default;
+	PointLightStore& operator=(PointLightStore&&) = default;
+	~PointLightStore() = default;
+
+	static constexpr uint32_t		invalidHandle = ~0U;
+
+	void Reserve(uint32_t count);
+	// һյԴlightеposVһAnimateʱǣعԴ
+	uint32_t Add(const LightMoveParams& move, const LightInCompute& light);
+	void Remove(uint32_t handle);
+	bool IsValid(uint32_t handle) const;
+	// ӦĹԴGetData()е
+	uint32_t GetIndex(uint32_t handle) const;
+	uint32_t GetSize() const;
+
+	// ռλΪ(radius * cos(a), height, radius * sin(a))a = angle * totalTime * moveSpeedٱ任۲ռ
+	void Animate(float totalTime, DirectX::FXMMATRIX view);
+	// Դı汾ԭBoxApp::UpdateLightPosļһ£У
+	void AnimateScalar(float totalTime, DirectX::FXMMATRIX view, LightInCompute* out) const;
+	const LightInCompute* GetData() const;
+private:
+	void AnimateRange(uint32_t start, uint32_t count, float totalTime, const DirectX::XMMATRIX& view);
+	void Resize(uint32_t size);
+	void MoveLight(uint32_t from, uint32_t to);
+private:
+	// ĩβⱣĹԴʹSIMD4յĹԴʱԽ
+	static constexpr uint32_t		simdPadding = 3;
+	// ÿ߳ĹԴΪ4ı
+	static constexpr uint32_t		chunkSize = 1024;
+
+	std::vector<float>				m_radius;
+	std::vector<float>				m_angle;
+	std::vector<float>				m_height;
+	std::vector<float>				m_moveSpeed;
+	std::vector<float>				m_strengthR;
+	std::vector<float>				m_strengthG;
+	std::vector<float>				m_strengthB;
+	std::vector<float>				m_fallOffStart;
+	std::vector<float>				m_fallOffEnd;
+	std::vector<LightInCompute>		m_packed;
+	std::vector<uint32_t>			m_indexToHandle;
+	std::vector<uint32_t>			m_handleToIndex;
+	std::vector<uint32_t>			m_freeHandles;
+	uint32_t						m_size{ 0 };
+};
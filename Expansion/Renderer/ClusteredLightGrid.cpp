@@ -0,0 +1,265 @@
+#include "ClusteredLightGrid.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "ThreadPool.hpp"
+
+using namespace DirectX;
+using namespace Renderer;
+
+void ClusteredLightGrid::SetView(uint32_t width, uint32_t height, float projX, float projY, float nearZ, float farZ)
+{
+	const float zNear = std::min(nearZ, farZ);
+	const float zFar = std::max(nearZ, farZ);
+	if (width == m_width && height == m_height && projX == m_projX && projY == m_projY && zNear == m_nearZ && zFar == m_farZ)
+		return;
+	m_width = width;
+	m_height = height;
+	m_projX = projX;
+	m_projY = projY;
+	m_nearZ = zNear;
+	m_farZ = zFar;
+	m_tileCountX = (width + tileSize - 1) / tileSize;
+	m_tileCountY = (height + tileSize - 1) / tileSize;
+	m_paddedTileCountX = (m_tileCountX + 3) & ~3U;
+	// ָ֣z_k = near * (far / near)^(k / sliceCount)
+	const float logRange = std::log(zFar / zNear);
+	m_sliceScale = static_cast<float>(sliceCount) / logRange;
+	m_sliceBias = -std::log(zNear) * m_sliceScale;
+	m_sliceZ.resize(sliceCount + 1);
+	for (uint32_t k = 0; k <= sliceCount; ++k)
+	{
+		m_sliceZ[k] = zNear * std::exp(logRange * static_cast<float>(k) / static_cast<float>(sliceCount));
+	}
+	m_sliceZ[sliceCount] = zFar;
+
+	// ۲ռ x = ndc * z / m00froxelİΧȡԶ˽Ĳ
+	// 뵽4ıķֿʹÿհΧУSIMDʱȻʧ
+	m_froxelMinX.assign(static_cast<size_t>(sliceCount) * m_paddedTileCountX, FLT_MAX);
+	m_froxelMaxX.assign(static_cast<size_t>(sliceCount) * m_paddedTileCountX, -FLT_MAX);
+	m_froxelMinY.resize(static_cast<size_t>(sliceCount) * m_tileCountY);
+	m_froxelMaxY.resize(static_cast<size_t>(sliceCount) * m_tileCountY);
+	for (uint32_t k = 0; k < sliceCount; ++k)
+	{
+		const float zn = m_sliceZ[k];
+		const float zf = m_sliceZ[k + 1];
+		for (uint32_t tx = 0; tx < m_tileCountX; ++tx)
+		{
+			const float ndc0 = -1.0f + 2.0f * static_cast<float>(tx * tileSize) / static_cast<float>(width);
+			const float ndc1 = -1.0f + 2.0f * static_cast<float>(std::min((tx + 1) * tileSize, width)) / static_cast<float>(width);
+			m_froxelMinX[k * m_paddedTileCountX + tx] = std::min(ndc0 * zn, ndc0 * zf) / projX;
+			m_froxelMaxX[k * m_paddedTileCountX + tx] = std::max(ndc1 * zn, ndc1 * zf) / projX;
+		}
+		for (uint32_t ty = 0; ty < m_tileCountY; ++ty)
+		{
+			// y£0зֿλndcĶ
+			const float ndcTop = 1.0f - 2.0f * static_cast<float>(ty * tileSize) / static_cast<float>(height);
+			const float ndcBottom = 1.0f - 2.0f * static_cast<float>(std::min((ty + 1) * tileSize, height)) / static_cast<float>(height);
+			m_froxelMinY[k * m_tileCountY + ty] = std::min(ndcBottom * zn, ndcBottom * zf) / projY;
+			m_froxelMaxY[k * m_tileCountY + ty] = std::max(ndcTop * zn, ndcTop * zf) / projY;
+		}
+	}
+	m_grid.assign(GetClusterCount(), ClusterRange{ 0, 0 });
+	m_lightIndices.clear();
+}
+
+void ClusteredLightGrid::Build(const LightInCompute* lights, uint32_t count)
+{
+	const uint32_t chunkCount = (count + lightChunkSize - 1) / lightChunkSize;
+	m_chunkPairs.resize(chunkCount);
+	Thread::ThreadPool::instance().ParallelFor(0, chunkCount, 1, [&](uint32_t chunk)
+	{
+		auto& pairs = m_chunkPairs[chunk];
+		pairs.clear();
+		const uint32_t end = std::min(count, (chunk + 1) * lightChunkSize);
+		for (uint32_t i = chunk * lightChunkSize; i < end; ++i)
+		{
+			BinLight(lights[i], i, pairs);
+		}
+	});
+	Compact(m_chunkPairs);
+}
+
+void ClusteredLightGrid::BuildReference(const LightInCompute* lights, uint32_t count)
+{
+	m_chunkPairs.resize(1);
+	auto& pairs = m_chunkPairs[0];
+	pairs.clear();
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		for (uint32_t k = 0; k < sliceCount; ++k)
+		{
+			for (uint32_t ty = 0; ty < m_tileCountY; ++ty)
+			{
+				for (uint32_t tx = 0; tx < m_tileCountX; ++tx)
+				{
+					if (TestFroxel(lights[i], k, ty, tx))
+					{
+						pairs.push_back({ (k * m_tileCountY + ty) * m_tileCountX + tx, i });
+					}
+				}
+			}
+		}
+	}
+	Compact(m_chunkPairs);
+}
+
+const std::vector<ClusterRange>& ClusteredLightGrid::GetGrid() const
+{
+	return m_grid;
+}
+
+const std::vector<uint32_t>& ClusteredLightGrid::GetLightIndices() const
+{
+	return m_lightIndices;
+}
+
+ClusterConstant ClusteredLightGrid::GetConstant() const
+{
+	return ClusterConstant{ m_tileCountX, m_tileCountY, sliceCount, tileSize, m_sliceScale, m_sliceBias, { 0.0f, 0.0f } };
+}
+
+uint32_t ClusteredLightGrid::GetClusterCount() const
+{
+	return m_tileCountX * m_tileCountY * sliceCount;
+}
+
+uint32_t ClusteredLightGrid::GetOverflowCount() const
+{
+	return m_overflow;
+}
+
+uint32_t ClusteredLightGrid::GetSlice(float viewZ) const
+{
+	const float z = std::min(std::max(viewZ, m_nearZ), m_farZ);
+	const float slice = std::floor(std::log(z) * m_sliceScale + m_sliceBias);
+	return static_cast<uint32_t>(std::min(std::max(slice, 0.0f), static_cast<float>(sliceCount - 1)));
+}
+
+bool ClusteredLightGrid::TestFroxel(const LightInCompute& light, uint32_t slice, uint32_t tileY, uint32_t tileX) const
+{
+	// ˳BinLightеSIMD汾һ£֤λͬ
+	const float radiusSq = light.fallOffEnd * light.fallOffEnd;
+	const float dz = std::max(std::max(m_sliceZ[slice] - light.posV.z, light.posV.z - m_sliceZ[slice + 1]), 0.0f);
+	const float remainZ = radiusSq - dz * dz;
+	if (remainZ < 0.0f)
+		return false;
+	const uint32_t yIdx = slice * m_tileCountY + tileY;
+	const float dy = std::max(std::max(m_froxelMinY[yIdx] - light.posV.y, light.posV.y - m_froxelMaxY[yIdx]), 0.0f);
+	const float remainY = remainZ - dy * dy;
+	if (remainY < 0.0f)
+		return false;
+	const uint32_t xIdx = slice * m_paddedTileCountX + tileX;
+	const float dx = std::max(std::max(m_froxelMinX[xIdx] - light.posV.x, light.posV.x - m_froxelMaxX[xIdx]), 0.0f);
+	return dx * dx <= remainY;
+}
+
+void ClusteredLightGrid::BinLight(const LightInCompute& light, uint32_t lightIdx, std::vector<LightPair>& pairs) const
+{
+	const float cx = light.posV.x;
+	const float cy = light.posV.y;
+	const float cz = light.posV.z;
+	const float radius = light.fallOffEnd;
+	const float radiusSq = radius * radius;
+	// ѡΧֻСһԱ⸡ս԰ΧвΪ׼
+	const uint32_t sliceBegin = std::max(GetSlice(cz - radius), 1U) - 1;
+	const uint32_t sliceEnd = std::min(GetSlice(cz + radius) + 1, sliceCount - 1);
+	const float tilesPerNdcX = 0.5f * static_cast<float>(m_width) / static_cast<float>(tileSize);
+	const float tilesPerNdcY = 0.5f * static_cast<float>(m_height) / static_cast<float>(tileSize);
+	const XMVECTOR zero = XMVectorZero();
+	const XMVECTOR centerX = XMVectorReplicate(cx);
+	for (uint32_t k = sliceBegin; k <= sliceEnd; ++k)
+	{
+		const float zn = m_sliceZ[k];
+		const float zf = m_sliceZ[k + 1];
+		const float dz = std::max(std::max(zn - cz, cz - zf), 0.0f);
+		const float remainZ = radiusSq - dz * dz;
+		if (remainZ < 0.0f)
+			continue;
+		// ΧڸòԶ˽ϵndcΧx / zxzֵڶ˵㴦ȡ
+		const float ndcMinX = std::min((cx - radius) / zn, (cx - radius) / zf) * m_projX;
+		const float ndcMaxX = std::max((cx + radius) / zn, (cx + radius) / zf) * m_projX;
+		const float ndcMinY = std::min((cy - radius) / zn, (cy - radius) / zf) * m_projY;
+		const float ndcMaxY = std::max((cy + radius) / zn, (cy + radius) / zf) * m_projY;
+		const int tileX0 = static_cast<int>(std::floor((ndcMinX + 1.0f) * tilesPerNdcX)) - 1;
+		const int tileX1 = static_cast<int>(std::floor((ndcMaxX + 1.0f) * tilesPerNdcX)) + 1;
+		const int tileY0 = static_cast<int>(std::floor((1.0f - ndcMaxY) * tilesPerNdcY)) - 1;
+		const int tileY1 = static_cast<int>(std::floor((1.0f - ndcMinY) * tilesPerNdcY)) + 1;
+		if (tileX1 < 0 || tileY1 < 0 || tileX0 >= static_cast<int>(m_tileCountX) || tileY0 >= static_cast<int>(m_tileCountY))
+			continue;
+		// 4ֿΪһ飬뵽4Ա
+		const uint32_t xBegin = static_cast<uint32_t>(std::max(tileX0, 0)) & ~3U;
+		const uint32_t xEnd = std::min(static_cast<uint32_t>(tileX1), m_tileCountX - 1);
+		const uint32_t yBegin = static_cast<uint32_t>(std::max(tileY0, 0));
+		const uint32_t yEnd = std::min(static_cast<uint32_t>(tileY1), m_tileCountY - 1);
+		const float* minX = &m_froxelMinX[k * m_paddedTileCountX];
+		const float* maxX = &m_froxelMaxX[k * m_paddedTileCountX];
+		for (uint32_t ty = yBegin; ty <= yEnd; ++ty)
+		{
+			const uint32_t yIdx = k * m_tileCountY + ty;
+			const float dy = std::max(std::max(m_froxelMinY[yIdx] - cy, cy - m_froxelMaxY[yIdx]), 0.0f);
+			const float remainY = remainZ - dy * dy;
+			if (remainY < 0.0f)
+				continue;
+			const XMVECTOR remain = XMVectorReplicate(remainY);
+			const uint32_t rowBase = (k * m_tileCountY + ty) * m_tileCountX;
+			for (uint32_t tx = xBegin; tx <= xEnd; tx += 4)
+			{
+				const XMVECTOR boxMin = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(minX + tx));
+				const XMVECTOR boxMax = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(maxX + tx));
+				XMVECTOR dx = XMVectorMax(XMVectorSubtract(boxMin, centerX), XMVectorSubtract(centerX, boxMax));
+				dx = XMVectorMax(dx, zero);
+				const XMVECTOR inside = XMVectorLessOrEqual(XMVectorMultiply(dx, dx), remain);
+				XMUINT4 mask;
+				XMStoreUInt4(&mask, inside);
+				const uint32_t laneMask[4] = { mask.x, mask.y, mask.z, mask.w };
+				const uint32_t lanes = std::min(4U, m_tileCountX - tx);
+				for (uint32_t lane = 0; lane < lanes; ++lane)
+				{
+					if (laneMask[lane] != 0)
+					{
+						pairs.push_back({ rowBase + tx + lane, lightIdx });
+					}
+				}
+			}
+		}
+	}
+}
+
+void ClusteredLightGrid::Compact(const std::vector<std::vector<LightPair>>& chunkPairs)
+{
+	const uint32_t clusterCount = GetClusterCount();
+	m_grid.assign(clusterCount, ClusterRange{ 0, 0 });
+	for (const auto& pairs : chunkPairs)
+	{
+		for (const auto& pair : pairs)
+		{
+			++m_grid[pair.cluster].count;
+		}
+	}
+	// ǰ׺͵õÿص㣬޵ĲִӺĴؿʼض
+	uint32_t total = 0;
+	for (auto& range : m_grid)
+	{
+		const uint32_t begin = std::min(total, maxLightIndices);
+		const uint32_t end = std::min(total + range.count, maxLightIndices);
+		total += range.count;
+		range.offset = begin;
+		range.count = end - begin;
+	}
+	m_overflow = total > maxLightIndices ? total - maxLightIndices : 0;
+	m_lightIndices.resize(std::min(total, maxLightIndices));
+	m_cursor.assign(clusterCount, 0);
+	for (const auto& pairs : chunkPairs)
+	{
+		for (const auto& pair : pairs)
+		{
+			const auto& range = m_grid[pair.cluster];
+			uint32_t& cursor = m_cursor[pair.cluster];
+			if (cursor < range.count)
+			{
+				m_lightIndices[range.offset + cursor++] = pair.light;
+			}
+		}
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Light.h"
+
+namespace Renderer
+{
+// ɫеuint2һ£ôڹԴбе
+struct ClusterRange
+{
+	uint32_t	offset;
+	uint32_t	count;
+};
+
+// ɫжλĲԸʽ
+struct ClusterConstant
+{
+	uint32_t	tileCountX;
+	uint32_t	tileCountY;
+	uint32_t	sliceCount;
+	uint32_t	tileSize;
+	float		sliceScale;		// slice = log(z) * sliceScale + sliceBias
+	float		sliceBias;
+	float		pad[2];
+};
+
+/*
+ * CPU˵ķִعԴ䣬ΪTileBased.hlslֿ޳
+ * ĻtileSizeַֿ飬۲ռȰָΪsliceCount㣬ÿfroxelȡ۲ռΧԴΧ
+ * ֿ޳ҪֿڵȷΧȲ()ķֿ˻Ϊ׶壻ִȻ޹
+ * Ϊÿص(offset, count)еĹԴбÿڵԴ
+ */
+class ClusteredLightGrid
+{
+public:
+	static constexpr uint32_t	tileSize = 64;
+	static constexpr uint32_t	sliceCount = 24;
+	// ԴбޣĲֱGetOverflowCount
+	static constexpr uint32_t	maxLightIndices = 1 << 20;
+
+	ClusteredLightGrid() = default;
+	ClusteredLightGrid(const ClusteredLightGrid&) = delete;
+	ClusteredLightGrid& operator=(const ClusteredLightGrid&) = delete;
+	ClusteredLightGrid(ClusteredLightGrid&&) = default;
+	ClusteredLightGrid& operator=(ClusteredLightGrid&&) = default;
+	~ClusteredLightGrid() = default;
+
+	/*
+	 * ֱʻͶӰ仯ʱؽfroxelΧУδʱֱӷ
+	 * projXprojYΪͶӰm00m11nearZfarZ˳޹أreverse-Z
+	 */
+	void SetView(uint32_t width, uint32_t height, float projX, float projY, float nearZ, float farZ);
+	// ԴѡfroxelÿSIMD4ڷֿ飬Դַ̳߳
+	void Build(const LightInCompute* lights, uint32_t count);
+	// froxelԴı汾Buildλһ£У
+	void BuildReference(const LightInCompute* lights, uint32_t count);
+
+	const std::vector<ClusterRange>& GetGrid() const;
+	const std::vector<uint32_t>& GetLightIndices() const;
+	ClusterConstant GetConstant() const;
+	uint32_t GetClusterCount() const;
+	uint32_t GetOverflowCount() const;
+private:
+	struct LightPair
+	{
+		uint32_t	cluster;
+		uint32_t	light;
+	};
+	uint32_t GetSlice(float viewZ) const;
+	bool TestFroxel(const LightInCompute& light, uint32_t slice, uint32_t tileY, uint32_t tileX) const;
+	void BinLight(const LightInCompute& light, uint32_t lightIdx, std::vector<LightPair>& pairs) const;
+	// ȶ֤ڹԴ˳
+	void Compact(const std::vector<std::vector<LightPair>>& chunkPairs);
+private:
+	static constexpr uint32_t				lightChunkSize = 64;
+
+	uint32_t								m_width{ 0 };
+	uint32_t								m_height{ 0 };
+	float									m_projX{ 0.0f };
+	float									m_projY{ 0.0f };
+	float									m_nearZ{ 0.0f };
+	float									m_farZ{ 0.0f };
+	uint32_t								m_tileCountX{ 0 };
+	uint32_t								m_tileCountY{ 0 };
+	uint32_t								m_paddedTileCountX{ 0 };
+	float									m_sliceScale{ 0.0f };
+	float									m_sliceBias{ 0.0f };
+	// froxelڹ۲ռİΧУxΧȡ(slice, tileX)yΧȡ(slice, tileY)zΧֻȡslice
+	std::vector<float>						m_sliceZ;
+	std::vector<float>						m_froxelMinX;
+	std::vector<float>						m_froxelMaxX;
+	std::vector<float>						m_froxelMinY;
+	std::vector<float>						m_froxelMaxY;
+
+	std::vector<std::vector<LightPair>>		m_chunkPairs;
+	std::vector<ClusterRange>				m_grid;
+	std::vector<uint32_t>					m_lightIndices;
+	std::vector<uint32_t>					m_cursor;
+	uint32_t								m_overflow{ 0 };
+};
+}
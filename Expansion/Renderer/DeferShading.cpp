@@ -54,7 +54,8 @@ void Renderer::DeferShading::CreateDescriptors(D3D12_CPU_DESCRIPTOR_HANDLE srvCp
 	CreateDescriptors();
 }
   
-void Renderer::DeferShading::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const {
+void Renderer::DeferShading::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) {
+	FlushBarriers(cmdList);
 	cmdList->ClearRenderTargetView(m_bloomRTV[0], Colors::LightSteelBlue, 0, nullptr);
 	cmdList->ClearRenderTargetView(m_bloomRTV[1], Colors::LightSteelBlue, 0, nullptr);
 	cmdList->OMSetRenderTargets(2, &m_bloomRTV[0], true, &m_cpuDSV);
@@ -1,8 +1,234 @@
 #include "ForwardPlus.h"
+#include "RtvDsvMgr.h"
+#include "Texture.h"
 
 using namespace Renderer;
 
 ForwardPlus::ForwardPlus(ID3D12Device* _device, UINT _width, UINT _height, DXGI_FORMAT _format)
 : IRenderer(_device, _width, _height, _format)
 {
+	m_dsvOffset = RtvDsvMgr::instance().RegisterDSV(1);
+	CreateResources();
+}
+
+void ForwardPlus::InitRootSignature()
+{
+	CD3DX12_DESCRIPTOR_RANGE gBufferTable;
+	gBufferTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 3, 1, 0);
+	CD3DX12_DESCRIPTOR_RANGE depthTable;
+	depthTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 7, 0);
+	// TileBasedDeferļǩͬļĴCullLightsDeferλͬһļ
+	CD3DX12_ROOT_PARAMETER parameters[7]{};
+	parameters[0].InitAsConstantBufferView(0);
+	parameters[1].InitAsDescriptorTable(1, &gBufferTable);
+	parameters[2].InitAsShaderResourceView(0);
+	parameters[3].InitAsConstants(4, 1, 0);
+	parameters[4].InitAsShaderResourceView(6);
+	parameters[5].InitAsDescriptorTable(1, &depthTable);
+	parameters[6].InitAsUnorderedAccessView(3);
+
+	// CullLightsֻʹLoadҪ
+	CD3DX12_ROOT_SIGNATURE_DESC rootDesc(7U, parameters, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_NONE);
+	ComPtr<ID3DBlob> serializeRootSig{ nullptr };
+	ComPtr<ID3DBlob> error{ nullptr };
+	auto res = D3D12SerializeRootSignature(&rootDesc, D3D_ROOT_SIGNATURE_VERSION_1, serializeRootSig.GetAddressOf(), error.GetAddressOf());
+	if (error)
+	{
+		OutputDebugStringA(static_cast<char*>(error->GetBufferPointer()));
+	}
+	ThrowIfFailed(res);
+	ThrowIfFailed(m_device->CreateRootSignature(0, serializeRootSig->GetBufferPointer(), serializeRootSig->GetBufferSize(), IID_PPV_ARGS(m_cullRootSig.GetAddressOf())));
+}
+
+void ForwardPlus::InitPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& templateDesc)
+{
+	const auto& shader = m_shaderPack[L"Shaders\\ForwardPlus"];
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC depthDesc = templateDesc;
+	depthDesc.InputLayout = { shader->GetInputLayouts(), shader->GetInputLayoutSize() };
+	depthDesc.VS = { static_cast<BYTE*>(shader->GetShaderByType(ShaderPos::vertex)->GetBufferPointer()), shader->GetShaderByType(ShaderPos::vertex)->GetBufferSize() };
+	// ֻдȣҪɫalphaԱֻ÷ֿȷΧ
+	depthDesc.PS = { nullptr, 0 };
+	depthDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+	depthDesc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_GREATER;
+	depthDesc.NumRenderTargets = 0;
+	depthDesc.RTVFormats[0] = DXGI_FORMAT_UNKNOWN;
+	depthDesc.RTVFormats[1] = DXGI_FORMAT_UNKNOWN;
+	depthDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
+	depthDesc.SampleDesc.Count = 1;
+	depthDesc.SampleDesc.Quality = 0;
+	ThrowIfFailed(m_device->CreateGraphicsPipelineState(&depthDesc, IID_PPV_ARGS(&m_depthPso)));
+
+	// ģ壬볡ȾĿһ
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC shadingDesc = templateDesc;
+	shadingDesc.InputLayout = depthDesc.InputLayout;
+	shadingDesc.VS = depthDesc.VS;
+	shadingDesc.PS = { static_cast<BYTE*>(shader->GetShaderByType(ShaderPos::fragment)->GetBufferPointer()), shader->GetShaderByType(ShaderPos::fragment)->GetBufferSize() };
+	shadingDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+	// ͸ֻȲԣд
+	shadingDesc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
+	shadingDesc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_GREATER_EQUAL;
+	D3D12_RENDER_TARGET_BLEND_DESC alphaBlend{};
+	alphaBlend.BlendEnable = true;
+	alphaBlend.LogicOpEnable = false;
+	alphaBlend.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+	alphaBlend.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+	alphaBlend.BlendOp = D3D12_BLEND_OP_ADD;
+	alphaBlend.SrcBlendAlpha = D3D12_BLEND_ONE;
+	alphaBlend.DestBlendAlpha = D3D12_BLEND_ZERO;
+	alphaBlend.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+	alphaBlend.LogicOp = D3D12_LOGIC_OP_NOOP;
+	alphaBlend.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+	shadingDesc.BlendState.IndependentBlendEnable = true;
+	shadingDesc.BlendState.RenderTargetBlendDesc[0] = alphaBlend;
+	// Ŀֻ¼͸ĸ
+	shadingDesc.BlendState.RenderTargetBlendDesc[1].RenderTargetWriteMask = 0;
+	ThrowIfFailed(m_device->CreateGraphicsPipelineState(&shadingDesc, IID_PPV_ARGS(&m_pso)));
+
+	D3D12_COMPUTE_PIPELINE_STATE_DESC cullDesc{};
+	cullDesc.CS = { m_shaderPack[L"Shaders\\TileBased_CullLights"]->GetShaderByType(ShaderPos::compute)->GetBufferPointer(), m_shaderPack[L"Shaders\\TileBased_CullLights"]->GetShaderByType(ShaderPos::compute)->GetBufferSize() };
+	cullDesc.pRootSignature = m_cullRootSig.Get();
+	cullDesc.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
+	cullDesc.NodeMask = 0;
+	ThrowIfFailed(m_device->CreateComputePipelineState(&cullDesc, IID_PPV_ARGS(&m_cullPso)));
+
+	// CPUõĽṹ岼¶ҪУ飬ShaderConfig.hĶһ»ﱨ
+	shader->CheckConstantBuffer(ShaderPos::fragment, "cbTileLights", sizeof(UINT) * 4);
+	shader->CheckStructuredBuffer(ShaderPos::fragment, "sbLights", sizeof(LightInCompute));
+	m_shaderPack[L"Shaders\\TileBased_CullLights"]->CheckConstantBuffer(ShaderPos::compute, "cbPass", sizeof(PostProcessPass));
+	m_shaderPack[L"Shaders\\TileBased_CullLights"]->CheckStructuredBuffer(ShaderPos::compute, "sbLights", sizeof(LightInCompute));
+}
+
+void ForwardPlus::InitTexture()
+{
+	m_depthIdx = TextureMgr::instance().RegisterRenderToTexture("ForwardPlusDepth");
+}
+
+void ForwardPlus::CreateDescriptors(D3D12_CPU_DESCRIPTOR_HANDLE srvCpuStart, D3D12_CPU_DESCRIPTOR_HANDLE rtvCpuStart,
+D3D12_CPU_DESCRIPTOR_HANDLE dsvCpuStart, D3D12_GPU_DESCRIPTOR_HANDLE srvGpuStart, UINT srvSize, UINT rtvSize, UINT dsvSize)
+{
+	m_cpuSRV = CD3DX12_CPU_DESCRIPTOR_HANDLE(srvCpuStart, static_cast<INT>(m_depthIdx), srvSize);
+	m_gpuSRV = CD3DX12_GPU_DESCRIPTOR_HANDLE(srvGpuStart, static_cast<INT>(m_depthIdx), srvSize);
+
+	InitDSV(dsvCpuStart, dsvSize);
+	CreateDescriptors();
+}
+
+void ForwardPlus::Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc)
+{
+
+}
+
+void ForwardPlus::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc)
+{
+	// ԤȾZΪ0
+	ChangeState<D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_DEPTH_WRITE>(cmdList, m_resource.Get());
+	FlushBarriers(cmdList);
+	cmdList->ClearDepthStencilView(m_cpuDSV, D3D12_CLEAR_FLAG_DEPTH, 0.0f, 0, 0, nullptr);
+	cmdList->OMSetRenderTargets(0, nullptr, false, &m_cpuDSV);
+	cmdList->SetPipelineState(m_depthPso.Get());
+	drawFunc(depthPrePass);
+	ChangeState<D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE>(cmdList, m_resource.Get());
+
+	// ֿԴ޳Դ׶TileBasedDefer
+	const UINT frameIndex = m_opaque->GetPointLightFrame();
+	m_retiredTileLightBuffers[frameIndex].Reset();
+	const UINT lightCount = m_opaque->GetPointLightCount();
+	const UINT lightWords = (lightCount + 31) >> 5;
+	if (lightWords > m_tileLightWords)
+	{
+		// ;֡ڶȡɵλ
+		m_retiredTileLightBuffers[frameIndex] = std::move(m_tileLightBuffer);
+		m_tileLightWords = std::max(lightWords, m_tileLightWords * 2);
+		CreateTileLightBuffer();
+	}
+	cmdList->SetComputeRootSignature(m_cullRootSig.Get());
+	drawFunc(lightCullingPass);
+	const UINT debug[] = { false, false, lightCount, 0 };
+	cmdList->SetComputeRoot32BitConstants(3U, 4, &debug, 0);
+	cmdList->SetComputeRootShaderResourceView(2, m_opaque->GetPointLightAddress());
+	cmdList->SetComputeRootShaderResourceView(4, m_opaque->GetTilePlaneAddress());
+	cmdList->SetComputeRootDescriptorTable(5, m_gpuSRV);
+	cmdList->SetComputeRootUnorderedAccessView(6, m_tileLightBuffer->GetGPUVirtualAddress());
+	cmdList->SetPipelineState(m_cullPso.Get());
+	FlushBarriers(cmdList);
+	cmdList->Dispatch(m_tileCountX, m_tileCountY, 1);
+	ChangeState<D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE>(cmdList, m_tileLightBuffer.Get());
+
+	// ǰɫ
+	cmdList->OMSetRenderTargets(2, &m_opaque->GetRenderTarget<0>(), true, &m_sceneDSV);
+	const UINT tileConstant[] = { m_tileCountX, lightWords, 0, 0 };
+	cmdList->SetGraphicsRoot32BitConstants(tileConstantRootParam, 4, &tileConstant, 0);
+	cmdList->SetGraphicsRootShaderResourceView(lightsRootParam, m_opaque->GetPointLightAddress());
+	cmdList->SetGraphicsRootShaderResourceView(tileBitsRootParam, m_tileLightBuffer->GetGPUVirtualAddress());
+	cmdList->SetPipelineState(m_pso.Get());
+	drawFunc(shadingPass);
+	ChangeState<D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS>(cmdList, m_tileLightBuffer.Get());
+}
+
+void ForwardPlus::SetOpaqueRenderer(const TileBasedDefer* opaque, D3D12_CPU_DESCRIPTOR_HANDLE sceneDSV)
+{
+	m_opaque = opaque;
+	m_sceneDSV = sceneDSV;
+}
+
+void ForwardPlus::InitDSV(D3D12_CPU_DESCRIPTOR_HANDLE _cpuDSV, UINT dsvSize)
+{
+	m_cpuDSV = CD3DX12_CPU_DESCRIPTOR_HANDLE(_cpuDSV, static_cast<INT>(m_dsvOffset), dsvSize);
+}
+
+void ForwardPlus::CreateDescriptors()
+{
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
+	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Texture2D.MostDetailedMip = 0;
+	srvDesc.Texture2D.MipLevels = 1;
+	srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+	srvDesc.Texture2D.PlaneSlice = 0;
+	m_device->CreateShaderResourceView(m_resource.Get(), &srvDesc, m_cpuSRV);
+
+	D3D12_DEPTH_STENCIL_VIEW_DESC dsvDesc{};
+	dsvDesc.Flags = D3D12_DSV_FLAG_NONE;
+	dsvDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
+	dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
+	dsvDesc.Texture2D.MipSlice = 0;
+	m_device->CreateDepthStencilView(m_resource.Get(), &dsvDesc, m_cpuDSV);
+}
+
+void ForwardPlus::CreateResources()
+{
+	m_tileCountX = (m_width + TILE_GROUP_DIM - 1) / TILE_GROUP_DIM;
+	m_tileCountY = (m_height + TILE_GROUP_DIM - 1) / TILE_GROUP_DIM;
+
+	D3D12_RESOURCE_DESC depthDesc;
+	ZeroMemory(&depthDesc, sizeof(D3D12_RESOURCE_DESC));
+	depthDesc.Alignment = 0;
+	depthDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+	depthDesc.Width = m_width;
+	depthDesc.Height = m_height;
+	depthDesc.DepthOrArraySize = 1;
+	depthDesc.MipLevels = 1;
+	depthDesc.Format = m_format;
+	depthDesc.SampleDesc.Count = 1;
+	depthDesc.SampleDesc.Quality = 0;
+	depthDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+	depthDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+
+	D3D12_CLEAR_VALUE depthClear;
+	depthClear.Format = DXGI_FORMAT_D32_FLOAT;
+	depthClear.DepthStencil.Depth = 0.0f;
+	depthClear.DepthStencil.Stencil = 0;
+
+	const auto& properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	ThrowIfFailed(m_device->CreateCommittedResource(&properties, D3D12_HEAP_FLAG_NONE, &depthDesc, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, &depthClear, IID_PPV_ARGS(m_resource.ReleaseAndGetAddressOf())));
+	CreateTileLightBuffer();
+}
+
+void ForwardPlus::CreateTileLightBuffer()
+{
+	const auto& properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	const UINT64 byteSize = sizeof(UINT) * static_cast<UINT64>(m_tileCountX) * m_tileCountY * m_tileLightWords;
+	const auto& bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(byteSize, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+	ThrowIfFailed(m_device->CreateCommittedResource(&properties, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr, IID_PPV_ARGS(m_tileLightBuffer.ReleaseAndGetAddressOf())));
 }
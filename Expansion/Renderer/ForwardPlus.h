@@ -1,11 +1,31 @@
 #pragma once
 #include "IRenderer.h"
+#include "TileBasedDefer.h"
 
 namespace Renderer
 {
+/*
+ * ͸Forward+ȾTileBasedDefer֮
+ * 1. ԤȾ͸ֻдԼȻõÿ͸
+ * 2. Դ޳TileBased.hlslеCullLights͸G-BufferȷֿȷΧTileBasedDeferϴĵԴ׶棬λдԴ
+ * 3. ǰɫ͸ԶϣضȡڷֿĹԴλ˲ӳȾֻܴ͸
+ * ֿԴбCPU汾TileLightList˳TransparentSort
+ */
 class ForwardPlus final : public IRenderer
 {
 public:
+	// DrawвdrawFuncⲿ󶨶Ӧĸ͸
+	enum Pass : UINT
+	{
+		depthPrePass = 0,
+		lightCullingPass,	// ֻ󶨼ǩcbPass(0)G-Buffer(1)
+		shadingPass
+	};
+	// ǰɫǩռõĸ
+	static constexpr UINT	lightsRootParam = 12;
+	static constexpr UINT	tileBitsRootParam = 13;
+	static constexpr UINT	tileConstantRootParam = 14;
+
 	ForwardPlus(ID3D12Device* _device, UINT _width, UINT _height, DXGI_FORMAT _format);
 	ForwardPlus(const ForwardPlus&) = delete;
 	ForwardPlus& operator=(const ForwardPlus&) = delete;
@@ -13,7 +33,34 @@ public:
 	ForwardPlus& operator=(ForwardPlus&&) = default;
 	~ForwardPlus() override = default;
 
+	void InitRootSignature();
+	void InitPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& templateDesc) override;
+	void InitTexture() override;
+	void CreateDescriptors(D3D12_CPU_DESCRIPTOR_HANDLE srvCpuStart, D3D12_CPU_DESCRIPTOR_HANDLE rtvCpuStart, D3D12_CPU_DESCRIPTOR_HANDLE dsvCpuStart, D3D12_GPU_DESCRIPTOR_HANDLE srvGpuStart, UINT srvSize, UINT rtvSize, UINT dsvSize) override;
+
+	void Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc) override;
+	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) override;
+	// ɫдopaqueȾĿ꣬sceneDSVΪ͸Ȼ
+	void SetOpaqueRenderer(const TileBasedDefer* opaque, D3D12_CPU_DESCRIPTOR_HANDLE sceneDSV);
 private:
+	void InitDSV(D3D12_CPU_DESCRIPTOR_HANDLE _cpuDSV, UINT dsvSize) override;
+	void CreateDescriptors() override;
+	void CreateResources() override;
+	// m_tileLightWordsֿԴλ򣬾ɵĻɵ߸GPU
+	void CreateTileLightBuffer();
+private:
+	ComPtr<ID3D12RootSignature>		m_cullRootSig;
+	ComPtr<ID3D12PipelineState>		m_cullPso;
+	ComPtr<ID3D12PipelineState>		m_depthPso;
+	// ÿֿm_tileLightWordsuintԴʱ
+	ComPtr<ID3D12Resource>			m_tileLightBuffer;
+	// ǰĻͬһ֡Դһλƣʱ֡ΧѾ
+	std::array<ComPtr<ID3D12Resource>, frameResourcesCount>	m_retiredTileLightBuffers;
+	const TileBasedDefer*			m_opaque{ nullptr };
+	CD3DX12_CPU_DESCRIPTOR_HANDLE	m_sceneDSV;
+	UINT							m_depthIdx;
+	UINT							m_tileCountX{ 0 };
+	UINT							m_tileCountY{ 0 };
+	UINT							m_tileLightWords{ MAX_TILE_LIGHTS >> 5 };
 };
 }
-
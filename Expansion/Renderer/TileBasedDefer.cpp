@@ -1,13 +1,14 @@
 #include "TileBasedDefer.h"
+#include <algorithm>
 #include "RtvDsvMgr.h"
 #include "Texture.h"
+#include "UploadRing.h"
 #include <DirectXColors.h>
 
 using namespace Renderer;
 
 TileBasedDefer::TileBasedDefer(ID3D12Device* _device, UINT _width, UINT _height, DXGI_FORMAT _format)
-: IRenderer(_device, _width, _height, _format),
-m_pointLightUploader(std::make_unique<UploaderBuffer<LightInCompute>>(_device, pointLightNum, false))
+: IRenderer(_device, _width, _height, _format)
 {
 	m_rtvOffset = RtvDsvMgr::instance().RegisterRTV(2);
 	CreateResources();
@@ -19,16 +20,22 @@ void TileBasedDefer::InitRootSignature()
 	gBufferTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 3, 1, 0);
 	CD3DX12_DESCRIPTOR_RANGE outputTable;
 	outputTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 2, 1, 0);
-	CD3DX12_ROOT_PARAMETER parameters[5]{};
+	CD3DX12_ROOT_PARAMETER parameters[9]{};
 	parameters[0].InitAsConstantBufferView(0);
 	parameters[1].InitAsDescriptorTable(1, &gBufferTable);
 	parameters[2].InitAsDescriptorTable(1, &outputTable);
 	parameters[3].InitAsShaderResourceView(0);
 	parameters[4].InitAsConstants(4, 1, 0);
+	// ִذ汾ʹõĴطΧԴбز
+	parameters[5].InitAsShaderResourceView(4);
+	parameters[6].InitAsShaderResourceView(5);
+	parameters[7].InitAsConstants(sizeof(ClusterConstant) / sizeof(UINT), 2, 0);
+	// ֿ汾ʹõ׶
+	parameters[8].InitAsShaderResourceView(6);
 
 	auto sampler = GetStaticSampler();
 	// ɸǩ
-	CD3DX12_ROOT_SIGNATURE_DESC rootDesc(5U, parameters, sampler.size(), sampler.data(), D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+	CD3DX12_ROOT_SIGNATURE_DESC rootDesc(9U, parameters, sampler.size(), sampler.data(), D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 	ComPtr<ID3DBlob> serializeRootSig{ nullptr };
 	ComPtr<ID3DBlob> error{ nullptr };
 	auto res = D3D12SerializeRootSignature(&rootDesc, D3D_ROOT_SIGNATURE_VERSION_1, serializeRootSig.GetAddressOf(), error.GetAddressOf());
@@ -60,6 +67,16 @@ void TileBasedDefer::InitPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& templateD
 	pointDesc.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
 	pointDesc.NodeMask = 0;
 	ThrowIfFailed(m_device->CreateComputePipelineState(&pointDesc, IID_PPV_ARGS(&m_pointPso)));
+
+	pointDesc.CS = { m_shaderPack[L"Shaders\\TileBased_DeferClustered"]->GetShaderByType(ShaderPos::compute)->GetBufferPointer(), m_shaderPack[L"Shaders\\TileBased_DeferClustered"]->GetShaderByType(ShaderPos::compute)->GetBufferSize() };
+	ThrowIfFailed(m_device->CreateComputePipelineState(&pointDesc, IID_PPV_ARGS(&m_clusteredPso)));
+
+	// УCPUõĽṹ岼֣¶ִУShaderConfig.hɫһʱڳʼ׶α
+	m_shaderPack[L"Shaders\\Box"]->CheckConstantBuffer(ShaderPos::fragment, "cbPass", sizeof(PassConstant));
+	m_shaderPack[L"Shaders\\TileBased_Defer"]->CheckConstantBuffer(ShaderPos::compute, "cbPass", sizeof(PostProcessPass));
+	m_shaderPack[L"Shaders\\TileBased_Defer"]->CheckConstantBuffer(ShaderPos::compute, "cbDebug", sizeof(UINT) * 4);
+	m_shaderPack[L"Shaders\\TileBased_Defer"]->CheckStructuredBuffer(ShaderPos::compute, "sbLights", sizeof(LightInCompute));
+	m_shaderPack[L"Shaders\\TileBased_DeferClustered"]->CheckConstantBuffer(ShaderPos::compute, "cbCluster", sizeof(ClusterConstant));
 }
 
 void TileBasedDefer::InitTexture()
@@ -96,8 +113,9 @@ void TileBasedDefer::Update(const GameTimer& timer, const std::function<void(UIN
 
 }
 
-void TileBasedDefer::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const
+void TileBasedDefer::Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc)
 {
+	FlushBarriers(cmdList);
 	cmdList->ClearRenderTargetView(m_bloomRTV[0], Colors::LightSteelBlue, 0, nullptr);
 	cmdList->ClearRenderTargetView(m_bloomRTV[1], Colors::LightSteelBlue, 0, nullptr);
 	cmdList->OMSetRenderTargets(2, &m_bloomRTV[0], true, &m_cpuDSV);
@@ -108,27 +126,120 @@ void TileBasedDefer::Draw(ID3D12GraphicsCommandList* cmdList, const std::functio
 	ChangeState<D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_UNORDERED_ACCESS>(cmdList, m_bloomRes.Get());
 
 	cmdList->SetComputeRootSignature(m_pointRootSig.Get());
-	cmdList->SetPipelineState(m_pointPso.Get());
 	// DrawFuncҪgBuffercbPass
 	drawFunc(NULL);
-	constexpr UINT debug[] = { false, false, false, false };
+	// ԴMAX_TILE_LIGHTSʱɫ޳
+	const UINT debug[] = { false, false, m_pointLightCount, 0 };
 	cmdList->SetComputeRoot32BitConstants(4U, 4, &debug, 0);
 	cmdList->SetComputeRootDescriptorTable(2, m_bloomGpuUAV[0]);
-	cmdList->SetComputeRootShaderResourceView(3, m_pointLightUploader->GetResource()->GetGPUVirtualAddress());
-	const UINT groupX = static_cast<UINT>(std::ceilf(static_cast<float>(m_width) / 16.0f));
-	const UINT groupY = static_cast<UINT>(std::ceilf(static_cast<float>(m_height) / 16.0f));
+	cmdList->SetComputeRootShaderResourceView(3, GetPointLightAddress());
+	// ׶ͬʱForwardPlus޳Դִģʽͬ
+	// ֻõm00m11TAAֻıУʹ޶ͶӰ
+	const XMFLOAT4X4& proj = m_camera->GetNonjitteredProj();
+	if (m_frustumCache.Update(m_camera->GetProjectionVersion(), proj._11, proj._22, m_width, m_height))
+	{
+		UploadTilePlanes(cmdList);
+	}
+	if (m_lightCulling == LightCulling::Clustered)
+	{
+		// ÿ֡ؽӻϴз
+		const auto& grid = m_clusterGrid.GetGrid();
+		const auto& indices = m_clusterGrid.GetLightIndices();
+		auto& uploadRing = UploadRing::instance();
+		// бҲҪϷĵַ
+		const auto gridAlloc = uploadRing.Allocate<ClusterRange>(std::max(static_cast<UINT>(grid.size()), 1U), false);
+		memcpy(gridAlloc.cpuAddress, grid.data(), sizeof(ClusterRange) * grid.size());
+		const auto indexAlloc = uploadRing.Allocate<UINT>(std::max(static_cast<UINT>(indices.size()), 1U), false);
+		memcpy(indexAlloc.cpuAddress, indices.data(), sizeof(UINT) * indices.size());
+		const ClusterConstant constant = m_clusterGrid.GetConstant();
+		cmdList->SetComputeRootShaderResourceView(5, gridAlloc.GetAddress());
+		cmdList->SetComputeRootShaderResourceView(6, indexAlloc.GetAddress());
+		cmdList->SetComputeRoot32BitConstants(7U, sizeof(ClusterConstant) / sizeof(UINT), &constant, 0);
+		cmdList->SetPipelineState(m_clusteredPso.Get());
+	}
+	else
+	{
+		cmdList->SetComputeRootShaderResourceView(8, GetTilePlaneAddress());
+		cmdList->SetPipelineState(m_pointPso.Get());
+	}
+	const UINT groupX = (m_width + TILE_GROUP_DIM - 1) / TILE_GROUP_DIM;
+	const UINT groupY = (m_height + TILE_GROUP_DIM - 1) / TILE_GROUP_DIM;
+	FlushBarriers(cmdList);
 	cmdList->Dispatch(groupX, groupY, 1);
 	ChangeState<D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_RENDER_TARGET>(cmdList, m_resource.Get());
 	ChangeState<D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_RENDER_TARGET>(cmdList, m_bloomRes.Get());
 }
 
-void TileBasedDefer::UpdatePointLights(const vector<std::shared_ptr<Light<Compute>>>& points) const
+void TileBasedDefer::UpdatePointLights(UINT frameIndex, const LightInCompute* lights, UINT count)
+{
+	auto& uploader = m_pointLightUploaders[frameIndex];
+	// ݣбҲҪϷĵַ
+	if (!uploader || m_pointLightCapacity[frameIndex] < count)
+	{
+		m_pointLightCapacity[frameIndex] = std::max({ count, m_pointLightCapacity[frameIndex] * 2, 1U });
+		uploader = std::make_unique<UploaderBuffer<LightInCompute>>(m_device.Get(), m_pointLightCapacity[frameIndex], false);
+	}
+	uploader->CopyRange(0, lights, count);
+	m_pointLightFrame = frameIndex;
+	m_pointLightCount = count;
+	if (m_lightCulling != LightCulling::Clustered || !m_camera)
+		return;
+	// صĻʹ޶ͶӰTAAһأ64صķֿԺ
+	const XMMATRIX proj = m_camera->GetNonjitteredProjXM();
+	m_clusterGrid.SetView(m_width, m_height, XMVectorGetX(proj.r[0]), XMVectorGetY(proj.r[1]), m_camera->m_nearPlane, m_camera->m_farPlane);
+	m_clusterGrid.Build(lights, count);
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS TileBasedDefer::GetPointLightAddress() const
+{
+	return m_pointLightUploaders[m_pointLightFrame]->GetResource()->GetGPUVirtualAddress();
+}
+
+UINT TileBasedDefer::GetPointLightCount() const
+{
+	return m_pointLightCount;
+}
+
+UINT TileBasedDefer::GetPointLightFrame() const
+{
+	return m_pointLightFrame;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS TileBasedDefer::GetTilePlaneAddress() const
 {
-	for (UINT i = 0; i < pointLightNum; ++i)
+	return m_tilePlaneBuffer->GetGPUVirtualAddress();
+}
+
+void TileBasedDefer::UploadTilePlanes(ID3D12GraphicsCommandList* cmdList)
+{
+	const auto& planes = m_frustumCache.GetPlanes();
+	const UINT64 byteSize = sizeof(XMFLOAT4) * planes.size();
+	if (!m_tilePlaneBuffer || m_tilePlaneBuffer->GetDesc().Width < byteSize)
 	{
-		LightInCompute light = points[i]->GetData();
-		m_pointLightUploader->Copy(i, light);
+		// ֱֻֿʱ仯OnResizeǰѱգɻֱͷ
+		const auto& properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+		const auto& bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(byteSize);
+		ThrowIfFailed(m_device->CreateCommittedResource(&properties, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(m_tilePlaneBuffer.ReleaseAndGetAddressOf())));
 	}
+	else
+	{
+		ChangeState<D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_DEST>(cmdList, m_tilePlaneBuffer.Get());
+	}
+	const auto allocation = UploadRing::instance().Allocate(byteSize, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT);
+	memcpy(allocation.cpuAddress, planes.data(), byteSize);
+	FlushBarriers(cmdList);
+	cmdList->CopyBufferRegion(m_tilePlaneBuffer.Get(), 0, allocation.resource, allocation.offset, byteSize);
+	ChangeState<D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE>(cmdList, m_tilePlaneBuffer.Get());
+}
+
+void TileBasedDefer::SetCamera(const std::shared_ptr<Camera>& camera)
+{
+	m_camera = camera;
+}
+
+void TileBasedDefer::SetLightCulling(LightCulling mode)
+{
+	m_lightCulling = mode;
 }
 
 auto TileBasedDefer::GetStaticSampler() -> std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> const
@@ -1,9 +1,18 @@
 #pragma once
 #include "IRenderer.h"
+#include "Camera.h"
+#include "ClusteredLightGrid.h"
+#include "TileFrustumCache.h"
 #include "UploaderBuffer.hpp"
 
 namespace Renderer
 {
+enum class LightCulling
+{
+	TileBased,	// ɫֿ鰴ȷΧ޳
+	Clustered	// CPU˰froxelԴ
+};
+
 class TileBasedDefer final : public IRenderer
 {
 public:
@@ -20,17 +29,41 @@ public:
 	void CreateDescriptors(D3D12_CPU_DESCRIPTOR_HANDLE srvCpuStart, D3D12_CPU_DESCRIPTOR_HANDLE rtvCpuStart, D3D12_CPU_DESCRIPTOR_HANDLE dsvCpuStart, D3D12_GPU_DESCRIPTOR_HANDLE srvGpuStart, UINT srvSize, UINT rtvSize, UINT dsvSize) override;
 
 	void Update(const GameTimer& timer, const std::function<void(UINT, PassConstant&)>& updateFunc) override;
-	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) const override;
-	void UpdatePointLights(const vector<std::shared_ptr<Light<Compute>>>& points) const;
+	void Draw(ID3D12GraphicsCommandList* cmdList, const std::function<void(UINT)>& drawFunc) override;
+	/*
+	 * lightsΪеcountյԴдframeIndexӦ֡Դϴ
+	 * ֡ԴΧѾʱãʱڴ·䣬Ӱ;֡ȡĻ
+	 */
+	void UpdatePointLights(UINT frameIndex, const LightInCompute* lights, UINT count);
+	void SetCamera(const std::shared_ptr<Camera>& camera);
+	void SetLightCulling(LightCulling mode);
+	// ForwardPlusñ֡ϴĵԴ׶
+	D3D12_GPU_VIRTUAL_ADDRESS GetPointLightAddress() const;
+	// ֡ϴĵԴֿ޳ÿMAX_TILE_LIGHTSյȫɫ
+	UINT GetPointLightCount() const;
+	// ֡Դڵ֡Դ
+	UINT GetPointLightFrame() const;
+	D3D12_GPU_VIRTUAL_ADDRESS GetTilePlaneAddress() const;
 private:
 	auto GetStaticSampler()->std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> const;
 	void InitDSV(D3D12_CPU_DESCRIPTOR_HANDLE _cpuDSV, UINT dsvSize) override;
 	void CreateDescriptors() override;
 	void CreateResources() override;
+	// ׶ֻͶӰֱʱ仯ʱϴѿĬ϶
+	void UploadTilePlanes(ID3D12GraphicsCommandList* cmdList);
 private:
 	ComPtr<ID3D12RootSignature>						m_pointRootSig;
 	ComPtr<ID3D12PipelineState>						m_pointPso;
-	std::unique_ptr<UploaderBuffer<LightInCompute>>	m_pointLightUploader;
+	ComPtr<ID3D12PipelineState>						m_clusteredPso;
+	std::array<std::unique_ptr<UploaderBuffer<LightInCompute>>, frameResourcesCount>	m_pointLightUploaders;
+	std::array<UINT, frameResourcesCount>			m_pointLightCapacity{};
+	UINT											m_pointLightFrame{ 0 };
+	UINT											m_pointLightCount{ 0 };
+	std::shared_ptr<Camera>							m_camera;
+	LightCulling									m_lightCulling{ LightCulling::TileBased };
+	ClusteredLightGrid								m_clusterGrid;
+	TileFrustumCache								m_frustumCache;
+	ComPtr<ID3D12Resource>							m_tilePlaneBuffer;
 	CD3DX12_CPU_DESCRIPTOR_HANDLE					m_bloomCpuUAV[2];
 	CD3DX12_GPU_DESCRIPTOR_HANDLE					m_bloomGpuUAV[2];
 };
@@ -0,0 +1,675 @@
+#include "TileBasedReference.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include "DDSFile.h"
+#include "MappedFile.h"
+#include "ThreadPool.hpp"
+
+using namespace Renderer;
+using namespace DirectX;
+
+namespace
+{
+constexpr float	PI = 3.141592653589793f;
+constexpr float	INV_PI = 0.3183098861837907f;
+
+// ɫfloat3ı汾
+struct Float3
+{
+	float	x, y, z;
+};
+
+Float3 operator+(const Float3& a, const Float3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+Float3 operator-(const Float3& a, const Float3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+Float3 operator*(const Float3& a, const Float3& b) { return { a.x * b.x, a.y * b.y, a.z * b.z }; }
+Float3 operator*(const Float3& a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+
+float Dot(const Float3& a, const Float3& b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+Float3 Normalize(const Float3& v)
+{
+	return v * (1.0f / std::sqrt(Dot(v, v)));
+}
+
+Float3 Load(const XMFLOAT3& v)
+{
+	return { v.x, v.y, v.z };
+}
+
+XMFLOAT4 Lerp(const XMFLOAT4& a, const XMFLOAT4& b, float t)
+{
+	return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t };
+}
+
+float Saturate(float v)
+{
+	return std::min(std::max(v, 0.0f), 1.0f);
+}
+
+// fxcݵpowչΪ˷
+float Pow5(float v)
+{
+	return v * v * v * v * v;
+}
+
+float HalfToFloat(uint16_t h)
+{
+	const uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+	const uint32_t exponent = (h >> 10) & 0x1F;
+	uint32_t mantissa = h & 0x3FF;
+	uint32_t bits;
+	if (exponent == 0x1F)
+	{
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else if (exponent != 0)
+	{
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	else if (mantissa == 0)
+	{
+		bits = sign;
+	}
+	else
+	{
+		// ǹ
+		uint32_t e = 113;
+		while ((mantissa & 0x400) == 0)
+		{
+			mantissa <<= 1;
+			--e;
+		}
+		bits = sign | (e << 23) | ((mantissa & 0x3FF) << 13);
+	}
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+float SnormToFloat(int16_t v)
+{
+	return std::max(static_cast<float>(v) / 32767.0f, -1.0f);
+}
+
+XMFLOAT4 DecodeTexel(DDSFormat format, const uint8_t* texel)
+{
+	switch (format)
+	{
+	case DDSFormat::R32G32B32A32_FLOAT:
+	{
+		XMFLOAT4 result;
+		memcpy(&result, texel, sizeof(result));
+		return result;
+	}
+	case DDSFormat::R16G16B16A16_FLOAT:
+	{
+		uint16_t v[4];
+		memcpy(v, texel, sizeof(v));
+		return { HalfToFloat(v[0]), HalfToFloat(v[1]), HalfToFloat(v[2]), HalfToFloat(v[3]) };
+	}
+	case DDSFormat::R16G16B16A16_SNORM:
+	{
+		int16_t v[4];
+		memcpy(v, texel, sizeof(v));
+		return { SnormToFloat(v[0]), SnormToFloat(v[1]), SnormToFloat(v[2]), SnormToFloat(v[3]) };
+	}
+	case DDSFormat::R10G10B10A2_UNORM:
+	{
+		uint32_t v;
+		memcpy(&v, texel, sizeof(v));
+		return { static_cast<float>(v & 0x3FF) / 1023.0f, static_cast<float>((v >> 10) & 0x3FF) / 1023.0f,
+			static_cast<float>((v >> 20) & 0x3FF) / 1023.0f, static_cast<float>(v >> 30) / 3.0f };
+	}
+	case DDSFormat::R32_FLOAT:
+	{
+		float v;
+		memcpy(&v, texel, sizeof(v));
+		return { v, 0.0f, 0.0f, 1.0f };
+	}
+	case DDSFormat::R8G8B8A8_UNORM:
+		return { texel[0] / 255.0f, texel[1] / 255.0f, texel[2] / 255.0f, texel[3] / 255.0f };
+	default:
+		return { 0.0f, 0.0f, 0.0f, 0.0f };
+	}
+}
+
+bool IsGBufferFormat(DDSFormat format)
+{
+	switch (format)
+	{
+	case DDSFormat::R32G32B32A32_FLOAT:
+	case DDSFormat::R16G16B16A16_FLOAT:
+	case DDSFormat::R16G16B16A16_SNORM:
+	case DDSFormat::R10G10B10A2_UNORM:
+	case DDSFormat::R32_FLOAT:
+	case DDSFormat::R8G8B8A8_UNORM:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/*
+ * DecodeGBufferuv = dispatchID * invSizeؽϣ
+ * ˫(Բmip 0֮ͬ)˵Ľ4صľֵ߽簴clamp
+ */
+XMFLOAT4 SampleCorner(const std::vector<XMFLOAT4>& texture, uint32_t width, uint32_t height, uint32_t x, uint32_t y)
+{
+	const uint32_t x0 = std::min(x == 0 ? 0 : x - 1, width - 1);
+	const uint32_t x1 = std::min(x, width - 1);
+	const uint32_t y0 = std::min(y == 0 ? 0 : y - 1, height - 1);
+	const uint32_t y1 = std::min(y, height - 1);
+	const XMFLOAT4 top = Lerp(texture[static_cast<size_t>(y0) * width + x0], texture[static_cast<size_t>(y0) * width + x1], 0.5f);
+	const XMFLOAT4 bottom = Lerp(texture[static_cast<size_t>(y1) * width + x0], texture[static_cast<size_t>(y1) * width + x1], 0.5f);
+	return Lerp(top, bottom, 0.5f);
+}
+
+float Luminance(const Float3& col)
+{
+	return Dot(col, { 0.2126f, 0.7152f, 0.0722f });
+}
+
+// BRDF.hlsl
+float GGX(float ndoth, float r2)
+{
+	const float r4 = r2 * r2;
+	const float ndoth2 = ndoth * ndoth;
+	const float denom = PI * (ndoth2 * (r4 - 1.0f) + 1.0f) * (ndoth2 * (r4 - 1.0f) + 1.0f);
+	return r4 / denom;
+}
+
+float Geometry_UE(float ndotv, float ndotl, float roughness)
+{
+	const float r = roughness + 1.0f;
+	const float k = r / 8.0f;
+	const float GL = ndotl / (ndotl * (1.0f - k) + k);
+	const float GV = ndotv / (ndotv * (1.0f - k) + k);
+	return GL * GV * (1.0f / (4.0f * ndotl * ndotv + 1e-5f));
+}
+
+Float3 Fresnel(float hdotv, const Float3& f0)
+{
+	const float f = Pow5(1.0f - hdotv);
+	return { f0.x + (1.0f - f0.x) * f, f0.y + (1.0f - f0.y) * f, f0.z + (1.0f - f0.z) * f };
+}
+
+float LightAttenuation(float dist, float fallOffStart, float fallOffEnd)
+{
+	return Saturate((fallOffEnd - dist) / (fallOffEnd - fallOffStart));
+}
+
+Float3 PhysicalShading(const Float3& albedo, float roughness, float metalness, float ndotv, float ndotl, float ndoth, float hdotv)
+{
+	const float r2 = roughness * roughness;
+	const Float3 f0 = Float3{ 0.04f, 0.04f, 0.04f } + (albedo - Float3{ 0.04f, 0.04f, 0.04f }) * metalness;
+	const Float3 fresnel = Fresnel(hdotv, f0);
+
+	const Float3 kd = (Float3{ 1.0f, 1.0f, 1.0f } - fresnel) * (1.0f - metalness);
+	const Float3 diffuse = kd * INV_PI * albedo;
+
+	const Float3 specular = fresnel * (GGX(ndoth, r2) * Geometry_UE(ndotv, ndotl, r2));
+	return (diffuse + specular) * ndotl;
+}
+
+// TileBased.hlslеComputePointLight
+Float3 ComputePointLight(const LightInCompute& light, const Float3& albedo, float roughness, float metalness, const Float3& posV, const Float3& normalDir, const Float3& viewDir)
+{
+	Float3 lightDir = Load(light.posV) - posV;
+	const float dist = std::sqrt(Dot(lightDir, lightDir));
+	lightDir = Normalize(lightDir);
+	const float attenuation = LightAttenuation(dist, light.fallOffStart, light.fallOffEnd);
+	const Float3 halfDir = Normalize(viewDir + lightDir);
+
+	const float ndotl = Dot(normalDir, lightDir);
+	const float ndotv = Dot(normalDir, viewDir);
+	const float ndoth = Dot(normalDir, halfDir);
+	const float hdotv = Dot(halfDir, viewDir);
+	return PhysicalShading(albedo, roughness, metalness, ndotv, ndotl, ndoth, hdotv) * Load(light.strength) * attenuation;
+}
+
+constexpr uint32_t	depthMaskBits = DEPTH_MASK_BITS;
+
+// TileBased.hlslеDepthMaskSlot
+uint32_t DepthMaskSlot(float viewZ, float tileMinZ, float depthScale)
+{
+	return static_cast<uint32_t>(std::min(std::max((viewZ - tileMinZ) * depthScale, 0.0f), static_cast<float>(depthMaskBits - 1)));
+}
+
+uint32_t FirstBitLow(uint32_t v)
+{
+	uint32_t bit = 0;
+	while ((v & 1) == 0)
+	{
+		v >>= 1;
+		++bit;
+	}
+	return bit;
+}
+
+double ElapsedMs(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+}
+
+TileBasedReference::TileBasedReference(uint32_t tileSize, uint32_t listCapacity)
+	: m_tileSize(std::max(tileSize, 1u)), m_listCapacity(std::max(listCapacity, 1u)), m_frustumCache(m_tileSize)
+{
+}
+
+bool TileBasedReference::ReadImage(const std::filesystem::path& path, uint32_t& width, uint32_t& height, std::vector<XMFLOAT4>& pixels)
+{
+	MappedFile file;
+	if (!file.Open(path))
+	{
+		std::cout << "can't open G-Buffer file " << path << std::endl;
+		return false;
+	}
+	DDSFile dds;
+	if (!dds.Parse(file.GetData(), file.GetSize()))
+	{
+		std::cout << "invalid DDS file " << path << std::endl;
+		return false;
+	}
+	const DDSTextureInfo& info = dds.GetInfo();
+	if (!IsGBufferFormat(info.format))
+	{
+		std::cout << "unsupported G-Buffer format " << static_cast<uint32_t>(info.format) << " in " << path << std::endl;
+		return false;
+	}
+	const DDSSubresource& top = dds.GetSubresource(0, 0);
+	const uint32_t elementSize = DDSFile::GetElementSize(info.format);
+	width = top.width;
+	height = top.height;
+	pixels.resize(static_cast<size_t>(width) * height);
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		const uint8_t* row = top.data + y * top.rowPitch;
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			pixels[static_cast<size_t>(y) * width + x] = DecodeTexel(info.format, row + static_cast<size_t>(x) * elementSize);
+		}
+	}
+	return true;
+}
+
+bool TileBasedReference::LoadGBuffer(const std::filesystem::path& albedo, const std::filesystem::path& depth, const std::filesystem::path& mixed)
+{
+	uint32_t width[3], height[3];
+	std::vector<XMFLOAT4> images[3];
+	if (!ReadImage(albedo, width[0], height[0], images[0]) || !ReadImage(depth, width[1], height[1], images[1]) || !ReadImage(mixed, width[2], height[2], images[2]))
+		return false;
+	if (width[0] != width[1] || width[0] != width[2] || height[0] != height[1] || height[0] != height[2])
+	{
+		std::cout << "G-Buffer size mismatch" << std::endl;
+		return false;
+	}
+	SetGBuffer(width[0], height[0], std::move(images[0]), std::move(images[1]), std::move(images[2]));
+	return true;
+}
+
+void TileBasedReference::SetGBuffer(uint32_t width, uint32_t height, std::vector<XMFLOAT4> albedo, std::vector<XMFLOAT4> depth, std::vector<XMFLOAT4> mixed)
+{
+	m_width = width;
+	m_height = height;
+	m_albedo = std::move(albedo);
+	m_depth = std::move(depth);
+	m_mixed = std::move(mixed);
+	m_tileCountX = (width + m_tileSize - 1) / m_tileSize;
+	m_tileCountY = (height + m_tileSize - 1) / m_tileSize;
+	// ֱʱ仯һRunʱؽ׶
+	m_frustumProjX = 0.0f;
+	m_frustumProjY = 0.0f;
+}
+
+void TileBasedReference::SetCullingMode(TileCullingMode mode)
+{
+	m_mode = mode;
+}
+
+void TileBasedReference::Run(const TileReferenceView& view, const LightInCompute* lights, uint32_t count, bool visualizeLightCount)
+{
+	const size_t tileCount = static_cast<size_t>(m_tileCountX) * m_tileCountY;
+	const size_t pixelCount = static_cast<size_t>(m_width) * m_height;
+	m_pixels.resize(pixelCount);
+	m_tileLightCounts.assign(tileCount, 0);
+	m_tileDepthRanges.resize(tileCount);
+	m_tileDepthMasks.assign(tileCount, 0);
+	if (m_mode == TileCullingMode::MinMax)
+	{
+		m_lightWords = 0;
+		m_tileLightBits.clear();
+		m_tileLightLists.assign(tileCount * m_listCapacity, 0);
+	}
+	else
+	{
+		m_lightWords = (count + 31) / 32;
+		m_tileLightBits.assign(tileCount * m_lightWords, 0);
+		m_tileLightLists.clear();
+	}
+	// GPUһٶɫǰ
+	m_shaded.assign(pixelCount, { 0.0f, 0.0f, 0.0f, 0.0f });
+	m_bloom.assign(pixelCount, { 0.0f, 0.0f, 0.0f, 0.0f });
+	m_stats = TileReferenceStats{};
+	m_stats.tileCountX = m_tileCountX;
+	m_stats.tileCountY = m_tileCountY;
+	if (tileCount == 0)
+		return;
+	if (m_frustumProjX != view.proj._11 || m_frustumProjY != view.proj._22)
+	{
+		m_frustumCache.Build(m_width, m_height, view.proj._11, view.proj._22);
+		m_frustumProjX = view.proj._11;
+		m_frustumProjY = view.proj._22;
+	}
+
+	// ֿ֮以ԷֿΪλַ̳߳
+	auto& pool = Thread::ThreadPool::instance();
+	auto start = std::chrono::steady_clock::now();
+	pool.ParallelFor(0, m_tileCountY, 1, [&](uint32_t tileY)
+	{
+		for (uint32_t tileX = 0; tileX < m_tileCountX; ++tileX)
+			CullTile(view, lights, count, tileX, tileY);
+	});
+	m_stats.cullTime = ElapsedMs(start);
+
+	start = std::chrono::steady_clock::now();
+	pool.ParallelFor(0, m_tileCountY, 1, [&](uint32_t tileY)
+	{
+		for (uint32_t tileX = 0; tileX < m_tileCountX; ++tileX)
+			ShadeTile(lights, visualizeLightCount, tileX, tileY);
+	});
+	m_stats.shadeTime = ElapsedMs(start);
+
+	std::vector<uint32_t> falsePositives(m_tileCountY, 0);
+	pool.ParallelFor(0, m_tileCountY, 1, [&](uint32_t tileY)
+	{
+		for (uint32_t tileX = 0; tileX < m_tileCountX; ++tileX)
+			falsePositives[tileY] += CountFalsePositives(view, lights, tileX, tileY);
+	});
+	for (uint32_t tileFalsePositives : falsePositives)
+		m_stats.falsePositives += tileFalsePositives;
+
+	uint64_t totalLights = 0;
+	for (uint32_t lightCount : m_tileLightCounts)
+	{
+		totalLights += lightCount;
+		m_stats.maxTileLights = std::max(m_stats.maxTileLights, lightCount);
+		if (lightCount == 0)
+			++m_stats.emptyTiles;
+		if (m_mode == TileCullingMode::MinMax && lightCount > m_listCapacity)
+		{
+			++m_stats.overflowTiles;
+			m_stats.droppedLights += lightCount - m_listCapacity;
+		}
+	}
+	m_stats.averageTileLights = static_cast<float>(static_cast<double>(totalLights) / static_cast<double>(tileCount));
+}
+
+TileBasedReference::PixelData TileBasedReference::Decode(const TileReferenceView& view, uint32_t x, uint32_t y) const
+{
+	const float invWidth = 1.0f / static_cast<float>(m_width);
+	const float invHeight = 1.0f / static_cast<float>(m_height);
+	const float posNDCX = (static_cast<float>(x) + 0.5f) * (2.0f * invWidth) - 1.0f;
+	const float posNDCY = (static_cast<float>(y) + 0.5f) * (-2.0f * invHeight) + 1.0f;
+
+	PixelData data;
+	const XMFLOAT4 albedo = SampleCorner(m_albedo, m_width, m_height, x, y);
+	data.albedo = { albedo.x, albedo.y, albedo.z };
+	const float ndcZ = SampleCorner(m_depth, m_width, m_height, x, y).x;
+	const float viewZ = view.proj._43 / (ndcZ - view.proj._33);
+	data.viewPos = { posNDCX / view.proj._11 * viewZ, posNDCY / view.proj._22 * viewZ, viewZ };
+
+	const XMFLOAT4 mixed = SampleCorner(m_mixed, m_width, m_height, x, y);
+	// DecodeSphereMap
+	const float l = 1.0f - mixed.x * mixed.x - mixed.y * mixed.y;
+	const float s = std::sqrt(l);
+	const Float3 normalW{ mixed.x * s * 2.0f, mixed.y * s * 2.0f, l * 2.0f - 1.0f };
+	// mul(float4(normal, 0), g_view)
+	data.normalDir = {
+		normalW.x * view.view._11 + normalW.y * view.view._21 + normalW.z * view.view._31,
+		normalW.x * view.view._12 + normalW.y * view.view._22 + normalW.z * view.view._32,
+		normalW.x * view.view._13 + normalW.y * view.view._23 + normalW.z * view.view._33 };
+	data.roughness = mixed.z;
+	data.metalness = mixed.w;
+	return data;
+}
+
+void TileBasedReference::CullTile(const TileReferenceView& view, const LightInCompute* lights, uint32_t count, uint32_t tileX, uint32_t tileY)
+{
+	const float zNear = std::min(view.nearZ, view.farZ);
+	const float zFar = std::max(view.nearZ, view.farZ);
+	// depthNearFarĳֵΪ(0x7F7FFFFF, 0)ȾΪλȽ밴Ƚϵȼ
+	float tileMinZ = FLT_MAX;
+	float tileMaxZ = 0.0f;
+	// ¼ÿ̵߳ЧȣȷΧȷڹ
+	std::vector<float> threadZ;
+	threadZ.reserve(static_cast<size_t>(m_tileSize) * m_tileSize);
+	for (uint32_t j = 0; j < m_tileSize; ++j)
+	{
+		for (uint32_t i = 0; i < m_tileSize; ++i)
+		{
+			const uint32_t x = tileX * m_tileSize + i;
+			const uint32_t y = tileY * m_tileSize + j;
+			// Ļ߳ͬԼclampıԵ
+			const PixelData data = Decode(view, x, y);
+			if (x < m_width && y < m_height)
+				m_pixels[static_cast<size_t>(y) * m_width + x] = data;
+			if (data.viewPos.z >= zNear && data.viewPos.z < zFar)
+			{
+				tileMinZ = std::min(tileMinZ, data.viewPos.z);
+				tileMaxZ = std::max(tileMaxZ, data.viewPos.z);
+				threadZ.push_back(data.viewPos.z);
+			}
+		}
+	}
+	const size_t tileIdx = static_cast<size_t>(tileY) * m_tileCountX + tileX;
+	m_tileDepthRanges[tileIdx] = { tileMinZ, tileMaxZ };
+
+	// ɫȡͬһTileFrustumCacheԶƽɷֿȷΧ
+	const XMFLOAT4* sidePlanes = &m_frustumCache.GetPlanes()[tileIdx * TileFrustumCache::planesPerTile];
+	const XMFLOAT4 planes[6] = {
+		sidePlanes[0], sidePlanes[1], sidePlanes[2], sidePlanes[3],
+		{ 0.0f, 0.0f, 1.0f, -tileMinZ },
+		{ 0.0f, 0.0f, -1.0f, tileMaxZ } };
+
+	const float depthScale = static_cast<float>(depthMaskBits) / std::max(tileMaxZ - tileMinZ, 1e-4f);
+	uint32_t depthMask = 0;
+	for (float z : threadZ)
+		depthMask |= 1u << DepthMaskSlot(z, tileMinZ, depthScale);
+	m_tileDepthMasks[tileIdx] = depthMask;
+
+	uint32_t lightCount = 0;
+	uint32_t* list = m_mode == TileCullingMode::MinMax ? m_tileLightLists.data() + tileIdx * m_listCapacity : nullptr;
+	uint32_t* bits = m_mode == TileCullingMode::DepthMask ? m_tileLightBits.data() + tileIdx * m_lightWords : nullptr;
+	for (uint32_t idx = 0; idx < count; ++idx)
+	{
+		const LightInCompute& light = lights[idx];
+		bool inFrustum = true;
+		for (const auto& plane : planes)
+		{
+			const float dist = plane.x * light.posV.x + plane.y * light.posV.y + plane.z * light.posV.z + plane.w;
+			inFrustum = inFrustum && (dist >= -light.fallOffEnd);
+		}
+		if (!inFrustum)
+			continue;
+		if (list)
+		{
+			if (lightCount < m_listCapacity)
+				list[lightCount] = idx;
+			++lightCount;
+			continue;
+		}
+		// ԴΧ򸲸ǵȶֿʵʴصȶཻҪɫ
+		const uint32_t slotMin = DepthMaskSlot(light.posV.z - light.fallOffEnd, tileMinZ, depthScale);
+		const uint32_t slotMax = DepthMaskSlot(light.posV.z + light.fallOffEnd, tileMinZ, depthScale);
+		const uint32_t lightMask = (0xFFFFFFFFu >> (31 - slotMax)) & (0xFFFFFFFFu << slotMin);
+		if (lightMask & depthMask)
+		{
+			bits[idx >> 5] |= 1u << (idx & 31);
+			++lightCount;
+		}
+	}
+	m_tileLightCounts[tileIdx] = lightCount;
+}
+
+template <typename Func>
+void TileBasedReference::ForEachTileLight(size_t tileIdx, Func&& func) const
+{
+	if (m_mode == TileCullingMode::MinMax)
+	{
+		const uint32_t shadeCount = std::min(m_tileLightCounts[tileIdx], m_listCapacity);
+		const uint32_t* list = m_tileLightLists.data() + tileIdx * m_listCapacity;
+		for (uint32_t i = 0; i < shadeCount; ++i)
+			func(list[i]);
+		return;
+	}
+	// ɫһ£ȡλ
+	const uint32_t* bits = m_tileLightBits.data() + tileIdx * m_lightWords;
+	for (uint32_t word = 0; word < m_lightWords; ++word)
+	{
+		for (uint32_t v = bits[word]; v != 0; v &= v - 1)
+			func((word << 5) | FirstBitLow(v));
+	}
+}
+
+void TileBasedReference::ShadeTile(const LightInCompute* lights, bool visualizeLightCount, uint32_t tileX, uint32_t tileY)
+{
+	const size_t tileIdx = static_cast<size_t>(tileY) * m_tileCountX + tileX;
+	const uint32_t lightCount = m_tileLightCounts[tileIdx];
+	const uint32_t endX = std::min((tileX + 1) * m_tileSize, m_width);
+	const uint32_t endY = std::min((tileY + 1) * m_tileSize, m_height);
+	for (uint32_t y = tileY * m_tileSize; y < endY; ++y)
+	{
+		for (uint32_t x = tileX * m_tileSize; x < endX; ++x)
+		{
+			const size_t pixelIdx = static_cast<size_t>(y) * m_width + x;
+			if (visualizeLightCount)
+			{
+				const float v = static_cast<float>(lightCount) / 255.0f;
+				m_shaded[pixelIdx] = { v, v, v, 1.0f };
+				m_bloom[pixelIdx] = { 0.0f, 0.0f, 0.0f, 0.0f };
+				continue;
+			}
+			// DeferǷأպͬۼӹ
+			const PixelData& data = m_pixels[pixelIdx];
+			const Float3 posV = Load(data.viewPos);
+			const Float3 normalDir = Load(data.normalDir);
+			const Float3 albedo = Load(data.albedo);
+			const Float3 viewDir = Normalize(posV * -1.0f);
+			XMFLOAT4& output = m_shaded[pixelIdx];
+			XMFLOAT4& bloom = m_bloom[pixelIdx];
+			ForEachTileLight(tileIdx, [&](uint32_t lightIdx)
+			{
+				const Float3 col = ComputePointLight(lights[lightIdx], albedo, data.roughness, data.metalness, posV, normalDir, viewDir);
+				output = { output.x + col.x, output.y + col.y, output.z + col.z, output.w + 1.0f };
+				if (Luminance({ output.x, output.y, output.z }) > 1.0f)
+					bloom = { bloom.x + col.x, bloom.y + col.y, bloom.z + col.z, bloom.w + 1.0f };
+			});
+		}
+	}
+}
+
+uint32_t TileBasedReference::CountFalsePositives(const TileReferenceView& view, const LightInCompute* lights, uint32_t tileX, uint32_t tileY) const
+{
+	const float zNear = std::min(view.nearZ, view.farZ);
+	const float zFar = std::max(view.nearZ, view.farZ);
+	const uint32_t endX = std::min((tileX + 1) * m_tileSize, m_width);
+	const uint32_t endY = std::min((tileY + 1) * m_tileSize, m_height);
+	uint32_t falsePositives = 0;
+	ForEachTileLight(static_cast<size_t>(tileY) * m_tileCountX + tileX, [&](uint32_t lightIdx)
+	{
+		// ˥ھﵽfallOffEndʱΪ0ֻоЧزŻᱻ
+		const LightInCompute& light = lights[lightIdx];
+		const float radius2 = light.fallOffEnd * light.fallOffEnd;
+		for (uint32_t y = tileY * m_tileSize; y < endY; ++y)
+		{
+			for (uint32_t x = tileX * m_tileSize; x < endX; ++x)
+			{
+				const XMFLOAT3& posV = m_pixels[static_cast<size_t>(y) * m_width + x].viewPos;
+				if (posV.z < zNear || posV.z >= zFar)
+					continue;
+				const Float3 d = Load(light.posV) - Load(posV);
+				if (Dot(d, d) < radius2)
+					return;
+			}
+		}
+		++falsePositives;
+	});
+	return falsePositives;
+}
+
+uint32_t TileBasedReference::GetWidth() const
+{
+	return m_width;
+}
+
+uint32_t TileBasedReference::GetHeight() const
+{
+	return m_height;
+}
+
+const std::vector<uint32_t>& TileBasedReference::GetTileLightCounts() const
+{
+	return m_tileLightCounts;
+}
+
+const std::vector<XMFLOAT2>& TileBasedReference::GetTileDepthRanges() const
+{
+	return m_tileDepthRanges;
+}
+
+const std::vector<uint32_t>& TileBasedReference::GetTileLightLists() const
+{
+	return m_tileLightLists;
+}
+
+const std::vector<uint32_t>& TileBasedReference::GetTileLightBits() const
+{
+	return m_tileLightBits;
+}
+
+uint32_t TileBasedReference::GetTileLightWords() const
+{
+	return m_lightWords;
+}
+
+const std::vector<uint32_t>& TileBasedReference::GetTileDepthMasks() const
+{
+	return m_tileDepthMasks;
+}
+
+const std::vector<XMFLOAT4>& TileBasedReference::GetShadedImage() const
+{
+	return m_shaded;
+}
+
+const std::vector<XMFLOAT4>& TileBasedReference::GetBloomImage() const
+{
+	return m_bloom;
+}
+
+const TileReferenceStats& TileBasedReference::GetStats() const
+{
+	return m_stats;
+}
+
+bool TileBasedReference::SaveShadedImage(const std::filesystem::path& path) const
+{
+	if (m_shaded.empty())
+		return false;
+	return DDSFile::Save(path, DDSFormat::R32G32B32A32_FLOAT, m_width, m_height, m_shaded.data());
+}
+
+bool TileBasedReference::SaveBloomImage(const std::filesystem::path& path) const
+{
+	if (m_bloom.empty())
+		return false;
+	return DDSFile::Save(path, DDSFormat::R32G32B32A32_FLOAT, m_width, m_height, m_bloom.data());
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+#include "Light.h"
+#include "TileFrustumCache.h"
+
+namespace Renderer
+{
+enum class TileCullingMode
+{
+	MinMax,		// ֻ÷ֿȷΧԶƽ棬ԴдΪlistCapacityб
+	DepthMask	// TileBased.hlslǰ32λ޳ԴбΪλ
+};
+
+// ӦTileBased.hlslcbPassDeferõĲ֣ΪCPUδתõʽ
+struct TileReferenceView
+{
+	DirectX::XMFLOAT4X4	view;
+	DirectX::XMFLOAT4X4	proj;
+	float				nearZ;
+	float				farZ;
+};
+
+struct TileReferenceStats
+{
+	uint32_t	tileCountX{ 0 };
+	uint32_t	tileCountY{ 0 };
+	uint32_t	maxTileLights{ 0 };
+	float		averageTileLights{ 0.0f };
+	uint32_t	emptyTiles{ 0 };
+	uint32_t	overflowTiles{ 0 };		// MinMax¹ԴlistCapacityķֿ
+	uint32_t	droppedLights{ 0 };		// MinMaxзֿгlistCapacityĹԴ֮
+	uint32_t	falsePositives{ 0 };	// ͨ޳ӰֿκЧص(ֿ, Դ)
+	double		cullTime{ 0.0 };		// 롢ȹԼ޳ʱ(ms)
+	double		shadeTime{ 0.0 };		// ɫʱ(ms)
+};
+
+/*
+ * TileBased.hlslDeferں˵CPUֲD3D豸Уֿ޳ڷֿСԴԤ
+ * ɫд𲽸֣G-Buffer롢ֿȷΧԼ롢׶幹졢ԴΧɫѭ
+ * ׶ɫʹͬһTileFrustumCache
+ * MinMaxģʽΪλ֮ǰбڶԱȣGPUбδΪֻɫǰlistCapacityԴ
+ * ģʽ·ֿڵĹԴɫ
+ */
+class TileBasedReference
+{
+public:
+	static constexpr uint32_t	defaultTileSize = TILE_GROUP_DIM;
+	static constexpr uint32_t	defaultListCapacity = 256;		// Ϊλ֮ǰtileLightList
+
+	explicit TileBasedReference(uint32_t tileSize = defaultTileSize, uint32_t listCapacity = defaultListCapacity);
+	TileBasedReference(const TileBasedReference&) = delete;
+	TileBasedReference& operator=(const TileBasedReference&) = delete;
+	TileBasedReference(TileBasedReference&&) = default;
+	TileBasedReference& operator=(TileBasedReference&&) = default;
+	~TileBasedReference() = default;
+
+	/*
+	 * ȡȡG-Buffer(DDS)ʡNDCȡ(ӳ䷨, ֲڶ, )
+	 * ֧R10G10B10A2_UNORMR32_FLOATR16G16B16A16_SNORM/FLOATR32G32B32A32_FLOATR8G8B8A8_UNORM
+	 */
+	bool LoadGBuffer(const std::filesystem::path& albedo, const std::filesystem::path& depth, const std::filesystem::path& mixed);
+	// ȡͼƬΪfloat4ʽLoadGBufferͬ
+	static bool ReadImage(const std::filesystem::path& path, uint32_t& width, uint32_t& height, std::vector<DirectX::XMFLOAT4>& pixels);
+	// ֱʹѾG-BufferͼΪwidth * heightfloat4
+	void SetGBuffer(uint32_t width, uint32_t height, std::vector<DirectX::XMFLOAT4> albedo, std::vector<DirectX::XMFLOAT4> depth, std::vector<DirectX::XMFLOAT4> mixed);
+	void SetCullingMode(TileCullingMode mode);
+	// visualizeLightCountӦcbDebugеg_visualizeLightCount
+	void Run(const TileReferenceView& view, const LightInCompute* lights, uint32_t count, bool visualizeLightCount = false);
+
+	uint32_t GetWidth() const;
+	uint32_t GetHeight() const;
+	// ÿֿͨԵĹԴlistCapacityĲ
+	const std::vector<uint32_t>& GetTileLightCounts() const;
+	// ÿֿԼõ(tileMinZ, tileMaxZ)
+	const std::vector<DirectX::XMFLOAT2>& GetTileDepthRanges() const;
+	// MinMax·ֿĹԴбÿֿռlistCapacityԪأЧΪmin(count, listCapacity)
+	const std::vector<uint32_t>& GetTileLightLists() const;
+	// DepthMask·ֿĹԴλÿֿռGetTileLightWords()UINT
+	const std::vector<uint32_t>& GetTileLightBits() const;
+	uint32_t GetTileLightWords() const;
+	const std::vector<uint32_t>& GetTileDepthMasks() const;
+	const std::vector<DirectX::XMFLOAT4>& GetShadedImage() const;
+	const std::vector<DirectX::XMFLOAT4>& GetBloomImage() const;
+	const TileReferenceStats& GetStats() const;
+	bool SaveShadedImage(const std::filesystem::path& path) const;
+	bool SaveBloomImage(const std::filesystem::path& path) const;
+private:
+	struct PixelData
+	{
+		DirectX::XMFLOAT3	albedo;
+		DirectX::XMFLOAT3	normalDir;
+		float				roughness;
+		float				metalness;
+		DirectX::XMFLOAT3	viewPos;
+	};
+	// ӦDecodeGBufferԳĻְclamp
+	PixelData Decode(const TileReferenceView& view, uint32_t x, uint32_t y) const;
+	void CullTile(const TileReferenceView& view, const LightInCompute* lights, uint32_t count, uint32_t tileX, uint32_t tileY);
+	void ShadeTile(const LightInCompute* lights, bool visualizeLightCount, uint32_t tileX, uint32_t tileY);
+	// ɫ˳ֿҪɫĹԴ
+	template <typename Func>
+	void ForEachTileLight(size_t tileIdx, Func&& func) const;
+	uint32_t CountFalsePositives(const TileReferenceView& view, const LightInCompute* lights, uint32_t tileX, uint32_t tileY) const;
+private:
+	uint32_t							m_tileSize;
+	uint32_t							m_listCapacity;
+	TileCullingMode						m_mode{ TileCullingMode::DepthMask };
+	uint32_t							m_width{ 0 };
+	uint32_t							m_height{ 0 };
+	uint32_t							m_tileCountX{ 0 };
+	uint32_t							m_tileCountY{ 0 };
+	TileFrustumCache					m_frustumCache;
+	float								m_frustumProjX{ 0.0f };
+	float								m_frustumProjY{ 0.0f };
+	std::vector<DirectX::XMFLOAT4>		m_albedo;
+	std::vector<DirectX::XMFLOAT4>		m_depth;
+	std::vector<DirectX::XMFLOAT4>		m_mixed;
+
+	std::vector<PixelData>				m_pixels;
+	std::vector<uint32_t>				m_tileLightCounts;
+	std::vector<uint32_t>				m_tileLightLists;
+	uint32_t							m_lightWords{ 0 };
+	std::vector<uint32_t>				m_tileLightBits;
+	std::vector<uint32_t>				m_tileDepthMasks;
+	std::vector<DirectX::XMFLOAT2>		m_tileDepthRanges;
+	std::vector<DirectX::XMFLOAT4>		m_shaded;
+	std::vector<DirectX::XMFLOAT4>		m_bloom;
+	TileReferenceStats					m_stats;
+};
+}
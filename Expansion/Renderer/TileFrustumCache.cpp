@@ -0,0 +1,171 @@
+#include "TileFrustumCache.h"
+#include <algorithm>
+
+using namespace Renderer;
+using namespace DirectX;
+
+TileFrustumCache::TileFrustumCache(uint32_t tileSize) : m_tileSize(std::max(tileSize, 1u))
+{
+}
+
+bool TileFrustumCache::Update(uint64_t projVersion, float projX, float projY, uint32_t width, uint32_t height)
+{
+	if (projVersion == m_projVersion && width == m_width && height == m_height)
+		return false;
+	m_projVersion = projVersion;
+	Build(width, height, projX, projY);
+	return true;
+}
+
+/*
+Pperspective = Ppersp->ortho*Portho
+Ppersp->ortho = 				Portho =
+  {n,  0, 	0, 		0,				   {1 / (rn*tan(fov/2)), 0, 						0, 				0,
+	0, n, 	0, 		0,				   	0,                   1 / (n * tan(fov / 2)), 	0, 				0,
+	0, 0, n + f, 	1,				   	0, 					 0,							1 / (f - n), 	0,
+ 	0, 0, 	-fn, 	0}				   	0, 				     0,							-nf / (f - n),  1 }
+
+׶ͶӰԱƵΪ
+Ppersp = {Swidth * m00, 	0, 				0, 	 0,
+			0,			 	Sheight * m11,	0, 	 0,
+			Tx,				Ty,				m22, 1,
+			0,				0,				m32, 0}
+*/
+void TileFrustumCache::Build(uint32_t width, uint32_t height, float projX, float projY)
+{
+	m_width = width;
+	m_height = height;
+	m_tileCountX = (width + m_tileSize - 1) / m_tileSize;
+	m_tileCountY = (height + m_tileSize - 1) / m_tileSize;
+	// 뵽4ıSIMDÿδ4()
+	m_columnPlanes.resize(static_cast<size_t>((m_tileCountX + 3) & ~3U) * 2);
+	m_rowPlanes.resize(static_cast<size_t>((m_tileCountY + 3) & ~3U) * 2);
+	m_planes.resize(static_cast<size_t>(m_tileCountX) * m_tileCountY * planesPerTile);
+
+	// ɫһ£scale = texSize / tileSizeoffset = scale - 1 - 2 * groupID
+	const float scaleX = static_cast<float>(width) / static_cast<float>(m_tileSize);
+	const float scaleY = static_cast<float>(height) / static_cast<float>(m_tileSize);
+	const XMVECTOR one = XMVectorReplicate(1.0f);
+	const XMVECTOR zero = XMVectorZero();
+	const XMVECTOR laneOffset = XMVectorSet(0.0f, 2.0f, 4.0f, 6.0f);
+
+	// col3 -+ col0 = (-+scale.x * m00, 0, 1 -+ offset.x, 0)
+	{
+		const float a = scaleX * projX;
+		const XMVECTOR a2 = XMVectorReplicate(a * a);
+		const XMVECTOR aV = XMVectorReplicate(a);
+		for (uint32_t tileX = 0; tileX < m_tileCountX; tileX += 4)
+		{
+			const XMVECTOR offset = XMVectorSubtract(XMVectorReplicate(scaleX - 1.0f - 2.0f * static_cast<float>(tileX)), laneOffset);
+			const XMVECTOR rightZ = XMVectorSubtract(one, offset);
+			const XMVECTOR leftZ = XMVectorAdd(one, offset);
+			const XMVECTOR rightInv = XMVectorReciprocal(XMVectorSqrt(XMVectorMultiplyAdd(rightZ, rightZ, a2)));
+			const XMVECTOR leftInv = XMVectorReciprocal(XMVectorSqrt(XMVectorMultiplyAdd(leftZ, leftZ, a2)));
+			// 4ֿSoAתΪ(x, 0, z, 0)
+			const XMVECTOR rightX = XMVectorNegate(XMVectorMultiply(aV, rightInv));
+			const XMVECTOR rightN = XMVectorMultiply(rightZ, rightInv);
+			const XMVECTOR leftX = XMVectorMultiply(aV, leftInv);
+			const XMVECTOR leftN = XMVectorMultiply(leftZ, leftInv);
+			XMFLOAT4* dst = &m_columnPlanes[static_cast<size_t>(tileX) * 2];
+			XMVECTOR lo = XMVectorMergeXY(rightX, zero);
+			XMVECTOR hi = XMVectorMergeXY(rightN, zero);
+			const XMVECTOR right0 = XMVectorPermute<0, 1, 4, 5>(lo, hi);
+			const XMVECTOR right1 = XMVectorPermute<2, 3, 6, 7>(lo, hi);
+			lo = XMVectorMergeZW(rightX, zero);
+			hi = XMVectorMergeZW(rightN, zero);
+			const XMVECTOR right2 = XMVectorPermute<0, 1, 4, 5>(lo, hi);
+			const XMVECTOR right3 = XMVectorPermute<2, 3, 6, 7>(lo, hi);
+			lo = XMVectorMergeXY(leftX, zero);
+			hi = XMVectorMergeXY(leftN, zero);
+			const XMVECTOR left0 = XMVectorPermute<0, 1, 4, 5>(lo, hi);
+			const XMVECTOR left1 = XMVectorPermute<2, 3, 6, 7>(lo, hi);
+			lo = XMVectorMergeZW(leftX, zero);
+			hi = XMVectorMergeZW(leftN, zero);
+			const XMVECTOR left2 = XMVectorPermute<0, 1, 4, 5>(lo, hi);
+			const XMVECTOR left3 = XMVectorPermute<2, 3, 6, 7>(lo, hi);
+			XMStoreFloat4(dst + 0, right0);
+			XMStoreFloat4(dst + 1, left0);
+			XMStoreFloat4(dst + 2, right1);
+			XMStoreFloat4(dst + 3, left1);
+			XMStoreFloat4(dst + 4, right2);
+			XMStoreFloat4(dst + 5, left2);
+			XMStoreFloat4(dst + 6, right3);
+			XMStoreFloat4(dst + 7, left3);
+		}
+	}
+
+	// col3 -+ col1 = (0, -+scale.y * m11, 1 +- offset.y, 0)
+	{
+		const float c = scaleY * projY;
+		const XMVECTOR c2 = XMVectorReplicate(c * c);
+		const XMVECTOR cV = XMVectorReplicate(c);
+		for (uint32_t tileY = 0; tileY < m_tileCountY; tileY += 4)
+		{
+			const XMVECTOR offset = XMVectorSubtract(XMVectorReplicate(scaleY - 1.0f - 2.0f * static_cast<float>(tileY)), laneOffset);
+			const XMVECTOR topZ = XMVectorAdd(one, offset);
+			const XMVECTOR bottomZ = XMVectorSubtract(one, offset);
+			const XMVECTOR topInv = XMVectorReciprocal(XMVectorSqrt(XMVectorMultiplyAdd(topZ, topZ, c2)));
+			const XMVECTOR bottomInv = XMVectorReciprocal(XMVectorSqrt(XMVectorMultiplyAdd(bottomZ, bottomZ, c2)));
+			// 4ֿSoAתΪ(0, y, z, 0)
+			const XMVECTOR topY = XMVectorNegate(XMVectorMultiply(cV, topInv));
+			const XMVECTOR topN = XMVectorMultiply(topZ, topInv);
+			const XMVECTOR bottomY = XMVectorMultiply(cV, bottomInv);
+			const XMVECTOR bottomN = XMVectorMultiply(bottomZ, bottomInv);
+			XMFLOAT4* dst = &m_rowPlanes[static_cast<size_t>(tileY) * 2];
+			XMVECTOR lo = XMVectorMergeXY(zero, topY);
+			XMVECTOR hi = XMVectorMergeXY(topN, zero);
+			const XMVECTOR top0 = XMVectorPermute<0, 1, 4, 5>(lo, hi);
+			const XMVECTOR top1 = XMVectorPermute<2, 3, 6, 7>(lo, hi);
+			lo = XMVectorMergeZW(zero, topY);
+			hi = XMVectorMergeZW(topN, zero);
+			const XMVECTOR top2 = XMVectorPermute<0, 1, 4, 5>(lo, hi);
+			const XMVECTOR top3 = XMVectorPermute<2, 3, 6, 7>(lo, hi);
+			lo = XMVectorMergeXY(zero, bottomY);
+			hi = XMVectorMergeXY(bottomN, zero);
+			const XMVECTOR bottom0 = XMVectorPermute<0, 1, 4, 5>(lo, hi);
+			const XMVECTOR bottom1 = XMVectorPermute<2, 3, 6, 7>(lo, hi);
+			lo = XMVectorMergeZW(zero, bottomY);
+			hi = XMVectorMergeZW(bottomN, zero);
+			const XMVECTOR bottom2 = XMVectorPermute<0, 1, 4, 5>(lo, hi);
+			const XMVECTOR bottom3 = XMVectorPermute<2, 3, 6, 7>(lo, hi);
+			XMStoreFloat4(dst + 0, top0);
+			XMStoreFloat4(dst + 1, bottom0);
+			XMStoreFloat4(dst + 2, top1);
+			XMStoreFloat4(dst + 3, bottom1);
+			XMStoreFloat4(dst + 4, top2);
+			XMStoreFloat4(dst + 5, bottom2);
+			XMStoreFloat4(dst + 6, top3);
+			XMStoreFloat4(dst + 7, bottom3);
+		}
+	}
+
+	// չΪֿ(, , , )ɫֻ谴ֿȡ4ƽ
+	XMFLOAT4* dst = m_planes.data();
+	for (uint32_t tileY = 0; tileY < m_tileCountY; ++tileY)
+	{
+		const XMVECTOR top = XMLoadFloat4(&m_rowPlanes[static_cast<size_t>(tileY) * 2]);
+		const XMVECTOR bottom = XMLoadFloat4(&m_rowPlanes[static_cast<size_t>(tileY) * 2 + 1]);
+		for (uint32_t tileX = 0; tileX < m_tileCountX; ++tileX)
+		{
+			XMStoreFloat4(dst++, XMLoadFloat4(&m_columnPlanes[static_cast<size_t>(tileX) * 2]));
+			XMStoreFloat4(dst++, XMLoadFloat4(&m_columnPlanes[static_cast<size_t>(tileX) * 2 + 1]));
+			XMStoreFloat4(dst++, top);
+			XMStoreFloat4(dst++, bottom);
+		}
+	}
+}
+
+const std::vector<XMFLOAT4>& TileFrustumCache::GetPlanes() const
+{
+	return m_planes;
+}
+
+uint32_t TileFrustumCache::GetTileCountX() const
+{
+	return m_tileCountX;
+}
+
+uint32_t TileFrustumCache::GetTileCountY() const
+{
+	return m_tileCountY;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include "ShaderConfig.h"
+
+namespace Renderer
+{
+/*
+ * TileBased.hlslֿ׶CPU
+ * ֻȡڷֱͶӰm00m11ÿֿ鰴(, , , )4۲ռƽ棬߳ڣ˳Gribb/Hartmannȡ˳һ
+ * ֻͶӰ汾ֱʱ仯ʱؽԶƽֿȷΧɫй
+ */
+class TileFrustumCache
+{
+public:
+	static constexpr uint32_t	defaultTileSize = TILE_GROUP_DIM;
+	static constexpr uint32_t	planesPerTile = 4;
+
+	explicit TileFrustumCache(uint32_t tileSize = defaultTileSize);
+	TileFrustumCache(const TileFrustumCache&) = delete;
+	TileFrustumCache& operator=(const TileFrustumCache&) = delete;
+	TileFrustumCache(TileFrustumCache&&) = default;
+	TileFrustumCache& operator=(TileFrustumCache&&) = default;
+	~TileFrustumCache() = default;
+
+	// ͶӰ汾(Camera::GetProjectionVersion)ֱʱ仯ʱؽǷؽprojXprojYͬBuild
+	bool Update(uint64_t projVersion, float projX, float projY, uint32_t width, uint32_t height);
+	// SIMDһμ4()ֿƽ棬projXprojYΪͶӰm00m11
+	void Build(uint32_t width, uint32_t height, float projX, float projY);
+
+	const std::vector<DirectX::XMFLOAT4>& GetPlanes() const;
+	uint32_t GetTileCountX() const;
+	uint32_t GetTileCountY() const;
+private:
+	uint32_t						m_tileSize;
+	uint32_t						m_width{ 0 };
+	uint32_t						m_height{ 0 };
+	uint32_t						m_tileCountX{ 0 };
+	uint32_t						m_tileCountY{ 0 };
+	uint64_t						m_projVersion{ ~0ULL };
+	// ƽֻȡڷֿУƽֻȡڷֿ
+	std::vector<DirectX::XMFLOAT4>	m_columnPlanes;
+	std::vector<DirectX::XMFLOAT4>	m_rowPlanes;
+	std::vector<DirectX::XMFLOAT4>	m_planes;
+};
+}
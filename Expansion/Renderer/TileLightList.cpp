@@ -0,0 +1,102 @@
+#include "TileLightList.h"
+#include <algorithm>
+#include <cassert>
+
+using namespace Renderer;
+using namespace DirectX;
+
+TileLightList::TileLightList(uint32_t tileSize) : m_tileSize(std::max(tileSize, 1u))
+{
+}
+
+void TileLightList::ReduceDepthRanges(uint32_t width, uint32_t height, const float* opaqueViewZ, const float* transparentViewZ, float nearZ, float farZ)
+{
+	m_tileCountX = (width + m_tileSize - 1) / m_tileSize;
+	m_tileCountY = (height + m_tileSize - 1) / m_tileSize;
+	m_tileDepthRanges.assign(static_cast<size_t>(m_tileCountX) * m_tileCountY, { emptyTileZ, 0.0f });
+	const float zNear = std::min(nearZ, farZ);
+	const float zFar = std::max(nearZ, farZ);
+	// Ļ̶߳ȡclampıԵأıԼֻĻڵ
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			const size_t pixelIdx = static_cast<size_t>(y) * width + x;
+			XMFLOAT2& range = m_tileDepthRanges[static_cast<size_t>(y / m_tileSize) * m_tileCountX + x / m_tileSize];
+			const float opaqueZ = opaqueViewZ[pixelIdx];
+			range.y = std::max(range.y, (opaqueZ >= zNear && opaqueZ < zFar) ? opaqueZ : zFar);
+			const float transparentZ = transparentViewZ[pixelIdx];
+			if (transparentZ >= zNear && transparentZ < zFar)
+				range.x = std::min(range.x, transparentZ);
+		}
+	}
+}
+
+void TileLightList::Build(const std::vector<XMFLOAT4>& planes, const LightInCompute* lights, uint32_t count)
+{
+	const size_t tileCount = m_tileDepthRanges.size();
+	assert(planes.size() == tileCount * TileFrustumCache::planesPerTile);
+	m_lightWords = (count + 31) >> 5;
+	m_tileLightBits.assign(tileCount * m_lightWords, 0);
+	for (size_t tileIdx = 0; tileIdx < tileCount; ++tileIdx)
+	{
+		const XMFLOAT2& range = m_tileDepthRanges[tileIdx];
+		if (range.x > range.y)
+			continue;
+		const XMFLOAT4* sidePlanes = &planes[tileIdx * TileFrustumCache::planesPerTile];
+		const XMFLOAT4 tilePlanes[6] = {
+			sidePlanes[0], sidePlanes[1], sidePlanes[2], sidePlanes[3],
+			{ 0.0f, 0.0f, 1.0f, -range.x },
+			{ 0.0f, 0.0f, -1.0f, range.y } };
+		uint32_t* bits = &m_tileLightBits[tileIdx * m_lightWords];
+		for (uint32_t idx = 0; idx < count; ++idx)
+		{
+			const LightInCompute& light = lights[idx];
+			bool inFrustum = true;
+			for (const XMFLOAT4& plane : tilePlanes)
+			{
+				const float dist = plane.x * light.posV.x + plane.y * light.posV.y + plane.z * light.posV.z + plane.w;
+				inFrustum = inFrustum && (dist >= -light.fallOffEnd);
+			}
+			if (inFrustum)
+				bits[idx >> 5] |= 1u << (idx & 31);
+		}
+	}
+}
+
+uint32_t TileLightList::GetTileCountX() const
+{
+	return m_tileCountX;
+}
+
+uint32_t TileLightList::GetTileCountY() const
+{
+	return m_tileCountY;
+}
+
+uint32_t TileLightList::GetLightWords() const
+{
+	return m_lightWords;
+}
+
+const std::vector<XMFLOAT2>& TileLightList::GetTileDepthRanges() const
+{
+	return m_tileDepthRanges;
+}
+
+const std::vector<uint32_t>& TileLightList::GetTileLightBits() const
+{
+	return m_tileLightBits;
+}
+
+uint32_t TileLightList::GetTileLightCount(uint32_t tileX, uint32_t tileY) const
+{
+	const uint32_t* bits = &m_tileLightBits[(static_cast<size_t>(tileY) * m_tileCountX + tileX) * m_lightWords];
+	uint32_t count = 0;
+	for (uint32_t word = 0; word < m_lightWords; ++word)
+	{
+		for (uint32_t value = bits[word]; value != 0; value &= value - 1)
+			++count;
+	}
+	return count;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cfloat>
+#include <vector>
+#include "Light.h"
+#include "TileFrustumCache.h"
+
+namespace Renderer
+{
+/*
+ * TileBased.hlslCullLightsں˵CPU汾D3D豸ForwardPlusķֿԴбΪ׼
+ * ֿȷΧȡ͸ȵ͸Զȣ͸ڲ͸֮ǰԶ͸ԶĲֻᱻȲ޳
+ * ԴбΪλÿֿռGetLightWords()UINTɫдԴһ
+ */
+class TileLightList
+{
+public:
+	static constexpr uint32_t	defaultTileSize = TILE_GROUP_DIM;
+	// ɫû͸صķֿ鱣ָóֵ
+	static constexpr float		emptyTileZ = FLT_MAX;
+
+	explicit TileLightList(uint32_t tileSize = defaultTileSize);
+	TileLightList(const TileLightList&) = delete;
+	TileLightList& operator=(const TileLightList&) = delete;
+	TileLightList(TileLightList&&) = default;
+	TileLightList& operator=(TileLightList&&) = default;
+	~TileLightList() = default;
+
+	/*
+	 * opaqueViewZtransparentViewZΪwidth * height۲ռȣ[near, far)ڵΪЧ
+	 * ЧĲ͸(պ)Զƽ洦Ч͸زԼ
+	 */
+	void ReduceDepthRanges(uint32_t width, uint32_t height, const float* opaqueViewZ, const float* transparentViewZ, float nearZ, float farZ);
+	// planesΪͬһֱTileFrustumCacheĲ棬ÿֿռ(count + 31) / 32uintCullLightsдԴĲһ
+	void Build(const std::vector<DirectX::XMFLOAT4>& planes, const LightInCompute* lights, uint32_t count);
+
+	uint32_t GetTileCountX() const;
+	uint32_t GetTileCountY() const;
+	uint32_t GetLightWords() const;
+	// ÿֿ(tileMinZ, tileMaxZ)û͸صķֿtileMinZΪemptyTileZtileMinZ > tileMaxZķֿ͸ȫڵбΪ
+	const std::vector<DirectX::XMFLOAT2>& GetTileDepthRanges() const;
+	const std::vector<uint32_t>& GetTileLightBits() const;
+	uint32_t GetTileLightCount(uint32_t tileX, uint32_t tileY) const;
+private:
+	uint32_t						m_tileSize;
+	uint32_t						m_tileCountX{ 0 };
+	uint32_t						m_tileCountY{ 0 };
+	uint32_t						m_lightWords{ 0 };
+	std::vector<DirectX::XMFLOAT2>	m_tileDepthRanges;
+	std::vector<uint32_t>			m_tileLightBits;
+};
+}
@@ -0,0 +1,35 @@
+#include "TransparentSort.h"
+#include <algorithm>
+#include <numeric>
+
+using namespace Renderer;
+using namespace DirectX;
+
+const std::vector<uint32_t>& TransparentSort::Sort(const XMFLOAT3* centers, uint32_t count, FXMMATRIX view)
+{
+	m_viewDepths.resize(count);
+	// Լ¹۲ռz = dot(p, ) + m32
+	const XMMATRIX viewT = XMMatrixTranspose(view);
+	const XMVECTOR depthRow = viewT.r[2];
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		m_viewDepths[i] = XMVectorGetX(XMVector3Dot(XMLoadFloat3(&centers[i]), depthRow)) + XMVectorGetW(depthRow);
+	}
+	m_order.resize(count);
+	std::iota(m_order.begin(), m_order.end(), 0u);
+	std::stable_sort(m_order.begin(), m_order.end(), [this](uint32_t lhs, uint32_t rhs)
+	{
+		return m_viewDepths[lhs] > m_viewDepths[rhs];
+	});
+	return m_order;
+}
+
+const std::vector<uint32_t>& TransparentSort::GetOrder() const
+{
+	return m_order;
+}
+
+const std::vector<float>& TransparentSort::GetViewDepths() const
+{
+	return m_viewDepths;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+namespace Renderer
+{
+/*
+ * ͸ԶĻ˳ֻ۲󣬲D3D豸
+ * Թ۲ռΪͬ屣˳ֹʱÿ֡˳ȶ˸
+ */
+class TransparentSort
+{
+public:
+	TransparentSort() = default;
+	TransparentSort(const TransparentSort&) = delete;
+	TransparentSort& operator=(const TransparentSort&) = delete;
+	TransparentSort(TransparentSort&&) = default;
+	TransparentSort& operator=(TransparentSort&&) = default;
+	~TransparentSort() = default;
+
+	// centersΪcountռģԶ
+	const std::vector<uint32_t>& Sort(const DirectX::XMFLOAT3* centers, uint32_t count, DirectX::FXMMATRIX view);
+	const std::vector<uint32_t>& GetOrder() const;
+	// һSortÿĹ۲ռȣ˳
+	const std::vector<float>& GetViewDepths() const;
+private:
+	std::vector<float>		m_viewDepths;
+	std::vector<uint32_t>	m_order;
+};
+}
@@ -2,6 +2,7 @@
 
 #include <DirectXCollision.h>
 #include "MathHelper.hpp"
+#include "BVH.h"
 
 namespace Models
 {
@@ -13,6 +14,8 @@ private:
 public:
 	inline static AABB sceneBox{};
 	inline static Sphere sceneBound{};
+	// ͸ȾΧйɵBVHͼԪ벻͸Ⱦе˳һ
+	inline static BVH sceneBVH{};
 };
 }
 
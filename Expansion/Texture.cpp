@@ -1,29 +1,77 @@
 #include "Texture.h"
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include "DDSFile.h"
 #include <D3DUtil.hpp>
-#include <Inc/DDSTextureLoader.h>
 #include <Inc/ResourceUploadBatch.h>
 
 const std::wstring TexturePath = L"Resources/Textures/";
 
-textureData::textureData(std::string_view _name, std::wstring _fileName)
-: name(_name), fileName(std::move(_fileName))
+namespace
 {
-	
+// ÿζӦһResourceUploadBatchͨEndصfutureѯ
+class D3D12TextureUploader final : public ITextureUploader<DDSPayload>
+{
+public:
+	D3D12TextureUploader(ID3D12Device* device, ID3D12CommandQueue* cmdQueue)
+	: m_device(device), m_commandQueue(cmdQueue)
+	{
+	}
+
+	void Upload(DDSPayload& payload) override
+	{
+		if (!m_batch)
+		{
+			m_batch.emplace(m_device);
+			m_batch->Begin();
+		}
+		m_batch->Upload(payload.resource.Get(), 0, payload.subresources.data(), static_cast<UINT>(payload.subresources.size()));
+		m_batch->Transition(payload.resource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		// ѿϴѣԴָӳļ֮ᱻͷ
+		payload.subresources.clear();
+	}
+
+	uint64_t Submit() override
+	{
+		const uint64_t batch = m_nextBatch++;
+		m_finished.emplace(batch, m_batch->End(m_commandQueue));
+		m_batch.reset();
+		return batch;
+	}
+
+	bool IsComplete(uint64_t batch) override
+	{
+		const auto it = m_finished.find(batch);
+		if (it == m_finished.end())
+			return true;
+		if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return false;
+		m_finished.erase(it);
+		return true;
+	}
+private:
+	ID3D12Device*									m_device;
+	ID3D12CommandQueue*								m_commandQueue;
+	std::optional<DirectX::ResourceUploadBatch>		m_batch;
+	std::unordered_map<uint64_t, std::future<void>>	m_finished;
+	uint64_t										m_nextBatch{ 0 };
+};
 }
 
-Texture::Texture(std::string_view _name, std::wstring _fileName, ID3D12Device* device, ID3D12CommandQueue* queue)
-	: m_tex(std::make_unique<textureData>(_name, _fileName))
+textureData::textureData(std::string_view _name, std::wstring _fileName)
+: name(_name), fileName(std::move(_fileName))
 {
-	CreateDDSTexture(device, queue);
+	
 }
 
-void Texture::CreateDDSTexture(ID3D12Device* currDevice, ID3D12CommandQueue* cmdQueue)
+Texture::Texture(std::string_view _name, std::wstring _fileName, UINT srvIndex, bool isCubeMap)
+	: m_tex(std::make_unique<textureData>(_name, std::move(_fileName)))
 {
-	DirectX::ResourceUploadBatch upload(currDevice);
-	upload.Begin();
-	ThrowIfFailed(DirectX::CreateDDSTextureFromFile(currDevice, upload, m_tex->fileName.c_str(), m_tex->Resource.ReleaseAndGetAddressOf(), false, 0UI64, nullptr, &m_tex->isCubeMap));
-	const auto uploadFinished = upload.End(cmdQueue);
-	uploadFinished.wait();
+	m_tex->registerIndex = srvIndex;
+	m_tex->srvIndex = srvIndex;
+	m_tex->isCubeMap = isCubeMap;
 }
 
 void TextureMgr::Init(ID3D12Device* currDevice, ID3D12CommandQueue* cmdQueue)
@@ -31,48 +79,170 @@ void TextureMgr::Init(ID3D12Device* currDevice, ID3D12CommandQueue* cmdQueue)
 	m_device = currDevice;
 	m_commandQueue = cmdQueue;
 	m_srvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	// D3D12豸̵߳ģԴDDS߳ɣԴʼ״̬ΪCOPY_DEST
+	m_uploader = std::make_unique<D3D12TextureUploader>(currDevice, cmdQueue);
+	m_loader = std::make_unique<TextureUploadTracker<DDSPayload>>([device = currDevice](const MappedFile& file, DDSPayload& payload)
+	{
+		DDSFile dds;
+		if (!dds.Parse(file.GetData(), file.GetSize(), payload.maxMips))
+			return false;
+		const auto& info = dds.GetInfo();
+		const auto texDesc = CD3DX12_RESOURCE_DESC::Tex2D(static_cast<DXGI_FORMAT>(info.format), info.width, info.height,
+			static_cast<UINT16>(info.arraySize), static_cast<UINT16>(info.mipCount));
+		const CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
+		if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &texDesc, D3D12_RESOURCE_STATE_COPY_DEST,
+			nullptr, IID_PPV_ARGS(payload.resource.ReleaseAndGetAddressOf()))))
+			return false;
+		// Դֱָӳļ⿽
+		const auto& subresources = dds.GetSubresources();
+		payload.subresources.resize(subresources.size());
+		for (size_t i = 0; i < subresources.size(); ++i)
+		{
+			payload.subresources[i].pData = subresources[i].data;
+			payload.subresources[i].RowPitch = static_cast<LONG_PTR>(subresources[i].rowPitch);
+			payload.subresources[i].SlicePitch = static_cast<LONG_PTR>(subresources[i].slicePitch);
+		}
+		payload.isCubeMap = info.isCubeMap;
+		payload.isPreview = info.skippedMips > 0;
+		return true;
+	});
 }
 
-UINT TextureMgr::InsertDDSTexture(std::string_view name, const std::wstring& fileName)
+void TextureMgr::SetPreviewMips(UINT previewMips)
+{
+	m_previewMips = previewMips;
+}
+
+UINT TextureMgr::InsertDDSTexture(std::string_view name, const std::wstring& fileName, bool isCubeMap)
 {
 	HashID id = StringToID(name);
 	if (m_textureID.count(id))
 	{
 		return m_textureID[id];
 	}
-	m_textures.emplace_back(std::make_unique<Texture>(name, fileName, m_device.Get(), m_commandQueue.Get()));
+	m_textures.emplace_back(std::make_unique<Texture>(name, fileName, numDescriptor, isCubeMap));
+	DDSPayload request;
+	request.maxMips = m_previewMips;
+	// m_texturesе±һ
+	m_loader->Request(fileName, std::move(request));
 	m_textureID[id] = numDescriptor++;
 	return m_textureID[id];
 }
 
+bool TextureMgr::Pump()
+{
+	return m_loader->Pump(*m_uploader) && m_srvHeap != nullptr;
+}
+
+void TextureMgr::ApplySwaps(UINT64 completedFence, UINT64 lastFence)
+{
+	if (!m_srvHeap)
+		return;
+	// GPUѾõ
+	m_retiredSlots.erase(std::remove_if(m_retiredSlots.begin(), m_retiredSlots.end(), [&](const RetiredSlot& retired)
+	{
+		if (retired.fence > completedFence)
+			return false;
+		m_freeSlots.push_back(retired.slot);
+		return true;
+	}), m_retiredSlots.end());
+
+	auto readyTextures = m_loader->TakeReady(m_freeSlots.size());
+	for (auto& ready : readyTextures)
+	{
+		auto& tex = *m_textures[ready.idx]->m_tex;
+		// ֮֡֡ͨµֻlastFence֮ǰύ֡
+		m_retiredSlots.push_back({ tex.srvIndex, lastFence, std::move(tex.Resource) });
+		tex.srvIndex = m_freeSlots.back();
+		m_freeSlots.pop_back();
+		m_srvSlots[tex.registerIndex] = tex.srvIndex;
+		SetResource(tex, ready);
+		CreateSRV(tex);
+	}
+	if (!readyTextures.empty())
+	{
+		++m_swapGeneration;
+	}
+}
+
+UINT TextureMgr::GetSRVIndex(UINT registerIndex) const
+{
+	return registerIndex < m_srvSlots.size() ? m_srvSlots[registerIndex] : registerIndex;
+}
+
+UINT TextureMgr::GetSwapGeneration() const
+{
+	return m_swapGeneration;
+}
+
+void TextureMgr::WaitForTexture(std::string_view name)
+{
+	const auto it = std::find_if(m_textures.begin(), m_textures.end(), [name](const std::unique_ptr<Texture>& tex)
+	{
+		return tex->m_tex->name == name;
+	});
+	if (it == m_textures.end())
+		return;
+	m_loader->WaitFor(static_cast<UINT>(it - m_textures.begin()), *m_uploader);
+}
+
 void TextureMgr::GenerateSRVHeap()
 {
+	// ÿԤһ滻滻պ֮滻ʹ
+	const UINT spareCount = static_cast<UINT>(m_textures.size());
 	D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc{};
-	srvHeapDesc.NumDescriptors = numDescriptor;
+	srvHeapDesc.NumDescriptors = numDescriptor + spareCount;
 	srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
 	srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
 	ThrowIfFailed(m_device->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&m_srvHeap)));
-	CD3DX12_CPU_DESCRIPTOR_HANDLE srvHandler(m_srvHeap->GetCPUDescriptorHandleForHeapStart());
+	m_srvSlots.resize(numDescriptor);
+	for (UINT i = 0; i < numDescriptor; ++i)
+	{
+		m_srvSlots[i] = i;
+	}
+	m_freeSlots.clear();
+	for (UINT i = 0; i < spareCount; ++i)
+	{
+		m_freeSlots.push_back(numDescriptor + spareCount - 1 - i);
+	}
+	m_retiredSlots.clear();
+	// δдռλֱд룬ٴ滻
+	for (auto& ready : m_loader->TakeReady(m_textures.size()))
+	{
+		SetResource(*m_textures[ready.idx]->m_tex, ready);
+	}
+	for (const auto& tex : m_textures)
+	{
+		CreateSRV(*tex->m_tex);
+	}
+}
+
+void TextureMgr::CreateSRV(const textureData& tex) const
+{
+	CD3DX12_CPU_DESCRIPTOR_HANDLE srvHandler(m_srvHeap->GetCPUDescriptorHandleForHeapStart(), tex.srvIndex, m_srvDescriptorSize);
 	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
 	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-
-	for (size_t i = 0; i < m_textures.size(); ++i)
-	{
-		const auto& tex = m_textures[i];
-		srvDesc.Format = tex->m_tex->Resource->GetDesc().Format;
-		if (tex->m_tex->isCubeMap) {
-			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
-			srvDesc.TextureCube.MostDetailedMip = 0;
-			srvDesc.TextureCube.MipLevels = tex->m_tex->Resource->GetDesc().MipLevels;
-			srvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
-		} else {
-			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-			srvDesc.Texture2D.MipLevels = tex->m_tex->Resource->GetDesc().MipLevels;
-			srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
-		}
-		m_device->CreateShaderResourceView(tex->m_tex->Resource.Get(), &srvDesc, srvHandler);
-		srvHandler.Offset(1, m_srvDescriptorSize);
+	const bool ready = tex.Resource != nullptr;
+	// ռλԴɫΪ0
+	srvDesc.Format = ready ? tex.Resource->GetDesc().Format : DXGI_FORMAT_R8G8B8A8_UNORM;
+	const UINT mipLevels = ready ? tex.Resource->GetDesc().MipLevels : 1;
+	if (tex.isCubeMap) {
+		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+		srvDesc.TextureCube.MostDetailedMip = 0;
+		srvDesc.TextureCube.MipLevels = mipLevels;
+		srvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
+	} else {
+		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Texture2D.MipLevels = mipLevels;
+		srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
 	}
+	m_device->CreateShaderResourceView(ready ? tex.Resource.Get() : nullptr, &srvDesc, srvHandler);
+}
+
+void TextureMgr::SetResource(textureData& tex, UploadedTexture& uploaded)
+{
+	tex.Resource = std::move(uploaded.payload.resource);
+	tex.isCubeMap = uploaded.payload.isCubeMap;
 }
 
 UINT TextureMgr::RegisterRenderToTexture(std::string_view name)
@@ -104,7 +274,11 @@ size_t TextureMgr::Size() const
 	return m_textureID.size();
 }
 
-TextureMgr::~TextureMgr() = default;
+TextureMgr::~TextureMgr()
+{
+	// ȵȴ̨̲߳ٷ豸
+	m_loader.reset();
+}
 
 TextureMgr::TextureMgr(Singleton<TextureMgr>::Token) : Singleton<TextureMgr>()
 {
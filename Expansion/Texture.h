@@ -6,27 +6,39 @@
 #include <memory>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 #include "Singleton.hpp"
+#include "TextureUploadTracker.hpp"
 
 using Microsoft::WRL::ComPtr;
 extern const std::wstring TexturePath;
 
 struct textureData
 {
-	std::string_view		name;
+	std::string				name;
 	std::wstring			fileName;
 	bool					isCubeMap{ false };
-	ComPtr<ID3D12Resource>	Resource{ nullptr };
+	UINT					registerIndex{ 0 };	// ʵȴ滻仯
+	UINT					srvIndex{ 0 };		// ǰʹõ
+	ComPtr<ID3D12Resource>	Resource{ nullptr };	// ǰָԴΪʱռλ
 	textureData(std::string_view _name, std::wstring _fileName);
 };
 
 class Texture {
 public:
-	Texture(std::string_view name, std::wstring fileName, ID3D12Device* device, ID3D12CommandQueue* queue);
+	Texture(std::string_view name, std::wstring fileName, UINT srvIndex, bool isCubeMap);
 	~Texture() = default;
 	std::unique_ptr<textureData> m_tex;
-private:
-	void CreateDDSTexture(ID3D12Device* currDevice, ID3D12CommandQueue* cmdQueue);
+};
+
+// ߳̽resourceڽʱʼ״̬ΪCOPY_DEST
+struct DDSPayload
+{
+	UINT								maxMips{ 0 };
+	ComPtr<ID3D12Resource>				resource;
+	std::vector<D3D12_SUBRESOURCE_DATA>	subresources;
+	bool								isCubeMap{ false };
+	bool								isPreview{ false };	// ˸߷ֱʵmip
 };
 
 class TextureMgr : public Singleton<TextureMgr>
@@ -37,7 +49,29 @@ public:
 	TextureMgr& operator=(const TextureMgr&) = delete;
 	TextureMgr& operator=(TextureMgr&&) = delete;
 	void Init(ID3D12Device* __restrict currDevice, ID3D12CommandQueue* __restrict cmdQueue);
-	UINT InsertDDSTexture(std::string_view name, const std::wstring& fileName);
+	/*
+	 * ں̨ȡϴǰָռλ
+	 * isCubeMapֻռλάȣDDSļΪ׼
+	 */
+	UINT InsertDDSTexture(std::string_view name, const std::wstring& fileName, bool isCubeMap = false);
+	/*
+	 * ֻ֮СpreviewMipsmipԤúmip
+	 * Ԥ֮ǰ0ʾֱӼ
+	 */
+	void SetPreviewMips(UINT previewMips);
+	// ߳ÿ֡ãύѽϴɵϴǷеȴ滻
+	bool Pump();
+	/*
+	 * ϴɵдеǸGPUڶȡռλ
+	 * completedFenceԽ滻ʱlastFenceգʱ֮֡
+	 */
+	void ApplySwaps(UINT64 completedFence, UINT64 lastFence);
+	// עתΪǰɫеҪת
+	UINT GetSRVIndex(UINT registerIndex) const;
+	// ÿ滻ʾݴϴ
+	UINT GetSwapGeneration() const;
+	// ֱָmipϴ(ʧ)֮ApplySwaps滻
+	void WaitForTexture(std::string_view name);
 	void GenerateSRVHeap();
 	UINT RegisterRenderToTexture(std::string_view name);
 	ID3D12DescriptorHeap* GetSRVDescriptorHeap() const;
@@ -45,6 +79,10 @@ public:
 	size_t Size() const;
 	virtual ~TextureMgr();
 	explicit TextureMgr(typename Singleton<TextureMgr>::Token);
+private:
+	using UploadedTexture = TextureUploadTracker<DDSPayload>::UploadedTexture;
+	void CreateSRV(const textureData& tex) const;
+	static void SetResource(textureData& tex, UploadedTexture& uploaded);
 private:
 	ComPtr<ID3D12Device>									m_device;
 	ComPtr<ID3D12CommandQueue>								m_commandQueue;
@@ -53,4 +91,18 @@ private:
 	std::vector<std::unique_ptr<Texture>>					m_textures;
 	std::unordered_map<size_t, UINT>						m_textureID;
 	UINT													numDescriptor;
+	std::unique_ptr<ITextureUploader<DDSPayload>>			m_uploader;
+	std::unique_ptr<TextureUploadTracker<DDSPayload>>		m_loader;
+	struct RetiredSlot
+	{
+		UINT					slot;
+		UINT64					fence;
+		ComPtr<ID3D12Resource>	resource;	// ָԴһͬ
+	};
+	// עӳ䣬ڶβԤһ
+	std::vector<UINT>										m_srvSlots;
+	std::vector<UINT>										m_freeSlots;
+	std::vector<RetiredSlot>								m_retiredSlots;
+	UINT													m_swapGeneration{ 0 };
+	UINT													m_previewMips{ 0 };
 };
\ No newline at end of file
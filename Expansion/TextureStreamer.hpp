@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MappedFile.h"
+
+/*
+ * ͵̨I/O׶ΣD3D豸
+ * ļӳڴI/Oϣڶ߳а˳ִУռÿ֡ʹõ̳߳أ
+ * ɵĽ߳ͨPollCompletedȡߣϴ滻Ҫ豸Ĺɵ߳
+ */
+template <typename Payload>
+class TextureStreamer
+{
+public:
+	// ߳еãfalseʾļЧ
+	using ParseFunc = std::function<bool(const MappedFile&, Payload&)>;
+	struct Result
+	{
+		uint32_t				idx{ 0 };
+		std::filesystem::path	fileName;
+		bool					succeeded{ false };
+		MappedFile				file;		// ӳֱߴPayload
+		Payload					payload{};
+	};
+
+	explicit TextureStreamer(ParseFunc parse) : m_parse(std::move(parse)), m_thread([this]() { Run(); }) {}
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+	TextureStreamer(TextureStreamer&&) = delete;
+	TextureStreamer& operator=(TextureStreamer&&) = delete;
+	// δʼ󣬵ȴڽ
+	~TextureStreamer()
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		m_thread.join();
+	}
+
+	// payloadΪĳʼֵЯÿĽ
+	void Request(uint32_t idx, std::filesystem::path fileName, Payload payload = {})
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+			m_requests.push_back({ idx, std::move(fileName), std::move(payload) });
+			m_pending.fetch_add(1, std::memory_order_relaxed);
+		}
+		m_wake.notify_one();
+	}
+
+	// ȡѾɽ󣬰˳
+	std::vector<Result> PollCompleted()
+	{
+		std::vector<Result> results;
+		std::lock_guard<std::mutex> guard(m_lock);
+		results.swap(m_completed);
+		return results;
+	}
+
+	// δɽ
+	uint32_t GetPendingCount() const
+	{
+		return m_pending.load(std::memory_order_acquire);
+	}
+
+	void WaitAll()
+	{
+		std::unique_lock<std::mutex> lock(m_lock);
+		m_idle.wait(lock, [this]() { return m_pending.load(std::memory_order_relaxed) == 0; });
+	}
+private:
+	struct Pending
+	{
+		uint32_t				idx;
+		std::filesystem::path	fileName;
+		Payload					payload;
+	};
+	void Run()
+	{
+		for (;;)
+		{
+			Pending request;
+			{
+				std::unique_lock<std::mutex> lock(m_lock);
+				m_wake.wait(lock, [this]() { return m_stop || !m_requests.empty(); });
+				if (m_stop)
+					return;
+				request = std::move(m_requests.front());
+				m_requests.pop_front();
+			}
+			Result result;
+			result.idx = request.idx;
+			result.fileName = std::move(request.fileName);
+			result.payload = std::move(request.payload);
+			try
+			{
+				result.succeeded = result.file.Open(result.fileName) && m_parse(result.file, result.payload);
+			}
+			catch (...)
+			{
+				result.succeeded = false;
+			}
+			{
+				std::lock_guard<std::mutex> guard(m_lock);
+				m_completed.emplace_back(std::move(result));
+				m_pending.fetch_sub(1, std::memory_order_release);
+			}
+			m_idle.notify_all();
+		}
+	}
+private:
+	ParseFunc						m_parse;
+	std::atomic<uint32_t>			m_pending{ 0 };
+	std::mutex						m_lock;
+	std::condition_variable			m_wake;
+	std::condition_variable			m_idle;
+	std::deque<Pending>				m_requests;
+	std::vector<Result>				m_completed;
+	bool							m_stop{ false };
+	// ʼ߳ʱԱѾ
+	std::thread						m_thread;
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include "TextureStreamer.hpp"
+
+enum class TextureState
+{
+	Loading,	// ̨ȡ
+	Uploading,	// ύϴȴGPU
+	Preview,	// ͷֱmipϴѾɣ
+	Ready,		// ϴѾ
+	Failed
+};
+
+/*
+ * ϴˣD3D12ʵResourceUploadBatch¼ύ
+ */
+template <typename Payload>
+class ITextureUploader
+{
+public:
+	virtual ~ITextureUploader() = default;
+	// һɵ뵱ǰΣغpayloadõļݲٱ
+	virtual void Upload(Payload& payload) = 0;
+	// ύǰΣα
+	virtual uint64_t Submit() = 0;
+	// ǷGPUִ
+	virtual bool IsComplete(uint64_t batch) = 0;
+};
+
+/*
+ * ͵״̬D3D豸
+ * Loading -> Uploading -> Preview -> ReadyʧʱFailed
+ * ״ֻ̬ӳϴĽȣϴɵб滻ɵͨTakeReady
+ * PayloadҪṩisPreviewʾʱ˸߷ֱʵmipԤɺԶ
+ */
+template <typename Payload>
+class TextureUploadTracker
+{
+public:
+	struct UploadedTexture
+	{
+		uint32_t	idx;
+		Payload		payload;
+	};
+
+	explicit TextureUploadTracker(typename TextureStreamer<Payload>::ParseFunc parse) : m_streamer(std::move(parse)) {}
+	TextureUploadTracker(const TextureUploadTracker&) = delete;
+	TextureUploadTracker& operator=(const TextureUploadTracker&) = delete;
+	TextureUploadTracker(TextureUploadTracker&&) = delete;
+	TextureUploadTracker& operator=(TextureUploadTracker&&) = delete;
+	~TextureUploadTracker() = default;
+
+	// payloadΪĳʼֵ
+	uint32_t Request(std::filesystem::path fileName, Payload payload = {})
+	{
+		const uint32_t idx = static_cast<uint32_t>(m_states.size());
+		m_states.push_back(TextureState::Loading);
+		m_streamer.Request(idx, std::move(fileName), std::move(payload));
+		return idx;
+	}
+
+	// ߳еãύѽϴռɵϴǷеȴ滻
+	bool Pump(ITextureUploader<Payload>& uploader)
+	{
+		// 1. ѽɵϲΪһϴύȴGPU
+		auto parsed = m_streamer.PollCompleted();
+		PendingBatch pending;
+		for (auto& result : parsed)
+		{
+			if (!result.succeeded)
+			{
+				// ԤѾʱʹԤ
+				m_states[result.idx] = TextureState::Failed;
+				std::cout << "ERROR::TEXTURE::" << result.fileName.string() << " load failed" << std::endl;
+				continue;
+			}
+			// Ԥ֮ʱԤڶ
+			if (result.payload.isPreview)
+				m_streamer.Request(result.idx, result.fileName);
+			uploader.Upload(result.payload);
+			if (m_states[result.idx] == TextureState::Loading)
+				m_states[result.idx] = TextureState::Uploading;
+			pending.textures.push_back({ result.idx, std::move(result.payload) });
+		}
+		if (!pending.textures.empty())
+		{
+			// ύӳļresultһͷ
+			pending.batch = uploader.Submit();
+			m_uploads.emplace_back(std::move(pending));
+		}
+
+		// 2. ռGPUɵϴ
+		for (auto it = m_uploads.begin(); it != m_uploads.end();)
+		{
+			if (!uploader.IsComplete(it->batch))
+			{
+				++it;
+				continue;
+			}
+			for (auto& uploaded : it->textures)
+			{
+				auto& state = m_states[uploaded.idx];
+				// ѾʱɵԤ
+				if (uploaded.payload.isPreview && state == TextureState::Ready)
+					continue;
+				if (state != TextureState::Failed)
+					state = uploaded.payload.isPreview ? TextureState::Preview : TextureState::Ready;
+				// δ滻Ԥȡ
+				m_ready.erase(std::remove_if(m_ready.begin(), m_ready.end(), [&uploaded](const UploadedTexture& ready)
+				{
+					return ready.idx == uploaded.idx;
+				}), m_ready.end());
+				m_ready.emplace_back(std::move(uploaded));
+			}
+			it = m_uploads.erase(it);
+		}
+		return !m_ready.empty();
+	}
+
+	// ֱmipϴ(ʧ)滻
+	void WaitFor(uint32_t idx, ITextureUploader<Payload>& uploader)
+	{
+		while (m_states[idx] != TextureState::Ready && m_states[idx] != TextureState::Failed)
+		{
+			Pump(uploader);
+			std::this_thread::yield();
+		}
+	}
+
+	// ϴɵ˳ȡmaxCountȴ滻
+	std::vector<UploadedTexture> TakeReady(size_t maxCount)
+	{
+		const size_t count = std::min(maxCount, m_ready.size());
+		std::vector<UploadedTexture> taken(std::make_move_iterator(m_ready.begin()), std::make_move_iterator(m_ready.begin() + count));
+		m_ready.erase(m_ready.begin(), m_ready.begin() + count);
+		return taken;
+	}
+
+	TextureState GetState(uint32_t idx) const
+	{
+		return m_states[idx];
+	}
+
+	uint32_t GetTextureCount() const
+	{
+		return static_cast<uint32_t>(m_states.size());
+	}
+private:
+	struct PendingBatch
+	{
+		uint64_t						batch{ 0 };
+		std::vector<UploadedTexture>	textures;
+	};
+	std::vector<TextureState>		m_states;
+	std::vector<PendingBatch>		m_uploads;
+	std::vector<UploadedTexture>	m_ready;
+	// ȴ߳̽
+	TextureStreamer<Payload>		m_streamer;
+};
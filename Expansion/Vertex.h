@@ -1,38 +1,14 @@
 #pragma once
 
 #include <DirectXMath.h>
+#include <cstddef>
 #include "MathHelper.hpp"
 #include "D3DUtil.hpp"
 #include "Light.h"
+#include "VertexFormat.h"
 
 using namespace DirectX;
 
-struct Vertex_GPU
-{
-	XMFLOAT3 pos;
-	XMFLOAT3 normal;
-	XMFLOAT3 tangent;
-	XMFLOAT2 uv;
-	Vertex_GPU(const XMFLOAT3& _pos, const XMFLOAT3& _normal, const XMFLOAT3& _tan, const XMFLOAT2& _uv) : pos(_pos), normal(_normal), tangent(_tan), uv(_uv) {}
-	Vertex_GPU(float px, float py, float pz, float nx, float ny, float nz, float tanx, float tany, float tanz, float u, float v):
-	pos(px, py, pz), normal(nx, ny, nz), tangent(tanx, tany, tanz), uv(u, v) {}
-	Vertex_GPU() = default;
-};
-
-struct Vertex_CPU
-{
-	XMFLOAT3 pos;
-	XMFLOAT3 normal;
-	XMFLOAT3 tangent;
-	XMFLOAT3 bitangent;
-	XMFLOAT2 tex;
-	Vertex_CPU(float px, float py, float pz, float nx, float ny, float nz, float tx, float ty, float tz, float u, float v)
-	: pos(px, py, pz), normal(nx, ny, nz), tangent(tx, ty, tz), tex(u, v) {}
-	Vertex_CPU(const XMFLOAT3& _pos, const XMFLOAT3& _normal, const XMFLOAT3& _tangent, const XMFLOAT2& _tex) :
-	pos(_pos), normal(_normal), tangent(_tangent), tex(_tex) {}
-	Vertex_CPU() = default;
-};
-
 struct ObjectInstance
 {
 	XMFLOAT4X4	model_gpu{ MathHelper::MathHelper::identity4x4() };
@@ -91,3 +67,12 @@ struct PostProcessPass {
 	XMFLOAT3	cameraPos_gpu;
 	float		g_GamePad0;
 };
+
+// DataStructure.hlslComputeStruct.hlslа16ֽڴĲֽڶӦκһĶҪͬʱ޸
+static_assert(sizeof(LightInPixel) == 48, "LightInPixelHLSLLightֲһ");
+static_assert(sizeof(LightInCompute) == 32 && offsetof(LightInCompute, posV) == 16, "LightInComputeHLSLPointLightֲһ");
+static_assert(sizeof(ObjectInstance) == 144, "ObjectInstanceHLSLObjectInstanceֲһ");
+static_assert(offsetof(PassConstant, nearZ_gpu) == 384 && offsetof(PassConstant, renderTargetSize_gpu) == 400
+	&& offsetof(PassConstant, cameraPos_gpu) == 416 && offsetof(PassConstant, ambient) == 432, "PassConstantHLSLWorldConstantֲһ");
+static_assert(offsetof(PassConstant, lights) == 448 && sizeof(PassConstant) == 448 + sizeof(LightInPixel) * MAX_LIGHTS, "PassConstantеlightsHLSLWorldConstantһ");
+static_assert(offsetof(PostProcessPass, nearZ_gpu) == 384 && offsetof(PostProcessPass, cameraPos_gpu) == 400 && sizeof(PostProcessPass) == 416, "PostProcessPassHLSLComputeConstantֲһ");
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+/*
+ * ʽֻDirectXMath񻺴ȲD3DģֱӰļ
+ */
+struct Vertex_GPU
+{
+	XMFLOAT3 pos;
+	XMFLOAT3 normal;
+	XMFLOAT3 tangent;
+	XMFLOAT2 uv;
+	Vertex_GPU(const XMFLOAT3& _pos, const XMFLOAT3& _normal, const XMFLOAT3& _tan, const XMFLOAT2& _uv) : pos(_pos), normal(_normal), tangent(_tan), uv(_uv) {}
+	Vertex_GPU(float px, float py, float pz, float nx, float ny, float nz, float tanx, float tany, float tanz, float u, float v):
+	pos(px, py, pz), normal(nx, ny, nz), tangent(tanx, tany, tanz), uv(u, v) {}
+	Vertex_GPU() = default;
+};
+
+struct Vertex_CPU
+{
+	XMFLOAT3 pos;
+	XMFLOAT3 normal;
+	XMFLOAT3 tangent;
+	XMFLOAT3 bitangent;
+	XMFLOAT2 tex;
+	Vertex_CPU(float px, float py, float pz, float nx, float ny, float nz, float tx, float ty, float tz, float u, float v)
+	: pos(px, py, pz), normal(nx, ny, nz), tangent(tx, ty, tz), tex(u, v) {}
+	Vertex_CPU(const XMFLOAT3& _pos, const XMFLOAT3& _normal, const XMFLOAT3& _tangent, const XMFLOAT2& _tex) :
+	pos(_pos), normal(_normal), tangent(_tangent), tex(_tex) {}
+	Vertex_CPU() = default;
+};
@@ -59,4 +59,20 @@ float3 PhysicalShading(MaterialData mat, float ndotv, float ndotl, float ndoth,
     return result;
 }
 
+float3 ComputePointLight(PointLight light, MaterialData mat, float3 posV, float3 normalDir, float3 viewDir) {
+	float3 lightDir = light.posV - posV;
+	float dist = length(lightDir);
+	lightDir = normalize(lightDir);
+	float attentaution = LightAttenuation(dist, light.fallOfStart, light.fallOfEnd);
+	float3 halfDir = normalize(viewDir + lightDir);
+
+    float ndotl = dot(normalDir, lightDir);
+    float ndotv = dot(normalDir, viewDir);
+    float ndoth = dot(normalDir, halfDir);
+    float hdotv = dot(halfDir, viewDir);
+
+    float3 brdf = PhysicalShading(mat, ndotv, ndotl, ndoth, hdotv) * light.strength * attentaution;
+	return brdf;
+}
+
 #endif
\ No newline at end of file
@@ -3,10 +3,7 @@
 
 static const float PI = 3.141592653589793f;
 static const float INV_PI = 0.3183098861837907f;
-#define MAX_LIGHTS (16)
-#define DIR_LIGHT_NUM (3)
-#define SPOT_LIGHT_COUNT (0)
-#define POINT_LIGHT_COUNT (0)
+#include "../../Base/ShaderConfig.h" // 光源数量与CPU端共用
 #define randOffset (14)
 
 struct Light {
@@ -18,6 +15,13 @@ struct Light {
     float spotPower; // 仅聚光灯
 };
 
+struct PointLight { // 观察空间的点光源，分块延迟与ForwardPlus共用
+    float3 strength; // 光源的颜色
+    float fallOfStart; // 仅点光源、聚光灯
+    float3 posV; // 仅点光源、聚光灯
+    float fallOfEnd; // 仅点光源、聚光灯
+};
+
 struct Material {
     float3 emission;
     uint  diffuseIndex;
@@ -87,6 +91,7 @@ struct CascadedShadowFrustum
     float4 g_cascadedOffset[5]; // shadowTex的平移量
     float4 g_cascadedScale[5]; // shadowTex的缩放量
     float4 g_cascadeFrustumDepthsFloat[5];
+    float4 g_cascadedAtlasScaleBias[5]; // 级联在阴影图集中的uv缩放(xy)与偏移(zw)
     float  g_cascadedBlendArea;
     float  g_shadowOffset;
     int    g_pcfStart;
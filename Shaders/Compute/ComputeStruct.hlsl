@@ -39,13 +39,6 @@ struct GBufferData {
     float3 viewPos;
 };
 
-struct PointLight {
-    float3 strength; // 光源的颜色
-    float fallOfStart; // 仅点光源、聚光灯
-    float3 posV; // 仅点光源、聚光灯
-    float fallOfEnd; // 仅点光源、聚光灯
-};
-
 float2 EncodeSphereMap(float3 normal){
     return normalize(normal.xy) * (sqrt(0.5f - 0.5f * normal.z));
 }
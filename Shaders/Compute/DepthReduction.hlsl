@@ -0,0 +1,46 @@
+#ifndef DEPTH_REDUCTION
+#define DEPTH_REDUCTION
+
+#include "ComputeStruct.hlsl"
+
+#define REDUCTION_GROUP_DIM 16
+
+ConstantBuffer<cbSettings> cbInput : register(b0, space0);
+ConstantBuffer<ComputeConstant> cbPass : register(b1, space0);
+Texture2D gBuffer[3] : register(t3, space0);
+RWByteAddressBuffer depthBounds : register(u0, space0); // 可见像素在观察空间中的(minZ, maxZ)，以asuint存储
+
+groupshared uint groupMinZ;
+groupshared uint groupMaxZ;
+
+/*
+* SDSM的深度归约：正浮点数的位模式与数值同序，观察空间深度以uint进行原子比较
+* 先在线程组内归约，每个线程组只对全局结果做一次原子操作
+* NDC深度为0的天空像素不参与归约，CPU端的参考实现为SampleDistribution::ReduceDepth
+*/
+[numthreads(REDUCTION_GROUP_DIM, REDUCTION_GROUP_DIM, 1)]
+void Reduce(uint3 dispatchID : SV_DispatchThreadID, uint groupIdx : SV_GroupIndex) {
+	if (groupIdx == 0){
+		groupMinZ = 0x7f7fffff;
+		groupMaxZ = 0;
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	if (all(dispatchID.xy < (uint2)cbInput.texSize)){
+		float ndcZ = gBuffer[1][dispatchID.xy].x;
+		if (ndcZ > 0.0f){
+			uint viewZ = asuint(cbPass.g_proj[3][2] / (ndcZ - cbPass.g_proj[2][2]));
+			InterlockedMin(groupMinZ, viewZ);
+			InterlockedMax(groupMaxZ, viewZ);
+		}
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	if (groupIdx == 0 && groupMinZ <= groupMaxZ){
+		uint original;
+		depthBounds.InterlockedMin(0, groupMinZ, original);
+		depthBounds.InterlockedMax(4, groupMaxZ, original);
+	}
+}
+
+#endif
\ No newline at end of file
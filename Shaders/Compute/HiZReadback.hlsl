@@ -0,0 +1,33 @@
+#ifndef HIZ_READBACK
+#define HIZ_READBACK
+
+#include "ComputeStruct.hlsl"
+
+#define HIZ_GROUP_DIM 8
+
+ConstantBuffer<cbSettings> cbInput : register(b0, space0); // texSize为屏幕大小，w0、w1为输出大小
+Texture2D gBuffer[3] : register(t3, space0);
+RWByteAddressBuffer hiZDepth : register(u0, space0); // 以asuint存储的NDC深度，行优先排列
+
+/*
+* 遮挡剔除的深度降采样：每个输出texel取覆盖的所有像素中最远的NDC深度，反向Z下即最小值，天空为0
+* 覆盖范围向外取整，保证每个像素都被某个texel覆盖，CPU端的参考实现为HiZCuller::Downsample
+*/
+[numthreads(HIZ_GROUP_DIM, HIZ_GROUP_DIM, 1)]
+void Downsample(uint3 dispatchID : SV_DispatchThreadID) {
+	uint2 outSize = uint2(cbInput.w0, cbInput.w1);
+	uint2 screenSize = (uint2)cbInput.texSize;
+	if (any(dispatchID.xy >= outSize))
+		return;
+	uint2 start = dispatchID.xy * screenSize / outSize;
+	uint2 end = min(((dispatchID.xy + 1) * screenSize + outSize - 1) / outSize, screenSize);
+	float farthest = 1.0f;
+	for (uint y = start.y; y < end.y; ++y){
+		for (uint x = start.x; x < end.x; ++x){
+			farthest = min(farthest, gBuffer[1][uint2(x, y)].x);
+		}
+	}
+	hiZDepth.Store((dispatchID.y * outSize.x + dispatchID.x) * 4, asuint(farthest));
+}
+
+#endif
\ No newline at end of file
@@ -1,9 +1,8 @@
 #ifndef TILE_BASED_CULLING
 #define TILE_BASED_CULLING
 
-#define TILE_GROUP_DIM (16)
+#include "../../Base/ShaderConfig.h" // TILE_GROUP_DIM、DEPTH_MASK_BITS与MAX_TILE_LIGHTS与CPU端共用
 #define TILE_GROUP_SIZE (TILE_GROUP_DIM * TILE_GROUP_DIM)
-#define MAX_LIGHTS_NUM (2048)
 
 #include "../BRDF/BRDF.hlsl"
 #include "ComputeStruct.hlsl"
@@ -12,12 +11,25 @@ ConstantBuffer<ComputeConstant> cbPass		: register(b0);
 cbuffer 						cbDebug 	: register(b1) {
 	uint g_visualizeLightCount;
 	uint g_visualizePerSampleShading;
+	uint g_pointLightCount; // 可以超过MAX_TILE_LIGHTS，超出时分批剔除
 	uint g_gamepad0;
-	uint g_gamepad1;
+}
+cbuffer 						cbCluster 	: register(b2) {
+	uint  g_clusterCountX;
+	uint  g_clusterCountY;
+	uint  g_clusterSliceCount;
+	uint  g_clusterTileSize;
+	float g_clusterSliceScale;
+	float g_clusterSliceBias;
 }
 StructuredBuffer<PointLight>	sbLights 	: register(t0);
 Texture2D 						gBuffer[3]	: register(t1);
+StructuredBuffer<uint2>			sbClusters	: register(t4); // 每个簇在光源索引列表中的(offset, count)
+StructuredBuffer<uint>			sbClusterLightIndices : register(t5);
+StructuredBuffer<float4>		sbTilePlanes : register(t6); // 每个分块4个侧面(右, 左, 上, 下)，只在投影或分辨率变化时由CPU重建
+Texture2D						transparentDepth : register(t7); // ForwardPlus深度预渲染得到的透明物体NDC深度，清除值0表示没有透明物体
 RWTexture2D<float4> 			output[2]   : register(u1);
+RWStructuredBuffer<uint>		tileLightMask : register(u3); // ForwardPlus的分块光源位域，每个分块占lightWords个uint
 
 SamplerState            pointWrap        : register(s0);
 SamplerState            pointClamp       : register(s1);
@@ -27,21 +39,22 @@ SamplerState            anisotropicWrap  : register(s4);
 SamplerState            anisotropicClamp : register(s5);
 
 groupshared uint tileLightCount;
-groupshared uint tileLightList[MAX_LIGHTS_NUM >> 3];
+groupshared uint tileLightBits[MAX_TILE_LIGHTS >> 5]; // 每批MAX_TILE_LIGHTS盏光源，每个光源占1位，着色时按光源序号升序遍历
 groupshared uint2 depthNearFar;
+groupshared uint depthMask; // 分块深度范围等分为32段，记录有像素落入的段
 
 /*
-* 如果给出的矩阵是投影矩阵，则裁剪面是在观察空间
-* 如果给出的矩阵是VP矩阵，则裁剪面是在世界空间
-* 如果给出的矩阵是MVP矩阵，则裁剪面是在物体空间
+* 观察空间下的子视锥体，侧面来自sbTilePlanes，近远平面由分块的深度范围构造
 */
-void ConstructFrustumPlanes(uint2 groupID, float tileMinZ, float tileMaxZ, uint2 texSize, float4x4 mat, out float4 frustumPlane[6]);
-float3 ComputePointLight(PointLight light, MaterialData mat, float3 pos, float3 normalDir, float3 viewDir);
+void LoadFrustumPlanes(uint2 groupID, float tileMinZ, float tileMaxZ, uint2 texSize, out float4 frustumPlane[6]);
+uint DepthMaskSlot(float viewZ, float tileMinZ, float depthScale);
+float NdcToViewZ(float ndcZ);
 
 /*
 * 为了提出光源，考虑将单个视锥体基于屏幕区域划分为多个块，一个块对应子视锥体，每个分块的大小时16x16，对每个子视锥体进行一次全局光源的视锥体剔除，
 * 从而分别获得各自受影响的光源列表，并在着色时根据当前像素所属的分块区域对对应的光源列表进行着色计算。
 * 同时遍历该区块的所有深度值并算出对应的Zmin、Zmax作为视锥体的nearP和farP,从而缩小视锥体的大小并有效剔除光源
+* 2.5D剔除：Zmin到Zmax之间再划分为32段深度掩码，前景与背景之间的空段不会让光源通过
 */
 [numthreads(TILE_GROUP_DIM, TILE_GROUP_DIM, 1)]
 void Defer(uint3 groupID : SV_GROUPID, uint3 dispathID : SV_DispatchThreadID, uint groupIdx : SV_GROUPINDEX) {
@@ -69,6 +82,7 @@ void Defer(uint3 groupID : SV_GROUPID, uint3 dispathID : SV_DispatchThreadID, ui
 		tileLightCount = 0;
 		depthNearFar.x = 0x7F7FFFFF;
 		depthNearFar.y = 0;
+		depthMask = 0;
 	}
 	GroupMemoryBarrierWithGroupSync();
 	/*
@@ -85,101 +99,207 @@ void Defer(uint3 groupID : SV_GROUPID, uint3 dispathID : SV_DispatchThreadID, ui
 	float tileMinZ = asfloat(depthNearFar.x);
 	float tileMaxZ = asfloat(depthNearFar.y);
 	float4 frustumPlanes[6];
-	ConstructFrustumPlanes(groupID.xy, tileMinZ, tileMaxZ, texSize, cbPass.g_proj, frustumPlanes); // 变换到了View空间
+	LoadFrustumPlanes(groupID.xy, tileMinZ, tileMaxZ, texSize, frustumPlanes); // View空间
+
+	// 深度范围确定后再构建深度掩码
+	float depthScale = DEPTH_MASK_BITS / max(tileMaxZ - tileMinZ, 1e-4f);
+	if (valid) {
+		InterlockedOr(depthMask, 1u << DepthMaskSlot(data.viewPos.z, tileMinZ, depthScale));
+	}
+	GroupMemoryBarrierWithGroupSync();
 
 	// 光源剔除,同时每个线程还要承担一部分的光源碰撞检测计算
-	for (uint idx = groupIdx; idx < MAX_LIGHTS_NUM; idx += TILE_GROUP_SIZE) {
-		PointLight light = sbLights[idx];
-		bool inFrustum = true;
-		[unroll]
-		for (uint i = 0; i < 6; ++i) {
-			float dist = dot(frustumPlanes[i], float4(light.posV, 1.0f));
-			inFrustum = inFrustum && (dist >= -light.fallOfEnd);
+	// 位域一次只覆盖MAX_TILE_LIGHTS盏光源，光源更多时分批剔除与着色，批次按序号递增，着色顺序不变
+	bool shade = all(dispathID.xy < texSize) && !g_visualizeLightCount;
+	float3 viewDir = normalize(-data.viewPos);
+	for (uint lightBase = 0; lightBase < g_pointLightCount; lightBase += MAX_TILE_LIGHTS) {
+		uint batchCount = min(g_pointLightCount - lightBase, MAX_TILE_LIGHTS);
+		uint lightWords = (batchCount + 31) >> 5;
+		for (uint clearIdx = groupIdx; clearIdx < lightWords; clearIdx += TILE_GROUP_SIZE) {
+			tileLightBits[clearIdx] = 0;
 		}
-		[branch]
-		if (inFrustum) {
-			// 会受到光照的light需要被加入列表
-			uint pivot = 0;
-			InterlockedAdd(tileLightCount, 1, pivot);
-			tileLightList[pivot] = idx;
+		GroupMemoryBarrierWithGroupSync();
+
+		for (uint batchIdx = groupIdx; batchIdx < batchCount; batchIdx += TILE_GROUP_SIZE) {
+			PointLight light = sbLights[lightBase + batchIdx];
+			bool inFrustum = true;
+			[unroll]
+			for (uint i = 0; i < 6; ++i) {
+				float dist = dot(frustumPlanes[i], float4(light.posV, 1.0f));
+				inFrustum = inFrustum && (dist >= -light.fallOfEnd);
+			}
+			[branch]
+			if (inFrustum) {
+				// 光源包围球覆盖的深度段与分块中实际存在像素的深度段相交才需要着色
+				uint slotMin = DepthMaskSlot(light.posV.z - light.fallOfEnd, tileMinZ, depthScale);
+				uint slotMax = DepthMaskSlot(light.posV.z + light.fallOfEnd, tileMinZ, depthScale);
+				uint lightMask = (0xFFFFFFFFu >> (31 - slotMax)) & (0xFFFFFFFFu << slotMin);
+				if (lightMask & depthMask) {
+					InterlockedOr(tileLightBits[batchIdx >> 5], 1u << (batchIdx & 31));
+					InterlockedAdd(tileLightCount, 1);
+				}
+			}
 		}
-	}
-	GroupMemoryBarrierWithGroupSync();
+		GroupMemoryBarrierWithGroupSync();
 
-	// 光照计算阶段,只需要处理屏幕区域内的像素即可
-	if (all(dispathID.xy < texSize)) {
+		// 光照计算阶段,只需要处理屏幕区域内的像素即可
 		[branch]
-		if (g_visualizeLightCount) {
-			output[0][dispathID.xy] = float4(float(tileLightCount / 255.0f).xxx, 1.0f);
-			output[1][dispathID.xy] = float4(0, 0, 0, 0);
-		} else {
-			float3 viewDir = normalize(-data.viewPos);
-			for (uint i = 0; i < tileLightCount; ++i) {
-				float3 col = ComputePointLight(sbLights[tileLightList[i]], mat, data.viewPos, data.normalDir, viewDir);
-				output[0][dispathID.xy] += float4(col, 1.0f);
-				float3 luma = output[0][dispathID.xy].xyz;
-				if (Luminance(luma) > 1.0f){
-					output[1][dispathID.xy] += float4(col, 1.0f);
+		if (shade) {
+			for (uint word = 0; word < lightWords; ++word) {
+				uint bits = tileLightBits[word];
+				while (bits != 0) {
+					uint lightIdx = lightBase + ((word << 5) | firstbitlow(bits));
+					bits &= bits - 1;
+					float3 col = ComputePointLight(sbLights[lightIdx], mat, data.viewPos, data.normalDir, viewDir);
+					output[0][dispathID.xy] += float4(col, 1.0f);
+					float3 luma = output[0][dispathID.xy].xyz;
+					if (Luminance(luma) > 1.0f){
+						output[1][dispathID.xy] += float4(col, 1.0f);
+					}
 				}
 			}
 		}
+		// 下一批清空位域之前，所有线程都要完成读取
+		GroupMemoryBarrierWithGroupSync();
+	}
+
+	if (all(dispathID.xy < texSize) && g_visualizeLightCount) {
+		output[0][dispathID.xy] = float4(float(tileLightCount / 255.0f).xxx, 1.0f);
+		output[1][dispathID.xy] = float4(0, 0, 0, 0);
 	}
 }
 
 /*
-Pperspective = Ppersp->ortho*Portho
-Ppersp->ortho = 				Portho =
-  {n,  0, 	0, 		0,				   {1 / (rn*tan(fov/2)), 0, 						0, 				0,
-	0, n, 	0, 		0,				   	0,                   1 / (n * tan(fov / 2)), 	0, 				0,
-	0, 0, n + f, 	1,				   	0, 					 0,							1 / (f - n), 	0,
- 	0, 0, 	-fn, 	0}				   	0, 				     0,							-nf / (f - n),  1 }
-
-则子视锥体的投影矩阵可以被推导为
-Ppersp = {Swidth * m00, 	0, 				0, 	 0,
-			0,			 	Sheight * m11,	0, 	 0,
-			Tx,				Ty,				m22, 1,
-			0,				0,				m32, 0}
+* 分簇版本：光源到簇的分配在CPU端完成，这里只需根据像素的分块与观察空间深度找到所属的簇
+* 簇的深度按指数划分，与分块内的深度分布无关，深度不连续的分块不会因Zmin/Zmax拉开而退化
 */
-void ConstructFrustumPlanes(uint2 groupID, float tileMinZ, float tileMaxZ, uint2 texSize, float4x4 mat, out float4 frustumPlane[6]) {
-	/*
-	* 先为每个分块与计算视锥体平面，随后将结果放入一个常量缓冲区中去，在观察空间中执行，因此只有当投影矩阵发生变化时才需要重新计算
-	*/
-	float2 scale = float2(texSize) / TILE_GROUP_DIM;
-	float2 offset = scale - 1.0f - 2.0f * float2(groupID.xy);
-	// 计算当前分块视锥体的投影的矩阵
-	float4 col0 = float4(scale.x * mat[0][0], 0, offset.x, 0);
-	float4 col1 = float4(0, scale.y * mat[1][1], -offset.y, 0);
-	float4 col3 = float4(0, 0, 1, 0);
-
-	// Gribb/Hartmann法提取视锥体平面
-	frustumPlane[0] = col3 - col0;
-	frustumPlane[1] = col3 + col0;
-	frustumPlane[2] = col3 - col1;
-	frustumPlane[3] = col3 + col1;
-	frustumPlane[4] = float4(0, 0, 1, -tileMinZ);
-	frustumPlane[5] = float4(0, 0, -1, tileMaxZ);
+[numthreads(TILE_GROUP_DIM, TILE_GROUP_DIM, 1)]
+void DeferClustered(uint3 dispathID : SV_DispatchThreadID) {
+	uint2 texSize;
+	gBuffer[0].GetDimensions(texSize.x, texSize.y);
+	if (any(dispathID.xy >= texSize))
+		return;
+	float2 invSize = 1.0f / float2(texSize);
+	GBufferData data = DecodeGBuffer(gBuffer, anisotropicClamp, dispathID.xy, invSize, cbPass.g_proj, cbPass.g_view);
+	// 避免对天空盒或其他非法像素着色
+	bool valid = (data.viewPos.z >= min(cbPass.g_nearZ, cbPass.g_farZ) && data.viewPos.z < max(cbPass.g_nearZ, cbPass.g_farZ));
+	if (!valid)
+		return;
+	MaterialData mat;
+	mat.albedo = data.albedo;
+	mat.roughness = data.roughness;
+	mat.emission = float3(0, 0, 0);
+	mat.metalness = data.metalness;
 
-	// 标准化视锥体平面
-	[unroll]
-	for (uint i = 0; i < 6; ++i){
-		frustumPlane[i] *= rcp(length(frustumPlane[i].xyz));
+	float slice = floor(log(data.viewPos.z) * g_clusterSliceScale + g_clusterSliceBias);
+	uint sliceIdx = (uint)clamp(slice, 0.0f, float(g_clusterSliceCount - 1));
+	uint2 tile = min(dispathID.xy / g_clusterTileSize, uint2(g_clusterCountX, g_clusterCountY) - 1);
+	uint2 cluster = sbClusters[(sliceIdx * g_clusterCountY + tile.y) * g_clusterCountX + tile.x];
+
+	[branch]
+	if (g_visualizeLightCount) {
+		output[0][dispathID.xy] = float4(float(cluster.y / 255.0f).xxx, 1.0f);
+		output[1][dispathID.xy] = float4(0, 0, 0, 0);
+	} else {
+		float3 viewDir = normalize(-data.viewPos);
+		for (uint i = 0; i < cluster.y; ++i) {
+			float3 col = ComputePointLight(sbLights[sbClusterLightIndices[cluster.x + i]], mat, data.viewPos, data.normalDir, viewDir);
+			output[0][dispathID.xy] += float4(col, 1.0f);
+			float3 luma = output[0][dispathID.xy].xyz;
+			if (Luminance(luma) > 1.0f){
+				output[1][dispathID.xy] += float4(col, 1.0f);
+			}
+		}
+	}
+}
+
+/*
+* ForwardPlus的分块光源列表：深度范围从分块内透明物体的最近深度到不透明物体的最远深度，比后者更远的透明片元会被深度测试剔除
+* 透明物体可以相互叠加，分块内的深度分布没有意义，因此不使用深度掩码，光源位域写回显存供前向着色读取
+* CPU端的对应实现为Renderer::TileLightList
+*/
+[numthreads(TILE_GROUP_DIM, TILE_GROUP_DIM, 1)]
+void CullLights(uint3 groupID : SV_GROUPID, uint3 dispathID : SV_DispatchThreadID, uint groupIdx : SV_GROUPINDEX) {
+	uint2 texSize;
+	gBuffer[1].GetDimensions(texSize.x, texSize.y);
+	int3 texel = int3(min(dispathID.xy, texSize - 1), 0);
+	float nearZ = min(cbPass.g_nearZ, cbPass.g_farZ);
+	float farZ = max(cbPass.g_nearZ, cbPass.g_farZ);
+	// 天空盒按远平面处理，透明物体仍然可以出现在它前面
+	float opaqueZ = NdcToViewZ(gBuffer[1].Load(texel).x);
+	if (!(opaqueZ >= nearZ && opaqueZ < farZ)) {
+		opaqueZ = farZ;
+	}
+	float transparentZ = NdcToViewZ(transparentDepth.Load(texel).x);
+	if (groupIdx == 0) {
+		depthNearFar.x = 0x7F7FFFFF;
+		depthNearFar.y = 0;
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	InterlockedMax(depthNearFar.y, asuint(opaqueZ));
+	if (transparentZ >= nearZ && transparentZ < farZ) {
+		InterlockedMin(depthNearFar.x, asuint(transparentZ));
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	float tileMinZ = asfloat(depthNearFar.x);
+	float tileMaxZ = asfloat(depthNearFar.y);
+	float4 frustumPlanes[6];
+	LoadFrustumPlanes(groupID.xy, tileMinZ, tileMaxZ, texSize, frustumPlanes);
+	// 显存中每个分块占(g_pointLightCount + 31) / 32个uint，光源超过MAX_TILE_LIGHTS时分批剔除并写入各自的区间
+	uint lightWords = (g_pointLightCount + 31) >> 5;
+	uint tileCountX = (texSize.x + TILE_GROUP_DIM - 1) / TILE_GROUP_DIM;
+	uint base = (groupID.y * tileCountX + groupID.x) * lightWords;
+	for (uint lightBase = 0; lightBase < g_pointLightCount; lightBase += MAX_TILE_LIGHTS) {
+		uint batchCount = min(g_pointLightCount - lightBase, MAX_TILE_LIGHTS);
+		uint batchWords = (batchCount + 31) >> 5;
+		for (uint clearIdx = groupIdx; clearIdx < batchWords; clearIdx += TILE_GROUP_SIZE) {
+			tileLightBits[clearIdx] = 0;
+		}
+		GroupMemoryBarrierWithGroupSync();
+
+		// 没有透明物体或透明物体全部被遮挡的分块保持空列表
+		if (tileMinZ <= tileMaxZ) {
+			for (uint batchIdx = groupIdx; batchIdx < batchCount; batchIdx += TILE_GROUP_SIZE) {
+				PointLight light = sbLights[lightBase + batchIdx];
+				bool inFrustum = true;
+				[unroll]
+				for (uint i = 0; i < 6; ++i) {
+					float dist = dot(frustumPlanes[i], float4(light.posV, 1.0f));
+					inFrustum = inFrustum && (dist >= -light.fallOfEnd);
+				}
+				if (inFrustum) {
+					InterlockedOr(tileLightBits[batchIdx >> 5], 1u << (batchIdx & 31));
+				}
+			}
+		}
+		GroupMemoryBarrierWithGroupSync();
+
+		for (uint word = groupIdx; word < batchWords; word += TILE_GROUP_SIZE) {
+			tileLightMask[base + (lightBase >> 5) + word] = tileLightBits[word];
+		}
+		GroupMemoryBarrierWithGroupSync();
 	}
 }
 
-float3 ComputePointLight(PointLight light, MaterialData mat, float3 posV, float3 normalDir, float3 viewDir) {
-	float3 lightDir = light.posV - posV;
-	float dist = length(lightDir);
-	lightDir = normalize(lightDir);
-	float attentaution = LightAttenuation(dist, light.fallOfStart, light.fallOfEnd);
-	float3 halfDir = normalize(viewDir + lightDir);
+void LoadFrustumPlanes(uint2 groupID, float tileMinZ, float tileMaxZ, uint2 texSize, out float4 frustumPlane[6]) {
+	uint tileCountX = (texSize.x + TILE_GROUP_DIM - 1) / TILE_GROUP_DIM;
+	uint base = (groupID.y * tileCountX + groupID.x) * 4;
+	[unroll]
+	for (uint i = 0; i < 4; ++i){
+		frustumPlane[i] = sbTilePlanes[base + i];
+	}
+	frustumPlane[4] = float4(0, 0, 1, -tileMinZ);
+	frustumPlane[5] = float4(0, 0, -1, tileMaxZ);
+}
 
-    float ndotl = dot(normalDir, lightDir);
-    float ndotv = dot(normalDir, viewDir);
-    float ndoth = dot(normalDir, halfDir);
-    float hdotv = dot(halfDir, viewDir);
+uint DepthMaskSlot(float viewZ, float tileMinZ, float depthScale) {
+	return (uint)clamp((viewZ - tileMinZ) * depthScale, 0.0f, float(DEPTH_MASK_BITS - 1));
+}
 
-    float3 brdf = PhysicalShading(mat, ndotv, ndotl, ndoth, hdotv) * light.strength * attentaution;
-	return brdf;
+float NdcToViewZ(float ndcZ) {
+	return cbPass.g_proj[3][2] / (ndcZ - cbPass.g_proj[2][2]);
 }
 
 #endif
\ No newline at end of file
@@ -20,16 +20,20 @@ float3 DebugCascadedShadowColor(uint curr, uint next, float weight) {
 }
 
 /*
-* 计算PCF滤波
+* 计算PCF滤波，shadowPos为级联内[0, 1]的纹理坐标，采样前变换到图集中该级联的区域
 */
-float CalcPCF(float4 shadowPos, float invWidth, float invHeight, CascadedShadowFrustum frustum, Texture2D shadow, SamplerComparisonState depthSample) {
+float CalcPCF(float4 shadowPos, float invAtlasSize, float4 atlasScaleBias, CascadedShadowFrustum frustum, Texture2D shadowAtlas, SamplerComparisonState depthSample) {
 	shadowPos.xyz /= shadowPos.w;
 	float depthZ = shadowPos.z;
+	float2 atlasUV = shadowPos.xy * atlasScaleBias.xy + atlasScaleBias.zw;
+	// 相邻级联在图集中紧挨着，采样点限制在当前区域内，避免PCF读到其他级联的深度
+	float2 regionMin = atlasScaleBias.zw + 0.5f * invAtlasSize;
+	float2 regionMax = atlasScaleBias.zw + atlasScaleBias.xy - 0.5f * invAtlasSize;
 	float ans = 0.0f;
 	for (int x = frustum.g_pcfStart; x <= frustum.g_pcfEnd; ++x){
 		for (int y = frustum.g_pcfStart; y <= frustum.g_pcfEnd; ++y){
-			float2 offset = shadowPos.xy + float2(x, y) * float2(invWidth, invHeight);
-			ans += shadow.SampleCmpLevelZero(depthSample, offset, depthZ);
+			float2 offset = clamp(atlasUV + float2(x, y) * invAtlasSize, regionMin, regionMax);
+			ans += shadowAtlas.SampleCmpLevelZero(depthSample, offset, depthZ);
 		}
 	}
 	return ans / ((frustum.g_pcfEnd - frustum.g_pcfStart + 1) * (frustum.g_pcfEnd - frustum.g_pcfStart + 1));
@@ -74,20 +78,21 @@ void CalcBlendAmountForMap(float4 shadowTexcoord, CascadedShadowFrustum frustum,
 /*
 * 基于映射的级联选择：从级联0开始，计算当前级联的投影纹理坐标，然后对级联纹理的边界进行测试，倘若不在边界范围中就尝试下一层CSM，直到找到投影纹理位于边界范围的级联为止
 */
-float CalcCascadedShadowByMapped(float4 shadowPos, Texture2D shadowTex[5], CascadedShadowFrustum frustum, SamplerComparisonState sampleState, out uint currIdx, out uint nextIdx, out float weight) {
+float CalcCascadedShadowByMapped(float4 shadowPos, Texture2D shadowAtlas, CascadedShadowFrustum frustum, SamplerComparisonState sampleState, out uint currIdx, out uint nextIdx, out float weight) {
 	currIdx = 0, nextIdx = 0;
 	weight = 1.0f;
 	uint width, height;
-	shadowTex[0].GetDimensions(width, height);
-	float invWidth = 1.0f / (float)width, invHeight = 1.0f / (float)height;
+	shadowAtlas.GetDimensions(width, height);
+	float invAtlasSize = 1.0f / (float)width;
 	uint halfKernel = abs(frustum.g_pcfEnd);
-	float minBorder = halfKernel * invWidth, maxBorder = 1.0f - minBorder;
 
 	uint foundCascade = 0;
 	float4 shadowTexcoord = float4(0.0f, 0.0f, 0.0f, 0.0f);
 	[unroll]
 	for (uint i = 0; i < 5 && !foundCascade; ++i){
 		shadowTexcoord = shadowPos * frustum.g_cascadedScale[i] + frustum.g_cascadedOffset[i];
+		// 各级联分辨率不同，PCF核心占据的边界按级联自身的texel大小计算
+		float minBorder = halfKernel * invAtlasSize / frustum.g_cascadedAtlasScaleBias[i].x, maxBorder = 1.0f - minBorder;
 		if (min(shadowTexcoord.x, shadowTexcoord.y) > minBorder && max(shadowTexcoord.x, shadowTexcoord.y) < maxBorder){
 			currIdx = i;
 			foundCascade = 1;
@@ -97,18 +102,18 @@ float CalcCascadedShadowByMapped(float4 shadowPos, Texture2D shadowTex[5], Casca
 	float4 shadowNextTexcoord = shadowPos * frustum.g_cascadedScale[nextIdx] + frustum.g_cascadedOffset[nextIdx];
 
 	// 计算pcf核心
-	float currPercent = CalcPCF(shadowTexcoord, invWidth, invHeight, frustum, shadowTex[currIdx], sampleState);
-	float nextPercent = CalcPCF(shadowNextTexcoord, invWidth, invHeight, frustum, shadowTex[nextIdx], sampleState);
+	float currPercent = CalcPCF(shadowTexcoord, invAtlasSize, frustum.g_cascadedAtlasScaleBias[currIdx], frustum, shadowAtlas, sampleState);
+	float nextPercent = CalcPCF(shadowNextTexcoord, invAtlasSize, frustum.g_cascadedAtlasScaleBias[nextIdx], frustum, shadowAtlas, sampleState);
 	CalcBlendAmountForMap(shadowTexcoord, frustum, weight);
 	return lerp(nextPercent, currPercent, weight);
 }
 
-float CalcCascadedShadowByInterval(float4 shadowPos, float depthZ, Texture2D shadowTex[5], CascadedShadowFrustum frustum, SamplerComparisonState sampleState, out uint currIdx, out uint nextIdx, out float weight) {
+float CalcCascadedShadowByInterval(float4 shadowPos, float depthZ, Texture2D shadowAtlas, CascadedShadowFrustum frustum, SamplerComparisonState sampleState, out uint currIdx, out uint nextIdx, out float weight) {
 	currIdx = 0, nextIdx = 0;
 	weight = 1.0f;
 	uint width, height;
-	shadowTex[0].GetDimensions(width, height);
-	float invWidth = 1.0f / width, invHeight = 1.0f / height;
+	shadowAtlas.GetDimensions(width, height);
+	float invAtlasSize = 1.0f / width;
 
 	/*
 	* 在该方法中，顶点着色器需要计算顶点在世界空间中的深度并在像素着色器中计算出查之后的深度并根据深度值的区间范围选择对应的级联，
@@ -125,8 +130,8 @@ float CalcCascadedShadowByInterval(float4 shadowPos, float depthZ, Texture2D sha
 	float4 shadowNextTexcoord = shadowPos * frustum.g_cascadedScale[nextIdx] + frustum.g_cascadedOffset[nextIdx];
 
 	CalcBlendAmountForInterval(depthZ, shadowTexcoord.xy, frustum, currIdx, weight);
-	float currPCF = CalcPCF(shadowTexcoord, invWidth, invHeight, frustum, shadowTex[currIdx], sampleState);
-	float nextPCF = CalcPCF(shadowNextTexcoord, invWidth, invHeight, frustum, shadowTex[nextIdx], sampleState);
+	float currPCF = CalcPCF(shadowTexcoord, invAtlasSize, frustum.g_cascadedAtlasScaleBias[currIdx], frustum, shadowAtlas, sampleState);
+	float nextPCF = CalcPCF(shadowNextTexcoord, invAtlasSize, frustum.g_cascadedAtlasScaleBias[nextIdx], frustum, shadowAtlas, sampleState);
 	return lerp(nextPCF, currPCF, weight);
 }
 
@@ -0,0 +1,35 @@
+#ifndef SHADOW_CACHE
+#define SHADOW_CACHE
+
+// 静态物体的阴影缓存，与阴影图集位于同一个描述符表，两者中级联区域的位置相同
+Texture2D g_staticShadow : register(t5, space2);
+
+// 静态缓存在区域内环形寻址：缓存中的位置 = (窗口中的位置 + 偏移) % 区域边长
+cbuffer cbShadowCache : register(b5) {
+    uint2 g_regionOrigin;
+    uint g_regionSize;
+    uint g_cacheOffset; // 低16位为x，高16位为y
+}
+
+struct v2f {
+    float4 pos : SV_POSITION;
+};
+
+// 一个覆盖整个视口的三角形，视口与裁剪矩形限定为级联在图集中的区域
+v2f Vert(uint vertexID : SV_VERTEXID)
+{
+    v2f o;
+    float2 uv = float2((vertexID << 1) & 2, vertexID & 2);
+    o.pos = float4(uv * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f), 0.0f, 1.0f);
+    return o;
+}
+
+// 将静态深度原样写入图集，之后动态物体在其上继续进行深度测试
+float Frag(v2f o) : SV_DEPTH
+{
+    uint2 local = uint2(o.pos.xy) - g_regionOrigin;
+    uint2 offset = uint2(g_cacheOffset & 0xffff, g_cacheOffset >> 16);
+    return g_staticShadow.Load(int3(g_regionOrigin + (local + offset) % g_regionSize, 0)).r;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+#ifndef FORWARD_PLUS
+#define FORWARD_PLUS
+
+#include "GameBase.hlsl"
+
+/*
+* 透明物体的前向着色：平行光沿用ComputeLighting，点光源读取TileBased.hlsl中CullLights写出的分块光源位域
+* 点光源位于观察空间，着色同样在观察空间中进行
+*/
+cbuffer cbTileLights : register(b4) {
+    uint g_tileCountX;
+    uint g_tileLightWords; // 每个分块占用的uint数，与CullLights写入时一致
+    uint g_tilePad0;
+    uint g_tilePad1;
+}
+StructuredBuffer<PointLight> sbLights : register(t0, space3);
+StructuredBuffer<uint> sbTileLightBits : register(t1, space3);
+
+struct input
+{
+    float3 vertex : POSITION;
+    float3 normal : NORMAL;
+    float3 tangent : TANGENT;
+    float2 uv : TEXCOORD;
+};
+
+struct v2f
+{
+    float4 pos : SV_POSITION;
+    float3 normal : NORMAL;
+    float3 tangent : TANGENT;
+    float3 frag : POSITION0;
+    float4 shadowPos : POSITION1;
+    float3 posV : POSITION2;
+    float2 uv : TEXCOORD;
+
+    nointerpolation uint matIndex : MATINDEX;
+};
+
+v2f Vert(input v, uint instanceID : SV_INSTANCEID)
+{
+    v2f o;
+    ObjectInstance objectData = instanceData[instanceID];
+    float4 worldFrag = mul(float4(v.vertex, 1.0f), objectData.g_model);
+    o.frag = worldFrag.xyz;
+    o.posV = mul(worldFrag, cbPass.g_view).xyz;
+    o.pos = mul(worldFrag, cbPass.g_vp);
+    o.shadowPos = mul(worldFrag, cbPass.shadowTansform);
+    o.normal = mul(v.normal, (float3x3)objectData.g_model);
+    o.tangent = mul(v.tangent, (float3x3)objectData.g_model);
+    o.matIndex = objectData.g_matIndex;
+    o.uv = v.uv;
+    return o;
+}
+
+float4 Frag(v2f o) : SV_TARGET
+{
+    Material mat = cbMaterial[o.matIndex];
+    float4 sampleCol = g_modelTexture[mat.diffuseIndex].Sample(anisotropicWrap, o.uv);
+    float3 albedo = sampleCol.xyz;
+    float3 ambient = albedo * cbPass.ambient;
+
+    float3 normalSample = g_modelTexture[mat.normalIndex].Sample(anisotropicWrap, o.uv).xyz;
+    float3 normalDir = CalcByTBN(normalSample, o.normal, o.tangent);
+    float2 metalicRoughness = g_modelTexture[mat.metalnessIndex].Sample(anisotropicWrap, o.uv).xy;
+
+    float3 viewDir = normalize(cbPass.g_cameraPos - o.frag);
+    MaterialData matData;
+    matData.albedo = albedo;
+    matData.roughness = metalicRoughness.x;
+    matData.metalness = metalicRoughness.y;
+    matData.emission = mat.emission;
+    float3 ans = ComputeLighting(cbPass.lights, matData, o.frag, normalDir, viewDir, o.shadowPos) + ambient;
+
+    // 像素所在分块的光源按序号升序着色，与TileBased_Defer的顺序一致
+    float3 normalV = normalize(mul(normalDir, (float3x3)cbPass.g_view));
+    float3 viewDirV = normalize(-o.posV);
+    uint2 tile = uint2(o.pos.xy) / TILE_GROUP_DIM;
+    uint base = (tile.y * g_tileCountX + tile.x) * g_tileLightWords;
+    for (uint word = 0; word < g_tileLightWords; ++word) {
+        uint bits = sbTileLightBits[base + word];
+        while (bits != 0) {
+            uint lightIdx = (word << 5) | firstbitlow(bits);
+            bits &= bits - 1;
+            ans += ComputePointLight(sbLights[lightIdx], matData, o.posV, normalV, viewDirV);
+        }
+    }
+
+    return float4(ans, sampleCol.a);
+};
+
+#endif
\ No newline at end of file
@@ -22,7 +22,8 @@ Texture2D randomTex : register(t2);
 Texture2D ssao : register(t3);
 Texture2D g_modelTexture[256] : register(t4);
 Texture2D gBuffer[3] : register(t4, space1);
-Texture2D g_shadow[5] : register(t4, space2);
+// 所有级联共用一张阴影图集
+Texture2D g_shadow : register(t4, space2);
 ConstantBuffer<WorldConstant> cbPass : register(b0);
 ConstantBuffer<SSAOPass> ssaoNoise : register(b1);
 ConstantBuffer<BlurPass> blurNoise : register(b2);
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "TestFramework.h"
+#include "AliasingPlanner.h"
+
+namespace
+{
+struct PlannedResource
+{
+	uint64_t			size;
+	uint64_t			alignment;
+	TransientHeapType	heapType;
+	uint32_t			firstUse;
+	uint32_t			lastUse;
+};
+
+bool LifetimesOverlap(const PlannedResource& lhs, const PlannedResource& rhs)
+{
+	return lhs.firstUse <= rhs.lastUse && rhs.firstUse <= lhs.lastUse;
+}
+
+bool MemoryOverlaps(const PlannedResource& lhs, uint64_t lhsOffset, const PlannedResource& rhs, uint64_t rhsOffset)
+{
+	return lhsOffset < rhsOffset + rhs.size && rhsOffset < lhsOffset + lhs.size;
+}
+
+// passۼӴԴĴС
+uint64_t BruteForcePeakLive(const std::vector<PlannedResource>& resources, uint32_t passCount)
+{
+	uint64_t peak = 0;
+	for (uint32_t pass = 0; pass < passCount; ++pass)
+	{
+		uint64_t live = 0;
+		for (const auto& res : resources)
+		{
+			if (res.firstUse <= pass && pass <= res.lastUse)
+				live += res.size;
+		}
+		peak = std::max(peak, live);
+	}
+	return peak;
+}
+}
+
+TEST(AliasingPlanner, DisjointLifetimesShareMemory)
+{
+	AliasingPlanner planner;
+	const uint32_t first = planner.AddResource(1000, 256, TransientHeapType::renderTarget, 0, 1);
+	const uint32_t second = planner.AddResource(800, 512, TransientHeapType::renderTarget, 2, 3);
+	const uint32_t overlapping = planner.AddResource(300, 256, TransientHeapType::renderTarget, 1, 2);
+	const uint32_t texture = planner.AddResource(4096, 4096, TransientHeapType::texture, 0, 3);
+	planner.Plan();
+
+	EXPECT_EQ(planner.GetResourceCount(), 4u);
+	EXPECT_EQ(planner.GetPlacement(first).offset, planner.GetPlacement(second).offset);
+	EXPECT_NE(planner.GetPlacement(first).offset, planner.GetPlacement(overlapping).offset);
+	EXPECT_EQ(planner.GetPlacement(texture).heapType, TransientHeapType::texture);
+	EXPECT_EQ(planner.GetPlacement(texture).offset, 0u);
+	// ڶλ2561000֮
+	EXPECT_EQ(planner.GetHeapSize(TransientHeapType::renderTarget), 1024u + 300u);
+	EXPECT_EQ(planner.GetHeapSize(TransientHeapType::texture), 4096u);
+	EXPECT_EQ(planner.GetHeapSize(TransientHeapType::buffer), 0u);
+	EXPECT_EQ(planner.GetUnaliasedSize(), 1000u + 800u + 300u + 4096u);
+	EXPECT_EQ(planner.GetAliasedSize(), 1324u + 4096u);
+	EXPECT_EQ(planner.GetSavedSize(), 6196u - 5420u);
+	EXPECT_EQ(planner.GetPeakLiveSize(), 1300u + 4096u);
+
+	const auto& events = planner.GetAliasingEvents();
+	ASSERT_EQ(events.size(), 1u);
+	EXPECT_EQ(events[0].position, 2u);
+	EXPECT_EQ(events[0].before, first);
+	EXPECT_EQ(events[0].after, second);
+
+	// ٴι滮ǰ
+	planner.Reset();
+	planner.Plan();
+	EXPECT_EQ(planner.GetResourceCount(), 0u);
+	EXPECT_EQ(planner.GetAliasedSize(), 0u);
+	EXPECT_TRUE(planner.GetAliasingEvents().empty());
+}
+
+TEST(AliasingPlanner, RejectsInvalidResources)
+{
+	AliasingPlanner planner;
+	EXPECT_THROW(planner.AddResource(16, 16, TransientHeapType::texture, 3, 2), std::runtime_error);
+	EXPECT_THROW(planner.AddResource(16, 0, TransientHeapType::texture, 0, 0), std::runtime_error);
+	EXPECT_THROW(planner.AddResource(16, 48, TransientHeapType::texture, 0, 0), std::runtime_error);
+	EXPECT_THROW(planner.AddResource(16, 16, TransientHeapType::count, 0, 0), std::runtime_error);
+	EXPECT_NO_THROW(planner.AddResource(16, 1, TransientHeapType::buffer, 0, 0));
+}
+
+TEST(AliasingPlanner, RandomPlansNeverOverlapLiveResources)
+{
+	std::mt19937 rng(2024);
+	for (uint32_t iteration = 0; iteration < 500; ++iteration)
+	{
+		const uint32_t passCount = 1 + rng() % 24;
+		const uint32_t resourceCount = rng() % 40;
+		std::vector<PlannedResource> resources;
+		AliasingPlanner planner;
+		for (uint32_t idx = 0; idx < resourceCount; ++idx)
+		{
+			PlannedResource res;
+			// СǶ
+			res.size = 1 + rng() % (1 << (4 + rng() % 14));
+			res.alignment = 1ULL << (rng() % 17);
+			res.heapType = static_cast<TransientHeapType>(rng() % AliasingPlanner::heapTypeCount);
+			res.firstUse = rng() % passCount;
+			res.lastUse = res.firstUse + rng() % (passCount - res.firstUse);
+			ASSERT_EQ(planner.AddResource(res.size, res.alignment, res.heapType, res.firstUse, res.lastUse), idx);
+			resources.push_back(res);
+		}
+		planner.Plan();
+
+		uint64_t unaliased = 0;
+		for (uint32_t idx = 0; idx < resourceCount; ++idx)
+		{
+			const PlannedResource& res = resources[idx];
+			const TransientPlacement& placement = planner.GetPlacement(idx);
+			unaliased += res.size;
+			EXPECT_EQ(placement.heapType, res.heapType);
+			EXPECT_EQ(placement.offset % res.alignment, 0u);
+			EXPECT_LE(placement.offset + res.size, planner.GetHeapSize(res.heapType));
+			// ͬһཻԴڴ滥ص
+			for (uint32_t other = idx + 1; other < resourceCount; ++other)
+			{
+				const PlannedResource& rhs = resources[other];
+				if (rhs.heapType != res.heapType || !LifetimesOverlap(res, rhs))
+					continue;
+				if (MemoryOverlaps(res, placement.offset, rhs, planner.GetPlacement(other).offset))
+					Test::Fail(__FILE__, __LINE__, "iteration " + std::to_string(iteration) + ": live resources " + std::to_string(idx) + " and " + std::to_string(other) + " overlap");
+			}
+		}
+		EXPECT_EQ(planner.GetUnaliasedSize(), unaliased);
+		EXPECT_EQ(planner.GetPeakLiveSize(), BruteForcePeakLive(resources, passCount));
+		EXPECT_LE(planner.GetPeakLiveSize(), planner.GetAliasedSize());
+		EXPECT_EQ(planner.GetSavedSize(), unaliased > planner.GetAliasedSize() ? unaliased - planner.GetAliasedSize() : 0u);
+
+		// ¼λ򣬽ֵԴڽԴ֮ʼʹãռͬһڴ
+		std::vector<uint32_t> takeovers(resourceCount, 0);
+		uint32_t lastPosition = 0;
+		for (const AliasingEvent& event : planner.GetAliasingEvents())
+		{
+			ASSERT_LT(event.before, resourceCount);
+			ASSERT_LT(event.after, resourceCount);
+			const PlannedResource& before = resources[event.before];
+			const PlannedResource& after = resources[event.after];
+			EXPECT_GE(event.position, lastPosition);
+			lastPosition = event.position;
+			EXPECT_EQ(event.position, after.firstUse);
+			EXPECT_LT(before.lastUse, after.firstUse);
+			EXPECT_EQ(before.heapType, after.heapType);
+			EXPECT_TRUE(MemoryOverlaps(before, planner.GetPlacement(event.before).offset, after, planner.GetPlacement(event.after).offset));
+			++takeovers[event.after];
+		}
+		for (uint32_t idx = 0; idx < resourceCount; ++idx)
+		{
+			EXPECT_LE(takeovers[idx], 1u);
+		}
+	}
+}
@@ -0,0 +1,141 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include "BVH.h"
+
+using namespace Models;
+
+namespace
+{
+std::vector<BoundingBox> RandomBoxes(uint32_t count)
+{
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> centerDist(-1000.0f, 1000.0f);
+	std::uniform_real_distribution<float> extentDist(0.5f, 8.0f);
+	std::vector<BoundingBox> boxes(count);
+	for (auto& box : boxes)
+	{
+		box.Center = XMFLOAT3(centerDist(rng), centerDist(rng) * 0.1f, centerDist(rng));
+		box.Extents = XMFLOAT3(extentDist(rng), extentDist(rng), extentDist(rng));
+	}
+	return boxes;
+}
+
+// 뼶Ĳƽ򳡾ĵһխ
+void SlabPlanes(XMFLOAT4* planes)
+{
+	planes[0] = XMFLOAT4(1.0f, 0.0f, 0.0f, -100.0f);
+	planes[1] = XMFLOAT4(-1.0f, 0.0f, 0.0f, -100.0f);
+	planes[2] = XMFLOAT4(0.0f, 0.0f, 1.0f, -300.0f);
+	planes[3] = XMFLOAT4(0.0f, 0.0f, -1.0f, -300.0f);
+}
+
+void BM_Build(benchmark::State& state)
+{
+	const auto boxes = RandomBoxes(static_cast<uint32_t>(state.range(0)));
+	BVH bvh;
+	for (auto _ : state)
+	{
+		bvh.Build(boxes);
+		benchmark::DoNotOptimize(bvh.GetNodes().data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Build)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 17);
+
+void BM_Refit(benchmark::State& state)
+{
+	const auto boxes = RandomBoxes(static_cast<uint32_t>(state.range(0)));
+	BVH bvh;
+	bvh.Build(boxes);
+	for (auto _ : state)
+	{
+		bvh.Refit(boxes);
+		benchmark::DoNotOptimize(bvh.GetNodes().data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Refit)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 17);
+
+// BVHѯ԰ΧеıȽ
+void BM_QueryPlanes(benchmark::State& state)
+{
+	const auto boxes = RandomBoxes(static_cast<uint32_t>(state.range(0)));
+	BVH bvh;
+	bvh.Build(boxes);
+	XMFLOAT4 planes[4];
+	SlabPlanes(planes);
+	std::vector<uint32_t> result;
+	for (auto _ : state)
+	{
+		result.clear();
+		bvh.QueryPlanes(planes, 4, result);
+		benchmark::DoNotOptimize(result.data());
+	}
+	state.counters["hits"] = static_cast<double>(result.size());
+}
+BENCHMARK(BM_QueryPlanes)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 17);
+
+void BM_QueryPlanesLinear(benchmark::State& state)
+{
+	const auto boxes = RandomBoxes(static_cast<uint32_t>(state.range(0)));
+	XMFLOAT4 planes[4];
+	SlabPlanes(planes);
+	std::vector<uint32_t> result;
+	for (auto _ : state)
+	{
+		result.clear();
+		for (uint32_t i = 0; i < boxes.size(); ++i)
+		{
+			const auto& box = boxes[i];
+			bool outside = false;
+			for (const auto& p : planes)
+			{
+				const float dist = p.x * box.Center.x + p.y * box.Center.y + p.z * box.Center.z + p.w;
+				const float radius = std::fabs(p.x) * box.Extents.x + std::fabs(p.y) * box.Extents.y + std::fabs(p.z) * box.Extents.z;
+				outside = outside || dist > radius;
+			}
+			if (!outside)
+				result.push_back(i);
+		}
+		benchmark::DoNotOptimize(result.data());
+	}
+	state.counters["hits"] = static_cast<double>(result.size());
+}
+BENCHMARK(BM_QueryPlanesLinear)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 17);
+
+// ϵʰȡ
+void BM_RaycastTriangles(benchmark::State& state)
+{
+	const uint32_t side = static_cast<uint32_t>(state.range(0));
+	std::vector<XMFLOAT3> positions;
+	std::vector<uint32_t> indices;
+	for (uint32_t z = 0; z <= side; ++z)
+	{
+		for (uint32_t x = 0; x <= side; ++x)
+		{
+			positions.emplace_back(static_cast<float>(x), std::sin(x * 0.1f) * std::cos(z * 0.1f) * 4.0f, static_cast<float>(z));
+		}
+	}
+	for (uint32_t z = 0; z < side; ++z)
+	{
+		for (uint32_t x = 0; x < side; ++x)
+		{
+			const uint32_t i = z * (side + 1) + x;
+			indices.insert(indices.end(), { i, i + side + 1, i + 1, i + 1, i + side + 1, i + side + 2 });
+		}
+	}
+	BVH bvh;
+	bvh.BuildTriangles(positions, indices);
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> posDist(0.0f, static_cast<float>(side));
+	for (auto _ : state)
+	{
+		RayHit hit;
+		const XMVECTOR origin = XMVectorSet(posDist(rng), 50.0f, posDist(rng), 0.0f);
+		benchmark::DoNotOptimize(bvh.Raycast(origin, XMVectorSet(0.1f, -1.0f, 0.05f, 0.0f), 1000.0f, hit));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RaycastTriangles)->Arg(64)->Arg(512);
+}
@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "TestFramework.h"
+#include "BVH.h"
+
+using namespace Models;
+
+namespace
+{
+std::vector<BoundingBox> RandomBoxes(uint32_t count, uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> centerDist(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> extentDist(0.1f, 5.0f);
+	std::vector<BoundingBox> boxes(count);
+	for (auto& box : boxes)
+	{
+		box.Center = XMFLOAT3(centerDist(rng), centerDist(rng), centerDist(rng));
+		box.Extents = XMFLOAT3(extentDist(rng), extentDist(rng), extentDist(rng));
+	}
+	return boxes;
+}
+
+bool BoxOutsidePlanes(const BoundingBox& box, const XMFLOAT4* planes, uint32_t planeCount)
+{
+	for (uint32_t i = 0; i < planeCount; ++i)
+	{
+		const auto& p = planes[i];
+		const float dist = p.x * box.Center.x + p.y * box.Center.y + p.z * box.Center.z + p.w;
+		const float radius = std::fabs(p.x) * box.Extents.x + std::fabs(p.y) * box.Extents.y + std::fabs(p.z) * box.Extents.z;
+		if (dist > radius)
+			return true;
+	}
+	return false;
+}
+
+std::vector<uint32_t> Sorted(std::vector<uint32_t> values)
+{
+	std::sort(values.begin(), values.end());
+	return values;
+}
+
+// ÿͼԪǡóһҶڵУÿڵİΧаӽڵͼԪ
+void CheckStructure(const BVH& bvh)
+{
+	const auto& nodes = bvh.GetNodes();
+	ASSERT_FALSE(nodes.empty());
+	std::vector<uint32_t> seen(bvh.GetPrimitiveCount(), 0);
+	const auto contains = [](const BVHNode& node, const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax)
+	{
+		constexpr float eps = 1e-4f;
+		return node.boundsMin.x <= boundsMin.x + eps && node.boundsMin.y <= boundsMin.y + eps && node.boundsMin.z <= boundsMin.z + eps &&
+			node.boundsMax.x >= boundsMax.x - eps && node.boundsMax.y >= boundsMax.y - eps && node.boundsMax.z >= boundsMax.z - eps;
+	};
+	uint32_t leafPrims = 0;
+	for (size_t n = 0; n < nodes.size(); ++n)
+	{
+		const auto& node = nodes[n];
+		if (!node.IsLeaf())
+		{
+			ASSERT_LT(node.offset, nodes.size());
+			EXPECT_TRUE(contains(node, nodes[n + 1].boundsMin, nodes[n + 1].boundsMax));
+			EXPECT_TRUE(contains(node, nodes[node.offset].boundsMin, nodes[node.offset].boundsMax));
+			continue;
+		}
+		leafPrims += node.count;
+	}
+	EXPECT_EQ(leafPrims, bvh.GetPrimitiveCount());
+	// øĲѯռȫͼԪ
+	std::vector<uint32_t> all;
+	BoundingBox everything(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1e6f, 1e6f, 1e6f));
+	bvh.QueryAABB(everything, all);
+	for (const uint32_t prim : all)
+	{
+		ASSERT_LT(prim, seen.size());
+		++seen[prim];
+	}
+	for (const uint32_t count : seen)
+	{
+		ASSERT_EQ(count, 1u);
+	}
+}
+}
+
+TEST(BVH, EmptyBuildHasNoNodes)
+{
+	BVH bvh;
+	bvh.Build({});
+	EXPECT_TRUE(bvh.Empty());
+	std::vector<uint32_t> result;
+	bvh.QueryAABB(BoundingBox(), result);
+	EXPECT_TRUE(result.empty());
+	RayHit hit;
+	EXPECT_FALSE(bvh.Raycast(XMVectorZero(), XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), 100.0f, hit));
+}
+
+TEST(BVH, StructureCoversEveryPrimitiveOnce)
+{
+	for (uint32_t count : { 1u, 3u, 17u, 1000u, 5000u })
+	{
+		BVH bvh;
+		bvh.Build(RandomBoxes(count, count));
+		CheckStructure(bvh);
+	}
+}
+
+TEST(BVH, BuildIsDeterministic)
+{
+	const auto boxes = RandomBoxes(3000, 5);
+	BVH first, second;
+	first.Build(boxes);
+	second.Build(boxes);
+	const auto& a = first.GetNodes();
+	const auto& b = second.GetNodes();
+	ASSERT_EQ(a.size(), b.size());
+	for (size_t i = 0; i < a.size(); ++i)
+	{
+		ASSERT_EQ(a[i].offset, b[i].offset);
+		ASSERT_EQ(a[i].count, b[i].count);
+		ASSERT_EQ(a[i].boundsMin.x, b[i].boundsMin.x);
+		ASSERT_EQ(a[i].boundsMax.z, b[i].boundsMax.z);
+	}
+}
+
+TEST(BVH, QueriesMatchBruteForce)
+{
+	const auto boxes = RandomBoxes(4000, 9);
+	BVH bvh;
+	bvh.Build(boxes);
+	std::mt19937 rng(13);
+	std::uniform_real_distribution<float> posDist(-120.0f, 120.0f);
+	std::uniform_real_distribution<float> sizeDist(1.0f, 60.0f);
+	for (int query = 0; query < 50; ++query)
+	{
+		const BoundingBox queryBox(XMFLOAT3(posDist(rng), posDist(rng), posDist(rng)), XMFLOAT3(sizeDist(rng), sizeDist(rng), sizeDist(rng)));
+		std::vector<uint32_t> expected, result;
+		for (uint32_t i = 0; i < boxes.size(); ++i)
+		{
+			if (queryBox.Intersects(boxes[i]))
+				expected.push_back(i);
+		}
+		bvh.QueryAABB(queryBox, result);
+		ASSERT_EQ(Sorted(result), expected);
+
+		const BoundingSphere sphere(queryBox.Center, queryBox.Extents.x);
+		expected.clear();
+		result.clear();
+		for (uint32_t i = 0; i < boxes.size(); ++i)
+		{
+			if (sphere.Contains(boxes[i]) != DISJOINT)
+				expected.push_back(i);
+		}
+		bvh.QuerySphere(sphere, result);
+		ASSERT_EQ(Sorted(result), expected);
+
+		// 4ƽΧɵ
+		XMFLOAT4 planes[4];
+		for (auto& plane : planes)
+		{
+			const XMVECTOR normal = XMVector3Normalize(XMVectorSet(posDist(rng), posDist(rng), posDist(rng), 0.0f));
+			const XMVECTOR point = XMVectorSet(posDist(rng) * 0.3f, posDist(rng) * 0.3f, posDist(rng) * 0.3f, 0.0f);
+			XMStoreFloat4(&plane, XMPlaneFromPointNormal(point, normal));
+		}
+		expected.clear();
+		result.clear();
+		for (uint32_t i = 0; i < boxes.size(); ++i)
+		{
+			if (!BoxOutsidePlanes(boxes[i], planes, 4))
+				expected.push_back(i);
+		}
+		bvh.QueryPlanes(planes, 4, result);
+		ASSERT_EQ(Sorted(result), expected);
+	}
+}
+
+TEST(BVH, QueryFrustumMatchesPlanes)
+{
+	const auto boxes = RandomBoxes(2000, 21);
+	BVH bvh;
+	bvh.Build(boxes);
+	const BoundingFrustum frustum(XMFLOAT3(0.0f, 0.0f, -150.0f), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f), 0.5f, -0.5f, 0.4f, -0.4f, 1.0f, 400.0f);
+	XMVECTOR planesXM[6];
+	frustum.GetPlanes(&planesXM[0], &planesXM[1], &planesXM[2], &planesXM[3], &planesXM[4], &planesXM[5]);
+	XMFLOAT4 planes[6];
+	for (uint32_t i = 0; i < 6; ++i)
+	{
+		XMStoreFloat4(&planes[i], planesXM[i]);
+	}
+	std::vector<uint32_t> expected, result;
+	for (uint32_t i = 0; i < boxes.size(); ++i)
+	{
+		if (!BoxOutsidePlanes(boxes[i], planes, 6))
+			expected.push_back(i);
+	}
+	bvh.QueryFrustum(frustum, result);
+	EXPECT_FALSE(expected.empty());
+	EXPECT_EQ(Sorted(result), expected);
+}
+
+TEST(BVH, RefitKeepsQueriesExact)
+{
+	auto boxes = RandomBoxes(3000, 17);
+	BVH bvh;
+	bvh.Build(boxes);
+	// ƶһְΧУ˲
+	std::mt19937 rng(19);
+	std::uniform_real_distribution<float> moveDist(-30.0f, 30.0f);
+	for (size_t i = 0; i < boxes.size(); i += 7)
+	{
+		boxes[i].Center.x += moveDist(rng);
+		boxes[i].Center.y += moveDist(rng);
+	}
+	const size_t nodeCount = bvh.GetNodes().size();
+	bvh.Refit(boxes);
+	EXPECT_EQ(bvh.GetNodes().size(), nodeCount);
+	CheckStructure(bvh);
+	const BoundingBox queryBox(XMFLOAT3(10.0f, -20.0f, 5.0f), XMFLOAT3(40.0f, 40.0f, 40.0f));
+	std::vector<uint32_t> expected, result;
+	for (uint32_t i = 0; i < boxes.size(); ++i)
+	{
+		if (queryBox.Intersects(boxes[i]))
+			expected.push_back(i);
+	}
+	bvh.QueryAABB(queryBox, result);
+	EXPECT_EQ(Sorted(result), expected);
+}
+
+TEST(BVH, TriangleRaycastFindsClosestHit)
+{
+	// 󽻵Ƚ
+	std::mt19937 rng(23);
+	std::uniform_real_distribution<float> posDist(-50.0f, 50.0f);
+	std::uniform_real_distribution<float> offsetDist(-3.0f, 3.0f);
+	std::vector<XMFLOAT3> positions;
+	std::vector<uint32_t> indices;
+	for (uint32_t tri = 0; tri < 3000; ++tri)
+	{
+		const XMFLOAT3 base(posDist(rng), posDist(rng), posDist(rng));
+		for (int v = 0; v < 3; ++v)
+		{
+			indices.push_back(static_cast<uint32_t>(positions.size()));
+			positions.emplace_back(base.x + offsetDist(rng), base.y + offsetDist(rng), base.z + offsetDist(rng));
+		}
+	}
+	BVH bvh;
+	bvh.BuildTriangles(positions, indices);
+	EXPECT_EQ(bvh.GetPrimitiveCount(), 3000u);
+	uint32_t hits = 0;
+	for (int ray = 0; ray < 300; ++ray)
+	{
+		const XMVECTOR origin = XMVectorSet(posDist(rng), posDist(rng), -80.0f, 0.0f);
+		const XMVECTOR direction = XMVector3Normalize(XMVectorSet(offsetDist(rng) * 0.1f, offsetDist(rng) * 0.1f, 1.0f, 0.0f));
+		float closest = 1000.0f;
+		uint32_t closestTri = UINT_MAX;
+		for (uint32_t tri = 0; tri < 3000; ++tri)
+		{
+			float dist;
+			if (TriangleTests::Intersects(origin, direction, XMLoadFloat3(&positions[3 * tri]), XMLoadFloat3(&positions[3 * tri + 1]),
+				XMLoadFloat3(&positions[3 * tri + 2]), dist) && dist < closest)
+			{
+				closest = dist;
+				closestTri = tri;
+			}
+		}
+		RayHit hit;
+		const bool found = bvh.Raycast(origin, direction, 1000.0f, hit);
+		ASSERT_EQ(found, closestTri != UINT_MAX);
+		if (!found)
+			continue;
+		++hits;
+		ASSERT_NEAR(hit.distance, closest, 1e-3);
+	}
+	EXPECT_GT(hits, 0u);
+}
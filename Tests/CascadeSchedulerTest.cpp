@@ -0,0 +1,290 @@
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "TestFramework.h"
+#include "CascadeScheduler.h"
+
+using namespace Effect;
+using namespace DirectX;
+
+namespace
+{
+constexpr uint32_t cascadeCount = 5;
+constexpr uint32_t everyFrameCount = 2;
+constexpr float lightAngle = 0.0087266f;
+const XMFLOAT3 lightDir{ 0.3f, -1.0f, 0.2f };
+
+CascadeFit MakeFit(int32_t x, int32_t y, uint32_t resolution = 64, float nearZ = 100.0f, float farZ = -100.0f)
+{
+	CascadeFit fit;
+	fit.x = x;
+	fit.y = y;
+	fit.resolution = resolution;
+	fit.texelSize = 0.5f;
+	fit.nearZ = nearZ;
+	fit.farZ = farZ;
+	return fit;
+}
+
+// λڴ׶
+CascadeRect MakeSlice(const CascadeFit& fit)
+{
+	const int32_t res = static_cast<int32_t>(fit.resolution);
+	return { fit.x + 1, fit.y + 1, fit.x + res - 1, fit.y + res - 1 };
+}
+
+// ģGPUϵľ̬棬ÿtexel¼Ĺտռtexel
+class CacheModel
+{
+public:
+	explicit CacheModel(uint32_t res) : m_res(static_cast<int32_t>(res)), m_texels(res * res, { INT32_MIN, INT32_MIN }) {}
+
+	// GetCacheRectsӿüػ棬ػtexel
+	uint32_t Draw(const CascadeScheduler& scheduler, uint32_t idx)
+	{
+		CascadeCacheRect rects[CascadeScheduler::maxCacheRects];
+		const uint32_t count = scheduler.GetCacheRects(idx, rects);
+		const CascadeFit& fit = scheduler.GetCachedFit(idx);
+		uint32_t drawn = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const CascadeCacheRect& rect = rects[i];
+			EXPECT_TRUE(rect.left >= 0 && rect.top >= 0 && rect.right <= m_res && rect.bottom <= m_res);
+			for (int32_t py = rect.top; py < rect.bottom; ++py)
+			{
+				for (int32_t px = rect.left; px < rect.right; ++px)
+				{
+					const int32_t column = px - rect.viewportX;
+					const int32_t row = py - rect.viewportY;
+					EXPECT_TRUE(column >= 0 && column < m_res && row >= 0 && row < m_res);
+					m_texels[py * m_res + px] = { fit.x + column, fit.y + m_res - 1 - row };
+					++drawn;
+				}
+			}
+		}
+		return drawn;
+	}
+
+	// ϳɫѰַʽȡÿtexelӦõӦĹտռtexel
+	bool Matches(const CascadeScheduler& scheduler, uint32_t idx) const
+	{
+		const CascadeFit& fit = scheduler.GetCachedFit(idx);
+		const XMINT2 offset = scheduler.GetCacheOffset(idx);
+		for (int32_t row = 0; row < m_res; ++row)
+		{
+			for (int32_t column = 0; column < m_res; ++column)
+			{
+				const XMINT2& texel = m_texels[((row + offset.y) % m_res) * m_res + (column + offset.x) % m_res];
+				if (texel.x != fit.x + column || texel.y != fit.y + m_res - 1 - row)
+					return false;
+			}
+		}
+		return true;
+	}
+private:
+	int32_t				m_res;
+	std::vector<XMINT2>	m_texels;
+};
+
+struct FrameResult
+{
+	CascadeWork	work;
+	int32_t		x;
+	int32_t		y;
+	XMINT2		offset;
+	uint32_t	rectCount;
+};
+
+// ʱÿ֡ĵȽ
+std::vector<FrameResult> RandomWalk(uint32_t seed, uint32_t frames)
+{
+	CascadeScheduler scheduler(cascadeCount, everyFrameCount, lightAngle);
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int32_t> step(-20, 20);
+	int32_t x = 0;
+	int32_t y = 0;
+	std::vector<FrameResult> results;
+	for (uint32_t frame = 0; frame < frames; ++frame)
+	{
+		scheduler.BeginFrame(lightDir);
+		x += step(rng);
+		y += step(rng);
+		const CascadeFit fit = MakeFit(x, y);
+		if (!scheduler.ShouldUpdate(0, MakeSlice(fit)))
+			continue;
+		scheduler.Submit(0, fit);
+		CascadeCacheRect rects[CascadeScheduler::maxCacheRects];
+		results.push_back({ scheduler.GetWork(0), scheduler.GetCachedFit(0).x, scheduler.GetCachedFit(0).y,
+			scheduler.GetCacheOffset(0), scheduler.GetCacheRects(0, rects) });
+	}
+	return results;
+}
+}
+
+TEST(CascadeScheduler, FarCascadesRoundRobin)
+{
+	CascadeScheduler scheduler(cascadeCount, everyFrameCount, lightAngle);
+	const CascadeFit fit = MakeFit(0, 0);
+	scheduler.BeginFrame(lightDir);
+	for (uint32_t idx = 0; idx < cascadeCount; ++idx)
+	{
+		ASSERT_TRUE(scheduler.ShouldUpdate(idx, MakeSlice(fit)));
+		EXPECT_TRUE(scheduler.Submit(idx, fit) == CascadeWork::full);
+	}
+	for (uint32_t frame = 0; frame < 9; ++frame)
+	{
+		scheduler.BeginFrame(lightDir);
+		uint32_t farUpdates = 0;
+		for (uint32_t idx = 0; idx < cascadeCount; ++idx)
+		{
+			const bool update = scheduler.ShouldUpdate(idx, MakeSlice(fit));
+			if (idx < everyFrameCount)
+			{
+				EXPECT_TRUE(update);
+			}
+			else if (update)
+			{
+				EXPECT_EQ(idx - everyFrameCount, scheduler.GetFrameIndex() % (cascadeCount - everyFrameCount));
+				++farUpdates;
+			}
+			if (update)
+				EXPECT_TRUE(scheduler.Submit(idx, fit) == CascadeWork::dynamicOnly);
+			else
+				EXPECT_TRUE(scheduler.GetWork(idx) == CascadeWork::skip);
+		}
+		EXPECT_EQ(farUpdates, 1u);
+	}
+}
+
+TEST(CascadeScheduler, SkippedCascadeUpdatesWhenSliceLeavesWindow)
+{
+	CascadeScheduler scheduler(cascadeCount, everyFrameCount, lightAngle);
+	const CascadeFit fit = MakeFit(100, -50);
+	scheduler.BeginFrame(lightDir);
+	for (uint32_t idx = 0; idx < cascadeCount; ++idx)
+		scheduler.Submit(idx, fit);
+	scheduler.BeginFrame(lightDir);
+	const uint32_t scheduled = everyFrameCount + scheduler.GetFrameIndex() % (cascadeCount - everyFrameCount);
+	const uint32_t skipped = scheduled == cascadeCount - 1 ? everyFrameCount : scheduled + 1;
+	// ڴʱֲһԽڶҪ
+	EXPECT_FALSE(scheduler.ShouldUpdate(skipped, { 100, -50, 164, 14 }));
+	EXPECT_TRUE(scheduler.ShouldUpdate(skipped, { 99, -50, 164, 14 }));
+	EXPECT_TRUE(scheduler.ShouldUpdate(skipped, { 100, -51, 164, 14 }));
+	EXPECT_TRUE(scheduler.ShouldUpdate(skipped, { 100, -50, 165, 14 }));
+	EXPECT_TRUE(scheduler.ShouldUpdate(skipped, { 100, -50, 164, 15 }));
+
+	// ǿƸº󴰿ƽƣķΧ֮ƶ
+	EXPECT_TRUE(scheduler.Submit(skipped, MakeFit(110, -50)) == CascadeWork::scroll);
+	EXPECT_FALSE(scheduler.ShouldUpdate(skipped, { 110, -50, 174, 14 }));
+}
+
+TEST(CascadeScheduler, FullRedrawConditions)
+{
+	CascadeScheduler scheduler(1, 1, lightAngle);
+	auto submitNext = [&scheduler](const CascadeFit& fit, const XMFLOAT3& dir = lightDir)
+	{
+		scheduler.BeginFrame(dir);
+		return scheduler.Submit(0, fit);
+	};
+	EXPECT_TRUE(submitNext(MakeFit(0, 0)) == CascadeWork::full);
+	EXPECT_TRUE(submitNext(MakeFit(0, 0)) == CascadeWork::dynamicOnly);
+	// ȷΧԱʱûȷΧ
+	EXPECT_TRUE(submitNext(MakeFit(3, 0, 64, 50.0f, -20.0f)) == CascadeWork::scroll);
+	EXPECT_EQ(scheduler.GetCachedFit(0).nearZ, 100.0f);
+	EXPECT_EQ(scheduler.GetCachedFit(0).farZ, -100.0f);
+	EXPECT_TRUE(submitNext(MakeFit(3, 0, 64, 150.0f, -100.0f)) == CascadeWork::full);
+	// ƽƳһڡֱʻtexelСı
+	EXPECT_TRUE(submitNext(MakeFit(3 + 64, 0, 64, 150.0f)) == CascadeWork::full);
+	EXPECT_TRUE(submitNext(MakeFit(3 + 64, 0, 128, 150.0f)) == CascadeWork::full);
+	CascadeFit scaled = MakeFit(3 + 64, 0, 128, 150.0f);
+	scaled.texelSize = 0.25f;
+	EXPECT_TRUE(submitNext(scaled) == CascadeWork::full);
+	EXPECT_TRUE(submitNext(scaled) == CascadeWork::dynamicOnly);
+	// Դתֵʱûķ
+	const XMFLOAT3 cached = scheduler.BeginFrame(XMFLOAT3(lightDir.x + 0.001f, lightDir.y, lightDir.z));
+	EXPECT_TRUE(scheduler.Submit(0, scaled) == CascadeWork::dynamicOnly);
+	EXPECT_TRUE(submitNext(scaled, cached) == CascadeWork::dynamicOnly);
+	EXPECT_TRUE(submitNext(scaled, XMFLOAT3(lightDir.x + 0.5f, lightDir.y, lightDir.z)) == CascadeWork::full);
+	scheduler.Invalidate();
+	EXPECT_TRUE(submitNext(scaled) == CascadeWork::full);
+}
+
+TEST(CascadeScheduler, ScrollRedrawsOnlyExposedTexels)
+{
+	constexpr uint32_t res = 64;
+	CascadeScheduler scheduler(1, 1, lightAngle);
+	CacheModel cache(res);
+	std::mt19937 rng(99);
+	std::uniform_int_distribution<int32_t> step(-40, 40);
+	int32_t x = 17;
+	int32_t y = -5;
+	uint32_t scrolls = 0;
+	for (uint32_t frame = 0; frame < 2000; ++frame)
+	{
+		scheduler.BeginFrame(lightDir);
+		const int32_t dx = frame % 50 == 0 ? 0 : step(rng);
+		const int32_t dy = frame % 7 == 0 ? 0 : step(rng);
+		x += dx;
+		y += dy;
+		const CascadeWork work = scheduler.Submit(0, MakeFit(x, y, res));
+		const uint32_t drawn = cache.Draw(scheduler, 0);
+		ASSERT_TRUE(cache.Matches(scheduler, 0));
+		if (work == CascadeWork::scroll)
+		{
+			// ػtexelǡ´вɴصĲ
+			const uint32_t overlap = (res - std::abs(dx)) * (res - std::abs(dy));
+			EXPECT_EQ(drawn, res * res - overlap);
+			++scrolls;
+		}
+		else if (work == CascadeWork::dynamicOnly)
+		{
+			EXPECT_EQ(drawn, 0u);
+		}
+		else
+		{
+			EXPECT_EQ(drawn, res * res);
+		}
+	}
+	EXPECT_GT(scrolls, 1000u);
+}
+
+TEST(CascadeScheduler, StaticCacheIndependentOfCameraPath)
+{
+	// ƶʹ̬ʧЧصԭ󴰿ͶӰȫͬ
+	CascadeScheduler scheduler(1, 1, lightAngle);
+	scheduler.BeginFrame(lightDir);
+	EXPECT_TRUE(scheduler.Submit(0, MakeFit(0, 0)) == CascadeWork::full);
+	const int32_t path[][2] = { { 5, 0 }, { 5, 30 }, { -20, 30 }, { -20, -10 }, { 0, -10 }, { 0, 0 } };
+	for (const auto& point : path)
+	{
+		scheduler.BeginFrame(lightDir);
+		EXPECT_TRUE(scheduler.Submit(0, MakeFit(point[0], point[1])) == CascadeWork::scroll);
+	}
+	EXPECT_EQ(scheduler.GetCachedFit(0).x, 0);
+	EXPECT_EQ(scheduler.GetCachedFit(0).y, 0);
+	EXPECT_EQ(scheduler.GetCacheOffset(0).x, 0);
+	EXPECT_EQ(scheduler.GetCacheOffset(0).y, 0);
+}
+
+TEST(CascadeScheduler, SameInputsGiveSameSchedule)
+{
+	const auto first = RandomWalk(5, 3000);
+	const auto second = RandomWalk(5, 3000);
+	ASSERT_EQ(first.size(), second.size());
+	ASSERT_GT(first.size(), 0u);
+	for (size_t i = 0; i < first.size(); ++i)
+	{
+		ASSERT_TRUE(first[i].work == second[i].work);
+		EXPECT_EQ(first[i].x, second[i].x);
+		EXPECT_EQ(first[i].y, second[i].y);
+		EXPECT_EQ(first[i].offset.x, second[i].offset.x);
+		EXPECT_EQ(first[i].offset.y, second[i].offset.y);
+		EXPECT_EQ(first[i].rectCount, second[i].rectCount);
+		EXPECT_LE(first[i].rectCount, CascadeScheduler::maxCacheRects);
+	}
+	// ÿ֡£һ֮֡ÿֻ֡ƽƻ
+	EXPECT_EQ(first.size(), 3000u);
+	EXPECT_TRUE(first[0].work == CascadeWork::full);
+	for (size_t i = 1; i < first.size(); ++i)
+		EXPECT_FALSE(first[i].work == CascadeWork::full);
+}
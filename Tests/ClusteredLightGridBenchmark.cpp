@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "ClusteredLightGrid.h"
+
+using namespace Renderer;
+
+namespace
+{
+// 1080p60ֱӳԴֲ볡л˶ĵԴ
+std::vector<LightInCompute> RandomLights(uint32_t count)
+{
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> xy(-40.0f, 40.0f);
+	std::uniform_real_distribution<float> z(1.0f, 150.0f);
+	std::uniform_real_distribution<float> radius(1.0f, 8.0f);
+	std::vector<LightInCompute> lights(count);
+	for (auto& light : lights)
+	{
+		light.posV = DirectX::XMFLOAT3(xy(rng), xy(rng) * 0.25f, z(rng));
+		light.fallOffEnd = radius(rng);
+		light.fallOffStart = 0.5f * light.fallOffEnd;
+	}
+	return lights;
+}
+
+void SetView(ClusteredLightGrid& grid)
+{
+	const float projY = 1.0f / std::tan(0.5f * 1.0471976f);
+	grid.SetView(1920, 1080, projY * 1080.0f / 1920.0f, projY, 0.1f, 1000.0f);
+}
+
+void BM_Build(benchmark::State& state)
+{
+	const auto lights = RandomLights(static_cast<uint32_t>(state.range(0)));
+	ClusteredLightGrid grid;
+	SetView(grid);
+	for (auto _ : state)
+	{
+		grid.Build(lights.data(), static_cast<uint32_t>(lights.size()));
+		benchmark::DoNotOptimize(grid.GetLightIndices().data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Build)->Arg(256)->Arg(1024)->Arg(4096)->Arg(16384)->Unit(benchmark::kMicrosecond);
+
+// froxelԴı汾
+void BM_BuildReference(benchmark::State& state)
+{
+	const auto lights = RandomLights(static_cast<uint32_t>(state.range(0)));
+	ClusteredLightGrid grid;
+	SetView(grid);
+	for (auto _ : state)
+	{
+		grid.BuildReference(lights.data(), static_cast<uint32_t>(lights.size()));
+		benchmark::DoNotOptimize(grid.GetLightIndices().data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BuildReference)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "TestFramework.h"
+#include "ClusteredLightGrid.h"
+
+using namespace Renderer;
+
+namespace
+{
+// ͸ͶӰm00m11һ£60ֱӳ
+struct View
+{
+	uint32_t	width;
+	uint32_t	height;
+	float		projX;
+	float		projY;
+	float		nearZ;
+	float		farZ;
+};
+
+View MakeView(uint32_t width, uint32_t height, float nearZ = 0.1f, float farZ = 1000.0f)
+{
+	const float projY = 1.0f / std::tan(0.5f * 1.0471976f);
+	return { width, height, projY * static_cast<float>(height) / static_cast<float>(width), projY, nearZ, farZ };
+}
+
+// Դֲ׶⣬뾶Խ
+std::vector<LightInCompute> RandomLights(uint32_t count, uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> xy(-60.0f, 60.0f);
+	std::uniform_real_distribution<float> z(-5.0f, 200.0f);
+	std::uniform_real_distribution<float> logRadius(-2.0f, 4.0f);
+	std::vector<LightInCompute> lights(count);
+	for (auto& light : lights)
+	{
+		light.strength = DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f);
+		light.posV = DirectX::XMFLOAT3(xy(rng), xy(rng), z(rng));
+		light.fallOffEnd = std::exp2(logRadius(rng));
+		light.fallOffStart = 0.5f * light.fallOffEnd;
+	}
+	return lights;
+}
+
+void SetView(ClusteredLightGrid& grid, const View& view)
+{
+	grid.SetView(view.width, view.height, view.projX, view.projY, view.nearZ, view.farZ);
+}
+
+void ExpectSameResult(const ClusteredLightGrid& a, const ClusteredLightGrid& b)
+{
+	ASSERT_EQ(a.GetGrid().size(), b.GetGrid().size());
+	for (size_t i = 0; i < a.GetGrid().size(); ++i)
+	{
+		ASSERT_EQ(a.GetGrid()[i].offset, b.GetGrid()[i].offset);
+		ASSERT_EQ(a.GetGrid()[i].count, b.GetGrid()[i].count);
+	}
+	EXPECT_TRUE(a.GetLightIndices() == b.GetLightIndices());
+	EXPECT_EQ(a.GetOverflowCount(), b.GetOverflowCount());
+}
+}
+
+TEST(ClusteredLightGrid, BuildMatchesBruteForceReference)
+{
+	for (const View& view : { MakeView(1920, 1080), MakeView(1000, 700), MakeView(64, 64), MakeView(130, 257, 0.5f, 300.0f) })
+	{
+		for (uint32_t count : { 0u, 1u, 63u, 64u, 65u, 700u })
+		{
+			const auto lights = RandomLights(count, count + view.width);
+			ClusteredLightGrid fast, reference;
+			SetView(fast, view);
+			SetView(reference, view);
+			fast.Build(lights.data(), count);
+			reference.BuildReference(lights.data(), count);
+			ExpectSameResult(fast, reference);
+		}
+	}
+}
+
+TEST(ClusteredLightGrid, LayoutIsCompactAndSorted)
+{
+	const View view = MakeView(1280, 720);
+	const auto lights = RandomLights(500, 11);
+	ClusteredLightGrid grid;
+	SetView(grid, view);
+	grid.Build(lights.data(), static_cast<uint32_t>(lights.size()));
+	const auto constant = grid.GetConstant();
+	EXPECT_EQ(constant.tileCountX, 20u);
+	EXPECT_EQ(constant.tileCountY, 12u);
+	EXPECT_EQ(constant.sliceCount, ClusteredLightGrid::sliceCount);
+	ASSERT_EQ(grid.GetGrid().size(), size_t(grid.GetClusterCount()));
+	uint32_t next = 0;
+	for (const auto& range : grid.GetGrid())
+	{
+		EXPECT_EQ(range.offset, next);
+		next += range.count;
+		// ڹԴҲظ
+		for (uint32_t i = 1; i < range.count; ++i)
+		{
+			ASSERT_LT(grid.GetLightIndices()[range.offset + i - 1], grid.GetLightIndices()[range.offset + i]);
+		}
+	}
+	EXPECT_EQ(next, static_cast<uint32_t>(grid.GetLightIndices().size()));
+	EXPECT_EQ(grid.GetOverflowCount(), 0u);
+}
+
+TEST(ClusteredLightGrid, ContainsLightsCoveringFroxelCenters)
+{
+	// ʵ޹صļ飺ΧfroxelĵʱùԴڶӦĴ
+	const View view = MakeView(800, 600);
+	const auto lights = RandomLights(300, 5);
+	ClusteredLightGrid grid;
+	SetView(grid, view);
+	grid.Build(lights.data(), static_cast<uint32_t>(lights.size()));
+	const auto constant = grid.GetConstant();
+	const auto& indices = grid.GetLightIndices();
+	uint32_t checked = 0;
+	for (uint32_t k = 0; k < constant.sliceCount; ++k)
+	{
+		// slice = log(z) * sliceScale + sliceBiasƸòȷΧ
+		const float zn = std::exp((static_cast<float>(k) - constant.sliceBias) / constant.sliceScale);
+		const float zf = std::exp((static_cast<float>(k + 1) - constant.sliceBias) / constant.sliceScale);
+		const float z = 0.5f * (zn + zf);
+		for (uint32_t ty = 0; ty < constant.tileCountY; ++ty)
+		{
+			const float pixelY = std::min((static_cast<float>(ty) + 0.5f) * constant.tileSize, static_cast<float>(view.height) - 0.5f);
+			const float y = (1.0f - 2.0f * pixelY / static_cast<float>(view.height)) * z / view.projY;
+			for (uint32_t tx = 0; tx < constant.tileCountX; ++tx)
+			{
+				const float pixelX = std::min((static_cast<float>(tx) + 0.5f) * constant.tileSize, static_cast<float>(view.width) - 0.5f);
+				const float x = (2.0f * pixelX / static_cast<float>(view.width) - 1.0f) * z / view.projX;
+				const auto& range = grid.GetGrid()[(k * constant.tileCountY + ty) * constant.tileCountX + tx];
+				const auto begin = indices.begin() + range.offset;
+				const auto end = begin + range.count;
+				for (uint32_t i = 0; i < lights.size(); ++i)
+				{
+					const auto& light = lights[i];
+					const float dx = x - light.posV.x;
+					const float dy = y - light.posV.y;
+					const float dz = z - light.posV.z;
+					if (dx * dx + dy * dy + dz * dz >= light.fallOffEnd * light.fallOffEnd * 0.999f)
+						continue;
+					++checked;
+					ASSERT_TRUE(std::binary_search(begin, end, i));
+				}
+			}
+		}
+	}
+	EXPECT_GT(checked, 0u);
+}
+
+TEST(ClusteredLightGrid, ReverseZAndRepeatedViewsAreEquivalent)
+{
+	const View view = MakeView(1024, 768);
+	const auto lights = RandomLights(200, 9);
+	ClusteredLightGrid forward, reversed;
+	SetView(forward, view);
+	reversed.SetView(view.width, view.height, view.projX, view.projY, view.farZ, view.nearZ);
+	// ʱSetViewֱӷأظòӰ
+	SetView(forward, view);
+	forward.Build(lights.data(), static_cast<uint32_t>(lights.size()));
+	reversed.Build(lights.data(), static_cast<uint32_t>(lights.size()));
+	ExpectSameResult(forward, reversed);
+	EXPECT_EQ(forward.GetConstant().sliceScale, reversed.GetConstant().sliceScale);
+}
+
+TEST(ClusteredLightGrid, OverflowIsTruncatedAndCounted)
+{
+	// ȫfroxelĹԴÿյռclusterCount
+	const View view = MakeView(1920, 1080);
+	ClusteredLightGrid fast, reference;
+	SetView(fast, view);
+	SetView(reference, view);
+	const uint32_t clusterCount = fast.GetClusterCount();
+	const uint32_t count = ClusteredLightGrid::maxLightIndices / clusterCount + 5;
+	std::vector<LightInCompute> lights(count);
+	for (auto& light : lights)
+	{
+		light.posV = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+		light.fallOffEnd = 1.0e5f;
+	}
+	fast.Build(lights.data(), count);
+	reference.BuildReference(lights.data(), count);
+	EXPECT_EQ(fast.GetOverflowCount(), count * clusterCount - ClusteredLightGrid::maxLightIndices);
+	EXPECT_EQ(static_cast<uint32_t>(fast.GetLightIndices().size()), ClusteredLightGrid::maxLightIndices);
+	// ضϴӺĴؿʼһΪ
+	EXPECT_EQ(fast.GetGrid().front().count, count);
+	EXPECT_EQ(fast.GetGrid().back().count, 0u);
+	ExpectSameResult(fast, reference);
+}
@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "TestFramework.h"
+#include "DDSFile.h"
+#include "MappedFile.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+constexpr uint32_t MakeFourCC(char a, char b, char c, char d)
+{
+	return static_cast<uint32_t>(static_cast<uint8_t>(a)) | static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8 |
+		static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16 | static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24;
+}
+
+// DDS_HEADERֶ˳ļֽԱԴƫ
+struct DDSDesc
+{
+	uint32_t	width{ 4 };
+	uint32_t	height{ 4 };
+	uint32_t	mipCount{ 1 };
+	uint32_t	fourCC{ 0 };
+	bool		rgba{ false };
+	uint32_t	caps2{ 0 };
+	uint32_t	dxgiFormat{ 0 };		// Ϊ0ʱдDX10ļͷ
+	uint32_t	dimension{ 3 };
+	uint32_t	miscFlag{ 0 };
+	uint32_t	arraySize{ 1 };
+	size_t		dataSize{ 0 };
+};
+
+constexpr size_t headerSize = 4 + 124;
+constexpr size_t dx10HeaderSize = 20;
+
+std::vector<uint8_t> MakeDDS(const DDSDesc& desc)
+{
+	uint32_t header[31]{};
+	static_assert(4 + sizeof(header) == headerSize);
+	header[0] = 124;
+	header[1] = 0x1007 | (desc.mipCount > 1 ? 0x20000 : 0);
+	header[2] = desc.height;
+	header[3] = desc.width;
+	header[6] = desc.mipCount;
+	header[18] = 32;
+	if (desc.dxgiFormat != 0)
+	{
+		header[19] = 0x4;
+		header[20] = MakeFourCC('D', 'X', '1', '0');
+	}
+	else if (desc.fourCC != 0)
+	{
+		header[19] = 0x4;
+		header[20] = desc.fourCC;
+	}
+	else if (desc.rgba)
+	{
+		header[19] = 0x41;
+		header[21] = 32;
+		header[22] = 0x000000ff;
+		header[23] = 0x0000ff00;
+		header[24] = 0x00ff0000;
+		header[25] = 0xff000000;
+	}
+	header[26] = 0x1000;
+	header[27] = desc.caps2;
+
+	// һηôСο
+	const size_t dx10Size = desc.dxgiFormat != 0 ? dx10HeaderSize : 0;
+	std::vector<uint8_t> bytes(headerSize + dx10Size + desc.dataSize);
+	const uint32_t magic = MakeFourCC('D', 'D', 'S', ' ');
+	memcpy(bytes.data(), &magic, 4);
+	memcpy(bytes.data() + 4, header, sizeof(header));
+	if (dx10Size != 0)
+	{
+		const uint32_t dx10[5] = { desc.dxgiFormat, desc.dimension, desc.miscFlag, desc.arraySize, 0 };
+		static_assert(sizeof(dx10) == dx10HeaderSize);
+		memcpy(bytes.data() + headerSize, dx10, sizeof(dx10));
+	}
+	uint8_t* payload = bytes.data() + headerSize + dx10Size;
+	for (size_t i = 0; i < desc.dataSize; ++i)
+	{
+		payload[i] = static_cast<uint8_t>(i * 7);
+	}
+	return bytes;
+}
+
+size_t Offset(const std::vector<uint8_t>& bytes, const DDSSubresource& sub)
+{
+	return static_cast<size_t>(sub.data - bytes.data());
+}
+}
+
+TEST(DDSFile, SurfaceInfo)
+{
+	size_t rowPitch, slicePitch;
+	DDSFile::GetSurfaceInfo(DDSFormat::BC1_UNORM, 1, 1, rowPitch, slicePitch);
+	EXPECT_EQ(rowPitch, 8u);
+	EXPECT_EQ(slicePitch, 8u);
+	DDSFile::GetSurfaceInfo(DDSFormat::BC3_UNORM, 10, 6, rowPitch, slicePitch);
+	EXPECT_EQ(rowPitch, 3u * 16u);
+	EXPECT_EQ(slicePitch, 3u * 2u * 16u);
+	DDSFile::GetSurfaceInfo(DDSFormat::R16G16B16A16_FLOAT, 5, 3, rowPitch, slicePitch);
+	EXPECT_EQ(rowPitch, 40u);
+	EXPECT_EQ(slicePitch, 120u);
+	EXPECT_TRUE(DDSFile::IsBlockCompressed(DDSFormat::BC7_UNORM_SRGB));
+	EXPECT_FALSE(DDSFile::IsBlockCompressed(DDSFormat::R8G8B8A8_UNORM));
+	EXPECT_EQ(DDSFile::GetElementSize(DDSFormat::Unknown), 0u);
+}
+
+TEST(DDSFile, LegacyMipChainLayout)
+{
+	// 16x16DXT15mip128 + 32 + 8 + 8 + 8ֽ
+	const auto bytes = MakeDDS({ .width = 16, .height = 16, .mipCount = 5, .fourCC = MakeFourCC('D', 'X', 'T', '1'), .dataSize = 184 });
+	DDSFile dds;
+	ASSERT_TRUE(dds.Parse(bytes.data(), bytes.size()));
+	const auto& info = dds.GetInfo();
+	EXPECT_EQ(info.format, DDSFormat::BC1_UNORM);
+	EXPECT_EQ(info.width, 16u);
+	EXPECT_EQ(info.mipCount, 5u);
+	EXPECT_EQ(info.arraySize, 1u);
+	EXPECT_EQ(info.skippedMips, 0u);
+	EXPECT_FALSE(info.isCubeMap);
+	ASSERT_EQ(dds.GetSubresources().size(), 5u);
+	const size_t expected[5] = { 0, 128, 160, 168, 176 };
+	for (uint32_t mip = 0; mip < 5; ++mip)
+	{
+		const auto& sub = dds.GetSubresource(0, mip);
+		EXPECT_EQ(Offset(bytes, sub), headerSize + expected[mip]);
+		EXPECT_EQ(sub.width, std::max(16u >> mip, 1u));
+	}
+	// ݲʱܾ
+	DDSFile truncated;
+	EXPECT_FALSE(truncated.Parse(bytes.data(), bytes.size() - 1));
+	EXPECT_TRUE(truncated.GetSubresources().empty());
+}
+
+TEST(DDSFile, MaxMipsKeepsSmallestMips)
+{
+	// ѹʽ8x44mipֻС2
+	const auto bytes = MakeDDS({ .width = 8, .height = 4, .mipCount = 4, .rgba = true, .dataSize = 128 + 32 + 8 + 4 });
+	DDSFile dds;
+	ASSERT_TRUE(dds.Parse(bytes.data(), bytes.size(), 2));
+	EXPECT_EQ(dds.GetInfo().format, DDSFormat::R8G8B8A8_UNORM);
+	EXPECT_EQ(dds.GetInfo().mipCount, 2u);
+	EXPECT_EQ(dds.GetInfo().skippedMips, 2u);
+	EXPECT_EQ(dds.GetInfo().width, 2u);
+	EXPECT_EQ(dds.GetInfo().height, 1u);
+	ASSERT_EQ(dds.GetSubresources().size(), 2u);
+	EXPECT_EQ(Offset(bytes, dds.GetSubresource(0, 0)), headerSize + 160);
+	EXPECT_EQ(Offset(bytes, dds.GetSubresource(0, 1)), headerSize + 168);
+
+	// maxMipsСmipʱȫmip
+	ASSERT_TRUE(dds.Parse(bytes.data(), bytes.size(), 4));
+	EXPECT_EQ(dds.GetInfo().mipCount, 4u);
+	EXPECT_EQ(dds.GetInfo().skippedMips, 0u);
+	EXPECT_EQ(dds.GetInfo().width, 8u);
+}
+
+TEST(DDSFile, MaxMipsKeepsBlockAlignedTopMip)
+{
+	// BCʽĶmipΪ4ı16x16ֻ2ʱʵʱ4x42x21x1
+	const auto bytes = MakeDDS({ .width = 16, .height = 16, .mipCount = 5, .fourCC = MakeFourCC('D', 'X', 'T', '5'), .dataSize = 368 });
+	DDSFile dds;
+	ASSERT_TRUE(dds.Parse(bytes.data(), bytes.size(), 2));
+	EXPECT_EQ(dds.GetInfo().format, DDSFormat::BC3_UNORM);
+	EXPECT_EQ(dds.GetInfo().mipCount, 3u);
+	EXPECT_EQ(dds.GetInfo().skippedMips, 2u);
+	EXPECT_EQ(dds.GetInfo().width, 4u);
+	EXPECT_EQ(Offset(bytes, dds.GetSubresource(0, 0)), headerSize + 256 + 64);
+}
+
+TEST(DDSFile, CubeMapsAndArrays)
+{
+	// ʽͼ6棬ÿ4x4RGBA2mip
+	const size_t faceSize = 64 + 16;
+	const auto legacy = MakeDDS({ .width = 4, .height = 4, .mipCount = 2, .rgba = true, .caps2 = 0x200 | 0xFC00, .dataSize = faceSize * 6 });
+	DDSFile dds;
+	ASSERT_TRUE(dds.Parse(legacy.data(), legacy.size(), 1));
+	EXPECT_TRUE(dds.GetInfo().isCubeMap);
+	EXPECT_EQ(dds.GetInfo().arraySize, 6u);
+	EXPECT_EQ(dds.GetInfo().mipCount, 1u);
+	for (uint32_t face = 0; face < 6; ++face)
+	{
+		EXPECT_EQ(Offset(legacy, dds.GetSubresource(face, 0)), headerSize + face * faceSize + 64);
+	}
+	// ȱͼ֧
+	const auto partial = MakeDDS({ .width = 4, .height = 4, .rgba = true, .caps2 = 0x200 | 0x400, .dataSize = 64 * 6 });
+	EXPECT_FALSE(dds.Parse(partial.data(), partial.size()));
+
+	// DX10ļͷͼ飺arraySizeΪ
+	const auto dx10Cube = MakeDDS({ .width = 2, .height = 2, .dxgiFormat = 10, .miscFlag = 0x4, .arraySize = 2, .dataSize = 32 * 12 });
+	ASSERT_TRUE(dds.Parse(dx10Cube.data(), dx10Cube.size()));
+	EXPECT_EQ(dds.GetInfo().format, DDSFormat::R16G16B16A16_FLOAT);
+	EXPECT_EQ(dds.GetInfo().arraySize, 12u);
+	EXPECT_EQ(Offset(dx10Cube, dds.GetSubresource(11, 0)), headerSize + dx10HeaderSize + 11 * 32);
+	// ͼ
+	const auto notSquare = MakeDDS({ .width = 4, .height = 2, .dxgiFormat = 28, .miscFlag = 0x4, .dataSize = 32 * 6 });
+	EXPECT_FALSE(dds.Parse(notSquare.data(), notSquare.size()));
+}
+
+TEST(DDSFile, RejectsInvalidHeaders)
+{
+	DDSFile dds;
+	EXPECT_FALSE(dds.Parse(nullptr, 0));
+	auto bytes = MakeDDS({ .rgba = true, .dataSize = 64 });
+	ASSERT_TRUE(dds.Parse(bytes.data(), bytes.size()));
+	EXPECT_FALSE(dds.Parse(bytes.data(), headerSize - 1));
+
+	auto badMagic = bytes;
+	badMagic[0] = 'X';
+	EXPECT_FALSE(dds.Parse(badMagic.data(), badMagic.size()));
+	// mipmip
+	const auto tooManyMips = MakeDDS({ .width = 4, .height = 4, .mipCount = 4, .rgba = true, .dataSize = 1024 });
+	EXPECT_FALSE(dds.Parse(tooManyMips.data(), tooManyMips.size()));
+	// 1D벻ֵ֧ĸʽ
+	const auto volume = MakeDDS({ .rgba = true, .caps2 = 0x200000, .dataSize = 64 });
+	EXPECT_FALSE(dds.Parse(volume.data(), volume.size()));
+	const auto texture1D = MakeDDS({ .dxgiFormat = 28, .dimension = 2, .dataSize = 64 });
+	EXPECT_FALSE(dds.Parse(texture1D.data(), texture1D.size()));
+	const auto unsupported = MakeDDS({ .dxgiFormat = 1, .dataSize = 256 });
+	EXPECT_FALSE(dds.Parse(unsupported.data(), unsupported.size()));
+	const auto unknownFourCC = MakeDDS({ .fourCC = MakeFourCC('A', 'B', 'C', 'D'), .dataSize = 64 });
+	EXPECT_FALSE(dds.Parse(unknownFourCC.data(), unknownFourCC.size()));
+	const auto hugeArray = MakeDDS({ .dxgiFormat = 28, .arraySize = 4096, .dataSize = 64 });
+	EXPECT_FALSE(dds.Parse(hugeArray.data(), hugeArray.size()));
+}
+
+TEST(DDSFile, SaveRoundTripThroughMappedFile)
+{
+	const fs::path path = fs::temp_directory_path() / "DDSFileTest_RoundTrip.dds";
+	std::vector<float> pixels(3 * 2 * 4);
+	for (size_t i = 0; i < pixels.size(); ++i)
+	{
+		pixels[i] = static_cast<float>(i) * 0.5f;
+	}
+	ASSERT_TRUE(DDSFile::Save(path, DDSFormat::R32G32B32A32_FLOAT, 3, 2, pixels.data()));
+	EXPECT_FALSE(DDSFile::Save(path.string() + ".bc", DDSFormat::BC1_UNORM, 4, 4, pixels.data()));
+	{
+		MappedFile file;
+		ASSERT_TRUE(file.Open(path));
+		DDSFile dds;
+		ASSERT_TRUE(dds.Parse(file.GetData(), file.GetSize()));
+		EXPECT_EQ(dds.GetInfo().format, DDSFormat::R32G32B32A32_FLOAT);
+		EXPECT_EQ(dds.GetInfo().width, 3u);
+		EXPECT_EQ(dds.GetInfo().height, 2u);
+		EXPECT_EQ(dds.GetInfo().mipCount, 1u);
+		const auto& sub = dds.GetSubresource(0, 0);
+		EXPECT_EQ(sub.rowPitch, 48u);
+		EXPECT_EQ(memcmp(sub.data, pixels.data(), pixels.size() * sizeof(float)), 0);
+	}
+	fs::remove(path);
+}
@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <DirectXCollision.h>
+#include "TestFramework.h"
+#include "FrustumCuller.h"
+
+using namespace DirectX;
+
+namespace
+{
+constexpr float nearPlane = 0.5f;
+constexpr float farPlane = 300.0f;
+constexpr float fovY = XM_PIDIV4;
+constexpr float aspect = 16.0f / 9.0f;
+
+enum class Expected { visible, culled, ambiguous };
+
+// üռпɼ6ԼֵС0ʱλƽڲ
+float ClipDistance(const XMFLOAT4& clip, uint32_t plane)
+{
+	switch (plane)
+	{
+	case 0: return clip.w + clip.x;
+	case 1: return clip.w - clip.x;
+	case 2: return clip.w + clip.y;
+	case 3: return clip.w - clip.y;
+	case 4: return clip.z;
+	default: return clip.w - clip.z;
+	}
+}
+
+/*
+ * жѰΧе8Ǳ任üռ䣬ĳԼ8ǶʱΧȫλڸƽ
+ * 밴ƽԵ޳ȼۣƽİΧܸӰ죬Ƚ
+ */
+Expected BruteForce(const BoundingBox& box, FXMMATRIX viewProj)
+{
+	XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+	box.GetCorners(corners);
+	XMFLOAT4 clip[BoundingBox::CORNER_COUNT];
+	float scale = 0.0f;
+	for (size_t i = 0; i < BoundingBox::CORNER_COUNT; ++i)
+	{
+		XMStoreFloat4(&clip[i], XMVector4Transform(XMVectorSet(corners[i].x, corners[i].y, corners[i].z, 1.0f), viewProj));
+		scale = std::max({ scale, std::abs(clip[i].x), std::abs(clip[i].y), std::abs(clip[i].z), std::abs(clip[i].w) });
+	}
+	const float tolerance = 1e-4f * scale;
+	bool ambiguous = false;
+	for (uint32_t plane = 0; plane < FrustumCuller::planeCount; ++plane)
+	{
+		float farthest = -FLT_MAX;
+		for (const auto& corner : clip)
+		{
+			farthest = std::max(farthest, ClipDistance(corner, plane));
+		}
+		if (farthest < -tolerance)
+			return Expected::culled;
+		ambiguous = ambiguous || farthest <= tolerance;
+	}
+	return ambiguous ? Expected::ambiguous : Expected::visible;
+}
+
+std::vector<BoundingBox> RandomBoxes(std::mt19937& rng, uint32_t count, float range, float maxExtent)
+{
+	std::uniform_real_distribution<float> position(-range, range);
+	std::uniform_real_distribution<float> extent(0.0f, maxExtent);
+	std::vector<BoundingBox> boxes;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		// ְΧ˻ΪƬ
+		const float ex = i % 7 == 0 ? 0.0f : extent(rng);
+		const float ey = i % 11 == 0 ? 0.0f : extent(rng);
+		boxes.emplace_back(XMFLOAT3(position(rng), position(rng), position(rng)), XMFLOAT3(ex, ey, extent(rng)));
+	}
+	return boxes;
+}
+
+XMMATRIX RandomView(std::mt19937& rng, float range)
+{
+	std::uniform_real_distribution<float> position(-range, range);
+	std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+	std::uniform_real_distribution<float> pitch(-1.2f, 1.2f);
+	const float yaw = angle(rng);
+	const float elevation = pitch(rng);
+	const XMVECTOR dir = XMVectorSet(std::cos(elevation) * std::sin(yaw), std::sin(elevation), std::cos(elevation) * std::cos(yaw), 0.0f);
+	return XMMatrixLookToLH(XMVectorSet(position(rng), position(rng), position(rng), 1.0f), dir, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+}
+
+// CascadedShadowͬԴͼOrthographicOffCenterLHסһ
+XMMATRIX RandomCascade(std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> offset(-150.0f, 50.0f);
+	std::uniform_real_distribution<float> size(5.0f, 120.0f);
+	std::uniform_real_distribution<float> depth(1.0f, 400.0f);
+	const float left = offset(rng);
+	const float bottom = offset(rng);
+	const float width = size(rng);
+	const float nearZ = -depth(rng);
+	const float farZ = depth(rng);
+	return RandomView(rng, 100.0f) * XMMatrixOrthographicOffCenterLH(left, left + width, bottom, bottom + width, nearZ, farZ);
+}
+
+void AddItems(FrustumCuller& culler, const std::vector<BoundingBox>& boxes)
+{
+	culler.Reset();
+	for (uint32_t i = 0; i < boxes.size(); ++i)
+	{
+		culler.AddItem(boxes[i], i);
+	}
+}
+}
+
+TEST(FrustumCuller, MatchesBruteForceForReverseZAndCascades)
+{
+	std::mt19937 rng(4);
+	const XMMATRIX reverseZ = XMMatrixPerspectiveFovLH(fovY, aspect, farPlane, nearPlane);
+	const XMMATRIX forwardZ = XMMatrixPerspectiveFovLH(fovY, aspect, nearPlane, farPlane);
+	for (uint32_t round = 0; round < 20; ++round)
+	{
+		// 4ıǲͨ
+		const auto boxes = RandomBoxes(rng, 1001 + round, 200.0f, 15.0f);
+		std::vector<XMMATRIX> viewProjs;
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			viewProjs.push_back(RandomCascade(rng));
+		}
+		const XMMATRIX view = RandomView(rng, 50.0f);
+		viewProjs.push_back(view * reverseZ);
+		viewProjs.push_back(view * forwardZ);
+
+		// ǿɼڰΧ֮䣬ΧеpayloadΪ2iǿɼΪ2i + 1
+		FrustumCuller culler;
+		culler.Reset();
+		for (uint32_t i = 0; i < boxes.size(); ++i)
+		{
+			culler.AddItem(boxes[i], 2 * i);
+			if (i % 97 == 0)
+				culler.AddAlwaysVisible(2 * i + 1);
+		}
+		XMFLOAT4 planes[FrustumCuller::planeCount];
+		for (const auto& viewProj : viewProjs)
+		{
+			FrustumCuller::ExtractPlanes(viewProj, planes);
+			culler.AddPass(planes);
+		}
+		culler.Cull();
+
+		uint32_t ambiguous = 0;
+		for (uint32_t passIdx = 0; passIdx < viewProjs.size(); ++passIdx)
+		{
+			const auto& visible = culler.GetVisible(passIdx);
+			EXPECT_TRUE(std::is_sorted(visible.begin(), visible.end()));
+			std::vector<uint8_t> isVisible(2 * boxes.size() + 1, 0);
+			for (uint32_t payload : visible)
+			{
+				isVisible[payload] = 1;
+			}
+			const CullStats& stats = culler.GetStats(passIdx);
+			EXPECT_EQ(stats.visible, static_cast<uint32_t>(visible.size()));
+			EXPECT_EQ(stats.visible + stats.culled, culler.GetItemCount());
+			for (uint32_t i = 0; i < boxes.size(); ++i)
+			{
+				if (i % 97 == 0)
+					EXPECT_EQ(isVisible[2 * i + 1], 1);
+				const Expected expected = BruteForce(boxes[i], viewProjs[passIdx]);
+				if (expected == Expected::ambiguous)
+				{
+					++ambiguous;
+					continue;
+				}
+				if (isVisible[2 * i] != (expected == Expected::visible ? 1 : 0))
+					Test::Fail(__FILE__, __LINE__, "round " + std::to_string(round) + " pass " + std::to_string(passIdx) + " box " + std::to_string(i) + " differs from brute force");
+			}
+		}
+		EXPECT_LT(ambiguous, static_cast<uint32_t>(boxes.size() * viewProjs.size() / 100));
+	}
+}
+
+TEST(FrustumCuller, ReverseZPlanesMatchBoundingFrustum)
+{
+	// Camera::GetFrustumPlanesͬreverse-ZͶӰBoundingFrustum󽻻Զƽ
+	const XMMATRIX reverseZ = XMMatrixPerspectiveFovLH(fovY, aspect, farPlane, nearPlane);
+	BoundingFrustum frustum;
+	BoundingFrustum::CreateFromMatrix(frustum, reverseZ);
+	if (frustum.Near > frustum.Far)
+	{
+		std::swap(frustum.Near, frustum.Far);
+	}
+	XMVECTOR expected[FrustumCuller::planeCount];
+	frustum.GetPlanes(&expected[0], &expected[1], &expected[2], &expected[3], &expected[4], &expected[5]);
+	XMFLOAT4 planes[FrustumCuller::planeCount];
+	FrustumCuller::ExtractPlanes(reverseZ, planes);
+	// ߵƽ˳ͬҶӦƽ
+	for (const auto& plane : expected)
+	{
+		XMFLOAT4 target;
+		XMStoreFloat4(&target, plane);
+		const bool found = std::any_of(std::begin(planes), std::end(planes), [&target](const XMFLOAT4& p)
+		{
+			const float tolerance = 1e-4f * std::max(1.0f, std::abs(target.w));
+			return std::abs(p.x - target.x) < 1e-4f && std::abs(p.y - target.y) < 1e-4f && std::abs(p.z - target.z) < 1e-4f && std::abs(p.w - target.w) < tolerance;
+		});
+		EXPECT_TRUE(found);
+	}
+
+	// ƽǱصģ޳İΧһ׶岻ཻȫλ׶ڵİΧһɼ
+	std::mt19937 rng(8);
+	const auto boxes = RandomBoxes(rng, 20000, 250.0f, 20.0f);
+	FrustumCuller culler;
+	AddItems(culler, boxes);
+	culler.AddPass(planes);
+	culler.Cull();
+	std::vector<uint8_t> isVisible(boxes.size(), 0);
+	for (uint32_t payload : culler.GetVisible(0))
+	{
+		isVisible[payload] = 1;
+	}
+	uint32_t contained = 0;
+	uint32_t disjoint = 0;
+	uint32_t culled = 0;
+	for (uint32_t i = 0; i < boxes.size(); ++i)
+	{
+		if (BruteForce(boxes[i], reverseZ) == Expected::ambiguous)
+			continue;
+		const ContainmentType containment = frustum.Contains(boxes[i]);
+		if (containment == CONTAINS)
+		{
+			++contained;
+			EXPECT_EQ(isVisible[i], 1);
+		}
+		if (containment == DISJOINT)
+			++disjoint;
+		if (!isVisible[i])
+		{
+			++culled;
+			EXPECT_EQ(static_cast<int>(containment), static_cast<int>(DISJOINT));
+		}
+	}
+	// ΧиҴ󲿷ֲཻİΧб޳
+	EXPECT_GT(contained, 0u);
+	EXPECT_GT(culled, 0u);
+	EXPECT_GE(culled * 10, disjoint * 9);
+}
+
+TEST(FrustumCuller, ResetClearsItemsAndPasses)
+{
+	FrustumCuller culler;
+	XMFLOAT4 planes[FrustumCuller::planeCount];
+	FrustumCuller::ExtractPlanes(XMMatrixPerspectiveFovLH(fovY, aspect, farPlane, nearPlane), planes);
+	culler.Reset();
+	culler.AddItem(BoundingBox(XMFLOAT3(0.0f, 0.0f, 10.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)), 7);
+	culler.AddItem(BoundingBox(XMFLOAT3(0.0f, 0.0f, -10.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)), 3);
+	culler.AddAlwaysVisible(5);
+	EXPECT_EQ(culler.AddPass(planes), 0u);
+	culler.Cull();
+	ASSERT_EQ(culler.GetVisible(0).size(), 2u);
+	EXPECT_EQ(culler.GetVisible(0)[0], 7u);
+	EXPECT_EQ(culler.GetVisible(0)[1], 5u);
+	EXPECT_EQ(culler.GetStats(0).culled, 1u);
+
+	culler.Reset();
+	EXPECT_EQ(culler.GetItemCount(), 0u);
+	EXPECT_EQ(culler.GetPassCount(), 0u);
+	culler.AddItem(BoundingBox(XMFLOAT3(0.0f, 0.0f, -10.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)), 1);
+	culler.AddPass(planes);
+	culler.Cull();
+	EXPECT_TRUE(culler.GetVisible(0).empty());
+}
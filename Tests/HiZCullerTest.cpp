@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <DirectXCollision.h>
+#include "TestFramework.h"
+#include "HiZCuller.h"
+
+using namespace DirectX;
+
+namespace
+{
+constexpr uint32_t depthWidth = 96;
+constexpr uint32_t depthHeight = 54;
+constexpr float nearPlane = 0.5f;
+constexpr float farPlane = 500.0f;
+constexpr float fovY = XM_PIDIV2;
+constexpr float aspect = static_cast<float>(depthWidth) / depthHeight;
+
+// CameraͬķZͶӰͼֻzƽ
+XMMATRIX MakeViewProj(float cameraZ)
+{
+	return XMMatrixTranslation(0.0f, 0.0f, -cameraZ) * XMMatrixPerspectiveFovLH(fovY, aspect, farPlane, nearPlane);
+}
+
+float ViewZToNdc(float viewZ)
+{
+	XMFLOAT4X4 proj;
+	XMStoreFloat4x4(&proj, XMMatrixPerspectiveFovLH(fovY, aspect, farPlane, nearPlane));
+	return proj._33 + proj._43 / viewZ;
+}
+
+/*
+ * ĳz = 10һұ߽Ϊx = 2ǽy = -2ĵ棬Ϊ
+ * ÿ볡Ľ㣬õλcameraZʱ
+ */
+std::vector<float> RenderScene(float cameraZ, uint32_t width = depthWidth, uint32_t height = depthHeight)
+{
+	const float tanY = std::tan(fovY * 0.5f);
+	const float tanX = tanY * aspect;
+	std::vector<float> depth(static_cast<size_t>(width) * height, 0.0f);
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		const float ndcY = 1.0f - (static_cast<float>(y) + 0.5f) / height * 2.0f;
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			const float ndcX = (static_cast<float>(x) + 0.5f) / width * 2.0f - 1.0f;
+			float viewZ = FLT_MAX;
+			const float wallZ = 10.0f - cameraZ;
+			if (ndcX * tanX * wallZ < 2.0f)
+				viewZ = wallZ;
+			if (ndcY < 0.0f)
+				viewZ = std::min(viewZ, 2.0f / (-ndcY * tanY));
+			if (viewZ < farPlane)
+				depth[static_cast<size_t>(y) * width + x] = ViewZToNdc(viewZ);
+		}
+	}
+	return depth;
+}
+
+// HiZReadbackͬԸ߷ֱȾ󽵲ÿtexelΪ串ǷΧԶ
+std::vector<float> RenderDownsampled(float cameraZ)
+{
+	constexpr uint32_t scale = 8;
+	const std::vector<float> full = RenderScene(cameraZ, depthWidth * scale, depthHeight * scale);
+	std::vector<float> depth(static_cast<size_t>(depthWidth) * depthHeight);
+	HiZCuller::Downsample(full.data(), depthWidth * scale, depthHeight * scale, depthWidth * scale, depthWidth, depthHeight, depth.data());
+	return depth;
+}
+
+BoundingBox RandomBox(std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> depth(3.0f, 40.0f);
+	std::uniform_real_distribution<float> side(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> extent(0.1f, 1.5f);
+	const float z = depth(rng);
+	return BoundingBox(XMFLOAT3(side(rng) * z * 1.6f, side(rng) * z, z), XMFLOAT3(extent(rng), extent(rng), extent(rng)));
+}
+
+// HiZCuller::TestͬΧиǵtexelΧԼNDC
+bool ScreenRect(const BoundingBox& box, FXMMATRIX viewProj, int32_t rect[4], float& nearest)
+{
+	XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+	box.GetCorners(corners);
+	float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+	nearest = 0.0f;
+	for (const auto& corner : corners)
+	{
+		XMFLOAT4 clip;
+		XMStoreFloat4(&clip, XMVector3Transform(XMLoadFloat3(&corner), viewProj));
+		const float invW = 1.0f / clip.w;
+		minX = std::min(minX, (clip.x * invW * 0.5f + 0.5f) * depthWidth);
+		maxX = std::max(maxX, (clip.x * invW * 0.5f + 0.5f) * depthWidth);
+		minY = std::min(minY, (0.5f - clip.y * invW * 0.5f) * depthHeight);
+		maxY = std::max(maxY, (0.5f - clip.y * invW * 0.5f) * depthHeight);
+		nearest = std::max(nearest, clip.z * invW);
+	}
+	rect[0] = std::max(static_cast<int32_t>(std::floor(std::clamp(minX, -1.0f, static_cast<float>(depthWidth)))), 0);
+	rect[1] = std::max(static_cast<int32_t>(std::floor(std::clamp(minY, -1.0f, static_cast<float>(depthHeight)))), 0);
+	rect[2] = std::min(static_cast<int32_t>(std::floor(std::clamp(maxX, -1.0f, static_cast<float>(depthWidth)))), static_cast<int32_t>(depthWidth) - 1);
+	rect[3] = std::min(static_cast<int32_t>(std::floor(std::clamp(maxY, -1.0f, static_cast<float>(depthHeight)))), static_cast<int32_t>(depthHeight) - 1);
+	return rect[0] <= rect[2] && rect[1] <= rect[3];
+}
+}
+
+TEST(HiZCuller, DownsampleKeepsFarthestOfCoveredPixels)
+{
+	// Դߴ粻ܱߴоڿ
+	constexpr uint32_t width = 101;
+	constexpr uint32_t height = 67;
+	constexpr uint32_t rowPitch = 128;
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> value(0.0f, 1.0f);
+	std::vector<float> source(static_cast<size_t>(rowPitch) * height, -5.0f);
+	for (uint32_t y = 0; y < height; ++y)
+		for (uint32_t x = 0; x < width; ++x)
+			source[static_cast<size_t>(y) * rowPitch + x] = value(rng);
+	constexpr uint32_t outWidth = 24;
+	constexpr uint32_t outHeight = 16;
+	std::vector<float> out(outWidth * outHeight);
+	HiZCuller::Downsample(source.data(), width, height, rowPitch, outWidth, outHeight, out.data());
+	// ÿԴضĳtexelǣҸtexelÿtexelĸĳصֵ
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			const uint32_t ox = std::min(x * outWidth / width, outWidth - 1);
+			const uint32_t oy = std::min(y * outHeight / height, outHeight - 1);
+			ASSERT_LE(out[oy * outWidth + ox], source[static_cast<size_t>(y) * rowPitch + x]);
+		}
+	}
+	for (uint32_t oy = 0; oy < outHeight; ++oy)
+	{
+		for (uint32_t ox = 0; ox < outWidth; ++ox)
+		{
+			const float texel = out[oy * outWidth + ox];
+			EXPECT_GE(texel, 0.0f);
+			// ǸǷΧڵĳأоֵ֮ᱻ
+			bool found = false;
+			for (uint32_t y = oy * height / outHeight; y < std::min(((oy + 1) * height + outHeight - 1) / outHeight, height); ++y)
+				for (uint32_t x = ox * width / outWidth; x < std::min(((ox + 1) * width + outWidth - 1) / outWidth, width); ++x)
+					found = found || source[static_cast<size_t>(y) * rowPitch + x] == texel;
+			EXPECT_TRUE(found);
+		}
+	}
+}
+
+TEST(HiZCuller, BuildLevelsAreConservative)
+{
+	const std::vector<float> depth = RenderScene(0.0f);
+	HiZCuller culler;
+	EXPECT_FALSE(culler.IsValid());
+	culler.Build(depth.data(), depthWidth, depthHeight);
+	ASSERT_TRUE(culler.IsValid());
+	// 96x54 -> 48x27 -> 24x14 -> 12x7 -> 6x4 -> 3x2 -> 2x1 -> 1x1
+	ASSERT_EQ(culler.GetLevelCount(), 8u);
+	EXPECT_EQ(culler.GetWidth(2), 24u);
+	EXPECT_EQ(culler.GetHeight(2), 14u);
+	EXPECT_EQ(culler.GetHeight(7), 1u);
+	for (uint32_t level = 0; level < culler.GetLevelCount(); ++level)
+	{
+		// ÿһtexel串ǵκε0texelҵԶ
+		for (uint32_t y = 0; y < culler.GetHeight(level); ++y)
+		{
+			for (uint32_t x = 0; x < culler.GetWidth(level); ++x)
+			{
+				float farthest = 1.0f;
+				for (uint32_t sy = y << level; sy < std::min((y + 1) << level, depthHeight); ++sy)
+					for (uint32_t sx = x << level; sx < std::min((x + 1) << level, depthWidth); ++sx)
+						farthest = std::min(farthest, depth[static_cast<size_t>(sy) * depthWidth + sx]);
+				ASSERT_EQ(culler.GetDepth(level, x, y), farthest);
+			}
+		}
+	}
+}
+
+TEST(HiZCuller, CulledBoxesAreHiddenPerTexel)
+{
+	const std::vector<float> depth = RenderScene(0.0f);
+	const XMMATRIX viewProj = MakeViewProj(0.0f);
+	HiZCuller culler;
+	// Build֮ǰǿɼ
+	EXPECT_TRUE(culler.IsVisible(BoundingBox(XMFLOAT3(0.0f, 0.0f, 30.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)), viewProj));
+	culler.Build(depth.data(), depthWidth, depthHeight);
+	culler.ResetStats();
+	std::mt19937 rng(17);
+	HiZErrorStats errors;
+	for (uint32_t i = 0; i < 2000; ++i)
+	{
+		const BoundingBox box = RandomBox(rng);
+		const bool visible = culler.IsVisible(box, viewProj);
+		culler.Evaluate(box, !visible, viewProj, errors);
+		if (visible)
+			continue;
+		// ޳İΧиǵÿtexel
+		int32_t rect[4];
+		float nearest;
+		if (!ScreenRect(box, viewProj, rect, nearest))
+			continue;
+		for (int32_t y = rect[1]; y <= rect[3]; ++y)
+			for (int32_t x = rect[0]; x <= rect[2]; ++x)
+				ASSERT_LT(nearest, depth[static_cast<size_t>(y) * depthWidth + x]);
+	}
+	EXPECT_EQ(culler.GetStats().tested, 2000u);
+	// ǽ൱һְΧб޳Ϊʵʱжû
+	EXPECT_GT(culler.GetStats().occluded, 200u);
+	EXPECT_EQ(errors.tested, 2000u);
+	EXPECT_EQ(errors.falsePositive, 0u);
+	EXPECT_EQ(errors.falseNegative, 0u);
+	// ǽǰ봩ƽİΧпɼ
+	EXPECT_TRUE(culler.IsVisible(BoundingBox(XMFLOAT3(0.0f, 0.0f, 5.0f), XMFLOAT3(0.5f, 0.5f, 0.5f)), viewProj));
+	EXPECT_TRUE(culler.IsVisible(BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)), viewProj));
+	EXPECT_FALSE(culler.IsVisible(BoundingBox(XMFLOAT3(-3.0f, 0.0f, 20.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)), viewProj));
+}
+
+TEST(HiZCuller, ReprojectMatchesRenderedDepth)
+{
+	const std::vector<float> prev = RenderDownsampled(0.0f);
+	std::vector<float> out(prev.size());
+	// ʱÿtexelֻǽԵھӶѷ
+	HiZCuller::Reproject(prev.data(), depthWidth, depthHeight, MakeViewProj(0.0f), MakeViewProj(0.0f), out.data());
+	uint32_t filledSky = 0;
+	for (size_t i = 0; i < prev.size(); ++i)
+	{
+		if (prev[i] > 0.0f)
+			ASSERT_NEAR(out[i], prev[i], 1e-5f);
+		else
+			filledSky += out[i] > 0.0f;
+	}
+	EXPECT_LE(filledSky, 2u);
+
+	/*
+	 * ǰƺֱȾȱȽ
+	 * texelͶӰһtexelڣ3x3ʵȸ
+	 * Ļײ±¶ĵû˻Ϊ
+	 */
+	const std::vector<float> truth = RenderDownsampled(1.5f);
+	HiZCuller::Reproject(prev.data(), depthWidth, depthHeight, MakeViewProj(0.0f), MakeViewProj(1.5f), out.data());
+	uint32_t holes = 0;
+	uint32_t covered = 0;
+	for (uint32_t y = 0; y < depthHeight; ++y)
+	{
+		for (uint32_t x = 0; x < depthWidth; ++x)
+		{
+			float nearest = 0.0f;
+			for (uint32_t ny = y > 0 ? y - 1 : 0; ny <= std::min(y + 1, depthHeight - 1); ++ny)
+				for (uint32_t nx = x > 0 ? x - 1 : 0; nx <= std::min(x + 1, depthWidth - 1); ++nx)
+					nearest = std::max(nearest, truth[static_cast<size_t>(ny) * depthWidth + nx]);
+			const size_t i = static_cast<size_t>(y) * depthWidth + x;
+			ASSERT_LE(out[i], nearest + 1e-5f);
+			if (truth[i] > 0.0f)
+			{
+				++covered;
+				holes += out[i] <= 0.0f;
+			}
+		}
+	}
+	EXPECT_LT(holes, covered / 5);
+}
+
+TEST(HiZCuller, ReprojectKeepsFarthestSampleAndFillsCracks)
+{
+	// ͶӰΪλNDCֻxyţȲ䣬ÿеȴұ
+	constexpr uint32_t width = 8;
+	constexpr uint32_t height = 4;
+	std::vector<float> prev(width * height);
+	for (uint32_t y = 0; y < height; ++y)
+		for (uint32_t x = 0; x < width; ++x)
+			prev[y * width + x] = 0.1f * static_cast<float>(x + 1);
+	std::vector<float> out(prev.size());
+
+	// Сһ룺ڵͬһtexelԶߣȦûtexelΪ
+	HiZCuller::Reproject(prev.data(), width, height, XMMatrixIdentity(), XMMatrixScaling(0.5f, 0.5f, 1.0f), out.data());
+	const float shrunk[width] = { 0.0f, 0.0f, 0.1f, 0.3f, 0.5f, 0.7f, 0.0f, 0.0f };
+	for (uint32_t x = 0; x < width; ++x)
+	{
+		EXPECT_EQ(out[x], 0.0f);
+		EXPECT_NEAR(out[width + x], shrunk[x], 1e-6f);
+		EXPECT_NEAR(out[2 * width + x], shrunk[x], 1e-6f);
+		EXPECT_EQ(out[3 * width + x], 0.0f);
+	}
+
+	// ˮƽŴһ֮һtexelѷ죬ڲѷھԶ䣬߽ϵѷΪ
+	HiZCuller::Reproject(prev.data(), width, height, XMMatrixIdentity(), XMMatrixScaling(2.0f, 1.0f, 1.0f), out.data());
+	const float borderRow[width] = { 0.0f, 0.3f, 0.0f, 0.4f, 0.0f, 0.5f, 0.0f, 0.6f };
+	const float innerRow[width] = { 0.0f, 0.3f, 0.3f, 0.4f, 0.4f, 0.5f, 0.5f, 0.6f };
+	for (uint32_t x = 0; x < width; ++x)
+	{
+		EXPECT_NEAR(out[x], borderRow[x], 1e-6f);
+		EXPECT_NEAR(out[width + x], innerRow[x], 1e-6f);
+		EXPECT_NEAR(out[2 * width + x], innerRow[x], 1e-6f);
+		EXPECT_NEAR(out[3 * width + x], borderRow[x], 1e-6f);
+	}
+}
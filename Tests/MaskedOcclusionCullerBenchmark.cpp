@@ -0,0 +1,179 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include <DirectXCollision.h>
+#include "MaskedOcclusionCuller.h"
+
+using namespace DirectX;
+
+namespace
+{
+// BoxAppͬĻСƽ
+constexpr uint32_t bufferWidth = 512;
+constexpr uint32_t bufferHeight = 256;
+constexpr float nearPlane = 0.5f;
+// ·Ĺؼ֡ڹؼֵ֮֡֡
+constexpr uint32_t keyCount = 8;
+constexpr uint32_t framesPerKey = 30;
+
+/*
+ * SponzaĺϳɳxĳȣΪŶǽУǽм
+ * ǽһŷ䣬ɢڳ뷿ĵϣ󲿷ֱǽڵ
+ */
+class SyntheticScene
+{
+public:
+	SyntheticScene()
+	{
+		// 
+		AddBox(XMFLOAT3(0.0f, -0.5f, 0.0f), XMFLOAT3(80.0f, 0.5f, 45.0f));
+		// ǽÿ20һ4׿Ŷ
+		for (float side : { -1.0f, 1.0f })
+		{
+			for (float x = -60.0f; x < 60.0f; x += 20.0f)
+			{
+				AddBox(XMFLOAT3(x + 8.0f, 7.5f, side * 20.0f), XMFLOAT3(8.0f, 7.5f, 0.5f));
+			}
+			// 
+			for (float x = -55.0f; x <= 55.0f; x += 10.0f)
+			{
+				AddBox(XMFLOAT3(x, 6.0f, side * 9.0f), XMFLOAT3(0.8f, 6.0f, 0.8f));
+			}
+			// ֮ĸǽ
+			for (float x = -60.0f; x <= 60.0f; x += 20.0f)
+			{
+				AddBox(XMFLOAT3(x, 5.0f, side * 32.0f), XMFLOAT3(0.5f, 5.0f, 12.0f));
+			}
+		}
+		// ǽм6׿
+		for (float x : { -30.0f, 0.0f, 30.0f })
+		{
+			AddBox(XMFLOAT3(x, 7.5f, -11.5f), XMFLOAT3(0.5f, 7.5f, 8.5f));
+			AddBox(XMFLOAT3(x, 7.5f, 11.5f), XMFLOAT3(0.5f, 7.5f, 8.5f));
+		}
+
+		std::mt19937 rng(8);
+		std::uniform_real_distribution<float> x(-75.0f, 75.0f);
+		std::uniform_real_distribution<float> z(-42.0f, 42.0f);
+		std::uniform_real_distribution<float> extent(0.2f, 1.5f);
+		for (uint32_t i = 0; i < 4096; ++i)
+		{
+			const float e = extent(rng);
+			objects.emplace_back(XMFLOAT3(x(rng), e, z(rng)), XMFLOAT3(e, e, e));
+		}
+	}
+
+	OccluderMesh				occluders;
+	std::vector<BoundingBox>	objects;
+private:
+	void AddBox(const XMFLOAT3& center, const XMFLOAT3& extents)
+	{
+		static const XMFLOAT3 corners[8] = {
+			{ -1.0f, -1.0f, -1.0f }, { 1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, -1.0f }, { -1.0f, 1.0f, -1.0f },
+			{ -1.0f, -1.0f, 1.0f }, { 1.0f, -1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f }, { -1.0f, 1.0f, 1.0f } };
+		static const uint32_t indices[36] = {
+			0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4,
+			3, 6, 2, 3, 7, 6, 0, 4, 7, 0, 7, 3, 1, 2, 6, 1, 6, 5 };
+		const XMMATRIX world = XMMatrixScaling(extents.x, extents.y, extents.z) * XMMatrixTranslation(center.x, center.y, center.z);
+		occluders.Append(corners, sizeof(XMFLOAT3), indices, 36, world, 0.0f);
+	}
+};
+
+// ȷԵ·ȡŶص㣬ؼ֮֡Բֵ
+std::vector<XMMATRIX> MakeCameraPath()
+{
+	struct Key
+	{
+		XMFLOAT3	eye;
+		XMFLOAT3	target;
+	};
+	const Key keys[keyCount] = {
+		{ { -70.0f, 2.0f, 0.0f }, { 0.0f, 2.0f, 0.0f } },
+		{ { -45.0f, 2.0f, 3.0f }, { -20.0f, 3.0f, -10.0f } },
+		{ { -32.0f, 2.0f, 0.0f }, { -30.0f, 2.0f, 40.0f } },
+		{ { -15.0f, 2.0f, -5.0f }, { 40.0f, 6.0f, 5.0f } },
+		{ { 10.0f, 8.0f, 0.0f }, { 10.0f, 0.0f, -30.0f } },
+		{ { 20.0f, 2.0f, -15.0f }, { 20.0f, 2.0f, -40.0f } },
+		{ { 45.0f, 2.0f, 5.0f }, { -60.0f, 2.0f, 0.0f } },
+		{ { 60.0f, 12.0f, 15.0f }, { -20.0f, 0.0f, -15.0f } } };
+
+	const XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, static_cast<float>(bufferWidth) / bufferHeight, 1000.0f, nearPlane);
+	const XMVECTOR up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+	std::vector<XMMATRIX> path;
+	path.reserve(keyCount * framesPerKey);
+	for (uint32_t key = 0; key < keyCount; ++key)
+	{
+		const Key& from = keys[key];
+		const Key& to = keys[(key + 1) % keyCount];
+		for (uint32_t frame = 0; frame < framesPerKey; ++frame)
+		{
+			const float t = static_cast<float>(frame) / framesPerKey;
+			const XMVECTOR eye = XMVectorLerp(XMLoadFloat3(&from.eye), XMLoadFloat3(&to.eye), t);
+			const XMVECTOR target = XMVectorLerp(XMLoadFloat3(&from.target), XMLoadFloat3(&to.target), t);
+			path.push_back(XMMatrixLookAtLH(eye, target, up) * proj);
+		}
+	}
+	return path;
+}
+
+const SyntheticScene& GetScene()
+{
+	static const SyntheticScene scene;
+	return scene;
+}
+
+const std::vector<XMMATRIX>& GetCameraPath()
+{
+	static const std::vector<XMMATRIX> path = MakeCameraPath();
+	return path;
+}
+
+// һ֡޳ադڵ塢壬رڵ
+uint32_t CullFrame(MaskedOcclusionCuller& culler, const SyntheticScene& scene, FXMMATRIX viewProj)
+{
+	culler.Clear(nearPlane);
+	culler.RenderOccluder(scene.occluders, viewProj);
+	uint32_t occluded = 0;
+	for (const BoundingBox& box : scene.objects)
+	{
+		occluded += culler.IsVisible(box, viewProj) ? 0 : 1;
+	}
+	return occluded;
+}
+
+// ÿεΪ·ϵһ֡˳ѭΪ0ʱǿʹñʵ
+void BM_CameraPath(benchmark::State& state)
+{
+	const SyntheticScene& scene = GetScene();
+	const auto& path = GetCameraPath();
+	MaskedOcclusionCuller culler(bufferWidth, bufferHeight, state.range(0) != 0);
+	size_t frame = 0;
+	uint64_t occluded = 0;
+	for (auto _ : state)
+	{
+		occluded += CullFrame(culler, scene, path[frame]);
+		frame = (frame + 1) % path.size();
+	}
+	state.SetItemsProcessed(state.iterations());
+	state.counters["occluded"] = static_cast<double>(occluded) / (static_cast<double>(state.iterations()) * scene.objects.size());
+	state.SetLabel(culler.UsesSimd() ? "avx2" : "scalar");
+}
+BENCHMARK(BM_CameraPath)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// ؼ֡ʱλ·Ͽӽ
+void BM_CameraKeyframe(benchmark::State& state)
+{
+	const SyntheticScene& scene = GetScene();
+	const XMMATRIX viewProj = GetCameraPath()[static_cast<size_t>(state.range(0)) * framesPerKey];
+	MaskedOcclusionCuller culler(bufferWidth, bufferHeight);
+	uint32_t occluded = 0;
+	for (auto _ : state)
+	{
+		occluded = CullFrame(culler, scene, viewProj);
+		benchmark::DoNotOptimize(occluded);
+	}
+	state.counters["triangles"] = culler.GetStats().occluderTriangles;
+	state.counters["occluded"] = static_cast<double>(occluded) / scene.objects.size();
+}
+BENCHMARK(BM_CameraKeyframe)->DenseRange(0, keyCount - 1)->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <DirectXCollision.h>
+#include "TestFramework.h"
+#include "MaskedOcclusionCuller.h"
+
+using namespace DirectX;
+
+namespace
+{
+constexpr uint32_t bufferWidth = 128;
+constexpr uint32_t bufferHeight = 64;
+constexpr float nearPlane = 0.5f;
+
+// ͼΪλռ伴۲ռ䣬Cameraͬʹ÷Z
+XMMATRIX MakeViewProj()
+{
+	return XMMatrixPerspectiveFovLH(XM_PIDIV2, static_cast<float>(bufferWidth) / bufferHeight, 1000.0f, nearPlane);
+}
+
+// ۲ռеΣȫλڽƽ֮󣬲ֳĻ
+OccluderMesh MakeOccluders(uint32_t seed, uint32_t triangleCount)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> depth(2.0f, 60.0f);
+	std::uniform_real_distribution<float> side(-1.3f, 1.3f);
+	std::uniform_real_distribution<float> spread(0.05f, 0.6f);
+	OccluderMesh mesh;
+	for (uint32_t tri = 0; tri < triangleCount; ++tri)
+	{
+		const float z = depth(rng);
+		const float cx = side(rng) * z * 2.0f;
+		const float cy = side(rng) * z;
+		const float size = spread(rng) * z;
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			const float vz = std::max(z + side(rng) * size, nearPlane * 2.0f);
+			mesh.vertices.emplace_back(cx + side(rng) * size, cy + side(rng) * size, vz);
+		}
+	}
+	// ϽĴǽ棬֤㹻İΧбڵ
+	const XMFLOAT3 walls[] = { { -12.0f, -8.0f, 8.0f }, { 0.0f, -8.0f, 9.0f }, { -12.0f, 8.0f, 8.0f },
+		{ 0.0f, -8.0f, 9.0f }, { 0.0f, 8.0f, 9.0f }, { -12.0f, 8.0f, 8.0f },
+		{ 0.0f, -8.0f, 12.0f }, { 14.0f, -8.0f, 12.0f }, { 0.0f, 8.0f, 12.0f },
+		{ 14.0f, -8.0f, 12.0f }, { 14.0f, 8.0f, 12.0f }, { 0.0f, 8.0f, 12.0f } };
+	mesh.vertices.insert(mesh.vertices.end(), std::begin(walls), std::end(walls));
+	return mesh;
+}
+
+XMFLOAT3 ToScreen(const XMFLOAT3& position, FXMMATRIX viewProj)
+{
+	XMFLOAT4 clip;
+	XMStoreFloat4(&clip, XMVector3Transform(XMLoadFloat3(&position), viewProj));
+	const float invW = 1.0f / clip.w;
+	return { (clip.x * invW * 0.5f + 0.5f) * bufferWidth, (0.5f - clip.y * invW * 0.5f) * bufferHeight, invW };
+}
+
+// صĲοդ(߽總ſ)ʱȡô1/wÿرֵ
+std::vector<float> RasterizeReference(const OccluderMesh& mesh, FXMMATRIX viewProj)
+{
+	std::vector<float> depth(static_cast<size_t>(bufferWidth) * bufferHeight, 0.0f);
+	for (uint32_t tri = 0; tri < mesh.GetTriangleCount(); ++tri)
+	{
+		XMFLOAT3 v[3];
+		for (uint32_t i = 0; i < 3; ++i)
+			v[i] = ToScreen(mesh.vertices[3 * tri + i], viewProj);
+		const double area = (static_cast<double>(v[1].x) - v[0].x) * (static_cast<double>(v[2].y) - v[0].y) - (static_cast<double>(v[2].x) - v[0].x) * (static_cast<double>(v[1].y) - v[0].y);
+		if (std::abs(area) < 1e-6)
+			continue;
+		for (uint32_t y = 0; y < bufferHeight; ++y)
+		{
+			for (uint32_t x = 0; x < bufferWidth; ++x)
+			{
+				const double px = x + 0.5;
+				const double py = y + 0.5;
+				double weights[3];
+				bool inside = true;
+				for (uint32_t e = 0; e < 3; ++e)
+				{
+					const XMFLOAT3& a = v[(e + 1) % 3];
+					const XMFLOAT3& b = v[(e + 2) % 3];
+					weights[e] = ((b.x - a.x) * (py - a.y) - (px - a.x) * (b.y - a.y)) / area;
+					inside = inside && weights[e] >= -1e-4;
+				}
+				if (!inside)
+					continue;
+				const double invW = weights[0] * v[0].z + weights[1] * v[1].z + weights[2] * v[2].z;
+				float& pixel = depth[static_cast<size_t>(y) * bufferWidth + x];
+				pixel = std::max(pixel, static_cast<float>(invW) * 1.0001f);
+			}
+		}
+	}
+	return depth;
+}
+
+BoundingBox RandomBox(std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> depth(4.0f, 80.0f);
+	std::uniform_real_distribution<float> side(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> extent(0.1f, 2.0f);
+	const float z = depth(rng);
+	return BoundingBox(XMFLOAT3(side(rng) * z * 1.8f, side(rng) * z * 0.9f, z), XMFLOAT3(extent(rng), extent(rng), extent(rng)));
+}
+
+uint32_t FloatBits(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+// IsVisibleͬΧиǵطΧԼ1/w
+bool ScreenRect(const BoundingBox& box, FXMMATRIX viewProj, int32_t rect[4], float& nearest)
+{
+	XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+	box.GetCorners(corners);
+	float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+	nearest = 0.0f;
+	for (const auto& corner : corners)
+	{
+		const XMFLOAT3 screen = ToScreen(corner, viewProj);
+		minX = std::min(minX, screen.x);
+		maxX = std::max(maxX, screen.x);
+		minY = std::min(minY, screen.y);
+		maxY = std::max(maxY, screen.y);
+		nearest = std::max(nearest, screen.z);
+	}
+	rect[0] = std::max(static_cast<int32_t>(std::floor(std::clamp(minX, -1.0f, static_cast<float>(bufferWidth)))), 0);
+	rect[1] = std::max(static_cast<int32_t>(std::floor(std::clamp(minY, -1.0f, static_cast<float>(bufferHeight)))), 0);
+	rect[2] = std::min(static_cast<int32_t>(std::floor(std::clamp(maxX, -1.0f, static_cast<float>(bufferWidth)))), static_cast<int32_t>(bufferWidth) - 1);
+	rect[3] = std::min(static_cast<int32_t>(std::floor(std::clamp(maxY, -1.0f, static_cast<float>(bufferHeight)))), static_cast<int32_t>(bufferHeight) - 1);
+	return rect[0] <= rect[2] && rect[1] <= rect[3];
+}
+}
+
+TEST(MaskedOcclusionCuller, DepthIsConservativeAgainstBruteForce)
+{
+	const XMMATRIX viewProj = MakeViewProj();
+	for (uint32_t seed : { 1u, 2u, 3u, 4u })
+	{
+		const OccluderMesh mesh = MakeOccluders(seed, 80);
+		const std::vector<float> reference = RasterizeReference(mesh, viewProj);
+		MaskedOcclusionCuller culler(bufferWidth, bufferHeight);
+		culler.Clear(nearPlane);
+		culler.RenderOccluder(mesh, viewProj);
+		uint32_t covered = 0;
+		uint32_t referenceCovered = 0;
+		for (uint32_t y = 0; y < bufferHeight; ++y)
+		{
+			for (uint32_t x = 0; x < bufferWidth; ++x)
+			{
+				// ڵȲܱκʵڵ
+				const float depth = culler.GetPixelDepth(x, y);
+				const float truth = reference[static_cast<size_t>(y) * bufferWidth + x];
+				ASSERT_LE(depth, truth);
+				covered += depth > 0.0f;
+				referenceCovered += truth > 0.0f;
+			}
+		}
+		// ǽ渲ǵķֿϲο㣬Ӧ˻Ϊȫɼ
+		EXPECT_GT(covered, referenceCovered / 4);
+	}
+}
+
+TEST(MaskedOcclusionCuller, OccludedBoxesAreHiddenPerPixel)
+{
+	const XMMATRIX viewProj = MakeViewProj();
+	std::mt19937 rng(11);
+	uint32_t occluded = 0;
+	for (uint32_t seed : { 5u, 6u, 7u })
+	{
+		const OccluderMesh mesh = MakeOccluders(seed, 80);
+		const std::vector<float> reference = RasterizeReference(mesh, viewProj);
+		MaskedOcclusionCuller culler(bufferWidth, bufferHeight);
+		culler.Clear(nearPlane);
+		culler.RenderOccluder(mesh, viewProj);
+		for (uint32_t i = 0; i < 400; ++i)
+		{
+			const BoundingBox box = RandomBox(rng);
+			if (culler.IsVisible(box, viewProj))
+				continue;
+			++occluded;
+			// ޳İΧиǵÿضиڵ
+			int32_t rect[4];
+			float nearest;
+			if (!ScreenRect(box, viewProj, rect, nearest))
+				continue;
+			for (int32_t y = rect[1]; y <= rect[3]; ++y)
+			{
+				for (int32_t x = rect[0]; x <= rect[2]; ++x)
+				{
+					ASSERT_LT(nearest, reference[static_cast<size_t>(y) * bufferWidth + x]);
+				}
+			}
+		}
+		EXPECT_EQ(culler.GetStats().tested, 400u);
+	}
+	EXPECT_GT(occluded, 50u);
+}
+
+TEST(MaskedOcclusionCuller, SimdMatchesScalar)
+{
+	const XMMATRIX viewProj = MakeViewProj();
+	std::mt19937 rng(21);
+	for (uint32_t seed : { 8u, 9u, 10u })
+	{
+		const OccluderMesh mesh = MakeOccluders(seed, 300);
+		MaskedOcclusionCuller simd(bufferWidth, bufferHeight);
+		MaskedOcclusionCuller scalar(bufferWidth, bufferHeight, false);
+		EXPECT_FALSE(scalar.UsesSimd());
+		for (MaskedOcclusionCuller* culler : { &simd, &scalar })
+		{
+			culler->Clear(nearPlane);
+			culler->RenderOccluder(mesh, viewProj);
+		}
+		// ʵλһ£ɼԶͬ
+		for (uint32_t y = 0; y < bufferHeight; ++y)
+		{
+			for (uint32_t x = 0; x < bufferWidth; ++x)
+			{
+				ASSERT_EQ(FloatBits(simd.GetPixelDepth(x, y)), FloatBits(scalar.GetPixelDepth(x, y)));
+			}
+		}
+		for (uint32_t i = 0; i < 200; ++i)
+		{
+			const BoundingBox box = RandomBox(rng);
+			EXPECT_EQ(simd.IsVisible(box, viewProj), scalar.IsVisible(box, viewProj));
+		}
+		EXPECT_EQ(simd.GetStats().occluderTriangles, scalar.GetStats().occluderTriangles);
+		EXPECT_EQ(simd.GetStats().occluded, scalar.GetStats().occluded);
+	}
+}
+
+TEST(MaskedOcclusionCuller, NearPlaneClipping)
+{
+	const XMMATRIX viewProj = MakeViewProj();
+	// ƽĵȻڵ󷽵壬ƽİΧǿɼ
+	OccluderMesh floor;
+	floor.vertices = { { -50.0f, -2.0f, -5.0f }, { -50.0f, -2.0f, 40.0f }, { 50.0f, -2.0f, -5.0f },
+		{ 50.0f, -2.0f, -5.0f }, { -50.0f, -2.0f, 40.0f }, { 50.0f, -2.0f, 40.0f } };
+	MaskedOcclusionCuller culler(bufferWidth, bufferHeight);
+	culler.Clear(nearPlane);
+	culler.RenderOccluder(floor, viewProj);
+	EXPECT_GT(culler.GetStats().occluderTriangles, 2u);
+	EXPECT_FALSE(culler.IsVisible(BoundingBox(XMFLOAT3(0.0f, -6.0f, 15.0f), XMFLOAT3(1.0f, 0.5f, 1.0f)), viewProj));
+	EXPECT_TRUE(culler.IsVisible(BoundingBox(XMFLOAT3(0.0f, 1.0f, 15.0f), XMFLOAT3(1.0f, 0.5f, 1.0f)), viewProj));
+	EXPECT_TRUE(culler.IsVisible(BoundingBox(XMFLOAT3(0.0f, -4.0f, 0.0f), XMFLOAT3(1.0f, 0.5f, 1.0f)), viewProj));
+}
+
+TEST(OccluderMesh, AppendWithStrideAndSimplify)
+{
+	// λòڶṹĿͷҲǽṹΨһĳԱ
+	struct Vertex
+	{
+		float		uv[2];
+		XMFLOAT3	pos;
+		uint32_t	color;
+	};
+	const Vertex mesh[] = { { {}, { 0.0f, 0.0f, 0.0f }, 1 }, { {}, { 10.0f, 0.0f, 0.0f }, 2 }, { {}, { 0.0f, 10.0f, 0.0f }, 3 },
+		{ {}, { 0.0f, 0.0f, 1.0f }, 4 }, { {}, { 0.1f, 0.0f, 1.0f }, 5 }, { {}, { 0.0f, 0.1f, 1.0f }, 6 } };
+	const uint32_t indices[] = { 0, 1, 2, 3, 4, 5 };
+	OccluderMesh occluder;
+	const XMMATRIX world = XMMatrixScaling(0.5f, 0.5f, 0.5f) * XMMatrixTranslation(1.0f, 2.0f, 3.0f);
+	occluder.Append(&mesh[0].pos, sizeof(Vertex), indices, 6, world, 1.0f);
+	// ڶС
+	ASSERT_EQ(occluder.GetTriangleCount(), 1u);
+	EXPECT_NEAR(occluder.vertices[1].x, 6.0f, 1e-5f);
+	EXPECT_NEAR(occluder.vertices[1].y, 2.0f, 1e-5f);
+	EXPECT_NEAR(occluder.vertices[2].y, 7.0f, 1e-5f);
+	EXPECT_NEAR(occluder.vertices[2].z, 3.0f, 1e-5f);
+	occluder.Append(&mesh[0].pos, sizeof(Vertex), indices + 3, 3, XMMatrixScaling(100.0f, 100.0f, 100.0f), 1.0f);
+	occluder.Append(&mesh[0].pos, sizeof(Vertex), indices, 3, XMMatrixScaling(0.2f, 0.2f, 0.2f), 1.0f);
+	ASSERT_EQ(occluder.GetTriangleCount(), 3u);
+	// Σԭ˳
+	occluder.Simplify(2);
+	ASSERT_EQ(occluder.GetTriangleCount(), 2u);
+	EXPECT_NEAR(occluder.vertices[0].x, 1.0f, 1e-5f);
+	EXPECT_NEAR(occluder.vertices[4].x, 10.0f, 1e-4f);
+	EXPECT_NEAR(occluder.vertices[5].z, 100.0f, 1e-3f);
+}
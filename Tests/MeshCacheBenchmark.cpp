@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+#include <fstream>
+#include "MeshCache.h"
+
+using namespace Models;
+namespace fs = std::filesystem;
+
+namespace
+{
+// sponzaģٸܼʮ򶥵
+MeshCacheData MakeData(uint32_t meshCount, uint32_t verticesPerMesh)
+{
+	MeshCacheData data;
+	data.materials.push_back({ "material", { "diffuse.dds", "specular.dds", "normal.dds" } });
+	for (uint32_t m = 0; m < meshCount; ++m)
+	{
+		CachedMesh mesh;
+		mesh.materialName = "material";
+		mesh.vertices.resize(verticesPerMesh);
+		mesh.indices.resize(static_cast<size_t>(verticesPerMesh) * 3);
+		for (uint32_t i = 0; i < mesh.indices.size(); ++i)
+		{
+			mesh.indices[i] = i % verticesPerMesh;
+		}
+		mesh.eboCount = static_cast<uint32_t>(mesh.indices.size());
+		data.meshes.push_back(std::move(mesh));
+	}
+	return data;
+}
+
+fs::path BenchmarkPath(const char* name)
+{
+	return fs::temp_directory_path() / name;
+}
+
+void BM_Save(benchmark::State& state)
+{
+	const MeshCacheData data = MakeData(static_cast<uint32_t>(state.range(0)), 1024);
+	const fs::path path = BenchmarkPath("MeshCacheBenchmark_save.meshcache");
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(MeshCache::Save(path, 1, data));
+	}
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(fs::file_size(path)));
+	fs::remove(path);
+}
+BENCHMARK(BM_Save)->Arg(64)->Arg(400)->Unit(benchmark::kMillisecond);
+
+void BM_Load(benchmark::State& state)
+{
+	const fs::path path = BenchmarkPath("MeshCacheBenchmark_load.meshcache");
+	MeshCache::Save(path, 1, MakeData(static_cast<uint32_t>(state.range(0)), 1024));
+	for (auto _ : state)
+	{
+		MeshCacheData data;
+		benchmark::DoNotOptimize(MeshCache::Load(path, 1, data));
+	}
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(fs::file_size(path)));
+	fs::remove(path);
+}
+BENCHMARK(BM_Load)->Arg(64)->Arg(400)->Unit(benchmark::kMillisecond);
+
+// ԴļϣÿμʱҪ㣬ɨobjеmtllib
+void BM_HashSource(benchmark::State& state)
+{
+	const fs::path obj = BenchmarkPath("MeshCacheBenchmark.obj");
+	{
+		std::ofstream stream(obj, std::ios::binary | std::ios::trunc);
+		stream << "mtllib MeshCacheBenchmark.mtl\n";
+		for (int64_t i = 0; i < state.range(0); ++i)
+		{
+			stream << "v " << i * 0.001 << " 1.5 -2.25\nvt 0.5 0.25\nf 1/1 2/2 3/3\n";
+		}
+	}
+	uint64_t hash = 0;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(MeshCache::HashSource(obj, 0, hash));
+	}
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(fs::file_size(obj)));
+	fs::remove(obj);
+}
+BENCHMARK(BM_HashSource)->Arg(1 << 18)->Unit(benchmark::kMillisecond);
+}
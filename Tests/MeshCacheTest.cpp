@@ -0,0 +1,221 @@
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include "TestFramework.h"
+#include "MeshCache.h"
+
+using namespace Models;
+namespace fs = std::filesystem;
+
+namespace
+{
+// ÿʹöʱĿ¼ʱɾ
+struct TempDir
+{
+	fs::path path;
+	explicit TempDir(const char* name) : path(fs::temp_directory_path() / (std::string("MeshCacheTest_") + name))
+	{
+		fs::remove_all(path);
+		fs::create_directories(path);
+	}
+	~TempDir()
+	{
+		std::error_code error;
+		fs::remove_all(path, error);
+	}
+};
+
+void WriteFile(const fs::path& path, const std::string& content)
+{
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	stream << content;
+}
+
+std::string ReadFile(const fs::path& path)
+{
+	std::ifstream stream(path, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+MeshCacheData MakeData(uint32_t meshCount, uint32_t verticesPerMesh)
+{
+	std::mt19937 rng(meshCount);
+	std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+	MeshCacheData data;
+	data.materials.push_back({ "stone", { "stone_d.dds", "", "stone_n.dds" } });
+	data.materials.push_back({ "leaf", { "leaf_d.dds", "leaf_s.dds", "" } });
+	uint32_t vboStart = 0, eboStart = 0;
+	for (uint32_t m = 0; m < meshCount; ++m)
+	{
+		CachedMesh mesh;
+		mesh.materialName = data.materials[m % 2].name;
+		mesh.vboStart = vboStart;
+		mesh.eboStart = eboStart;
+		for (uint32_t v = 0; v < verticesPerMesh; ++v)
+		{
+			mesh.vertices.emplace_back(dist(rng), dist(rng), dist(rng), 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, dist(rng), dist(rng));
+		}
+		for (uint32_t i = 0; i + 2 < verticesPerMesh; ++i)
+		{
+			mesh.indices.insert(mesh.indices.end(), { i, i + 1, i + 2 });
+		}
+		mesh.eboCount = static_cast<uint32_t>(mesh.indices.size());
+		mesh.bounds = DirectX::BoundingBox(XMFLOAT3(1.0f, 2.0f, 3.0f), XMFLOAT3(4.0f, 5.0f, 6.0f));
+		vboStart += verticesPerMesh;
+		eboStart += mesh.eboCount;
+		data.meshes.push_back(std::move(mesh));
+	}
+	return data;
+}
+
+uint32_t ReadU32(const std::string& bytes, size_t offset)
+{
+	uint32_t value;
+	memcpy(&value, bytes.data() + offset, sizeof(value));
+	return value;
+}
+
+void WriteU32(std::string& bytes, size_t offset, uint32_t value)
+{
+	memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+
+// ļͷmagicversionsourceHashmaterialCountmeshCount
+constexpr size_t versionOffset = 4;
+constexpr size_t materialCountOffset = 16;
+constexpr size_t meshCountOffset = 20;
+}
+
+TEST(MeshCache, HashIsFnv1aAndChains)
+{
+	// FNV-1a 64λı׼
+	EXPECT_EQ(MeshCache::Hash("", 0), 14695981039346656037ULL);
+	EXPECT_EQ(MeshCache::Hash("a", 1), 0xaf63dc4c8601ec8cULL);
+	EXPECT_EQ(MeshCache::Hash("foobar", 6), 0x85944171f73967e8ULL);
+	EXPECT_EQ(MeshCache::Hash("bar", 3, MeshCache::Hash("foo", 3)), MeshCache::Hash("foobar", 6));
+}
+
+TEST(MeshCache, SaveLoadRoundTrip)
+{
+	TempDir dir("RoundTrip");
+	const fs::path cachePath = MeshCache::GetCachePath(dir.path / "model.obj");
+	EXPECT_EQ(cachePath.filename().string(), std::string("model.obj.meshcache"));
+	const MeshCacheData data = MakeData(5, 64);
+	ASSERT_TRUE(MeshCache::Save(cachePath, 42, data));
+	EXPECT_FALSE(fs::exists(fs::path(cachePath) += ".tmp"));
+
+	MeshCacheData loaded;
+	ASSERT_TRUE(MeshCache::Load(cachePath, 42, loaded));
+	ASSERT_EQ(loaded.materials.size(), data.materials.size());
+	for (size_t i = 0; i < data.materials.size(); ++i)
+	{
+		EXPECT_EQ(loaded.materials[i].name, data.materials[i].name);
+		for (int t = 0; t < 3; ++t)
+		{
+			EXPECT_EQ(loaded.materials[i].textures[t], data.materials[i].textures[t]);
+		}
+	}
+	ASSERT_EQ(loaded.meshes.size(), data.meshes.size());
+	for (size_t i = 0; i < data.meshes.size(); ++i)
+	{
+		const auto& a = loaded.meshes[i];
+		const auto& b = data.meshes[i];
+		EXPECT_EQ(a.materialName, b.materialName);
+		EXPECT_EQ(a.vboStart, b.vboStart);
+		EXPECT_EQ(a.eboStart, b.eboStart);
+		EXPECT_EQ(a.eboCount, b.eboCount);
+		EXPECT_EQ(a.bounds.Extents.z, b.bounds.Extents.z);
+		ASSERT_EQ(a.vertices.size(), b.vertices.size());
+		EXPECT_EQ(memcmp(a.vertices.data(), b.vertices.data(), sizeof(Vertex_CPU) * a.vertices.size()), 0);
+		EXPECT_EQ(a.indices, b.indices);
+	}
+}
+
+TEST(MeshCache, LoadRejectsStaleOrCorruptFiles)
+{
+	TempDir dir("Corrupt");
+	const fs::path cachePath = dir.path / "model.meshcache";
+	ASSERT_TRUE(MeshCache::Save(cachePath, 7, MakeData(3, 16)));
+	const std::string original = ReadFile(cachePath);
+	MeshCacheData loaded;
+	EXPECT_FALSE(MeshCache::Load(dir.path / "missing.meshcache", 7, loaded));
+	EXPECT_FALSE(MeshCache::Load(cachePath, 8, loaded));
+
+	std::string bytes = original;
+	WriteU32(bytes, versionOffset, MeshCache::version + 1);
+	WriteFile(cachePath, bytes);
+	EXPECT_FALSE(MeshCache::Load(cachePath, 7, loaded));
+
+	// ضλöʧ
+	for (size_t size : { size_t(3), size_t(24), original.size() / 2, original.size() - 1 })
+	{
+		WriteFile(cachePath, original.substr(0, size));
+		EXPECT_FALSE(MeshCache::Load(cachePath, 7, loaded));
+	}
+	WriteFile(cachePath, original + "x");
+	EXPECT_FALSE(MeshCache::Load(cachePath, 7, loaded));
+	// ʧܵĶȡ޸
+	EXPECT_TRUE(loaded.meshes.empty());
+	WriteFile(cachePath, original);
+	EXPECT_TRUE(MeshCache::Load(cachePath, 7, loaded));
+}
+
+TEST(MeshCache, LoadRejectsCountsLargerThanFile)
+{
+	TempDir dir("Counts");
+	const fs::path cachePath = dir.path / "model.meshcache";
+	ASSERT_TRUE(MeshCache::Save(cachePath, 7, MakeData(2, 8)));
+	const std::string original = ReadFile(cachePath);
+	EXPECT_EQ(ReadU32(original, materialCountOffset), 2u);
+	EXPECT_EQ(ReadU32(original, meshCountOffset), 2u);
+	MeshCacheData loaded;
+	// 𻵵ڷ֮ǰͱ᳢ܾԷʮGB
+	for (uint32_t count : { 0xFFFFFFFFu, 0x10000000u, 1000u })
+	{
+		std::string bytes = original;
+		WriteU32(bytes, materialCountOffset, count);
+		WriteFile(cachePath, bytes);
+		EXPECT_FALSE(MeshCache::Load(cachePath, 7, loaded));
+		bytes = original;
+		WriteU32(bytes, meshCountOffset, count);
+		WriteFile(cachePath, bytes);
+		EXPECT_FALSE(MeshCache::Load(cachePath, 7, loaded));
+	}
+}
+
+TEST(MeshCache, SourceHashFollowsMaterialLibraries)
+{
+	TempDir dir("Source");
+	const fs::path obj = dir.path / "scene.obj";
+	WriteFile(obj, "# test\nmtllib scene.mtl extra.mtl\r\nv 0 0 0\nv 1 0 0\nv 0 1 0\nusemtl stone\nf 1 2 3\n");
+	WriteFile(dir.path / "scene.mtl", "newmtl stone\nmap_Kd stone.dds\n");
+	WriteFile(dir.path / "extra.mtl", "newmtl leaf\n");
+	uint64_t base, hash;
+	ASSERT_TRUE(MeshCache::HashSource(obj, 0, base));
+	ASSERT_TRUE(MeshCache::HashSource(obj, 0, hash));
+	EXPECT_EQ(hash, base);
+	ASSERT_TRUE(MeshCache::HashSource(obj, 1, hash));
+	EXPECT_NE(hash, base);
+
+	// ޸һʿⶼʹʧЧ
+	WriteFile(dir.path / "scene.mtl", "newmtl stone\nmap_Kd stone2.dds\n");
+	ASSERT_TRUE(MeshCache::HashSource(obj, 0, hash));
+	EXPECT_NE(hash, base);
+	const uint64_t changed = hash;
+	WriteFile(dir.path / "extra.mtl", "newmtl leaf\nd 0.5\n");
+	ASSERT_TRUE(MeshCache::HashSource(obj, 0, hash));
+	EXPECT_NE(hash, changed);
+	// ɾʿͬıϣ
+	const uint64_t beforeRemove = hash;
+	fs::remove(dir.path / "extra.mtl");
+	ASSERT_TRUE(MeshCache::HashSource(obj, 0, hash));
+	EXPECT_NE(hash, beforeRemove);
+	// ޹صļӰϣ
+	WriteFile(dir.path / "other.mtl", "newmtl other\n");
+	uint64_t again;
+	ASSERT_TRUE(MeshCache::HashSource(obj, 0, again));
+	EXPECT_EQ(again, hash);
+
+	EXPECT_FALSE(MeshCache::HashSource(dir.path / "missing.obj", 0, hash));
+}
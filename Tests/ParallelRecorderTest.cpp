@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "TestFramework.h"
+#include "ParallelRecorder.hpp"
+
+namespace
+{
+struct FakeItem
+{
+	uint32_t id;
+};
+
+// еһ¼chunkIdxΪڿ
+struct LoggedCommand
+{
+	enum class Type { begin, draw, end };
+	Type		type;
+	uint32_t	passIdx;
+	uint32_t	chunkIdx;
+	uint32_t	itemId;
+
+	bool operator==(const LoggedCommand& rhs) const
+	{
+		return type == rhs.type && passIdx == rhs.passIdx && chunkIdx == rhs.chunkIdx && itemId == rhs.itemId;
+	}
+};
+
+// ֻ¼еĽնˣб
+class LoggingSink : public ICommandSink<FakeItem>
+{
+public:
+	void BeginChunk(const RecordChunk& chunk) override
+	{
+		m_current = chunk;
+		log.push_back({ LoggedCommand::Type::begin, chunk.passIdx, chunk.chunkIdx, 0 });
+	}
+
+	void DrawItem(const FakeItem& item) override
+	{
+		log.push_back({ LoggedCommand::Type::draw, m_current.passIdx, m_current.chunkIdx, item.id });
+	}
+
+	void EndChunk(const RecordChunk& chunk) override
+	{
+		log.push_back({ LoggedCommand::Type::end, chunk.passIdx, chunk.chunkIdx, 0 });
+	}
+
+	std::vector<LoggedCommand>	log;
+private:
+	RecordChunk					m_current;
+};
+
+class Scene
+{
+public:
+	explicit Scene(const std::vector<uint32_t>& passSizes)
+	{
+		uint32_t nextId = 0;
+		for (uint32_t size : passSizes)
+		{
+			std::vector<FakeItem*> pass;
+			for (uint32_t i = 0; i < size; ++i)
+			{
+				m_items.emplace_back(std::make_unique<FakeItem>(FakeItem{ nextId++ }));
+				pass.push_back(m_items.back().get());
+			}
+			passes.push_back(std::move(pass));
+		}
+	}
+
+	std::vector<std::vector<FakeItem*>>	passes;
+private:
+	std::vector<std::unique_ptr<FakeItem>>	m_items;
+};
+
+// sink˳ƴӸ൱ڰ˳ύб
+std::vector<LoggedCommand> RecordScene(const Scene& scene, uint32_t maxChunks, bool parallel)
+{
+	ParallelRecorder<FakeItem> recorder(maxChunks, 16);
+	for (const auto& pass : scene.passes)
+	{
+		recorder.AddPass(pass);
+	}
+	std::vector<LoggingSink> sinks(recorder.GetChunkCount());
+	std::vector<ICommandSink<FakeItem>*> sinkPtrs;
+	for (auto& sink : sinks)
+	{
+		sinkPtrs.push_back(&sink);
+	}
+	if (parallel)
+		recorder.Record(sinkPtrs);
+	else
+		recorder.RecordSerial(sinkPtrs);
+
+	std::vector<LoggedCommand> submitted;
+	for (const auto& sink : sinks)
+	{
+		submitted.insert(submitted.end(), sink.log.begin(), sink.log.end());
+	}
+	return submitted;
+}
+
+std::vector<uint32_t> DrawnItems(const std::vector<LoggedCommand>& commands)
+{
+	std::vector<uint32_t> ids;
+	for (const auto& command : commands)
+	{
+		if (command.type == LoggedCommand::Type::draw)
+			ids.push_back(command.itemId);
+	}
+	return ids;
+}
+}
+
+TEST(ParallelRecorder, SplitChunksTilesItemsEvenly)
+{
+	for (uint32_t itemCount = 0; itemCount < 300; ++itemCount)
+	{
+		for (uint32_t maxChunks : { 1u, 2u, 3u, 4u, 8u })
+		{
+			for (uint32_t minItems : { 1u, 7u, 32u })
+			{
+				const auto chunks = ParallelRecorder<FakeItem>::SplitChunks(5, itemCount, maxChunks, minItems);
+				const uint32_t expectedCount = std::clamp((itemCount + minItems - 1) / minItems, 1u, maxChunks);
+				ASSERT_EQ(static_cast<uint32_t>(chunks.size()), expectedCount);
+				uint32_t start = 0;
+				for (uint32_t i = 0; i < chunks.size(); ++i)
+				{
+					const RecordChunk& chunk = chunks[i];
+					EXPECT_EQ(chunk.passIdx, 5u);
+					EXPECT_EQ(chunk.chunkIdx, i);
+					EXPECT_EQ(chunk.chunkCount, expectedCount);
+					ASSERT_EQ(chunk.begin, start);
+					ASSERT_LE(chunk.begin, chunk.end);
+					// ǰĿȺĿһȾ
+					const uint32_t size = chunk.end - chunk.begin;
+					EXPECT_LE(size, itemCount / expectedCount + 1);
+					EXPECT_GE(size, itemCount / expectedCount);
+					if (i > 0)
+						EXPECT_LE(size, chunks[i - 1].end - chunks[i - 1].begin);
+					start = chunk.end;
+				}
+				EXPECT_EQ(start, itemCount);
+			}
+		}
+	}
+}
+
+TEST(ParallelRecorder, ChunksFollowPassOrder)
+{
+	Scene scene({ 40, 0, 3, 100 });
+	ParallelRecorder<FakeItem> recorder(4, 16);
+	for (uint32_t passIdx = 0; passIdx < scene.passes.size(); ++passIdx)
+	{
+		EXPECT_EQ(recorder.AddPass(scene.passes[passIdx]), passIdx);
+	}
+	// 403飬pass3passռһ飬100Ʒ4
+	const auto& chunks = recorder.GetChunks();
+	ASSERT_EQ(recorder.GetChunkCount(), 9u);
+	const uint32_t expectedPass[] = { 0, 0, 0, 1, 2, 3, 3, 3, 3 };
+	const uint32_t expectedBegin[] = { 0, 14, 27, 0, 0, 0, 25, 50, 75 };
+	for (uint32_t i = 0; i < chunks.size(); ++i)
+	{
+		EXPECT_EQ(chunks[i].passIdx, expectedPass[i]);
+		EXPECT_EQ(chunks[i].begin, expectedBegin[i]);
+	}
+	EXPECT_EQ(chunks[3].end, 0u);
+
+	// ÿsinkǡյһ飬ûȾĿȻBegin/End״̬
+	std::vector<LoggingSink> sinks(recorder.GetChunkCount());
+	std::vector<ICommandSink<FakeItem>*> sinkPtrs;
+	for (auto& sink : sinks)
+	{
+		sinkPtrs.push_back(&sink);
+	}
+	recorder.Record(sinkPtrs);
+	for (uint32_t i = 0; i < sinks.size(); ++i)
+	{
+		const auto& log = sinks[i].log;
+		ASSERT_EQ(log.size(), chunks[i].end - chunks[i].begin + 2);
+		EXPECT_TRUE(log.front().type == LoggedCommand::Type::begin);
+		EXPECT_TRUE(log.back().type == LoggedCommand::Type::end);
+		EXPECT_EQ(log.front().passIdx, chunks[i].passIdx);
+		EXPECT_EQ(log.front().chunkIdx, chunks[i].chunkIdx);
+		for (uint32_t j = 1; j + 1 < log.size(); ++j)
+		{
+			EXPECT_EQ(log[j].itemId, scene.passes[chunks[i].passIdx][chunks[i].begin + j - 1]->id);
+		}
+	}
+
+	recorder.Reset();
+	EXPECT_EQ(recorder.GetChunkCount(), 0u);
+	EXPECT_EQ(recorder.GetMaxChunksPerPass(), 4u);
+}
+
+TEST(ParallelRecorder, OutputIsIdenticalAcrossThreadCounts)
+{
+	Scene scene({ 500, 17, 0, 1, 64, 33, 1000 });
+	const auto reference = RecordScene(scene, 1, false);
+	std::vector<uint32_t> expectedIds;
+	for (const auto& pass : scene.passes)
+	{
+		for (const FakeItem* item : pass)
+		{
+			expectedIds.push_back(item->id);
+		}
+	}
+	EXPECT_TRUE(DrawnItems(reference) == expectedIds);
+
+	// 湤߳仯˳ύĻ˳뵥̴߳¼ͬ
+	for (uint32_t maxChunks : { 1u, 2u, 3u, 4u, 8u, 16u })
+	{
+		const auto serial = RecordScene(scene, maxChunks, false);
+		EXPECT_TRUE(DrawnItems(serial) == expectedIds);
+		for (uint32_t run = 0; run < 20; ++run)
+		{
+			ASSERT_TRUE(RecordScene(scene, maxChunks, true) == serial);
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include "PointLightStore.h"
+
+using namespace DirectX;
+
+namespace
+{
+// 볡л˶ĵԴֲ
+void FillStore(PointLightStore& store, uint32_t count)
+{
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<float> radius(5.0f, 60.0f);
+	std::uniform_real_distribution<float> angle(0.0f, XM_2PI);
+	std::uniform_real_distribution<float> height(0.5f, 20.0f);
+	std::uniform_real_distribution<float> speed(0.05f, 0.5f);
+	std::uniform_real_distribution<float> color(0.2f, 1.0f);
+	store.Reserve(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		LightMoveParams move;
+		move.radius = radius(rng);
+		move.angle = angle(rng);
+		move.height = height(rng);
+		move.moveSpeed = speed(rng);
+		LightInCompute light{};
+		light.strength = XMFLOAT3(color(rng), color(rng), color(rng));
+		light.fallOffStart = 1.0f;
+		light.fallOffEnd = 8.0f;
+		store.Add(move, light);
+	}
+}
+
+XMMATRIX MakeView()
+{
+	return XMMatrixLookAtLH(XMVectorSet(5.0f, 30.0f, -80.0f, 1.0f), XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+}
+
+// SoA SIMD汾ַ̳߳
+void BM_Animate(benchmark::State& state)
+{
+	PointLightStore store;
+	FillStore(store, static_cast<uint32_t>(state.range(0)));
+	const XMMATRIX view = MakeView();
+	float totalTime = 0.0f;
+	for (auto _ : state)
+	{
+		store.Animate(totalTime, view);
+		totalTime += 1.0f / 60.0f;
+		benchmark::DoNotOptimize(store.GetData());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Animate)->Arg(2048)->Arg(100000)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// Դı汾ӦԭBoxApp::UpdateLightPosļ
+void BM_AnimateScalar(benchmark::State& state)
+{
+	PointLightStore store;
+	FillStore(store, static_cast<uint32_t>(state.range(0)));
+	std::vector<LightInCompute> out(store.GetSize());
+	const XMMATRIX view = MakeView();
+	float totalTime = 0.0f;
+	for (auto _ : state)
+	{
+		store.AnimateScalar(totalTime, view, out.data());
+		totalTime += 1.0f / 60.0f;
+		benchmark::DoNotOptimize(out.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AnimateScalar)->Arg(2048)->Arg(100000)->Unit(benchmark::kMicrosecond)->UseRealTime();
+}
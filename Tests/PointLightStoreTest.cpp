@@ -0,0 +1,160 @@
+#include <cmath>
+#include <map>
+#include <random>
+#include <vector>
+#include "TestFramework.h"
+#include "PointLightStore.h"
+
+using namespace DirectX;
+
+namespace
+{
+LightMoveParams MakeMove(float seed)
+{
+	LightMoveParams move;
+	move.radius = 10.0f + seed;
+	move.angle = 0.1f * seed;
+	move.height = 2.0f * seed;
+	move.moveSpeed = 0.01f * (seed + 1.0f);
+	return move;
+}
+
+// strength.xΪԴıʶɾƺԿҵԭ
+LightInCompute MakeLight(float id)
+{
+	LightInCompute light{};
+	light.strength = XMFLOAT3(id, 0.5f, 0.25f);
+	light.fallOffStart = 1.0f;
+	light.fallOffEnd = 2.0f + id;
+	return light;
+}
+
+XMMATRIX MakeView()
+{
+	return XMMatrixLookAtLH(XMVectorSet(5.0f, 30.0f, -80.0f, 1.0f), XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+}
+
+void ExpectAnimateMatchesScalar(PointLightStore& store, float totalTime)
+{
+	const XMMATRIX view = MakeView();
+	std::vector<LightInCompute> expected(store.GetSize());
+	store.AnimateScalar(totalTime, view, expected.data());
+	store.Animate(totalTime, view);
+	const LightInCompute* actual = store.GetData();
+	for (uint32_t i = 0; i < store.GetSize(); ++i)
+	{
+		ASSERT_NEAR(actual[i].posV.x, expected[i].posV.x, 1e-3f);
+		ASSERT_NEAR(actual[i].posV.y, expected[i].posV.y, 1e-3f);
+		ASSERT_NEAR(actual[i].posV.z, expected[i].posV.z, 1e-3f);
+		ASSERT_EQ(actual[i].strength.x, expected[i].strength.x);
+		ASSERT_EQ(actual[i].fallOffStart, expected[i].fallOffStart);
+		ASSERT_EQ(actual[i].fallOffEnd, expected[i].fallOffEnd);
+	}
+}
+}
+
+TEST(PointLightStore, RemoveKeepsHandlesAndPacksDensely)
+{
+	PointLightStore store;
+	std::vector<uint32_t> handles;
+	for (uint32_t i = 0; i < 6; ++i)
+		handles.push_back(store.Add(MakeMove(static_cast<float>(i)), MakeLight(static_cast<float>(i))));
+	EXPECT_EQ(store.GetSize(), 6u);
+
+	// ɾмĹԴĩβĹԴλ
+	store.Remove(handles[1]);
+	EXPECT_EQ(store.GetSize(), 5u);
+	EXPECT_FALSE(store.IsValid(handles[1]));
+	EXPECT_EQ(store.GetIndex(handles[5]), 1u);
+	for (uint32_t i : { 0u, 2u, 3u, 4u, 5u })
+	{
+		ASSERT_TRUE(store.IsValid(handles[i]));
+		EXPECT_EQ(store.GetData()[store.GetIndex(handles[i])].strength.x, static_cast<float>(i));
+	}
+
+	// ɾһյҪ
+	store.Remove(handles[4]);
+	EXPECT_EQ(store.GetSize(), 4u);
+	EXPECT_EQ(store.GetIndex(handles[5]), 1u);
+	EXPECT_FALSE(store.IsValid(PointLightStore::invalidHandle));
+}
+
+TEST(PointLightStore, RemovedHandlesAreReused)
+{
+	PointLightStore store;
+	const uint32_t a = store.Add(MakeMove(0.0f), MakeLight(0.0f));
+	const uint32_t b = store.Add(MakeMove(1.0f), MakeLight(1.0f));
+	store.Remove(a);
+	const uint32_t c = store.Add(MakeMove(2.0f), MakeLight(2.0f));
+	EXPECT_EQ(c, a);
+	EXPECT_EQ(store.GetIndex(b), 0u);
+	EXPECT_EQ(store.GetIndex(c), 1u);
+	EXPECT_EQ(store.GetData()[store.GetIndex(c)].strength.x, 2.0f);
+
+	// ȫɾ
+	store.Remove(b);
+	store.Remove(c);
+	EXPECT_EQ(store.GetSize(), 0u);
+	const uint32_t d = store.Add(MakeMove(3.0f), MakeLight(3.0f));
+	EXPECT_TRUE(store.IsValid(d));
+	EXPECT_EQ(store.GetIndex(d), 0u);
+}
+
+TEST(PointLightStore, AnimateMatchesScalarAfterRemovals)
+{
+	PointLightStore store;
+	std::vector<uint32_t> handles;
+	// Խ߳飬4ı
+	for (uint32_t i = 0; i < 2051; ++i)
+		handles.push_back(store.Add(MakeMove(static_cast<float>(i % 97)), MakeLight(static_cast<float>(i))));
+	ExpectAnimateMatchesScalar(store, 3.5f);
+
+	for (uint32_t i = 0; i < handles.size(); i += 3)
+		store.Remove(handles[i]);
+	EXPECT_EQ(store.GetSize(), 1367u);
+	ExpectAnimateMatchesScalar(store, 7.25f);
+}
+
+TEST(PointLightStore, RandomAddRemoveMatchesReference)
+{
+	PointLightStore store;
+	std::map<uint32_t, float> reference;
+	std::vector<uint32_t> alive;
+	std::mt19937 rng(1337);
+	float nextId = 0.0f;
+	for (uint32_t step = 0; step < 20000; ++step)
+	{
+		if (alive.empty() || rng() % 3 != 0)
+		{
+			const uint32_t handle = store.Add(MakeMove(std::fmod(nextId, 97.0f)), MakeLight(nextId));
+			ASSERT_TRUE(reference.find(handle) == reference.end());
+			reference[handle] = nextId;
+			alive.push_back(handle);
+			nextId += 1.0f;
+		}
+		else
+		{
+			const size_t slot = rng() % alive.size();
+			store.Remove(alive[slot]);
+			reference.erase(alive[slot]);
+			alive[slot] = alive.back();
+			alive.pop_back();
+		}
+		if (step % 997 != 0)
+			continue;
+		ASSERT_EQ(store.GetSize(), static_cast<uint32_t>(reference.size()));
+		// ÿǡöӦһЧ
+		std::vector<bool> used(store.GetSize(), false);
+		for (const auto& [handle, id] : reference)
+		{
+			ASSERT_TRUE(store.IsValid(handle));
+			const uint32_t idx = store.GetIndex(handle);
+			ASSERT_LT(idx, store.GetSize());
+			ASSERT_FALSE(used[idx]);
+			used[idx] = true;
+			ASSERT_EQ(store.GetData()[idx].strength.x, id);
+			ASSERT_EQ(store.GetData()[idx].fallOffEnd, 2.0f + id);
+		}
+	}
+	ExpectAnimateMatchesScalar(store, 1.0f);
+}
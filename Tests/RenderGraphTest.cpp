@@ -0,0 +1,423 @@
+#include <algorithm>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "TestFramework.h"
+#include "RenderGraph.h"
+
+namespace
+{
+struct DeclaredAccess
+{
+	RenderGraph::ResourceHandle	resource;
+	uint32_t					state;
+	bool						write;
+};
+
+/*
+ * ģĺˣάÿԴ״̬passʼʱУķ
+ * 1. תbeforeڵǰ״̬beginend֮Դܱ
+ * 2. UAVдʱη֮UAV
+ * 3. ֡ʱԴصfinalStateûδɵĲ
+ */
+class ValidatingBackend : public RenderGraphBackend
+{
+public:
+	struct ResourceState
+	{
+		uint32_t	state{ GraphState::common };
+		bool		pending{ false };	// beginδend
+		uint32_t	pendingAfter{ 0 };
+		bool		lastUav{ false };	// һηΪUAV֮ûת
+		bool		lastUavWrite{ false };
+		bool		uavBarrier{ false };
+	};
+
+	ValidatingBackend(const RenderGraph& graph, std::map<std::string, std::vector<DeclaredAccess>> accesses)
+	: m_graph(graph), m_accesses(std::move(accesses))
+	{
+	}
+
+	void Import(RenderGraph::ResourceHandle resource, uint32_t initialState)
+	{
+		m_states[resource].state = initialState;
+	}
+
+	void SubmitBarriers(const GraphBarrier* barriers, uint32_t count) override
+	{
+		++submitCount;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const GraphBarrier& barrier = barriers[i];
+			log.push_back(barrier);
+			if (barrier.type == GraphBarrierType::aliasing)
+				continue;
+			auto found = m_states.find(barrier.resource);
+			if (found == m_states.end())
+			{
+				Error("barrier on a resource without tracked state: " + m_graph.GetResourceName(barrier.resource));
+				continue;
+			}
+			ResourceState& res = found->second;
+			if (barrier.type == GraphBarrierType::uav)
+			{
+				if (res.pending || res.state != GraphState::unorderedAccess)
+					Error("UAV barrier outside unordered access on " + m_graph.GetResourceName(barrier.resource));
+				res.uavBarrier = true;
+				continue;
+			}
+			if (barrier.before == barrier.after)
+				Error("redundant transition on " + m_graph.GetResourceName(barrier.resource));
+			switch (barrier.split)
+			{
+			case GraphBarrierSplit::none:
+				if (res.pending || res.state != barrier.before)
+					Error("transition from a wrong state on " + m_graph.GetResourceName(barrier.resource));
+				res.state = barrier.after;
+				break;
+			case GraphBarrierSplit::begin:
+				if (res.pending || res.state != barrier.before)
+					Error("split begin from a wrong state on " + m_graph.GetResourceName(barrier.resource));
+				res.pending = true;
+				res.pendingAfter = barrier.after;
+				break;
+			case GraphBarrierSplit::end:
+				if (!res.pending || res.pendingAfter != barrier.after || res.state != barrier.before)
+					Error("split end without a matching begin on " + m_graph.GetResourceName(barrier.resource));
+				res.pending = false;
+				res.state = barrier.after;
+				break;
+			}
+			res.lastUav = false;
+			res.uavBarrier = false;
+		}
+	}
+
+	void BeginPass(const std::string& name) override
+	{
+		passes.push_back(name);
+		const auto found = m_accesses.find(name);
+		if (found == m_accesses.end())
+			return;
+		for (const DeclaredAccess& access : found->second)
+		{
+			auto state = m_states.find(access.resource);
+			if (state == m_states.end())
+				continue;
+			ResourceState& res = state->second;
+			const std::string& resourceName = m_graph.GetResourceName(access.resource);
+			if (res.pending)
+				Error(name + " accesses " + resourceName + " during a split barrier");
+			if ((res.state & access.state) != access.state || (access.write && res.state != access.state))
+				Error(name + " accesses " + resourceName + " in a wrong state");
+			const bool uav = access.state == GraphState::unorderedAccess;
+			if (uav && res.lastUav && (access.write || res.lastUavWrite) && !res.uavBarrier)
+				Error(name + " misses a UAV barrier on " + resourceName);
+			res.lastUav = uav;
+			res.lastUavWrite = access.write;
+			res.uavBarrier = false;
+		}
+	}
+
+	void EndPass() override
+	{
+		++endCount;
+	}
+
+	void CheckFinal(RenderGraph::ResourceHandle resource, uint32_t finalState)
+	{
+		const ResourceState& res = m_states[resource];
+		if (res.pending || res.state != finalState)
+			Error("frame ends with " + m_graph.GetResourceName(resource) + " in a wrong state");
+	}
+
+	std::vector<GraphBarrier>	log;
+	std::vector<std::string>	passes;
+	std::vector<std::string>	errors;
+	uint32_t					submitCount{ 0 };
+	uint32_t					endCount{ 0 };
+private:
+	void Error(const std::string& message)
+	{
+		errors.push_back(message);
+	}
+
+	const RenderGraph&										m_graph;
+	std::map<std::string, std::vector<DeclaredAccess>>		m_accesses;
+	std::map<RenderGraph::ResourceHandle, ResourceState>	m_states;
+};
+
+void ExpectNoErrors(const ValidatingBackend& backend)
+{
+	EXPECT_EQ(backend.errors.size(), 0u);
+	if (!backend.errors.empty())
+		Test::Fail(__FILE__, __LINE__, backend.errors.front());
+}
+
+bool SameBarrier(const GraphBarrier& barrier, GraphBarrierType type, GraphBarrierSplit split, RenderGraph::ResourceHandle resource, uint32_t before, uint32_t after)
+{
+	return barrier.type == type && barrier.split == split && barrier.resource == resource && barrier.before == before && barrier.after == after;
+}
+}
+
+TEST(RenderGraph, CullsUnusedPassesAndMergesReads)
+{
+	RenderGraph graph;
+	const auto backBuffer = graph.ImportResource("BackBuffer", nullptr, GraphState::present, GraphState::present);
+	const auto shadow = graph.ImportResource("Shadow", nullptr, GraphState::pixelShaderResource, GraphState::pixelShaderResource);
+	const auto debug = graph.DeclareVirtual("Debug");
+	std::vector<std::string> executed;
+	const auto Record = [&executed](const char* name) { return [&executed, name] { executed.emplace_back(name); }; };
+	const auto shadowPass = graph.AddPass("Shadow", Record("Shadow"));
+	graph.Write(shadowPass, shadow, GraphState::depthWrite);
+	const auto lighting = graph.AddPass("Lighting", Record("Lighting"));
+	graph.Read(lighting, shadow, GraphState::pixelShaderResource);
+	graph.Write(lighting, backBuffer, GraphState::renderTarget);
+	const auto unused = graph.AddPass("Unused", Record("Unused"));
+	graph.Read(unused, shadow, GraphState::pixelShaderResource);
+	graph.Write(unused, debug, GraphState::renderTarget);
+	const auto post = graph.AddPass("Post", Record("Post"));
+	graph.Read(post, shadow, GraphState::nonPixelShaderResource);
+	graph.Write(post, backBuffer, GraphState::renderTarget);
+	graph.Compile();
+
+	// ֻдʹõԴpass޳
+	EXPECT_TRUE(graph.IsCulled(unused));
+	EXPECT_FALSE(graph.IsCulled(post));
+	ASSERT_EQ(graph.GetExecutionOrder().size(), 3u);
+	EXPECT_EQ(graph.GetExecutionOrder()[1], lighting);
+	EXPECT_EQ(graph.GetExecutionOrder()[2], post);
+
+	// 󻺳ת֡ʼֵһд룻ֻʺϲΪһת֡ʱص״̬
+	ASSERT_EQ(graph.GetBarriers(0).size(), 2u);
+	EXPECT_TRUE(SameBarrier(graph.GetBarriers(0)[0], GraphBarrierType::transition, GraphBarrierSplit::begin, backBuffer, GraphState::present, GraphState::renderTarget));
+	EXPECT_TRUE(SameBarrier(graph.GetBarriers(0)[1], GraphBarrierType::transition, GraphBarrierSplit::none, shadow, GraphState::pixelShaderResource, GraphState::depthWrite));
+	ASSERT_EQ(graph.GetBarriers(1).size(), 2u);
+	EXPECT_TRUE(SameBarrier(graph.GetBarriers(1)[0], GraphBarrierType::transition, GraphBarrierSplit::end, backBuffer, GraphState::present, GraphState::renderTarget));
+	EXPECT_TRUE(SameBarrier(graph.GetBarriers(1)[1], GraphBarrierType::transition, GraphBarrierSplit::none, shadow, GraphState::depthWrite, GraphState::shaderResource));
+	EXPECT_EQ(graph.GetBarriers(2).size(), 0u);
+	ASSERT_EQ(graph.GetFinalBarriers().size(), 2u);
+	EXPECT_TRUE(SameBarrier(graph.GetFinalBarriers()[0], GraphBarrierType::transition, GraphBarrierSplit::none, backBuffer, GraphState::renderTarget, GraphState::present));
+	EXPECT_TRUE(SameBarrier(graph.GetFinalBarriers()[1], GraphBarrierType::transition, GraphBarrierSplit::none, shadow, GraphState::shaderResource, GraphState::pixelShaderResource));
+	EXPECT_EQ(graph.GetBarrierCount(), 6u);
+
+	ValidatingBackend backend(graph, { { "Shadow", { { shadow, GraphState::depthWrite, true } } },
+		{ "Lighting", { { shadow, GraphState::pixelShaderResource, false }, { backBuffer, GraphState::renderTarget, true } } },
+		{ "Post", { { shadow, GraphState::nonPixelShaderResource, false }, { backBuffer, GraphState::renderTarget, true } } } });
+	backend.Import(backBuffer, GraphState::present);
+	backend.Import(shadow, GraphState::pixelShaderResource);
+	graph.Execute(backend);
+	ExpectNoErrors(backend);
+	backend.CheckFinal(backBuffer, GraphState::present);
+	backend.CheckFinal(shadow, GraphState::pixelShaderResource);
+	// ޳passִУûϵλòύ
+	EXPECT_EQ(executed, (std::vector<std::string>{ "Shadow", "Lighting", "Post" }));
+	EXPECT_EQ(backend.passes, executed);
+	EXPECT_EQ(backend.endCount, 3u);
+	EXPECT_EQ(backend.submitCount, 3u);
+	EXPECT_EQ(backend.log.size(), 6u);
+}
+
+TEST(RenderGraph, UavBarriersBetweenUnorderedAccesses)
+{
+	RenderGraph graph;
+	const auto particles = graph.ImportResource("Particles", nullptr, GraphState::unorderedAccess, GraphState::unorderedAccess);
+	const auto output = graph.ImportResource("Output", nullptr, GraphState::renderTarget, GraphState::renderTarget);
+	const auto emit = graph.AddPass("Emit", nullptr);
+	graph.Write(emit, particles, GraphState::unorderedAccess);
+	const auto simulate = graph.AddPass("Simulate", nullptr);
+	graph.Write(simulate, particles, GraphState::unorderedAccess);
+	const auto count = graph.AddPass("Count", nullptr);
+	graph.Read(count, particles, GraphState::unorderedAccess);
+	graph.Write(count, output, GraphState::renderTarget);
+	graph.Compile();
+	// һη֮ǰҪUAVϣ֮ÿη֮ǰһ
+	EXPECT_EQ(graph.GetBarriers(0).size(), 0u);
+	ASSERT_EQ(graph.GetBarriers(1).size(), 1u);
+	EXPECT_TRUE(SameBarrier(graph.GetBarriers(1)[0], GraphBarrierType::uav, GraphBarrierSplit::none, particles, GraphState::unorderedAccess, GraphState::unorderedAccess));
+	ASSERT_EQ(graph.GetBarriers(2).size(), 1u);
+	EXPECT_EQ(graph.GetBarriers(2)[0].type, GraphBarrierType::uav);
+	EXPECT_EQ(graph.GetBarrierCount(), 2u);
+}
+
+TEST(RenderGraph, TransientResourcesAlias)
+{
+	RenderGraph graph;
+	const auto output = graph.ImportResource("Output", nullptr, GraphState::renderTarget, GraphState::renderTarget);
+	const auto first = graph.DeclareTransient("First", 1000, 256, TransientHeapType::renderTarget);
+	const auto second = graph.DeclareTransient("Second", 900, 512, TransientHeapType::renderTarget);
+	const auto unused = graph.DeclareTransient("Unused", 4096, 256, TransientHeapType::texture);
+	const auto writeFirst = graph.AddPass("WriteFirst", nullptr);
+	graph.Write(writeFirst, first, GraphState::renderTarget);
+	const auto useFirst = graph.AddPass("UseFirst", nullptr);
+	graph.Read(useFirst, first, GraphState::pixelShaderResource);
+	graph.Write(useFirst, output, GraphState::renderTarget);
+	const auto writeUnused = graph.AddPass("WriteUnused", nullptr);
+	graph.Write(writeUnused, unused, GraphState::renderTarget);
+	const auto writeSecond = graph.AddPass("WriteSecond", nullptr);
+	graph.Write(writeSecond, second, GraphState::renderTarget);
+	const auto useSecond = graph.AddPass("UseSecond", nullptr);
+	graph.Read(useSecond, second, GraphState::pixelShaderResource);
+	graph.Write(useSecond, output, GraphState::renderTarget);
+	graph.Compile();
+
+	EXPECT_TRUE(graph.IsCulled(writeUnused));
+	EXPECT_FALSE(graph.IsPlaced(unused));
+	EXPECT_THROW(graph.GetPlacement(unused), std::runtime_error);
+	ASSERT_TRUE(graph.IsPlaced(first));
+	ASSERT_TRUE(graph.IsPlaced(second));
+	// ڲཻͬһڴ棬ѵĴСȡнϴ
+	EXPECT_EQ(graph.GetPlacement(first).offset, graph.GetPlacement(second).offset);
+	EXPECT_EQ(graph.GetAliasingPlanner().GetHeapSize(TransientHeapType::renderTarget), 1000u);
+	EXPECT_EQ(graph.GetAliasingPlanner().GetHeapSize(TransientHeapType::texture), 0u);
+	// λڽڴpass֮ǰ˲̬Դ״̬ת
+	ASSERT_EQ(graph.GetExecutionOrder().size(), 4u);
+	ASSERT_EQ(graph.GetBarriers(2).size(), 1u);
+	const GraphBarrier& aliasing = graph.GetBarriers(2)[0];
+	EXPECT_EQ(aliasing.type, GraphBarrierType::aliasing);
+	EXPECT_EQ(aliasing.resource, second);
+	EXPECT_EQ(aliasing.aliasBefore, first);
+	// λеĵһԴһ֡second
+	ASSERT_EQ(graph.GetBarriers(0).size(), 1u);
+	const GraphBarrier& wrap = graph.GetBarriers(0)[0];
+	EXPECT_EQ(wrap.type, GraphBarrierType::aliasing);
+	EXPECT_EQ(wrap.resource, first);
+	EXPECT_EQ(wrap.aliasBefore, GraphBarrier::anyResource);
+	EXPECT_EQ(graph.GetBarrierCount(), 2u);
+
+	int placed = 0;
+	graph.SetNative(second, &placed);
+	EXPECT_EQ(graph.GetNative(second), static_cast<void*>(&placed));
+}
+
+TEST(RenderGraph, RejectsInvalidDeclarations)
+{
+	RenderGraph graph;
+	const auto target = graph.ImportResource("Target", nullptr, GraphState::common, GraphState::common);
+	const auto pass = graph.AddPass("Pass", nullptr);
+	graph.Read(pass, target, GraphState::pixelShaderResource);
+	graph.Read(pass, target, GraphState::nonPixelShaderResource);
+	EXPECT_THROW(graph.Write(pass, target, GraphState::renderTarget), std::runtime_error);
+	const auto writer = graph.AddPass("Writer", nullptr);
+	graph.Write(writer, target, GraphState::renderTarget);
+	EXPECT_THROW(graph.Read(writer, target, GraphState::pixelShaderResource), std::runtime_error);
+	ValidatingBackend backend(graph, {});
+	EXPECT_THROW(graph.Execute(backend), std::runtime_error);
+
+	// ˲̬Դڵһд֮ǰδ
+	graph.Reset();
+	const auto output = graph.ImportResource("Output", nullptr, GraphState::common, GraphState::common);
+	const auto transient = graph.DeclareTransient("Transient", 256, 256, TransientHeapType::texture);
+	const auto reader = graph.AddPass("Reader", nullptr);
+	graph.Read(reader, transient, GraphState::pixelShaderResource);
+	graph.Write(reader, output, GraphState::renderTarget);
+	EXPECT_THROW(graph.Compile(), std::runtime_error);
+}
+
+TEST(RenderGraph, RandomGraphsKeepDependenciesAndStates)
+{
+	const uint32_t readStates[] = { GraphState::pixelShaderResource, GraphState::nonPixelShaderResource, GraphState::copySource, GraphState::depthRead, GraphState::unorderedAccess };
+	const uint32_t writeStates[] = { GraphState::renderTarget, GraphState::unorderedAccess, GraphState::depthWrite, GraphState::copyDest };
+	const uint32_t frameStates[] = { GraphState::common, GraphState::pixelShaderResource, GraphState::renderTarget, GraphState::unorderedAccess };
+	constexpr uint32_t importedCount = 5;
+	std::mt19937 rng(5);
+	for (uint32_t iteration = 0; iteration < 300; ++iteration)
+	{
+		RenderGraph graph;
+		RenderGraph::ResourceHandle resources[importedCount];
+		uint32_t initialStates[importedCount];
+		uint32_t finalStates[importedCount];
+		for (uint32_t i = 0; i < importedCount; ++i)
+		{
+			initialStates[i] = frameStates[rng() % std::size(frameStates)];
+			finalStates[i] = frameStates[rng() % std::size(frameStates)];
+			resources[i] = graph.ImportResource("Imported" + std::to_string(i), nullptr, initialStates[i], finalStates[i]);
+		}
+		const auto scratch = graph.DeclareVirtual("Scratch");
+
+		// ÿpassʼͬĵԴpass޸Դ
+		std::map<std::string, std::vector<DeclaredAccess>> accesses;
+		std::vector<bool> writesImported;
+		std::vector<bool> writesScratch;
+		std::vector<uint32_t> executed;
+		const uint32_t passCount = 4 + rng() % 12;
+		for (uint32_t p = 0; p < passCount; ++p)
+		{
+			const std::string name = "Pass" + std::to_string(p);
+			const auto pass = graph.AddPass(name, [&executed, p] { executed.push_back(p); });
+			uint32_t chosen[importedCount];
+			for (uint32_t i = 0; i < importedCount; ++i)
+				chosen[i] = i;
+			std::shuffle(std::begin(chosen), std::end(chosen), rng);
+			const uint32_t accessCount = 1 + rng() % 3;
+			for (uint32_t a = 0; a < accessCount; ++a)
+			{
+				const bool write = rng() % 2 == 0;
+				const uint32_t state = write ? writeStates[rng() % std::size(writeStates)] : readStates[rng() % std::size(readStates)];
+				if (write)
+					graph.Write(pass, resources[chosen[a]], state);
+				else
+					graph.Read(pass, resources[chosen[a]], state);
+				accesses[name].push_back({ resources[chosen[a]], state, write });
+				if (a == 0)
+					writesImported.push_back(write);
+				else
+					writesImported.back() = writesImported.back() || write;
+			}
+			writesScratch.push_back(rng() % 4 == 0);
+			if (writesScratch.back())
+				graph.Write(pass, scratch, GraphState::common);
+		}
+		graph.Compile();
+
+		// д뵼ԴpassǱʹãԴһ汾ʹã޸passֻںд޸ʱʹ
+		std::vector<bool> expectAlive(passCount);
+		bool scratchNeeded = false;
+		for (uint32_t p = passCount; p-- > 0;)
+		{
+			expectAlive[p] = writesImported[p] || (writesScratch[p] && scratchNeeded);
+			scratchNeeded = scratchNeeded || (writesScratch[p] && expectAlive[p]);
+		}
+
+		std::vector<uint32_t> position(passCount, ~0u);
+		const auto& order = graph.GetExecutionOrder();
+		for (uint32_t idx = 0; idx < order.size(); ++idx)
+			position[order[idx]] = idx;
+		for (uint32_t p = 0; p < passCount; ++p)
+		{
+			ASSERT_EQ(graph.IsCulled(p), !expectAlive[p]);
+			ASSERT_EQ(position[p] != ~0u, expectAlive[p]);
+		}
+		// ͬһԴηдʱִ˳˳ͬ
+		for (uint32_t a = 0; a < passCount; ++a)
+		{
+			for (uint32_t b = a + 1; b < passCount; ++b)
+			{
+				if (!expectAlive[a] || !expectAlive[b])
+					continue;
+				for (const DeclaredAccess& first : accesses["Pass" + std::to_string(a)])
+				{
+					for (const DeclaredAccess& second : accesses["Pass" + std::to_string(b)])
+					{
+						if (first.resource == second.resource && (first.write || second.write))
+							ASSERT_LT(position[a], position[b]);
+					}
+				}
+			}
+		}
+
+		ValidatingBackend backend(graph, accesses);
+		for (uint32_t i = 0; i < importedCount; ++i)
+			backend.Import(resources[i], initialStates[i]);
+		graph.Execute(backend);
+		for (uint32_t i = 0; i < importedCount; ++i)
+			backend.CheckFinal(resources[i], finalStates[i]);
+		ASSERT_EQ(backend.errors.size(), 0u);
+		ASSERT_EQ(executed.size(), order.size());
+		for (uint32_t idx = 0; idx < order.size(); ++idx)
+			ASSERT_EQ(executed[idx], order[idx]);
+		EXPECT_EQ(backend.log.size(), graph.GetBarrierCount());
+	}
+}
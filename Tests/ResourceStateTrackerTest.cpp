@@ -0,0 +1,405 @@
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "TestFramework.h"
+#include "ResourceStateTracker.h"
+#include "RenderGraph.h"
+
+using namespace GraphState;
+
+namespace
+{
+// ¼ύϣÿSubmitΪһ
+class RecordingSink : public BarrierSink
+{
+public:
+	void Submit(const StateBarrier* barriers, uint32_t count) override
+	{
+		batches.emplace_back(barriers, barriers + count);
+	}
+
+	std::vector<StateBarrier> All() const
+	{
+		std::vector<StateBarrier> all;
+		for (const auto& batch : batches)
+		{
+			all.insert(all.end(), batch.begin(), batch.end());
+		}
+		return all;
+	}
+
+	std::vector<std::vector<StateBarrier>>	batches;
+};
+
+/*
+ * ģGPUϵԴ״ִ̬˳ӦϲУ
+ * 1. תbeforeԴʵ״̬תҪԴbefore
+ * 2. beforeafterͬת
+ */
+class GpuModel
+{
+public:
+	explicit GpuModel(std::vector<std::vector<uint32_t>> states)
+	: states(std::move(states))
+	{
+	}
+
+	void Apply(const StateBarrier& barrier, const std::string& context)
+	{
+		if (barrier.type == StateBarrierType::uav)
+			return;
+		auto& subs = states[Index(barrier.resource)];
+		if (barrier.before == barrier.after)
+			errors.push_back(context + ": redundant transition");
+		if (barrier.subresource == allSubresources)
+		{
+			if (std::any_of(subs.begin(), subs.end(), [&barrier](uint32_t state) { return state != barrier.before; }))
+				errors.push_back(context + ": whole transition from a wrong state");
+			std::fill(subs.begin(), subs.end(), barrier.after);
+			return;
+		}
+		if (barrier.subresource >= subs.size())
+		{
+			errors.push_back(context + ": subresource out of range");
+			return;
+		}
+		if (subs[barrier.subresource] != barrier.before)
+			errors.push_back(context + ": subresource transition from a wrong state " + std::to_string(Index(barrier.resource)) + "/" + std::to_string(barrier.subresource) + " " + std::to_string(barrier.before) + "->" + std::to_string(barrier.after) + " actual " + std::to_string(subs[barrier.subresource]));
+		subs[barrier.subresource] = barrier.after;
+	}
+
+	static size_t Index(void* resource)
+	{
+		return reinterpret_cast<size_t>(resource) - 1;
+	}
+
+	std::vector<std::vector<uint32_t>>	states;
+	std::vector<std::string>			errors;
+};
+
+void* Resource(size_t idx)
+{
+	return reinterpret_cast<void*>(idx + 1);
+}
+
+// ба˳¼һϣһҪԴĳ״̬ķ
+struct ListEvent
+{
+	std::vector<StateBarrier>	barriers;
+	void*						resource{ nullptr };
+	uint32_t					subresource{ 0 };
+	uint32_t					expected{ 0 };
+};
+
+class ListSink : public BarrierSink
+{
+public:
+	explicit ListSink(std::vector<ListEvent>& events)
+	: m_events(events)
+	{
+	}
+
+	void Submit(const StateBarrier* barriers, uint32_t count) override
+	{
+		ListEvent event;
+		event.barriers.assign(barriers, barriers + count);
+		m_events.push_back(std::move(event));
+	}
+private:
+	std::vector<ListEvent>&	m_events;
+};
+}
+
+TEST(ResourceStateTracker, DropsRedundantAndMergesBatchedTransitions)
+{
+	ResourceStateTracker tracker;
+	void* texture = Resource(0);
+	void* buffer = Resource(1);
+	tracker.Transition(texture, common, renderTarget);
+	tracker.Transition(texture, renderTarget, shaderResource);
+	ASSERT_EQ(tracker.GetPendingCount(), 1u);
+	// Ѵںϲֻ״̬ȡһֲҪת
+	tracker.Transition(texture, shaderResource, pixelShaderResource);
+	EXPECT_EQ(tracker.GetState(texture).value(), shaderResource);
+	// תοʼʱ״̬ת໥
+	tracker.Transition(texture, shaderResource, common);
+	EXPECT_EQ(tracker.GetPendingCount(), 0u);
+	EXPECT_EQ(tracker.GetDroppedCount(), 3u);
+	tracker.UAVBarrier(buffer);
+	tracker.UAVBarrier(buffer);
+	EXPECT_EQ(tracker.GetPendingCount(), 1u);
+	EXPECT_FALSE(tracker.GetState(buffer).has_value());
+
+	RecordingSink sink;
+	tracker.Flush(sink);
+	tracker.Flush(sink);
+	ASSERT_EQ(sink.batches.size(), 1u);
+	ASSERT_EQ(sink.batches[0].size(), 1u);
+	EXPECT_TRUE(sink.batches[0][0].type == StateBarrierType::uav);
+	EXPECT_EQ(tracker.GetSubmittedCount(), 1u);
+
+	// Ѿύ֮ת֮ϲ
+	tracker.Transition(texture, common, copyDest);
+	tracker.Flush(sink);
+	tracker.Transition(texture, copyDest, copySource);
+	tracker.UAVBarrier(texture);
+	tracker.Transition(texture, copySource, unorderedAccess);
+	EXPECT_EQ(tracker.GetPendingCount(), 3u);
+	tracker.Flush(sink);
+	const auto all = sink.All();
+	ASSERT_EQ(all.size(), 5u);
+	EXPECT_EQ(all[1].before, common);
+	EXPECT_EQ(all[1].after, copyDest);
+	EXPECT_EQ(all[2].before, copyDest);
+	EXPECT_EQ(all[2].after, copySource);
+	EXPECT_EQ(all[4].before, copySource);
+	EXPECT_EQ(all[4].after, unorderedAccess);
+
+	tracker.Reset();
+	EXPECT_FALSE(tracker.GetState(texture).has_value());
+	EXPECT_EQ(tracker.GetSubmittedCount(), 0u);
+}
+
+TEST(ResourceStateTracker, TracksSubresourcesSeparately)
+{
+	ResourceStateTracker tracker;
+	void* texture = Resource(0);
+	tracker.TransitionSubresource(texture, 1, 4, common, renderTarget);
+	EXPECT_EQ(tracker.GetState(texture, 1).value(), renderTarget);
+	EXPECT_FALSE(tracker.GetState(texture, 0).has_value());
+	EXPECT_FALSE(tracker.GetState(texture).has_value());
+	EXPECT_THROW(tracker.TransitionSubresource(texture, 4, 4, common, renderTarget), std::runtime_error);
+	// תԴУֻиԴһתϲ
+	tracker.Transition(texture, common, shaderResource);
+	EXPECT_EQ(tracker.GetPendingCount(), 5u);
+	EXPECT_EQ(tracker.GetState(texture).value(), shaderResource);
+	// Դ״̬һºתֻһ
+	tracker.Transition(texture, shaderResource, common);
+	EXPECT_EQ(tracker.GetPendingCount(), 6u);
+	RecordingSink sink;
+	tracker.Flush(sink);
+	GpuModel gpu({ { common, common, common, common } });
+	for (const auto& barrier : sink.All())
+	{
+		gpu.Apply(barrier, "subresources");
+	}
+	EXPECT_TRUE(gpu.errors.empty());
+	EXPECT_TRUE(gpu.states[0] == std::vector<uint32_t>(4, common));
+	EXPECT_EQ(sink.All().back().subresource, allSubresources);
+
+	// ״̬иԴ״̬ͬʱһתԴ
+	ResourceStateTable table;
+	table.Set(texture, { renderTarget, shaderResource, shaderResource, shaderResource });
+	ResourceStateTracker fresh(&table);
+	fresh.Transition(texture, common, pixelShaderResource);
+	ASSERT_EQ(fresh.GetPendingCount(), 1u);
+	RecordingSink freshSink;
+	fresh.Flush(freshSink);
+	EXPECT_EQ(freshSink.All()[0].subresource, 0u);
+	EXPECT_EQ(freshSink.All()[0].before, renderTarget);
+	EXPECT_EQ(fresh.GetDroppedCount(), 3u);
+}
+
+TEST(ResourceStateTracker, ResolvePatchesAssumedStatesAndUpdatesTable)
+{
+	ResourceStateTable table;
+	void* texture = Resource(0);
+	void* external = Resource(1);
+	void* unknown = Resource(2);
+	table.Set(texture, { copyDest });
+	table.Set(external, { common });
+
+	// ¼ʱ״̬лûм¼÷ٶ״̬ת
+	ResourceStateTracker tracker;
+	tracker.Transition(texture, common, renderTarget);
+	RecordingSink sink;
+	EXPECT_THROW(tracker.Resolve(table, sink), std::runtime_error);
+	tracker.Flush(sink);
+	// ֡ͼ¼Ƶתֻ¸ٵ״̬
+	tracker.NoteTransition(external, renderTarget, pixelShaderResource);
+	EXPECT_EQ(tracker.GetPendingCount(), 0u);
+	EXPECT_EQ(tracker.GetState(external).value(), pixelShaderResource);
+	tracker.UAVBarrier(unknown);
+	tracker.Flush(sink);
+
+	RecordingSink fixups;
+	EXPECT_EQ(tracker.Resolve(table, fixups), 2u);
+	ASSERT_EQ(fixups.batches.size(), 1u);
+	const auto& patch = fixups.batches[0];
+	ASSERT_EQ(patch.size(), 2u);
+	EXPECT_EQ(patch[0].resource, texture);
+	EXPECT_EQ(patch[0].before, copyDest);
+	EXPECT_EQ(patch[0].after, common);
+	EXPECT_EQ(patch[1].resource, external);
+	EXPECT_EQ(patch[1].before, common);
+	EXPECT_EQ(patch[1].after, renderTarget);
+	// бʱ״̬д״ֻ̬UAVϵԴ״̬
+	EXPECT_TRUE(table.Find(texture).value() == std::vector<uint32_t>{ renderTarget });
+	EXPECT_TRUE(table.Find(external).value() == std::vector<uint32_t>{ pixelShaderResource });
+	EXPECT_FALSE(table.Find(unknown).has_value());
+	EXPECT_EQ(table.GetResourceCount(), 2u);
+
+	// ֮б״̬Ϊ׼Ҫ
+	ResourceStateTracker next(&table);
+	next.Transition(texture, common, copySource);
+	RecordingSink nextSink;
+	next.Flush(nextSink);
+	EXPECT_EQ(nextSink.All()[0].before, renderTarget);
+	RecordingSink nextFixups;
+	EXPECT_EQ(next.Resolve(table, nextFixups), 0u);
+	EXPECT_TRUE(nextFixups.batches.empty());
+	table.Invalidate(texture);
+	EXPECT_FALSE(table.Find(texture).has_value());
+	table.Clear();
+	EXPECT_EQ(table.GetResourceCount(), 0u);
+}
+
+TEST(ResourceStateTracker, RandomParallelListsKeepGpuStatesValid)
+{
+	// ÿֲ¼б(¼ƿʼʱ״̬)ٰύ˳ResolveִУб֮ǰ
+	constexpr uint32_t states[] = { common, renderTarget, unorderedAccess, copyDest, copySource, pixelShaderResource, nonPixelShaderResource, shaderResource,
+		pixelShaderResource | copySource, depthWrite };
+	constexpr size_t resourceCount = 12;
+	std::mt19937 rng(99);
+	const auto RandomState = [&rng, &states]() { return states[rng() % std::size(states)]; };
+
+	std::vector<std::vector<uint32_t>> initial(resourceCount);
+	for (size_t idx = 0; idx < resourceCount; ++idx)
+	{
+		initial[idx].assign(idx % 3 == 0 ? 4 : 1, common);
+		for (auto& state : initial[idx])
+		{
+			state = RandomState();
+		}
+	}
+	GpuModel gpu(initial);
+	ResourceStateTable table;
+	// һԴ״̬м¼
+	for (size_t idx = 0; idx < resourceCount; idx += 2)
+	{
+		table.Set(Resource(idx), gpu.states[idx]);
+	}
+
+	uint32_t totalFixups = 0;
+	for (uint32_t round = 0; round < 400; ++round)
+	{
+		// ÷ֻֿ֪ʼʱ״̬
+		const std::vector<std::vector<uint32_t>> known = gpu.states;
+		std::vector<bool> inTable(resourceCount);
+		for (size_t idx = 0; idx < resourceCount; ++idx)
+		{
+			// Դδ֪ʱ÷ЩԴȷļٶ״̬
+			const auto recorded = table.Find(Resource(idx));
+			inTable[idx] = recorded && std::find(recorded->begin(), recorded->end(), unknownState) == recorded->end();
+		}
+		const uint32_t listCount = 1 + rng() % 3;
+		std::vector<std::vector<ListEvent>> lists(listCount);
+		std::vector<ResourceStateTracker> trackers;
+		for (uint32_t list = 0; list < listCount; ++list)
+		{
+			trackers.emplace_back(&table);
+		}
+		for (uint32_t list = 0; list < listCount; ++list)
+		{
+			ResourceStateTracker& tracker = trackers[list];
+			ListSink sink(lists[list]);
+			const uint32_t opCount = rng() % 24;
+			for (uint32_t op = 0; op < opCount; ++op)
+			{
+				const size_t idx = rng() % resourceCount;
+				void* resource = Resource(idx);
+				const auto& subs = known[idx];
+				const bool uniform = std::all_of(subs.begin(), subs.end(), [&subs](uint32_t state) { return state == subs.front(); });
+				const uint32_t after = RandomState();
+				const uint32_t kind = rng() % 8;
+				if (kind == 0)
+				{
+					tracker.UAVBarrier(resource);
+				}
+				else if (kind == 1 && subs.size() == 1)
+				{
+					// ⲿ¼ƵתbeforeΪǰ״ֿ̬ʼʱ״̬
+					tracker.Flush(sink);
+					const uint32_t before = tracker.GetState(resource).value_or(inTable[idx] ? table.Find(resource)->front() : subs.front());
+					if (before != after)
+					{
+						tracker.NoteTransition(resource, before, after);
+						ListEvent event;
+						event.barriers.push_back({ StateBarrierType::transition, resource, allSubresources, before, after });
+						lists[list].push_back(std::move(event));
+					}
+				}
+				else if (subs.size() > 1 && (kind < 4 || (!uniform && !inTable[idx])))
+				{
+					const uint32_t sub = rng() % subs.size();
+					tracker.TransitionSubresource(resource, sub, static_cast<uint32_t>(subs.size()), subs[sub], after);
+				}
+				else if (uniform || inTable[idx])
+				{
+					tracker.Transition(resource, subs.front(), after);
+				}
+				// ǰύϣٵ״̬GPUϵ״̬һ
+				if (rng() % 2 == 0)
+				{
+					tracker.Flush(sink);
+					for (uint32_t sub = 0; sub < subs.size(); ++sub)
+					{
+						const auto state = subs.size() == 1 ? tracker.GetState(resource) : tracker.GetState(resource, sub);
+						if (!state)
+							continue;
+						ListEvent access;
+						access.resource = resource;
+						access.subresource = sub;
+						access.expected = *state;
+						lists[list].push_back(access);
+					}
+				}
+			}
+			tracker.Flush(sink);
+		}
+
+		for (uint32_t list = 0; list < listCount; ++list)
+		{
+			const std::string context = "round " + std::to_string(round) + " list " + std::to_string(list);
+			RecordingSink fixups;
+			totalFixups += trackers[list].Resolve(table, fixups);
+			for (const auto& barrier : fixups.All())
+			{
+				gpu.Apply(barrier, context + " fixup");
+			}
+			for (const ListEvent& event : lists[list])
+			{
+				for (const auto& barrier : event.barriers)
+				{
+					gpu.Apply(barrier, context);
+				}
+				if (event.resource && gpu.states[GpuModel::Index(event.resource)][event.subresource] != event.expected)
+					gpu.errors.push_back(context + ": access in a wrong state");
+			}
+		}
+		// ״̬֪ļ¼GPUϵ״̬һ
+		for (size_t idx = 0; idx < resourceCount; ++idx)
+		{
+			const auto recorded = table.Find(Resource(idx));
+			if (!recorded)
+				continue;
+			const auto& actual = gpu.states[idx];
+			for (size_t sub = 0; sub < actual.size(); ++sub)
+			{
+				const uint32_t state = recorded->size() == 1 ? recorded->front() : (*recorded)[sub];
+				if (state != unknownState && state != actual[sub])
+					gpu.errors.push_back("round " + std::to_string(round) + ": table disagrees with the GPU");
+			}
+		}
+		if (!gpu.errors.empty())
+			break;
+	}
+	for (const auto& error : gpu.errors)
+	{
+		Test::Fail(__FILE__, __LINE__, error);
+	}
+	// ¼ƵбȷʵҪ
+	EXPECT_GT(totalFixups, 0u);
+}
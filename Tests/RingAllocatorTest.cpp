@@ -0,0 +1,192 @@
+#include <deque>
+#include <random>
+#include <vector>
+#include "TestFramework.h"
+#include "RingAllocator.hpp"
+
+namespace
+{
+constexpr uint64_t invalid = RingAllocator::invalidOffset;
+
+struct Range
+{
+	uint64_t	begin;
+	uint64_t	end;
+};
+
+// һ֡ڵȫύʱΧֵ
+struct InFlightFrame
+{
+	uint64_t			fence;
+	std::vector<Range>	ranges;
+};
+
+bool Overlaps(const Range& a, const Range& b)
+{
+	return a.begin < b.end && b.begin < a.end;
+}
+}
+
+TEST(RingAllocator, WrapsAroundAfterReclaim)
+{
+	RingAllocator ring(1024);
+	EXPECT_EQ(ring.Allocate(400, 1), 0u);
+	ring.FinishFrame(1);
+	EXPECT_EQ(ring.Allocate(400, 1), 400u);
+	ring.FinishFrame(2);
+	EXPECT_EQ(ring.GetUsedSize(), 800u);
+
+	// βֻʣ224ֽڣһ֡պ䣬Ļβ뵱ǰ֡
+	ring.Reclaim(1);
+	EXPECT_EQ(ring.GetUsedSize(), 400u);
+	EXPECT_EQ(ring.Allocate(400, 1), 0u);
+	EXPECT_EQ(ring.GetUsedSize(), 1024u);
+	ring.FinishFrame(3);
+
+	ring.Reclaim(2);
+	EXPECT_EQ(ring.GetUsedSize(), 624u);
+	EXPECT_EQ(ring.Allocate(400, 1), 400u);
+	ring.FinishFrame(4);
+	ring.Reclaim(4);
+	EXPECT_EQ(ring.GetUsedSize(), 0u);
+	// Ϊպص
+	EXPECT_EQ(ring.Allocate(1024, 1), 0u);
+}
+
+TEST(RingAllocator, AlignmentPaddingAtTheEndOfTheRing)
+{
+	RingAllocator ring(1024);
+	EXPECT_EQ(ring.Allocate(10, 1), 0u);
+	EXPECT_EQ(ring.Allocate(16, 64), 64u);
+	EXPECT_EQ(ring.GetUsedSize(), 80u);
+	EXPECT_EQ(ring.Allocate(220, 1), 80u);
+	ring.FinishFrame(1);
+	EXPECT_EQ(ring.Allocate(500, 1), 300u);
+	ring.FinishFrame(2);
+	ring.Reclaim(1);
+	EXPECT_EQ(ring.GetUsedSize(), 500u);
+
+	// 800뵽256Խβص㣬뻷β224ֽһ֡
+	EXPECT_EQ(ring.Allocate(100, 256), 0u);
+	EXPECT_EQ(ring.GetUsedSize(), 824u);
+	// 󳬳βָķʧܣıôС
+	EXPECT_EQ(ring.Allocate(64, 256), invalid);
+	EXPECT_EQ(ring.GetUsedSize(), 824u);
+	EXPECT_EQ(ring.Allocate(32, 256), 256u);
+	EXPECT_EQ(ring.GetUsedSize(), 1012u);
+	ring.FinishFrame(3);
+
+	// ʱβָ밴֡СǰǡԽ
+	ring.Reclaim(2);
+	EXPECT_EQ(ring.GetUsedSize(), 512u);
+	ring.Reclaim(3);
+	EXPECT_EQ(ring.GetUsedSize(), 0u);
+}
+
+TEST(RingAllocator, ReclaimWaitsForTheFence)
+{
+	RingAllocator ring(256);
+	EXPECT_EQ(ring.Allocate(64, 1), 0u);
+	ring.FinishFrame(5);
+	EXPECT_EQ(ring.Allocate(64, 1), 64u);
+	ring.FinishFrame(7);
+	// ûз֡ռΧ¼
+	ring.FinishFrame(8);
+
+	ring.Reclaim(4);
+	EXPECT_EQ(ring.GetUsedSize(), 128u);
+	ring.Reclaim(6);
+	EXPECT_EQ(ring.GetUsedSize(), 64u);
+	// δ֡ᱻ
+	EXPECT_EQ(ring.Allocate(32, 1), 128u);
+	ring.Reclaim(100);
+	EXPECT_EQ(ring.GetUsedSize(), 32u);
+	ring.FinishFrame(9);
+	ring.Reclaim(9);
+	EXPECT_EQ(ring.GetUsedSize(), 0u);
+}
+
+TEST(RingAllocator, FullRingReturnsFailure)
+{
+	RingAllocator ring(512);
+	EXPECT_EQ(ring.Allocate(0, 1), invalid);
+	EXPECT_EQ(ring.Allocate(513, 1), invalid);
+	EXPECT_EQ(ring.Allocate(512, 1), 0u);
+	EXPECT_EQ(ring.Allocate(1, 1), invalid);
+	ring.FinishFrame(1);
+	EXPECT_EQ(ring.Allocate(1, 1), invalid);
+	EXPECT_EQ(ring.GetUsedSize(), 512u);
+
+	ring.Reclaim(0);
+	EXPECT_EQ(ring.Allocate(1, 1), invalid);
+	ring.Reclaim(1);
+	EXPECT_EQ(ring.Allocate(256, 1), 0u);
+	EXPECT_EQ(ring.Allocate(256, 1), 256u);
+	EXPECT_EQ(ring.Allocate(1, 1), invalid);
+	EXPECT_EQ(ring.GetCapacity(), 512u);
+}
+
+TEST(RingAllocator, InFlightFramesNeverOverlap)
+{
+	constexpr uint64_t capacity = 32 * 1024;
+	constexpr uint32_t framesInFlight = 3;
+	RingAllocator ring(capacity);
+	std::deque<InFlightFrame> inFlight;
+	std::mt19937 rng(2024);
+	uint64_t fence = 0;
+	uint32_t failures = 0;
+	for (uint32_t frame = 0; frame < 2000; ++frame)
+	{
+		// ģCPUGPU framesInFlight֡ȴ֡ɺſʼ¼
+		if (inFlight.size() == framesInFlight)
+		{
+			ring.Reclaim(inFlight.front().fence);
+			inFlight.pop_front();
+		}
+
+		InFlightFrame current;
+		const uint32_t allocCount = 1 + rng() % 24;
+		for (uint32_t i = 0; i < allocCount; ++i)
+		{
+			const uint64_t size = 1 + rng() % 2048;
+			const uint64_t alignment = 1ULL << (rng() % 9);
+			const uint64_t usedBefore = ring.GetUsedSize();
+			const uint64_t offset = ring.Allocate(size, alignment);
+			if (offset == invalid)
+			{
+				EXPECT_EQ(ring.GetUsedSize(), usedBefore);
+				++failures;
+				continue;
+			}
+			EXPECT_EQ(offset % alignment, 0u);
+			ASSERT_LE(offset + size, capacity);
+			EXPECT_GE(ring.GetUsedSize(), usedBefore + size);
+			const Range range{ offset, offset + size };
+			for (const auto& other : inFlight)
+			{
+				for (const auto& otherRange : other.ranges)
+				{
+					ASSERT_FALSE(Overlaps(range, otherRange));
+				}
+			}
+			for (const auto& sameFrame : current.ranges)
+			{
+				ASSERT_FALSE(Overlaps(range, sameFrame));
+			}
+			current.ranges.push_back(range);
+		}
+		current.fence = ++fence;
+		ring.FinishFrame(current.fence);
+		inFlight.emplace_back(std::move(current));
+		EXPECT_LE(ring.GetUsedSize(), capacity);
+	}
+	// ƽÿ֡Լ13KB֡;ʱǷʧܵ·
+	EXPECT_GT(failures, 0u);
+
+	while (!inFlight.empty())
+	{
+		ring.Reclaim(inFlight.front().fence);
+		inFlight.pop_front();
+	}
+	EXPECT_EQ(ring.GetUsedSize(), 0u);
+}
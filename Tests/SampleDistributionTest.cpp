@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <DirectXMath.h>
+#include "TestFramework.h"
+#include "SampleDistribution.h"
+
+using namespace Effect;
+using namespace DirectX;
+
+namespace
+{
+constexpr float nearPlane = 0.5f;
+constexpr float farPlane = 1000.0f;
+
+// CameraͬķZͶӰƽӳ䵽1Զƽӳ䵽0
+struct Projection
+{
+	float	proj22;
+	float	proj32;
+};
+
+Projection MakeProjection()
+{
+	XMFLOAT4X4 proj;
+	XMStoreFloat4x4(&proj, XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, farPlane, nearPlane));
+	return { proj._33, proj._43 };
+}
+
+float ViewZToNdc(const Projection& proj, float viewZ)
+{
+	return proj.proj22 + proj.proj32 / viewZ;
+}
+
+// ϳɵȻһաһбһЩ壬оڿ
+struct DepthImage
+{
+	uint32_t			width;
+	uint32_t			height;
+	uint32_t			rowPitch;
+	std::vector<float>	ndc;
+	float				minViewZ{ FLT_MAX };
+	float				maxViewZ{ 0.0f };
+};
+
+DepthImage MakeDepth(const Projection& proj, uint32_t seed)
+{
+	DepthImage image{ 97, 61, 112 };
+	image.ndc.assign(static_cast<size_t>(image.rowPitch) * image.height, -1.0f);
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> objectZ(3.0f, 400.0f);
+	for (uint32_t y = 0; y < image.height; ++y)
+	{
+		for (uint32_t x = 0; x < image.width; ++x)
+		{
+			float& ndc = image.ndc[static_cast<size_t>(y) * image.rowPitch + x];
+			if (y < image.height / 3)
+			{
+				ndc = 0.0f;
+				continue;
+			}
+			const float viewZ = (x + y) % 11 == 0 ? objectZ(rng) : 20.0f + static_cast<float>(image.height - y) * 2.5f;
+			ndc = ViewZToNdc(proj, viewZ);
+			// ȽNDCصȣα任
+			const float roundTrip = SampleDistribution::NdcToViewZ(ndc, proj.proj22, proj.proj32);
+			image.minViewZ = std::min(image.minViewZ, roundTrip);
+			image.maxViewZ = std::max(image.maxViewZ, roundTrip);
+		}
+	}
+	return image;
+}
+
+uint32_t FloatBits(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+}
+
+TEST(SampleDistribution, ReduceDepthMatchesVisibleRange)
+{
+	const Projection proj = MakeProjection();
+	EXPECT_NEAR(SampleDistribution::NdcToViewZ(1.0f, proj.proj22, proj.proj32), nearPlane, 1e-4f);
+	EXPECT_NEAR(SampleDistribution::NdcToViewZ(ViewZToNdc(proj, 250.0f), proj.proj22, proj.proj32), 250.0f, 0.05f);
+	for (uint32_t seed : { 1u, 2u, 3u })
+	{
+		const DepthImage image = MakeDepth(proj, seed);
+		const DepthBounds bounds = SampleDistribution::ReduceDepth(image.ndc.data(), image.width, image.height, image.rowPitch, proj.proj22, proj.proj32);
+		ASSERT_TRUE(bounds.valid);
+		EXPECT_NEAR(bounds.minZ, image.minViewZ, image.minViewZ * 1e-5f);
+		EXPECT_NEAR(bounds.maxZ, image.maxViewZ, image.maxViewZ * 1e-5f);
+	}
+	// ȫΪʱЧ
+	const std::vector<float> sky(16 * 16, 0.0f);
+	EXPECT_FALSE(SampleDistribution::ReduceDepth(sky.data(), 16, 16, 16, proj.proj22, proj.proj32).valid);
+}
+
+TEST(SampleDistribution, GpuBitReductionMatchesReference)
+{
+	// ģReduceɫػuintλģʽȡֵοʵһ
+	const Projection proj = MakeProjection();
+	const DepthImage image = MakeDepth(proj, 9);
+	uint32_t minBits = SampleDistribution::clearMinBits;
+	uint32_t maxBits = SampleDistribution::clearMaxBits;
+	for (uint32_t y = 0; y < image.height; ++y)
+	{
+		for (uint32_t x = 0; x < image.width; ++x)
+		{
+			const float ndc = image.ndc[static_cast<size_t>(y) * image.rowPitch + x];
+			if (ndc <= 0.0f)
+				continue;
+			const uint32_t bits = FloatBits(SampleDistribution::NdcToViewZ(ndc, proj.proj22, proj.proj32));
+			minBits = std::min(minBits, bits);
+			maxBits = std::max(maxBits, bits);
+		}
+	}
+	const DepthBounds decoded = SampleDistribution::DecodeBounds(minBits, maxBits);
+	const DepthBounds reference = SampleDistribution::ReduceDepth(image.ndc.data(), image.width, image.height, image.rowPitch, proj.proj22, proj.proj32);
+	ASSERT_TRUE(decoded.valid);
+	EXPECT_NEAR(decoded.minZ, reference.minZ, reference.minZ * 1e-5f);
+	EXPECT_NEAR(decoded.maxZ, reference.maxZ, reference.maxZ * 1e-5f);
+	// ûдʱΪֵ
+	EXPECT_FALSE(SampleDistribution::DecodeBounds(SampleDistribution::clearMinBits, SampleDistribution::clearMaxBits).valid);
+}
+
+TEST(SampleDistribution, QuantizeIsStableAndConservative)
+{
+	std::mt19937 rng(4);
+	std::uniform_real_distribution<float> depth(0.1f, 1500.0f);
+	for (uint32_t i = 0; i < 2000; ++i)
+	{
+		DepthBounds bounds;
+		bounds.minZ = depth(rng);
+		bounds.maxZ = std::max(bounds.minZ, depth(rng));
+		bounds.valid = true;
+		const DepthBounds quantized = SampleDistribution::Quantize(bounds, nearPlane, farPlane, 8);
+		ASSERT_TRUE(quantized.valid);
+		// 룬ڽԶƽ֮
+		EXPECT_LE(quantized.minZ, std::max(bounds.minZ, nearPlane) * 1.0001f);
+		EXPECT_GE(quantized.maxZ, std::min(bounds.maxZ, farPlane) * 0.9999f);
+		EXPECT_GE(quantized.minZ, nearPlane);
+		EXPECT_LE(quantized.maxZ, farPlane);
+		EXPECT_LE(quantized.minZ, quantized.maxZ);
+		// ͬһڵ΢С仯ı
+		DepthBounds moved = bounds;
+		moved.minZ = std::max(quantized.minZ, bounds.minZ * 0.9999f);
+		moved.maxZ = std::min(quantized.maxZ, bounds.maxZ * 1.0001f);
+		const DepthBounds again = SampleDistribution::Quantize(moved, nearPlane, farPlane, 8);
+		EXPECT_EQ(again.minZ, quantized.minZ);
+		EXPECT_EQ(again.maxZ, quantized.maxZ);
+	}
+}
+
+TEST(SampleDistribution, SplitsCoverRangeMonotonically)
+{
+	DepthBounds bounds;
+	bounds.minZ = 2.0f;
+	bounds.maxZ = 512.0f;
+	bounds.valid = true;
+	float splits[5];
+	// lambdaΪ1ʱڼԶͬΪ0ʱڼȳ
+	SampleDistribution::ComputeSplits(bounds, 1.0f, 5, splits);
+	float previous = bounds.minZ;
+	for (float split : splits)
+	{
+		EXPECT_NEAR(split / previous, 3.0314331f, 1e-3f);
+		previous = split;
+	}
+	SampleDistribution::ComputeSplits(bounds, 0.0f, 5, splits);
+	previous = bounds.minZ;
+	for (float split : splits)
+	{
+		EXPECT_NEAR(split - previous, 102.0f, 1e-2f);
+		previous = split;
+	}
+	for (float lambda : { 0.25f, 0.8f })
+	{
+		SampleDistribution::ComputeSplits(bounds, lambda, 5, splits);
+		previous = bounds.minZ;
+		for (float split : splits)
+		{
+			EXPECT_GT(split, previous);
+			previous = split;
+		}
+		EXPECT_EQ(splits[4], bounds.maxZ);
+	}
+}
+
+TEST(SampleDistribution, TexelsPerPixel)
+{
+	// ۲10һظ0.0120ֱ1024ʱһtexelԼ0.0195
+	EXPECT_NEAR(SampleDistribution::TexelsPerPixel(10.0f, 0.001f, 20.0f, 1024), 0.512f, 1e-4f);
+	EXPECT_EQ(SampleDistribution::TexelsPerPixel(10.0f, 0.001f, 0.0f, 1024), 0.0f);
+}
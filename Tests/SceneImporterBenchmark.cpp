@@ -0,0 +1,70 @@
+#include <benchmark/benchmark.h>
+#include <fstream>
+#include "SceneImporter.h"
+
+using namespace Models;
+namespace fs = std::filesystem;
+
+namespace
+{
+// side * sideıε񣬰лΪ
+fs::path WriteGridObj(uint32_t side)
+{
+	const fs::path path = fs::temp_directory_path() / ("SceneImporterBenchmark_" + std::to_string(side) + ".obj");
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	for (uint32_t z = 0; z <= side; ++z)
+	{
+		for (uint32_t x = 0; x <= side; ++x)
+		{
+			stream << "v " << x << " " << ((x * 7 + z * 3) % 5) * 0.1f << " " << z << "\n";
+			stream << "vt " << static_cast<float>(x) / side << " " << static_cast<float>(z) / side << "\n";
+		}
+	}
+	for (uint32_t z = 0; z < side; ++z)
+	{
+		if (z % 16 == 0)
+			stream << "o row" << z << "\n";
+		for (uint32_t x = 0; x < side; ++x)
+		{
+			const uint32_t i = z * (side + 1) + x + 1;
+			stream << "f " << i << "/" << i << " " << i + 1 << "/" << i + 1 << " " << i + side + 2 << "/" << i + side + 2 << " " << i + side + 1 << "/" << i + side + 1 << "\n";
+		}
+	}
+	return path;
+}
+
+// assimpת
+void BM_Import(benchmark::State& state)
+{
+	const fs::path obj = WriteGridObj(static_cast<uint32_t>(state.range(0)));
+	for (auto _ : state)
+	{
+		MeshCacheData data;
+		std::string error;
+		benchmark::DoNotOptimize(SceneImporter::Import(obj, data, error));
+	}
+	fs::remove(obj);
+}
+BENCHMARK(BM_Import)->Arg(128)->Arg(512)->Unit(benchmark::kMillisecond);
+
+// лʱ·ϣԴļȡ
+void BM_HashAndLoadCache(benchmark::State& state)
+{
+	const fs::path obj = WriteGridObj(static_cast<uint32_t>(state.range(0)));
+	MeshCacheData imported;
+	std::string error;
+	uint64_t hash = 0;
+	SceneImporter::Import(obj, imported, error);
+	MeshCache::HashSource(obj, SceneImporter::importFlags, hash);
+	MeshCache::Save(MeshCache::GetCachePath(obj), hash, imported);
+	for (auto _ : state)
+	{
+		MeshCacheData data;
+		MeshCache::HashSource(obj, SceneImporter::importFlags, hash);
+		benchmark::DoNotOptimize(MeshCache::Load(MeshCache::GetCachePath(obj), hash, data));
+	}
+	fs::remove(MeshCache::GetCachePath(obj));
+	fs::remove(obj);
+}
+BENCHMARK(BM_HashAndLoadCache)->Arg(128)->Arg(512)->Unit(benchmark::kMillisecond);
+}
@@ -0,0 +1,143 @@
+#include <fstream>
+#include <string>
+#include "TestFramework.h"
+#include "SceneImporter.h"
+
+using namespace Models;
+namespace fs = std::filesystem;
+
+namespace
+{
+struct TempDir
+{
+	fs::path path;
+	explicit TempDir(const char* name) : path(fs::temp_directory_path() / (std::string("SceneImporterTest_") + name))
+	{
+		fs::remove_all(path);
+		fs::create_directories(path);
+	}
+	~TempDir()
+	{
+		std::error_code error;
+		fs::remove_all(path, error);
+	}
+};
+
+void WriteFile(const fs::path& path, const std::string& content)
+{
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	stream << content;
+}
+
+// ıΡһ߶Σ߶ڵҪ
+constexpr const char* mixedObj =
+	"mtllib mixed.mtl\n"
+	"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 2 0 1\nv 3 0 1\nv 3.5 1 1\nv 2.5 2 1\nv 1.5 1 1\n"
+	"vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+	"vn 0 0 1\n"
+	"o quad\nusemtl wall\nf 1/1/1 2/2/1 3/3/1 4/4/1\n"
+	"o pentagon\nusemtl wall\nf 5/1/1 6/2/1 7/3/1 8/4/1 9/1/1\n"
+	"o wire\nusemtl wall\nl 1 5\n";
+constexpr const char* mixedMtl = "newmtl wall\nKd 1 1 1\nmap_Kd wall_d.dds\nmap_Ks wall_s.dds\n";
+
+void CheckTriangleMeshes(const MeshCacheData& data)
+{
+	uint32_t vboStart = 0, eboStart = 0;
+	for (const auto& mesh : data.meshes)
+	{
+		EXPECT_EQ(mesh.vboStart, vboStart);
+		EXPECT_EQ(mesh.eboStart, eboStart);
+		EXPECT_EQ(mesh.eboCount, static_cast<uint32_t>(mesh.indices.size()));
+		EXPECT_EQ(mesh.indices.size() % 3, 0u);
+		EXPECT_GT(mesh.indices.size(), 0u);
+		for (const uint32_t idx : mesh.indices)
+		{
+			ASSERT_LT(idx, mesh.vertices.size());
+		}
+		// Χаȫ
+		for (const auto& v : mesh.vertices)
+		{
+			EXPECT_LE(std::fabs(v.pos.x - mesh.bounds.Center.x), mesh.bounds.Extents.x + 1e-5f);
+			EXPECT_LE(std::fabs(v.pos.y - mesh.bounds.Center.y), mesh.bounds.Extents.y + 1e-5f);
+			EXPECT_LE(std::fabs(v.pos.z - mesh.bounds.Center.z), mesh.bounds.Extents.z + 1e-5f);
+		}
+		vboStart += static_cast<uint32_t>(mesh.vertices.size());
+		eboStart += mesh.eboCount;
+	}
+}
+}
+
+TEST(SceneImporter, PolygonsAreTriangulatedAndLinesDropped)
+{
+	TempDir dir("Mixed");
+	WriteFile(dir.path / "mixed.obj", mixedObj);
+	WriteFile(dir.path / "mixed.mtl", mixedMtl);
+	MeshCacheData data;
+	std::string error;
+	ASSERT_TRUE(SceneImporter::Import(dir.path / "mixed.obj", data, error));
+	CheckTriangleMeshes(data);
+	// ı2Σ3
+	uint32_t triangles = 0;
+	for (const auto& mesh : data.meshes)
+	{
+		triangles += mesh.eboCount / 3;
+		EXPECT_EQ(mesh.materialName, std::string("wall"));
+	}
+	EXPECT_EQ(triangles, 5u);
+	EXPECT_EQ(data.meshes.size(), 2u);
+
+	bool foundWall = false;
+	for (const auto& mat : data.materials)
+	{
+		if (mat.name != "wall")
+			continue;
+		foundWall = true;
+		EXPECT_EQ(mat.textures[0], std::string("wall_d.dds"));
+		EXPECT_EQ(mat.textures[1], std::string("wall_s.dds"));
+		EXPECT_TRUE(mat.textures[2].empty());
+	}
+	EXPECT_TRUE(foundWall);
+}
+
+TEST(SceneImporter, MeshWithoutTexCoordsHasNoTangents)
+{
+	TempDir dir("NoUV");
+	WriteFile(dir.path / "plain.obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+	MeshCacheData data;
+	std::string error;
+	ASSERT_TRUE(SceneImporter::Import(dir.path / "plain.obj", data, error));
+	ASSERT_EQ(data.meshes.size(), 1u);
+	CheckTriangleMeshes(data);
+	EXPECT_EQ(data.meshes[0].vertices[0].tangent.x, 0.0f);
+	EXPECT_EQ(data.meshes[0].vertices[0].tex.y, 0.0f);
+}
+
+TEST(SceneImporter, MissingFileReportsError)
+{
+	MeshCacheData data;
+	std::string error;
+	EXPECT_FALSE(SceneImporter::Import(fs::temp_directory_path() / "SceneImporterTest_missing.obj", data, error));
+	EXPECT_FALSE(error.empty());
+}
+
+TEST(SceneImporter, CacheRoundTripMatchesImport)
+{
+	TempDir dir("Cache");
+	const fs::path obj = dir.path / "mixed.obj";
+	WriteFile(obj, mixedObj);
+	WriteFile(dir.path / "mixed.mtl", mixedMtl);
+	MeshCacheData imported;
+	std::string error;
+	ASSERT_TRUE(SceneImporter::Import(obj, imported, error));
+	uint64_t hash;
+	ASSERT_TRUE(MeshCache::HashSource(obj, SceneImporter::importFlags, hash));
+	ASSERT_TRUE(MeshCache::Save(MeshCache::GetCachePath(obj), hash, imported));
+	MeshCacheData cached;
+	ASSERT_TRUE(MeshCache::Load(MeshCache::GetCachePath(obj), hash, cached));
+	ASSERT_EQ(cached.meshes.size(), imported.meshes.size());
+	for (size_t i = 0; i < cached.meshes.size(); ++i)
+	{
+		EXPECT_EQ(cached.meshes[i].indices, imported.meshes[i].indices);
+		EXPECT_EQ(cached.meshes[i].vertices.size(), imported.meshes[i].vertices.size());
+	}
+}
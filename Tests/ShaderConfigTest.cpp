@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "TestFramework.h"
+#include "ShaderConfig.h"
+#include "Light.h"
+
+/*
+ * ShaderConfig.hC++HLSLͬ಻άһݳԼýṹĲһ
+ * ԵĹĿ¼ΪֿĿ¼
+ */
+namespace
+{
+namespace fs = std::filesystem;
+
+const char* const sharedMacros[] = { "DIR_LIGHT_NUM", "SPOT_LIGHT_NUM", "MAX_LIGHTS", "TILE_GROUP_DIM", "DEPTH_MASK_BITS", "MAX_TILE_LIGHTS" };
+
+std::string ReadText(const fs::path& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	std::stringstream stream;
+	stream << file.rdbuf();
+	return stream.str();
+}
+
+std::string Lower(std::string text)
+{
+	std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	return text;
+}
+
+// ɫWindows·ļСдУͳһΪСдĹ淶·
+std::string Key(const fs::path& path)
+{
+	return Lower(fs::weakly_canonical(path).generic_string());
+}
+
+std::map<std::string, fs::path> CollectShaders()
+{
+	std::map<std::string, fs::path> shaders;
+	for (const auto& entry : fs::recursive_directory_iterator("Shaders"))
+	{
+		if (entry.is_regular_file() && Lower(entry.path().extension().string()) == ".hlsl")
+			shaders[Key(entry.path())] = entry.path();
+	}
+	return shaders;
+}
+
+std::vector<fs::path> Includes(const fs::path& path)
+{
+	static const std::regex includePattern(R"(^\s*#include\s*"([^"]+)\")");
+	std::vector<fs::path> result;
+	std::istringstream stream(ReadText(path));
+	std::string line;
+	std::smatch match;
+	while (std::getline(stream, line))
+	{
+		if (std::regex_search(line, match, includePattern))
+			result.push_back(path.parent_path() / match[1].str());
+	}
+	return result;
+}
+
+bool ReachesConfig(const fs::path& path, std::set<std::string>& visited)
+{
+	if (!visited.insert(Key(path)).second)
+		return false;
+	for (const auto& include : Includes(path))
+	{
+		if (Key(include) == Key("Base/ShaderConfig.h"))
+			return true;
+		if (fs::exists(include) && ReachesConfig(include, visited))
+			return true;
+	}
+	// Сдͬİ·LinuxҲСд·²
+	static const auto shaders = CollectShaders();
+	for (const auto& include : Includes(path))
+	{
+		const auto it = shaders.find(Key(include));
+		if (!fs::exists(include) && it != shaders.end() && ReachesConfig(it->second, visited))
+			return true;
+	}
+	return false;
+}
+
+bool UsesIdentifier(const std::string& text, const std::string& name)
+{
+	return std::regex_search(text, std::regex("\\b" + name + "\\b"));
+}
+
+struct Member
+{
+	std::string	type;
+	std::string	name;
+};
+
+// struct Name { type name; ... };HLSLṹ壬ֱֻ֧Ա
+std::vector<Member> ParseStruct(const std::string& text, const std::string& name)
+{
+	std::vector<Member> members;
+	const std::regex structPattern("struct\\s+" + name + "\\s*\\{([^}]*)\\}");
+	std::smatch match;
+	if (!std::regex_search(text, match, structPattern))
+		return members;
+	static const std::regex memberPattern(R"((\w+)\s+(\w+)\s*;)");
+	std::string body = std::regex_replace(match[1].str(), std::regex("//[^\n]*"), "");
+	for (auto it = std::sregex_iterator(body.begin(), body.end(), memberPattern); it != std::sregex_iterator(); ++it)
+		members.push_back({ (*it)[1].str(), (*it)[2].str() });
+	return members;
+}
+
+// Ĵƫƣ4ֽڣԱܿԽ16ֽڱ߽磻ṹЩԱĲͬ
+std::vector<size_t> PackOffsets(const std::vector<Member>& members, size_t& size)
+{
+	static const std::regex vectorPattern(R"((float|uint|int)([1-4])?)");
+	std::vector<size_t> offsets;
+	size_t offset = 0;
+	for (const auto& member : members)
+	{
+		std::smatch match;
+		if (!std::regex_match(member.type, match, vectorPattern))
+			return {};
+		const size_t bytes = 4 * (match[2].matched ? std::stoul(match[2].str()) : 1);
+		if (offset / 16 != (offset + bytes - 1) / 16)
+			offset = (offset + 15) & ~size_t(15);
+		offsets.push_back(offset);
+		offset += bytes;
+	}
+	size = offset;
+	return offsets;
+}
+}
+
+TEST(ShaderConfig, HeaderIsHlslCompatible)
+{
+	// ֻԤָעУHLSL޷
+	const std::string text = ReadText("Base/ShaderConfig.h");
+	ASSERT_FALSE(text.empty());
+	const std::string stripped = std::regex_replace(text, std::regex(R"(/\*[\s\S]*?\*/)"), "");
+	std::istringstream stream(stripped);
+	std::string line;
+	while (std::getline(stream, line))
+	{
+		const auto first = line.find_first_not_of(" \t\r");
+		if (first == std::string::npos)
+			continue;
+		EXPECT_EQ(line[first], '#');
+	}
+	EXPECT_EQ(text.find("//"), std::string::npos);
+}
+
+TEST(ShaderConfig, ShadersDoNotRedefineSharedConstants)
+{
+	const auto shaders = CollectShaders();
+	ASSERT_FALSE(shaders.empty());
+	uint32_t users = 0;
+	for (const auto& [key, path] : shaders)
+	{
+		const std::string text = ReadText(path);
+		bool uses = false;
+		for (const char* name : sharedMacros)
+		{
+			EXPECT_FALSE(std::regex_search(text, std::regex(std::string("#define\\s+") + name + "\\b")));
+			uses = uses || UsesIdentifier(text, name);
+		}
+		if (!uses)
+			continue;
+		++users;
+		std::set<std::string> visited;
+		EXPECT_TRUE(ReachesConfig(path, visited));
+	}
+	EXPECT_GT(users, 0u);
+}
+
+TEST(ShaderConfig, LightLayoutsMatchHlsl)
+{
+	const std::string text = ReadText("Shaders/BRDF/DataStructure.hlsl");
+	struct Case
+	{
+		const char*				name;
+		std::vector<size_t>		cppOffsets;
+		size_t					cppSize;
+	};
+	const Case cases[] = {
+		{ "Light", { offsetof(LightInPixel, strength), offsetof(LightInPixel, fallOffStart), offsetof(LightInPixel, direction),
+			offsetof(LightInPixel, fallOffEnd), offsetof(LightInPixel, position), offsetof(LightInPixel, spotPower) }, sizeof(LightInPixel) },
+		{ "PointLight", { offsetof(LightInCompute, strength), offsetof(LightInCompute, fallOffStart), offsetof(LightInCompute, posV),
+			offsetof(LightInCompute, fallOffEnd) }, sizeof(LightInCompute) } };
+	for (const Case& c : cases)
+	{
+		const auto members = ParseStruct(text, c.name);
+		ASSERT_EQ(members.size(), c.cppOffsets.size());
+		size_t size = 0;
+		const auto offsets = PackOffsets(members, size);
+		ASSERT_EQ(offsets.size(), members.size());
+		for (size_t i = 0; i < offsets.size(); ++i)
+			EXPECT_EQ(offsets[i], c.cppOffsets[i]);
+		EXPECT_EQ(size, c.cppSize);
+	}
+}
+
+TEST(ShaderConfig, ConstantsAreConsistent)
+{
+	EXPECT_EQ(MAX_LIGHTS, DIR_LIGHT_NUM + SPOT_LIGHT_NUM);
+	EXPECT_EQ(MAX_TILE_LIGHTS % 32, 0);
+	EXPECT_EQ(DEPTH_MASK_BITS, 32);
+	EXPECT_LE(TILE_GROUP_DIM * TILE_GROUP_DIM, 1024);
+	// ÿλռõgroupshared32KB
+	EXPECT_LE((MAX_TILE_LIGHTS >> 5) * 4 + 16, 32768);
+}
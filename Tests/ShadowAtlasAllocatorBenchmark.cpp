@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "ShadowAtlasAllocator.h"
+
+using namespace Effect;
+
+namespace
+{
+constexpr uint32_t atlasSize = 4096;
+constexpr uint32_t minTileSize = 16;
+
+// ֱʸıʱ²֣ȴСط
+void BM_CascadeLayout(benchmark::State& state)
+{
+	ShadowAtlasAllocator atlas(atlasSize, minTileSize);
+	const uint32_t sizes[] = { 2048, 1024, 1024, 512, 256 };
+	for (auto _ : state)
+	{
+		atlas.Reset();
+		for (uint32_t size : sizes)
+			benchmark::DoNotOptimize(atlas.Allocate(size));
+	}
+	state.SetItemsProcessed(state.iterations() * std::size(sizes));
+}
+BENCHMARK(BM_CascadeLayout);
+
+// С򷴸ͷţͼڴƬ״̬
+void BM_FragmentedAllocFree(benchmark::State& state)
+{
+	ShadowAtlasAllocator atlas(atlasSize, minTileSize);
+	std::mt19937 rng(42);
+	std::vector<ShadowAtlasRegion> alive;
+	for (auto _ : state)
+	{
+		if (alive.empty() || rng() % 2 == 0)
+		{
+			if (const auto region = atlas.Allocate(minTileSize << (rng() % 7)))
+				alive.push_back(*region);
+		}
+		else
+		{
+			const size_t slot = rng() % alive.size();
+			atlas.Free(alive[slot]);
+			alive[slot] = alive.back();
+			alive.pop_back();
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FragmentedAllocFree);
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "TestFramework.h"
+#include "ShadowAtlasAllocator.h"
+
+using namespace Effect;
+
+namespace
+{
+constexpr uint32_t atlasSize = 1024;
+constexpr uint32_t minTileSize = 16;
+
+// СֿΪλ¼ÿλñĸռã֮ûص
+class Occupancy
+{
+public:
+	explicit Occupancy(uint32_t cells) : m_cells(cells), m_owner(static_cast<size_t>(cells) * cells, -1) {}
+
+	bool Mark(const ShadowAtlasRegion& region, int owner)
+	{
+		for (uint32_t y = region.y / minTileSize; y < (region.y + region.size) / minTileSize; ++y)
+		{
+			for (uint32_t x = region.x / minTileSize; x < (region.x + region.size) / minTileSize; ++x)
+			{
+				int& cell = m_owner[static_cast<size_t>(y) * m_cells + x];
+				if (owner >= 0 && cell >= 0)
+					return false;
+				cell = owner;
+			}
+		}
+		return true;
+	}
+private:
+	uint32_t			m_cells;
+	std::vector<int>	m_owner;
+};
+
+uint64_t Area(const ShadowAtlasRegion& region)
+{
+	return static_cast<uint64_t>(region.size) * region.size;
+}
+}
+
+TEST(ShadowAtlasAllocator, RandomAllocFreeNeverOverlaps)
+{
+	ShadowAtlasAllocator atlas(atlasSize, minTileSize);
+	Occupancy occupancy(atlasSize / minTileSize);
+	std::vector<ShadowAtlasRegion> alive;
+	std::mt19937 rng(2024);
+	uint64_t expectedArea = 0;
+	uint32_t failures = 0;
+	for (uint32_t step = 0; step < 20000; ++step)
+	{
+		if (alive.empty() || rng() % 5 < 3)
+		{
+			// Сȡ2ݣȡ߼
+			const uint32_t size = minTileSize / 2 + rng() % (atlasSize / 4);
+			const auto region = atlas.Allocate(size);
+			if (!region)
+			{
+				// ʧʱȷʵû㹻Ŀп
+				EXPECT_LT(atlas.GetLargestFreeSize(), std::max(ShadowAtlasAllocator::RoundUpPow2(size), minTileSize));
+				++failures;
+				continue;
+			}
+			EXPECT_EQ(region->size, std::max(ShadowAtlasAllocator::RoundUpPow2(size), minTileSize));
+			ASSERT_LE(region->x + region->size, atlasSize);
+			ASSERT_LE(region->y + region->size, atlasSize);
+			EXPECT_EQ(region->x % region->size, 0u);
+			EXPECT_EQ(region->y % region->size, 0u);
+			ASSERT_TRUE(occupancy.Mark(*region, static_cast<int>(step)));
+			alive.push_back(*region);
+			expectedArea += Area(*region);
+		}
+		else
+		{
+			const size_t slot = rng() % alive.size();
+			atlas.Free(alive[slot]);
+			occupancy.Mark(alive[slot], -1);
+			expectedArea -= Area(alive[slot]);
+			alive[slot] = alive.back();
+			alive.pop_back();
+		}
+		ASSERT_EQ(atlas.GetUsedArea(), expectedArea);
+	}
+	EXPECT_GT(failures, 0u);
+
+	// ȫͷźнڵϲͼ
+	for (const auto& region : alive)
+		atlas.Free(region);
+	EXPECT_EQ(atlas.GetUsedArea(), 0u);
+	EXPECT_EQ(atlas.GetLargestFreeSize(), atlasSize);
+	const auto whole = atlas.Allocate(atlasSize);
+	ASSERT_TRUE(whole.has_value());
+	EXPECT_EQ(whole->level, 0u);
+}
+
+TEST(ShadowAtlasAllocator, LargestFirstFillsWithoutFragmentation)
+{
+	// ȴСط2ͼʱһȫɹǼ
+	std::mt19937 rng(7);
+	ShadowAtlasAllocator atlas(atlasSize, minTileSize);
+	for (uint32_t round = 0; round < 500; ++round)
+	{
+		std::vector<uint32_t> sizes;
+		uint64_t area = 0;
+		for (;;)
+		{
+			const uint32_t size = minTileSize << (rng() % 6);
+			if (area + static_cast<uint64_t>(size) * size > static_cast<uint64_t>(atlasSize) * atlasSize)
+				break;
+			area += static_cast<uint64_t>(size) * size;
+			sizes.push_back(size);
+		}
+		std::sort(sizes.begin(), sizes.end(), [](uint32_t lhs, uint32_t rhs) { return lhs > rhs; });
+		atlas.Reset();
+		for (uint32_t size : sizes)
+			ASSERT_TRUE(atlas.Allocate(size).has_value());
+		EXPECT_EQ(atlas.GetUsedArea(), area);
+	}
+}
+
+TEST(ShadowAtlasAllocator, AllocateWithMinSizeDegrades)
+{
+	ShadowAtlasAllocator atlas(atlasSize, minTileSize);
+	// ռ޵һ
+	for (int i = 0; i < 3; ++i)
+		ASSERT_TRUE(atlas.Allocate(atlasSize / 2).has_value());
+	ASSERT_TRUE(atlas.Allocate(atlasSize / 4).has_value());
+	ASSERT_TRUE(atlas.Allocate(atlasSize / 4).has_value());
+	EXPECT_EQ(atlas.GetLargestFreeSize(), atlasSize / 4);
+
+	EXPECT_FALSE(atlas.Allocate(atlasSize / 2).has_value());
+	const auto region = atlas.Allocate(atlasSize / 2, minTileSize);
+	ASSERT_TRUE(region.has_value());
+	EXPECT_EQ(region->size, atlasSize / 4);
+	// ʱ
+	EXPECT_FALSE(atlas.Allocate(atlasSize / 2, atlasSize / 2).has_value());
+
+	ASSERT_TRUE(atlas.Allocate(atlasSize / 8).has_value());
+	const auto uv = atlas.GetUVScaleBias(*region);
+	EXPECT_NEAR(uv.x, 0.25f, 1e-6f);
+	EXPECT_NEAR(uv.z * atlasSize, static_cast<float>(region->x), 1e-3f);
+	EXPECT_NEAR(uv.w * atlasSize, static_cast<float>(region->y), 1e-3f);
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * СĵԪԿܣֻ׼⣬WindowsLinux϶ֱӹ
+ * TESTעEXPECT_*ʧִܺУASSERT_*ʧܺǰ
+ * ԳĲΪӴʱֻƥ
+ */
+namespace Test
+{
+using TestFunc = void(*)();
+
+struct TestCase
+{
+	const char*	suite;
+	const char*	name;
+	TestFunc	func;
+};
+
+inline std::vector<TestCase>& GetTestCases()
+{
+	static std::vector<TestCase> cases;
+	return cases;
+}
+
+// ǰʧܵļԷ̳߳ص
+inline std::atomic<int>& GetFailureCount()
+{
+	static std::atomic<int> count{ 0 };
+	return count;
+}
+
+struct Registrar
+{
+	Registrar(const char* suite, const char* name, TestFunc func)
+	{
+		GetTestCases().push_back({ suite, name, func });
+	}
+};
+
+template <typename T>
+std::string ToString(const T& value)
+{
+	if constexpr (requires(std::ostream& os) { os << value; })
+	{
+		std::ostringstream os;
+		if constexpr (std::is_same_v<T, unsigned char> || std::is_same_v<T, signed char> || std::is_same_v<T, char>)
+			os << static_cast<int>(value);
+		else
+			os << value;
+		return os.str();
+	}
+	else
+	{
+		return "<unprintable>";
+	}
+}
+
+inline void Fail(const char* file, int line, const std::string& message)
+{
+	std::printf("%s:%d: failure: %s\n", file, line, message.c_str());
+	++GetFailureCount();
+}
+
+template <typename A, typename B, typename Op>
+bool Compare(const A& a, const B& b, Op op, const char* opText, const char* aText, const char* bText, const char* file, int line)
+{
+	if (op(a, b))
+		return true;
+	Fail(file, line, std::string(aText) + " " + opText + " " + bText + " (" + ToString(a) + " vs " + ToString(b) + ")");
+	return false;
+}
+
+inline bool Near(double a, double b, double tolerance, const char* aText, const char* bText, const char* file, int line)
+{
+	if (std::fabs(a - b) <= tolerance)
+		return true;
+	Fail(file, line, std::string(aText) + " near " + bText + " (" + ToString(a) + " vs " + ToString(b) + ", tolerance " + ToString(tolerance) + ")");
+	return false;
+}
+
+inline int RunAll(int argc, char** argv)
+{
+	const char* filter = argc > 1 ? argv[1] : nullptr;
+	int failedCases = 0;
+	int runCases = 0;
+	for (const auto& testCase : GetTestCases())
+	{
+		const std::string fullName = std::string(testCase.suite) + "." + testCase.name;
+		if (filter && fullName.find(filter) == std::string::npos)
+			continue;
+		++runCases;
+		GetFailureCount().store(0);
+		std::printf("[ RUN      ] %s\n", fullName.c_str());
+		try
+		{
+			testCase.func();
+		}
+		catch (const std::exception& e)
+		{
+			Fail(__FILE__, __LINE__, std::string("uncaught exception: ") + e.what());
+		}
+		catch (...)
+		{
+			Fail(__FILE__, __LINE__, "uncaught exception");
+		}
+		if (GetFailureCount().load() > 0)
+		{
+			++failedCases;
+			std::printf("[  FAILED  ] %s\n", fullName.c_str());
+		}
+		else
+		{
+			std::printf("[       OK ] %s\n", fullName.c_str());
+		}
+	}
+	std::printf("%d of %d test cases passed\n", runCases - failedCases, runCases);
+	return failedCases == 0 && runCases > 0 ? 0 : 1;
+}
+}
+
+#define TEST(suite, name)																	\
+	static void suite##_##name##_Test();													\
+	static const Test::Registrar suite##_##name##_registrar(#suite, #name, &suite##_##name##_Test);	\
+	static void suite##_##name##_Test()
+
+#define TEST_COMPARE_(a, b, op, onFail)																				\
+	do {																											\
+		if (!Test::Compare((a), (b), [](const auto& x, const auto& y) { return x op y; }, #op, #a, #b, __FILE__, __LINE__))	\
+			onFail;																									\
+	} while (false)
+
+#define EXPECT_EQ(a, b) TEST_COMPARE_(a, b, ==, (void)0)
+#define EXPECT_NE(a, b) TEST_COMPARE_(a, b, !=, (void)0)
+#define EXPECT_LT(a, b) TEST_COMPARE_(a, b, <, (void)0)
+#define EXPECT_LE(a, b) TEST_COMPARE_(a, b, <=, (void)0)
+#define EXPECT_GT(a, b) TEST_COMPARE_(a, b, >, (void)0)
+#define EXPECT_GE(a, b) TEST_COMPARE_(a, b, >=, (void)0)
+#define ASSERT_EQ(a, b) TEST_COMPARE_(a, b, ==, return)
+#define ASSERT_NE(a, b) TEST_COMPARE_(a, b, !=, return)
+#define ASSERT_LT(a, b) TEST_COMPARE_(a, b, <, return)
+#define ASSERT_LE(a, b) TEST_COMPARE_(a, b, <=, return)
+#define ASSERT_GT(a, b) TEST_COMPARE_(a, b, >, return)
+#define ASSERT_GE(a, b) TEST_COMPARE_(a, b, >=, return)
+
+#define EXPECT_TRUE(cond) do { if (!(cond)) Test::Fail(__FILE__, __LINE__, "expected " #cond); } while (false)
+#define EXPECT_FALSE(cond) do { if (cond) Test::Fail(__FILE__, __LINE__, "expected !(" #cond ")"); } while (false)
+#define ASSERT_TRUE(cond) do { if (!(cond)) { Test::Fail(__FILE__, __LINE__, "expected " #cond); return; } } while (false)
+#define ASSERT_FALSE(cond) do { if (cond) { Test::Fail(__FILE__, __LINE__, "expected !(" #cond ")"); return; } } while (false)
+
+#define EXPECT_NEAR(a, b, tolerance) do { Test::Near((a), (b), (tolerance), #a, #b, __FILE__, __LINE__); } while (false)
+#define ASSERT_NEAR(a, b, tolerance) do { if (!Test::Near((a), (b), (tolerance), #a, #b, __FILE__, __LINE__)) return; } while (false)
+
+#define EXPECT_THROW(statement, exception)																\
+	do {																								\
+		bool caught_ = false;																			\
+		try { statement; } catch (const exception&) { caught_ = true; } catch (...) {}					\
+		if (!caught_) Test::Fail(__FILE__, __LINE__, "expected " #statement " to throw " #exception);	\
+	} while (false)
+#define EXPECT_NO_THROW(statement)																		\
+	do {																								\
+		try { statement; } catch (...) { Test::Fail(__FILE__, __LINE__, "unexpected exception from " #statement); }	\
+	} while (false)
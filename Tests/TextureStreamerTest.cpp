@@ -0,0 +1,152 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "TestFramework.h"
+#include "TextureStreamer.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+struct TempDir
+{
+	fs::path path;
+	explicit TempDir(const char* name) : path(fs::temp_directory_path() / (std::string("TextureStreamerTest_") + name))
+	{
+		fs::remove_all(path);
+		fs::create_directories(path);
+	}
+	~TempDir()
+	{
+		std::error_code error;
+		fs::remove_all(path, error);
+	}
+};
+
+void WriteFile(const fs::path& path, const std::string& content)
+{
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	stream << content;
+}
+
+// Ϊļִн߳
+struct TextPayload
+{
+	std::string		text;
+	std::thread::id	thread;
+};
+using TextStreamer = TextureStreamer<TextPayload>;
+
+bool ParseText(const MappedFile& file, TextPayload& payload)
+{
+	payload.text.assign(reinterpret_cast<const char*>(file.GetData()), file.GetSize());
+	payload.thread = std::this_thread::get_id();
+	if (payload.text == "throw")
+		throw std::runtime_error("parse error");
+	return payload.text != "invalid";
+}
+}
+
+TEST(TextureStreamer, RequestsCompleteInOrderOnOneThread)
+{
+	TempDir dir("Order");
+	TextStreamer streamer(ParseText);
+	constexpr uint32_t count = 32;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const fs::path path = dir.path / (std::to_string(i) + ".dds");
+		WriteFile(path, "texture" + std::to_string(i));
+		streamer.Request(i, path);
+	}
+	streamer.WaitAll();
+	EXPECT_EQ(streamer.GetPendingCount(), 0u);
+	auto results = streamer.PollCompleted();
+	ASSERT_EQ(results.size(), size_t(count));
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		EXPECT_EQ(results[i].idx, i);
+		EXPECT_TRUE(results[i].succeeded);
+		EXPECT_EQ(results[i].payload.text, "texture" + std::to_string(i));
+		// ӳһ𽻸
+		EXPECT_TRUE(results[i].file.IsOpen());
+		// ͬһ߳н
+		EXPECT_TRUE(results[i].payload.thread == results[0].payload.thread);
+	}
+	EXPECT_TRUE(results[0].payload.thread != std::this_thread::get_id());
+	EXPECT_TRUE(streamer.PollCompleted().empty());
+}
+
+TEST(TextureStreamer, FailuresAreReported)
+{
+	TempDir dir("Failures");
+	WriteFile(dir.path / "invalid.dds", "invalid");
+	WriteFile(dir.path / "throw.dds", "throw");
+	WriteFile(dir.path / "valid.dds", "valid");
+	TextStreamer streamer(ParseText);
+	streamer.Request(0, dir.path / "missing.dds");
+	streamer.Request(1, dir.path / "invalid.dds");
+	streamer.Request(2, dir.path / "throw.dds");
+	streamer.Request(3, dir.path / "valid.dds");
+	streamer.WaitAll();
+	const auto results = streamer.PollCompleted();
+	ASSERT_EQ(results.size(), 4u);
+	EXPECT_FALSE(results[0].succeeded);
+	EXPECT_FALSE(results[1].succeeded);
+	// ׳쳣߳
+	EXPECT_FALSE(results[2].succeeded);
+	EXPECT_TRUE(results[3].succeeded);
+	EXPECT_EQ(results[3].fileName.filename().string(), std::string("valid.dds"));
+}
+
+TEST(TextureStreamer, PollWhileStreaming)
+{
+	TempDir dir("Poll");
+	WriteFile(dir.path / "a.dds", "a");
+	TextStreamer streamer([](const MappedFile& file, TextPayload& payload)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		return ParseText(file, payload);
+	});
+	constexpr uint32_t count = 50;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		streamer.Request(i, dir.path / "a.dds");
+	}
+	// ģ߳ÿ֡ȡ߽
+	uint32_t next = 0;
+	while (next < count)
+	{
+		for (const auto& result : streamer.PollCompleted())
+		{
+			EXPECT_EQ(result.idx, next);
+			++next;
+		}
+		EXPECT_LE(streamer.GetPendingCount(), count - next);
+		std::this_thread::yield();
+	}
+	EXPECT_EQ(streamer.GetPendingCount(), 0u);
+}
+
+TEST(TextureStreamer, DestroyWithQueuedRequests)
+{
+	TempDir dir("Destroy");
+	WriteFile(dir.path / "a.dds", "a");
+	std::atomic<uint32_t> parsed{ 0 };
+	{
+		TextStreamer streamer([&](const MappedFile& file, TextPayload& payload)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			++parsed;
+			return ParseText(file, payload);
+		});
+		for (uint32_t i = 0; i < 100; ++i)
+		{
+			streamer.Request(i, dir.path / "a.dds");
+		}
+	}
+	// δʼ󣬲ȴȫ
+	EXPECT_LT(parsed.load(), 100u);
+}
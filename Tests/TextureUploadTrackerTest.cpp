@@ -0,0 +1,245 @@
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "TestFramework.h"
+#include "TextureUploadTracker.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+struct TempDir
+{
+	fs::path path;
+	explicit TempDir(const char* name) : path(fs::temp_directory_path() / (std::string("TextureUploadTrackerTest_") + name))
+	{
+		fs::remove_all(path);
+		fs::create_directories(path);
+	}
+	~TempDir()
+	{
+		std::error_code error;
+		fs::remove_all(path, error);
+	}
+};
+
+void WriteFile(const fs::path& path, const std::string& content)
+{
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	stream << content;
+}
+
+// maxMipsΪ0ʱģֻСļmip
+struct TextPayload
+{
+	uint32_t	maxMips{ 0 };
+	std::string	text;
+	bool		isPreview{ false };
+};
+using TextTracker = TextureUploadTracker<TextPayload>;
+
+// ΪnofullļֻԤܹ
+bool ParseText(const MappedFile& file, TextPayload& payload)
+{
+	payload.text.assign(reinterpret_cast<const char*>(file.GetData()), file.GetSize());
+	if (payload.text == "invalid" || (payload.text == "nofull" && payload.maxMips == 0))
+		return false;
+	payload.isPreview = payload.maxMips > 0;
+	return true;
+}
+
+/*
+ * GPUϴˣ¼ÿϴ
+ * latencyΪ0ʱֻcompletedеɣÿڱѯlatency֮
+ */
+class FakeUploader : public ITextureUploader<TextPayload>
+{
+public:
+	void Upload(TextPayload& payload) override
+	{
+		m_current.push_back(payload.text + (payload.isPreview ? ":preview" : ""));
+	}
+
+	uint64_t Submit() override
+	{
+		batches.push_back(std::move(m_current));
+		m_current.clear();
+		return batches.size() - 1;
+	}
+
+	bool IsComplete(uint64_t batch) override
+	{
+		if (latency > 0 && ++m_polls[batch] > latency)
+			return true;
+		return completed.count(batch) > 0;
+	}
+
+	std::vector<std::vector<std::string>>	batches;
+	std::set<uint64_t>						completed;
+	uint32_t								latency{ 0 };
+private:
+	std::vector<std::string>				m_current;
+	std::unordered_map<uint64_t, uint32_t>	m_polls;
+};
+
+// ģ߳֡Pumpʱfalse
+bool PumpUntil(TextTracker& tracker, FakeUploader& uploader, const std::function<bool()>& done)
+{
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while (!done())
+	{
+		if (std::chrono::steady_clock::now() > deadline)
+			return false;
+		tracker.Pump(uploader);
+		std::this_thread::yield();
+	}
+	return true;
+}
+}
+
+TEST(TextureUploadTracker, StatesFollowUploadProgress)
+{
+	TempDir dir("States");
+	WriteFile(dir.path / "a.dds", "a");
+	TextTracker tracker(ParseText);
+	FakeUploader uploader;
+	const uint32_t idx = tracker.Request(dir.path / "a.dds", { 2 });
+	EXPECT_EQ(idx, 0u);
+	EXPECT_EQ(tracker.GetTextureCount(), 1u);
+	EXPECT_TRUE(tracker.GetState(idx) == TextureState::Loading);
+
+	// ԤɺύϴGPU֮ǰUploading
+	ASSERT_TRUE(PumpUntil(tracker, uploader, [&]() { return tracker.GetState(idx) != TextureState::Loading; }));
+	EXPECT_TRUE(tracker.GetState(idx) == TextureState::Uploading);
+	ASSERT_EQ(uploader.batches.size(), 1u);
+	EXPECT_TRUE(uploader.batches[0] == std::vector<std::string>{ "a:preview" });
+	EXPECT_FALSE(tracker.Pump(uploader));
+	EXPECT_TRUE(tracker.TakeReady(8).empty());
+
+	uploader.completed.insert(0);
+	ASSERT_TRUE(PumpUntil(tracker, uploader, [&]() { return tracker.GetState(idx) == TextureState::Preview; }));
+	auto ready = tracker.TakeReady(8);
+	ASSERT_EQ(ready.size(), 1u);
+	EXPECT_EQ(ready[0].idx, idx);
+	EXPECT_TRUE(ready[0].payload.isPreview);
+
+	// Ԥ֮ԶϴǰΪPreview
+	ASSERT_TRUE(PumpUntil(tracker, uploader, [&]() { return uploader.batches.size() == 2; }));
+	EXPECT_TRUE(uploader.batches[1] == std::vector<std::string>{ "a" });
+	EXPECT_TRUE(tracker.GetState(idx) == TextureState::Preview);
+	uploader.completed.insert(1);
+	ASSERT_TRUE(PumpUntil(tracker, uploader, [&]() { return tracker.GetState(idx) == TextureState::Ready; }));
+	ready = tracker.TakeReady(8);
+	ASSERT_EQ(ready.size(), 1u);
+	EXPECT_FALSE(ready[0].payload.isPreview);
+	EXPECT_EQ(ready[0].payload.text, std::string("a"));
+}
+
+TEST(TextureUploadTracker, WaitForDoesNotNeedDescriptorSwaps)
+{
+	TempDir dir("Wait");
+	TextTracker tracker(ParseText);
+	FakeUploader uploader;
+	uploader.latency = 3;
+	constexpr uint32_t count = 6;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const fs::path path = dir.path / (std::to_string(i) + ".dds");
+		WriteFile(path, "texture" + std::to_string(i));
+		tracker.Request(path, { 2 });
+	}
+	// ֻWaitForȡ߾ȴҲ
+	tracker.WaitFor(4, uploader);
+	EXPECT_TRUE(tracker.GetState(4) == TextureState::Ready);
+	tracker.WaitFor(4, uploader);
+
+	// бÿֻµϴȡδ滻Ԥ
+	auto ready = tracker.TakeReady(2);
+	EXPECT_EQ(ready.size(), 2u);
+	auto rest = tracker.TakeReady(count);
+	ready.insert(ready.end(), std::make_move_iterator(rest.begin()), std::make_move_iterator(rest.end()));
+	std::set<uint32_t> seen;
+	bool hasFull = false;
+	for (const auto& texture : ready)
+	{
+		EXPECT_TRUE(seen.insert(texture.idx).second);
+		if (texture.idx == 4)
+		{
+			EXPECT_FALSE(texture.payload.isPreview);
+			hasFull = true;
+		}
+	}
+	EXPECT_TRUE(hasFull);
+	// Ԥ֮ǰϴ
+	uint32_t previews = 0;
+	bool fullSeen = false;
+	for (const auto& batch : uploader.batches)
+	{
+		for (const auto& name : batch)
+		{
+			const bool isPreview = name.find(":preview") != std::string::npos;
+			EXPECT_FALSE(isPreview && fullSeen);
+			fullSeen = fullSeen || !isPreview;
+			previews += isPreview ? 1 : 0;
+		}
+	}
+	EXPECT_EQ(previews, count);
+}
+
+TEST(TextureUploadTracker, FailuresEndTheWait)
+{
+	TempDir dir("Failures");
+	WriteFile(dir.path / "invalid.dds", "invalid");
+	WriteFile(dir.path / "nofull.dds", "nofull");
+	WriteFile(dir.path / "valid.dds", "valid");
+	TextTracker tracker(ParseText);
+	FakeUploader uploader;
+	uploader.latency = 1;
+	const uint32_t missing = tracker.Request(dir.path / "missing.dds", { 2 });
+	const uint32_t invalid = tracker.Request(dir.path / "invalid.dds");
+	const uint32_t noFull = tracker.Request(dir.path / "nofull.dds", { 2 });
+	const uint32_t valid = tracker.Request(dir.path / "valid.dds");
+	tracker.WaitFor(missing, uploader);
+	tracker.WaitFor(invalid, uploader);
+	tracker.WaitFor(noFull, uploader);
+	tracker.WaitFor(valid, uploader);
+	EXPECT_TRUE(tracker.GetState(missing) == TextureState::Failed);
+	EXPECT_TRUE(tracker.GetState(invalid) == TextureState::Failed);
+	EXPECT_TRUE(tracker.GetState(valid) == TextureState::Ready);
+
+	// ʧʱѾϴԤ
+	EXPECT_TRUE(PumpUntil(tracker, uploader, [&]() { return tracker.GetState(noFull) == TextureState::Failed; }));
+	tracker.Pump(uploader);
+	const auto ready = tracker.TakeReady(8);
+	ASSERT_EQ(ready.size(), 2u);
+	for (const auto& texture : ready)
+	{
+		EXPECT_TRUE(texture.idx == noFull || texture.idx == valid);
+		EXPECT_EQ(texture.payload.isPreview, texture.idx == noFull);
+	}
+}
+
+TEST(TextureUploadTracker, LatePreviewDoesNotReplaceFullTexture)
+{
+	TempDir dir("Late");
+	WriteFile(dir.path / "a.dds", "a");
+	TextTracker tracker(ParseText);
+	FakeUploader uploader;
+	const uint32_t idx = tracker.Request(dir.path / "a.dds", { 2 });
+	ASSERT_TRUE(PumpUntil(tracker, uploader, [&]() { return uploader.batches.size() == 2; }));
+	// Ԥ
+	uploader.completed.insert(1);
+	ASSERT_TRUE(PumpUntil(tracker, uploader, [&]() { return tracker.GetState(idx) == TextureState::Ready; }));
+	uploader.completed.insert(0);
+	tracker.Pump(uploader);
+	EXPECT_TRUE(tracker.GetState(idx) == TextureState::Ready);
+	const auto ready = tracker.TakeReady(8);
+	ASSERT_EQ(ready.size(), 1u);
+	EXPECT_FALSE(ready[0].payload.isPreview);
+}
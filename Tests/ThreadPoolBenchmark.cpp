@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <vector>
+#include "ThreadPool.hpp"
+
+using Thread::ThreadPool;
+using Thread::TaskHandle;
+
+namespace
+{
+// ʵ¾ĸأÿԪһת
+void UpdateRange(std::vector<float>& data, uint32_t chunkBegin, uint32_t chunkEnd)
+{
+	for (uint32_t i = chunkBegin; i < chunkEnd; ++i)
+	{
+		const float angle = data[i] * 0.01f;
+		data[i] = std::sin(angle) * 2.0f + std::cos(angle) * 0.5f;
+	}
+}
+
+void BM_UpdateSerial(benchmark::State& state)
+{
+	std::vector<float> data(static_cast<size_t>(state.range(0)), 1.0f);
+	for (auto _ : state)
+	{
+		UpdateRange(data, 0, static_cast<uint32_t>(data.size()));
+		benchmark::DoNotOptimize(data.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_UpdateSerial)->Arg(1 << 12)->Arg(1 << 16)->Arg(1 << 20)->UseRealTime();
+
+void BM_UpdateParallelFor(benchmark::State& state)
+{
+	auto& pool = ThreadPool::instance();
+	std::vector<float> data(static_cast<size_t>(state.range(0)), 1.0f);
+	const uint32_t grain = static_cast<uint32_t>(state.range(1));
+	for (auto _ : state)
+	{
+		pool.ParallelFor(0, static_cast<uint32_t>(data.size()), grain, [&](uint32_t chunkBegin, uint32_t chunkEnd) { UpdateRange(data, chunkBegin, chunkEnd); });
+		benchmark::DoNotOptimize(data.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.counters["workers"] = pool.GetWorkerCount();
+}
+BENCHMARK(BM_UpdateParallelFor)->ArgsProduct({ { 1 << 12, 1 << 16, 1 << 20 }, { 256, 4096 } })->UseRealTime();
+
+// ύȴĿ
+void BM_SubmitWait(benchmark::State& state)
+{
+	auto& pool = ThreadPool::instance();
+	const int count = static_cast<int>(state.range(0));
+	std::vector<TaskHandle> tasks(count);
+	for (auto _ : state)
+	{
+		for (auto& task : tasks)
+			task = pool.Submit([]() {});
+		pool.WaitAll(tasks);
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_SubmitWait)->Arg(64)->Arg(1024)->UseRealTime();
+
+// ÿҪǰһɲܵ
+void BM_DependencyChain(benchmark::State& state)
+{
+	auto& pool = ThreadPool::instance();
+	const int count = static_cast<int>(state.range(0));
+	for (auto _ : state)
+	{
+		TaskHandle last;
+		for (int i = 0; i < count; ++i)
+			last = pool.Submit([]() {}, { last });
+		pool.Wait(last);
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_DependencyChain)->Arg(256)->UseRealTime();
+}
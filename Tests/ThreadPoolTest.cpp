@@ -0,0 +1,157 @@
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "TestFramework.h"
+#include "ThreadPool.hpp"
+
+using Thread::ThreadPool;
+using Thread::TaskHandle;
+
+TEST(ThreadPool, ParallelForVisitsEveryIndexOnce)
+{
+	auto& pool = ThreadPool::instance();
+	for (uint32_t grain : { 1u, 7u, 64u, 1000u, 100000u })
+	{
+		std::vector<std::atomic<int>> visits(10007);
+		pool.ParallelFor(0, static_cast<uint32_t>(visits.size()), grain, [&](uint32_t idx) { visits[idx].fetch_add(1); });
+		for (const auto& visit : visits)
+		{
+			ASSERT_EQ(visit.load(), 1);
+		}
+	}
+}
+
+TEST(ThreadPool, ParallelForChunksTileTheRange)
+{
+	auto& pool = ThreadPool::instance();
+	std::vector<int> covered(1000, 0);
+	std::atomic<uint32_t> chunkCount{ 0 };
+	pool.ParallelFor(10, 1000, 64, [&](uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		EXPECT_LE(chunkEnd - chunkBegin, 64u);
+		EXPECT_EQ((chunkBegin - 10) % 64, 0u);
+		for (uint32_t i = chunkBegin; i < chunkEnd; ++i)
+			++covered[i];
+		chunkCount.fetch_add(1);
+	});
+	EXPECT_EQ(chunkCount.load(), (990u + 63u) / 64u);
+	EXPECT_EQ(std::accumulate(covered.begin(), covered.begin() + 10, 0), 0);
+	EXPECT_EQ(std::accumulate(covered.begin() + 10, covered.end(), 0), 990);
+}
+
+TEST(ThreadPool, EmptyRangeDoesNothing)
+{
+	bool called = false;
+	ThreadPool::instance().ParallelFor(5, 5, 1, [&](uint32_t) { called = true; });
+	ThreadPool::instance().ParallelFor(6, 5, 1, [&](uint32_t) { called = true; });
+	EXPECT_FALSE(called);
+}
+
+TEST(ThreadPool, DependenciesRunInOrder)
+{
+	auto& pool = ThreadPool::instance();
+	for (int round = 0; round < 200; ++round)
+	{
+		std::atomic<int> clock{ 0 };
+		int a = -1, b = -1, c = -1, d = -1;
+		// a -> (b, c) -> d
+		TaskHandle ta = pool.Submit([&]() { a = clock++; });
+		TaskHandle tb = pool.Submit([&]() { b = clock++; }, { ta });
+		TaskHandle tc = pool.Submit([&]() { c = clock++; }, { ta });
+		TaskHandle td = pool.Submit([&]() { d = clock++; }, { tb, tc });
+		pool.Wait(td);
+		ASSERT_LT(a, b);
+		ASSERT_LT(a, c);
+		ASSERT_LT(b, d);
+		ASSERT_LT(c, d);
+		ASSERT_EQ(d, 3);
+	}
+}
+
+TEST(ThreadPool, FinishedAndNullDependenciesAreIgnored)
+{
+	auto& pool = ThreadPool::instance();
+	TaskHandle first = pool.Submit([]() {});
+	pool.Wait(first);
+	bool ran = false;
+	TaskHandle second = pool.Submit([&]() { ran = true; }, { first, nullptr });
+	pool.Wait(second);
+	EXPECT_TRUE(ran);
+	pool.Wait(nullptr);
+}
+
+TEST(ThreadPool, LongChainCompletes)
+{
+	auto& pool = ThreadPool::instance();
+	std::vector<int> order;
+	TaskHandle last;
+	for (int i = 0; i < 1000; ++i)
+	{
+		last = pool.Submit([&order, i]() { order.push_back(i); }, { last });
+	}
+	pool.Wait(last);
+	ASSERT_EQ(order.size(), 1000u);
+	for (int i = 0; i < 1000; ++i)
+	{
+		ASSERT_EQ(order[i], i);
+	}
+}
+
+TEST(ThreadPool, WaitRethrowsTaskException)
+{
+	auto& pool = ThreadPool::instance();
+	TaskHandle task = pool.Submit([]() { throw std::runtime_error("task"); });
+	EXPECT_THROW(pool.Wait(task), std::runtime_error);
+	// ׳쳣ͬΪɣճִ
+	bool ran = false;
+	TaskHandle next = pool.Submit([&]() { ran = true; }, { task });
+	pool.Wait(next);
+	EXPECT_TRUE(ran);
+}
+
+TEST(ThreadPool, ParallelForRethrowsAfterAllChunksFinish)
+{
+	auto& pool = ThreadPool::instance();
+	std::atomic<uint32_t> finished{ 0 };
+	EXPECT_THROW(pool.ParallelFor(0, 256, 1, [&](uint32_t idx)
+	{
+		if (idx == 100)
+			throw std::runtime_error("chunk");
+		finished.fetch_add(1);
+	}), std::runtime_error);
+	EXPECT_EQ(finished.load(), 255u);
+}
+
+TEST(ThreadPool, NestedParallelForDoesNotDeadlock)
+{
+	auto& pool = ThreadPool::instance();
+	std::atomic<uint64_t> sum{ 0 };
+	pool.ParallelFor(0, 64, 1, [&](uint32_t outer)
+	{
+		pool.ParallelFor(0, 100, 10, [&](uint32_t chunkBegin, uint32_t chunkEnd)
+		{
+			uint64_t local = 0;
+			for (uint32_t i = chunkBegin; i < chunkEnd; ++i)
+				local += outer * 100 + i;
+			sum.fetch_add(local);
+		});
+	});
+	// 0 ~ 6399֮
+	EXPECT_EQ(sum.load(), 6399ull * 6400ull / 2ull);
+}
+
+TEST(ThreadPool, TasksSubmittedFromWorkersComplete)
+{
+	auto& pool = ThreadPool::instance();
+	std::atomic<int> count{ 0 };
+	std::vector<TaskHandle> inner(32);
+	TaskHandle outer = pool.Submit([&]()
+	{
+		for (auto& task : inner)
+			task = pool.Submit([&]() { count.fetch_add(1); });
+	});
+	pool.Wait(outer);
+	pool.WaitAll(inner);
+	EXPECT_EQ(count.load(), 32);
+}
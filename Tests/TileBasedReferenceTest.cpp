@@ -0,0 +1,384 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include "TestFramework.h"
+#include "DDSFile.h"
+#include "TileBasedReference.h"
+
+using namespace Renderer;
+using namespace DirectX;
+namespace fs = std::filesystem;
+
+namespace
+{
+struct TempDir
+{
+	fs::path path;
+	explicit TempDir(const char* name) : path(fs::temp_directory_path() / (std::string("TileBasedReferenceTest_") + name))
+	{
+		fs::remove_all(path);
+		fs::create_directories(path);
+	}
+	~TempDir()
+	{
+		std::error_code error;
+		fs::remove_all(path, error);
+	}
+};
+
+// Camera::SetFrustumReverseZһ£60ֱӳƽ0.5Զƽ500
+TileReferenceView MakeView(uint32_t width, uint32_t height)
+{
+	constexpr float nearZ = 0.5f;
+	constexpr float farZ = 500.0f;
+	const float projY = 1.0f / std::tan(0.5f * 1.0471976f);
+	TileReferenceView view{};
+	view.view = XMFLOAT4X4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	view.proj = XMFLOAT4X4(
+		projY * static_cast<float>(height) / static_cast<float>(width), 0.0f, 0.0f, 0.0f,
+		0.0f, projY, 0.0f, 0.0f,
+		0.0f, 0.0f, nearZ / (nearZ - farZ), 1.0f,
+		0.0f, 0.0f, -farZ * nearZ / (nearZ - farZ), 0.0f);
+	view.nearZ = farZ;
+	view.farZ = nearZ;
+	return view;
+}
+
+float ToNDC(const TileReferenceView& view, float viewZ)
+{
+	return view.proj._33 + view.proj._43 / viewZ;
+}
+
+struct GBuffer
+{
+	uint32_t				width;
+	uint32_t				height;
+	std::vector<XMFLOAT4>	albedo;
+	std::vector<XMFLOAT4>	depth;
+	std::vector<XMFLOAT4>	mixed;
+};
+
+// ԶĽݵ棬skyΪtrueʱϽ(NDC0)
+GBuffer MakeGBuffer(const TileReferenceView& view, uint32_t width, uint32_t height, bool sky)
+{
+	GBuffer gbuffer{ width, height };
+	const size_t count = static_cast<size_t>(width) * height;
+	gbuffer.albedo.assign(count, { 0.8f, 0.6f, 0.4f, 1.0f });
+	gbuffer.depth.resize(count);
+	gbuffer.mixed.assign(count, { 0.0f, 0.0f, 0.5f, 0.0f });
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			const float viewZ = 2.0f + 0.25f * static_cast<float>(x) + 3.0f * static_cast<float>((y / 10) % 4);
+			const bool isSky = sky && x > width / 2 && y < height / 3;
+			gbuffer.depth[static_cast<size_t>(y) * width + x] = { isSky ? 0.0f : ToNDC(view, viewZ), 0.0f, 0.0f, 1.0f };
+		}
+	}
+	return gbuffer;
+}
+
+void SetGBuffer(TileBasedReference& reference, const GBuffer& gbuffer)
+{
+	reference.SetGBuffer(gbuffer.width, gbuffer.height, gbuffer.albedo, gbuffer.depth, gbuffer.mixed);
+}
+
+// DecodeGBufferؽǲصĹ۲ռλ
+XMFLOAT3 PixelViewPos(const TileReferenceView& view, const GBuffer& gbuffer, uint32_t x, uint32_t y)
+{
+	const uint32_t x0 = std::min(x == 0 ? 0 : x - 1, gbuffer.width - 1);
+	const uint32_t x1 = std::min(x, gbuffer.width - 1);
+	const uint32_t y0 = std::min(y == 0 ? 0 : y - 1, gbuffer.height - 1);
+	const uint32_t y1 = std::min(y, gbuffer.height - 1);
+	const auto depth = [&](uint32_t i, uint32_t j) { return gbuffer.depth[static_cast<size_t>(j) * gbuffer.width + i].x; };
+	const float ndcZ = 0.25f * (depth(x0, y0) + depth(x1, y0) + depth(x0, y1) + depth(x1, y1));
+	const float viewZ = view.proj._43 / (ndcZ - view.proj._33);
+	const float ndcX = (static_cast<float>(x) + 0.5f) * 2.0f / static_cast<float>(gbuffer.width) - 1.0f;
+	const float ndcY = 1.0f - (static_cast<float>(y) + 0.5f) * 2.0f / static_cast<float>(gbuffer.height);
+	return { ndcX / view.proj._11 * viewZ, ndcY / view.proj._22 * viewZ, viewZ };
+}
+
+std::vector<LightInCompute> RandomLights(uint32_t count, uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> xy(-30.0f, 30.0f);
+	std::uniform_real_distribution<float> z(0.0f, 80.0f);
+	std::uniform_real_distribution<float> radius(0.5f, 12.0f);
+	std::vector<LightInCompute> lights(count);
+	for (auto& light : lights)
+	{
+		light.strength = XMFLOAT3(1.0f, 1.0f, 1.0f);
+		light.posV = XMFLOAT3(xy(rng), xy(rng), z(rng));
+		light.fallOffEnd = radius(rng);
+		light.fallOffStart = 0.5f * light.fallOffEnd;
+	}
+	return lights;
+}
+
+bool TileContains(const TileBasedReference& reference, TileCullingMode mode, uint32_t listCapacity, size_t tileIdx, uint32_t lightIdx)
+{
+	if (mode == TileCullingMode::DepthMask)
+	{
+		const uint32_t word = reference.GetTileLightBits()[tileIdx * reference.GetTileLightWords() + (lightIdx >> 5)];
+		return (word >> (lightIdx & 31)) & 1;
+	}
+	const uint32_t count = std::min(reference.GetTileLightCounts()[tileIdx], listCapacity);
+	const auto begin = reference.GetTileLightLists().begin() + tileIdx * listCapacity;
+	return std::find(begin, begin + count, lightIdx) != begin + count;
+}
+}
+
+TEST(TileBasedReference, TilesContainLightsReachingTheirPixels)
+{
+	constexpr uint32_t width = 200;
+	constexpr uint32_t height = 150;
+	const TileReferenceView view = MakeView(width, height);
+	const GBuffer gbuffer = MakeGBuffer(view, width, height, true);
+	const auto lights = RandomLights(300, 3);
+	for (TileCullingMode mode : { TileCullingMode::MinMax, TileCullingMode::DepthMask })
+	{
+		TileBasedReference reference;
+		SetGBuffer(reference, gbuffer);
+		reference.SetCullingMode(mode);
+		reference.Run(view, lights.data(), static_cast<uint32_t>(lights.size()));
+		const auto& stats = reference.GetStats();
+		ASSERT_EQ(stats.tileCountX, 13u);
+		ASSERT_EQ(stats.tileCountY, 10u);
+		EXPECT_EQ(stats.overflowTiles, 0u);
+		uint32_t checked = 0;
+		uint64_t listed = 0;
+		for (uint32_t tileY = 0; tileY < stats.tileCountY; ++tileY)
+		{
+			for (uint32_t tileX = 0; tileX < stats.tileCountX; ++tileX)
+			{
+				const size_t tileIdx = static_cast<size_t>(tileY) * stats.tileCountX + tileX;
+				listed += reference.GetTileLightCounts()[tileIdx];
+				for (uint32_t y = tileY * 16; y < std::min((tileY + 1) * 16, height); ++y)
+				{
+					for (uint32_t x = tileX * 16; x < std::min((tileX + 1) * 16, width); ++x)
+					{
+						const XMFLOAT3 posV = PixelViewPos(view, gbuffer, x, y);
+						if (posV.z >= 500.0f)
+							continue;
+						for (uint32_t i = 0; i < lights.size(); ++i)
+						{
+							const float dx = posV.x - lights[i].posV.x;
+							const float dy = posV.y - lights[i].posV.y;
+							const float dz = posV.z - lights[i].posV.z;
+							if (dx * dx + dy * dy + dz * dz >= lights[i].fallOffEnd * lights[i].fallOffEnd * 0.999f)
+								continue;
+							++checked;
+							ASSERT_TRUE(TileContains(reference, mode, TileBasedReference::defaultListCapacity, tileIdx, i));
+						}
+					}
+				}
+			}
+		}
+		EXPECT_GT(checked, 0u);
+		EXPECT_LE(uint64_t(stats.falsePositives), listed);
+		EXPECT_LT(stats.maxTileLights, TileBasedReference::defaultListCapacity);
+	}
+}
+
+TEST(TileBasedReference, DepthMaskIsSubsetOfMinMax)
+{
+	constexpr uint32_t width = 160;
+	constexpr uint32_t height = 96;
+	const TileReferenceView view = MakeView(width, height);
+	const GBuffer gbuffer = MakeGBuffer(view, width, height, true);
+	const auto lights = RandomLights(500, 8);
+	TileBasedReference minMax, depthMask;
+	SetGBuffer(minMax, gbuffer);
+	SetGBuffer(depthMask, gbuffer);
+	minMax.SetCullingMode(TileCullingMode::MinMax);
+	minMax.Run(view, lights.data(), static_cast<uint32_t>(lights.size()));
+	depthMask.Run(view, lights.data(), static_cast<uint32_t>(lights.size()));
+	const size_t tileCount = minMax.GetTileLightCounts().size();
+	ASSERT_EQ(depthMask.GetTileLightCounts().size(), tileCount);
+	for (size_t tileIdx = 0; tileIdx < tileCount; ++tileIdx)
+	{
+		for (uint32_t i = 0; i < lights.size(); ++i)
+		{
+			if (TileContains(depthMask, TileCullingMode::DepthMask, 0, tileIdx, i))
+				ASSERT_TRUE(TileContains(minMax, TileCullingMode::MinMax, TileBasedReference::defaultListCapacity, tileIdx, i));
+		}
+	}
+	// ֻȥӰκصĹԴ
+	EXPECT_LE(depthMask.GetStats().falsePositives, minMax.GetStats().falsePositives);
+}
+
+TEST(TileBasedReference, LoadedGBufferMatchesDecoded)
+{
+	TempDir dir("Load");
+	constexpr uint32_t width = 70;
+	constexpr uint32_t height = 45;
+	const TileReferenceView view = MakeView(width, height);
+	const GBuffer gbuffer = MakeGBuffer(view, width, height, true);
+	std::vector<float> depth(gbuffer.depth.size());
+	std::transform(gbuffer.depth.begin(), gbuffer.depth.end(), depth.begin(), [](const XMFLOAT4& v) { return v.x; });
+	ASSERT_TRUE(DDSFile::Save(dir.path / "albedo.dds", DDSFormat::R32G32B32A32_FLOAT, width, height, gbuffer.albedo.data()));
+	ASSERT_TRUE(DDSFile::Save(dir.path / "depth.dds", DDSFormat::R32_FLOAT, width, height, depth.data()));
+	ASSERT_TRUE(DDSFile::Save(dir.path / "mixed.dds", DDSFormat::R32G32B32A32_FLOAT, width, height, gbuffer.mixed.data()));
+
+	TileBasedReference loaded, decoded;
+	ASSERT_TRUE(loaded.LoadGBuffer(dir.path / "albedo.dds", dir.path / "depth.dds", dir.path / "mixed.dds"));
+	EXPECT_EQ(loaded.GetWidth(), width);
+	EXPECT_EQ(loaded.GetHeight(), height);
+	SetGBuffer(decoded, gbuffer);
+	const auto lights = RandomLights(64, 21);
+	loaded.Run(view, lights.data(), static_cast<uint32_t>(lights.size()));
+	decoded.Run(view, lights.data(), static_cast<uint32_t>(lights.size()));
+	EXPECT_TRUE(loaded.GetTileLightCounts() == decoded.GetTileLightCounts());
+	EXPECT_TRUE(loaded.GetTileLightBits() == decoded.GetTileLightBits());
+	ASSERT_EQ(loaded.GetShadedImage().size(), decoded.GetShadedImage().size());
+	for (size_t i = 0; i < loaded.GetShadedImage().size(); ++i)
+	{
+		ASSERT_EQ(loaded.GetShadedImage()[i].x, decoded.GetShadedImage()[i].x);
+		ASSERT_EQ(loaded.GetShadedImage()[i].w, decoded.GetShadedImage()[i].w);
+	}
+
+	// ͼ¶
+	ASSERT_TRUE(loaded.SaveShadedImage(dir.path / "shaded.dds"));
+	TileBasedReference reloaded;
+	EXPECT_TRUE(reloaded.LoadGBuffer(dir.path / "shaded.dds", dir.path / "depth.dds", dir.path / "mixed.dds"));
+
+	// ȱʧļߴ粻һµG-Bufferᱻܾ
+	EXPECT_FALSE(reloaded.LoadGBuffer(dir.path / "missing.dds", dir.path / "depth.dds", dir.path / "mixed.dds"));
+	const std::vector<float> small(4, 0.5f);
+	ASSERT_TRUE(DDSFile::Save(dir.path / "small.dds", DDSFormat::R32_FLOAT, 2, 2, small.data()));
+	EXPECT_FALSE(reloaded.LoadGBuffer(dir.path / "albedo.dds", dir.path / "small.dds", dir.path / "mixed.dds"));
+}
+
+TEST(TileBasedReference, MinMaxOverflowIsReported)
+{
+	constexpr uint32_t width = 64;
+	constexpr uint32_t height = 48;
+	constexpr uint32_t listCapacity = 4;
+	constexpr uint32_t count = 10;
+	const TileReferenceView view = MakeView(width, height);
+	const GBuffer gbuffer = MakeGBuffer(view, width, height, false);
+	// ȫصĹԴ
+	std::vector<LightInCompute> lights(count);
+	for (auto& light : lights)
+	{
+		light.strength = XMFLOAT3(1.0f, 1.0f, 1.0f);
+		light.posV = XMFLOAT3(0.0f, 0.0f, 10.0f);
+		light.fallOffEnd = 1.0e4f;
+		light.fallOffStart = 1.0f;
+	}
+	TileBasedReference reference(16, listCapacity);
+	SetGBuffer(reference, gbuffer);
+	reference.SetCullingMode(TileCullingMode::MinMax);
+	reference.Run(view, lights.data(), count);
+	const auto& stats = reference.GetStats();
+	const uint32_t tileCount = stats.tileCountX * stats.tileCountY;
+	EXPECT_EQ(tileCount, 12u);
+	EXPECT_EQ(stats.overflowTiles, tileCount);
+	EXPECT_EQ(stats.droppedLights, tileCount * (count - listCapacity));
+	EXPECT_EQ(stats.maxTileLights, count);
+	for (size_t tileIdx = 0; tileIdx < tileCount; ++tileIdx)
+	{
+		EXPECT_EQ(reference.GetTileLightCounts()[tileIdx], count);
+		// ֻǰlistCapacityԴ
+		for (uint32_t i = 0; i < listCapacity; ++i)
+			EXPECT_EQ(reference.GetTileLightLists()[tileIdx * listCapacity + i], i);
+	}
+	// ÿֻɫlistCapacityԴ
+	EXPECT_EQ(reference.GetShadedImage().front().w, static_cast<float>(listCapacity));
+
+	// λ
+	reference.SetCullingMode(TileCullingMode::DepthMask);
+	reference.Run(view, lights.data(), count);
+	EXPECT_EQ(reference.GetStats().overflowTiles, 0u);
+	EXPECT_EQ(reference.GetStats().droppedLights, 0u);
+	EXPECT_EQ(reference.GetStats().maxTileLights, count);
+	EXPECT_EQ(reference.GetShadedImage().front().w, static_cast<float>(count));
+}
+
+TEST(TileBasedReference, DepthMaskRejectsLightsInDepthGaps)
+{
+	// ֿȫλz = 5Ҳֿ߽һ()λz = 50
+	constexpr uint32_t width = 32;
+	constexpr uint32_t height = 16;
+	const TileReferenceView view = MakeView(width, height);
+	GBuffer gbuffer = MakeGBuffer(view, width, height, false);
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		for (uint32_t x = 0; x < width; ++x)
+			gbuffer.depth[static_cast<size_t>(y) * width + x].x = ToNDC(view, x < 16 ? 5.0f : 50.0f);
+	}
+	// 69յԴλҲֿǰ֮Ŀ϶УԴԶĻ
+	constexpr uint32_t count = 70;
+	std::vector<LightInCompute> lights(count);
+	for (auto& light : lights)
+	{
+		light.strength = XMFLOAT3(1.0f, 1.0f, 1.0f);
+		light.posV = XMFLOAT3(0.0f, 0.0f, -100.0f);
+		light.fallOffEnd = 1.0f;
+		light.fallOffStart = 0.5f;
+	}
+	lights[count - 1].posV = XMFLOAT3(0.4f * 30.0f / view.proj._11, 0.0f, 30.0f);
+	lights[count - 1].fallOffEnd = 5.0f;
+
+	TileBasedReference minMax, depthMask;
+	SetGBuffer(minMax, gbuffer);
+	SetGBuffer(depthMask, gbuffer);
+	minMax.SetCullingMode(TileCullingMode::MinMax);
+	minMax.Run(view, lights.data(), count);
+	depthMask.Run(view, lights.data(), count);
+
+	// ֻп϶˵ȶд
+	EXPECT_EQ(depthMask.GetTileDepthMasks()[0], 1u);
+	EXPECT_EQ(depthMask.GetTileDepthMasks()[1], 1u | (1u << 31));
+	EXPECT_EQ(depthMask.GetTileDepthRanges()[1].y, 50.0f);
+	EXPECT_GT(depthMask.GetTileDepthRanges()[1].x, 5.0f);
+
+	EXPECT_EQ(minMax.GetTileLightCounts()[1], 1u);
+	EXPECT_EQ(minMax.GetTileLightLists()[TileBasedReference::defaultListCapacity], count - 1);
+	EXPECT_EQ(minMax.GetStats().falsePositives, 1u);
+	EXPECT_EQ(depthMask.GetTileLightCounts()[1], 0u);
+	EXPECT_EQ(depthMask.GetTileLightWords(), 3u);
+	EXPECT_EQ(depthMask.GetStats().falsePositives, 0u);
+}
+
+TEST(TileBasedReference, BitfieldMatchesCountsAndShading)
+{
+	constexpr uint32_t width = 128;
+	constexpr uint32_t height = 80;
+	const TileReferenceView view = MakeView(width, height);
+	const GBuffer gbuffer = MakeGBuffer(view, width, height, true);
+	const auto lights = RandomLights(333, 17);
+	const uint32_t count = static_cast<uint32_t>(lights.size());
+	TileBasedReference minMax, depthMask;
+	SetGBuffer(minMax, gbuffer);
+	SetGBuffer(depthMask, gbuffer);
+	minMax.SetCullingMode(TileCullingMode::MinMax);
+	minMax.Run(view, lights.data(), count);
+	depthMask.Run(view, lights.data(), count);
+	ASSERT_EQ(depthMask.GetTileLightWords(), (count + 31) / 32);
+	const uint32_t words = depthMask.GetTileLightWords();
+	for (size_t tileIdx = 0; tileIdx < depthMask.GetTileLightCounts().size(); ++tileIdx)
+	{
+		uint32_t bits = 0;
+		for (uint32_t word = 0; word < words; ++word)
+		{
+			for (uint32_t v = depthMask.GetTileLightBits()[tileIdx * words + word]; v != 0; v &= v - 1)
+				++bits;
+		}
+		EXPECT_EQ(bits, depthMask.GetTileLightCounts()[tileIdx]);
+	}
+	// ȥĹԴԷֿص˥Ϊ0ɫMinMaxȫһ
+	const auto& a = minMax.GetShadedImage();
+	const auto& b = depthMask.GetShadedImage();
+	ASSERT_EQ(a.size(), b.size());
+	for (size_t i = 0; i < a.size(); ++i)
+	{
+		ASSERT_EQ(a[i].x, b[i].x);
+		ASSERT_EQ(a[i].y, b[i].y);
+		ASSERT_EQ(a[i].z, b[i].z);
+		// wΪɫĹԴ
+		ASSERT_LE(b[i].w, a[i].w);
+	}
+}
@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "TileBasedReference.h"
+#include "TileLightList.h"
+
+using namespace Renderer;
+using namespace DirectX;
+
+/*
+ * ȡȡG-BufferCPUTileBasedDeferں˲ÿֿĹԴͳ
+ * ÷TileBasedReferenceTool <albedo.dds> <depth.dds> <mixed.dds> [ѡ]
+ * ͼвԴԴBoxApp˥Χֲ׶ڣͶӰCamera::SetFrustumReverseZһ
+ * --transparentʱTileLightListForwardPlusķֿԴ͸ΪForwardPlusԤȾĽ
+ */
+namespace
+{
+struct Options
+{
+	std::string		albedo;
+	std::string		depth;
+	std::string		mixed;
+	uint32_t		lights{ 2048 };
+	uint32_t		seed{ 1337 };
+	uint32_t		tileSize{ TileBasedReference::defaultTileSize };
+	uint32_t		listCapacity{ TileBasedReference::defaultListCapacity };
+	TileCullingMode	mode{ TileCullingMode::DepthMask };
+	float			fov{ 60.0f };
+	float			nearZ{ 0.5f };
+	float			farZ{ 500.0f };
+	float			lightRange{ 150.0f };	// ԴֲԶ
+	std::string		shaded;
+	std::string		transparent;	// ͸NDC
+};
+
+void PrintUsage()
+{
+	std::cout << "usage: TileBasedReferenceTool <albedo.dds> <depth.dds> <mixed.dds>\n"
+		"\t[--lights N] [--seed N] [--tile N] [--capacity N] [--mode minmax|depthmask]\n"
+		"\t[--fov degrees] [--near Z] [--far Z] [--range Z] [--shaded out.dds] [--transparent depth.dds]" << std::endl;
+}
+
+bool ParseOptions(int argc, char** argv, Options& options)
+{
+	std::vector<std::string> positional;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if (arg.rfind("--", 0) != 0)
+		{
+			positional.push_back(arg);
+			continue;
+		}
+		if (i + 1 >= argc)
+			return false;
+		const char* value = argv[++i];
+		if (arg == "--lights")
+			options.lights = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+		else if (arg == "--seed")
+			options.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+		else if (arg == "--tile")
+			options.tileSize = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+		else if (arg == "--capacity")
+			options.listCapacity = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+		else if (arg == "--mode" && std::strcmp(value, "minmax") == 0)
+			options.mode = TileCullingMode::MinMax;
+		else if (arg == "--mode" && std::strcmp(value, "depthmask") == 0)
+			options.mode = TileCullingMode::DepthMask;
+		else if (arg == "--fov")
+			options.fov = std::strtof(value, nullptr);
+		else if (arg == "--near")
+			options.nearZ = std::strtof(value, nullptr);
+		else if (arg == "--far")
+			options.farZ = std::strtof(value, nullptr);
+		else if (arg == "--range")
+			options.lightRange = std::strtof(value, nullptr);
+		else if (arg == "--shaded")
+			options.shaded = value;
+		else if (arg == "--transparent")
+			options.transparent = value;
+		else
+			return false;
+	}
+	if (positional.size() != 3)
+		return false;
+	options.albedo = positional[0];
+	options.depth = positional[1];
+	options.mixed = positional[2];
+	return options.tileSize > 0 && options.listCapacity > 0 && options.nearZ > 0.0f && options.farZ > options.nearZ;
+}
+
+TileReferenceView MakeView(const Options& options, uint32_t width, uint32_t height)
+{
+	const float projY = 1.0f / std::tan(0.5f * options.fov * 0.017453292f);
+	const float n = options.nearZ;
+	const float f = options.farZ;
+	TileReferenceView view{};
+	view.view = XMFLOAT4X4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	view.proj = XMFLOAT4X4(
+		projY * static_cast<float>(height) / static_cast<float>(width), 0.0f, 0.0f, 0.0f,
+		0.0f, projY, 0.0f, 0.0f,
+		0.0f, 0.0f, n / (n - f), 1.0f,
+		0.0f, 0.0f, -f * n / (n - f), 0.0f);
+	view.nearZ = f;
+	view.farZ = n;
+	return view;
+}
+
+std::vector<LightInCompute> MakeLights(const Options& options, const TileReferenceView& view)
+{
+	std::mt19937 rng(options.seed);
+	std::uniform_real_distribution<float> ndcDist(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> depthDist(options.nearZ, options.lightRange);
+	std::uniform_real_distribution<float> hueDist(0.2f, 0.8f);
+	std::uniform_real_distribution<float> attenuationDist(2.0f, 20.0f);
+	std::vector<LightInCompute> lights(options.lights);
+	for (auto& light : lights)
+	{
+		const float z = depthDist(rng);
+		light.posV = XMFLOAT3(ndcDist(rng) * z / view.proj._11, ndcDist(rng) * z / view.proj._22, z);
+		light.strength = XMFLOAT3(hueDist(rng), hueDist(rng), hueDist(rng));
+		light.fallOffEnd = attenuationDist(rng);
+		light.fallOffStart = 0.8f * light.fallOffEnd;
+	}
+	return lights;
+}
+
+// ÿһֿУcapacityķֿ*ǣcapacityΪ0ʱ
+void PrintTileCounts(const std::vector<uint32_t>& counts, uint32_t tileCountX, uint32_t tileCountY, uint32_t capacity)
+{
+	for (uint32_t tileY = 0; tileY < tileCountY; ++tileY)
+	{
+		for (uint32_t tileX = 0; tileX < tileCountX; ++tileX)
+		{
+			const uint32_t count = counts[static_cast<size_t>(tileY) * tileCountX + tileX];
+			const bool overflow = capacity > 0 && count > capacity;
+			std::cout << std::setw(5) << count << (overflow ? '*' : ' ');
+		}
+		std::cout << "\n";
+	}
+}
+
+// ͸͸ȾΪNDCȣתΪ۲ռ󽻸TileLightList
+bool RunForwardPlus(const Options& options, const TileReferenceView& view, const std::vector<LightInCompute>& lights)
+{
+	uint32_t width[2], height[2];
+	std::vector<XMFLOAT4> images[2];
+	if (!TileBasedReference::ReadImage(options.depth, width[0], height[0], images[0]) || !TileBasedReference::ReadImage(options.transparent, width[1], height[1], images[1]))
+		return false;
+	if (width[0] != width[1] || height[0] != height[1])
+	{
+		std::cout << "transparent depth size doesn't match the G-Buffer" << std::endl;
+		return false;
+	}
+	std::vector<float> viewZ[2];
+	for (uint32_t i = 0; i < 2; ++i)
+	{
+		viewZ[i].resize(images[i].size());
+		for (size_t pixel = 0; pixel < images[i].size(); ++pixel)
+			viewZ[i][pixel] = view.proj._43 / (images[i][pixel].x - view.proj._33);
+	}
+	TileFrustumCache frustumCache(options.tileSize);
+	frustumCache.Build(width[0], height[0], view.proj._11, view.proj._22);
+	TileLightList tileLights(options.tileSize);
+	tileLights.ReduceDepthRanges(width[0], height[0], viewZ[0].data(), viewZ[1].data(), view.nearZ, view.farZ);
+	tileLights.Build(frustumCache.GetPlanes(), lights.data(), static_cast<uint32_t>(lights.size()));
+
+	std::vector<uint32_t> counts;
+	uint32_t maxCount = 0;
+	uint64_t total = 0;
+	uint32_t emptyTiles = 0;
+	for (uint32_t tileY = 0; tileY < tileLights.GetTileCountY(); ++tileY)
+	{
+		for (uint32_t tileX = 0; tileX < tileLights.GetTileCountX(); ++tileX)
+		{
+			const uint32_t count = tileLights.GetTileLightCount(tileX, tileY);
+			counts.push_back(count);
+			maxCount = std::max(maxCount, count);
+			total += count;
+			emptyTiles += count == 0 ? 1 : 0;
+		}
+	}
+	std::cout << "ForwardPlus tiles\n";
+	PrintTileCounts(counts, tileLights.GetTileCountX(), tileLights.GetTileCountY(), 0);
+	std::cout << "max " << maxCount << ", average " << static_cast<double>(total) / static_cast<double>(std::max<size_t>(counts.size(), 1))
+		<< ", empty " << emptyTiles << ", " << tileLights.GetLightWords() << " words per tile" << std::endl;
+	return true;
+}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 2;
+	}
+	TileBasedReference reference(options.tileSize, options.listCapacity);
+	if (!reference.LoadGBuffer(options.albedo, options.depth, options.mixed))
+		return 1;
+	reference.SetCullingMode(options.mode);
+	const TileReferenceView view = MakeView(options, reference.GetWidth(), reference.GetHeight());
+	const auto lights = MakeLights(options, view);
+	reference.Run(view, lights.data(), static_cast<uint32_t>(lights.size()));
+
+	const auto& stats = reference.GetStats();
+	std::cout << "G-Buffer " << reference.GetWidth() << "x" << reference.GetHeight()
+		<< ", " << stats.tileCountX << "x" << stats.tileCountY << " tiles of " << options.tileSize
+		<< ", " << lights.size() << " lights, " << (options.mode == TileCullingMode::MinMax ? "minmax" : "depthmask") << "\n";
+	PrintTileCounts(reference.GetTileLightCounts(), stats.tileCountX, stats.tileCountY, options.mode == TileCullingMode::MinMax ? options.listCapacity : 0);
+	std::cout << "max " << stats.maxTileLights << ", average " << stats.averageTileLights << ", empty " << stats.emptyTiles << "\n"
+		<< "overflow tiles " << stats.overflowTiles << ", dropped lights " << stats.droppedLights << " (capacity " << options.listCapacity << ")\n"
+		<< "false positives " << stats.falsePositives << "\n"
+		<< "cull " << stats.cullTime << " ms, shade " << stats.shadeTime << " ms" << std::endl;
+	if (!options.shaded.empty() && !reference.SaveShadedImage(options.shaded))
+	{
+		std::cout << "can't write " << options.shaded << std::endl;
+		return 1;
+	}
+	if (!options.transparent.empty() && !RunForwardPlus(options, view, lights))
+		return 1;
+	return 0;
+}
@@ -0,0 +1,113 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "TileFrustumCache.h"
+
+using namespace Renderer;
+using namespace DirectX;
+
+namespace
+{
+// 1080p1440p4K16طֿʱֱΪ120x68160x90240x135ֿ
+constexpr int64_t resolutions[][2] = { { 1920, 1080 }, { 2560, 1440 }, { 3840, 2160 } };
+
+struct Projection
+{
+	float	projX;
+	float	projY;
+};
+
+Projection MakeProjection(uint32_t width, uint32_t height)
+{
+	const float projY = 1.0f / std::tan(0.5f * 1.0471976f);
+	return { projY * static_cast<float>(height) / static_cast<float>(width), projY };
+}
+
+void SetTileLabel(benchmark::State& state, const TileFrustumCache& cache)
+{
+	state.SetLabel(std::to_string(cache.GetTileCountX()) + "x" + std::to_string(cache.GetTileCountY()) + " tiles");
+	state.SetItemsProcessed(state.iterations() * cache.GetTileCountX() * cache.GetTileCountY());
+}
+
+void ResolutionArgs(benchmark::internal::Benchmark* benchmark)
+{
+	for (const auto& resolution : resolutions)
+	{
+		benchmark->Args({ resolution[0], resolution[1] });
+	}
+}
+
+// ÿ֡ͶӰ汾仯൱ӳֱʱؽ
+void BM_UpdateRebuild(benchmark::State& state)
+{
+	const uint32_t width = static_cast<uint32_t>(state.range(0));
+	const uint32_t height = static_cast<uint32_t>(state.range(1));
+	const Projection proj = MakeProjection(width, height);
+	TileFrustumCache cache;
+	uint64_t version = 0;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(cache.Update(version++, proj.projX, proj.projY, width, height));
+		benchmark::DoNotOptimize(cache.GetPlanes().data());
+	}
+	SetTileLabel(state, cache);
+}
+BENCHMARK(BM_UpdateRebuild)->Apply(ResolutionArgs)->Unit(benchmark::kMicrosecond);
+
+// ͶӰʱĳֻ֡Ƚϰ汾ֱ
+void BM_UpdateCached(benchmark::State& state)
+{
+	const uint32_t width = static_cast<uint32_t>(state.range(0));
+	const uint32_t height = static_cast<uint32_t>(state.range(1));
+	const Projection proj = MakeProjection(width, height);
+	TileFrustumCache cache;
+	cache.Update(0, proj.projX, proj.projY, width, height);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(cache.Update(0, proj.projX, proj.projY, width, height));
+	}
+	SetTileLabel(state, cache);
+}
+BENCHMARK(BM_UpdateCached)->Apply(ResolutionArgs)->Unit(benchmark::kNanosecond);
+
+// ֿ4ƽ棬൱ɫÿ߳ظƵ
+void BM_ScalarPerTile(benchmark::State& state)
+{
+	const uint32_t width = static_cast<uint32_t>(state.range(0));
+	const uint32_t height = static_cast<uint32_t>(state.range(1));
+	const Projection proj = MakeProjection(width, height);
+	const uint32_t tileSize = TileFrustumCache::defaultTileSize;
+	const uint32_t tileCountX = (width + tileSize - 1) / tileSize;
+	const uint32_t tileCountY = (height + tileSize - 1) / tileSize;
+	std::vector<XMFLOAT4> planes(static_cast<size_t>(tileCountX) * tileCountY * TileFrustumCache::planesPerTile);
+	const auto makePlane = [](float x, float y, float z)
+	{
+		const float invLength = 1.0f / std::sqrt(x * x + y * y + z * z);
+		return XMFLOAT4(x * invLength, y * invLength, z * invLength, 0.0f);
+	};
+	for (auto _ : state)
+	{
+		XMFLOAT4* dst = planes.data();
+		for (uint32_t tileY = 0; tileY < tileCountY; ++tileY)
+		{
+			const float top = 1.0f - 2.0f * static_cast<float>(tileY * tileSize) / static_cast<float>(height);
+			const float bottom = 1.0f - 2.0f * static_cast<float>((tileY + 1) * tileSize) / static_cast<float>(height);
+			for (uint32_t tileX = 0; tileX < tileCountX; ++tileX)
+			{
+				const float left = -1.0f + 2.0f * static_cast<float>(tileX * tileSize) / static_cast<float>(width);
+				const float right = -1.0f + 2.0f * static_cast<float>((tileX + 1) * tileSize) / static_cast<float>(width);
+				*dst++ = makePlane(-1.0f, 0.0f, right / proj.projX);
+				*dst++ = makePlane(1.0f, 0.0f, -left / proj.projX);
+				*dst++ = makePlane(0.0f, -1.0f, top / proj.projY);
+				*dst++ = makePlane(0.0f, 1.0f, -bottom / proj.projY);
+			}
+		}
+		benchmark::DoNotOptimize(planes.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetLabel(std::to_string(tileCountX) + "x" + std::to_string(tileCountY) + " tiles");
+	state.SetItemsProcessed(state.iterations() * tileCountX * tileCountY);
+}
+BENCHMARK(BM_ScalarPerTile)->Apply(ResolutionArgs)->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,134 @@
+#include <cmath>
+#include "TestFramework.h"
+#include "TileFrustumCache.h"
+
+using namespace Renderer;
+using namespace DirectX;
+
+namespace
+{
+// ԭ㡢Ϊ(x, y, z)ĵλƽ
+XMFLOAT4 MakePlane(float x, float y, float z)
+{
+	const float invLength = 1.0f / std::sqrt(x * x + y * y + z * z);
+	return { x * invLength, y * invLength, z * invLength, 0.0f };
+}
+
+float Distance(const XMFLOAT4& plane, float x, float y, float z)
+{
+	return plane.x * x + plane.y * y + plane.z * z + plane.w;
+}
+
+// ɷֿ߽NDCֱӹ(, , , )ƽ棬SIMDƵ޹
+void ExpectMatchesEdges(const TileFrustumCache& cache, uint32_t width, uint32_t height, uint32_t tileSize, float projX, float projY)
+{
+	ASSERT_EQ(cache.GetPlanes().size(), size_t(cache.GetTileCountX()) * cache.GetTileCountY() * TileFrustumCache::planesPerTile);
+	for (uint32_t tileY = 0; tileY < cache.GetTileCountY(); ++tileY)
+	{
+		const float top = 1.0f - 2.0f * static_cast<float>(tileY * tileSize) / static_cast<float>(height);
+		const float bottom = 1.0f - 2.0f * static_cast<float>((tileY + 1) * tileSize) / static_cast<float>(height);
+		for (uint32_t tileX = 0; tileX < cache.GetTileCountX(); ++tileX)
+		{
+			const float left = -1.0f + 2.0f * static_cast<float>(tileX * tileSize) / static_cast<float>(width);
+			const float right = -1.0f + 2.0f * static_cast<float>((tileX + 1) * tileSize) / static_cast<float>(width);
+			const XMFLOAT4 expected[4] = {
+				MakePlane(-1.0f, 0.0f, right / projX),
+				MakePlane(1.0f, 0.0f, -left / projX),
+				MakePlane(0.0f, -1.0f, top / projY),
+				MakePlane(0.0f, 1.0f, -bottom / projY) };
+			const XMFLOAT4* planes = &cache.GetPlanes()[(static_cast<size_t>(tileY) * cache.GetTileCountX() + tileX) * TileFrustumCache::planesPerTile];
+			for (uint32_t i = 0; i < TileFrustumCache::planesPerTile; ++i)
+			{
+				ASSERT_NEAR(planes[i].x, expected[i].x, 1e-5f);
+				ASSERT_NEAR(planes[i].y, expected[i].y, 1e-5f);
+				ASSERT_NEAR(planes[i].z, expected[i].z, 1e-5f);
+				ASSERT_NEAR(planes[i].w, expected[i].w, 1e-5f);
+			}
+		}
+	}
+}
+}
+
+TEST(TileFrustumCache, PlanesMatchTileEdges)
+{
+	const float projY = 1.0f / std::tan(0.5f * 1.0471976f);
+	struct Case
+	{
+		uint32_t	width;
+		uint32_t	height;
+		uint32_t	tileSize;
+	};
+	// ֿ4ıֱʲֿܱ
+	for (const Case& c : { Case{ 1920, 1080, 16 }, Case{ 1000, 700, 16 }, Case{ 17, 9, 16 }, Case{ 130, 257, 8 }, Case{ 64, 64, 32 } })
+	{
+		const float projX = projY * static_cast<float>(c.height) / static_cast<float>(c.width);
+		TileFrustumCache cache(c.tileSize);
+		cache.Build(c.width, c.height, projX, projY);
+		EXPECT_EQ(cache.GetTileCountX(), (c.width + c.tileSize - 1) / c.tileSize);
+		EXPECT_EQ(cache.GetTileCountY(), (c.height + c.tileSize - 1) / c.tileSize);
+		ExpectMatchesEdges(cache, c.width, c.height, c.tileSize, projX, projY);
+	}
+}
+
+TEST(TileFrustumCache, PlanesFaceIntoTheTile)
+{
+	constexpr uint32_t width = 320;
+	constexpr uint32_t height = 240;
+	const float projY = 1.0f / std::tan(0.5f * 1.0471976f);
+	const float projX = projY * 0.75f;
+	TileFrustumCache cache;
+	cache.Build(width, height, projX, projY);
+	const uint32_t tileCountX = cache.GetTileCountX();
+	for (uint32_t tileY = 0; tileY < cache.GetTileCountY(); ++tileY)
+	{
+		for (uint32_t tileX = 0; tileX < tileCountX; ++tileX)
+		{
+			const XMFLOAT4* planes = &cache.GetPlanes()[(static_cast<size_t>(tileY) * tileCountX + tileX) * TileFrustumCache::planesPerTile];
+			for (float z : { 0.5f, 10.0f, 400.0f })
+			{
+				// ֿвڲ࣬ڷֿһ
+				const auto viewPos = [&](float pixelX, float pixelY, float& x, float& y)
+				{
+					x = (2.0f * pixelX / static_cast<float>(width) - 1.0f) * z / projX;
+					y = (1.0f - 2.0f * pixelY / static_cast<float>(height)) * z / projY;
+				};
+				float x, y;
+				viewPos((static_cast<float>(tileX) + 0.5f) * 16.0f, (static_cast<float>(tileY) + 0.5f) * 16.0f, x, y);
+				for (uint32_t i = 0; i < TileFrustumCache::planesPerTile; ++i)
+					ASSERT_GT(Distance(planes[i], x, y, z), 0.0f);
+				viewPos((static_cast<float>(tileX) + 1.5f) * 16.0f, (static_cast<float>(tileY) + 0.5f) * 16.0f, x, y);
+				EXPECT_LT(Distance(planes[0], x, y, z), 0.0f);
+				viewPos((static_cast<float>(tileX) - 0.5f) * 16.0f, (static_cast<float>(tileY) + 0.5f) * 16.0f, x, y);
+				EXPECT_LT(Distance(planes[1], x, y, z), 0.0f);
+				viewPos((static_cast<float>(tileX) + 0.5f) * 16.0f, (static_cast<float>(tileY) - 0.5f) * 16.0f, x, y);
+				EXPECT_LT(Distance(planes[2], x, y, z), 0.0f);
+				viewPos((static_cast<float>(tileX) + 0.5f) * 16.0f, (static_cast<float>(tileY) + 1.5f) * 16.0f, x, y);
+				EXPECT_LT(Distance(planes[3], x, y, z), 0.0f);
+			}
+		}
+	}
+}
+
+TEST(TileFrustumCache, UpdateRebuildsOnlyOnChange)
+{
+	const float projY = 1.7320508f;
+	TileFrustumCache cache;
+	EXPECT_TRUE(cache.Update(0, projY * 0.5625f, projY, 1920, 1080));
+	EXPECT_EQ(cache.GetTileCountX(), 120u);
+	EXPECT_EQ(cache.GetTileCountY(), 68u);
+	// 汾ֱʲʱʹͶӰֵͬҲؽ
+	EXPECT_FALSE(cache.Update(0, projY * 0.5625f, projY, 1920, 1080));
+	EXPECT_FALSE(cache.Update(0, 1.0f, 1.0f, 1920, 1080));
+	ExpectMatchesEdges(cache, 1920, 1080, 16, projY * 0.5625f, projY);
+
+	// ͶӰ汾仯
+	EXPECT_TRUE(cache.Update(1, 1.0f, 1.0f, 1920, 1080));
+	ExpectMatchesEdges(cache, 1920, 1080, 16, 1.0f, 1.0f);
+	// ֱʱ仯
+	EXPECT_TRUE(cache.Update(1, 1.0f, 1.0f, 1280, 720));
+	EXPECT_EQ(cache.GetTileCountX(), 80u);
+	EXPECT_EQ(cache.GetTileCountY(), 45u);
+	EXPECT_TRUE(cache.Update(1, 1.0f, 1.0f, 1280, 721));
+	EXPECT_FALSE(cache.Update(1, 1.0f, 1.0f, 1280, 721));
+	ExpectMatchesEdges(cache, 1280, 721, 16, 1.0f, 1.0f);
+}
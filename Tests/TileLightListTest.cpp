@@ -0,0 +1,177 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include "TestFramework.h"
+#include "TileLightList.h"
+
+using namespace Renderer;
+using namespace DirectX;
+
+namespace
+{
+constexpr float nearZ = 0.5f;
+constexpr float farZ = 500.0f;
+
+struct View
+{
+	uint32_t	width;
+	uint32_t	height;
+	float		projX;
+	float		projY;
+};
+
+View MakeView(uint32_t width, uint32_t height)
+{
+	const float projY = 1.0f / std::tan(0.5f * 1.0471976f);
+	return { width, height, projY * static_cast<float>(height) / static_cast<float>(width), projY };
+}
+
+// zĹ۲ռλ
+XMFLOAT3 PixelViewPos(const View& view, float pixelX, float pixelY, float z)
+{
+	return { (2.0f * pixelX / static_cast<float>(view.width) - 1.0f) * z / view.projX,
+		(1.0f - 2.0f * pixelY / static_cast<float>(view.height)) * z / view.projY, z };
+}
+
+bool HasLight(const TileLightList& list, uint32_t tileIdx, uint32_t lightIdx)
+{
+	return (list.GetTileLightBits()[static_cast<size_t>(tileIdx) * list.GetLightWords() + (lightIdx >> 5)] >> (lightIdx & 31)) & 1;
+}
+}
+
+TEST(TileLightList, DepthRangesFollowTransparentAndOpaqueDepth)
+{
+	constexpr uint32_t width = 48;
+	constexpr uint32_t height = 16;
+	std::vector<float> opaque(width * height, 100.0f);
+	std::vector<float> transparent(width * height, farZ);
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		// 0飺û͸أ1飺͸2030֮䣬Ұ벿ΪպУ2飺͸ȫڵ
+		for (uint32_t x = 16; x < 32; ++x)
+		{
+			transparent[y * width + x] = 20.0f + static_cast<float>(y) * 10.0f / 15.0f;
+			if (x >= 24)
+				opaque[y * width + x] = 0.0f;
+		}
+		for (uint32_t x = 32; x < 48; ++x)
+		{
+			transparent[y * width + x] = 150.0f;
+		}
+	}
+	TileLightList list;
+	list.ReduceDepthRanges(width, height, opaque.data(), transparent.data(), farZ, nearZ);
+	ASSERT_EQ(list.GetTileCountX(), 3u);
+	ASSERT_EQ(list.GetTileCountY(), 1u);
+	const auto& ranges = list.GetTileDepthRanges();
+	EXPECT_EQ(ranges[0].x, TileLightList::emptyTileZ);
+	EXPECT_EQ(ranges[0].y, 100.0f);
+	EXPECT_NEAR(ranges[1].x, 20.0f, 1e-5f);
+	EXPECT_EQ(ranges[1].y, farZ);
+	EXPECT_EQ(ranges[2].x, 150.0f);
+	EXPECT_GT(ranges[2].x, ranges[2].y);
+}
+
+TEST(TileLightList, LightsReachingTransparentPixelsAreListed)
+{
+	const View view = MakeView(160, 96);
+	std::vector<float> opaque(view.width * view.height);
+	std::vector<float> transparent(view.width * view.height);
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> opaqueDist(40.0f, 200.0f);
+	std::uniform_real_distribution<float> transparentDist(5.0f, 60.0f);
+	for (size_t i = 0; i < opaque.size(); ++i)
+	{
+		opaque[i] = opaqueDist(rng);
+		transparent[i] = (i % 7 == 0) ? transparentDist(rng) : farZ;
+	}
+	std::uniform_real_distribution<float> ndc(-1.2f, 1.2f);
+	std::uniform_real_distribution<float> depth(1.0f, 220.0f);
+	std::uniform_real_distribution<float> radius(1.0f, 15.0f);
+	std::vector<LightInCompute> lights(300);
+	for (auto& light : lights)
+	{
+		const float z = depth(rng);
+		light.posV = XMFLOAT3(ndc(rng) * z / view.projX, ndc(rng) * z / view.projY, z);
+		light.fallOffEnd = radius(rng);
+		light.fallOffStart = 0.5f * light.fallOffEnd;
+	}
+
+	TileFrustumCache frustumCache;
+	frustumCache.Build(view.width, view.height, view.projX, view.projY);
+	TileLightList list;
+	list.ReduceDepthRanges(view.width, view.height, opaque.data(), transparent.data(), nearZ, farZ);
+	list.Build(frustumCache.GetPlanes(), lights.data(), static_cast<uint32_t>(lights.size()));
+	ASSERT_EQ(list.GetLightWords(), 10u);
+
+	// ʵ޹صļ飺Χ򸲸͸أ򸲸͸벻͸֮߶ʱԴڷֿ
+	uint32_t checked = 0;
+	for (uint32_t y = 0; y < view.height; ++y)
+	{
+		for (uint32_t x = 0; x < view.width; ++x)
+		{
+			const size_t pixel = static_cast<size_t>(y) * view.width + x;
+			if (transparent[pixel] >= farZ)
+				continue;
+			const uint32_t tileIdx = (y / TileLightList::defaultTileSize) * list.GetTileCountX() + x / TileLightList::defaultTileSize;
+			for (float t : { 0.0f, 0.5f, 1.0f })
+			{
+				const float z = transparent[pixel] + t * (opaque[pixel] - transparent[pixel]);
+				const XMFLOAT3 pos = PixelViewPos(view, static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f, z);
+				for (uint32_t i = 0; i < lights.size(); ++i)
+				{
+					const float dx = pos.x - lights[i].posV.x;
+					const float dy = pos.y - lights[i].posV.y;
+					const float dz = pos.z - lights[i].posV.z;
+					if (dx * dx + dy * dy + dz * dz >= lights[i].fallOffEnd * lights[i].fallOffEnd * 0.999f)
+						continue;
+					++checked;
+					ASSERT_TRUE(HasLight(list, tileIdx, i));
+				}
+			}
+		}
+	}
+	EXPECT_GT(checked, 0u);
+
+	// λһ
+	for (uint32_t tileY = 0; tileY < list.GetTileCountY(); ++tileY)
+	{
+		for (uint32_t tileX = 0; tileX < list.GetTileCountX(); ++tileX)
+		{
+			uint32_t count = 0;
+			for (uint32_t i = 0; i < lights.size(); ++i)
+				count += HasLight(list, tileY * list.GetTileCountX() + tileX, i) ? 1 : 0;
+			EXPECT_EQ(list.GetTileLightCount(tileX, tileY), count);
+		}
+	}
+}
+
+TEST(TileLightList, LightsBeyondOneBatchAreKept)
+{
+	// ԴMAX_TILE_LIGHTSʱضϣλ򲼾CullLightsдԴĽһ
+	const View view = MakeView(32, 32);
+	std::vector<float> opaque(view.width * view.height, 100.0f);
+	std::vector<float> transparent(view.width * view.height, 10.0f);
+	const uint32_t count = MAX_TILE_LIGHTS + 100;
+	std::vector<LightInCompute> lights(count);
+	for (auto& light : lights)
+	{
+		light.posV = XMFLOAT3(0.0f, 0.0f, 50.0f);
+		light.fallOffEnd = 1000.0f;
+	}
+	// һյԴ׶
+	lights.back().posV = XMFLOAT3(0.0f, 0.0f, -5000.0f);
+
+	TileFrustumCache frustumCache;
+	frustumCache.Build(view.width, view.height, view.projX, view.projY);
+	TileLightList list;
+	list.ReduceDepthRanges(view.width, view.height, opaque.data(), transparent.data(), nearZ, farZ);
+	list.Build(frustumCache.GetPlanes(), lights.data(), count);
+	EXPECT_EQ(list.GetLightWords(), (count + 31) / 32);
+	for (uint32_t tileIdx = 0; tileIdx < 4; ++tileIdx)
+	{
+		EXPECT_EQ(list.GetTileLightCount(tileIdx % 2, tileIdx / 2), count - 1);
+		EXPECT_TRUE(HasLight(list, tileIdx, MAX_TILE_LIGHTS + 50));
+		EXPECT_FALSE(HasLight(list, tileIdx, count - 1));
+	}
+}
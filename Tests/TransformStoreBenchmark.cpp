@@ -0,0 +1,99 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+#include <vector>
+#include "TransformStore.h"
+
+namespace
+{
+constexpr uint32_t instanceCount = 100000;
+
+// ԭȵʵ֣ÿʵԳһTransformʵS * R * Tת
+struct InstanceData
+{
+	Transform	transform;
+	XMFLOAT4X4	model;
+};
+
+std::vector<Transform> MakeTransforms(uint32_t count)
+{
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<float> angleDist(-3.0f, 3.0f);
+	std::uniform_real_distribution<float> positionDist(-500.0f, 500.0f);
+	std::vector<Transform> forms(count);
+	for (auto& form : forms)
+	{
+		form = Transform(XMFLOAT3(1.0f, 1.0f, 1.0f), XMFLOAT3(angleDist(rng), angleDist(rng), angleDist(rng)),
+			XMFLOAT3(positionDist(rng), positionDist(rng), positionDist(rng)));
+	}
+	return forms;
+}
+
+void BM_PerInstanceTransform(benchmark::State& state)
+{
+	std::vector<std::shared_ptr<InstanceData>> instances;
+	for (const auto& form : MakeTransforms(instanceCount))
+	{
+		auto instance = std::make_shared<InstanceData>();
+		instance->transform = form;
+		instances.push_back(std::move(instance));
+	}
+	for (auto _ : state)
+	{
+		for (auto& instance : instances)
+		{
+			const Transform& form = instance->transform;
+			const XMMATRIX model = XMMatrixScaling(form.m_scale.x, form.m_scale.y, form.m_scale.z)
+				* XMMatrixRotationRollPitchYaw(form.m_rotation.x, form.m_rotation.y, form.m_rotation.z)
+				* XMMatrixTranslation(form.m_position.x, form.m_position.y, form.m_position.z);
+			XMStoreFloat4x4(&instance->model, XMMatrixTranspose(model));
+		}
+		benchmark::DoNotOptimize(instances.data());
+	}
+	state.SetItemsProcessed(state.iterations() * instanceCount);
+}
+BENCHMARK(BM_PerInstanceTransform)->UseRealTime();
+
+void BM_ComposeTransposed(benchmark::State& state)
+{
+	auto& store = TransformStore::instance();
+	const std::vector<Transform> forms = MakeTransforms(instanceCount);
+	const uint32_t start = store.Allocate(instanceCount);
+	for (uint32_t i = 0; i < instanceCount; ++i)
+	{
+		store.SetRotation(start + i, forms[i].m_rotation);
+		store.SetPosition(start + i, forms[i].m_position);
+	}
+	std::vector<XMFLOAT4X4> models(instanceCount);
+	for (auto _ : state)
+	{
+		store.ComposeTransposed(start, instanceCount, models.data());
+		benchmark::DoNotOptimize(models.data());
+	}
+	state.SetItemsProcessed(state.iterations() * instanceCount);
+}
+BENCHMARK(BM_ComposeTransposed)->UseRealTime();
+
+// ÿֻ֡1%ʵ޸ģֻΪ
+void BM_ComposeDirtyOnePercent(benchmark::State& state)
+{
+	auto& store = TransformStore::instance();
+	const std::vector<Transform> forms = MakeTransforms(instanceCount);
+	const uint32_t start = store.Allocate(instanceCount);
+	std::vector<XMFLOAT4X4> models(instanceCount);
+	uint32_t frame = 0;
+	for (auto _ : state)
+	{
+		for (uint32_t i = frame % 100; i < instanceCount; i += 100)
+			store.SetPosition(start + i, forms[i].m_position);
+		store.ConsumeDirtyRanges(start, instanceCount, [&](uint32_t first, uint32_t size)
+		{
+			store.ComposeTransposed(first, size, models.data() + (first - start));
+		});
+		benchmark::DoNotOptimize(models.data());
+		++frame;
+	}
+	state.SetItemsProcessed(state.iterations() * instanceCount);
+}
+BENCHMARK(BM_ComposeDirtyOnePercent)->UseRealTime();
+}
@@ -0,0 +1,120 @@
+#include <random>
+#include <vector>
+#include "TestFramework.h"
+#include "TransformStore.h"
+
+namespace
+{
+// ԭRenderItem::UpdateʵTransform::GetModelMatrixXMĽ
+XMMATRIX ReferenceModel(const XMFLOAT3& scale, const XMFLOAT3& rotation, const XMFLOAT3& position)
+{
+	return XMMatrixScaling(scale.x, scale.y, scale.z) * XMMatrixRotationRollPitchYaw(rotation.x, rotation.y, rotation.z)
+		* XMMatrixTranslation(position.x, position.y, position.z);
+}
+
+uint32_t CountDirty(TransformStore& store, uint32_t start, uint32_t count)
+{
+	uint32_t dirty = 0;
+	store.ConsumeDirtyRanges(start, count, [&](uint32_t, uint32_t size) { dirty += size; });
+	return dirty;
+}
+}
+
+TEST(TransformStore, AllocateReturnsContiguousRanges)
+{
+	auto& store = TransformStore::instance();
+	const uint32_t first = store.Allocate(5);
+	const uint32_t second = store.Allocate(3);
+	EXPECT_EQ(second, first + 5);
+	EXPECT_EQ(store.GetSize(), second + 3);
+	// ·ʵΪλ任
+	const Transform form = store.GetTransform(second);
+	EXPECT_EQ(form.m_scale.x, 1.0f);
+	EXPECT_EQ(form.m_rotation.y, 0.0f);
+	EXPECT_EQ(form.m_position.z, 0.0f);
+}
+
+TEST(TransformStore, GrowAtEndExtendsInPlace)
+{
+	auto& store = TransformStore::instance();
+	const uint32_t start = store.Allocate(2);
+	store.SetPosition(start + 1, XMFLOAT3(1.0f, 2.0f, 3.0f));
+	EXPECT_EQ(store.Grow(start, 2), start);
+	EXPECT_EQ(store.GetSize(), start + 3);
+	EXPECT_EQ(store.GetTransform(start + 1).m_position.y, 2.0f);
+}
+
+TEST(TransformStore, GrowInMiddleMovesRangeToEnd)
+{
+	auto& store = TransformStore::instance();
+	const uint32_t start = store.Allocate(2);
+	store.SetScale(start, XMFLOAT3(2.0f, 3.0f, 4.0f));
+	store.SetRotation(start + 1, XMFLOAT3(0.1f, 0.2f, 0.3f));
+	store.Allocate(1);
+	const uint32_t moved = store.Grow(start, 2);
+	EXPECT_EQ(moved, start + 3);
+	EXPECT_EQ(store.GetSize(), moved + 3);
+	EXPECT_EQ(store.GetTransform(moved).m_scale.z, 4.0f);
+	EXPECT_EQ(store.GetTransform(moved + 1).m_rotation.x, 0.1f);
+}
+
+TEST(TransformStore, DirtyFlagsLastOneWritePerFrameResource)
+{
+	auto& store = TransformStore::instance();
+	const uint32_t start = store.Allocate(8);
+	for (int frame = 0; frame < frameResourcesCount; ++frame)
+	{
+		EXPECT_EQ(CountDirty(store, start, 8), 8u);
+	}
+	EXPECT_EQ(CountDirty(store, start, 8), 0u);
+
+	// ֻб޸ĵʵٴα࣬ʵϲΪһ
+	store.SetPosition(start + 2, XMFLOAT3(1.0f, 0.0f, 0.0f));
+	store.SetScale(start + 3, XMFLOAT3(2.0f, 2.0f, 2.0f));
+	store.SetRotation(start + 6, XMFLOAT3(0.0f, 1.0f, 0.0f));
+	std::vector<std::pair<uint32_t, uint32_t>> ranges;
+	store.ConsumeDirtyRanges(start, 8, [&](uint32_t first, uint32_t size) { ranges.emplace_back(first, size); });
+	ASSERT_EQ(ranges.size(), 2u);
+	EXPECT_EQ(ranges[0].first, start + 2);
+	EXPECT_EQ(ranges[0].second, 2u);
+	EXPECT_EQ(ranges[1].first, start + 6);
+	EXPECT_EQ(ranges[1].second, 1u);
+
+	store.MarkDirty(start, 8);
+	EXPECT_EQ(CountDirty(store, start, 8), 8u);
+}
+
+TEST(TransformStore, ComposeMatchesPerInstanceMatrices)
+{
+	auto& store = TransformStore::instance();
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> scaleDist(0.1f, 4.0f);
+	std::uniform_real_distribution<float> angleDist(-6.0f, 6.0f);
+	std::uniform_real_distribution<float> positionDist(-500.0f, 500.0f);
+	// 4ı4ʵһ
+	constexpr uint32_t count = 103;
+	const uint32_t start = store.Allocate(count);
+	std::vector<Transform> forms(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		forms[i] = Transform(XMFLOAT3(scaleDist(rng), scaleDist(rng), scaleDist(rng)), XMFLOAT3(angleDist(rng), angleDist(rng), angleDist(rng)),
+			XMFLOAT3(positionDist(rng), positionDist(rng), positionDist(rng)));
+		store.SetScale(start + i, forms[i].m_scale);
+		store.SetRotation(start + i, forms[i].m_rotation);
+		store.SetPosition(start + i, forms[i].m_position);
+	}
+	std::vector<XMFLOAT4X4> composed(count);
+	store.ComposeTransposed(start, count, composed.data());
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		XMFLOAT4X4 expected;
+		XMStoreFloat4x4(&expected, XMMatrixTranspose(ReferenceModel(forms[i].m_scale, forms[i].m_rotation, forms[i].m_position)));
+		for (int row = 0; row < 4; ++row)
+		{
+			for (int col = 0; col < 4; ++col)
+			{
+				ASSERT_NEAR(composed[i].m[row][col], expected.m[row][col], 1e-3 * (1.0 + std::fabs(expected.m[row][col])));
+			}
+		}
+	}
+}
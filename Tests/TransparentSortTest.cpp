@@ -0,0 +1,63 @@
+#include <vector>
+#include "TestFramework.h"
+#include "TransparentSort.h"
+
+using namespace Renderer;
+using namespace DirectX;
+
+namespace
+{
+XMMATRIX MakeView(FXMVECTOR eye, FXMVECTOR target)
+{
+	return XMMatrixLookAtLH(eye, target, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+}
+}
+
+TEST(TransparentSort, OrdersFarToNear)
+{
+	const std::vector<XMFLOAT3> centers = { { 0.0f, 0.0f, 10.0f }, { 1.0f, 2.0f, 50.0f }, { -3.0f, 0.0f, 5.0f }, { 0.0f, -1.0f, 30.0f } };
+	TransparentSort sort;
+	const auto& order = sort.Sort(centers.data(), static_cast<uint32_t>(centers.size()), XMMatrixIdentity());
+	ASSERT_EQ(order.size(), centers.size());
+	EXPECT_EQ(order[0], 1u);
+	EXPECT_EQ(order[1], 3u);
+	EXPECT_EQ(order[2], 0u);
+	EXPECT_EQ(order[3], 2u);
+	EXPECT_EQ(sort.GetViewDepths()[1], 50.0f);
+	EXPECT_TRUE(&sort.GetOrder() == &order);
+}
+
+TEST(TransparentSort, DepthMatchesViewTransform)
+{
+	const XMMATRIX view = MakeView(XMVectorSet(20.0f, 5.0f, -40.0f, 1.0f), XMVectorSet(-10.0f, 0.0f, 30.0f, 1.0f));
+	const std::vector<XMFLOAT3> centers = { { 0.0f, 0.0f, 0.0f }, { 25.0f, 3.0f, 60.0f }, { -60.0f, 10.0f, 5.0f }, { 100.0f, -5.0f, -20.0f } };
+	TransparentSort sort;
+	sort.Sort(centers.data(), static_cast<uint32_t>(centers.size()), view);
+	for (size_t i = 0; i < centers.size(); ++i)
+	{
+		const XMVECTOR viewPos = XMVector3TransformCoord(XMLoadFloat3(&centers[i]), view);
+		EXPECT_NEAR(sort.GetViewDepths()[i], XMVectorGetZ(viewPos), 1e-3f);
+	}
+	const auto& order = sort.GetOrder();
+	for (size_t i = 1; i < order.size(); ++i)
+	{
+		EXPECT_GT(sort.GetViewDepths()[order[i - 1]], sort.GetViewDepths()[order[i]]);
+	}
+}
+
+TEST(TransparentSort, EqualDepthsKeepInputOrder)
+{
+	// ͬһȵ屣˳ֹʱÿ֡ͬ
+	const std::vector<XMFLOAT3> centers = { { 0.0f, 0.0f, 20.0f }, { 5.0f, 0.0f, 20.0f }, { 0.0f, 0.0f, 40.0f }, { -5.0f, 3.0f, 20.0f } };
+	TransparentSort sort;
+	for (int frame = 0; frame < 3; ++frame)
+	{
+		const auto& order = sort.Sort(centers.data(), static_cast<uint32_t>(centers.size()), XMMatrixIdentity());
+		ASSERT_EQ(order.size(), 4u);
+		EXPECT_EQ(order[0], 2u);
+		EXPECT_EQ(order[1], 0u);
+		EXPECT_EQ(order[2], 1u);
+		EXPECT_EQ(order[3], 3u);
+	}
+	EXPECT_TRUE(sort.Sort(centers.data(), 0, XMMatrixIdentity()).empty());
+}